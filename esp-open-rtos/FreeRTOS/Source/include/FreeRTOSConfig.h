@@ -131,6 +131,15 @@
 #define configUSE_NEWLIB_REENTRANT 1
 #endif
 
+/* Set configSUPPORT_STATIC_ALLOCATION to 1 to enable the xxxCreateStatic()
+   API. The port then also provides static idle and timer task memory. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#endif
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 #ifndef INCLUDE_vTaskPrioritySet
@@ -198,6 +198,38 @@ void vPortEndScheduler( void )
     /* No-op, nothing to return to */
 }
 
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/* With static allocation the kernel gets the idle and timer task memory
+   from these callbacks instead of the heap. They are weak so that an
+   application can supply its own buffers.
+*/
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+void __attribute__((weak)) vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                                         StackType_t **ppxIdleTaskStackBuffer,
+                                                         uint32_t *pulIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS == 1
+static StaticTask_t xTimerTaskTCB;
+static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+void __attribute__((weak)) vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                                          StackType_t **ppxTimerTaskStackBuffer,
+                                                          uint32_t *pulTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+#endif
+
 /*-----------------------------------------------------------*/
 
 static unsigned portBASE_TYPE uxCriticalNesting = 0;
@@ -30,9 +30,35 @@
 
 #define SPI_FLASH_SECTOR_SIZE      4096
 
+/**
+ * The cache window at SPIFLASH_MMAP_BASE maps one megabyte of flash: the
+ * Cache_Read_Enable of spiflash-cache-enable.S maps rboot_megabyte, the
+ * megabyte of the running ROM, whatever its arguments. Reads within the first
+ * SPIFLASH_MMAP_SIZE bytes of that megabyte go through the window, without
+ * disabling interrupts or the cache; all others are raw reads. Define as 0 to
+ * always use raw reads.
+ */
+#ifndef SPIFLASH_MMAP_SIZE
+#define SPIFLASH_MMAP_SIZE         0x100000
+#endif
+#define SPIFLASH_MMAP_BASE         0x40200000
+
+/**
+ * Raw reads outside the window are split into critical sections of at most
+ * this many bytes. Interrupts and the cache are enabled between them.
+ */
+#ifndef SPIFLASH_READ_CHUNK
+#define SPIFLASH_READ_CHUNK        256
+#endif
+
 /**
  * Read data from SPI flash.
  *
+ * Reads inside the memory-mapped window go through the flash cache, other
+ * reads through the SPI(0) data registers in SPIFLASH_READ_CHUNK pieces. A
+ * raw read longer than one chunk is not atomic with respect to writes done
+ * by other tasks between the pieces.
+ *
  * @param addr Address to read from. Can be not aligned.
  * @param buf Buffer to read to. Doesn't have to be aligned.
  * @param size Size of data to read. Buffer size must be >= than data size.
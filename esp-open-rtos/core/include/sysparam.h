@@ -25,6 +25,24 @@
  *  Keys and values are stored in flash using a progressive list structure
  *  which allows space-efficient storage and minimizes flash erase cycles,
  *  improving write speed and increasing the lifespan of the flash memory.
+ *
+ *  Building with `SYSPARAM_INDEX_SIZE` set to the expected number of keys
+ *  keeps a RAM index of the keys (20 bytes each), built by sysparam_init().
+ *  Lookups then read the flash only to confirm the key and fetch the value,
+ *  instead of walking every entry of the area.
+ *
+ *  Several keys can be changed together with sysparam_txn_begin(),
+ *  sysparam_txn_set_data() and sysparam_txn_commit(): the new entries are
+ *  appended as one block that a single header write makes valid, so after a
+ *  reset either all of them or none are found.  Areas holding such blocks
+ *  are only readable by this version of sysparam until they are compacted.
+ *
+ *  Compaction normally happens inside the write that runs out of space, which
+ *  then waits for the stale region to be erased and every live entry to be
+ *  copied.  Calling sysparam_compact_step() from a low-priority task instead
+ *  spreads that work over short time slices, so writes rarely have to
+ *  compact at all.  sysparam_get_stats() reports the erase counts and the
+ *  write latency.
  */
 
 /** Status codes returned by all sysparam functions
@@ -60,6 +78,36 @@ typedef struct {
     struct sysparam_context *ctx;
 } sysparam_iter_t;
 
+/** Structure holding the key/value pairs staged by sysparam_txn_set_data()
+ *  until sysparam_txn_commit().  This should be initialized by calling
+ *  sysparam_txn_begin() and is released by sysparam_txn_commit() or
+ *  sysparam_txn_abort().
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t bufsize;
+    size_t flash_len;          ///< Flash space of the staged entries, at most
+    uint16_t count;
+    sysparam_status_t status;  ///< First staging error, returned by the commit
+} sysparam_txn_t;
+
+/** Wear and latency figures returned by sysparam_get_stats().  Counters
+ *  start at zero in sysparam_init(), except `region_cycles`, which is kept in
+ *  the region headers.
+ */
+typedef struct {
+    uint32_t sector_erases;          ///< Sectors erased since sysparam_init()
+    uint16_t region_cycles[2];       ///< Compactions into the lower and the upper region
+    uint32_t compactions;            ///< Compactions finished inside a write or sysparam_compact()
+    uint32_t background_compactions; ///< Compactions finished by sysparam_compact_step()
+    uint32_t restarts;               ///< Background copies dropped because a copied key changed
+    size_t compactable;              ///< Bytes of deleted entries a compaction would free
+    size_t free;                     ///< Unwritten bytes at the end of the active region
+    uint32_t set_max_us;             ///< Slowest sysparam_set_data() or sysparam_txn_commit()
+    uint32_t step_max_us;            ///< Slowest sysparam_compact_step()
+} sysparam_stats_t;
+
 /** Initialize sysparam and set up the current area of flash to use.
  *
  *  This must be called (and return successfully) before any other sysparam
@@ -85,7 +133,11 @@ typedef struct {
  *                                  necessary to call sysparam_create_area() to
  *                                  create one first.
  *  @retval ::SYSPARAM_ERR_CORRUPT  Sysparam region has bad/corrupted data
- *  @retval ::SYSPARAM_ERR_IO       I/O error reading/writing flash
+ *  @retval ::SYSPARAM_ERR_IO       I/O error reading/writing flash, including
+ *                                  failing to finish a transaction that a
+ *                                  reset interrupted.  The area is then left
+ *                                  uninitialized; calling sysparam_init()
+ *                                  again retries.
  */
 sysparam_status_t sysparam_init(uint32_t base_addr, uint32_t top_addr);
 
@@ -149,6 +201,46 @@ sysparam_status_t sysparam_get_info(uint32_t *base_addr, uint32_t *num_sectors);
  */
 sysparam_status_t sysparam_compact();
 
+/** Do part of a compaction, for at most about `slice_us` microseconds.
+ *
+ *  Meant to be called repeatedly from a low-priority task.  Each call first
+ *  erases sectors of the stale region that are not blank yet.  Once they are
+ *  erased and at least `threshold` bytes (and at least one) are compactable,
+ *  it copies the live entries into the stale region, a key at a time, and
+ *  finally switches regions as sysparam_compact() would.  Writes may happen
+ *  between calls.  A write that changes a key which was already copied drops
+ *  the copy, which then starts over.  A write that needs to compact finishes
+ *  the copy in progress instead of starting a new one.
+ *
+ *  The sysparam lock is held for the whole call, so writes from other tasks
+ *  wait at most about one slice.  A sector erase cannot be split, so a call
+ *  takes at least as long as one erase (typically 30-50 ms) whenever it
+ *  erases a sector.
+ *
+ *  @param[in] threshold  Compactable bytes needed to start a new copy
+ *  @param[in] slice_us   Time after which no further step is started
+ *
+ *  @retval ::SYSPARAM_OK           Work was done and more may remain
+ *  @retval ::SYSPARAM_NOTFOUND     Nothing to do until more entries are
+ *                                  deleted or replaced
+ *  @retval ::SYSPARAM_ERR_NOINIT   No current sysparam area is active
+ *  @retval ::SYSPARAM_ERR_NOMEM    Unable to allocate memory
+ *  @retval ::SYSPARAM_ERR_IO       I/O error reading/writing flash
+ */
+sysparam_status_t sysparam_compact_step(size_t threshold, uint32_t slice_us);
+
+/** Get wear and latency statistics of the active area
+ *
+ *  Without the RAM index, `compactable` takes a scan of the active region.
+ *
+ *  @param[out] stats  The figures
+ *
+ *  @retval ::SYSPARAM_OK           Completed successfully
+ *  @retval ::SYSPARAM_ERR_NOINIT   No current sysparam area is active
+ *  @retval ::SYSPARAM_ERR_IO       I/O error reading flash
+ */
+sysparam_status_t sysparam_get_stats(sysparam_stats_t *stats);
+
 /** Get the value associated with a key
  *
  *  This is the core "get value" function.  It will retrieve the value for the
@@ -464,4 +556,67 @@ sysparam_status_t sysparam_iter_next(sysparam_iter_t *iter);
  */
 void sysparam_iter_end(sysparam_iter_t *iter);
 
+/** Begin a transaction changing several keys at once
+ *
+ *  Nothing is read or written until sysparam_txn_commit().
+ *
+ *  @param[in] txn  A pointer to a sysparam_txn_t structure to initialize
+ *
+ *  @retval ::SYSPARAM_OK           Initialization successful
+ */
+sysparam_status_t sysparam_txn_begin(sysparam_txn_t *txn);
+
+/** Stage a new value for a key
+ *
+ *  Takes the same arguments as sysparam_set_data(), including an empty value
+ *  to delete the key.  The data is copied, so the buffers can be reused
+ *  right away.  If the same key is staged twice, the last value is written.
+ *
+ *  An error is also remembered and returned by sysparam_txn_commit(), which
+ *  then writes nothing, so the results of a series of calls can be checked
+ *  once.
+ *
+ *  @retval ::SYSPARAM_OK           Value staged
+ *  @retval ::SYSPARAM_ERR_BADVALUE Either an empty key was provided or the
+ *                                  staged entries exceed 65535 bytes
+ *  @retval ::SYSPARAM_ERR_NOMEM    Unable to allocate memory
+ */
+sysparam_status_t sysparam_txn_set_data(sysparam_txn_t *txn, const char *key, const uint8_t *value, size_t value_len, bool binary);
+
+/** Stage a string value, as sysparam_set_string() */
+sysparam_status_t sysparam_txn_set_string(sysparam_txn_t *txn, const char *key, const char *value);
+
+/** Stage an int32_t binary value, as sysparam_set_int32() */
+sysparam_status_t sysparam_txn_set_int32(sysparam_txn_t *txn, const char *key, int32_t value);
+
+/** Stage an int8_t binary value, as sysparam_set_int8() */
+sysparam_status_t sysparam_txn_set_int8(sysparam_txn_t *txn, const char *key, int8_t value);
+
+/** Write all staged values atomically and release `txn`
+ *
+ *  Values equal to the stored ones are left out.  The others are appended in
+ *  one contiguous flash write, followed by the header write that commits
+ *  them, and the values they replace are then marked deleted (a reset before
+ *  that is repaired by the next sysparam_init()).  If the area is too full,
+ *  it is compacted once, before anything is written.
+ *
+ *  @param[in] txn  The transaction, released even on error
+ *
+ *  @retval ::SYSPARAM_OK           All values set (or already set).
+ *  @retval ::SYSPARAM_ERR_NOINIT   sysparam_init() must be called first
+ *  @retval ::SYSPARAM_ERR_BADVALUE A staging call failed with this error
+ *  @retval ::SYSPARAM_ERR_FULL     No space left in sysparam area
+ *                                  (or too many keys in use); no value set
+ *  @retval ::SYSPARAM_ERR_NOMEM    Unable to allocate memory; no value set
+ *  @retval ::SYSPARAM_ERR_CORRUPT  Sysparam region has bad/corrupted data
+ *  @retval ::SYSPARAM_ERR_IO       I/O error reading/writing flash; the
+ *                                  values may or may not have been set, but
+ *                                  after a reset either all or none of them
+ *                                  are found
+ */
+sysparam_status_t sysparam_txn_commit(sysparam_txn_t *txn);
+
+/** Release a transaction without writing anything */
+void sysparam_txn_abort(sysparam_txn_t *txn);
+
 #endif /* _SYSPARAM_H_ */
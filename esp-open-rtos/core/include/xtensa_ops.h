@@ -39,4 +39,8 @@
 #define ESYNC() asm volatile ( "esync" )
 #define DSYNC() asm volatile ( "dsync" )
 
+// Stop the CPU until an interrupt above @level arrives (waiti 0 enables all
+// interrupt levels as it stops)
+#define WAITI(level) asm volatile ( "waiti " #level ::: "memory" )
+
 #endif /* _XTENSA_OPS_H */
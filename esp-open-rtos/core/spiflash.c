@@ -30,6 +30,10 @@
 #include <FreeRTOS.h>
 #include <string.h>
 
+/* Megabyte of flash mapped at SPIFLASH_MMAP_BASE, see spiflash-cache-enable.S.
+ * Holds 0x80 until Cache_Read_Enable first runs, which is past any flash. */
+extern uint8_t rboot_megabyte;
+
 /**
  * Note about Wait_SPI_Idle.
  *
@@ -188,18 +192,11 @@ static inline void IRAM read_block(sdk_flashchip_t *chip, uint32_t addr,
 
 /**
  * Read SPI flash data. Data region doesn't need to be page aligned.
+ * The caller checks the bounds.
  */
-static inline bool IRAM read_data(sdk_flashchip_t *flashchip, uint32_t addr,
+static inline void IRAM read_data(sdk_flashchip_t *flashchip, uint32_t addr,
         uint8_t *dst, uint32_t size)
 {
-    if (size < 1) {
-        return true;
-    }
-
-    if ((addr + size) > flashchip->chip_size) {
-        return false;
-    }
-
     while (size >= SPI_READ_MAX_SIZE) {
         read_block(flashchip, addr, dst, SPI_READ_MAX_SIZE);
         dst += SPI_READ_MAX_SIZE;
@@ -210,25 +207,80 @@ static inline bool IRAM read_data(sdk_flashchip_t *flashchip, uint32_t addr,
     if (size > 0) {
         read_block(flashchip, addr, dst, size);
     }
+}
 
-    return true;
+/**
+ * Read flash through the memory-mapped cache window, from @p offset into
+ * the mapped megabyte.
+ *
+ * The window only allows aligned 32-bit loads, a byte or unaligned load
+ * raises an exception. Loads are volatile so the compiler can't turn the
+ * copy into memcpy.
+ */
+static inline void IRAM read_mmap(uint32_t offset, uint8_t *dst, uint32_t size)
+{
+    const volatile uint32_t *src =
+        (const volatile uint32_t *)(SPIFLASH_MMAP_BASE + (offset & ~3));
+    uint32_t skip = offset & 3;
+    uint32_t word;
+
+    if (skip) {
+        uint32_t n = 4 - skip < size ? 4 - skip : size;
+        word = *src++;
+        memcpy(dst, (uint8_t *)&word + skip, n);
+        dst += n;
+        size -= n;
+    }
+
+    if (((uint32_t)dst & 3) == 0) {
+        for (; size >= 4; size -= 4, dst += 4) {
+            *(uint32_t *)dst = *src++;
+        }
+    } else {
+        for (; size >= 4; size -= 4, dst += 4) {
+            word = *src++;
+            memcpy(dst, &word, 4);
+        }
+    }
+
+    if (size > 0) {
+        word = *src;
+        memcpy(dst, &word, size);
+    }
 }
 
 bool IRAM spiflash_read(uint32_t dest_addr, uint8_t *buf, uint32_t size)
 {
-    bool result = false;
+    if (!buf || dest_addr > sdk_flashchip.chip_size ||
+            size > sdk_flashchip.chip_size - dest_addr) {
+        return false;
+    }
+
+    uint32_t mmap_start = (uint32_t)rboot_megabyte << 20;
+    if (dest_addr >= mmap_start && dest_addr - mmap_start < SPIFLASH_MMAP_SIZE &&
+            size <= SPIFLASH_MMAP_SIZE - (dest_addr - mmap_start)) {
+        read_mmap(dest_addr - mmap_start, buf, size);
+        return true;
+    }
+
+    // Interrupts and the cache are off only while one chunk is read
+    while (size > 0) {
+        uint32_t chunk = size < SPIFLASH_READ_CHUNK ? size : SPIFLASH_READ_CHUNK;
 
-    if (buf) {
         vPortEnterCritical();
         Cache_Read_Disable();
 
-        result = read_data(&sdk_flashchip, dest_addr, buf, size);
+        read_data(&sdk_flashchip, dest_addr, buf, chunk);
 
         Cache_Read_Enable(0, 0, 1);
         vPortExitCritical();
+
+        dest_addr += chunk;
+        buf += chunk;
+        size -= chunk;
     }
 
-    return result;
+    return true;
 }
 
 bool IRAM spiflash_erase_sector(uint32_t addr)
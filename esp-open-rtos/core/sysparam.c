@@ -13,6 +13,7 @@
 #include <common_macros.h>
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "espressif/esp_system.h"
 
 /* The "magic" value that indicates the start of a sysparam region in flash.
  */
@@ -70,10 +71,39 @@
 #define ENTRY_ID_END   0xfff
 #define ENTRY_ID_ANY  0x1000
 
+/* A transaction block is a key-type entry with id 0 (never given to a key)
+ * whose payload holds the entries of one sysparam_txn_commit().  It is written
+ * with ENTRY_FLAG_INVALID set, so the whole block is skipped like any invalid
+ * entry until its header is rewritten without that flag.  Once committed, its
+ * entries are read as if they followed the header directly.
+ */
+#define ENTRY_ID_TXN   0x000
+/* On a committed transaction block: the values it replaces may still have to
+ * be deleted (see `_txn_recover`)
+ */
+#define ENTRY_FLAG_TXN_PENDING ENTRY_FLAG_BINARY
+
 #ifndef SYSPARAM_DEBUG
 #define SYSPARAM_DEBUG 0
 #endif
 
+/* Number of keys held in the optional RAM index, which maps a hash of each key
+ * to the flash addresses of its key and current value entries so that lookups
+ * do not have to walk the region (20 bytes of RAM per key).  0 disables the
+ * index.  If the region holds more keys than this, the index is dropped and
+ * lookups scan the flash as before until the next compaction or
+ * sysparam_init().
+ */
+#ifndef SYSPARAM_INDEX_SIZE
+#define SYSPARAM_INDEX_SIZE 0
+#endif
+
+/* Size of the stack buffer used to hash keys stored in flash and to check an
+ * index hit against the stored key.  Keys up to this length are checked with a
+ * single flash read.
+ */
+#define INDEX_KEY_BUFFER_SIZE 32
+
 /******************************* Useful Macros *******************************/
 
 #define ROUND_TO_WORD_BOUNDARY(x) (((x) + 3) & 0xfffffffc)
@@ -93,7 +123,7 @@
 struct region_header {
     uint32_t magic;
     uint16_t flags_size;
-    uint16_t reserved;
+    uint16_t cycles; // Compactions into this region (reserved, 0, in older areas)
 } __attribute__ ((packed));
 
 struct entry_header {
@@ -109,6 +139,16 @@ struct sysparam_context {
     uint16_t max_key_id;
 };
 
+struct index_slot {
+    uint32_t key_addr;
+    uint32_t value_addr; // 0 if the key has no live value
+    uint16_t hash;
+    uint16_t key_id;
+    uint16_t key_len;
+    uint16_t value_idflags;
+    uint16_t value_len;
+};
+
 /*************************** Global variables/data ***************************/
 
 static struct {
@@ -117,9 +157,45 @@ static struct {
     uint32_t end_addr;
     size_t region_size;
     bool force_compact;
+    bool txn_pending; // A committed transaction has not finished its deletes
+    uint16_t cur_cycles;
+    uint16_t alt_cycles;
     SemaphoreHandle_t sem;
 } _sysparam_info;
 
+/* A compaction in progress, which sysparam_compact_step() spreads over many
+ * calls and `_compact_params` finishes in one go.  Sectors of the stale region
+ * are erased from the last one down; the first, which holds the region header
+ * sysparam_init() looks for, only when the copy starts.
+ */
+static struct {
+    uint16_t erased;      // Trailing sectors of the stale region known to be blank
+    bool copying;         // Live entries are being copied, `iter` is open
+    bool remapped;        // The key passed to `_compact_params` was copied
+    sysparam_iter_t iter; // Position of the copy in the active region
+    uint32_t addr;        // End of the copied entries in the stale region
+    uint16_t key_id;      // Last key id given in the stale region
+    uint16_t copied_id;   // Id of the last key of the active region passed
+    uint8_t *buf;         // Entries of one copied key
+    size_t bufsize;
+} _sysparam_compact;
+
+static sysparam_stats_t _sysparam_stats;
+
+#if SYSPARAM_INDEX_SIZE > 0
+/* Mirror of the live keys of the active region.  `compactable` and
+ * `max_key_id` hold what a scan of the whole region would have counted, so
+ * writes do not need one either.
+ */
+static struct {
+    struct index_slot slot[SYSPARAM_INDEX_SIZE];
+    uint16_t count;
+    uint16_t max_key_id;
+    size_t compactable;
+    bool valid;
+} _sysparam_index;
+#endif
+
 /***************************** Internal routines *****************************/
 
 static sysparam_status_t _write_and_verify(uint32_t addr, const void *data, size_t data_size) {
@@ -138,18 +214,61 @@ static sysparam_status_t _write_and_verify(uint32_t addr, const void *data, size
     return SYSPARAM_OK;
 }
 
+/** Write a block prepared in RAM with one flash write, then verify it
+ *
+ *  Unlike `_write_and_verify`, `data` must be in RAM and is passed to the
+ *  flash driver as is.
+ */
+static sysparam_status_t _write_block_and_verify(uint32_t addr, uint8_t *data, size_t data_size) {
+    uint8_t bounce[BOUNCE_BUFFER_SIZE];
+    int i;
+
+    CHECK_FLASH_OP(spiflash_write(addr, data, data_size));
+    for (i = 0; i < data_size; i += BOUNCE_BUFFER_SIZE) {
+        size_t count = min(data_size - i, BOUNCE_BUFFER_SIZE);
+        CHECK_FLASH_OP(spiflash_read(addr + i, bounce, count));
+        if (memcmp(data + i, bounce, count) != 0) {
+            debug(1, "Flash write (@ 0x%08x) verify failed!", addr);
+            return SYSPARAM_ERR_IO;
+        }
+    }
+    return SYSPARAM_OK;
+}
+
 /** Erase the sectors of a region */
 static sysparam_status_t _format_region(uint32_t addr, uint16_t num_sectors) {
     int i;
 
     for (i = 0; i < num_sectors; i++) {
+        _sysparam_stats.sector_erases++;
         CHECK_FLASH_OP(spiflash_erase_sector(addr + (i * SPI_FLASH_SECTOR_SIZE)));
     }
     return SYSPARAM_OK;
 }
 
+/** Erase a sector unless it is already blank */
+static sysparam_status_t _erase_sector(uint32_t addr) {
+    uint32_t buffer[SCAN_BUFFER_SIZE];
+    uint32_t offset;
+    int i;
+
+    for (offset = 0; offset < sdk_flashchip.sector_size; offset += sizeof(buffer)) {
+        CHECK_FLASH_OP(spiflash_read(addr + offset, (uint8_t*)buffer, sizeof(buffer)));
+        for (i = 0; i < SCAN_BUFFER_SIZE; i++) {
+            if (buffer[i] != 0xffffffff) {
+                debug(3, "erase sector @ 0x%08x", addr);
+                _sysparam_stats.sector_erases++;
+                CHECK_FLASH_OP(spiflash_erase_sector(addr));
+                return SYSPARAM_OK;
+            }
+        }
+    }
+    debug(3, "sector @ 0x%08x is already blank", addr);
+    return SYSPARAM_OK;
+}
+
 /** Write the magic data at the beginning of a region */
-static inline sysparam_status_t _write_region_header(uint32_t addr, uint32_t other, bool active) {
+static inline sysparam_status_t _write_region_header(uint32_t addr, uint32_t other, bool active, uint16_t cycles) {
     struct region_header header;
     sysparam_status_t status;
     int16_t num_sectors;
@@ -166,7 +285,7 @@ static inline sysparam_status_t _write_region_header(uint32_t addr, uint32_t oth
     if (active) {
         header.flags_size |= REGION_FLAG_ACTIVE;
     }
-    header.reserved = 0;
+    header.cycles = cycles;
 
     debug(3, "write region header (0x%04x) @ 0x%08x", header.flags_size, addr);
     status = _write_and_verify(addr, &header, REGION_HEADER_SIZE);
@@ -244,6 +363,16 @@ static sysparam_status_t _find_entry(struct sysparam_context *ctx, uint16_t matc
         }
 
         id = ctx->entry.idflags & ENTRY_MASK_ID;
+        if (id == ENTRY_ID_TXN && (ctx->entry.idflags & (ENTRY_FLAG_ALIVE | ENTRY_FLAG_INVALID | ENTRY_FLAG_VALUE)) == ENTRY_FLAG_ALIVE) {
+            debug(3, "  entry is a committed transaction (%d bytes)", ctx->entry.len);
+            if (ctx->entry.idflags & ENTRY_FLAG_TXN_PENDING) {
+                _sysparam_info.txn_pending = true;
+            }
+            // Only the header goes away when compacting; step into the payload
+            ctx->compactable += ENTRY_HEADER_SIZE;
+            ctx->entry.len = 0;
+            continue;
+        }
         if ((ctx->entry.idflags & (ENTRY_FLAG_ALIVE | ENTRY_FLAG_INVALID)) == ENTRY_FLAG_ALIVE) {
             debug(3, "  entry is alive and valid");
             if (!(ctx->entry.idflags & ENTRY_FLAG_VALUE)) {
@@ -285,7 +414,8 @@ static inline sysparam_status_t _read_payload(struct sysparam_context *ctx, uint
     size_t size = min(buffer_size, ctx->entry.len);
     debug(3, "read payload (%d) @ 0x%08x", size, addr);
 
-    CHECK_FLASH_OP(spiflash_read(addr, buffer, buffer_size));
+    // Only the entry: a larger buffer could reach past the end of the flash
+    CHECK_FLASH_OP(spiflash_read(addr, buffer, size));
 
     return SYSPARAM_OK;
 }
@@ -344,6 +474,218 @@ static inline sysparam_status_t _find_value(struct sysparam_context *ctx, uint16
     return _find_entry(ctx, id_field & ENTRY_MASK_ID, true);
 }
 
+/******************************** RAM index **********************************/
+
+#if SYSPARAM_INDEX_SIZE > 0
+
+#define HASH_INIT 2166136261u // FNV-1a offset basis
+
+static uint32_t _hash_bytes(uint32_t hash, const uint8_t *data, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline uint16_t _hash_fold(uint32_t hash) {
+    return (hash >> 16) ^ (hash & 0xffff);
+}
+
+static inline uint16_t _hash_key(const char *key, uint16_t key_len) {
+    return _hash_fold(_hash_bytes(HASH_INIT, (const uint8_t *)key, key_len));
+}
+
+/** Hash the payload of the key entry at `addr` */
+static sysparam_status_t _hash_key_entry(uint32_t addr, uint16_t key_len, uint16_t *result) {
+    uint8_t buffer[INDEX_KEY_BUFFER_SIZE];
+    uint32_t hash = HASH_INIT;
+    uint32_t i;
+
+    for (i = 0; i < key_len; i += INDEX_KEY_BUFFER_SIZE) {
+        size_t count = min(key_len - i, INDEX_KEY_BUFFER_SIZE);
+        CHECK_FLASH_OP(spiflash_read(addr + ENTRY_HEADER_SIZE + i, buffer, count));
+        hash = _hash_bytes(hash, buffer, count);
+    }
+    *result = _hash_fold(hash);
+    return SYSPARAM_OK;
+}
+
+/** Compare the payload of the key entry at `addr` with `key` */
+static sysparam_status_t _index_check_key(uint32_t addr, const char *key, uint16_t key_len) {
+    uint8_t buffer[INDEX_KEY_BUFFER_SIZE];
+    uint32_t i;
+
+    for (i = 0; i < key_len; i += INDEX_KEY_BUFFER_SIZE) {
+        size_t count = min(key_len - i, INDEX_KEY_BUFFER_SIZE);
+        CHECK_FLASH_OP(spiflash_read(addr + ENTRY_HEADER_SIZE + i, buffer, count));
+        if (memcmp(key + i, buffer, count)) {
+            return SYSPARAM_NOTFOUND;
+        }
+    }
+    return SYSPARAM_OK;
+}
+
+static void _index_reset(void) {
+    _sysparam_index.count = 0;
+    _sysparam_index.max_key_id = 0;
+    _sysparam_index.compactable = 0;
+    _sysparam_index.valid = true;
+}
+
+static inline void _index_invalidate(void) {
+    if (_sysparam_index.valid) {
+        debug(2, "index dropped, falling back to region scans");
+    }
+    _sysparam_index.valid = false;
+}
+
+static struct index_slot *_index_find_id(uint16_t key_id) {
+    int i;
+
+    for (i = 0; i < _sysparam_index.count; i++) {
+        if (_sysparam_index.slot[i].key_id == key_id) {
+            return &_sysparam_index.slot[i];
+        }
+    }
+    return NULL;
+}
+
+/** Add a key without a value; drops the whole index if it is full */
+static void _index_add_key(uint16_t key_id, uint32_t addr, uint16_t key_len, uint16_t hash) {
+    struct index_slot *slot;
+
+    if (!_sysparam_index.valid) return;
+    if (_sysparam_index.count == SYSPARAM_INDEX_SIZE) {
+        debug(1, "more than %d keys, not indexing", SYSPARAM_INDEX_SIZE);
+        _index_invalidate();
+        return;
+    }
+    slot = &_sysparam_index.slot[_sysparam_index.count++];
+    slot->key_addr = addr;
+    slot->value_addr = 0;
+    slot->hash = hash;
+    slot->key_id = key_id;
+    slot->key_len = key_len;
+    _sysparam_index.max_key_id = max(_sysparam_index.max_key_id, key_id);
+}
+
+/** Record the value entry of a key (addr 0 when the value was deleted) */
+static void _index_set_value(uint16_t key_id, uint32_t addr, uint16_t idflags, uint16_t len) {
+    struct index_slot *slot;
+
+    if (!_sysparam_index.valid) return;
+    slot = _index_find_id(key_id);
+    if (!slot) {
+        _index_invalidate();
+        return;
+    }
+    slot->value_addr = addr;
+    slot->value_idflags = idflags;
+    slot->value_len = len;
+}
+
+static int _index_unused_keys(void) {
+    int i, unused = 0;
+
+    for (i = 0; i < _sysparam_index.count; i++) {
+        if (!_sysparam_index.slot[i].value_addr) unused++;
+    }
+    return unused;
+}
+
+/** Build the index from the active region: one pass over the keys (reading
+ *  each key once to hash it) and one over the value headers.
+ */
+static sysparam_status_t _index_build(void) {
+    struct sysparam_context ctx;
+    struct index_slot *slot;
+    sysparam_status_t status;
+    uint16_t hash;
+
+    _index_reset();
+    _init_context(&ctx);
+    while ((status = _find_entry(&ctx, ENTRY_ID_ANY, false)) == SYSPARAM_OK) {
+        status = _hash_key_entry(ctx.addr, ctx.entry.len, &hash);
+        if (status != SYSPARAM_OK) break;
+        _index_add_key(ctx.entry.idflags & ENTRY_MASK_ID, ctx.addr, ctx.entry.len, hash);
+        if (!_sysparam_index.valid) return SYSPARAM_OK;
+    }
+    if (status != SYSPARAM_NOTFOUND) {
+        _index_invalidate();
+        return status;
+    }
+    _sysparam_index.compactable = ctx.compactable;
+
+    _init_context(&ctx);
+    while ((status = _find_entry(&ctx, ENTRY_ID_ANY, true)) == SYSPARAM_OK) {
+        slot = _index_find_id(ctx.entry.idflags & ENTRY_MASK_ID);
+        // As with _find_value(), the first live value of a key is the one used
+        if (slot && !slot->value_addr) {
+            slot->value_addr = ctx.addr;
+            slot->value_idflags = ctx.entry.idflags;
+            slot->value_len = ctx.entry.len;
+        }
+    }
+    if (status != SYSPARAM_NOTFOUND) {
+        _index_invalidate();
+        return status;
+    }
+    debug(2, "indexed %d keys", _sysparam_index.count);
+    return SYSPARAM_OK;
+}
+
+/** Find a key through the index and point `ctx` at its value entry
+ *
+ *  @param[out] found  The slot of the key, or NULL if the key does not exist
+ *
+ *  @retval ::SYSPARAM_NOTFOUND  No such key, or the key has no value
+ */
+static sysparam_status_t _index_find_key(struct sysparam_context *ctx, const char *key, uint16_t key_len, uint16_t hash, struct index_slot **found) {
+    struct index_slot *slot;
+    sysparam_status_t status;
+    int i;
+
+    *found = NULL;
+    for (i = 0; i < _sysparam_index.count; i++) {
+        slot = &_sysparam_index.slot[i];
+        if (slot->hash != hash || slot->key_len != key_len) continue;
+        status = _index_check_key(slot->key_addr, key, key_len);
+        if (status == SYSPARAM_NOTFOUND) {
+            debug(3, "hash collision @ 0x%08x", slot->key_addr);
+            continue;
+        }
+        if (status != SYSPARAM_OK) return status;
+
+        *found = slot;
+        if (!slot->value_addr) return SYSPARAM_NOTFOUND;
+        ctx->addr = slot->value_addr;
+        ctx->entry.idflags = slot->value_idflags;
+        ctx->entry.len = slot->value_len;
+        return SYSPARAM_OK;
+    }
+    return SYSPARAM_NOTFOUND;
+}
+
+#endif // SYSPARAM_INDEX_SIZE > 0
+
+/** Find the value entry for a key, through the RAM index if it is usable */
+static sysparam_status_t _find_key_value(struct sysparam_context *ctx, const char *key, uint16_t key_len) {
+    sysparam_status_t status;
+
+#if SYSPARAM_INDEX_SIZE > 0
+    struct index_slot *slot;
+
+    if (_sysparam_index.valid) {
+        return _index_find_key(ctx, key, key_len, _hash_key(key, key_len), &slot);
+    }
+#endif
+    status = _find_key(ctx, key, key_len);
+    if (status != SYSPARAM_OK) return status;
+    return _find_value(ctx, ctx->entry.idflags);
+}
+
 /** Write an entry at the specified address */
 static inline sysparam_status_t _write_entry(uint32_t addr, uint16_t id, const uint8_t *payload, uint16_t len) {
     struct entry_header entry;
@@ -407,9 +749,231 @@ static inline sysparam_status_t _delete_entry(uint32_t addr) {
     return _write_and_verify(addr, &entry, ENTRY_HEADER_SIZE);
 }
 
+/********************************* Compaction *********************************/
+
+static inline uint16_t _region_sectors(void) {
+    return _sysparam_info.region_size / sdk_flashchip.sector_size;
+}
+
+/** Close the iterator and free the buffer of a copy */
+static void _compact_release(void) {
+    if (_sysparam_compact.copying) {
+        sysparam_iter_end(&_sysparam_compact.iter);
+    }
+    free(_sysparam_compact.buf);
+    _sysparam_compact.buf = NULL;
+    _sysparam_compact.bufsize = 0;
+    _sysparam_compact.copying = false;
+}
+
+/** Give up a copy; the sectors it wrote to have to be erased again */
+static void _compact_drop(void) {
+    uint32_t used;
+
+    if (!_sysparam_compact.copying) return;
+    used = _sysparam_compact.addr - _sysparam_info.alt_base;
+    _sysparam_compact.erased = _region_sectors() - (used + sdk_flashchip.sector_size - 1) / sdk_flashchip.sector_size;
+    _compact_release();
+}
+
+/** Called before a write changes the value of `key_id` (-1 for a new key):
+ *  a copy that already passed the key would keep the old value.
+ */
+static void _compact_check_key(int key_id) {
+    if (_sysparam_compact.copying && key_id >= 0 && key_id <= _sysparam_compact.copied_id) {
+        debug(2, "key %d changed after it was copied, dropping the copy", key_id);
+        _compact_drop();
+        _sysparam_stats.restarts++;
+    }
+}
+
+/** Make sure the copy buffer holds at least `size` bytes */
+static sysparam_status_t _compact_reserve(size_t size) {
+    uint8_t *newbuf;
+
+    if (size <= _sysparam_compact.bufsize) return SYSPARAM_OK;
+    newbuf = realloc(_sysparam_compact.buf, size);
+    if (!newbuf) return SYSPARAM_ERR_NOMEM;
+    _sysparam_compact.buf = newbuf;
+    _sysparam_compact.bufsize = size;
+    return SYSPARAM_OK;
+}
+
+/** Write entries prepared in the copy buffer to the stale region
+ *
+ *  The stale region is not read until it becomes the active one, so unlike
+ *  `_write_entry` the entries are written valid straight away, with a single
+ *  flash write.
+ */
+static sysparam_status_t _compact_write(size_t len) {
+    sysparam_status_t status;
+
+    if (_sysparam_compact.addr + len > _sysparam_info.alt_base + _sysparam_info.region_size) {
+        debug(1, "live entries do not fit in the stale region");
+        return SYSPARAM_ERR_FULL;
+    }
+    status = _write_block_and_verify(_sysparam_compact.addr, _sysparam_compact.buf, len);
+    // Even if it failed, these bytes are no longer blank
+    _sysparam_compact.addr += len;
+    return status;
+}
+
+/** Copy the key entry of `*key_id`, which has no value (so the iterator
+ *  skipped it) but is about to get one, and give it its new id
+ */
+static sysparam_status_t _compact_keep_key(int *key_id) {
+    struct sysparam_context ctx;
+    struct entry_header header;
+    sysparam_status_t status;
+
+    _init_context(&ctx);
+    status = _find_entry(&ctx, *key_id, false);
+    if (status < 0) return status;
+    if (status == SYSPARAM_NOTFOUND) {
+        // Written as a new key instead
+        *key_id = -1;
+        return SYSPARAM_OK;
+    }
+    status = _compact_reserve(ENTRY_SIZE(ctx.entry.len));
+    if (status < 0) return status;
+    header.idflags = ++_sysparam_compact.key_id | ENTRY_FLAG_ALIVE;
+    header.len = ctx.entry.len;
+    memcpy(_sysparam_compact.buf, &header, ENTRY_HEADER_SIZE);
+    status = _read_payload(&ctx, _sysparam_compact.buf + ENTRY_HEADER_SIZE, ctx.entry.len);
+    if (status < 0) return status;
+    status = _compact_write(ENTRY_SIZE(ctx.entry.len));
+    if (status < 0) return status;
+    *key_id = _sysparam_compact.key_id;
+    return SYSPARAM_OK;
+}
+
+/** Make the stale region, with everything copied, the active one */
+static sysparam_status_t _compact_switch(void) {
+    uint32_t new_base = _sysparam_info.alt_base;
+    uint16_t cycles = _sysparam_info.alt_cycles;
+    sysparam_status_t status;
+
+    if (cycles < 0xffff) cycles++;
+    status = _write_region_header(new_base, _sysparam_info.cur_base, true, cycles);
+    if (status == SYSPARAM_OK) {
+        status = _write_region_header(_sysparam_info.cur_base, new_base, false, _sysparam_info.cur_cycles);
+    }
+    if (status < 0) return status;
+
+    _sysparam_info.alt_base = _sysparam_info.cur_base;
+    _sysparam_info.alt_cycles = _sysparam_info.cur_cycles;
+    _sysparam_info.cur_base = new_base;
+    _sysparam_info.cur_cycles = cycles;
+    _sysparam_info.end_addr = _sysparam_compact.addr;
+    _sysparam_info.force_compact = false;
+    _compact_release();
+    // The old active region is the stale one now
+    _sysparam_compact.erased = 0;
+
+#if SYSPARAM_INDEX_SIZE > 0
+    // Only reads; if it fails, lookups scan until the next compaction
+    status = _index_build();
+    if (status != SYSPARAM_OK) {
+        debug(1, "could not build index (%d)", status);
+    }
+#endif
+    debug(1, "done compacting (current size %d)", _sysparam_info.end_addr - _sysparam_info.cur_base);
+    return SYSPARAM_OK;
+}
+
+/** Do the next step of a compaction: erase a sector of the stale region,
+ *  start the copy, copy one key with its value, or switch regions once
+ *  everything is copied.
+ *
+ *  @param key_id     As for `_compact_params`, or NULL
+ *  @param[out] done  Set when the regions were switched
+ */
+static sysparam_status_t _compact_next(int *key_id, bool *done) {
+    struct entry_header header;
+    sysparam_iter_t *iter = &_sysparam_compact.iter;
+    sysparam_status_t status;
+    uint16_t num_sectors = _region_sectors();
+    uint16_t old_id;
+    uint8_t *pos;
+    size_t len;
+    bool skip_value;
+
+    *done = false;
+    if (!_sysparam_compact.copying) {
+        if (_sysparam_compact.erased < num_sectors - 1) {
+            status = _erase_sector(_sysparam_info.alt_base + (num_sectors - 1 - _sysparam_compact.erased) * sdk_flashchip.sector_size);
+            if (status < 0) return status;
+            _sysparam_compact.erased++;
+            return SYSPARAM_OK;
+        }
+        status = _erase_sector(_sysparam_info.alt_base);
+        if (status < 0) return status;
+        _sysparam_compact.erased = num_sectors;
+        status = sysparam_iter_start(iter);
+        if (status < 0) return status;
+        _sysparam_compact.copying = true;
+        _sysparam_compact.addr = _sysparam_info.alt_base + REGION_HEADER_SIZE;
+        _sysparam_compact.key_id = 0;
+        _sysparam_compact.copied_id = 0;
+        return SYSPARAM_OK;
+    }
+
+    status = sysparam_iter_next(iter);
+    if (status == SYSPARAM_NOTFOUND) {
+        if (key_id && *key_id >= 0 && !_sysparam_compact.remapped) {
+            status = _compact_keep_key(key_id);
+            if (status < 0) goto failed;
+        }
+        status = _compact_switch();
+        if (status < 0) goto failed;
+        *done = true;
+        return SYSPARAM_OK;
+    }
+    if (status < 0) goto failed;
+
+    old_id = iter->ctx->entry.idflags & ENTRY_MASK_ID;
+    _sysparam_compact.copied_id = old_id;
+    _sysparam_compact.key_id++;
+    // Don't copy the value of the key being written, since it will be
+    // replaced as soon as the compaction is done
+    skip_value = key_id && *key_id == old_id;
+    len = ENTRY_SIZE(iter->key_len);
+    if (!skip_value) {
+        len += ENTRY_SIZE(iter->value_len);
+    }
+    status = _compact_reserve(len);
+    if (status < 0) goto failed;
+
+    debug(2, "copying key %d as %d @ 0x%08x", old_id, _sysparam_compact.key_id, _sysparam_compact.addr);
+    pos = _sysparam_compact.buf;
+    header.idflags = _sysparam_compact.key_id | ENTRY_FLAG_ALIVE;
+    header.len = iter->key_len;
+    memcpy(pos, &header, ENTRY_HEADER_SIZE);
+    memcpy(pos + ENTRY_HEADER_SIZE, iter->key, iter->key_len);
+    pos += ENTRY_SIZE(iter->key_len);
+    if (skip_value) {
+        *key_id = _sysparam_compact.key_id;
+        _sysparam_compact.remapped = true;
+    } else {
+        header.idflags = _sysparam_compact.key_id | ENTRY_FLAG_ALIVE | ENTRY_FLAG_VALUE | (iter->binary ? ENTRY_FLAG_BINARY : 0);
+        header.len = iter->value_len;
+        memcpy(pos, &header, ENTRY_HEADER_SIZE);
+        memcpy(pos + ENTRY_HEADER_SIZE, iter->value, iter->value_len);
+    }
+    status = _compact_write(len);
+    if (status < 0) goto failed;
+    return SYSPARAM_OK;
+
+ failed:
+    debug(1, "error encountered during compacting (%d)", status);
+    _compact_drop();
+    return status;
+}
+
 /** Compact the current region, removing all deleted/unused entries, and write
  *  the result to the alternate region, then make the new alternate region the
- *  active one.
+ *  active one.  A compaction started by sysparam_compact_step() is finished
+ *  rather than started over.
  *
  *  @param key_id  A pointer to the "current" key ID, or NULL if none.
  *
@@ -420,79 +984,234 @@ static inline sysparam_status_t _delete_entry(uint32_t addr) {
  *  compacted result as well.
  */
 static sysparam_status_t _compact_params(struct sysparam_context *ctx, int *key_id) {
-    uint32_t new_base = _sysparam_info.alt_base;
     sysparam_status_t status;
-    uint32_t addr = new_base + REGION_HEADER_SIZE;
-    uint16_t current_key_id = 0;
-    sysparam_iter_t iter;
-    uint16_t binary_flag;
-    uint16_t num_sectors = _sysparam_info.region_size / sdk_flashchip.sector_size;
+    bool done = false;
 
     debug(1, "compacting region (current size %d, expect to recover %d%s bytes)...",
             _sysparam_info.end_addr - _sysparam_info.cur_base,
             ctx ? ctx->compactable : 0,
             (ctx && ctx->unused_keys > 0) ? "+ (unused keys present)" : "");
 
-    status = _format_region(new_base, num_sectors);
-    if (status < 0) return status;
-    status = sysparam_iter_start(&iter);
+    if (key_id) {
+        // A background copy may already hold the value being replaced
+        _compact_check_key(*key_id);
+    }
+    _sysparam_compact.remapped = false;
+    while (!done) {
+        status = _compact_next(key_id, &done);
+        if (status < 0) return status;
+    }
+    _sysparam_stats.compactions++;
+
+    if (ctx) {
+        // Fix up ctx so it doesn't point to invalid stuff
+        memset(ctx, 0, sizeof(*ctx));
+        ctx->addr = _sysparam_info.end_addr;
+        ctx->max_key_id = _sysparam_compact.key_id;
+    }
+
+    return SYSPARAM_OK;
+}
+
+/** Bytes a compaction would free, not counting keys without a value */
+static sysparam_status_t _compactable(size_t *result) {
+    struct sysparam_context ctx;
+    sysparam_status_t status;
+
+#if SYSPARAM_INDEX_SIZE > 0
+    if (_sysparam_index.valid) {
+        *result = _sysparam_index.compactable;
+        return SYSPARAM_OK;
+    }
+#endif
+    _init_context(&ctx);
+    status = _find_entry(&ctx, ENTRY_ID_END, false);
     if (status < 0) return status;
+    *result = ctx.compactable;
+    return SYSPARAM_OK;
+}
 
-    while (true) {
-        status = sysparam_iter_next(&iter);
-        if (status != SYSPARAM_OK) break;
+/** Record the duration of a write that started at `start_us` */
+static inline void _record_set_time(uint32_t start_us) {
+    uint32_t elapsed = sdk_system_get_time() - start_us;
 
-        current_key_id++;
+    if (elapsed > _sysparam_stats.set_max_us) {
+        _sysparam_stats.set_max_us = elapsed;
+    }
+}
 
-        // Write the key to the new region
-        debug(2, "writing %d key @ 0x%08x", current_key_id, addr);
-        status = _write_entry(addr, current_key_id, (uint8_t *)iter.key, iter.key_len);
-        if (status < 0) break;
-        addr += ENTRY_SIZE(iter.key_len);
+/********************************* Transactions *******************************/
+
+/* A staged key/value pair in `sysparam_txn_t.buf`, followed by the key and
+ * the value
+ */
+struct txn_record {
+    uint16_t key_len;
+    uint16_t value_len;
+    uint8_t binary;
+} __attribute__ ((packed));
+
+/* What a commit does for one staged record */
+struct txn_plan {
+    struct txn_record rec;
+    const uint8_t *key;
+    const uint8_t *value;
+    int key_id;             // -1 for a new key
+    uint32_t old_value_addr; // Current value, 0 if none
+    uint16_t old_value_len;
+    bool write;             // False if unchanged or staged again later
+};
 
-        if (key_id && (iter.ctx->entry.idflags & ENTRY_MASK_ID) == *key_id) {
-            // Update key_id to have the correct id for the compacted result
-            *key_id = current_key_id;
-            // Don't copy the old value, since we'll just be deleting it
-            // and writing a new one as soon as we return.
+/** Finish committed transactions whose deletes were interrupted
+ *
+ *  Readers take the first live value of a key, so until the values replaced
+ *  by a transaction are deleted they still hide the new ones.  For every
+ *  value (or deleted-value marker) in a pending transaction block, delete the
+ *  live values of that key written before the block, then clear the pending
+ *  flag.
+ */
+static sysparam_status_t _txn_recover(void) {
+    struct sysparam_context ctx;
+    struct entry_header txn, entry;
+    sysparam_status_t status;
+    uint32_t addr = _sysparam_info.cur_base + REGION_HEADER_SIZE;
+    uint32_t nested, txn_end;
+
+#if SYSPARAM_INDEX_SIZE > 0
+    // The index may hold values this deletes
+    _index_invalidate();
+#endif
+    // And so may a background copy
+    if (_sysparam_compact.copying) {
+        _compact_drop();
+        _sysparam_stats.restarts++;
+    }
+    while (addr + ENTRY_HEADER_SIZE <= _sysparam_info.end_addr) {
+        CHECK_FLASH_OP(spiflash_read(addr, (void*) &txn, ENTRY_HEADER_SIZE));
+        if ((txn.idflags & ENTRY_MASK_ID) != ENTRY_ID_TXN ||
+                (txn.idflags & (ENTRY_FLAG_ALIVE | ENTRY_FLAG_INVALID | ENTRY_FLAG_VALUE)) != ENTRY_FLAG_ALIVE) {
+            addr += ENTRY_SIZE(txn.len);
             continue;
         }
-
-        // Copy the value to the new region
-        debug(2, "writing %d value @ 0x%08x", current_key_id, addr);
-        binary_flag = iter.binary ? ENTRY_FLAG_BINARY : 0;
-        status = _write_entry(addr, current_key_id | ENTRY_FLAG_VALUE | binary_flag, iter.value, iter.value_len);
-        if (status < 0) break;
-        addr += ENTRY_SIZE(iter.value_len);
+        if (txn.idflags & ENTRY_FLAG_TXN_PENDING) {
+            debug(1, "finishing transaction @ 0x%08x", addr);
+            txn_end = min(addr + ENTRY_SIZE(txn.len), _sysparam_info.end_addr);
+            for (nested = addr + ENTRY_HEADER_SIZE; nested + ENTRY_HEADER_SIZE <= txn_end; nested += ENTRY_SIZE(entry.len)) {
+                CHECK_FLASH_OP(spiflash_read(nested, (void*) &entry, ENTRY_HEADER_SIZE));
+                if (!(entry.idflags & ENTRY_FLAG_VALUE)) continue;
+                while (true) {
+                    _init_context(&ctx);
+                    status = _find_value(&ctx, entry.idflags);
+                    if (status < 0) return status;
+                    if (status == SYSPARAM_NOTFOUND || ctx.addr > addr) break;
+                    status = _delete_entry(ctx.addr);
+                    if (status < 0) return status;
+                }
+            }
+            txn.idflags &= ~ENTRY_FLAG_TXN_PENDING;
+            status = _write_and_verify(addr, &txn, ENTRY_HEADER_SIZE);
+            if (status < 0) return status;
+        }
+        // The entries of a committed block follow its header
+        addr += ENTRY_HEADER_SIZE;
     }
-    sysparam_iter_end(&iter);
+    _sysparam_info.txn_pending = false;
+    return SYSPARAM_OK;
+}
 
-    // If we broke out with an error, return the error instead of continuing.
-    if (status < 0) {
-        debug(1, "error encountered during compacting (%d)", status);
-        return status;
-    }
+/** Make sure no transaction is half-finished before reading for a write */
+static inline sysparam_status_t _txn_check(void) {
+    return _sysparam_info.txn_pending ? _txn_recover() : SYSPARAM_OK;
+}
 
-    // Switch to officially using the new region.
-    status = _write_region_header(new_base, _sysparam_info.cur_base, true);
-    if (status < 0) return status;
-    status = _write_region_header(_sysparam_info.cur_base, new_base, false);
-    if (status < 0) return status;
+/** Look up every staged key and work out what a commit has to write
+ *
+ *  @param[out] totals     Region totals (compactable, max_key_id,
+ *                         unused_keys) as sysparam_set_data() collects them
+ *  @param[out] block_len  Size of the transaction block, 0 if nothing changes
+ *  @param[out] new_keys   Number of key entries the block adds
+ */
+static sysparam_status_t _txn_plan(struct sysparam_context *totals, struct txn_plan *plan, int count, size_t *block_len, int *new_keys) {
+    struct sysparam_context ctx;
+    struct txn_plan *p;
+    sysparam_status_t status;
+    size_t len = 0;
+    size_t free_space;
+    int i, j;
+#if SYSPARAM_INDEX_SIZE > 0
+    struct index_slot *slot;
+    bool indexed = _sysparam_index.valid;
+#endif
 
-    _sysparam_info.alt_base = _sysparam_info.cur_base;
-    _sysparam_info.cur_base = new_base;
-    _sysparam_info.end_addr = addr;
-    _sysparam_info.force_compact = false;
+    *new_keys = 0;
+    for (i = 0; i < count; i++) {
+        p = &plan[i];
+        p->write = false;
+        p->key_id = -1;
+        p->old_value_addr = 0;
+        // The last value staged for a key wins
+        for (j = i + 1; j < count; j++) {
+            if (plan[j].rec.key_len == p->rec.key_len && !memcmp(plan[j].key, p->key, p->rec.key_len)) break;
+        }
+        if (j < count) continue;
 
-    if (ctx) {
-        // Fix up ctx so it doesn't point to invalid stuff
-        memset(ctx, 0, sizeof(*ctx));
-        ctx->addr = addr;
-        ctx->max_key_id = current_key_id;
-    }
+        _init_context(&ctx);
+#if SYSPARAM_INDEX_SIZE > 0
+        if (indexed) {
+            status = _index_find_key(&ctx, (const char *)p->key, p->rec.key_len, _hash_key((const char *)p->key, p->rec.key_len), &slot);
+            if (slot) {
+                p->key_id = slot->key_id;
+            }
+        } else
+#endif
+        {
+            status = _find_key(&ctx, (const char *)p->key, p->rec.key_len);
+            if (status == SYSPARAM_OK) {
+                p->key_id = ctx.entry.idflags & ENTRY_MASK_ID;
+                status = _find_value(&ctx, p->key_id);
+            }
+        }
+        if (status < 0) return status;
 
-    debug(1, "done compacting (current size %d)", _sysparam_info.end_addr - _sysparam_info.cur_base);
+        if (status == SYSPARAM_OK) {
+            p->old_value_addr = ctx.addr;
+            p->old_value_len = ctx.entry.len;
+            if (ctx.entry.len == p->rec.value_len &&
+                    (ctx.entry.idflags & ENTRY_FLAG_BINARY) == (p->rec.binary ? ENTRY_FLAG_BINARY : 0)) {
+                status = _compare_payload(&ctx, (uint8_t *)p->value, p->rec.value_len);
+                if (status < 0) return status;
+                if (status == SYSPARAM_OK) continue; // Unchanged
+            }
+        } else if (!p->rec.value_len) {
+            continue; // Deleting a key that has no value
+        }
 
+        p->write = true;
+        if (p->key_id < 0) {
+            (*new_keys)++;
+            len += ENTRY_SIZE(p->rec.key_len);
+        }
+        // The new value, or for a delete an already-deleted empty value that
+        // tells _txn_recover which key it was
+        len += ENTRY_SIZE(p->rec.value_len);
+    }
+    *block_len = len ? ENTRY_SIZE(len) : 0;
+
+    _init_context(totals);
+#if SYSPARAM_INDEX_SIZE > 0
+    if (indexed) {
+        totals->compactable = _sysparam_index.compactable;
+        totals->max_key_id = _sysparam_index.max_key_id;
+        totals->unused_keys = _index_unused_keys();
+        return SYSPARAM_OK;
+    }
+#endif
+    // Only a new key id or a compaction needs a scan of the whole region
+    free_space = _sysparam_info.cur_base + _sysparam_info.region_size - _sysparam_info.end_addr;
+    if (*new_keys || *block_len > free_space) {
+        status = _find_entry(totals, ENTRY_ID_END, false);
+        if (status < 0) return status;
+    }
     return SYSPARAM_OK;
 }
 
@@ -549,8 +1268,9 @@ sysparam_status_t sysparam_init(uint32_t base_addr, uint32_t top_addr) {
             debug(2, "Found active region header @ 0x%08x but no stale region @ 0x%08x. Trying to recreate stale region.", addr0, addr1);
             status = _format_region(addr1, num_sectors);
             if (status != SYSPARAM_OK) return status;
-            status = _write_region_header(addr1, addr0, false);
+            status = _write_region_header(addr1, addr0, false, 0);
             if (status != SYSPARAM_OK) return status;
+            header1.cycles = 0;
         } else {
             // Found the stale one.  We have no idea how old it is, so we shouldn't use it without some sort of confirmation/recovery.  We'll have to bail for now.
             debug(1, "Found stale-region header @ 0x%08x, but no active region.", addr0);
@@ -563,17 +1283,27 @@ sysparam_status_t sysparam_init(uint32_t base_addr, uint32_t top_addr) {
     if (header0.flags_size & REGION_FLAG_ACTIVE) {
         _sysparam_info.cur_base = addr0;
         _sysparam_info.alt_base = addr1;
+        _sysparam_info.cur_cycles = header0.cycles;
+        _sysparam_info.alt_cycles = header1.cycles;
         debug(3, "Active region @ 0x%08x (0x%04x).  Stale region @ 0x%08x (0x%04x).", addr0, header0.flags_size, addr1, header1.flags_size);
 
     } else {
         _sysparam_info.cur_base = addr1;
         _sysparam_info.alt_base = addr0;
+        _sysparam_info.cur_cycles = header1.cycles;
+        _sysparam_info.alt_cycles = header0.cycles;
         debug(3, "Active region @ 0x%08x (0x%04x).  Stale region @ 0x%08x (0x%04x).", addr1, header1.flags_size, addr0, header0.flags_size);
     }
 
     // Find the actual end
     _sysparam_info.end_addr = _sysparam_info.cur_base + _sysparam_info.region_size;
     _sysparam_info.force_compact = false;
+    _sysparam_info.txn_pending = false;
+    // Nothing is known about the stale region; blank sectors are not erased
+    // again, though
+    _compact_release();
+    _sysparam_compact.erased = 0;
+    memset(&_sysparam_stats, 0, sizeof(_sysparam_stats));
     _init_context(&ctx);
     status = _find_entry(&ctx, ENTRY_ID_END, false);
     if (status < 0) {
@@ -586,6 +1316,27 @@ sysparam_status_t sysparam_init(uint32_t base_addr, uint32_t top_addr) {
         _sysparam_info.end_addr = ctx.addr;
     }
 
+    // A reset during sysparam_txn_commit() may have left replaced values
+    // alive.  Reads do not finish the transaction, so until it is done they
+    // could see old and new values mixed: fail and leave the area
+    // uninitialized, as for a scan error.
+    status = _txn_check();
+    if (status != SYSPARAM_OK) {
+        debug(1, "could not finish transaction (%d)", status);
+        _sysparam_info.cur_base = 0;
+        _sysparam_info.alt_base = 0;
+        _sysparam_info.end_addr = 0;
+        return status;
+    }
+
+#if SYSPARAM_INDEX_SIZE > 0
+    // The index only speeds up lookups: if it cannot be built, they scan
+    status = _index_build();
+    if (status != SYSPARAM_OK) {
+        debug(1, "could not build index (%d)", status);
+    }
+#endif
+
     return SYSPARAM_OK;
 }
 
@@ -623,14 +1374,18 @@ sysparam_status_t sysparam_create_area(uint32_t base_addr, uint16_t num_sectors,
         // De-initialize everything to force the caller to do a clean
         // `sysparam_init()` afterwards.
         memset(&_sysparam_info, 0, sizeof(_sysparam_info));
+        _compact_release();
+#if SYSPARAM_INDEX_SIZE > 0
+        _index_invalidate();
+#endif
     }
     status = _format_region(base_addr, num_sectors);
     if (status < 0) return status;
     status = _format_region(base_addr + region_size, num_sectors);
     if (status < 0) return status;
-    status = _write_region_header(base_addr, base_addr + region_size, true);
+    status = _write_region_header(base_addr, base_addr + region_size, true, 0);
     if (status < 0) return status;
-    status = _write_region_header(base_addr + region_size, base_addr, false);
+    status = _write_region_header(base_addr + region_size, base_addr, false, 0);
     if (status < 0) return status;
 
     return SYSPARAM_OK;
@@ -649,7 +1404,10 @@ sysparam_status_t sysparam_compact() {
     sysparam_status_t status;
 
     if (_sysparam_info.cur_base) {
-        status = _compact_params(NULL, NULL);
+        status = _txn_check();
+        if (status == SYSPARAM_OK) {
+            status = _compact_params(NULL, NULL);
+        }
     } else {
         status = SYSPARAM_ERR_NOINIT;
     }
@@ -658,6 +1416,67 @@ sysparam_status_t sysparam_compact() {
     return status;
 }
 
+sysparam_status_t sysparam_compact_step(size_t threshold, uint32_t slice_us) {
+    uint32_t start_us = sdk_system_get_time();
+    uint32_t elapsed;
+    sysparam_status_t status;
+    size_t compactable;
+    bool done;
+
+    xSemaphoreTake(_sysparam_info.sem, portMAX_DELAY);
+
+    if (!_sysparam_info.cur_base) {
+        xSemaphoreGive(_sysparam_info.sem);
+        return SYSPARAM_ERR_NOINIT;
+    }
+    status = _txn_check();
+    while (status == SYSPARAM_OK) {
+        if (!_sysparam_compact.copying && _sysparam_compact.erased >= _region_sectors() - 1 && !_sysparam_info.force_compact) {
+            // Only the first sector is left to erase, which starts the copy
+            status = _compactable(&compactable);
+            if (status < 0) break;
+            if (!compactable || compactable < threshold) {
+                status = SYSPARAM_NOTFOUND;
+                break;
+            }
+            debug(1, "starting background compaction (%d bytes compactable)", compactable);
+        }
+        status = _compact_next(NULL, &done);
+        if (done) {
+            _sysparam_stats.background_compactions++;
+        }
+        if (sdk_system_get_time() - start_us >= slice_us) break;
+    }
+
+    elapsed = sdk_system_get_time() - start_us;
+    if (elapsed > _sysparam_stats.step_max_us) {
+        _sysparam_stats.step_max_us = elapsed;
+    }
+    xSemaphoreGive(_sysparam_info.sem);
+    return status;
+}
+
+sysparam_status_t sysparam_get_stats(sysparam_stats_t *stats) {
+    sysparam_status_t status;
+    bool lower;
+
+    xSemaphoreTake(_sysparam_info.sem, portMAX_DELAY);
+
+    if (!_sysparam_info.cur_base) {
+        xSemaphoreGive(_sysparam_info.sem);
+        return SYSPARAM_ERR_NOINIT;
+    }
+    *stats = _sysparam_stats;
+    lower = _sysparam_info.cur_base < _sysparam_info.alt_base;
+    stats->region_cycles[0] = lower ? _sysparam_info.cur_cycles : _sysparam_info.alt_cycles;
+    stats->region_cycles[1] = lower ? _sysparam_info.alt_cycles : _sysparam_info.cur_cycles;
+    stats->free = _sysparam_info.cur_base + _sysparam_info.region_size - _sysparam_info.end_addr;
+    status = _compactable(&stats->compactable);
+
+    xSemaphoreGive(_sysparam_info.sem);
+    return status;
+}
+
 sysparam_status_t sysparam_get_data(const char *key, uint8_t **destptr, size_t *actual_length, bool *is_binary) {
     struct sysparam_context ctx;
     sysparam_status_t status;
@@ -674,11 +1493,7 @@ sysparam_status_t sysparam_get_data(const char *key, uint8_t **destptr, size_t *
     }
 
     _init_context(&ctx);
-    status = _find_key(&ctx, key, key_len);
-    if (status != SYSPARAM_OK) goto done;
-
-    // Find the associated value
-    status = _find_value(&ctx, ctx.entry.idflags);
+    status = _find_key_value(&ctx, key, key_len);
     if (status != SYSPARAM_OK) goto done;
 
     buffer = malloc(ctx.entry.len + 1);
@@ -723,9 +1538,7 @@ sysparam_status_t sysparam_get_data_static(const char *key, uint8_t *dest, size_
     }
 
     _init_context(&ctx);
-    status = _find_key(&ctx, key, key_len);
-    if (status != SYSPARAM_OK) goto done;
-    status = _find_value(&ctx, ctx.entry.idflags);
+    status = _find_key_value(&ctx, key, key_len);
     if (status != SYSPARAM_OK) goto done;
     status = _read_payload(&ctx, dest, dest_size);
     if (status != SYSPARAM_OK) goto done;
@@ -847,6 +1660,12 @@ sysparam_status_t sysparam_set_data(const char *key, const uint8_t *value, size_
     int key_id = -1;
     uint32_t old_value_addr = 0;
     uint16_t binary_flag;
+    bool indexed = false;
+    uint32_t start_us = sdk_system_get_time();
+#if SYSPARAM_INDEX_SIZE > 0
+    struct index_slot *slot;
+    uint16_t hash = _hash_key(key, key_len);
+#endif
 
     if (!key_len) return SYSPARAM_ERR_BADVALUE;
     if (key_len > MAX_KEY_LEN) return SYSPARAM_ERR_BADVALUE;
@@ -862,17 +1681,37 @@ sysparam_status_t sysparam_set_data(const char *key, const uint8_t *value, size_
         status = SYSPARAM_ERR_NOINIT;
         goto done;
     }
+    status = _txn_check();
+    if (status < 0) goto done;
 
     do {
         _init_context(&ctx);
-        status = _find_key(&ctx, key, key_len);
-        if (status == SYSPARAM_OK) {
-            // Key already exists, see if there's a current value.
-            key_id = ctx.entry.idflags & ENTRY_MASK_ID;
-            status = _find_value(&ctx, key_id);
+#if SYSPARAM_INDEX_SIZE > 0
+        indexed = _sysparam_index.valid;
+        if (indexed) {
+            status = _index_find_key(&ctx, key, key_len, hash, &slot);
+            if (slot) {
+                key_id = slot->key_id;
+            }
             if (status == SYSPARAM_OK) {
                 old_value_addr = ctx.addr;
             }
+            // Totals a scan to the end of the region would have collected
+            ctx.compactable = _sysparam_index.compactable;
+            ctx.max_key_id = _sysparam_index.max_key_id;
+            ctx.unused_keys = _index_unused_keys();
+        } else
+#endif
+        {
+            status = _find_key(&ctx, key, key_len);
+            if (status == SYSPARAM_OK) {
+                // Key already exists, see if there's a current value.
+                key_id = ctx.entry.idflags & ENTRY_MASK_ID;
+                status = _find_value(&ctx, key_id);
+                if (status == SYSPARAM_OK) {
+                    old_value_addr = ctx.addr;
+                }
+            }
         }
         if (status < 0) break;
 
@@ -912,8 +1751,11 @@ sysparam_status_t sysparam_set_data(const char *key, const uint8_t *value, size_
             if (needed_space > free_space) {
                 // Can we compact things?
                 // First, scan all remaining entries up to the end so we can
-                // get a reasonably accurate "compactable" reading.
-                _find_entry(&ctx, ENTRY_ID_END, false);
+                // get a reasonably accurate "compactable" reading (the index
+                // already has it).
+                if (!indexed) {
+                    _find_entry(&ctx, ENTRY_ID_END, false);
+                }
                 if (needed_space <= free_space + ctx.compactable) {
                     // We should be able to get enough space by compacting.
                     status = _compact_params(&ctx, &key_id);
@@ -966,6 +1808,7 @@ sysparam_status_t sysparam_set_data(const char *key, const uint8_t *value, size_
                 if (status < 0) break;
             }
 
+            _compact_check_key(key_id);
             init_write_context(&write_ctx);
 
             if (key_id < 0) {
@@ -973,26 +1816,46 @@ sysparam_status_t sysparam_set_data(const char *key, const uint8_t *value, size_
                 key_id = ctx.max_key_id + 1;
                 status = _write_entry(write_ctx.addr, key_id, (uint8_t *)key, key_len);
                 if (status < 0) break;
+#if SYSPARAM_INDEX_SIZE > 0
+                _index_add_key(key_id, write_ctx.addr, key_len, hash);
+#endif
                 write_ctx.addr += ENTRY_SIZE(key_len);
             }
 
             // Write new value
             status = _write_entry(write_ctx.addr, key_id | ENTRY_FLAG_VALUE | binary_flag, value, value_len);
             if (status < 0) break;
+#if SYSPARAM_INDEX_SIZE > 0
+            _index_set_value(key_id, write_ctx.addr, key_id | ENTRY_FLAG_ALIVE | ENTRY_FLAG_VALUE | binary_flag, value_len);
+#endif
             write_ctx.addr += ENTRY_SIZE(value_len);
             _sysparam_info.end_addr = write_ctx.addr;
         }
 
         // Delete old value (if present) by clearing its "alive" flag
         if (old_value_addr) {
+            _compact_check_key(key_id);
             status = _delete_entry(old_value_addr);
             if (status < 0) break;
+#if SYSPARAM_INDEX_SIZE > 0
+            _sysparam_index.compactable += ENTRY_SIZE(ctx.entry.len);
+            if (!value_len) {
+                _index_set_value(key_id, 0, 0, 0);
+            }
+#endif
         }
 
         debug(1, "New addr is 0x%08x (%d bytes remaining)", _sysparam_info.end_addr, _sysparam_info.cur_base + _sysparam_info.region_size - _sysparam_info.end_addr);
     } while (false);
 
  done:
+#if SYSPARAM_INDEX_SIZE > 0
+    if (status < 0 && status != SYSPARAM_ERR_FULL) {
+        // A failed write may have left entries the index does not know about
+        _index_invalidate();
+    }
+#endif
+    _record_set_time(start_us);
     xSemaphoreGive(_sysparam_info.sem);
 
     return status;
@@ -1103,3 +1966,240 @@ void sysparam_iter_end(sysparam_iter_t *iter) {
     if (iter->ctx) free(iter->ctx);
 }
 
+sysparam_status_t sysparam_txn_begin(sysparam_txn_t *txn) {
+    memset(txn, 0, sizeof(*txn));
+    return SYSPARAM_OK;
+}
+
+sysparam_status_t sysparam_txn_set_data(sysparam_txn_t *txn, const char *key, const uint8_t *value, size_t value_len, bool binary) {
+    struct txn_record rec;
+    size_t key_len = strlen(key);
+    size_t required_len, flash_len;
+    uint8_t *newbuf;
+
+    if (txn->status != SYSPARAM_OK) return txn->status;
+    if (!value) value_len = 0;
+
+    // At most a new key entry and a value entry, all inside one block entry
+    flash_len = txn->flash_len + ENTRY_SIZE(key_len) + ENTRY_SIZE(value_len);
+    if (!key_len || key_len > MAX_KEY_LEN || value_len > MAX_VALUE_LEN || flash_len > MAX_VALUE_LEN) {
+        txn->status = SYSPARAM_ERR_BADVALUE;
+        return txn->status;
+    }
+
+    required_len = txn->len + sizeof(rec) + key_len + value_len;
+    if (required_len > txn->bufsize) {
+        newbuf = realloc(txn->buf, max(required_len, 2 * txn->bufsize));
+        if (!newbuf) {
+            txn->status = SYSPARAM_ERR_NOMEM;
+            return txn->status;
+        }
+        txn->buf = newbuf;
+        txn->bufsize = max(required_len, 2 * txn->bufsize);
+    }
+    rec.key_len = key_len;
+    rec.value_len = value_len;
+    rec.binary = binary;
+    memcpy(txn->buf + txn->len, &rec, sizeof(rec));
+    memcpy(txn->buf + txn->len + sizeof(rec), key, key_len);
+    if (value_len) {
+        memcpy(txn->buf + txn->len + sizeof(rec) + key_len, value, value_len);
+    }
+    txn->len = required_len;
+    txn->flash_len = flash_len;
+    txn->count++;
+    return SYSPARAM_OK;
+}
+
+sysparam_status_t sysparam_txn_set_string(sysparam_txn_t *txn, const char *key, const char *value) {
+    return sysparam_txn_set_data(txn, key, (const uint8_t *)value, strlen(value), false);
+}
+
+sysparam_status_t sysparam_txn_set_int32(sysparam_txn_t *txn, const char *key, int32_t value) {
+    return sysparam_txn_set_data(txn, key, (const uint8_t *)&value, sizeof(value), true);
+}
+
+sysparam_status_t sysparam_txn_set_int8(sysparam_txn_t *txn, const char *key, int8_t value) {
+    return sysparam_txn_set_data(txn, key, (const uint8_t *)&value, sizeof(value), true);
+}
+
+sysparam_status_t sysparam_txn_commit(sysparam_txn_t *txn) {
+    struct sysparam_context ctx;
+    struct txn_plan *plan = NULL;
+    struct txn_plan *p;
+    struct entry_header header, txn_header;
+    sysparam_status_t status = txn->status;
+    uint8_t *block = NULL;
+    uint8_t *pos;
+    uint32_t addr;
+    size_t block_len, free_space;
+    int i, new_keys, next_key_id;
+    bool compacted = false;
+    uint32_t start_us = sdk_system_get_time();
+
+    if (status != SYSPARAM_OK || !txn->count) {
+        sysparam_txn_abort(txn);
+        return status;
+    }
+    plan = malloc(txn->count * sizeof(*plan));
+    if (!plan) {
+        sysparam_txn_abort(txn);
+        return SYSPARAM_ERR_NOMEM;
+    }
+    pos = txn->buf;
+    for (i = 0; i < txn->count; i++) {
+        memcpy(&plan[i].rec, pos, sizeof(struct txn_record));
+        plan[i].key = pos + sizeof(struct txn_record);
+        plan[i].value = plan[i].key + plan[i].rec.key_len;
+        pos = (uint8_t *)plan[i].value + plan[i].rec.value_len;
+    }
+
+    debug(1, "committing %d staged values", txn->count);
+
+    xSemaphoreTake(_sysparam_info.sem, portMAX_DELAY);
+
+    if (!_sysparam_info.cur_base) {
+        status = SYSPARAM_ERR_NOINIT;
+        goto done;
+    }
+    status = _txn_check();
+    if (status < 0) goto done;
+
+    // Make room first, with at most one compaction, so that nothing is
+    // written unless the whole block fits
+    while (true) {
+        status = _txn_plan(&ctx, plan, txn->count, &block_len, &new_keys);
+        if (status < 0) goto done;
+        if (!block_len) {
+            debug(1, "nothing to change");
+            status = SYSPARAM_OK;
+            goto done;
+        }
+        free_space = _sysparam_info.cur_base + _sysparam_info.region_size - _sysparam_info.end_addr;
+        if (!_sysparam_info.force_compact && block_len <= free_space && ctx.max_key_id + new_keys <= MAX_KEY_ID) {
+            break;
+        }
+        if (compacted || (!_sysparam_info.force_compact && block_len > free_space + ctx.compactable && ctx.unused_keys <= 0)) {
+            debug(1, "region full (need %d of %d remaining)", block_len, free_space);
+            status = SYSPARAM_ERR_FULL;
+            goto done;
+        }
+        // Key ids and value addresses change, so plan again afterwards
+        status = _compact_params(NULL, NULL);
+        if (status < 0) goto done;
+        compacted = true;
+    }
+
+    block = malloc(block_len);
+    if (!block) {
+        status = SYSPARAM_ERR_NOMEM;
+        goto done;
+    }
+    for (i = 0; i < txn->count; i++) {
+        if (plan[i].write) {
+            _compact_check_key(plan[i].key_id);
+        }
+    }
+    addr = _sysparam_info.end_addr;
+    next_key_id = ctx.max_key_id;
+    pos = block + ENTRY_HEADER_SIZE;
+    for (i = 0; i < txn->count; i++) {
+        p = &plan[i];
+        if (!p->write) continue;
+        if (p->key_id < 0) {
+            p->key_id = ++next_key_id;
+            header.idflags = p->key_id | ENTRY_FLAG_ALIVE;
+            header.len = p->rec.key_len;
+            memcpy(pos, &header, ENTRY_HEADER_SIZE);
+            memcpy(pos + ENTRY_HEADER_SIZE, p->key, p->rec.key_len);
+#if SYSPARAM_INDEX_SIZE > 0
+            _index_add_key(p->key_id, addr + (pos - block), p->rec.key_len, _hash_key((const char *)p->key, p->rec.key_len));
+#endif
+            pos += ENTRY_SIZE(p->rec.key_len);
+        }
+        if (p->rec.value_len) {
+            header.idflags = p->key_id | ENTRY_FLAG_ALIVE | ENTRY_FLAG_VALUE | (p->rec.binary ? ENTRY_FLAG_BINARY : 0);
+        } else {
+            header.idflags = p->key_id | ENTRY_FLAG_VALUE;
+        }
+        header.len = p->rec.value_len;
+        memcpy(pos, &header, ENTRY_HEADER_SIZE);
+        memcpy(pos + ENTRY_HEADER_SIZE, p->value, p->rec.value_len);
+#if SYSPARAM_INDEX_SIZE > 0
+        if (p->rec.value_len) {
+            _index_set_value(p->key_id, addr + (pos - block), header.idflags, header.len);
+        } else {
+            _index_set_value(p->key_id, 0, 0, 0);
+        }
+#endif
+        pos += ENTRY_SIZE(p->rec.value_len);
+    }
+    txn_header.idflags = ENTRY_ID_TXN | ENTRY_FLAG_ALIVE | ENTRY_FLAG_INVALID | ENTRY_FLAG_TXN_PENDING;
+    txn_header.len = block_len - ENTRY_HEADER_SIZE;
+    memcpy(block, &txn_header, ENTRY_HEADER_SIZE);
+
+    debug(2, "writing transaction block (%d bytes) @ 0x%08x", block_len, addr);
+    status = _write_block_and_verify(addr, block, block_len);
+    // Whatever reached the flash, later entries go after the block
+    _sysparam_info.end_addr = addr + block_len;
+    if (status < 0) {
+        // The block is still invalid, but its header may not be intact: have
+        // the next write compact it away
+        _sysparam_info.force_compact = true;
+        goto done;
+    }
+
+    // The commit: from here on the new values are the stored ones
+    debug(3, "set transaction valid @ 0x%08x", addr);
+    txn_header.idflags &= ~ENTRY_FLAG_INVALID;
+    status = _write_and_verify(addr, &txn_header, ENTRY_HEADER_SIZE);
+    if (status < 0) {
+        _sysparam_info.force_compact = true;
+        goto done;
+    }
+
+    _sysparam_info.txn_pending = true;
+    for (i = 0; i < txn->count; i++) {
+        p = &plan[i];
+        if (!p->write || !p->old_value_addr) continue;
+        status = _delete_entry(p->old_value_addr);
+        if (status < 0) goto done;
+#if SYSPARAM_INDEX_SIZE > 0
+        _sysparam_index.compactable += ENTRY_SIZE(p->old_value_len);
+#endif
+    }
+#if SYSPARAM_INDEX_SIZE > 0
+    // The block header and the deleted-value markers
+    _sysparam_index.compactable += ENTRY_HEADER_SIZE;
+    for (i = 0; i < txn->count; i++) {
+        if (plan[i].write && !plan[i].rec.value_len) {
+            _sysparam_index.compactable += ENTRY_SIZE(0);
+        }
+    }
+#endif
+    txn_header.idflags &= ~ENTRY_FLAG_TXN_PENDING;
+    status = _write_and_verify(addr, &txn_header, ENTRY_HEADER_SIZE);
+    if (status < 0) goto done;
+    _sysparam_info.txn_pending = false;
+
+    debug(1, "New addr is 0x%08x (%d bytes remaining)", _sysparam_info.end_addr, _sysparam_info.cur_base + _sysparam_info.region_size - _sysparam_info.end_addr);
+
+ done:
+#if SYSPARAM_INDEX_SIZE > 0
+    if (status < 0 && status != SYSPARAM_ERR_FULL && status != SYSPARAM_ERR_NOMEM) {
+        // The index may describe entries that did not reach the flash
+        _index_invalidate();
+    }
+#endif
+    _record_set_time(start_us);
+    xSemaphoreGive(_sysparam_info.sem);
+    free(block);
+    free(plan);
+    sysparam_txn_abort(txn);
+    return status;
+}
+
+void sysparam_txn_abort(sysparam_txn_t *txn) {
+    if (txn->buf) free(txn->buf);
+    memset(txn, 0, sizeof(*txn));
+}
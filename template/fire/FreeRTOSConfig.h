@@ -10,6 +10,30 @@
 /* Blink doesn't really need a lot of stack space! */
 #define configMINIMAL_STACK_SIZE 128
 
+/* Tasks, timers and mutexes of the app use static memory (fire_rtos.h), so the
+   heap left at steady state does not depend on allocation order. Build with
+   EXTRA_CFLAGS=-DconfigSUPPORT_STATIC_ALLOCATION=0 to take them from the heap. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION 1
+#endif
+
+/* Standby: when every task is blocked the idle task sleeps until the next
+   interrupt (fire_power.h). The tick keeps running, so this only borrows the
+   tickless idle hook to learn how long the CPU will stay idle. Build with
+   EXTRA_CFLAGS=-DFIRE_POWER_SAVE=0 to keep the CPU spinning in idle. */
+#ifndef FIRE_POWER_SAVE
+#define FIRE_POWER_SAVE 1
+#endif
+#if FIRE_POWER_SAVE
+#define configUSE_TICKLESS_IDLE 1
+void fire_power_idle(uint32_t expected_idle_ticks);
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) fire_power_idle(xExpectedIdleTime)
+#endif
+
+/* The timer service task runs the task health supervisor (fire_health.h): it
+   goes first whenever it is ready together with an application task. */
+#define configTIMER_TASK_PRIORITY ( tskIDLE_PRIORITY + 6 )
+
 /* Use the defaults for everything else */
 #include_next<FreeRTOSConfig.h>
 
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include "espressif/esp_common.h"
@@ -6,8 +7,28 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "timers.h"
 #include "esp/gpio.h"
 #include "led_manager.h"
+#include "fire_clock.h"
+#include "isr_ring.h"
+#include "fire_fsm.h"
+#include "fire_zones.h"
+#include "i2c/i2c.h"
+#include "pcf8574/pcf8574.h"
+#include "ads111x/ads111x.h"
+#include "sim_probe.h"
+#include "sim_rawprobe.h"
+#include "fire_notify.h"
+#include "fire_journal.h"
+#include "fire_trace.h"
+#include "fire_rtos.h"
+#include "fire_power.h"
+#include "fire_health.h"
+#include "fire_smoke.h"
+#include "fire_fusion.h"
+#include "fire_config.h"
+#include "lwip/tcpip.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
@@ -18,208 +39,875 @@
 // Định nghĩa macro DEBUG (1 = bật debug, 0 = tắt debug)
 #define DEBUG 1
 
-// Định nghĩa chân GPIO
-#define FIRE_SENSOR_PIN 12  // GPIO 12: Tín hiệu báo cháy
+// Định nghĩa chân GPIO (chân vùng 0 có thể đổi bằng fire.sensor.pin)
+#define FIRE_SENSOR_PIN 12  // GPIO 12: Tín hiệu báo cháy (vùng 0)
 #define SIM_STATUS_PIN  13  // GPIO 13: LED trạng thái SIM
 
+// Số PCF8574 mở rộng, mỗi chip thêm 8 vùng báo cháy (0 = chỉ dùng GPIO 12,
+// mặc định: bo mạch thường không có chip này). Khi bật, GPIO 13 (LED trạng
+// thái SIM) thành SDA, GPIO 0 thành SCL, và chân INT (open-drain) của các chip
+// nối chung vào FIRE_EXPANDER_INT_PIN; GPIO 3 (UART RX) được dùng vì console
+// chỉ cần TX.
+#ifndef FIRE_EXPANDER_COUNT
+#define FIRE_EXPANDER_COUNT 0
+#endif
+#define FIRE_I2C_BUS          0
+#define FIRE_I2C_SCL_PIN      0
+#define FIRE_I2C_SDA_PIN      13
+#define FIRE_EXPANDER_INT_PIN 3
+#define FIRE_EXPANDER_ADDR    0x20 // Địa chỉ chip đầu tiên, các chip sau tăng dần
+// Chờ bus I2C tối đa chừng này khi đọc PCF8574; đọc lỗi thì thử lại sau chừng này
+#define FIRE_EXPANDER_RETRY_MS 10
+
+#if FIRE_EXPANDER_COUNT > 6
+#error "At most 6 PCF8574 expanders fit in the 64-bit zone input word"
+#endif
+
+// Cảm biến khói analog (fire_smoke.h): ADC trong chip (chân TOUT, 0-1 V) và
+// ADS111x trên cùng bus I2C với PCF8574. Mỗi kênh là một vùng báo cháy
+#ifndef FIRE_SMOKE_ADC
+#define FIRE_SMOKE_ADC 1
+#endif
+#ifndef FIRE_SMOKE_ADS111X
+#define FIRE_SMOKE_ADS111X 0
+#endif
+#define FIRE_SMOKE_ADS111X_ADDR ADS111X_ADDR_GND
+#define FIRE_SMOKE_COUNT (FIRE_SMOKE_ADC + FIRE_SMOKE_ADS111X)
+// Vị trí của từng cảm biến trong khung mẫu, ADC trong chip trước
+#define FIRE_SMOKE_ADC_CHANNEL     0
+#define FIRE_SMOKE_ADS111X_CHANNEL FIRE_SMOKE_ADC
+// Chu kỳ lấy mẫu; bộ lọc được chỉnh cho 10 Hz (test/traces)
+#define FIRE_SMOKE_SAMPLE_MS 100
+// Kênh phải báo khói liên tục 1 s trước khi báo động và yên 5 s trước khi xóa
+#define FIRE_SMOKE_DEBOUNCE_US 1000000
+#define FIRE_SMOKE_RECOVERY_US 5000000
+// Bit đầu vào của các kênh analog (các bit cao nhất của từ đầu vào)
+#define FIRE_SMOKE_INPUTS (~(UINT64_MAX >> FIRE_SMOKE_COUNT))
+
+// Kết hợp cảm biến khí (fire_fusion.h): BME680, CCS811 và SHT3x trên cùng bus
+// I2C, thăm dò bởi task riêng. Báo động của bộ kết hợp là một vùng analog ngay
+// dưới các kênh khói. Tắt mặc định như ADS111x: bật sẽ dùng GPIO 0/13 cho I2C
+#ifndef FIRE_FUSION
+#define FIRE_FUSION 0
+#endif
+#define FIRE_FUSION_CHANNEL FIRE_SMOKE_COUNT
+#define FIRE_FUSION_INPUT   ((uint64_t)1 << FIRE_ZONES_ANALOG_INPUT(FIRE_FUSION_CHANNEL))
+// Bộ kết hợp đã xác nhận qua nhiều mốc nên debounce ngắn; yên 5 s trước khi xóa
+#define FIRE_FUSION_DEBOUNCE_US 100000
+#define FIRE_FUSION_RECOVERY_US 5000000
+// Bit đầu vào của mọi vùng analog (khói và bộ kết hợp)
+#define FIRE_ANALOG_COUNT  (FIRE_SMOKE_COUNT + FIRE_FUSION)
+#define FIRE_ANALOG_INPUTS (~(UINT64_MAX >> FIRE_ANALOG_COUNT))
+
+#if FIRE_SMOKE_COUNT > FIRE_SMOKE_CHANNELS
+#error "More analog smoke sensors than FIRE_SMOKE_CHANNELS"
+#endif
+#if FIRE_ZONES_GPIO_BITS + 8 * FIRE_EXPANDER_COUNT > FIRE_ZONES_INPUT_BITS - FIRE_ANALOG_COUNT
+#error "The analog zones overlap the last PCF8574 in the zone input word"
+#endif
+
+// Bus I2C cần cho PCF8574, ADS111x hoặc các cảm biến khí (GPIO 13 khi đó là SDA)
+#define FIRE_I2C_USED (FIRE_EXPANDER_COUNT > 0 || FIRE_SMOKE_ADS111X || FIRE_FUSION)
+
 // Cấu hình HTTP GET
 #define WEB_SERVER "httpbin.org"
-#define WEB_PORT "80"
+#define WEB_PORT 80
 #define WEB_PATH "/get"
 
-// Queue để truyền timestamp từ ISR sang task
-static QueueHandle_t fire_queue;
+// 1 = kiểm tra kết nối bằng raw API trong thread tcpip (không cần task riêng),
+// 0 = dùng sim_monitor_task với BSD socket
+#ifndef SIM_MONITOR_RAW
+#define SIM_MONITOR_RAW 1
+#endif
+// Chu kỳ kiểm tra và thời gian chờ sau khi connect thất bại (ms)
+#define SIM_PROBE_PERIOD_MS       5000
+#define SIM_PROBE_RETRY_PERIOD_MS 10000
+
+// Broker MQTT nhận sự kiện báo cháy/phục hồi (QoS 1, phiên bền vững)
+#define FIRE_MQTT_HOST      "test.mosquitto.org"
+#define FIRE_MQTT_PORT      1883
+#define FIRE_MQTT_TOPIC     "fire/events"
+#define FIRE_MQTT_CLIENT_ID "fire-esp8266"
+#define FIRE_MQTT_KEEPALIVE 30
+// Vùng flash chứa sự kiện chưa gửi được khi hàng đợi RAM đầy (dưới vùng sysparam)
+#define FIRE_SPILL_ADDR    0x1f0000
+#define FIRE_SPILL_SECTORS 4
+// Nhật ký lịch sử báo cháy (ghi vòng) ngay dưới vùng sự kiện chờ gửi
+#define FIRE_JOURNAL_ADDR    0x1e8000
+#define FIRE_JOURNAL_SECTORS 8
+// Bản ghi chưa đủ một trang được ghi ra sau khoảng thời gian yên lặng này
+#define FIRE_JOURNAL_FLUSH_MS 5000
+// Chu kỳ gửi histogram độ trễ (nhị phân, xem fire_trace.h) qua UART 0
+#define FIRE_TRACE_DUMP_MS 60000
+// Nén sysparam chạy nền: bắt đầu khi phần cũ thu hồi được từ ngưỡng này, mỗi
+// bước giữ mutex sysparam tối đa một lát (một lần xóa sector 45 ms có thể vượt),
+// nghỉ một tick giữa các bước và nghỉ lâu khi không còn việc
+#define FIRE_SYSPARAM_COMPACT_THRESHOLD 2048
+#define FIRE_SYSPARAM_COMPACT_SLICE_US  5000
+#define FIRE_SYSPARAM_COMPACT_IDLE_MS   10000
+// Thời gian im lặng tối đa của từng task trước khi bộ giám sát leo thang
+// (fire_health.h). Task giám sát báo cháy thức dậy ít nhất mỗi FIRE_HEALTH_BEAT_MS;
+// MQTT có thể chờ backoff 30 s cộng thời gian connect
+#define FIRE_HEALTH_BEAT_MS          1000
+#define FIRE_HEALTH_MONITOR_LIMIT_MS 3000
+#define FIRE_HEALTH_NOTIFY_LIMIT_MS  60000
+#define FIRE_HEALTH_PROBE_LIMIT_MS   20000
+
+// Thời gian tín hiệu báo cháy phải ổn định trước khi báo động (micro giây, khóa fire.zone.debounce_us)
+#define FIRE_DEBOUNCE_US 20000
+// Thời gian tín hiệu phải trở lại bình thường trước khi tắt báo động (micro giây)
+#define FIRE_RECOVERY_US 200000
+
+// Các chân không dùng được cho vùng 0: UART TX, flash SPI (6-11), các LED,
+// I2C/LED trạng thái và chân INT của PCF8574
+#define FIRE_RESERVED_PINS_BASE \
+    (BIT(1) | BIT(6) | BIT(7) | BIT(8) | BIT(9) | BIT(10) | BIT(11) | BIT(LED_BLUE) | BIT(LED_SIM) | \
+     BIT(LED_FAULT) | BIT(LED_FIRE) | BIT(SIM_STATUS_PIN))
+#if FIRE_I2C_USED && FIRE_EXPANDER_COUNT > 0
+#define FIRE_RESERVED_PINS (FIRE_RESERVED_PINS_BASE | BIT(FIRE_I2C_SCL_PIN) | BIT(FIRE_EXPANDER_INT_PIN))
+#elif FIRE_I2C_USED
+#define FIRE_RESERVED_PINS (FIRE_RESERVED_PINS_BASE | BIT(FIRE_I2C_SCL_PIN))
+#else
+#define FIRE_RESERVED_PINS FIRE_RESERVED_PINS_BASE
+#endif
+
+// Các bit thông báo gửi tới fire_monitor_task
+#define FIRE_NOTIFY_EDGE  BIT(0) // ISR đã đẩy sự kiện vào ring
+#define FIRE_NOTIFY_TIMER BIT(1) // Timer debounce/recovery hết hạn
+#define FIRE_NOTIFY_SMOKE  BIT(2) // Timer lấy mẫu đã đẩy mẫu analog vào ring
+#define FIRE_NOTIFY_FUSION BIT(3) // Báo động của bộ kết hợp cảm biến khí đổi trạng thái
+#define FIRE_NOTIFY_EXPANDER BIT(4) // Timer thử lại đọc PCF8574 hết hạn
+
+// Bảng vùng báo cháy: đầu vào, mức tích cực, debounce và recovery
+#define FIRE_EXPANDER_ZONE(n, pin) \
+    { FIRE_ZONES_EXPANDER_INPUT(n, pin), false, FIRE_DEBOUNCE_US, FIRE_RECOVERY_US }
+#define FIRE_EXPANDER_ZONES(n) \
+    FIRE_EXPANDER_ZONE(n, 0), FIRE_EXPANDER_ZONE(n, 1), FIRE_EXPANDER_ZONE(n, 2), \
+    FIRE_EXPANDER_ZONE(n, 3), FIRE_EXPANDER_ZONE(n, 4), FIRE_EXPANDER_ZONE(n, 5), \
+    FIRE_EXPANDER_ZONE(n, 6), FIRE_EXPANDER_ZONE(n, 7)
+
+// Chân vùng 0 và thời gian của các vùng tiếp điểm (GPIO, PCF8574) lấy từ cấu
+// hình khi khởi động, xem fire_apply_config()
+static fire_zone_config_t fire_zone_table[] = {
+    { FIRE_SENSOR_PIN, false, FIRE_DEBOUNCE_US, FIRE_RECOVERY_US },
+#if FIRE_EXPANDER_COUNT > 0
+    FIRE_EXPANDER_ZONES(0),
+#endif
+#if FIRE_EXPANDER_COUNT > 1
+    FIRE_EXPANDER_ZONES(1),
+#endif
+#if FIRE_EXPANDER_COUNT > 2
+    FIRE_EXPANDER_ZONES(2),
+#endif
+#if FIRE_EXPANDER_COUNT > 3
+    FIRE_EXPANDER_ZONES(3),
+#endif
+#if FIRE_EXPANDER_COUNT > 4
+    FIRE_EXPANDER_ZONES(4),
+#endif
+#if FIRE_EXPANDER_COUNT > 5
+    FIRE_EXPANDER_ZONES(5),
+#endif
+#if FIRE_SMOKE_ADC
+    { FIRE_ZONES_ANALOG_INPUT(FIRE_SMOKE_ADC_CHANNEL), true, FIRE_SMOKE_DEBOUNCE_US, FIRE_SMOKE_RECOVERY_US },
+#endif
+#if FIRE_SMOKE_ADS111X
+    { FIRE_ZONES_ANALOG_INPUT(FIRE_SMOKE_ADS111X_CHANNEL), true, FIRE_SMOKE_DEBOUNCE_US, FIRE_SMOKE_RECOVERY_US },
+#endif
+#if FIRE_FUSION
+    { FIRE_ZONES_ANALOG_INPUT(FIRE_FUSION_CHANNEL), true, FIRE_FUSION_DEBOUNCE_US, FIRE_FUSION_RECOVERY_US },
+#endif
+};
+
+#define FIRE_ZONE_COUNT (sizeof(fire_zone_table) / sizeof(fire_zone_table[0]))
+// Vùng tiếp điểm đứng đầu bảng, trước các vùng analog
+#define FIRE_CONTACT_ZONE_COUNT (1 + 8 * FIRE_EXPANDER_COUNT)
+
+// Cấu hình chạy: mặc định biên dịch sẵn, ghi đè bằng các khóa fire.* trong sysparam
+static const fire_config_t fire_config_defaults = {
+    .wifi_ssid = WIFI_SSID,
+    .wifi_pass = WIFI_PASS,
+    .mqtt_host = FIRE_MQTT_HOST,
+    .mqtt_port = FIRE_MQTT_PORT,
+    .mqtt_topic = FIRE_MQTT_TOPIC,
+    .mqtt_client_id = FIRE_MQTT_CLIENT_ID,
+    .mqtt_keepalive_s = FIRE_MQTT_KEEPALIVE,
+    .probe_host = WEB_SERVER,
+    .probe_port = WEB_PORT,
+    .probe_path = WEB_PATH,
+    .sensor_pin = FIRE_SENSOR_PIN,
+    .debounce_us = FIRE_DEBOUNCE_US,
+    .recovery_us = FIRE_RECOVERY_US,
+};
+static fire_config_t fire_config;
 
-// Hàm ISR cho GPIO 12
-void fire_isr_handler(uint8_t gpio_num) {
-    if (gpio_num == FIRE_SENSOR_PIN) {
-        uint32_t now = xTaskGetTickCountFromISR(); // Lấy thời gian từ FreeRTOS
-        xQueueSendToBackFromISR(fire_queue, &now, NULL);
-        // Vô hiệu hóa ngắt ngay trong ISR để chỉ xử lý một lần
-        gpio_set_interrupt(FIRE_SENSOR_PIN, GPIO_INTTYPE_NONE, NULL);
+// Ring lock-free để truyền sự kiện (timestamp CCOUNT + mức GPIO) từ ISR sang task
+static isr_ring_t fire_ring;
+static TaskHandle_t fire_task_handle;
+FIRE_TASK_STORAGE(fire_monitor_task, 512);
+
+// Timer one-shot dùng chung cho debounce và recovery của mọi vùng
+static TimerHandle_t fire_timer;
+FIRE_TIMER_STORAGE(fire_timer);
+
+// Trạng thái của tất cả các vùng (lớn, nên không đặt trên stack của task)
+static fire_zones_t fire_zones;
+
+// Độ trễ đo được từ cạnh cảm biến tới lúc bật LED báo cháy
+static fire_fsm_latency_t fire_latency;
+
+// Lịch sử báo cháy trên flash (chỉ fire_monitor_task truy cập)
+static fire_journal_t fire_journal;
+static bool fire_journal_ready;
+
+// Mức các chân của PCF8574, bit n*8+pin (chỉ task đọc/ghi); mặc định mức nghỉ
+static uint64_t fire_expander_levels = UINT64_MAX;
+#if FIRE_EXPANDER_COUNT > 0
+// Đọc lại PCF8574 sau lỗi I2C: INT giữ mức thấp tới khi cổng được đọc nên không
+// có cạnh nào khác báo thay đổi tiếp theo
+static TimerHandle_t fire_expander_timer;
+FIRE_TIMER_STORAGE(fire_expander);
+#endif
+
+#if FIRE_I2C_USED
+// Mỗi giao dịch trên bus I2C giữ mutex này: fire_monitor_task (PCF8574), timer
+// lấy mẫu (ADS111x) và task cảm biến khí có thể chen vào giữa giao dịch của nhau
+static SemaphoreHandle_t fire_i2c_mutex;
+FIRE_MUTEX_STORAGE(fire_i2c_mutex);
+#endif
+
+// Bit đầu vào của các kênh analog đang báo khói (chỉ task đọc/ghi)
+static uint64_t fire_smoke_levels;
+#if FIRE_SMOKE_COUNT > 0
+// Mẫu analog từ timer lấy mẫu (timer task) sang fire_monitor_task
+static fire_smoke_ring_t fire_smoke_ring;
+static TimerHandle_t fire_smoke_timer;
+FIRE_TIMER_STORAGE(fire_smoke);
+static const fire_smoke_config_t fire_smoke_config[FIRE_SMOKE_COUNT] = {
+#if FIRE_SMOKE_ADC
+    FIRE_SMOKE_TOUT_DEFAULTS,
+#endif
+#if FIRE_SMOKE_ADS111X
+    FIRE_SMOKE_ADS111X_DEFAULTS,
+#endif
+};
+static fire_smoke_channel_t fire_smoke_channels[FIRE_SMOKE_COUNT];
+#if FIRE_SMOKE_ADS111X
+static i2c_dev_t fire_smoke_ads = { .bus = FIRE_I2C_BUS, .addr = FIRE_SMOKE_ADS111X_ADDR };
+#endif
+#endif
+
+#if FIRE_FUSION
+// Báo động của bộ kết hợp, ghi bởi task thăm dò cảm biến khí
+static volatile bool fire_fusion_alarm;
+// Bit đầu vào tương ứng (chỉ fire_monitor_task đọc/ghi)
+static uint64_t fire_fusion_levels;
+#endif
+
+// Bản dump fire_trace đang gửi dở qua UART 0
+static TimerHandle_t fire_trace_timer;
+FIRE_TIMER_STORAGE(fire_trace);
+static uint8_t fire_trace_frame[FIRE_TRACE_FRAME_MAX];
+static size_t fire_trace_len, fire_trace_sent;
+
+// Thay thế handler mặc định của esp_gpio: đọc GPIO.IN một lần cho mọi chân đã
+// kích hoạt ngắt, nên các cạnh đồng thời trên nhiều vùng thành một sự kiện
+void IRAM gpio_interrupt_handler(void *arg)
+{
+    uint32_t status = GPIO.STATUS;
+    GPIO.STATUS_CLEAR = status;
+    fire_power_gpio_wake();
+
+    uint32_t now = fire_clock_cycles(); // Timestamp theo chu kỳ CPU, điểm đo EDGE của fire_trace
+    isr_ring_result_t result = isr_ring_push(&fire_ring, now, status & 0xffff, GPIO.IN & 0xffff);
+    // Chỉ đánh thức task khi nó có thể đang chờ (ring trước đó đã rỗng)
+    if (result == ISR_RING_WAKE && fire_task_handle != NULL) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xTaskNotifyFromISR(fire_task_handle, FIRE_NOTIFY_EDGE, eSetBits, &xHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
     }
 }
 
-// Task giám sát tín hiệu báo cháy (ưu tiên cao)
-static void fire_monitor_task(void *pvParameters)
+static void fire_timer_callback(TimerHandle_t timer)
+{
+    xTaskNotify(fire_task_handle, FIRE_NOTIFY_TIMER, eSetBits);
+}
+
+#if FIRE_EXPANDER_COUNT > 0
+static void fire_expander_timer_callback(TimerHandle_t timer)
 {
-    // Cấu hình GPIO 12 làm input với pull-up
-    gpio_enable(FIRE_SENSOR_PIN, GPIO_INPUT);
-    gpio_set_pullup(FIRE_SENSOR_PIN, true, true);
-    // In trạng thái ban đầu của GPIO 12
+    xTaskNotify(fire_task_handle, FIRE_NOTIFY_EXPANDER, eSetBits);
+}
+
+// Đọc lại cổng của tất cả PCF8574 (đồng thời xóa tín hiệu INT của chúng); bus
+// bận hoặc lỗi thì hẹn fire_expander_timer đọc lại
+static void fire_read_expanders(void)
+{
+    bool failed = false;
+
+    if (xSemaphoreTake(fire_i2c_mutex, pdMS_TO_TICKS(FIRE_EXPANDER_RETRY_MS)) != pdTRUE) {
+        xTimerStart(fire_expander_timer, 0);
+        return;
+    }
+    for (int n = 0; n < FIRE_EXPANDER_COUNT; n++) {
+        i2c_dev_t dev = { .bus = FIRE_I2C_BUS, .addr = FIRE_EXPANDER_ADDR + n };
+        uint8_t port;
+        // Lỗi I2C: giữ mức cũ thay vì coi cả cổng là đang báo cháy
+        if (pcf8574_port_read_buf(&dev, &port, 1) != 1) {
 #ifdef DEBUG
-    printf("Initial state of GPIO %d: %d\n", FIRE_SENSOR_PIN, gpio_read(FIRE_SENSOR_PIN));
+            printf("PCF8574 0x%02x read failed\n", dev.addr);
+#endif
+            failed = true;
+            continue;
+        }
+        fire_expander_levels &= ~((uint64_t)0xff << (8 * n));
+        fire_expander_levels |= (uint64_t)port << (8 * n);
+    }
+    xSemaphoreGive(fire_i2c_mutex);
+    if (failed) {
+        xTimerStart(fire_expander_timer, 0);
+    }
+}
 #endif
-    // Cấu hình interrupt cho GPIO 12 (falling edge)
-    gpio_set_interrupt(FIRE_SENSOR_PIN, GPIO_INTTYPE_EDGE_NEG, fire_isr_handler);
 
-    uint32_t last_interrupt_time = 0;
-    bool led_active = false; // Theo dõi trạng thái LED
+// Ghép GPIO 0-15, cổng các PCF8574 và các vùng analog thành từ đầu vào của bộ xử lý vùng
+static inline uint64_t fire_zone_input(uint16_t gpio_levels)
+{
+    uint64_t input = gpio_levels | ((fire_expander_levels << FIRE_ZONES_GPIO_BITS) & ~FIRE_ANALOG_INPUTS) |
+                     fire_smoke_levels;
+#if FIRE_FUSION
+    input |= fire_fusion_levels;
+#endif
+    return input;
+}
 
-    while (1) {
-        uint32_t interrupt_time;
-        // Chờ nhận dữ liệu từ queue
-        if (xQueueReceive(fire_queue, &interrupt_time, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-            interrupt_time *= portTICK_PERIOD_MS; // Chuyển sang ms
-            // Debounce: Chỉ xử lý nếu cách lần ngắt trước > 200ms
-            if (last_interrupt_time < interrupt_time - 200) {
-#ifdef DEBUG
-                printf("Fire detected on GPIO %d at %u ms!\n", FIRE_SENSOR_PIN, interrupt_time); // Sửa %lu thành %u
+#if FIRE_SMOKE_COUNT > 0
+// Lấy mẫu mọi kênh trong timer task với chu kỳ cố định. Timer task không được
+// chặn: khi task khác đang giữ bus I2C thì bỏ mẫu này, chu kỳ sau lấy lại
+static void fire_smoke_timer_callback(TimerHandle_t timer)
+{
+#if FIRE_SMOKE_ADS111X
+    if (xSemaphoreTake(fire_i2c_mutex, 0) != pdTRUE) {
+        return;
+    }
 #endif
-                // Bật nhấp nháy LED báo cháy
-                set_led_state(FIRE, LED_BLINK, 200);
-                led_active = true;
-                last_interrupt_time = interrupt_time;
-#ifdef DEBUG
-                // In stack high water mark khi có ngắt
-                UBaseType_t stack_high_water_mark = uxTaskGetStackHighWaterMark(NULL);
-                printf("Fire task stack high water mark: %lu words\n", stack_high_water_mark);
+    fire_smoke_sample_t sample = { .ccount = fire_clock_cycles() };
+#if FIRE_SMOKE_ADC
+    sample.value[FIRE_SMOKE_ADC_CHANNEL] = sdk_system_adc_read();
 #endif
-            }
+#if FIRE_SMOKE_ADS111X
+    // Kết quả của lần chuyển đổi bắt đầu ở chu kỳ trước (128 SPS: xong sau 8 ms)
+    sample.value[FIRE_SMOKE_ADS111X_CHANNEL] = ads111x_get_value(&fire_smoke_ads);
+    ads111x_start_conversion(&fire_smoke_ads);
+    xSemaphoreGive(fire_i2c_mutex);
+#endif
+    // Chỉ đánh thức task khi nó đã lọc hết các mẫu trước
+    if (fire_smoke_ring_push(&fire_smoke_ring, &sample) == ISR_RING_WAKE) {
+        xTaskNotify(fire_task_handle, FIRE_NOTIFY_SMOKE, eSetBits);
+    }
+}
+
+static bool fire_smoke_start(void)
+{
+    for (int i = 0; i < FIRE_SMOKE_COUNT; i++) {
+        if (!fire_smoke_init(&fire_smoke_channels[i], &fire_smoke_config[i])) {
+            return false;
         }
+    }
+#if FIRE_SMOKE_ADS111X
+    // Single-shot trên AIN0, dải ±4,096 V cho cảm biến 3,3 V
+    xSemaphoreTake(fire_i2c_mutex, portMAX_DELAY);
+    ads111x_set_input_mux(&fire_smoke_ads, ADS111X_MUX_0_GND);
+    ads111x_set_gain(&fire_smoke_ads, ADS111X_GAIN_4V096);
+    ads111x_set_data_rate(&fire_smoke_ads, ADS111X_DATA_RATE_128);
+    ads111x_set_mode(&fire_smoke_ads, ADS111X_MODE_SINGLE_SHOT);
+    ads111x_start_conversion(&fire_smoke_ads);
+    xSemaphoreGive(fire_i2c_mutex);
+#endif
+    fire_smoke_ring_init(&fire_smoke_ring);
+    fire_smoke_timer = FIRE_TIMER_CREATE(fire_smoke, pdMS_TO_TICKS(FIRE_SMOKE_SAMPLE_MS), pdTRUE,
+                                         fire_smoke_timer_callback);
+    return fire_smoke_timer != NULL && xTimerStart(fire_smoke_timer, 0) == pdPASS;
+}
+
+// Lọc một khung mẫu; khi có kênh đổi trạng thái, từ đầu vào mới được đưa vào
+// bộ xử lý vùng với thời điểm lấy mẫu
+static void fire_smoke_feed(const fire_smoke_sample_t *sample, fire_zones_batch_t *batch)
+{
+    uint64_t levels = 0;
+    for (int i = 0; i < FIRE_SMOKE_COUNT; i++) {
+        if (fire_smoke_update(&fire_smoke_channels[i], sample->value[i])) {
+            levels |= (uint64_t)1 << FIRE_ZONES_ANALOG_INPUT(i);
+        }
+    }
+    if (levels != fire_smoke_levels) {
+        fire_smoke_levels = levels;
+        fire_zones_input(&fire_zones, (fire_zones.last_input & ~FIRE_SMOKE_INPUTS) | levels, sample->ccount, batch);
+    }
+}
+#endif
+
+#if FIRE_FUSION
+// Gọi trong task thăm dò cảm biến khí
+static void fire_fusion_alarm_changed(bool alarm)
+{
+    fire_fusion_alarm = alarm;
+    xTaskNotify(fire_task_handle, FIRE_NOTIFY_FUSION, eSetBits);
+}
+#endif
+
+// Thực hiện kết quả gộp của một lượt xử lý và hẹn lại timer
+static void fire_apply_batch(const fire_zones_batch_t *batch)
+{
+    uint32_t latency_us = 0;
+    uint32_t now = fire_clock_cycles();
 
-        // Kiểm tra trạng thái GPIO 12 để tắt LED khi tín hiệu trở lại mức cao
-        if (gpio_read(FIRE_SENSOR_PIN) == 1 && led_active) {
-            // Tín hiệu cao: Tắt LED và bật lại ngắt
-            set_led_state(FIRE, LED_OFF, 0);
-            gpio_set_interrupt(FIRE_SENSOR_PIN, GPIO_INTTYPE_EDGE_NEG, fire_isr_handler);
-            led_active = false;
+    if (batch->raised) {
+        latency_us = fire_clock_cycles_to_us(now - batch->oldest_edge);
+    }
+    if (batch->raised && fire_zones_alarms(&fire_zones) == batch->raised) {
+        // Vùng đầu tiên báo động: bật nhấp nháy LED báo cháy
+        fire_trace_point(FIRE_TRACE_EDGE, batch->oldest_edge);
+        fire_trace_point(FIRE_TRACE_ALARM, now);
+        set_led_state(FIRE, LED_BLINK, 200);
+        fire_fsm_latency_record(&fire_latency, latency_us);
 #ifdef DEBUG
-            printf("GPIO %d returned to HIGH, LED turned off\n", FIRE_SENSOR_PIN);
-            // In stack high water mark khi trạng thái thay đổi
-            UBaseType_t stack_high_water_mark = uxTaskGetStackHighWaterMark(NULL);
-            printf("Fire task stack high water mark: %lu words\n", stack_high_water_mark);
+        printf("Edge-to-LED latency %u us (min %u, max %u)\n",
+               latency_us, fire_latency.min_us, fire_latency.max_us);
 #endif
+    }
+    if (batch->cleared && fire_zones_alarms(&fire_zones) == 0) {
+        set_led_state(FIRE, LED_OFF, 0);
+    }
+    // Khi có vùng báo động: radio luôn bật và cạnh kế tiếp không phải chờ SDK thoát light sleep
+    if (batch->raised || batch->cleared) {
+        fire_power_hold(FIRE_POWER_HOLD_ALARM, fire_zones_alarms(&fire_zones) != 0);
+    }
+    // Gửi sự kiện ra ngoài; không chờ mạng, thời điểm phát hiện tính từ cạnh GPIO
+    if (batch->raised && !fire_notify_post(FIRE_EVENT_ALARM, batch->raised,
+                                           fire_notify_now_ms() - latency_us / 1000)) {
+        printf("Fire event dropped: outbox full\n");
+    }
+    if (batch->cleared && !fire_notify_post(FIRE_EVENT_RECOVERY, batch->cleared, fire_notify_now_ms())) {
+        printf("Recovery event dropped: outbox full\n");
+    }
+    // Ghi vào bộ đệm RAM của nhật ký; flash chỉ bị ghi khi đủ một trang
+    if (fire_journal_ready) {
+        if (batch->raised) {
+            fire_journal_append(&fire_journal, FIRE_EVENT_ALARM, batch->raised,
+                                fire_notify_now_ms() - latency_us / 1000);
+        }
+        if (batch->cleared) {
+            fire_journal_append(&fire_journal, FIRE_EVENT_RECOVERY, batch->cleared, fire_notify_now_ms());
         }
+    }
+#ifdef DEBUG
+    if (batch->raised || batch->cleared) {
+        printf("Fire zones raised 0x%08x%08x cleared 0x%08x%08x active 0x%08x%08x\n",
+               (uint32_t)(batch->raised >> 32), (uint32_t)batch->raised,
+               (uint32_t)(batch->cleared >> 32), (uint32_t)batch->cleared,
+               (uint32_t)(fire_zones_alarms(&fire_zones) >> 32), (uint32_t)fire_zones_alarms(&fire_zones));
+    }
+#endif
 
-        // Delay để giảm tần suất lặp
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+    uint32_t timeout_us;
+    if (fire_zones_next_timeout(&fire_zones, fire_clock_cycles(), &timeout_us)) {
+        // Làm tròn lên và cộng thêm 1 tick để timer không hết hạn sớm
+        TickType_t ticks = (timeout_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000) + 1;
+        xTimerChangePeriod(fire_timer, ticks, 0);
+    } else {
+        xTimerStop(fire_timer, 0);
     }
 }
 
-// Task kiểm tra trạng thái SIM bằng HTTP GET
-static void sim_monitor_task(void *pvParameters)
+// Task giám sát tín hiệu báo cháy (ưu tiên cao)
+// Mỗi vùng là một máy trạng thái IDLE -> DEBOUNCE -> ALARM -> RECOVERY; task
+// chỉ chạy khi có cạnh GPIO hoặc timer hết hạn và gộp mọi thay đổi thành một batch
+static void fire_monitor_task(void *pvParameters)
 {
-    // Cấu hình GPIO 13 làm output cho LED
-    gpio_enable(SIM_STATUS_PIN, GPIO_OUTPUT);
-    int successes = 0, failures = 0;
+    fire_zones_batch_t batch;
+    uint32_t reported_overflows = 0;
+#if FIRE_SMOKE_COUNT > 0
+    uint32_t reported_smoke_overflows = 0;
+#endif
+    int health = fire_health_register_task("fire_monitor", FIRE_HEALTH_MONITOR_LIMIT_MS);
 
-    while (1) {
-        const struct addrinfo hints = {
-            .ai_family = AF_UNSPEC,
-            .ai_socktype = SOCK_STREAM,
-        };
-        struct addrinfo *res;
+    if (!fire_zones_init(&fire_zones, fire_zone_table, FIRE_ZONE_COUNT)) {
+        printf("Invalid fire zone table!\n");
+        vTaskDelete(NULL);
+    }
 
+    // Cấu hình chân vùng 0 (mặc định GPIO 12) làm input với pull-up
+    uint8_t sensor_pin = fire_config.sensor_pin;
+    gpio_enable(sensor_pin, GPIO_INPUT);
+    gpio_set_pullup(sensor_pin, true, true);
+    // In trạng thái ban đầu của chân vùng 0
 #ifdef DEBUG
-        printf("Running DNS lookup for %s...\r\n", WEB_SERVER);
+    printf("Initial state of GPIO %d: %d\n", sensor_pin, gpio_read(sensor_pin));
 #endif
-        int err = getaddrinfo(WEB_SERVER, WEB_PORT, &hints, &res);
+    // Cấu hình interrupt cho chân vùng 0 (cả hai cạnh)
+    gpio_set_interrupt(sensor_pin, GPIO_INTTYPE_EDGE_ANY, NULL);
 
-        if (err != 0 || res == NULL) {
-#ifdef DEBUG
-            printf("DNS lookup failed err=%d res=%p\r\n", err, res);
+#if FIRE_I2C_USED
+    fire_i2c_mutex = FIRE_MUTEX_CREATE(fire_i2c_mutex);
+    i2c_init(FIRE_I2C_BUS, FIRE_I2C_SCL_PIN, FIRE_I2C_SDA_PIN, I2C_FREQ_400K);
 #endif
-            if (res)
-                freeaddrinfo(res);
-            failures++;
-            set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
-            vTaskDelay(5000 / portTICK_PERIOD_MS);
+#if FIRE_EXPANDER_COUNT > 0
+    fire_expander_timer = FIRE_TIMER_CREATE(fire_expander, pdMS_TO_TICKS(FIRE_EXPANDER_RETRY_MS), pdFALSE,
+                                            fire_expander_timer_callback);
+    gpio_enable(FIRE_EXPANDER_INT_PIN, GPIO_INPUT);
+    gpio_set_pullup(FIRE_EXPANDER_INT_PIN, true, true);
+    // INT xuống thấp khi có chân đổi mức, lên lại sau khi cổng được đọc
+    gpio_set_interrupt(FIRE_EXPANDER_INT_PIN, GPIO_INTTYPE_EDGE_NEG, NULL);
+    fire_read_expanders();
+#endif
+    // Các đầu vào báo cháy đánh thức chip khỏi light sleep do SDK tự vào
+#if FIRE_EXPANDER_COUNT > 0
+    fire_power_start(BIT(sensor_pin) | BIT(FIRE_EXPANDER_INT_PIN));
+#else
+    fire_power_start(BIT(sensor_pin));
+#endif
+#if FIRE_SMOKE_COUNT > 0
+    if (!fire_smoke_start()) {
+        printf("Analog smoke sampling failed to start!\n");
+    }
+#endif
+#if FIRE_FUSION
+    if (!fire_fusion_start(FIRE_I2C_BUS, fire_i2c_mutex, fire_fusion_alarm_changed)) {
+        printf("Gas sensor fusion failed to start!\n");
+    }
+#endif
+
+    // Các vùng đã tích cực từ trước khi bật ngắt
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&fire_zones, fire_zone_input(GPIO.IN & 0xffff), fire_clock_cycles(), &batch);
+    fire_apply_batch(&batch);
+
+    TickType_t quiet_since = xTaskGetTickCount();
+    while (1) {
+        uint32_t notify_bits = 0;
+        fire_health_beat(health);
+        // Nhật ký còn bản ghi trong RAM được ghi ra flash sau một khoảng không
+        // vùng nào thay đổi (mẫu analog định kỳ không tính)
+        if (fire_journal_ready && fire_journal_pending(&fire_journal) &&
+            xTaskGetTickCount() - quiet_since >= pdMS_TO_TICKS(FIRE_JOURNAL_FLUSH_MS) &&
+            !fire_journal_flush(&fire_journal)) {
+            printf("Fire journal write failed\n");
+        }
+        // Chờ cạnh GPIO, timer hết hạn hoặc mẫu analog, thức dậy định kỳ cho heartbeat
+        if (xTaskNotifyWait(0, UINT32_MAX, &notify_bits, pdMS_TO_TICKS(FIRE_HEALTH_BEAT_MS)) == pdFALSE) {
             continue;
         }
 
-        struct sockaddr *sa = res->ai_addr;
-        if (sa->sa_family == AF_INET) {
-#ifdef DEBUG
-            printf("DNS lookup succeeded. IP=%s\r\n", inet_ntoa(((struct sockaddr_in *)sa)->sin_addr));
+        fire_zones_batch_clear(&batch);
+
+        isr_event_t event;
+        while (isr_ring_pop(&fire_ring, &event)) {
+            fire_trace_record(FIRE_TRACE_STAGE_WAKE, fire_clock_cycles() - event.ccount);
+#if FIRE_EXPANDER_COUNT > 0
+            if (event.pins & BIT(FIRE_EXPANDER_INT_PIN)) {
+                fire_read_expanders();
+            }
 #endif
+            fire_zones_input(&fire_zones, fire_zone_input(event.levels), event.ccount, &batch);
         }
 
-        int s = socket(res->ai_family, res->ai_socktype, 0);
-        if (s < 0) {
-#ifdef DEBUG
-            printf("... Failed to allocate socket.\r\n");
-#endif
-            freeaddrinfo(res);
-            failures++;
-            set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
-            vTaskDelay(5000 / portTICK_PERIOD_MS);
-            continue;
+#if FIRE_EXPANDER_COUNT > 0
+        if (notify_bits & FIRE_NOTIFY_EXPANDER) {
+            fire_read_expanders();
+            fire_zones_input(&fire_zones, fire_zone_input(GPIO.IN & 0xffff), fire_clock_cycles(), &batch);
         }
+#endif
 
+        uint32_t overflows = isr_ring_overflows(&fire_ring);
+        if (overflows != reported_overflows) {
 #ifdef DEBUG
-        printf("... allocated socket\r\n");
+            printf("Fire event ring overflow: %u events dropped\n", overflows - reported_overflows);
+#endif
+            reported_overflows = overflows;
+            // Có thể đã mất cạnh cuối: đồng bộ lại theo mức hiện tại
+#if FIRE_EXPANDER_COUNT > 0
+            fire_read_expanders();
 #endif
+            fire_zones_input(&fire_zones, fire_zone_input(GPIO.IN & 0xffff), fire_clock_cycles(), &batch);
+        }
 
-        if (connect(s, res->ai_addr, res->ai_addrlen) != 0) {
-            close(s);
-            freeaddrinfo(res);
+#if FIRE_SMOKE_COUNT > 0
+        fire_smoke_sample_t sample;
+        while (fire_smoke_ring_pop(&fire_smoke_ring, &sample)) {
+            fire_smoke_feed(&sample, &batch);
+        }
+        uint32_t smoke_overflows = fire_smoke_ring_overflows(&fire_smoke_ring);
+        if (smoke_overflows != reported_smoke_overflows) {
 #ifdef DEBUG
-            printf("... socket connect failed.\r\n");
+            printf("Analog smoke ring overflow: %u samples dropped\n", smoke_overflows - reported_smoke_overflows);
 #endif
-            failures++;
-            set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
-            vTaskDelay(10000 / portTICK_PERIOD_MS);
-            continue;
+            reported_smoke_overflows = smoke_overflows;
         }
+#endif
 
-#ifdef DEBUG
-        printf("... connected\r\n");
+#if FIRE_FUSION
+        if (notify_bits & FIRE_NOTIFY_FUSION) {
+            fire_fusion_levels = fire_fusion_alarm ? FIRE_FUSION_INPUT : 0;
+            fire_zones_input(&fire_zones, (fire_zones.last_input & ~FIRE_FUSION_INPUT) | fire_fusion_levels,
+                             fire_clock_cycles(), &batch);
+        }
 #endif
-        freeaddrinfo(res);
 
-        const char *req =
-            "GET "WEB_PATH" HTTP/1.1\r\n"
-            "Host: "WEB_SERVER"\r\n"
-            "User-Agent: esp-open-rtos/0.1 esp8266\r\n"
-            "Connection: close\r\n"
-            "\r\n";
-        if (write(s, req, strlen(req)) < 0) {
+        if (notify_bits & FIRE_NOTIFY_TIMER) {
+            fire_zones_expire(&fire_zones, fire_clock_cycles(), &batch);
+        }
+
+        fire_apply_batch(&batch);
+        if (batch.edges != 0 || batch.raised != 0 || batch.cleared != 0) {
+            quiet_since = xTaskGetTickCount();
+        }
+    }
+}
+
+#if SIM_MONITOR_RAW
+// Probe chạy hoàn toàn bằng callback trong thread tcpip
+static sim_rawprobe_t sim_probe;
+static TimerHandle_t sim_probe_timer;
+FIRE_TIMER_STORAGE(sim_probe);
+static int sim_successes, sim_failures;
+static int sim_probe_health = -1;
+
+static void sim_probe_start_cb(void *ctx)
+{
+    sim_rawprobe_start(&sim_probe);
+}
+
+// Timer chỉ chuyển việc sang thread tcpip, không chạm vào lwIP trực tiếp
+static void sim_probe_timer_callback(TimerHandle_t timer)
+{
+    if (tcpip_callback(sim_probe_start_cb, NULL) != ERR_OK &&
+        xTimerChangePeriod(sim_probe_timer, SIM_PROBE_PERIOD_MS / portTICK_PERIOD_MS, 0) != pdPASS) {
+        // Cả mailbox tcpip và hàng lệnh timer đều đầy: bộ giám sát sẽ thấy probe im lặng
+        printf("Probe timer re-arm failed\n");
+    }
+}
+
+// Gọi trong thread tcpip khi probe kết thúc
+static void sim_probe_done(const sim_rawprobe_report_t *report, void *arg)
+{
+    fire_health_beat(sim_probe_health);
+    if (report->result == SIM_PROBE_OK) {
+        sim_successes++;
+        set_led_state(SIM, LED_ON, 0); // Bật LED khi thành công
+    } else {
+        sim_failures++;
+        set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
+    }
+
 #ifdef DEBUG
-            printf("... socket send failed\r\n");
+    printf("Probe %s: result=%d HTTP %u %s, dns %u us, connect %u us, first byte %u us, total %u us\r\n",
+           fire_config.probe_host, report->result, report->status, report->reused ? "reused" : "new",
+           report->dns_us, report->connect_us, report->first_byte_us, report->total_us);
+    printf("successes = %d failures = %d\r\n", sim_successes, sim_failures);
 #endif
-            close(s);
+
+    // Connect thất bại: chờ lâu hơn trước khi thử lại
+    uint32_t period_ms = report->result == SIM_PROBE_ERR_CONNECT ? SIM_PROBE_RETRY_PERIOD_MS : SIM_PROBE_PERIOD_MS;
+    if (xTimerChangePeriod(sim_probe_timer, period_ms / portTICK_PERIOD_MS, 0) != pdPASS) {
+        // Hàng lệnh của task timer đầy (thread tcpip không được chờ): probe
+        // sau chạy bằng timer của lwIP trong chính thread này
+        printf("Probe timer re-arm failed, using an lwIP timeout\n");
+        sys_timeout(period_ms, sim_probe_start_cb, NULL);
+    }
+}
+
+static bool sim_monitor_init(void)
+{
+    if (!sim_rawprobe_init(&sim_probe, fire_config.probe_host, fire_config.probe_port, fire_config.probe_path,
+                           SIM_PROBE_TIMEOUT_MS, sim_probe_done, NULL)) {
+        return false;
+    }
+    sim_probe_health = fire_health_register_callback("sim_probe", FIRE_HEALTH_PROBE_LIMIT_MS);
+    sim_probe_timer = FIRE_TIMER_CREATE(sim_probe, SIM_PROBE_PERIOD_MS / portTICK_PERIOD_MS,
+                                        pdFALSE, sim_probe_timer_callback);
+    return sim_probe_timer != NULL && xTimerStart(sim_probe_timer, 0) == pdPASS;
+}
+#else
+// Task kiểm tra kết nối bằng HTTP HEAD trên một kết nối keep-alive
+static void sim_monitor_task(void *pvParameters)
+{
+    // Trạng thái probe (cache DNS, socket keep-alive) giữ ngoài stack của task
+    static sim_probe_t probe;
+    int successes = 0, failures = 0;
+    int health = fire_health_register_task("sim_monitor", FIRE_HEALTH_PROBE_LIMIT_MS);
+
+    // sim_probe giữ con trỏ tới cổng dạng chuỗi
+    static char port[6];
+    snprintf(port, sizeof(port), "%u", fire_config.probe_port);
+    if (!sim_probe_init(&probe, fire_config.probe_host, port, fire_config.probe_path)) {
+        printf("Probe request too long!\n");
+        vTaskDelete(NULL);
+    }
+
+    while (1) {
+        fire_health_beat(health);
+        sim_probe_result_t result = sim_probe_run(&probe);
+
+        if (result == SIM_PROBE_OK) {
+            successes++;
+            set_led_state(SIM, LED_ON, 0); // Bật LED khi thành công
+        } else {
             failures++;
             set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
-            vTaskDelay(5000 / portTICK_PERIOD_MS);
-            continue;
         }
 
 #ifdef DEBUG
-        printf("... socket send success\r\n");
+        if (result == SIM_PROBE_OK) {
+            printf("Probe %s: HTTP %u, rtt %u us (min %u, max %u)\r\n", fire_config.probe_host,
+                   probe.last_status, probe.last_rtt_us, probe.min_rtt_us, probe.max_rtt_us);
+        } else {
+            printf("Probe %s failed: result=%d errno=%d\r\n", fire_config.probe_host, result, errno);
+        }
+        printf("successes = %d failures = %d dns = %u connects = %u\r\n",
+               successes, failures, probe.dns_lookups, probe.connects);
 #endif
 
-        static char recv_buf[128];
-        int r;
-        do {
-            bzero(recv_buf, 128);
-            r = read(s, recv_buf, 127);
-            if (r > 0) {
-#ifdef DEBUG
-                printf("%s", recv_buf);
+        // Connect thất bại: chờ lâu hơn trước khi thử lại
+        vTaskDelay((result == SIM_PROBE_ERR_CONNECT ? SIM_PROBE_RETRY_PERIOD_MS : SIM_PROBE_PERIOD_MS) / portTICK_PERIOD_MS);
+    }
+}
+
+FIRE_TASK_STORAGE(sim_monitor_task, 512);
+
+static bool sim_monitor_init(void)
+{
+    return FIRE_TASK_CREATE(sim_monitor_task, sim_monitor_task, NULL, 3, NULL) == pdPASS;
+}
 #endif
-            }
-        } while (r > 0);
 
+// Gửi histogram độ trễ qua UART 0 mà không chờ FIFO TX: mỗi lần chỉ ghi tới
+// khi FIFO đầy, phần còn lại ở tick sau. Dòng printf chen vào giữa làm hỏng
+// bản dump đó (CRC sai) nhưng bản sau chứa lại toàn bộ histogram.
+static void fire_trace_timer_callback(TimerHandle_t timer)
+{
+    if (fire_trace_sent == fire_trace_len) {
 #ifdef DEBUG
-        printf("... done reading from socket. Last read return=%d errno=%d\r\n", r, errno);
+        // Bản dump trước đã gửi xong: dòng thống kê điện năng không chen vào giữa
+        fire_power_stats_t power;
+        fire_power_get_stats(&power);
+        printf("Power: active %u ms, idle %u ms, modem sleep %u ms, auto light %u ms, "
+               "%u GPIO wakes, %u uAh\n",
+               (uint32_t)(power.time_us[FIRE_POWER_ACTIVE] / 1000), (uint32_t)(power.time_us[FIRE_POWER_IDLE] / 1000),
+               (uint32_t)(power.time_us[FIRE_POWER_MODEM_SLEEP] / 1000),
+               (uint32_t)(power.time_us[FIRE_POWER_AUTO_LIGHT] / 1000),
+               power.wakes[FIRE_POWER_WAKE_GPIO], fire_power_charge_uah(&power));
+        fire_health_slot_t slots[FIRE_HEALTH_SLOTS];
+        uint32_t count = fire_health_get_stats(slots, FIRE_HEALTH_SLOTS);
+        for (uint32_t i = 0; i < count; i++) {
+            printf("Health: %s period %u ms (max %u), silence max %u ms, stack min %d words\n",
+                   slots[i].name, slots[i].period_ms, slots[i].period_max_ms, slots[i].silence_max_ms,
+                   slots[i].stack_min_words == UINT32_MAX ? -1 : (int)slots[i].stack_min_words);
+        }
 #endif
-        if (r != 0) {
-            failures++;
-            set_led_state(SIM, LED_BLINK, 250); // Nhấp nháy LED khi thất bại
-        } else {
-            successes++;
-            set_led_state(SIM, LED_ON, 0); // Bật LED khi thành công
+        fire_trace_len = fire_trace_encode(fire_trace_frame, sizeof(fire_trace_frame), fire_clock_cycles_per_us());
+        fire_trace_sent = 0;
+    }
+    while (fire_trace_sent < fire_trace_len && uart_putc_nowait(0, fire_trace_frame[fire_trace_sent]) == 0) {
+        fire_trace_sent++;
+    }
+    xTimerChangePeriod(timer, fire_trace_sent < fire_trace_len ? 1 : pdMS_TO_TICKS(FIRE_TRACE_DUMP_MS), 0);
+}
+
+// Task gửi sự kiện qua MQTT (ưu tiên thấp hơn báo cháy)
+FIRE_TASK_STORAGE(fire_notify_task, 768);
+static int fire_notify_health = -1;
+
+static void fire_notify_heartbeat(void)
+{
+    fire_health_beat(fire_notify_health);
+}
+
+// Mốc seq MQTT lưu trong sysparam (ngoài tiền tố fire.* của cấu hình): sau
+// khởi động lại seq không lặp lại, kể cả khi vùng flash sự kiện trống
+#define FIRE_NOTIFY_SEQ_KEY "notify.seq"
+
+static bool fire_notify_seq_load(uint32_t *mark)
+{
+    int32_t value;
+    if (sysparam_get_int32(FIRE_NOTIFY_SEQ_KEY, &value) != SYSPARAM_OK) {
+        return false;
+    }
+    *mark = (uint32_t)value;
+    return true;
+}
+
+static bool fire_notify_seq_store(uint32_t mark)
+{
+    if (sysparam_set_int32(FIRE_NOTIFY_SEQ_KEY, (int32_t)mark) != SYSPARAM_OK) {
+        printf("Lỗi lưu mốc seq MQTT\n");
+        return false;
+    }
+    return true;
+}
+
+static void fire_notify_task(void *pvParameters)
+{
+    fire_notify_health = fire_health_register_task("fire_notify", FIRE_HEALTH_NOTIFY_LIMIT_MS);
+    fire_notify_run();
+    vTaskDelete(NULL);
+}
+
+// Task nén sysparam (ưu tiên thấp nhất trên idle): dọn và xóa trước vùng dự
+// phòng khi hệ thống rảnh để lần ghi cấu hình không phải chờ nén cả vùng
+FIRE_TASK_STORAGE(fire_sysparam_task, 384);
+
+static void fire_sysparam_task(void *pvParameters)
+{
+    for (;;) {
+        sysparam_status_t status = sysparam_compact_step(FIRE_SYSPARAM_COMPACT_THRESHOLD,
+                                                         FIRE_SYSPARAM_COMPACT_SLICE_US);
+        if (status < 0) {
+            printf("Sysparam compaction failed (%d)\n", status);
         }
-        close(s);
+        vTaskDelay(status == SYSPARAM_OK ? 1 : pdMS_TO_TICKS(FIRE_SYSPARAM_COMPACT_IDLE_MS));
+    }
+}
+
+// Bộ giám sát gọi khi một task im lặng quá 3 lần giới hạn: ghi nốt nhật ký
+// và các sự kiện còn trong hàng đợi RAM (tối đa FIRE_OUTBOX_RAM_SLOTS) xuống
+// vùng flash chờ gửi rồi khởi động lại
+static void fire_restart(const char *name)
+{
+    printf("Task %s stalled, restarting\n", name);
+    if (fire_journal_ready && !fire_journal_flush(&fire_journal)) {
+        printf("Fire journal write failed\n");
+    }
+    if (!fire_notify_persist()) {
+        printf("Queued events not saved to flash\n");
+    }
+    sdk_system_restart();
+}
 
+// Đọc cấu hình một lần (một lượt duyệt sysparam) rồi áp vào bảng vùng; chân
+// vùng 0 trùng với chân đã dùng thì giữ mặc định
+static void fire_apply_config(void)
+{
+    fire_config_stats_t stats;
+
+    fire_config = fire_config_defaults;
+    sysparam_status_t status = fire_config_load(&fire_config, &stats);
+    if (status != SYSPARAM_OK) {
+        printf("Config load failed (%d), using defaults\n", status);
+    }
 #ifdef DEBUG
-        printf("successes = %d failures = %d\r\n", successes, failures);
-        UBaseType_t stack_high_water_mark = uxTaskGetStackHighWaterMark(NULL);
-        printf("SIM task stack high water mark: %lu words\n", stack_high_water_mark);
+    printf("Config: %u entries, %u applied, %u invalid, loaded in %u us\n",
+           stats.entries, stats.applied, stats.invalid, stats.load_us);
 #endif
+    if (FIRE_RESERVED_PINS & BIT(fire_config.sensor_pin)) {
+        printf("GPIO %u is in use, sensor stays on GPIO %u\n", fire_config.sensor_pin, FIRE_SENSOR_PIN);
+        fire_config.sensor_pin = FIRE_SENSOR_PIN;
+    }
 
-        vTaskDelay(5000 / portTICK_PERIOD_MS);
+    fire_zone_table[0].input = fire_config.sensor_pin;
+    for (uint32_t i = 0; i < FIRE_CONTACT_ZONE_COUNT; i++) {
+        fire_zone_table[i].debounce_us = fire_config.debounce_us;
+        fire_zone_table[i].recovery_us = fire_config.recovery_us;
     }
 }
 
@@ -232,27 +920,73 @@ void user_init(void)
     printf("System init, free heap: %u bytes\n", xPortGetFreeHeapSize());
 #endif
 
+    // Cấu hình chạy phải có trước Wi-Fi, MQTT và các vùng báo cháy
+    fire_apply_config();
+
     // Cấu hình Wi-Fi
-    struct sdk_station_config config = {
-        .ssid = WIFI_SSID,
-        .password = WIFI_PASS,
-    };
+    struct sdk_station_config config;
+    memset(&config, 0, sizeof(config));
+    memcpy(config.ssid, fire_config.wifi_ssid, sizeof(config.ssid));
+    memcpy(config.password, fire_config.wifi_pass, sizeof(config.password));
     sdk_wifi_set_opmode(STATION_MODE);
     sdk_wifi_station_set_config(&config);
 
-    // Khởi tạo queue cho ISR
-    fire_queue = xQueueCreate(5, sizeof(uint32_t));
-    if (fire_queue == NULL) {
-        printf("Lỗi tạo queue!\n");
+    // Khởi tạo ring cho ISR và timer debounce
+    isr_ring_init(&fire_ring);
+    fire_trace_init();
+    fire_timer = FIRE_TIMER_CREATE(fire_timer, 1, pdFALSE, fire_timer_callback);
+    if (fire_timer == NULL) {
+        printf("Lỗi tạo timer!\n");
         return;
     }
 
     // Khởi tạo LED Manager
     led_manager_init();
 
+    // Hàng đợi sự kiện phải sẵn sàng trước khi task báo cháy chạy
+    static fire_notify_config_t notify_config = {
+        .command_timeout_ms = 5000,
+        .heartbeat = fire_notify_heartbeat,
+        .seq_load = fire_notify_seq_load,
+        .seq_store = fire_notify_seq_store,
+    };
+    notify_config.host = fire_config.mqtt_host;
+    notify_config.port = fire_config.mqtt_port;
+    notify_config.topic = fire_config.mqtt_topic;
+    notify_config.client_id = fire_config.mqtt_client_id;
+    notify_config.keepalive_s = fire_config.mqtt_keepalive_s;
+    if (!fire_notify_init(&notify_config, &fire_flash_spiflash, FIRE_SPILL_ADDR, FIRE_SPILL_SECTORS)) {
+        printf("Lỗi khởi tạo vùng flash sự kiện, chỉ dùng RAM!\n");
+    }
+    FIRE_TASK_CREATE(fire_notify_task, fire_notify_task, NULL, 3, NULL);
+
+    fire_journal_ready = fire_journal_mount(&fire_journal, &fire_flash_spiflash,
+                                            FIRE_JOURNAL_ADDR, FIRE_JOURNAL_SECTORS);
+    if (!fire_journal_ready) {
+        printf("Lỗi khởi tạo nhật ký báo cháy!\n");
+    }
+
+    fire_trace_timer = FIRE_TIMER_CREATE(fire_trace, pdMS_TO_TICKS(FIRE_TRACE_DUMP_MS), pdFALSE,
+                                         fire_trace_timer_callback);
+    if (fire_trace_timer == NULL || xTimerStart(fire_trace_timer, 0) != pdPASS) {
+        printf("Lỗi tạo timer dump độ trễ!\n");
+    }
+
+    if (!fire_health_start(fire_restart)) {
+        printf("Lỗi tạo timer giám sát task!\n");
+    }
+
+    FIRE_TASK_CREATE(fire_sysparam_task, fire_sysparam_task, NULL, 1, NULL);
+
     // Tạo task giám sát báo cháy (ưu tiên cao)
-    xTaskCreate(fire_monitor_task, "fire_monitor_task", 512, NULL, 5, NULL);
+    FIRE_TASK_CREATE(fire_monitor_task, fire_monitor_task, NULL, 5, &fire_task_handle);
 
-    // Tạo task kiểm tra SIM bằng HTTP (ưu tiên thấp hơn)
-    xTaskCreate(sim_monitor_task, "sim_monitor_task", 512, NULL, 3, NULL);
+#if !FIRE_I2C_USED
+    // Cấu hình GPIO 13 làm output cho LED (GPIO 13 là SDA khi dùng I2C)
+    gpio_enable(SIM_STATUS_PIN, GPIO_OUTPUT);
+#endif
+    // Khởi động kiểm tra kết nối (ưu tiên thấp hơn báo cháy)
+    if (!sim_monitor_init()) {
+        printf("Lỗi khởi tạo kiểm tra kết nối!\n");
+    }
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef FIRE_CLOCK_H
+#define FIRE_CLOCK_H
+
+#include <stdint.h>
+
+#ifdef FIRE_HOST_BUILD
+#include <time.h>
+#else
+#include "espressif/esp_system.h"
+#include "xtensa_ops.h"
+#endif
+
+// Tần số CPU dùng khi chạy trên host (mô phỏng 80 MHz)
+#define FIRE_CLOCK_HOST_MHZ 80
+
+/**
+ * @brief Reads the free-running CPU cycle counter
+ *
+ * On the ESP8266 this is the Xtensa CCOUNT register, which increments once per
+ * CPU clock (80 or 160 MHz) and wraps roughly every 53 s at 80 MHz. Reading it
+ * is a single instruction, so it is safe and cheap to call from an ISR.
+ * Host builds derive an equivalent 80 MHz count from CLOCK_MONOTONIC.
+ *
+ * @return Current cycle count
+ */
+static inline uint32_t fire_clock_cycles(void)
+{
+#ifdef FIRE_HOST_BUILD
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    return (uint32_t)(ns * FIRE_CLOCK_HOST_MHZ / 1000);
+#else
+    uint32_t ccount;
+    RSR(ccount, ccount);
+    return ccount;
+#endif
+}
+
+/**
+ * @brief Returns the number of cycle counter ticks per microsecond
+ */
+static inline uint32_t fire_clock_cycles_per_us(void)
+{
+#ifdef FIRE_HOST_BUILD
+    return FIRE_CLOCK_HOST_MHZ;
+#else
+    return sdk_system_get_cpu_freq();
+#endif
+}
+
+/**
+ * @brief Converts a cycle counter difference to microseconds
+ *
+ * @param cycles Difference between two fire_clock_cycles() readings
+ * @return Elapsed time in microseconds
+ */
+static inline uint32_t fire_clock_cycles_to_us(uint32_t cycles)
+{
+    return cycles / fire_clock_cycles_per_us();
+}
+
+#endif
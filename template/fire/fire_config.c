@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fire_clock.h"
+#include "fire_config.h"
+
+typedef enum {
+    FIELD_STRING,
+    FIELD_U8,
+    FIELD_U16,
+    FIELD_U32,
+} field_type_t;
+
+// Mô tả một khóa: vị trí trong fire_config_t và miền giá trị hợp lệ
+// Description of one key: place in fire_config_t and valid range
+typedef struct {
+    const char *key;
+    uint8_t type;     // field_type_t
+    uint16_t offset;
+    uint16_t size;    // Buffer size for strings (including NUL)
+    uint32_t min;     // Numbers only
+    uint32_t max;
+} field_t;
+
+#define STRING_FIELD(key, member) \
+    { FIRE_CONFIG_PREFIX key, FIELD_STRING, offsetof(fire_config_t, member), \
+      sizeof(((fire_config_t *)0)->member), 0, 0 }
+#define NUMBER_FIELD(key, type, member, min, max) \
+    { FIRE_CONFIG_PREFIX key, type, offsetof(fire_config_t, member), \
+      sizeof(((fire_config_t *)0)->member), min, max }
+
+// Theo thứ tự của fire_config_field_t
+static const field_t fields[FIRE_CONFIG_FIELDS] = {
+    [FIRE_CONFIG_WIFI_SSID] = STRING_FIELD("wifi.ssid", wifi_ssid),
+    [FIRE_CONFIG_WIFI_PASS] = STRING_FIELD("wifi.pass", wifi_pass),
+    [FIRE_CONFIG_MQTT_HOST] = STRING_FIELD("mqtt.host", mqtt_host),
+    [FIRE_CONFIG_MQTT_PORT] = NUMBER_FIELD("mqtt.port", FIELD_U16, mqtt_port, 1, 65535),
+    [FIRE_CONFIG_MQTT_TOPIC] = STRING_FIELD("mqtt.topic", mqtt_topic),
+    [FIRE_CONFIG_MQTT_CLIENT_ID] = STRING_FIELD("mqtt.client_id", mqtt_client_id),
+    [FIRE_CONFIG_MQTT_KEEPALIVE] = NUMBER_FIELD("mqtt.keepalive", FIELD_U16, mqtt_keepalive_s, 5, 3600),
+    [FIRE_CONFIG_PROBE_HOST] = STRING_FIELD("probe.host", probe_host),
+    [FIRE_CONFIG_PROBE_PORT] = NUMBER_FIELD("probe.port", FIELD_U16, probe_port, 1, 65535),
+    [FIRE_CONFIG_PROBE_PATH] = STRING_FIELD("probe.path", probe_path),
+    [FIRE_CONFIG_SENSOR_PIN] = NUMBER_FIELD("sensor.pin", FIELD_U8, sensor_pin, 0, 15),
+    [FIRE_CONFIG_DEBOUNCE_US] = NUMBER_FIELD("zone.debounce_us", FIELD_U32, debounce_us, 0, 10000000),
+    [FIRE_CONFIG_RECOVERY_US] = NUMBER_FIELD("zone.recovery_us", FIELD_U32, recovery_us, 0, 60000000),
+};
+
+static uint32_t field_get(const fire_config_t *config, const field_t *field)
+{
+    const uint8_t *p = (const uint8_t *)config + field->offset;
+    switch (field->type) {
+    case FIELD_U8:
+        return *p;
+    case FIELD_U16:
+        return *(const uint16_t *)p;
+    default:
+        return *(const uint32_t *)p;
+    }
+}
+
+static void field_set(fire_config_t *config, const field_t *field, uint32_t value)
+{
+    uint8_t *p = (uint8_t *)config + field->offset;
+    switch (field->type) {
+    case FIELD_U8:
+        *p = value;
+        break;
+    case FIELD_U16:
+        *(uint16_t *)p = value;
+        break;
+    default:
+        *(uint32_t *)p = value;
+        break;
+    }
+}
+
+// Số nhị phân 1/2/4 byte (little-endian) hoặc số thập phân dạng chuỗi
+static bool parse_number(const uint8_t *value, size_t len, bool binary, int64_t *result)
+{
+    if (binary) {
+        if (len == 1) {
+            *result = (int8_t)value[0];
+        } else if (len == 2) {
+            *result = (int16_t)(value[0] | value[1] << 8);
+        } else if (len == 4) {
+            *result = (int32_t)((uint32_t)value[0] | (uint32_t)value[1] << 8 | (uint32_t)value[2] << 16 |
+                                (uint32_t)value[3] << 24);
+        } else {
+            return false;
+        }
+        return true;
+    }
+    char text[12];
+    char *end;
+    if (len == 0 || len >= sizeof(text)) {
+        return false;
+    }
+    memcpy(text, value, len);
+    text[len] = '\0';
+    *result = strtoll(text, &end, 10);
+    return *end == '\0';
+}
+
+static const field_t *field_find(const char *key)
+{
+    for (uint32_t i = 0; i < FIRE_CONFIG_FIELDS; i++) {
+        if (strcmp(fields[i].key, key) == 0) {
+            return &fields[i];
+        }
+    }
+    return NULL;
+}
+
+fire_config_result_t fire_config_apply(fire_config_t *config, const char *key, const uint8_t *value,
+                                       size_t value_len, bool binary)
+{
+    if (strncmp(key, FIRE_CONFIG_PREFIX, sizeof(FIRE_CONFIG_PREFIX) - 1) != 0) {
+        return FIRE_CONFIG_IGNORED;
+    }
+    const field_t *field = field_find(key);
+    if (field == NULL) {
+        return FIRE_CONFIG_IGNORED;
+    }
+
+    if (field->type == FIELD_STRING) {
+        // Chuỗi rỗng được lưu là một byte NUL (giá trị rỗng sẽ xóa khóa);
+        // chuỗi không được chứa NUL khác và phải vừa bộ đệm cùng NUL kết thúc
+        if (value_len > 0 && value[value_len - 1] == '\0') {
+            value_len--;
+        }
+        if (value_len >= field->size || memchr(value, '\0', value_len) != NULL) {
+            return FIRE_CONFIG_INVALID;
+        }
+        char *dest = (char *)config + field->offset;
+        memcpy(dest, value, value_len);
+        dest[value_len] = '\0';
+        return FIRE_CONFIG_APPLIED;
+    }
+
+    int64_t number;
+    if (!parse_number(value, value_len, binary, &number) || number < field->min || number > field->max) {
+        return FIRE_CONFIG_INVALID;
+    }
+    field_set(config, field, number);
+    return FIRE_CONFIG_APPLIED;
+}
+
+uint32_t fire_config_diff(const fire_config_t *a, const fire_config_t *b)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t i = 0; i < FIRE_CONFIG_FIELDS; i++) {
+        const field_t *field = &fields[i];
+        bool differs;
+        if (field->type == FIELD_STRING) {
+            differs = strcmp((const char *)a + field->offset, (const char *)b + field->offset) != 0;
+        } else {
+            differs = field_get(a, field) != field_get(b, field);
+        }
+        if (differs) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+sysparam_status_t fire_config_load(fire_config_t *config, fire_config_stats_t *stats)
+{
+    sysparam_iter_t iter;
+    sysparam_status_t status;
+
+    memset(stats, 0, sizeof(*stats));
+    uint32_t start = fire_clock_cycles();
+    status = sysparam_iter_start(&iter);
+    if (status != SYSPARAM_OK) {
+        return status;
+    }
+    while ((status = sysparam_iter_next(&iter)) == SYSPARAM_OK) {
+        stats->entries++;
+        switch (fire_config_apply(config, iter.key, iter.value, iter.value_len, iter.binary)) {
+        case FIRE_CONFIG_APPLIED:
+            stats->applied++;
+            break;
+        case FIRE_CONFIG_INVALID:
+            stats->invalid++;
+            break;
+        case FIRE_CONFIG_IGNORED:
+            break;
+        }
+    }
+    sysparam_iter_end(&iter);
+    stats->load_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    // Hết mục là kết thúc bình thường của lượt duyệt
+    return status == SYSPARAM_NOTFOUND ? SYSPARAM_OK : status;
+}
+
+sysparam_status_t fire_config_save(fire_config_t *stored, const fire_config_t *update, uint32_t *written)
+{
+    uint32_t changed = fire_config_diff(stored, update);
+    uint32_t count = 0;
+    sysparam_txn_t txn;
+    sysparam_status_t status;
+
+    if (written != NULL) {
+        *written = 0;
+    }
+    if (changed == 0) {
+        return SYSPARAM_OK;
+    }
+    // Mọi trường đổi trong một giao dịch: Wi-Fi SSID và mật khẩu không bao
+    // giờ được lưu nửa chừng, và cả lô là một lần ghi flash liền
+    sysparam_txn_begin(&txn);
+    for (uint32_t i = 0; i < FIRE_CONFIG_FIELDS; i++) {
+        const field_t *field = &fields[i];
+        if (!(changed & (1u << i))) {
+            continue;
+        }
+        if (field->type == FIELD_STRING) {
+            const char *text = (const char *)update + field->offset;
+            sysparam_txn_set_data(&txn, field->key, (const uint8_t *)text, text[0] != '\0' ? strlen(text) : 1, false);
+        } else {
+            sysparam_txn_set_int32(&txn, field->key, field_get(update, field));
+        }
+        count++;
+    }
+    status = sysparam_txn_commit(&txn);
+    if (status != SYSPARAM_OK) {
+        return status;
+    }
+    for (uint32_t i = 0; i < FIRE_CONFIG_FIELDS; i++) {
+        if (changed & (1u << i)) {
+            memcpy((uint8_t *)stored + fields[i].offset, (const uint8_t *)update + fields[i].offset, fields[i].size);
+        }
+    }
+    if (written != NULL) {
+        *written = count;
+    }
+    return SYSPARAM_OK;
+}
@@ -0,0 +1,106 @@
+#ifndef FIRE_CONFIG_H
+#define FIRE_CONFIG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sysparam.h"
+
+// Cấu hình chạy của ứng dụng báo cháy (Wi-Fi, MQTT, probe, chân cảm biến) lưu
+// trong sysparam dưới các khóa "fire.*". Khi khởi động cấu hình được đọc vào
+// RAM một lần bằng một lượt duyệt sysparam_iter_start/next thay vì tra từng
+// khóa (không có chỉ mục RAM của sysparam, mỗi lần tra quét lại cả vùng; lượt
+// duyệt còn đếm được giá trị sai của mọi khóa fire.*); khóa thiếu giữ giá trị mặc định
+// biên dịch sẵn, khóa lạ hoặc giá trị sai bị bỏ qua. Thay đổi được ghi lại
+// thành một giao dịch sysparam, chỉ các trường khác với bản đã lưu.
+
+#define FIRE_CONFIG_PREFIX "fire."
+
+// Các trường của cấu hình, bit i trong mặt nạ thay đổi là trường i
+// Configuration fields, bit i of a change mask is field i
+typedef enum {
+    FIRE_CONFIG_WIFI_SSID,      // fire.wifi.ssid
+    FIRE_CONFIG_WIFI_PASS,      // fire.wifi.pass
+    FIRE_CONFIG_MQTT_HOST,      // fire.mqtt.host
+    FIRE_CONFIG_MQTT_PORT,      // fire.mqtt.port
+    FIRE_CONFIG_MQTT_TOPIC,     // fire.mqtt.topic
+    FIRE_CONFIG_MQTT_CLIENT_ID, // fire.mqtt.client_id
+    FIRE_CONFIG_MQTT_KEEPALIVE, // fire.mqtt.keepalive
+    FIRE_CONFIG_PROBE_HOST,     // fire.probe.host
+    FIRE_CONFIG_PROBE_PORT,     // fire.probe.port
+    FIRE_CONFIG_PROBE_PATH,     // fire.probe.path
+    FIRE_CONFIG_SENSOR_PIN,     // fire.sensor.pin
+    FIRE_CONFIG_DEBOUNCE_US,    // fire.zone.debounce_us
+    FIRE_CONFIG_RECOVERY_US,    // fire.zone.recovery_us
+    FIRE_CONFIG_FIELDS
+} fire_config_field_t;
+
+// Cấu hình trong RAM, chuỗi luôn kết thúc bằng NUL
+// In-RAM configuration, strings always NUL-terminated
+typedef struct {
+    char wifi_ssid[33];         // 32 bytes like sdk_station_config
+    char wifi_pass[65];
+    char mqtt_host[64];
+    uint16_t mqtt_port;         // 1..65535
+    char mqtt_topic[64];
+    char mqtt_client_id[24];    // MQTT 3.1 limit is 23 characters
+    uint16_t mqtt_keepalive_s;  // 5..3600
+    char probe_host[64];
+    uint16_t probe_port;        // 1..65535
+    char probe_path[64];
+    uint8_t sensor_pin;         // GPIO 0..15 of zone 0
+    uint32_t debounce_us;       // Contact zones, 0..10 s
+    uint32_t recovery_us;       // Contact zones, 0..60 s
+} fire_config_t;
+
+typedef enum {
+    FIRE_CONFIG_IGNORED, // Not a fire.* key of this version
+    FIRE_CONFIG_APPLIED,
+    FIRE_CONFIG_INVALID, // Known key with a value of the wrong type, size or range
+} fire_config_result_t;
+
+// Thống kê lần đọc lúc khởi động
+// Statistics of the boot-time load
+typedef struct {
+    uint32_t entries;  // Sysparam entries visited
+    uint32_t applied;  // fire.* values taken
+    uint32_t invalid;  // fire.* values rejected, the default is kept
+    uint32_t load_us;  // Time of the iterator pass
+} fire_config_stats_t;
+
+/**
+ * @brief Applies one stored value to @p config
+ *
+ * Numbers may be binary (1, 2 or 4 bytes little-endian, as
+ * sysparam_set_int8/int32 store them) or decimal text.
+ */
+fire_config_result_t fire_config_apply(fire_config_t *config, const char *key, const uint8_t *value,
+                                       size_t value_len, bool binary);
+
+/**
+ * @brief Bit i set when field i differs between @p a and @p b
+ */
+uint32_t fire_config_diff(const fire_config_t *a, const fire_config_t *b);
+
+/**
+ * @brief Overlays the stored fire.* values on @p config in one iterator pass
+ *
+ * @p config holds the defaults on entry. The sysparam area must be
+ * initialised (the SDK startup does it before user_init()).
+ *
+ * @return SYSPARAM_OK, or the iterator error; values read before an error are kept
+ */
+sysparam_status_t fire_config_load(fire_config_t *config, fire_config_stats_t *stats);
+
+/**
+ * @brief Writes the fields of @p update that differ from @p stored as one transaction
+ *
+ * After a reset either all of the fields or none are found. @p stored takes
+ * the new values only on success; on an error the call can be repeated.
+ *
+ * @param written Number of keys written, may be NULL
+ */
+sysparam_status_t fire_config_save(fire_config_t *stored, const fire_config_t *update, uint32_t *written);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef FIRE_EVENT_H
+#define FIRE_EVENT_H
+
+#include <stdint.h>
+
+// Loại sự kiện gửi ra ngoài thiết bị
+typedef enum {
+    FIRE_EVENT_ALARM = 1,    // Zones entered the alarm state
+    FIRE_EVENT_RECOVERY = 2  // Zones returned to normal
+} fire_event_type_t;
+
+// Một sự kiện báo cháy/phục hồi chờ gửi đi
+// One fire or recovery notification waiting for delivery
+typedef struct {
+    uint32_t seq;       // Monotonic sequence number, kept across reboots
+    uint32_t stamp_ms;  // Detection time in milliseconds since boot
+    uint64_t zones;     // Zones raised or cleared
+    uint8_t type;       // fire_event_type_t
+} fire_event_t;
+
+#endif
@@ -0,0 +1,21 @@
+#include "fire_flash.h"
+
+#ifndef FIRE_HOST_BUILD
+#include "spiflash.h"
+
+static bool spiflash_read_op(uint32_t addr, void *buf, uint32_t len)
+{
+    return spiflash_read(addr, buf, len);
+}
+
+static bool spiflash_write_op(uint32_t addr, const void *buf, uint32_t len)
+{
+    return spiflash_write(addr, (uint8_t *)buf, len);
+}
+
+const fire_flash_ops_t fire_flash_spiflash = {
+    .read = spiflash_read_op,
+    .write = spiflash_write_op,
+    .erase_sector = spiflash_erase_sector,
+};
+#endif
@@ -0,0 +1,26 @@
+#ifndef FIRE_FLASH_H
+#define FIRE_FLASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Kích thước sector (đơn vị xóa) và trang (đơn vị ghi) của flash SPI
+#define FIRE_FLASH_SECTOR_SIZE 4096
+#define FIRE_FLASH_PAGE_SIZE   256
+
+// Thao tác flash dùng chung cho các vùng lưu trữ của ứng dụng
+// (NOR: ghi chỉ xóa bit 1 -> 0, xóa theo sector). Test trên host thay bằng
+// bộ giả lập trong RAM.
+// Flash primitives shared by the application's storage regions
+typedef struct {
+    bool (*read)(uint32_t addr, void *buf, uint32_t len);
+    bool (*write)(uint32_t addr, const void *buf, uint32_t len);
+    bool (*erase_sector)(uint32_t addr);
+} fire_flash_ops_t;
+
+#ifndef FIRE_HOST_BUILD
+// Thao tác flash thật qua core/spiflash
+extern const fire_flash_ops_t fire_flash_spiflash;
+#endif
+
+#endif
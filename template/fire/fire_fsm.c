@@ -0,0 +1,122 @@
+#include <string.h>
+#include "fire_fsm.h"
+#include "fire_clock.h"
+
+static void start_timer(fire_fsm_t *fsm, uint32_t timeout_us, uint32_t ccount, fire_fsm_action_t *action)
+{
+    fsm->timer_running = true;
+    fsm->timer_ccount = ccount;
+    fsm->timer_us = timeout_us;
+    action->timer_start = true;
+    action->timer_stop = false;
+    action->timer_us = timeout_us < FIRE_FSM_TIMER_STEP_US ? timeout_us : FIRE_FSM_TIMER_STEP_US;
+}
+
+static void stop_timer(fire_fsm_t *fsm, fire_fsm_action_t *action)
+{
+    if (fsm->timer_running) {
+        fsm->timer_running = false;
+        action->timer_stop = true;
+        action->timer_start = false;
+    }
+}
+
+void fire_fsm_init(fire_fsm_t *fsm, uint32_t debounce_us, uint32_t recovery_us)
+{
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->state = FIRE_FSM_IDLE;
+    fsm->debounce_us = debounce_us;
+    fsm->recovery_us = recovery_us;
+}
+
+void fire_fsm_edge(fire_fsm_t *fsm, bool active, uint32_t ccount, fire_fsm_action_t *action)
+{
+    memset(action, 0, sizeof(*action));
+
+    switch (fsm->state) {
+    case FIRE_FSM_IDLE:
+        if (active) {
+            fsm->state = FIRE_FSM_DEBOUNCE;
+            fsm->edge_ccount = ccount;
+            start_timer(fsm, fsm->debounce_us, ccount, action);
+        }
+        break;
+    case FIRE_FSM_DEBOUNCE:
+        if (active) {
+            // Tín hiệu còn rung: tính lại thời gian ổn định từ cạnh mới nhất
+            start_timer(fsm, fsm->debounce_us, ccount, action);
+        } else {
+            // Xung nhiễu ngắn hơn thời gian debounce
+            fsm->state = FIRE_FSM_IDLE;
+            stop_timer(fsm, action);
+        }
+        break;
+    case FIRE_FSM_ALARM:
+        if (!active) {
+            fsm->state = FIRE_FSM_RECOVERY;
+            start_timer(fsm, fsm->recovery_us, ccount, action);
+        }
+        break;
+    case FIRE_FSM_RECOVERY:
+        if (active) {
+            fsm->state = FIRE_FSM_ALARM;
+            stop_timer(fsm, action);
+        } else {
+            start_timer(fsm, fsm->recovery_us, ccount, action);
+        }
+        break;
+    }
+}
+
+void fire_fsm_timeout(fire_fsm_t *fsm, bool active, uint32_t ccount, fire_fsm_action_t *action)
+{
+    memset(action, 0, sizeof(*action));
+
+    // Bỏ qua timer đã bị hủy
+    if (!fsm->timer_running) {
+        return;
+    }
+    // Chưa hết hạn (timer cũ đã được khởi động lại, hoặc một chặng của thời
+    // gian dài): dời mốc tới lúc này, giữ phần lẻ micro giây trong chu kỳ
+    uint32_t elapsed_us = fire_clock_cycles_to_us(ccount - fsm->timer_ccount);
+    if (elapsed_us < fsm->timer_us) {
+        fsm->timer_ccount += elapsed_us * fire_clock_cycles_per_us();
+        start_timer(fsm, fsm->timer_us - elapsed_us, fsm->timer_ccount, action);
+        return;
+    }
+    fsm->timer_running = false;
+
+    switch (fsm->state) {
+    case FIRE_FSM_DEBOUNCE:
+        if (active) {
+            fsm->state = FIRE_FSM_ALARM;
+            action->alarm_on = true;
+        } else {
+            fsm->state = FIRE_FSM_IDLE;
+        }
+        break;
+    case FIRE_FSM_RECOVERY:
+        if (active) {
+            fsm->state = FIRE_FSM_ALARM;
+        } else {
+            fsm->state = FIRE_FSM_IDLE;
+            action->alarm_off = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void fire_fsm_latency_record(fire_fsm_latency_t *stats, uint32_t latency_us)
+{
+    if (stats->count == 0 || latency_us < stats->min_us) {
+        stats->min_us = latency_us;
+    }
+    if (latency_us > stats->max_us) {
+        stats->max_us = latency_us;
+    }
+    stats->last_us = latency_us;
+    stats->total_us += latency_us;
+    stats->count++;
+}
@@ -0,0 +1,94 @@
+#ifndef FIRE_FSM_H
+#define FIRE_FSM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Chặng dài nhất của một timer. CCOUNT 32 bit quay vòng sau 53,7 s ở 80 MHz và
+// 26,8 s ở 160 MHz, nên thời gian dài hơn (recovery tới 60 s) được chạy thành
+// nhiều chặng: mỗi lần hết hạn sớm, mốc được dời tới thời điểm đó và timer được
+// đặt lại cho phần còn lại, khoảng cách CCOUNT không bao giờ vượt một vòng
+#define FIRE_FSM_TIMER_STEP_US 10000000
+
+// Trạng thái của máy trạng thái báo cháy
+// States of the fire alarm state machine
+typedef enum {
+    FIRE_FSM_IDLE,      // Sensor inactive, waiting for an edge
+    FIRE_FSM_DEBOUNCE,  // Sensor went active, waiting for it to stay stable
+    FIRE_FSM_ALARM,     // Fire confirmed, alarm signalled
+    FIRE_FSM_RECOVERY   // Sensor went inactive, waiting before clearing the alarm
+} fire_fsm_state_t;
+
+// Hành động mà task phải thực hiện sau mỗi lần cập nhật
+// Side effects requested by the state machine
+typedef struct {
+    bool alarm_on;        // Start signalling the alarm
+    bool alarm_off;       // Stop signalling the alarm
+    bool timer_start;     // (Re)start the one-shot timer for timer_us
+    bool timer_stop;      // Cancel the one-shot timer
+    uint32_t timer_us;    // Timeout for timer_start, at most FIRE_FSM_TIMER_STEP_US
+} fire_fsm_action_t;
+
+// Máy trạng thái báo cháy (tín hiệu cảm biến tích cực mức thấp)
+// Fire alarm state machine for an active-low sensor input
+typedef struct {
+    fire_fsm_state_t state;
+    uint32_t debounce_us;   // Time the input must stay active before alarming
+    uint32_t recovery_us;   // Time the input must stay inactive before clearing
+    uint32_t edge_ccount;   // Cycle count of the edge that started the debounce
+    uint32_t timer_ccount;  // Cycle count the remaining time is counted from
+    uint32_t timer_us;      // Remaining time of the running timer from timer_ccount
+    bool timer_running;
+} fire_fsm_t;
+
+// Thống kê độ trễ từ cạnh cảm biến tới lúc bật báo động
+// Edge-to-alarm latency statistics, in microseconds
+typedef struct {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} fire_fsm_latency_t;
+
+/**
+ * @brief Initializes the state machine in the IDLE state
+ *
+ * @param fsm State machine
+ * @param debounce_us Time the input must stay active before the alarm fires
+ * @param recovery_us Time the input must stay inactive before the alarm clears
+ */
+void fire_fsm_init(fire_fsm_t *fsm, uint32_t debounce_us, uint32_t recovery_us);
+
+/**
+ * @brief Feeds one sensor edge into the state machine
+ *
+ * @param fsm State machine
+ * @param active true if the sensor input is active (low) after the edge
+ * @param ccount Cycle count timestamp of the edge
+ * @param action Output: actions to perform
+ */
+void fire_fsm_edge(fire_fsm_t *fsm, bool active, uint32_t ccount, fire_fsm_action_t *action);
+
+/**
+ * @brief Notifies the state machine that its one-shot timer expired
+ *
+ * Stale expirations (timer cancelled or restarted after it fired) are
+ * detected from the elapsed time and ignored. An expiration before the end
+ * of the timeout (a stale one, or one step of a timeout longer than
+ * FIRE_FSM_TIMER_STEP_US) moves the reference point to @p ccount and asks
+ * for the timer to be restarted for the next step.
+ *
+ * @param fsm State machine
+ * @param active Current sensor level (true = active)
+ * @param ccount Current cycle count
+ * @param action Output: actions to perform
+ */
+void fire_fsm_timeout(fire_fsm_t *fsm, bool active, uint32_t ccount, fire_fsm_action_t *action);
+
+/**
+ * @brief Records one edge-to-alarm latency sample
+ */
+void fire_fsm_latency_record(fire_fsm_latency_t *stats, uint32_t latency_us);
+
+#endif
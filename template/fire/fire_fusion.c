@@ -0,0 +1,389 @@
+#include <string.h>
+#include "fire_fusion.h"
+
+// Số nhân từ đơn vị đặc trưng sang nền (nhân thay cho dịch trái vì giá trị có thể âm)
+#define BASELINE_ONE (1 << FIRE_FUSION_BASELINE_FRAC_BITS)
+
+bool fire_fusion_init(fire_fusion_t *fusion, const fire_fusion_config_t *config, uint32_t now_ms)
+{
+    memset(fusion, 0, sizeof(*fusion));
+    fusion->config = config;
+    fusion->next_epoch_ms = now_ms;
+    if (config->epoch_ms == 0 || config->score_on > FIRE_FUSION_EVIDENCE_MAX || config->score_off > config->score_on) {
+        return false;
+    }
+    for (int i = 0; i < FIRE_FUSION_FEATURES; i++) {
+        const fire_fusion_feature_config_t *f = &config->features[i];
+        if (f->weight == 0) {
+            continue;
+        }
+        if (f->mode > FIRE_FUSION_RISE || (f->direction != 1 && f->direction != -1) || f->dev_hi <= f->dev_lo ||
+            f->baseline_shift > 30 ||
+            (f->mode == FIRE_FUSION_RISE && (f->rise_epochs == 0 || f->rise_epochs > FIRE_FUSION_RISE_MAX))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Đưa mẫu vào mẫu giữ nếu nó không cũ hơn mẫu đang giữ
+static void fusion_hold(fire_fusion_channel_t *ch, const fire_fusion_sample_t *sample)
+{
+    if (!ch->held_valid || (int32_t)(sample->ms - ch->held.ms) >= 0) {
+        ch->held = *sample;
+        ch->held_valid = true;
+    }
+}
+
+void fire_fusion_sample(fire_fusion_t *fusion, fire_fusion_feature_t feature, int32_t value, uint32_t ms)
+{
+    fire_fusion_channel_t *ch = &fusion->ch[feature];
+    fire_fusion_sample_t sample = { .ms = ms, .value = value };
+
+    // Mốc đã tính không được tính lại: mẫu đến muộn chỉ có tác dụng từ mốc sau
+    uint32_t scored_ms = fusion->next_epoch_ms - fusion->config->epoch_ms;
+    if (fusion->epochs > 0 && (int32_t)(ms - scored_ms) <= 0) {
+        fusion->late++;
+        fusion_hold(ch, &sample);
+        return;
+    }
+    // Hàng đợi đầy (task không tính mốc): bỏ mẫu cũ nhất, mẫu sau nó thay thế
+    // nó ở mọi mốc trừ các mốc nằm giữa hai mẫu
+    if (ch->pending_count == FIRE_FUSION_PENDING) {
+        fusion->dropped++;
+        memmove(&ch->pending[0], &ch->pending[1], (FIRE_FUSION_PENDING - 1) * sizeof(ch->pending[0]));
+        ch->pending_count--;
+    }
+    // Chèn theo thời gian; mẫu thường đến đúng thứ tự nên vòng lặp dừng ngay
+    int i = ch->pending_count;
+    while (i > 0 && (int32_t)(ch->pending[i - 1].ms - ms) > 0) {
+        ch->pending[i] = ch->pending[i - 1];
+        i--;
+    }
+    ch->pending[i] = sample;
+    ch->pending_count++;
+}
+
+static uint16_t fusion_evidence(int32_t deviation, int32_t lo, int32_t hi)
+{
+    if (deviation <= lo) {
+        return 0;
+    }
+    if (deviation >= hi) {
+        return FIRE_FUSION_EVIDENCE_MAX;
+    }
+    return (int64_t)(deviation - lo) * FIRE_FUSION_EVIDENCE_MAX / (hi - lo);
+}
+
+// Độ lệch của giá trị đang giữ tại một mốc, đã nhân với hướng
+static int32_t fusion_deviation(fire_fusion_channel_t *ch, const fire_fusion_feature_config_t *cfg, int32_t value)
+{
+    int32_t deviation = 0;
+
+    if (cfg->mode == FIRE_FUSION_RISE) {
+        // history_count < rise_epochs: lịch sử chưa quay vòng, ô 0 là mốc cũ nhất
+        int32_t reference = ch->history_count == 0 ? value
+                            : ch->history[ch->history_count < cfg->rise_epochs ? 0 : ch->history_pos];
+        deviation = value - reference;
+        ch->history[ch->history_pos] = value;
+        ch->history_pos = ch->history_pos + 1 == cfg->rise_epochs ? 0 : ch->history_pos + 1;
+        if (ch->history_count < cfg->rise_epochs) {
+            ch->history_count++;
+        }
+        return deviation * cfg->direction;
+    }
+
+    if (!ch->baseline_valid) {
+        ch->baseline = (int64_t)value * BASELINE_ONE;
+        ch->baseline_valid = true;
+    }
+    int32_t baseline = ch->baseline / BASELINE_ONE;
+    if (cfg->mode == FIRE_FUSION_LEVEL) {
+        deviation = value - baseline;
+    } else if (baseline > 0) {
+        deviation = (int64_t)(value - baseline) * 1000 / baseline;
+    }
+    deviation *= cfg->direction;
+
+    // Nền chỉ theo tín hiệu khi độ lệch dưới nửa dev_lo: thay đổi chậm nhưng
+    // kéo dài của đám cháy âm ỉ không bị coi là độ trôi
+    if (cfg->baseline_shift > 0 && deviation < cfg->dev_lo / 2) {
+        ch->baseline += ((int64_t)value * BASELINE_ONE - ch->baseline) >> cfg->baseline_shift;
+    }
+    return deviation;
+}
+
+static void fusion_score_epoch(fire_fusion_t *fusion, uint32_t epoch_ms)
+{
+    const fire_fusion_config_t *cfg = fusion->config;
+    int32_t sum = 0, weights = 0;
+    uint8_t agree = 0;
+
+    for (int i = 0; i < FIRE_FUSION_FEATURES; i++) {
+        const fire_fusion_feature_config_t *fc = &cfg->features[i];
+        fire_fusion_channel_t *ch = &fusion->ch[i];
+
+        // Căn chỉnh: mọi mẫu đo không muộn hơn mốc được đưa vào mẫu giữ
+        uint8_t n = 0;
+        while (n < ch->pending_count && (int32_t)(ch->pending[n].ms - epoch_ms) <= 0) {
+            fusion_hold(ch, &ch->pending[n]);
+            n++;
+        }
+        if (n > 0) {
+            memmove(&ch->pending[0], &ch->pending[n], (ch->pending_count - n) * sizeof(ch->pending[0]));
+            ch->pending_count -= n;
+        }
+
+        ch->fresh = fc->weight != 0 && ch->held_valid && epoch_ms - ch->held.ms <= fc->max_age_ms;
+        if (!ch->fresh) {
+            // Cảm biến im lặng: tốc độ tăng tính lại từ đầu khi có mẫu mới
+            ch->deviation = 0;
+            ch->evidence = 0;
+            ch->history_count = 0;
+            ch->history_pos = 0;
+            continue;
+        }
+        ch->deviation = fusion_deviation(ch, fc, ch->held.value);
+        ch->evidence = fusion_evidence(ch->deviation, fc->dev_lo, fc->dev_hi);
+
+        sum += (int32_t)fc->weight * ch->evidence;
+        if (fc->weight > 0) {
+            weights += fc->weight;
+            if (ch->evidence >= FIRE_FUSION_AGREE) {
+                agree++;
+            }
+        }
+    }
+
+    // Chuẩn hóa theo tổng trọng số dương của các đặc trưng còn mẫu, nên thiếu
+    // một cảm biến không kéo điểm xuống; trọng số âm chỉ trừ bớt
+    int32_t score = weights > 0 && sum > 0 ? sum / weights : 0;
+    fusion->score = score > FIRE_FUSION_EVIDENCE_MAX ? FIRE_FUSION_EVIDENCE_MAX : score;
+    fusion->agree = agree;
+
+    if (!fusion->alarm) {
+        if (fusion->score >= cfg->score_on && agree >= cfg->min_agree) {
+            if (fusion->over_epochs < UINT8_MAX) {
+                fusion->over_epochs++;
+            }
+            fusion->alarm = fusion->over_epochs >= cfg->confirm_epochs;
+        } else {
+            fusion->over_epochs = 0;
+        }
+    } else if (fusion->score < cfg->score_off) {
+        fusion->alarm = false;
+        fusion->over_epochs = 0;
+    }
+    fusion->epochs++;
+}
+
+bool fire_fusion_step(fire_fusion_t *fusion, uint32_t now_ms)
+{
+    const fire_fusion_config_t *cfg = fusion->config;
+
+    while ((int32_t)(now_ms - fusion->next_epoch_ms - cfg->align_ms) >= 0) {
+        fusion_score_epoch(fusion, fusion->next_epoch_ms);
+        fusion->next_epoch_ms += cfg->epoch_ms;
+    }
+    return fusion->alarm;
+}
+
+uint32_t fire_fusion_fresh_mask(const fire_fusion_t *fusion)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < FIRE_FUSION_FEATURES; i++) {
+        if (fusion->ch[i].fresh) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#ifndef FIRE_HOST_BUILD
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fire_rtos.h"
+#include "fire_health.h"
+#include "fire_i2c_sched.h"
+#include "bme680/bme680.h"
+#include "ccs811/ccs811.h"
+#include "sht3x/sht3x.h"
+
+// Địa chỉ I2C: SDO của BME680 nối VDD, ADDR của CCS811 và SHT3x nối GND
+#ifndef FIRE_FUSION_BME680_ADDR
+#define FIRE_FUSION_BME680_ADDR BME680_I2C_ADDRESS_2
+#endif
+#ifndef FIRE_FUSION_CCS811_ADDR
+#define FIRE_FUSION_CCS811_ADDR CCS811_I2C_ADDRESS_1
+#endif
+#ifndef FIRE_FUSION_SHT3X_ADDR
+#define FIRE_FUSION_SHT3X_ADDR SHT3x_ADDR_1
+#endif
+// BME680 đo cưỡng bức mỗi 3 s với bộ sấy 320 °C trong 150 ms; CCS811 và SHT3x
+// tự đo mỗi giây, task chỉ đọc kết quả
+#define FIRE_FUSION_BME680_PERIOD_MS 3000
+#define FIRE_FUSION_HEATER_C         320
+#define FIRE_FUSION_HEATER_MS        150
+#define FIRE_FUSION_CCS811_PERIOD_MS 1000
+#define FIRE_FUSION_SHT3X_PERIOD_MS  1000
+// Chu kỳ bù nhiệt độ/độ ẩm cho CCS811 bằng kết quả của SHT3x
+#define FIRE_FUSION_COMPENSATE_MS 60000
+// Task thức dậy ít nhất mỗi mốc; I2C treo vài giây vẫn chưa phải lỗi
+#define FIRE_FUSION_HEALTH_LIMIT_MS 10000
+
+static const fire_fusion_config_t fire_fusion_config = FIRE_FUSION_DEFAULTS;
+static fire_fusion_t fire_fusion;
+static fire_i2c_sched_t fire_fusion_sched;
+static bme680_sensor_t *fire_fusion_bme680;
+static ccs811_sensor_t *fire_fusion_ccs811;
+static sht3x_sensor_t *fire_fusion_sht3x;
+static int fire_fusion_bme680_job = -1;
+static int fire_fusion_ccs811_job = -1;
+static uint32_t fire_fusion_compensated_ms;
+static void (*fire_fusion_changed)(bool alarm);
+static SemaphoreHandle_t fire_fusion_bus_mutex;
+FIRE_TASK_STORAGE(fire_fusion_task, 512);
+
+static uint32_t fire_fusion_now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static bool fire_fusion_bme680_step(fire_i2c_step_t step, uint32_t now_ms)
+{
+    if (step == FIRE_I2C_START) {
+        return bme680_force_measurement(fire_fusion_bme680);
+    }
+    bme680_values_fixed_t values;
+    if (!bme680_get_results_fixed(fire_fusion_bme680, &values) || values.gas_resistance == 0) {
+        return false;
+    }
+    fire_fusion_sample(&fire_fusion, FIRE_FUSION_GAS, values.gas_resistance, now_ms);
+    // Không có SHT3x: dùng nhiệt độ/độ ẩm của BME680 (đọc cao hơn vì bộ sấy)
+    if (fire_fusion_sht3x == NULL) {
+        fire_fusion_sample(&fire_fusion, FIRE_FUSION_TEMP, values.temperature, now_ms);
+        fire_fusion_sample(&fire_fusion, FIRE_FUSION_HUMIDITY, values.humidity / 10, now_ms);
+    }
+    return true;
+}
+
+static bool fire_fusion_ccs811_step(uint32_t now_ms)
+{
+    uint16_t tvoc, eco2;
+    if (!ccs811_get_results(fire_fusion_ccs811, &tvoc, &eco2, NULL, NULL)) {
+        return false;
+    }
+    fire_fusion_sample(&fire_fusion, FIRE_FUSION_TVOC, tvoc, now_ms);
+    fire_fusion_sample(&fire_fusion, FIRE_FUSION_ECO2, eco2, now_ms);
+    return true;
+}
+
+static bool fire_fusion_sht3x_step(uint32_t now_ms)
+{
+    float temperature, humidity;
+    if (!sht3x_get_results(fire_fusion_sht3x, &temperature, &humidity)) {
+        return false;
+    }
+    fire_fusion_sample(&fire_fusion, FIRE_FUSION_TEMP, (int32_t)(temperature * 100), now_ms);
+    fire_fusion_sample(&fire_fusion, FIRE_FUSION_HUMIDITY, (int32_t)(humidity * 100), now_ms);
+    if (fire_fusion_ccs811 != NULL && now_ms - fire_fusion_compensated_ms >= FIRE_FUSION_COMPENSATE_MS) {
+        ccs811_set_environmental_data(fire_fusion_ccs811, temperature, humidity);
+        fire_fusion_compensated_ms = now_ms;
+    }
+    return true;
+}
+
+// Task duy nhất dùng các cảm biến này: chạy bước đến hạn của lịch (giữ mutex
+// của bus dùng chung), tính các mốc đã đủ mẫu rồi ngủ tới bước sau (tối đa một mốc)
+static void fire_fusion_task(void *pvParameters)
+{
+    int health = fire_health_register_task("fire_fusion", FIRE_FUSION_HEALTH_LIMIT_MS);
+    bool alarm = false;
+
+    while (1) {
+        fire_health_beat(health);
+        uint32_t now = fire_fusion_now_ms(), wait_ms;
+        int job = fire_i2c_sched_next(&fire_fusion_sched, now, &wait_ms);
+        if (job >= 0) {
+            bool ok;
+            xSemaphoreTake(fire_fusion_bus_mutex, portMAX_DELAY);
+            if (job == fire_fusion_bme680_job) {
+                ok = fire_fusion_bme680_step(fire_i2c_sched_step(&fire_fusion_sched, job), now);
+            } else if (job == fire_fusion_ccs811_job) {
+                ok = fire_fusion_ccs811_step(now);
+            } else {
+                ok = fire_fusion_sht3x_step(now);
+            }
+            xSemaphoreGive(fire_fusion_bus_mutex);
+            fire_i2c_sched_done(&fire_fusion_sched, job, fire_fusion_now_ms(), ok);
+        }
+
+        if (fire_fusion_step(&fire_fusion, fire_fusion_now_ms()) != alarm) {
+            alarm = fire_fusion.alarm;
+            printf("Fusion alarm %s: score %u, %u sensors agree, fresh 0x%02x\n", alarm ? "raised" : "cleared",
+                   fire_fusion.score, fire_fusion.agree, fire_fusion_fresh_mask(&fire_fusion));
+            fire_fusion_changed(alarm);
+        }
+
+        if (job < 0) {
+            if (wait_ms > fire_fusion_config.epoch_ms) {
+                wait_ms = fire_fusion_config.epoch_ms;
+            }
+            TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+            vTaskDelay(ticks > 0 ? ticks : 1);
+        }
+    }
+}
+
+bool fire_fusion_start(uint8_t bus, SemaphoreHandle_t bus_mutex, void (*changed)(bool alarm))
+{
+    uint32_t now = fire_fusion_now_ms();
+
+    fire_fusion_changed = changed;
+    fire_fusion_bus_mutex = bus_mutex;
+    fire_i2c_sched_init(&fire_fusion_sched);
+    if (!fire_fusion_init(&fire_fusion, &fire_fusion_config, now)) {
+        return false;
+    }
+
+    // Dò và cấu hình các cảm biến trong một lần giữ bus
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    fire_fusion_bme680 = bme680_init_sensor(bus, FIRE_FUSION_BME680_ADDR, 0);
+    if (fire_fusion_bme680 != NULL) {
+        // Áp suất không dùng; thời gian đo phụ thuộc cài đặt nên lấy sau cùng
+        bme680_set_oversampling_rates(fire_fusion_bme680, osr_1x, osr_none, osr_1x);
+        bme680_set_heater_profile(fire_fusion_bme680, 0, FIRE_FUSION_HEATER_C, FIRE_FUSION_HEATER_MS);
+        bme680_use_heater_profile(fire_fusion_bme680, 0);
+        uint32_t convert_ms = bme680_get_measurement_duration(fire_fusion_bme680) * portTICK_PERIOD_MS;
+        fire_fusion_bme680_job = fire_i2c_sched_add(&fire_fusion_sched, "bme680", FIRE_FUSION_BME680_PERIOD_MS,
+                                                    convert_ms, now);
+    }
+    fire_fusion_ccs811 = ccs811_init_sensor(bus, FIRE_FUSION_CCS811_ADDR);
+    if (fire_fusion_ccs811 != NULL && !ccs811_set_mode(fire_fusion_ccs811, ccs811_mode_1s)) {
+        fire_fusion_ccs811 = NULL;
+    }
+    if (fire_fusion_ccs811 != NULL) {
+        // Kết quả đầu tiên có sau một chu kỳ đo
+        fire_fusion_ccs811_job = fire_i2c_sched_add(&fire_fusion_sched, "ccs811", FIRE_FUSION_CCS811_PERIOD_MS, 0,
+                                                    now + FIRE_FUSION_CCS811_PERIOD_MS);
+        fire_fusion_compensated_ms = now - FIRE_FUSION_COMPENSATE_MS;
+    }
+    fire_fusion_sht3x = sht3x_init_sensor(bus, FIRE_FUSION_SHT3X_ADDR);
+    if (fire_fusion_sht3x != NULL && !sht3x_start_measurement(fire_fusion_sht3x, sht3x_periodic_1mps, sht3x_high)) {
+        fire_fusion_sht3x = NULL;
+    }
+    if (fire_fusion_sht3x != NULL) {
+        fire_i2c_sched_add(&fire_fusion_sched, "sht3x", FIRE_FUSION_SHT3X_PERIOD_MS, 0,
+                           now + FIRE_FUSION_SHT3X_PERIOD_MS);
+    }
+    xSemaphoreGive(bus_mutex);
+
+    printf("Fusion sensors: bme680 %s, ccs811 %s, sht3x %s\n", fire_fusion_bme680 != NULL ? "ok" : "missing",
+           fire_fusion_ccs811 != NULL ? "ok" : "missing", fire_fusion_sht3x != NULL ? "ok" : "missing");
+    if (fire_fusion_sched.count == 0) {
+        return false;
+    }
+    return FIRE_TASK_CREATE(fire_fusion_task, fire_fusion_task, NULL, 2, NULL) == pdPASS;
+}
+#endif
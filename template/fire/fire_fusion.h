@@ -0,0 +1,170 @@
+#ifndef FIRE_FUSION_H
+#define FIRE_FUSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Kết hợp nhiều cảm biến khí: BME680 (điện trở khí), CCS811 (TVOC, eCO2) và
+// SHT3x (nhiệt độ, độ ẩm) báo kết quả không đồng bộ, mỗi cảm biến một chu kỳ.
+// Các mẫu được căn về một lưới thời gian chung (giữ mẫu gần nhất không muộn
+// hơn mốc, bỏ qua mẫu quá cũ); mỗi đặc trưng được đổi thành bằng chứng 0..1000
+// so với nền hoặc tốc độ tăng của nó, rồi cộng có trọng số thành điểm khả năng
+// cháy. Trọng số âm (độ ẩm tăng do hơi nước) kéo điểm xuống để cắt báo động giả.
+// Kết quả là một bit đầu vào của bộ xử lý vùng, như kênh khói analog.
+
+// Giá trị của từng đặc trưng, theo đơn vị nguyên của driver
+// Fused features, in the drivers' integer units
+typedef enum {
+    FIRE_FUSION_GAS,      // BME680 gas resistance, ohm (falls with combustion products)
+    FIRE_FUSION_TVOC,     // CCS811 total VOC, ppb
+    FIRE_FUSION_ECO2,     // CCS811 equivalent CO2, ppm
+    FIRE_FUSION_TEMP,     // SHT3x temperature, 0.01 degree C
+    FIRE_FUSION_HUMIDITY, // SHT3x relative humidity, 0.01 %
+    FIRE_FUSION_FEATURES
+} fire_fusion_feature_t;
+
+// Cách đo độ lệch của một đặc trưng
+// How a feature's deviation is measured
+typedef enum {
+    FIRE_FUSION_LEVEL, // Value minus baseline
+    FIRE_FUSION_RATIO, // (value - baseline) / baseline, permille
+    FIRE_FUSION_RISE,  // Value minus the value rise_epochs earlier
+} fire_fusion_mode_t;
+
+// Bằng chứng đầy đủ của một đặc trưng, cũng là điểm lớn nhất
+#define FIRE_FUSION_EVIDENCE_MAX 1000
+// Bằng chứng từ mức này thì đặc trưng được tính là đồng ý
+#define FIRE_FUSION_AGREE 500
+// Số mẫu mới hơn mốc đã tính được giữ chờ căn chỉnh, mỗi đặc trưng
+#define FIRE_FUSION_PENDING 4
+// Cửa sổ tốc độ tăng dài nhất, tính bằng mốc
+#define FIRE_FUSION_RISE_MAX 64
+// Nền giữ 8 bit phân số để theo kịp độ trôi chậm
+#define FIRE_FUSION_BASELINE_FRAC_BITS 8
+
+// Cài đặt của một đặc trưng
+// Settings of one feature
+typedef struct {
+    uint8_t mode;           // fire_fusion_mode_t
+    int8_t direction;       // +1 rising values look like fire, -1 falling values
+    uint8_t rise_epochs;    // RISE window in epochs (1..FIRE_FUSION_RISE_MAX)
+    uint8_t baseline_shift; // LEVEL/RATIO baseline y += (x - y) / 2^n per epoch without evidence, 0 = fixed
+    int16_t weight;         // Weight in the score, negative = inhibits, 0 = ignored
+    int32_t dev_lo;         // Deviation that still gives no evidence
+    int32_t dev_hi;         // Deviation that gives full evidence (> dev_lo)
+    uint32_t max_age_ms;    // A sample older than this at an epoch leaves the feature out
+} fire_fusion_feature_config_t;
+
+// Cài đặt chung của bộ kết hợp
+// Fusion settings
+typedef struct {
+    fire_fusion_feature_config_t features[FIRE_FUSION_FEATURES];
+    uint32_t epoch_ms;      // Period of the common time grid
+    uint32_t align_ms;      // Epoch t is scored at t + align_ms so late deliveries still count
+    uint16_t score_on;      // Score that raises the alarm (0..FIRE_FUSION_EVIDENCE_MAX)
+    uint16_t score_off;     // Score under which it clears (<= score_on)
+    uint8_t confirm_epochs; // Consecutive epochs over score_on before raising
+    uint8_t min_agree;      // Positive-weight features at FIRE_FUSION_AGREE needed to raise
+} fire_fusion_config_t;
+
+// Cài đặt chỉnh theo các bản ghi test/traces/fusion_*.csv (lưới 1 s): khí
+// giảm 15-60 % so với nền, TVOC (bão hòa ở 1187 ppb) và eCO2 vượt nền, nhiệt
+// độ tăng 1,5-8 °C/phút (đầu báo nhiệt gia tăng); độ ẩm cao hơn nền 5-20 %
+// thì trừ điểm
+#define FIRE_FUSION_DEFAULTS { \
+        .features = { \
+            [FIRE_FUSION_GAS] = { .mode = FIRE_FUSION_RATIO, .direction = -1, .baseline_shift = 8, .weight = 30, \
+                                  .dev_lo = 150, .dev_hi = 600, .max_age_ms = 10000 }, \
+            [FIRE_FUSION_TVOC] = { .mode = FIRE_FUSION_LEVEL, .direction = 1, .baseline_shift = 8, .weight = 20, \
+                                   .dev_lo = 100, .dev_hi = 1000, .max_age_ms = 5000 }, \
+            [FIRE_FUSION_ECO2] = { .mode = FIRE_FUSION_LEVEL, .direction = 1, .baseline_shift = 8, .weight = 15, \
+                                   .dev_lo = 300, .dev_hi = 1500, .max_age_ms = 5000 }, \
+            [FIRE_FUSION_TEMP] = { .mode = FIRE_FUSION_RISE, .direction = 1, .rise_epochs = 60, .weight = 35, \
+                                   .dev_lo = 150, .dev_hi = 800, .max_age_ms = 5000 }, \
+            [FIRE_FUSION_HUMIDITY] = { .mode = FIRE_FUSION_LEVEL, .direction = 1, .baseline_shift = 8, .weight = -30, \
+                                       .dev_lo = 500, .dev_hi = 2000, .max_age_ms = 5000 }, \
+        }, \
+        .epoch_ms = 1000, .align_ms = 500, .score_on = 450, .score_off = 250, .confirm_epochs = 5, .min_agree = 2 }
+
+typedef struct {
+    uint32_t ms;
+    int32_t value;
+} fire_fusion_sample_t;
+
+// Trạng thái của một đặc trưng
+// State of one feature
+typedef struct {
+    fire_fusion_sample_t pending[FIRE_FUSION_PENDING]; // Samples after the last scored epoch, by time
+    fire_fusion_sample_t held;                         // Latest sample at or before the last scored epoch
+    int64_t baseline;                                  // Baseline, FIRE_FUSION_BASELINE_FRAC_BITS
+    int32_t history[FIRE_FUSION_RISE_MAX];             // Held values of the last epochs for RISE
+    int32_t deviation;                                 // At the last scored epoch
+    uint16_t evidence;                                 // 0..FIRE_FUSION_EVIDENCE_MAX, 0 when stale
+    uint8_t pending_count;
+    uint8_t history_pos;
+    uint8_t history_count;
+    bool held_valid;
+    bool baseline_valid;
+    bool fresh;                                        // Took part in the last score
+} fire_fusion_channel_t;
+
+typedef struct {
+    const fire_fusion_config_t *config;
+    fire_fusion_channel_t ch[FIRE_FUSION_FEATURES];
+    uint32_t next_epoch_ms; // Next epoch to score
+    uint16_t score;         // Score of the last epoch
+    uint8_t agree;          // Agreeing features at the last epoch
+    uint8_t over_epochs;    // Consecutive epochs meeting the raise condition
+    bool alarm;
+    uint32_t epochs;        // Scored epochs
+    uint32_t late;          // Samples delivered after their epoch was scored
+    uint32_t dropped;       // Pending samples discarded because the queue was full
+} fire_fusion_t;
+
+/**
+ * @brief Initializes the engine; the first epoch is @p now_ms
+ *
+ * @param config Settings, kept by reference
+ * @return false if the settings are out of range
+ */
+bool fire_fusion_init(fire_fusion_t *fusion, const fire_fusion_config_t *config, uint32_t now_ms);
+
+/**
+ * @brief Adds a sample measured at @p ms
+ *
+ * Samples of one feature may arrive up to align_ms after their time; a
+ * sample older than the last scored epoch still replaces the held value
+ * (counted in late).
+ */
+void fire_fusion_sample(fire_fusion_t *fusion, fire_fusion_feature_t feature, int32_t value, uint32_t ms);
+
+/**
+ * @brief Scores every epoch up to @p now_ms - align_ms
+ *
+ * @return true while the alarm is raised
+ */
+bool fire_fusion_step(fire_fusion_t *fusion, uint32_t now_ms);
+
+/**
+ * @brief Bit i set when feature i took part in the last score
+ */
+uint32_t fire_fusion_fresh_mask(const fire_fusion_t *fusion);
+
+#ifndef FIRE_HOST_BUILD
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/**
+ * @brief Probes the sensors on @p bus and starts the polling task
+ *
+ * Call after i2c_init(). Missing sensors are left out of the schedule and
+ * their features go stale.
+ *
+ * @param bus_mutex Held around every transaction on @p bus, shared with its other users
+ * @param changed Called in the polling task when the alarm rises or clears
+ * @return false if no sensor answered or the task could not be created
+ */
+bool fire_fusion_start(uint8_t bus, SemaphoreHandle_t bus_mutex, void (*changed)(bool alarm));
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+#include <stddef.h>
+#include <string.h>
+#include "fire_health.h"
+
+void fire_health_init(fire_health_t *health)
+{
+    memset(health, 0, sizeof(*health));
+}
+
+int fire_health_register(fire_health_t *health, const char *name, void *task, uint32_t limit_ms, uint32_t now_ms)
+{
+    if (health->count >= FIRE_HEALTH_SLOTS) {
+        return -1;
+    }
+    fire_health_slot_t *slot = &health->slots[health->count];
+    memset(slot, 0, sizeof(*slot));
+    slot->name = name;
+    slot->task = task;
+    slot->limit_ms = limit_ms;
+    slot->last_beat_ms = now_ms;
+    slot->stack_min_words = UINT32_MAX;
+    return health->count++;
+}
+
+fire_health_stage_t fire_health_stage_for(uint32_t silence_ms, uint32_t limit_ms)
+{
+    if (silence_ms > 3 * limit_ms) {
+        return FIRE_HEALTH_RESTART;
+    }
+    if (silence_ms > 2 * limit_ms) {
+        return FIRE_HEALTH_STALLED;
+    }
+    if (silence_ms > limit_ms) {
+        return FIRE_HEALTH_LATE;
+    }
+    return FIRE_HEALTH_OK;
+}
+
+bool fire_health_stack_sample(fire_health_t *health, int slot, uint32_t words)
+{
+    fire_health_slot_t *s = &health->slots[slot];
+    if (words >= s->stack_min_words) {
+        return false;
+    }
+    s->stack_min_words = words;
+    return words < FIRE_HEALTH_STACK_LOW_WORDS;
+}
+
+uint32_t fire_health_check(fire_health_t *health, uint32_t now_ms)
+{
+    uint32_t raised = 0;
+
+    for (uint32_t i = 0; i < health->count; i++) {
+        fire_health_slot_t *s = &health->slots[i];
+        uint32_t beats = s->beats;
+        uint32_t elapsed = now_ms - s->last_beat_ms;
+
+        if (beats != s->seen_beats) {
+            // Chu kỳ trung bình từ lần thay đổi trước; độ phân giải là chu kỳ kiểm tra
+            s->period_ms = elapsed / (beats - s->seen_beats);
+            if (s->period_ms > s->period_max_ms) {
+                s->period_max_ms = s->period_ms;
+            }
+            s->seen_beats = beats;
+            s->last_beat_ms = now_ms;
+            s->stage = FIRE_HEALTH_OK;
+            continue;
+        }
+
+        if (elapsed > s->silence_max_ms) {
+            s->silence_max_ms = elapsed;
+        }
+        fire_health_stage_t stage = fire_health_stage_for(elapsed, s->limit_ms);
+        if (stage > s->stage) {
+            s->stage = stage;
+            raised |= 1u << i;
+        }
+    }
+    return raised;
+}
+
+fire_health_stage_t fire_health_worst(const fire_health_t *health)
+{
+    fire_health_stage_t worst = FIRE_HEALTH_OK;
+    for (uint32_t i = 0; i < health->count; i++) {
+        if (health->slots[i].stage > worst) {
+            worst = health->slots[i].stage;
+        }
+    }
+    return worst;
+}
+
+#ifndef FIRE_HOST_BUILD
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "led_manager.h"
+#include "fire_rtos.h"
+
+static fire_health_t fire_health;
+static TimerHandle_t fire_health_timer;
+FIRE_TIMER_STORAGE(fire_health);
+static void (*fire_health_restart)(const char *name);
+// LED lỗi đang báo có task không phản hồi
+static bool fire_health_fault_shown;
+
+static uint32_t fire_health_now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static int fire_health_add(const char *name, void *task, uint32_t limit_ms)
+{
+    taskENTER_CRITICAL();
+    int slot = fire_health_register(&fire_health, name, task, limit_ms, fire_health_now_ms());
+    taskEXIT_CRITICAL();
+    if (slot < 0) {
+        printf("Health: no slot left for %s\n", name);
+    }
+    return slot;
+}
+
+int fire_health_register_task(const char *name, uint32_t limit_ms)
+{
+    return fire_health_add(name, xTaskGetCurrentTaskHandle(), limit_ms);
+}
+
+int fire_health_register_callback(const char *name, uint32_t limit_ms)
+{
+    return fire_health_add(name, NULL, limit_ms);
+}
+
+void fire_health_beat(int slot)
+{
+    if (slot >= 0) {
+        fire_health_beat_slot(&fire_health, slot);
+    }
+}
+
+static void fire_health_timer_callback(TimerHandle_t timer)
+{
+    for (uint32_t i = 0; i < fire_health.count; i++) {
+        fire_health_slot_t *s = &fire_health.slots[i];
+        if (s->task != NULL && fire_health_stack_sample(&fire_health, i, uxTaskGetStackHighWaterMark(s->task))) {
+            printf("Warning: %s stack low: %u words\n", s->name, s->stack_min_words);
+        }
+    }
+
+    uint32_t raised = fire_health_check(&fire_health, fire_health_now_ms());
+    for (uint32_t i = 0; i < fire_health.count; i++) {
+        const fire_health_slot_t *s = &fire_health.slots[i];
+        if (!(raised & (1u << i))) {
+            continue;
+        }
+        if (!fire_health_fault_shown) {
+            set_led_pattern(FAULT, LED_PATTERN_FAULT_CHIRP);
+            fire_health_fault_shown = true;
+        }
+        if (s->stage >= FIRE_HEALTH_STALLED) {
+            printf("Health: %s silent for %u ms (limit %u ms, %u beats, period %u ms)\n",
+                   s->name, fire_health_now_ms() - s->last_beat_ms, s->limit_ms, s->seen_beats, s->period_ms);
+        }
+        if (s->stage == FIRE_HEALTH_RESTART && fire_health_restart != NULL) {
+            fire_health_restart(s->name);
+        }
+    }
+    if (fire_health_fault_shown && fire_health_worst(&fire_health) == FIRE_HEALTH_OK) {
+        set_led_state(FAULT, LED_OFF, 0);
+        fire_health_fault_shown = false;
+    }
+}
+
+bool fire_health_start(void (*restart)(const char *name))
+{
+    fire_health_restart = restart;
+    fire_health_timer = FIRE_TIMER_CREATE(fire_health, pdMS_TO_TICKS(FIRE_HEALTH_CHECK_MS), pdTRUE,
+                                          fire_health_timer_callback);
+    return fire_health_timer != NULL && xTimerStart(fire_health_timer, 0) == pdPASS;
+}
+
+uint32_t fire_health_get_stats(fire_health_slot_t *slots, uint32_t max)
+{
+    taskENTER_CRITICAL();
+    uint32_t count = fire_health.count < max ? fire_health.count : max;
+    memcpy(slots, fire_health.slots, count * sizeof(slots[0]));
+    taskEXIT_CRITICAL();
+    return count;
+}
+#endif
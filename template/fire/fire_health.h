@@ -0,0 +1,125 @@
+#ifndef FIRE_HEALTH_H
+#define FIRE_HEALTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Giám sát sức khỏe task: mỗi task đăng ký một ô heartbeat và tăng bộ đếm của
+// nó mỗi vòng lặp (chỉ task đó ghi nên không cần khóa). Timer giám sát đọc các
+// bộ đếm theo chu kỳ; ô nào im lặng quá giới hạn thì leo thang: LED lỗi, rồi
+// ghi log, rồi khởi động lại có kiểm soát.
+
+#define FIRE_HEALTH_SLOTS 8
+
+// Chu kỳ kiểm tra của timer giám sát, cũng là độ phân giải của thống kê
+#ifndef FIRE_HEALTH_CHECK_MS
+#define FIRE_HEALTH_CHECK_MS 1000
+#endif
+// Cảnh báo khi high-water mark của stack xuống dưới mức này (word)
+#ifndef FIRE_HEALTH_STACK_LOW_WORDS
+#define FIRE_HEALTH_STACK_LOW_WORDS 50
+#endif
+
+// Mức leo thang của một ô, theo thời gian im lặng so với giới hạn
+// Escalation stages by silence relative to the slot's limit
+typedef enum {
+    FIRE_HEALTH_OK,      // Beat within the limit
+    FIRE_HEALTH_LATE,    // Over 1x the limit: fault LED
+    FIRE_HEALTH_STALLED, // Over 2x: log the slot
+    FIRE_HEALTH_RESTART, // Over 3x: controlled restart
+} fire_health_stage_t;
+
+// Một ô heartbeat và thống kê của nó
+// One heartbeat slot with its statistics
+typedef struct {
+    const char *name;
+    void *task;                 // TaskHandle_t for stack sampling, NULL for callbacks
+    uint32_t limit_ms;          // Longest silence allowed between beats
+    volatile uint32_t beats;    // Written by the owning task only
+    uint32_t seen_beats;        // Count at the last check that saw it change
+    uint32_t last_beat_ms;      // When the count was last seen changing
+    uint32_t period_ms;         // Mean loop period over the last beating check
+    uint32_t period_max_ms;     // Largest mean loop period seen
+    uint32_t silence_max_ms;    // Longest silence seen
+    uint32_t stack_min_words;   // Lowest stack high-water mark, UINT32_MAX if not sampled
+    fire_health_stage_t stage;
+} fire_health_slot_t;
+
+typedef struct {
+    fire_health_slot_t slots[FIRE_HEALTH_SLOTS];
+    uint32_t count;
+} fire_health_t;
+
+void fire_health_init(fire_health_t *health);
+
+/**
+ * @brief Adds a slot
+ *
+ * @param task Task whose stack is sampled, or NULL
+ * @param limit_ms Longest silence allowed between beats
+ * @return Slot number, -1 if every slot is taken
+ */
+int fire_health_register(fire_health_t *health, const char *name, void *task, uint32_t limit_ms, uint32_t now_ms);
+
+static inline void fire_health_beat_slot(fire_health_t *health, int slot)
+{
+    health->slots[slot].beats++;
+}
+
+/**
+ * @brief Stage reached after @p silence_ms without a beat
+ */
+fire_health_stage_t fire_health_stage_for(uint32_t silence_ms, uint32_t limit_ms);
+
+/**
+ * @brief Records a stack high-water sample of a slot
+ *
+ * @return true if it is a new minimum under FIRE_HEALTH_STACK_LOW_WORDS
+ */
+bool fire_health_stack_sample(fire_health_t *health, int slot, uint32_t words);
+
+/**
+ * @brief Reads every beat counter and updates periods and stages
+ *
+ * @return Bit i set when slot i rose to a higher stage
+ */
+uint32_t fire_health_check(fire_health_t *health, uint32_t now_ms);
+
+/**
+ * @brief Highest stage over all slots
+ */
+fire_health_stage_t fire_health_worst(const fire_health_t *health);
+
+#ifndef FIRE_HOST_BUILD
+/**
+ * @brief Registers the calling task (call from the task itself)
+ *
+ * @return Slot number for fire_health_beat(), -1 if every slot is taken
+ */
+int fire_health_register_task(const char *name, uint32_t limit_ms);
+
+/**
+ * @brief Registers a slot that is not a task (e.g. a tcpip callback)
+ */
+int fire_health_register_callback(const char *name, uint32_t limit_ms);
+
+/**
+ * @brief Beats a slot; does nothing for -1
+ */
+void fire_health_beat(int slot);
+
+/**
+ * @brief Starts the supervisor timer
+ *
+ * @param restart Called at FIRE_HEALTH_RESTART in the timer task; flushes
+ *        state and restarts the chip
+ */
+bool fire_health_start(void (*restart)(const char *name));
+
+/**
+ * @brief Copies the slots; @return number of slots
+ */
+uint32_t fire_health_get_stats(fire_health_slot_t *slots, uint32_t max);
+#endif
+
+#endif
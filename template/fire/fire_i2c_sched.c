@@ -0,0 +1,77 @@
+#include <string.h>
+#include "fire_i2c_sched.h"
+
+void fire_i2c_sched_init(fire_i2c_sched_t *sched)
+{
+    memset(sched, 0, sizeof(*sched));
+}
+
+int fire_i2c_sched_add(fire_i2c_sched_t *sched, const char *name, uint32_t period_ms, uint32_t convert_ms,
+                       uint32_t first_ms)
+{
+    if (sched->count >= FIRE_I2C_SCHED_JOBS || period_ms == 0) {
+        return -1;
+    }
+    fire_i2c_job_t *j = &sched->jobs[sched->count];
+    memset(j, 0, sizeof(*j));
+    j->name = name;
+    j->period_ms = period_ms;
+    j->convert_ms = convert_ms;
+    j->cycle_ms = first_ms;
+    j->due_ms = first_ms;
+    return sched->count++;
+}
+
+int fire_i2c_sched_next(const fire_i2c_sched_t *sched, uint32_t now_ms, uint32_t *wait_ms)
+{
+    int best = -1;
+    int32_t best_until = INT32_MAX;
+
+    // So sánh có dấu để đồng hồ ms quay vòng không làm sai thứ tự
+    for (uint32_t i = 0; i < sched->count; i++) {
+        int32_t until = (int32_t)(sched->jobs[i].due_ms - now_ms);
+        if (best < 0 || until < best_until) {
+            best = i;
+            best_until = until;
+        }
+    }
+    if (best < 0) {
+        *wait_ms = UINT32_MAX;
+        return -1;
+    }
+    if (best_until > 0) {
+        *wait_ms = best_until;
+        return -1;
+    }
+    *wait_ms = 0;
+    return best;
+}
+
+void fire_i2c_sched_done(fire_i2c_sched_t *sched, int job, uint32_t now_ms, bool ok)
+{
+    fire_i2c_job_t *j = &sched->jobs[job];
+    uint32_t late = now_ms - j->due_ms;
+
+    if ((int32_t)late > 0 && late > j->late_max_ms) {
+        j->late_max_ms = late;
+    }
+    if (fire_i2c_sched_step(sched, job) == FIRE_I2C_START && ok) {
+        j->converting = true;
+        j->due_ms = now_ms + j->convert_ms;
+        return;
+    }
+    if (!ok) {
+        j->errors++;
+    } else {
+        j->fetches++;
+    }
+    j->converting = false;
+
+    // Chu kỳ sau theo nhịp gốc; các chu kỳ đã lỡ được bỏ qua
+    uint32_t next = j->cycle_ms + j->period_ms;
+    if ((int32_t)(next - now_ms) <= 0) {
+        next += ((now_ms - next) / j->period_ms + 1) * j->period_ms;
+    }
+    j->cycle_ms = next;
+    j->due_ms = next;
+}
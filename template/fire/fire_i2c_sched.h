@@ -0,0 +1,79 @@
+#ifndef FIRE_I2C_SCHED_H
+#define FIRE_I2C_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lịch bus I2C dùng chung cho các cảm biến đo chậm: mỗi job là một cảm biến
+// với chu kỳ đo và thời gian chuyển đổi. Một task duy nhất chạy lịch nên các
+// giao dịch không bao giờ chồng nhau, và thời gian chuyển đổi (hàng trăm ms
+// với bộ sấy của BME680) được chờ bằng vTaskDelay thay vì giữ bus.
+
+#define FIRE_I2C_SCHED_JOBS 4
+
+// Việc phải làm khi một job đến hạn
+// Bus transaction due for a job
+typedef enum {
+    FIRE_I2C_START, // Trigger a measurement
+    FIRE_I2C_FETCH, // Read the results
+} fire_i2c_step_t;
+
+// Một cảm biến trong lịch
+// One sensor of the schedule
+typedef struct {
+    const char *name;
+    uint32_t period_ms;   // Time between measurement cycles
+    uint32_t convert_ms;  // Start to results, 0 = the sensor measures on its own (fetch only)
+    uint32_t cycle_ms;    // Due time of the current cycle, keeps the cadence
+    uint32_t due_ms;      // When the next step is due
+    bool converting;      // Started, results not fetched yet
+    uint32_t fetches;     // Successful fetches
+    uint32_t errors;      // Failed starts and fetches
+    uint32_t late_max_ms; // Largest delay of a step past its due time
+} fire_i2c_job_t;
+
+typedef struct {
+    fire_i2c_job_t jobs[FIRE_I2C_SCHED_JOBS];
+    uint32_t count;
+} fire_i2c_sched_t;
+
+void fire_i2c_sched_init(fire_i2c_sched_t *sched);
+
+/**
+ * @brief Adds a sensor whose first cycle is due at @p first_ms
+ *
+ * @return Job number, -1 if every job is taken or period_ms is 0
+ */
+int fire_i2c_sched_add(fire_i2c_sched_t *sched, const char *name, uint32_t period_ms, uint32_t convert_ms,
+                       uint32_t first_ms);
+
+/**
+ * @brief Picks the job to run now
+ *
+ * The most overdue job wins, ties go to the lower job number.
+ *
+ * @param wait_ms Set to the time until the next due step when nothing is
+ *        due (UINT32_MAX without jobs)
+ * @return Job number, -1 if nothing is due
+ */
+int fire_i2c_sched_next(const fire_i2c_sched_t *sched, uint32_t now_ms, uint32_t *wait_ms);
+
+/**
+ * @brief Transaction the job needs when it is due
+ */
+static inline fire_i2c_step_t fire_i2c_sched_step(const fire_i2c_sched_t *sched, int job)
+{
+    const fire_i2c_job_t *j = &sched->jobs[job];
+    return j->convert_ms == 0 || j->converting ? FIRE_I2C_FETCH : FIRE_I2C_START;
+}
+
+/**
+ * @brief Records the outcome of the step returned for @p job
+ *
+ * A started measurement is fetched convert_ms later; a finished or failed
+ * cycle moves to the next multiple of period_ms, skipping missed cycles
+ * instead of bursting to catch up.
+ */
+void fire_i2c_sched_done(fire_i2c_sched_t *sched, int job, uint32_t now_ms, bool ok);
+
+#endif
@@ -0,0 +1,262 @@
+#include <stddef.h>
+#include <string.h>
+#include "fire_journal.h"
+
+// Header đầu mỗi sector, ghi ngay sau khi xóa
+// Sector header
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;       // Increases by one for every sector opened
+    uint32_t reserved;
+    uint16_t unused;
+    uint16_t crc;
+} journal_header_t;
+
+// Bố cục một bản ghi trên flash
+// On-flash record layout
+typedef struct {
+    uint32_t stamp_ms;
+    uint32_t zones_lo;
+    uint32_t zones_hi;
+    uint8_t type;
+    uint8_t unused;
+    uint16_t crc;       // CRC-16/CCITT of the preceding bytes
+} journal_entry_t;
+
+_Static_assert(sizeof(journal_header_t) == FIRE_JOURNAL_HEADER_SIZE, "journal header size");
+_Static_assert(sizeof(journal_entry_t) == FIRE_JOURNAL_RECORD_SIZE, "journal record size");
+_Static_assert(FIRE_FLASH_PAGE_SIZE % FIRE_JOURNAL_RECORD_SIZE == 0, "records must tile a page");
+_Static_assert((FIRE_JOURNAL_HEADER_SIZE + FIRE_JOURNAL_RECORDS_PER_SECTOR * FIRE_JOURNAL_RECORD_SIZE) %
+               FIRE_FLASH_PAGE_SIZE == 0, "the last record must end on a page boundary");
+
+static uint16_t crc16(const void *data, uint32_t len)
+{
+    const uint8_t *p = data;
+    uint16_t crc = 0xffff;
+    while (len--) {
+        crc ^= (uint16_t)*p++ << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static inline uint32_t sector_addr(const fire_journal_t *journal, uint16_t sector)
+{
+    return journal->base + (uint32_t)sector * FIRE_FLASH_SECTOR_SIZE;
+}
+
+static inline uint32_t slot_addr(const fire_journal_t *journal, uint16_t sector, uint16_t slot)
+{
+    return sector_addr(journal, sector) + FIRE_JOURNAL_HEADER_SIZE + (uint32_t)slot * FIRE_JOURNAL_RECORD_SIZE;
+}
+
+static bool read_header(const fire_journal_t *journal, uint16_t sector, uint32_t *seq)
+{
+    journal_header_t header;
+
+    if (!journal->flash->read(sector_addr(journal, sector), &header, sizeof(header))) {
+        return false;
+    }
+    *seq = header.seq;
+    return header.magic == FIRE_JOURNAL_MAGIC &&
+           header.crc == crc16(&header, offsetof(journal_header_t, crc));
+}
+
+static bool entry_erased(const journal_entry_t *entry)
+{
+    const uint32_t *words = (const uint32_t *)entry;
+    for (uint32_t i = 0; i < sizeof(*entry) / 4; i++) {
+        if (words[i] != 0xffffffff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool entry_valid(const journal_entry_t *entry)
+{
+    return !entry_erased(entry) && entry->crc == crc16(entry, offsetof(journal_entry_t, crc));
+}
+
+// Tìm nhị phân slot trống đầu tiên: các bản ghi được ghi liên tiếp từ đầu sector
+static uint16_t find_free_slot(const fire_journal_t *journal, uint16_t sector)
+{
+    journal_entry_t entry;
+    uint16_t lo = 0, hi = FIRE_JOURNAL_RECORDS_PER_SECTOR;
+
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        // Không đọc được thì coi như đã ghi để không ghi đè lên nó
+        if (journal->flash->read(slot_addr(journal, sector, mid), &entry, sizeof(entry)) && entry_erased(&entry)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+bool fire_journal_mount(fire_journal_t *journal, const fire_flash_ops_t *flash, uint32_t base, uint16_t sectors)
+{
+    bool found = false;
+    uint32_t newest_seq = 0;
+    uint16_t newest = 0;
+
+    if (sectors < 2 || base % FIRE_FLASH_SECTOR_SIZE != 0) {
+        return false;
+    }
+    memset(journal, 0, sizeof(*journal));
+    journal->flash = flash;
+    journal->base = base;
+    journal->sectors = sectors;
+
+    // Chỉ đọc header của mỗi sector
+    for (uint16_t sector = 0; sector < sectors; sector++) {
+        uint32_t seq;
+        if (read_header(journal, sector, &seq) && (!found || (int32_t)(seq - newest_seq) > 0)) {
+            newest_seq = seq;
+            newest = sector;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // Vùng trống: lần ghi đầu tiên mở sector 0
+        journal->sector = sectors - 1;
+        journal->sector_seq = 0;
+        journal->slot = FIRE_JOURNAL_RECORDS_PER_SECTOR;
+        return true;
+    }
+    journal->sector = newest;
+    journal->sector_seq = newest_seq;
+    journal->slot = find_free_slot(journal, newest);
+    return true;
+}
+
+// Xóa sector kế tiếp (sector cũ nhất khi đã ghi vòng) và ghi header
+static bool open_next_sector(fire_journal_t *journal)
+{
+    uint16_t next = journal->sector + 1 == journal->sectors ? 0 : journal->sector + 1;
+    journal_header_t header = {
+        .magic = FIRE_JOURNAL_MAGIC,
+        .seq = journal->sector_seq + 1,
+        .reserved = 0xffffffff,
+        .unused = 0xffff,
+    };
+
+    if (!journal->flash->erase_sector(sector_addr(journal, next))) {
+        journal->write_errors++;
+        return false;
+    }
+    journal->erases++;
+    header.crc = crc16(&header, offsetof(journal_header_t, crc));
+    if (!journal->flash->write(sector_addr(journal, next), &header, sizeof(header))) {
+        journal->write_errors++;
+        return false;
+    }
+    journal->bytes_written += sizeof(header);
+    journal->sector = next;
+    journal->sector_seq = header.seq;
+    journal->slot = 0;
+    return true;
+}
+
+bool fire_journal_flush(fire_journal_t *journal)
+{
+    uint32_t len = (uint32_t)journal->buffered * FIRE_JOURNAL_RECORD_SIZE;
+
+    if (journal->buffered == 0) {
+        return true;
+    }
+    // Bộ đệm luôn nằm trong một trang: một lần ghi, thời gian khóa cache ngắn
+    bool ok = journal->flash->write(slot_addr(journal, journal->sector, journal->slot), journal->buf, len);
+    journal->flushes++;
+    journal->bytes_written += len;
+    // Ghi lỗi: bỏ qua các slot có thể đã ghi dở, CRC sẽ loại chúng khi đọc
+    journal->slot += journal->buffered;
+    journal->buffered = 0;
+    if (!ok) {
+        journal->write_errors++;
+    }
+    return ok;
+}
+
+bool fire_journal_append(fire_journal_t *journal, uint8_t type, uint64_t zones, uint32_t stamp_ms)
+{
+    journal_entry_t entry = {
+        .stamp_ms = stamp_ms,
+        .zones_lo = (uint32_t)zones,
+        .zones_hi = (uint32_t)(zones >> 32),
+        .type = type,
+        .unused = 0xff,
+    };
+
+    // Sector hiện tại đã đầy (bộ đệm khi đó luôn rỗng)
+    if (journal->slot >= FIRE_JOURNAL_RECORDS_PER_SECTOR && !open_next_sector(journal)) {
+        return false;
+    }
+    entry.crc = crc16(&entry, offsetof(journal_entry_t, crc));
+    memcpy(journal->buf + journal->buffered * FIRE_JOURNAL_RECORD_SIZE, &entry, sizeof(entry));
+    journal->buffered++;
+    journal->appended++;
+
+    // Ghi ra khi bộ đệm chạm cuối trang flash
+    uint32_t end = FIRE_JOURNAL_HEADER_SIZE + (uint32_t)(journal->slot + journal->buffered) * FIRE_JOURNAL_RECORD_SIZE;
+    if (end % FIRE_FLASH_PAGE_SIZE == 0) {
+        return fire_journal_flush(journal);
+    }
+    return true;
+}
+
+void fire_journal_iter_init(const fire_journal_t *journal, fire_journal_iter_t *iter)
+{
+    iter->sector = journal->sector;
+    iter->sector_seq = journal->sector_seq;
+    iter->slot = journal->sector_seq != 0 ? journal->slot : 0;
+    iter->buffered = journal->buffered;
+}
+
+static void decode(const journal_entry_t *entry, uint32_t sector_seq, uint16_t slot, fire_journal_record_t *record)
+{
+    record->index = (sector_seq - 1) * FIRE_JOURNAL_RECORDS_PER_SECTOR + slot;
+    record->stamp_ms = entry->stamp_ms;
+    record->zones = ((uint64_t)entry->zones_hi << 32) | entry->zones_lo;
+    record->type = entry->type;
+}
+
+bool fire_journal_prev(const fire_journal_t *journal, fire_journal_iter_t *iter, fire_journal_record_t *record)
+{
+    journal_entry_t entry;
+
+    // Bản ghi còn trong RAM là mới nhất
+    if (iter->buffered > 0) {
+        iter->buffered--;
+        memcpy(&entry, journal->buf + iter->buffered * FIRE_JOURNAL_RECORD_SIZE, sizeof(entry));
+        decode(&entry, journal->sector_seq, journal->slot + iter->buffered, record);
+        return true;
+    }
+
+    while (iter->sector_seq != 0) {
+        while (iter->slot > 0) {
+            iter->slot--;
+            if (journal->flash->read(slot_addr(journal, iter->sector, iter->slot), &entry, sizeof(entry)) &&
+                entry_valid(&entry)) {
+                decode(&entry, iter->sector_seq, iter->slot, record);
+                return true;
+            }
+        }
+        // Sang sector trước; dừng khi nó không phải sector liền trước (đã bị xóa để ghi vòng)
+        uint16_t prev = iter->sector == 0 ? journal->sectors - 1 : iter->sector - 1;
+        uint32_t seq;
+        if (iter->sector_seq == 1 || !read_header(journal, prev, &seq) || seq != iter->sector_seq - 1) {
+            iter->sector_seq = 0;
+            break;
+        }
+        iter->sector = prev;
+        iter->sector_seq = seq;
+        iter->slot = FIRE_JOURNAL_RECORDS_PER_SECTOR;
+    }
+    return false;
+}
@@ -0,0 +1,106 @@
+#ifndef FIRE_JOURNAL_H
+#define FIRE_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fire_flash.h"
+
+// Mỗi sector: 16 byte header rồi các bản ghi 16 byte liên tiếp
+#define FIRE_JOURNAL_HEADER_SIZE 16
+#define FIRE_JOURNAL_RECORD_SIZE 16
+#define FIRE_JOURNAL_RECORDS_PER_SECTOR \
+    ((FIRE_FLASH_SECTOR_SIZE - FIRE_JOURNAL_HEADER_SIZE) / FIRE_JOURNAL_RECORD_SIZE)
+// Bộ đệm RAM đúng bằng một trang flash
+#define FIRE_JOURNAL_BUFFER_RECORDS (FIRE_FLASH_PAGE_SIZE / FIRE_JOURNAL_RECORD_SIZE)
+
+#define FIRE_JOURNAL_MAGIC 0x4c4e4a46 // "FJNL"
+
+// Một mục trong lịch sử báo cháy
+// One alarm history entry
+typedef struct {
+    uint32_t index;     // Position in the journal since it was created (set when reading)
+    uint32_t stamp_ms;  // Event time in milliseconds since boot
+    uint64_t zones;     // Zones raised or cleared
+    uint8_t type;       // fire_event_type_t
+} fire_journal_record_t;
+
+// Nhật ký chỉ ghi thêm trên một vòng sector flash; sector cũ nhất bị xóa khi đầy
+// Append-only ring journal in a reserved flash region
+typedef struct {
+    const fire_flash_ops_t *flash;
+    uint32_t base;          // Flash address of the first sector
+    uint16_t sectors;       // Number of sectors (at least 2)
+    uint16_t sector;        // Sector currently written
+    uint32_t sector_seq;    // Sequence number in its header (0 = none yet)
+    uint16_t slot;          // Next unwritten record slot in that sector
+    uint8_t buffered;       // Records waiting in buf
+    uint8_t buf[FIRE_FLASH_PAGE_SIZE];
+    uint32_t appended;      // Records appended since mount
+    uint32_t flushes;       // Page program batches issued
+    uint32_t erases;        // Sectors erased since mount
+    uint32_t bytes_written; // Bytes programmed since mount, headers included
+    uint32_t write_errors;
+} fire_journal_t;
+
+// Vị trí khi đọc lùi từ bản ghi mới nhất
+// Newest-first read cursor
+typedef struct {
+    uint16_t sector;
+    uint32_t sector_seq;
+    uint16_t slot;      // Records left to visit in the current sector
+    uint8_t buffered;   // Buffered records left to visit
+} fire_journal_iter_t;
+
+/**
+ * @brief Mounts the journal and finds the write position
+ *
+ * Reads only the sector headers to find the newest sector, then binary
+ * searches it for the first erased slot, so the cost does not depend on the
+ * number of records stored.
+ *
+ * @param journal Journal
+ * @param flash Flash primitives
+ * @param base Flash address of the region, sector aligned
+ * @param sectors Number of sectors in the region (at least 2)
+ * @return false if the parameters are invalid or flash cannot be read
+ */
+bool fire_journal_mount(fire_journal_t *journal, const fire_flash_ops_t *flash, uint32_t base, uint16_t sectors);
+
+/**
+ * @brief Appends a record to the RAM buffer
+ *
+ * The buffer is written out as soon as it reaches the end of a flash page,
+ * so each flash write programs at most one page.
+ *
+ * @return false if a flash write or erase failed
+ */
+bool fire_journal_append(fire_journal_t *journal, uint8_t type, uint64_t zones, uint32_t stamp_ms);
+
+/**
+ * @brief Writes buffered records to flash
+ *
+ * @return false if a flash write or erase failed
+ */
+bool fire_journal_flush(fire_journal_t *journal);
+
+/**
+ * @brief Returns true if records are waiting in RAM
+ */
+static inline bool fire_journal_pending(const fire_journal_t *journal)
+{
+    return journal->buffered != 0;
+}
+
+/**
+ * @brief Starts reading from the newest record (buffered records included)
+ */
+void fire_journal_iter_init(const fire_journal_t *journal, fire_journal_iter_t *iter);
+
+/**
+ * @brief Reads the next older record, skipping damaged ones
+ *
+ * @return false once the oldest record has been read
+ */
+bool fire_journal_prev(const fire_journal_t *journal, fire_journal_iter_t *iter, fire_journal_record_t *record);
+
+#endif
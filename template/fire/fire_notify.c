@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <string.h>
+#include "fire_notify.h"
+#include "paho_mqtt_c/MQTTClient.h"
+
+#ifdef FIRE_HOST_BUILD
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+static pthread_mutex_t notify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notify_cond = PTHREAD_COND_INITIALIZER;
+static bool notify_pending;
+static volatile bool notify_stopping;
+
+uint32_t fire_notify_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void notify_lock(void)
+{
+    pthread_mutex_lock(&notify_mutex);
+}
+
+static void notify_unlock(void)
+{
+    pthread_mutex_unlock(&notify_mutex);
+}
+
+static bool notify_lock_timeout(uint32_t timeout_ms)
+{
+    for (uint32_t waited = 0; pthread_mutex_trylock(&notify_mutex) != 0; waited++) {
+        if (waited >= timeout_ms) {
+            return false;
+        }
+        usleep(1000);
+    }
+    return true;
+}
+
+// Gọi khi đang giữ khóa
+static void notify_wake(void)
+{
+    notify_pending = true;
+    pthread_cond_signal(&notify_cond);
+}
+
+// Chờ sự kiện mới hoặc hết thời gian
+static void notify_wait(uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&notify_mutex);
+    while (!notify_pending && !notify_stopping) {
+        if (pthread_cond_timedwait(&notify_cond, &notify_mutex, &deadline) != 0) {
+            break;
+        }
+    }
+    notify_pending = false;
+    pthread_mutex_unlock(&notify_mutex);
+}
+
+void fire_notify_stop(void)
+{
+    pthread_mutex_lock(&notify_mutex);
+    notify_stopping = true;
+    pthread_cond_signal(&notify_cond);
+    pthread_mutex_unlock(&notify_mutex);
+}
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "fire_rtos.h"
+
+static SemaphoreHandle_t notify_mutex;
+FIRE_MUTEX_STORAGE(notify_mutex);
+static TaskHandle_t notify_task;
+static const bool notify_stopping = false;
+
+uint32_t fire_notify_now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static void notify_lock(void)
+{
+    xSemaphoreTake(notify_mutex, portMAX_DELAY);
+}
+
+static void notify_unlock(void)
+{
+    xSemaphoreGive(notify_mutex);
+}
+
+static bool notify_lock_timeout(uint32_t timeout_ms)
+{
+    return xSemaphoreTake(notify_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+static void notify_wake(void)
+{
+    if (notify_task != NULL) {
+        xTaskNotifyGive(notify_task);
+    }
+}
+
+static void notify_wait(uint32_t timeout_ms)
+{
+    TickType_t ticks = timeout_ms / portTICK_PERIOD_MS;
+    ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
+}
+
+void fire_notify_stop(void)
+{
+}
+#endif
+
+static const fire_notify_config_t *notify_config;
+static fire_spill_t notify_spill;
+static fire_outbox_t notify_outbox;
+static fire_notify_stats_t notify_stats;
+static uint32_t notify_next_seq;
+// Sự kiện có seq nhỏ hơn giá trị này được ghi trước lần khởi động hiện tại
+static uint32_t notify_boot_seq;
+// Mốc seq đã lưu bền: sau khi khởi động lại seq bắt đầu từ đây, nên seq đã
+// gửi từ RAM (không nằm trong vùng flash chờ gửi) không bị dùng lại
+static uint32_t notify_seq_lease;
+
+// Dời mốc khi seq tiếp theo còn cách nó dưới nửa FIRE_NOTIFY_SEQ_LEASE; ghi
+// flash ngoài khóa, không bao giờ trong fire_notify_post()
+static void seq_lease_check(void)
+{
+    if (notify_config->seq_store == NULL) {
+        return;
+    }
+    notify_lock();
+    uint32_t next = notify_next_seq;
+    notify_unlock();
+    if ((int32_t)(notify_seq_lease - next) < FIRE_NOTIFY_SEQ_LEASE / 2 &&
+        notify_config->seq_store(next + FIRE_NOTIFY_SEQ_LEASE)) {
+        notify_seq_lease = next + FIRE_NOTIFY_SEQ_LEASE;
+    }
+}
+
+bool fire_notify_init(const fire_notify_config_t *config, const fire_flash_ops_t *flash,
+                      uint32_t base, uint16_t sectors)
+{
+    bool mounted = false;
+
+#ifndef FIRE_HOST_BUILD
+    notify_mutex = FIRE_MUTEX_CREATE(notify_mutex);
+#else
+    notify_stopping = false;
+    notify_pending = false;
+#endif
+    notify_config = config;
+    memset(&notify_stats, 0, sizeof(notify_stats));
+    if (flash != NULL) {
+        mounted = fire_spill_mount(&notify_spill, flash, base, sectors);
+    }
+    fire_outbox_init(&notify_outbox, mounted ? &notify_spill : NULL);
+    notify_next_seq = mounted ? notify_spill.next_seq : 0;
+    uint32_t mark;
+    if (config->seq_load != NULL && config->seq_load(&mark) && (int32_t)(mark - notify_next_seq) > 0) {
+        notify_next_seq = mark;
+    }
+    notify_boot_seq = notify_next_seq;
+    notify_seq_lease = notify_next_seq;
+    seq_lease_check();
+    return flash == NULL || mounted;
+}
+
+bool fire_notify_post(uint8_t type, uint64_t zones, uint32_t stamp_ms)
+{
+    fire_event_t event = {
+        .stamp_ms = stamp_ms,
+        .zones = zones,
+        .type = type,
+    };
+    bool queued;
+
+    notify_lock();
+    event.seq = notify_next_seq++;
+    queued = fire_outbox_push(&notify_outbox, &event);
+    notify_stats.posted++;
+    notify_wake();
+    notify_unlock();
+    return queued;
+}
+
+bool fire_notify_persist(void)
+{
+    if (!notify_lock_timeout(FIRE_NOTIFY_PERSIST_WAIT_MS)) {
+        return false;
+    }
+    bool saved = fire_outbox_persist(&notify_outbox) == notify_outbox.ram_count;
+    notify_unlock();
+    return saved;
+}
+
+int fire_notify_format(const fire_event_t *event, int32_t age_ms, char *buf, size_t len)
+{
+    char age[12] = "null";
+
+    if (age_ms >= 0) {
+        snprintf(age, sizeof(age), "%d", (int)age_ms);
+    }
+    int n = snprintf(buf, len,
+                     "{\"seq\":%u,\"type\":\"%s\",\"zones\":\"%08x%08x\",\"stamp\":%u,\"age\":%s}",
+                     (unsigned)event->seq, event->type == FIRE_EVENT_ALARM ? "fire" : "recovery",
+                     (unsigned)(event->zones >> 32), (unsigned)event->zones,
+                     (unsigned)event->stamp_ms, age);
+    return n >= 0 && (size_t)n < len ? n : -1;
+}
+
+// Độ trễ từ lúc phát hiện; chỉ có nghĩa với sự kiện của lần khởi động này
+static int32_t event_age(const fire_event_t *event, uint32_t now_ms)
+{
+    if ((int32_t)(event->seq - notify_boot_seq) < 0) {
+        return -1;
+    }
+    return (int32_t)(now_ms - event->stamp_ms);
+}
+
+static void heartbeat(void)
+{
+    if (notify_config->heartbeat != NULL) {
+        notify_config->heartbeat();
+    }
+}
+
+// Gửi mọi sự kiện đang chờ theo thứ tự; false nếu phiên MQTT bị hỏng
+static bool drain(mqtt_client_t *client)
+{
+    fire_event_t batch[FIRE_NOTIFY_BATCH];
+    char payload[FIRE_NOTIFY_PAYLOAD_MAX];
+
+    while (!notify_stopping) {
+        heartbeat();
+        seq_lease_check();
+        notify_lock();
+        uint32_t n = fire_outbox_peek(&notify_outbox, batch, FIRE_NOTIFY_BATCH);
+        notify_unlock();
+        if (n == 0) {
+            return true;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            int len = fire_notify_format(&batch[i], event_age(&batch[i], fire_notify_now_ms()),
+                                         payload, sizeof(payload));
+            mqtt_message_t message = {
+                .qos = MQTT_QOS1,
+                .payload = payload,
+                .payloadlen = len,
+            };
+            if (mqtt_publish(client, notify_config->topic, &message) != MQTT_SUCCESS) {
+                return false;
+            }
+
+            // Chỉ xóa khỏi hàng đợi sau khi broker đã xác nhận (PUBACK)
+            int32_t age = event_age(&batch[i], fire_notify_now_ms());
+            notify_lock();
+            fire_outbox_commit(&notify_outbox, 1);
+            notify_stats.published++;
+            if (age >= 0) {
+                notify_stats.latency_count++;
+                notify_stats.latency_sum_ms += age;
+                if ((uint32_t)age > notify_stats.latency_max_ms) {
+                    notify_stats.latency_max_ms = age;
+                }
+            }
+            notify_unlock();
+        }
+    }
+    return true;
+}
+
+// Một phiên MQTT: xả hàng đợi, rồi chờ sự kiện mới và giữ kết nối
+static void session(mqtt_client_t *client)
+{
+    uint32_t idle_ms = notify_config->keepalive_s * 1000 / 4;
+
+    while (!notify_stopping) {
+        heartbeat();
+        if (!drain(client)) {
+            return;
+        }
+        notify_wait(idle_ms ? idle_ms : 1000);
+        // Xử lý PINGRESP và gửi PINGREQ khi tới hạn keep-alive
+        if (mqtt_yield(client, 1) == MQTT_DISCONNECTED) {
+            return;
+        }
+    }
+}
+
+void fire_notify_run(void)
+{
+    mqtt_network_t network;
+    mqtt_client_t client = mqtt_client_default;
+    static uint8_t mqtt_buf[FIRE_NOTIFY_PAYLOAD_MAX + 64];
+    static uint8_t mqtt_readbuf[32];
+    uint32_t backoff_ms = FIRE_NOTIFY_BACKOFF_MIN_MS;
+
+#ifndef FIRE_HOST_BUILD
+    notify_task = xTaskGetCurrentTaskHandle();
+#endif
+    mqtt_network_new(&network);
+
+    while (!notify_stopping) {
+        heartbeat();
+        seq_lease_check();
+        if (mqtt_network_connect(&network, notify_config->host, notify_config->port) == 0) {
+            mqtt_packet_connect_data_t data = mqtt_packet_connect_data_initializer;
+            mqtt_client_new(&client, &network, notify_config->command_timeout_ms,
+                            mqtt_buf, sizeof(mqtt_buf), mqtt_readbuf, sizeof(mqtt_readbuf));
+            data.MQTTVersion = 3;
+            data.clientID.cstring = (char *)notify_config->client_id;
+            data.keepAliveInterval = notify_config->keepalive_s;
+            // Phiên bền vững: broker giữ trạng thái QoS 1 qua các lần kết nối lại
+            data.cleansession = 0;
+
+            if (mqtt_connect(&client, &data) == MQTT_SUCCESS) {
+                notify_lock();
+                notify_stats.sessions++;
+                notify_unlock();
+                backoff_ms = FIRE_NOTIFY_BACKOFF_MIN_MS;
+                session(&client);
+            }
+            mqtt_network_disconnect(&network);
+        }
+        if (notify_stopping) {
+            break;
+        }
+
+        notify_lock();
+        notify_stats.failures++;
+        notify_unlock();
+        notify_wait(backoff_ms);
+        backoff_ms = backoff_ms * 2 < FIRE_NOTIFY_BACKOFF_MAX_MS ? backoff_ms * 2 : FIRE_NOTIFY_BACKOFF_MAX_MS;
+    }
+}
+
+void fire_notify_get_stats(fire_notify_stats_t *stats)
+{
+    notify_lock();
+    *stats = notify_stats;
+    stats->spilled = notify_outbox.spilled;
+    stats->dropped = notify_outbox.dropped;
+    stats->pending = fire_outbox_count(&notify_outbox);
+    notify_unlock();
+}
@@ -0,0 +1,139 @@
+#ifndef FIRE_NOTIFY_H
+#define FIRE_NOTIFY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "fire_event.h"
+#include "fire_outbox.h"
+#include "fire_spill.h"
+
+// Thời gian chờ kết nối lại: tăng gấp đôi sau mỗi lần lỗi
+#ifndef FIRE_NOTIFY_BACKOFF_MIN_MS
+#define FIRE_NOTIFY_BACKOFF_MIN_MS 500
+#endif
+#ifndef FIRE_NOTIFY_BACKOFF_MAX_MS
+#define FIRE_NOTIFY_BACKOFF_MAX_MS 30000
+#endif
+// Số sự kiện đọc ra một lần khi xả hàng đợi
+#define FIRE_NOTIFY_BATCH 8
+// Độ dài tối đa của payload JSON
+#define FIRE_NOTIFY_PAYLOAD_MAX 112
+// Số seq được giữ trước trong mốc lưu bền (seq_store); mốc được dời khi còn
+// dưới một nửa, nên mỗi lần khởi động ghi một lần và sau đó hiếm khi ghi thêm
+#define FIRE_NOTIFY_SEQ_LEASE 1024
+// Thời gian tối đa chờ khóa hàng đợi khi ghi sự kiện RAM xuống flash trước khi khởi động lại
+#define FIRE_NOTIFY_PERSIST_WAIT_MS 100
+
+// Cấu hình kết nối MQTT
+typedef struct {
+    const char *host;
+    int port;
+    const char *topic;
+    const char *client_id;
+    uint16_t keepalive_s;         // MQTT keep-alive interval
+    uint32_t command_timeout_ms;  // Time allowed for CONNACK / PUBACK
+    void (*heartbeat)(void);      // Called on every pass of the session loop, may be NULL
+    bool (*seq_load)(uint32_t *mark); // Reads the persisted seq high-water mark, may be NULL
+    bool (*seq_store)(uint32_t mark); // Persists it (init and the MQTT task), may be NULL
+} fire_notify_config_t;
+
+// Thống kê phục vụ theo dõi và benchmark
+typedef struct {
+    uint32_t posted;       // Events accepted by fire_notify_post()
+    uint32_t published;    // Events acknowledged by the broker (PUBACK)
+    uint32_t spilled;      // Events that overflowed to flash
+    uint32_t dropped;      // Events lost because RAM and flash were full
+    uint32_t sessions;     // Successful MQTT connects
+    uint32_t failures;     // Failed connects and dropped sessions
+    uint32_t pending;      // Events still queued
+    uint32_t latency_count; // Events of this boot included in the latency figures
+    uint64_t latency_sum_ms; // Sum of detection-to-PUBACK latencies
+    uint32_t latency_max_ms;
+} fire_notify_stats_t;
+
+/**
+ * @brief Initializes the notification pipeline
+ *
+ * Mounts the flash spill region and queues any events left undelivered
+ * before the last reboot. Sequence numbers continue after the newest
+ * record found in flash or the persisted high-water mark, whichever is
+ * higher. The mark is moved FIRE_NOTIFY_SEQ_LEASE ahead of the next seq,
+ * so seqs already delivered from RAM are not handed out again after a
+ * reboot. Without seq_load/seq_store only the spilled records count.
+ *
+ * @param config Broker settings, must stay valid while the pipeline runs
+ * @param flash Flash primitives, or NULL to run without a spill region
+ * @param base Flash address of the spill region, sector aligned
+ * @param sectors Number of sectors in the spill region
+ * @return false if the spill region could not be mounted
+ */
+bool fire_notify_init(const fire_notify_config_t *config, const fire_flash_ops_t *flash,
+                      uint32_t base, uint16_t sectors);
+
+/**
+ * @brief Queues a fire or recovery event for delivery
+ *
+ * Never waits for the network: the event goes to the RAM outbox, or to flash
+ * when the outbox is full, and the MQTT task is woken up.
+ *
+ * @param type FIRE_EVENT_ALARM or FIRE_EVENT_RECOVERY
+ * @param zones Zones raised or cleared
+ * @param stamp_ms Detection time (fire_notify_now_ms() clock)
+ * @return false if the event had to be dropped
+ */
+bool fire_notify_post(uint8_t type, uint64_t zones, uint32_t stamp_ms);
+
+/**
+ * @brief Writes the events still held in RAM to the flash spill region
+ *
+ * Called right before a software restart. Waits at most
+ * FIRE_NOTIFY_PERSIST_WAIT_MS for the queue lock, so a task stalled while
+ * holding it cannot block the restart. Events delivered between this call
+ * and the restart are sent again afterwards with the same seq.
+ *
+ * @return false if some RAM events could not be written
+ */
+bool fire_notify_persist(void);
+
+/**
+ * @brief Runs the MQTT session loop
+ *
+ * Connects with a persistent session, publishes every queued event with
+ * QoS 1 in order and removes it only once the broker acknowledged it, then
+ * waits for new events while keeping the connection alive. Reconnects with
+ * exponential backoff. An event whose PUBACK was lost is published again
+ * with the same sequence number, so subscribers deduplicate by "seq"
+ * (unique across reboots when the high-water mark is persisted).
+ *
+ * Returns only after fire_notify_stop() (host builds).
+ */
+void fire_notify_run(void);
+
+/**
+ * @brief Makes fire_notify_run() return (used by host tests)
+ */
+void fire_notify_stop(void);
+
+/**
+ * @brief Copies the current statistics
+ */
+void fire_notify_get_stats(fire_notify_stats_t *stats);
+
+/**
+ * @brief Returns milliseconds since boot, the clock used for event stamps
+ */
+uint32_t fire_notify_now_ms(void);
+
+/**
+ * @brief Formats the JSON payload of an event
+ *
+ * @param event Event
+ * @param age_ms Time since detection, or -1 if unknown (event from a previous boot)
+ * @param buf Output buffer
+ * @param len Size of @p buf
+ * @return Payload length, or -1 if it does not fit
+ */
+int fire_notify_format(const fire_event_t *event, int32_t age_ms, char *buf, size_t len);
+
+#endif
@@ -0,0 +1,81 @@
+#include <string.h>
+#include "fire_outbox.h"
+
+#define RAM_INDEX(i) ((i) & (FIRE_OUTBOX_RAM_SLOTS - 1))
+
+static inline uint32_t spill_count(const fire_outbox_t *outbox)
+{
+    return outbox->spill != NULL ? outbox->spill->count : 0;
+}
+
+void fire_outbox_init(fire_outbox_t *outbox, fire_spill_t *spill)
+{
+    memset(outbox, 0, sizeof(*outbox));
+    outbox->spill = spill;
+}
+
+bool fire_outbox_push(fire_outbox_t *outbox, const fire_event_t *event)
+{
+    // Flash còn sự kiện cũ hơn: phải xếp sau chúng để giữ thứ tự
+    if (outbox->ram_count < FIRE_OUTBOX_RAM_SLOTS && spill_count(outbox) == 0) {
+        outbox->ram[RAM_INDEX(outbox->ram_head + outbox->ram_count)] = *event;
+        outbox->ram_count++;
+        return true;
+    }
+    if (outbox->spill != NULL && fire_spill_append(outbox->spill, event)) {
+        outbox->spilled++;
+        return true;
+    }
+    outbox->dropped++;
+    return false;
+}
+
+uint32_t fire_outbox_peek(const fire_outbox_t *outbox, fire_event_t *events, uint32_t max)
+{
+    uint32_t n = 0;
+
+    for (; n < max && n < outbox->ram_count; n++) {
+        events[n] = outbox->ram[RAM_INDEX(outbox->ram_head + n)];
+    }
+    // Sau phần RAM là phần đuôi nằm trên flash
+    for (uint32_t i = 0; n < max && i < spill_count(outbox); i++) {
+        if (!fire_spill_peek(outbox->spill, i, &events[n])) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+void fire_outbox_commit(fire_outbox_t *outbox, uint32_t n)
+{
+    uint32_t from_ram = n < outbox->ram_count ? n : outbox->ram_count;
+
+    outbox->ram_head += from_ram;
+    outbox->ram_count -= from_ram;
+    if (n > from_ram && outbox->spill != NULL) {
+        fire_spill_consume(outbox->spill, n - from_ram);
+    }
+}
+
+uint32_t fire_outbox_persist(fire_outbox_t *outbox)
+{
+    uint32_t saved = 0;
+
+    if (outbox->spill == NULL) {
+        return 0;
+    }
+    // Không xóa khỏi RAM: task MQTT có thể đang gửi sự kiện đầu và sẽ commit nó
+    for (; saved < outbox->ram_count; saved++) {
+        if (!fire_spill_append(outbox->spill, &outbox->ram[RAM_INDEX(outbox->ram_head + saved)])) {
+            break;
+        }
+    }
+    outbox->spilled += saved;
+    return saved;
+}
+
+uint32_t fire_outbox_count(const fire_outbox_t *outbox)
+{
+    return outbox->ram_count + spill_count(outbox);
+}
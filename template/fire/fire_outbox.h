@@ -0,0 +1,77 @@
+#ifndef FIRE_OUTBOX_H
+#define FIRE_OUTBOX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fire_event.h"
+#include "fire_spill.h"
+
+// Số sự kiện giữ trong RAM trước khi tràn sang flash
+#define FIRE_OUTBOX_RAM_SLOTS 16
+
+#if (FIRE_OUTBOX_RAM_SLOTS & (FIRE_OUTBOX_RAM_SLOTS - 1)) != 0
+#error "FIRE_OUTBOX_RAM_SLOTS must be a power of two"
+#endif
+
+// Hàng đợi gửi: phần đầu trong RAM, phần đuôi tràn sang flash khi RAM đầy
+// Outgoing event FIFO: the oldest events live in a bounded RAM ring, newer
+// ones overflow into the flash spill queue while the RAM ring is full or the
+// spill queue still holds older events, so delivery order is preserved.
+typedef struct {
+    fire_event_t ram[FIRE_OUTBOX_RAM_SLOTS];
+    uint32_t ram_head;   // Free-running index of the oldest RAM event
+    uint32_t ram_count;  // Events in the RAM ring
+    fire_spill_t *spill; // Overflow queue, or NULL to drop when RAM is full
+    uint32_t spilled;    // Events written to flash
+    uint32_t dropped;    // Events lost because both queues were full
+} fire_outbox_t;
+
+/**
+ * @brief Initializes an empty outbox
+ *
+ * Events already pending in @p spill (from before a reboot) are delivered
+ * first.
+ *
+ * @param outbox Outbox
+ * @param spill Mounted spill queue, or NULL
+ */
+void fire_outbox_init(fire_outbox_t *outbox, fire_spill_t *spill);
+
+/**
+ * @brief Queues an event at the tail
+ *
+ * @return false if the event was dropped
+ */
+bool fire_outbox_push(fire_outbox_t *outbox, const fire_event_t *event);
+
+/**
+ * @brief Copies up to @p max of the oldest events without removing them
+ *
+ * @return Number of events copied
+ */
+uint32_t fire_outbox_peek(const fire_outbox_t *outbox, fire_event_t *events, uint32_t max);
+
+/**
+ * @brief Removes the @p n oldest events once they have been delivered
+ */
+void fire_outbox_commit(fire_outbox_t *outbox, uint32_t n);
+
+/**
+ * @brief Copies every event of the RAM ring to the tail of the spill queue
+ *
+ * Used right before a restart so that no queued event is lost. The RAM
+ * copies stay queued: an event delivered afterwards is sent again from
+ * flash after the restart with the same seq. Copies land after events that
+ * were already spilled, so after the restart they may arrive out of order.
+ *
+ * @return Number of events copied (less than the RAM count if flash is
+ *         missing or full)
+ */
+uint32_t fire_outbox_persist(fire_outbox_t *outbox);
+
+/**
+ * @brief Returns the number of queued events (RAM and flash)
+ */
+uint32_t fire_outbox_count(const fire_outbox_t *outbox);
+
+#endif
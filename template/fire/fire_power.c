@@ -0,0 +1,186 @@
+#include <string.h>
+#include "fire_power.h"
+
+#ifdef FIRE_HOST_BUILD
+#define IRAM
+#else
+#include "espressif/esp_common.h"
+#include "esp/gpio.h"
+#include "esp/interrupts.h"
+#include "xtensa_ops.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+// µA·µs trong một µAh
+#define UA_US_PER_UAH 3600000000ull
+
+static const uint32_t state_current_ua[FIRE_POWER_STATES] = {
+    [FIRE_POWER_ACTIVE] = FIRE_POWER_ACTIVE_UA,
+    [FIRE_POWER_IDLE] = FIRE_POWER_IDLE_UA,
+    [FIRE_POWER_MODEM_SLEEP] = FIRE_POWER_MODEM_UA,
+    [FIRE_POWER_AUTO_LIGHT] = FIRE_POWER_AUTO_LIGHT_UA,
+};
+
+void fire_power_init(fire_power_t *pm, uint32_t now_us)
+{
+    memset(pm, 0, sizeof(*pm));
+    pm->state = FIRE_POWER_ACTIVE;
+    pm->since_us = now_us;
+}
+
+fire_power_state_t fire_power_deepest(uint32_t holds)
+{
+    if (holds & FIRE_POWER_HOLD_ALARM) {
+        return FIRE_POWER_IDLE;
+    }
+    if (holds & FIRE_POWER_HOLD_LED) {
+        return FIRE_POWER_MODEM_SLEEP;
+    }
+    return FIRE_POWER_AUTO_LIGHT;
+}
+
+fire_power_state_t fire_power_select(const fire_power_t *pm, uint32_t idle_us)
+{
+    fire_power_state_t state = fire_power_deepest(pm->holds);
+    // Khoảng rảnh quá ngắn thì chi phí vào/ra mức ngủ lớn hơn phần tiết kiệm được
+    if (state == FIRE_POWER_AUTO_LIGHT && idle_us < FIRE_POWER_AUTO_LIGHT_MIN_US) {
+        state = FIRE_POWER_MODEM_SLEEP;
+    }
+    if (state == FIRE_POWER_MODEM_SLEEP && idle_us < FIRE_POWER_MODEM_MIN_US) {
+        state = FIRE_POWER_IDLE;
+    }
+    return state;
+}
+
+uint32_t fire_power_exit_us(fire_power_state_t state)
+{
+    return state == FIRE_POWER_AUTO_LIGHT ? FIRE_POWER_AUTO_LIGHT_EXIT_US : 0;
+}
+
+// Cộng khoảng thời gian của trạng thái hiện tại rồi chuyển sang @state
+static void power_switch(fire_power_t *pm, fire_power_state_t state, uint32_t now_us)
+{
+    pm->stats.time_us[pm->state] += now_us - pm->since_us;
+    pm->stats.entries[state]++;
+    pm->state = state;
+    pm->since_us = now_us;
+}
+
+void fire_power_enter(fire_power_t *pm, fire_power_state_t state, uint32_t now_us)
+{
+    power_switch(pm, state, now_us);
+}
+
+void fire_power_wake(fire_power_t *pm, fire_power_wake_t source, uint32_t now_us)
+{
+    pm->stats.wakes[source]++;
+    power_switch(pm, FIRE_POWER_ACTIVE, now_us);
+}
+
+void fire_power_snapshot(const fire_power_t *pm, uint32_t now_us, fire_power_stats_t *stats)
+{
+    *stats = pm->stats;
+    stats->time_us[pm->state] += now_us - pm->since_us;
+}
+
+uint32_t fire_power_charge_uah(const fire_power_stats_t *stats)
+{
+    uint64_t charge = 0;
+    for (int i = 0; i < FIRE_POWER_STATES; i++) {
+        charge += stats->time_us[i] * state_current_ua[i];
+    }
+    return charge / UA_US_PER_UAH;
+}
+
+#ifndef FIRE_HOST_BUILD
+// Tính từ lúc khởi động: biến tĩnh bằng 0 là trạng thái ACTIVE tại thời điểm 0
+static fire_power_t fire_power;
+static bool fire_power_started;
+// Ngắt GPIO vùng báo cháy đã chạy trong lần WAITI hiện tại
+static volatile bool fire_power_gpio_woke;
+#if FIRE_POWER_SAVE
+// Mức ngủ đã báo cho SDK
+static fire_power_state_t fire_power_applied = FIRE_POWER_STATES;
+#endif
+
+// Báo mức ngủ sâu nhất được phép cho SDK (chỉ khi đổi, gọi từ task)
+static void fire_power_apply(void)
+{
+#if FIRE_POWER_SAVE
+    static const uint8_t sleep_types[FIRE_POWER_STATES] = {
+        [FIRE_POWER_ACTIVE] = WIFI_SLEEP_NONE,
+        [FIRE_POWER_IDLE] = WIFI_SLEEP_NONE,
+        [FIRE_POWER_MODEM_SLEEP] = WIFI_SLEEP_MODEM,
+        [FIRE_POWER_AUTO_LIGHT] = WIFI_SLEEP_LIGHT,
+    };
+    fire_power_state_t deepest = fire_power_deepest(fire_power.holds);
+    if (deepest != fire_power_applied) {
+        sdk_wifi_set_sleep_type(sleep_types[deepest]);
+        fire_power_applied = deepest;
+    }
+#endif
+}
+
+void fire_power_start(uint16_t wake_pins)
+{
+    // Ngắt cạnh vẫn được chốt trong GPIO.STATUS khi clock CPU bị tắt; bit này
+    // cho phép chúng kết thúc light sleep do SDK tự vào
+    for (int pin = 0; pin < 16; pin++) {
+        if (wake_pins & BIT(pin)) {
+            GPIO.CONF[pin] |= GPIO_CONF_WAKEUP_ENABLE;
+        }
+    }
+    fire_power_apply();
+    fire_power_started = true;
+}
+
+void fire_power_hold(uint32_t reason, bool held)
+{
+    taskENTER_CRITICAL();
+    if (held) {
+        fire_power.holds |= reason;
+    } else {
+        fire_power.holds &= ~reason;
+    }
+    taskEXIT_CRITICAL();
+    if (fire_power_started) {
+        fire_power_apply();
+    }
+}
+
+void IRAM fire_power_gpio_wake(void)
+{
+    fire_power_gpio_woke = true;
+}
+
+void fire_power_get_stats(fire_power_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    fire_power_snapshot(&fire_power, sdk_system_get_time(), stats);
+    taskEXIT_CRITICAL();
+}
+
+#if FIRE_POWER_SAVE
+void IRAM fire_power_idle(uint32_t expected_idle_ticks)
+{
+    uint32_t idle_us = expected_idle_ticks >= UINT32_MAX / (portTICK_PERIOD_MS * 1000)
+                           ? UINT32_MAX : expected_idle_ticks * portTICK_PERIOD_MS * 1000;
+    fire_power_state_t state = fire_power_started ? fire_power_select(&fire_power, idle_us) : FIRE_POWER_IDLE;
+
+    // Ngắt bị chặn từ lúc kiểm tra tới WAITI: một task được đánh thức ngay
+    // trước đó không bị bỏ lỡ. WAITI 0 mở lại ngắt khi đã dừng CPU
+    uint32_t ps = _xt_disable_interrupts();
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        _xt_restore_interrupts(ps);
+        return;
+    }
+    fire_power_gpio_woke = false;
+    fire_power_enter(&fire_power, state, sdk_system_get_time());
+    WAITI(0);
+    fire_power_wake(&fire_power, fire_power_gpio_woke ? FIRE_POWER_WAKE_GPIO : FIRE_POWER_WAKE_TIMER,
+                    sdk_system_get_time());
+    _xt_restore_interrupts(ps);
+}
+#endif
+#endif
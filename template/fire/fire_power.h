@@ -0,0 +1,159 @@
+#ifndef FIRE_POWER_H
+#define FIRE_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Chế độ chờ tiết kiệm điện: khi mọi task đang chờ, task idle của FreeRTOS
+// gọi fire_power_idle() (portSUPPRESS_TICKS_AND_SLEEP, xem FreeRTOSConfig.h),
+// hàm này chọn mức ngủ theo khoảng rảnh dự kiến rồi dừng CPU bằng WAITI tới
+// ngắt kế tiếp (tick, GPIO vùng báo cháy, FRC1). Ở mọi mức CPU chỉ nằm trong
+// WAITI; các mức khác nhau ở chế độ ngủ báo cho SDK qua
+// sdk_wifi_set_sleep_type() (radio luôn bật, modem sleep, hay cho phép SDK
+// tự vào light sleep giữa các beacon). Firmware không tự gọi forced light
+// sleep nên không biết SDK có thật sự tắt clock hay không.
+
+// Thời gian xấu nhất từ lúc có sự kiện đánh thức tới khi CPU chạy lại (micro
+// giây) khi SDK được phép tự vào light sleep (tắt clock CPU và FRC1); ở các
+// mức khác WAITI thoát ngay
+#ifndef FIRE_POWER_AUTO_LIGHT_EXIT_US
+#define FIRE_POWER_AUTO_LIGHT_EXIT_US 3000
+#endif
+// Khoảng rảnh ngắn nhất đáng vào từng mức ngủ
+#ifndef FIRE_POWER_AUTO_LIGHT_MIN_US
+#define FIRE_POWER_AUTO_LIGHT_MIN_US 50000
+#endif
+#ifndef FIRE_POWER_MODEM_MIN_US
+#define FIRE_POWER_MODEM_MIN_US 20000
+#endif
+
+// Dòng tiêu thụ điển hình theo datasheet ESP8266EX (micro ampe), dùng để ước
+// lượng điện lượng từ thời gian ở mỗi trạng thái. Mức auto light tính như
+// modem sleep: không đo được phần SDK có tắt clock, nên không tính dòng
+// light sleep (0.9 mA) cho nó
+#ifndef FIRE_POWER_ACTIVE_UA
+#define FIRE_POWER_ACTIVE_UA 70000
+#endif
+#ifndef FIRE_POWER_IDLE_UA
+#define FIRE_POWER_IDLE_UA 56000
+#endif
+#ifndef FIRE_POWER_MODEM_UA
+#define FIRE_POWER_MODEM_UA 15000
+#endif
+#ifndef FIRE_POWER_AUTO_LIGHT_UA
+#define FIRE_POWER_AUTO_LIGHT_UA FIRE_POWER_MODEM_UA
+#endif
+
+// Lý do không được ngủ sâu, giữ bởi các task qua fire_power_hold()
+// Reasons that cap the sleep depth
+#define FIRE_POWER_HOLD_LED   (1u << 0) // FRC1 is blinking an LED: an SDK light sleep would stop it
+#define FIRE_POWER_HOLD_ALARM (1u << 1) // A zone is in alarm: keep the radio up, wake at once
+
+// Trạng thái điện năng, từ tốn điện nhất tới ít nhất
+// Power states, deepest last
+typedef enum {
+    FIRE_POWER_ACTIVE,      // A task or interrupt is running
+    FIRE_POWER_IDLE,        // WAITI, radio always on
+    FIRE_POWER_MODEM_SLEEP, // WAITI, radio off between DTIM beacons
+    FIRE_POWER_AUTO_LIGHT,  // WAITI, SDK allowed to light sleep between DTIM beacons
+    FIRE_POWER_STATES
+} fire_power_state_t;
+
+// Nguồn đánh thức
+// What ended a sleep
+typedef enum {
+    FIRE_POWER_WAKE_GPIO,  // Fire zone or expander interrupt
+    FIRE_POWER_WAKE_TIMER, // Tick, FRC1 or any other interrupt
+    FIRE_POWER_WAKE_SOURCES
+} fire_power_wake_t;
+
+// Thời gian ở mỗi trạng thái và số lần vào/đánh thức
+// Energy accounting
+typedef struct {
+    uint64_t time_us[FIRE_POWER_STATES];
+    uint32_t entries[FIRE_POWER_STATES];
+    uint32_t wakes[FIRE_POWER_WAKE_SOURCES];
+} fire_power_stats_t;
+
+typedef struct {
+    uint32_t holds;           // FIRE_POWER_HOLD_* bits
+    fire_power_state_t state; // Current state
+    uint32_t since_us;        // When the current state was entered
+    fire_power_stats_t stats; // Closed spans only
+} fire_power_t;
+
+/**
+ * @brief Starts accounting in the active state with no holds
+ */
+void fire_power_init(fire_power_t *pm, uint32_t now_us);
+
+/**
+ * @brief Deepest state the holds allow, whatever the idle window
+ */
+fire_power_state_t fire_power_deepest(uint32_t holds);
+
+/**
+ * @brief Picks the state for an idle window
+ *
+ * @param idle_us Time until the next task deadline, UINT32_MAX if none
+ */
+fire_power_state_t fire_power_select(const fire_power_t *pm, uint32_t idle_us);
+
+/**
+ * @brief Worst-case time from a wake event until code runs again
+ */
+uint32_t fire_power_exit_us(fire_power_state_t state);
+
+/**
+ * @brief Closes the active span and enters a sleep state
+ */
+void fire_power_enter(fire_power_t *pm, fire_power_state_t state, uint32_t now_us);
+
+/**
+ * @brief Closes the sleep span and returns to the active state
+ */
+void fire_power_wake(fire_power_t *pm, fire_power_wake_t source, uint32_t now_us);
+
+/**
+ * @brief Copies the statistics with the open span counted up to @p now_us
+ */
+void fire_power_snapshot(const fire_power_t *pm, uint32_t now_us, fire_power_stats_t *stats);
+
+/**
+ * @brief Estimated charge drawn over the accounted time (micro amp hours)
+ */
+uint32_t fire_power_charge_uah(const fire_power_stats_t *stats);
+
+#ifndef FIRE_HOST_BUILD
+/**
+ * @brief Lets the sensor inputs wake the chip and applies the sleep policy
+ *
+ * @param wake_pins GPIO 0-15 whose interrupts end an SDK light sleep
+ */
+void fire_power_start(uint16_t wake_pins);
+
+/**
+ * @brief Sets or releases a FIRE_POWER_HOLD_* reason (task context)
+ */
+void fire_power_hold(uint32_t reason, bool held);
+
+/**
+ * @brief Marks the current sleep as ended by a fire input (GPIO interrupt)
+ */
+void fire_power_gpio_wake(void);
+
+/**
+ * @brief Reads the accounting of the device
+ */
+void fire_power_get_stats(fire_power_stats_t *stats);
+
+/**
+ * @brief Sleeps until the next interrupt (portSUPPRESS_TICKS_AND_SLEEP)
+ *
+ * Called by the idle task with the scheduler suspended. The tick keeps
+ * running, so at most one tick is slept per call and no tick is lost.
+ */
+void fire_power_idle(uint32_t expected_idle_ticks);
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef FIRE_RTOS_H
+#define FIRE_RTOS_H
+
+// Tạo task, timer và mutex của ứng dụng. Khi configSUPPORT_STATIC_ALLOCATION
+// bật (mặc định, xem FreeRTOSConfig.h), TCB, stack và buffer là biến tĩnh nên
+// heap không bị chia nhỏ và lượng heap dùng ở trạng thái ổn định cố định;
+// nếu không thì cấp phát từ heap như trước.
+//
+// Bộ nhớ tĩnh nằm trong các section .bss.fire_rtos.<tên>, nên link map
+// (build/fire.map) liệt kê từng đối tượng với kích thước của nó; `make budget`
+// in bảng tổng hợp.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "semphr.h"
+
+#define FIRE_RTOS_SECTION(name) __attribute__((section(".bss.fire_rtos." #name)))
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+static inline BaseType_t fire_rtos_task_created(TaskHandle_t task, TaskHandle_t *created)
+{
+    if (created != NULL) {
+        *created = task;
+    }
+    return task != NULL ? pdPASS : pdFAIL;
+}
+
+// Bộ nhớ của task @name với stack @depth word; tên task trong FreeRTOS là #name
+#define FIRE_TASK_STORAGE(name, depth) \
+    enum { name##_depth = (depth) }; \
+    static StackType_t name##_stack[depth] FIRE_RTOS_SECTION(name##_stack); \
+    static StaticTask_t name##_tcb FIRE_RTOS_SECTION(name##_tcb)
+
+// Như xTaskCreate(): trả về pdPASS hoặc pdFAIL
+#define FIRE_TASK_CREATE(name, code, param, priority, created) \
+    fire_rtos_task_created(xTaskCreateStatic((code), #name, name##_depth, (param), (priority), \
+                                             name##_stack, &name##_tcb), (created))
+
+#define FIRE_TIMER_STORAGE(name) \
+    static StaticTimer_t name##_buffer FIRE_RTOS_SECTION(name)
+
+// Như xTimerCreate() với ID NULL; tên timer là #name
+#define FIRE_TIMER_CREATE(name, period, auto_reload, callback) \
+    xTimerCreateStatic(#name, (period), (auto_reload), NULL, (callback), &name##_buffer)
+
+#define FIRE_MUTEX_STORAGE(name) \
+    static StaticSemaphore_t name##_buffer FIRE_RTOS_SECTION(name)
+
+#define FIRE_MUTEX_CREATE(name) xSemaphoreCreateMutexStatic(&name##_buffer)
+
+#else
+
+#define FIRE_TASK_STORAGE(name, depth) \
+    enum { name##_depth = (depth) }
+
+#define FIRE_TASK_CREATE(name, code, param, priority, created) \
+    xTaskCreate((code), #name, name##_depth, (param), (priority), (created))
+
+#define FIRE_TIMER_STORAGE(name) \
+    extern int name##_unused
+
+#define FIRE_TIMER_CREATE(name, period, auto_reload, callback) \
+    xTimerCreate(#name, (period), (auto_reload), NULL, (callback))
+
+#define FIRE_MUTEX_STORAGE(name) \
+    extern int name##_unused
+
+#define FIRE_MUTEX_CREATE(name) xSemaphoreCreateMutex()
+
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+#include <string.h>
+#include "fire_smoke.h"
+
+// Số nhân từ đơn vị ADC sang Q4 và từ Q4 sang Q12 (nhân thay cho dịch trái
+// vì giá trị có thể âm)
+#define FRAC_ONE       (1 << FIRE_SMOKE_FRAC_BITS)
+#define BASELINE_SCALE (1 << (FIRE_SMOKE_BASELINE_FRAC_BITS - FIRE_SMOKE_FRAC_BITS))
+
+bool fire_smoke_init(fire_smoke_channel_t *ch, const fire_smoke_config_t *config)
+{
+    memset(ch, 0, sizeof(*ch));
+    ch->config = config;
+    if (config->average_shift > FIRE_SMOKE_AVERAGE_MAX_SHIFT || config->rise_samples > FIRE_SMOKE_RISE_MAX ||
+        config->iir_shift > 15 || config->baseline_shift > 15 ||
+        config->level_off > config->level_on || config->rise_off > config->rise_on) {
+        return false;
+    }
+    ch->baseline = (int32_t)config->clean_air * FRAC_ONE * BASELINE_SCALE;
+    return true;
+}
+
+// Mẫu đầu tiên lấp đầy cửa sổ trung bình, IIR và lịch sử tốc độ tăng: bộ lọc
+// không có quá độ lúc khởi động. Khi nền được theo dõi, mẫu đó cũng thay cho
+// clean_air nếu chưa giống khói
+static void smoke_prime(fire_smoke_channel_t *ch, int16_t sample)
+{
+    const fire_smoke_config_t *cfg = ch->config;
+    uint32_t window = 1u << cfg->average_shift;
+
+    for (uint32_t i = 0; i < window; i++) {
+        ch->window[i] = sample;
+    }
+    ch->sum = (int32_t)sample * (1 << cfg->average_shift);
+    ch->filtered = (int32_t)sample * FRAC_ONE;
+    for (uint32_t i = 0; i < cfg->rise_samples; i++) {
+        ch->history[i] = ch->filtered;
+    }
+    if (cfg->baseline_shift > 0 && fire_smoke_level(ch) < (int32_t)cfg->level_off * FRAC_ONE / 2) {
+        ch->baseline = ch->filtered * BASELINE_SCALE;
+    }
+    ch->primed = true;
+}
+
+// Ngưỡng có trễ: bật khi đạt on, chỉ tắt khi xuống dưới off
+static bool smoke_hysteresis(bool active, int32_t value, int16_t on, int16_t off)
+{
+    if (!active) {
+        return value >= (int32_t)on * FRAC_ONE;
+    }
+    return value >= (int32_t)off * FRAC_ONE;
+}
+
+bool fire_smoke_update(fire_smoke_channel_t *ch, int16_t sample)
+{
+    const fire_smoke_config_t *cfg = ch->config;
+
+    if (!ch->primed) {
+        smoke_prime(ch, sample);
+    }
+
+    // Trung bình trượt: tổng chạy, mỗi mẫu một phép cộng và một phép trừ
+    uint32_t window_mask = (1u << cfg->average_shift) - 1;
+    ch->sum += sample - ch->window[ch->window_pos];
+    ch->window[ch->window_pos] = sample;
+    ch->window_pos = (ch->window_pos + 1) & window_mask;
+    int32_t average = ch->sum * FRAC_ONE >> cfg->average_shift;
+
+    // IIR bậc một, làm tròn về gần nhất để không lệch về một phía
+    if (cfg->iir_shift > 0) {
+        ch->filtered += (average - ch->filtered + (1 << (cfg->iir_shift - 1))) >> cfg->iir_shift;
+    } else {
+        ch->filtered = average;
+    }
+
+    if (cfg->rise_samples > 0) {
+        ch->rise = ch->filtered - ch->history[ch->history_pos];
+        ch->history[ch->history_pos] = ch->filtered;
+        ch->history_pos = ch->history_pos + 1 == cfg->rise_samples ? 0 : ch->history_pos + 1;
+        ch->rise_active = smoke_hysteresis(ch->rise_active, ch->rise, cfg->rise_on, cfg->rise_off);
+    }
+
+    int32_t level = fire_smoke_level(ch);
+    ch->level_active = smoke_hysteresis(ch->level_active, level, cfg->level_on, cfg->level_off);
+
+    // Nền chỉ theo tín hiệu khi gần không khí sạch: khói tăng chậm vượt nửa
+    // level_off sẽ giữ nền đứng yên thay vì bị coi là độ trôi
+    if (cfg->baseline_shift > 0 && !fire_smoke_active(ch) &&
+        level < (int32_t)cfg->level_off * FRAC_ONE / 2) {
+        int32_t target = ch->filtered * BASELINE_SCALE;
+        ch->baseline += (target - ch->baseline) >> cfg->baseline_shift;
+    }
+    return fire_smoke_active(ch);
+}
@@ -0,0 +1,181 @@
+#ifndef FIRE_SMOKE_H
+#define FIRE_SMOKE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "isr_ring.h"
+
+// Cảm biến khói analog: mẫu ADC được lấy với chu kỳ cố định vào một ring, task
+// báo cháy lọc từng kênh bằng số nguyên (trung bình trượt rồi IIR bậc một) và
+// so mức trên nền không khí sạch cùng tốc độ tăng với các ngưỡng có trễ. Kết
+// quả là một bit đầu vào của bộ xử lý vùng, như một đầu báo số.
+
+// Số kênh trong một khung mẫu (ADC trong chip và ADS111x)
+#ifndef FIRE_SMOKE_CHANNELS
+#define FIRE_SMOKE_CHANNELS 2
+#endif
+// Số khung của ring (phải là lũy thừa của 2)
+#define FIRE_SMOKE_RING_SIZE 16
+// Cửa sổ trung bình trượt lớn nhất: 2^FIRE_SMOKE_AVERAGE_MAX_SHIFT mẫu
+#define FIRE_SMOKE_AVERAGE_MAX_SHIFT 4
+// Số mẫu lớn nhất của cửa sổ đo tốc độ tăng
+#define FIRE_SMOKE_RISE_MAX 64
+// Giá trị lọc giữ 4 bit phân số (Q4) để IIR không bị kẹt do làm tròn; nền
+// giữ 12 bit (Q12) để theo kịp độ trôi chậm hơn 1 đơn vị ADC mỗi 2^baseline_shift mẫu
+#define FIRE_SMOKE_FRAC_BITS          4
+#define FIRE_SMOKE_BASELINE_FRAC_BITS 12
+
+#if (FIRE_SMOKE_RING_SIZE & (FIRE_SMOKE_RING_SIZE - 1)) != 0
+#error "FIRE_SMOKE_RING_SIZE must be a power of two"
+#endif
+
+// Một lần lấy mẫu tất cả các kênh
+// One acquisition of every channel
+typedef struct {
+    uint32_t ccount;                     // Cycle count when the channels were read
+    int16_t value[FIRE_SMOKE_CHANNELS];  // Raw ADC counts
+} fire_smoke_sample_t;
+
+// Ring một producer (timer lấy mẫu) / một consumer (task báo cháy), cùng cách
+// đếm head/tail như isr_ring_t
+// Single-producer / single-consumer ring of acquisitions
+typedef struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t overflows;
+    fire_smoke_sample_t slots[FIRE_SMOKE_RING_SIZE];
+} fire_smoke_ring_t;
+
+// Tham số lọc và ngưỡng của một kênh, theo đơn vị ADC thô
+// Filter and threshold settings of one channel, in raw ADC counts
+typedef struct {
+    uint8_t average_shift;  // Moving average over 2^n samples (n <= FIRE_SMOKE_AVERAGE_MAX_SHIFT)
+    uint8_t iir_shift;      // IIR y += (x - y) / 2^n after the average, 0 = off
+    uint8_t rise_samples;   // Rate of rise over this many samples (<= FIRE_SMOKE_RISE_MAX), 0 = off
+    uint8_t baseline_shift; // Clean-air baseline tracking y / 2^n per sample, 0 = fixed baseline
+    int16_t clean_air;      // Expected clean-air reading, replaced by the first sample when tracking
+    int16_t level_on;       // Level above the baseline that activates the channel
+    int16_t level_off;      // Level under which it deactivates (<= level_on)
+    int16_t rise_on;        // Rise over rise_samples that activates the channel
+    int16_t rise_off;       // Rise under which it deactivates (<= rise_on)
+} fire_smoke_config_t;
+
+// Cài đặt cho đầu báo khói quang lấy mẫu 10 Hz, chỉnh theo các bản ghi trong
+// test/traces: trung bình 0,8 s, IIR ~0,4 s, tốc độ tăng đo trên 5 s, nền theo
+// độ trôi với hằng số thời gian ~200 s. TOUT: 0-1 V, 10 bit
+#define FIRE_SMOKE_TOUT_DEFAULTS { \
+        .average_shift = 3, .iir_shift = 2, .rise_samples = 50, .baseline_shift = 11, \
+        .clean_air = 120, .level_on = 150, .level_off = 100, .rise_on = 80, .rise_off = 30 }
+// ADS111x ở ±4,096 V (125 uV mỗi đơn vị), cùng cảm biến với dải 0-3,3 V
+#define FIRE_SMOKE_ADS111X_DEFAULTS { \
+        .average_shift = 3, .iir_shift = 2, .rise_samples = 50, .baseline_shift = 11, \
+        .clean_air = 3200, .level_on = 4000, .level_off = 2700, .rise_on = 2100, .rise_off = 800 }
+
+// Trạng thái lọc của một kênh
+// Filter and detector state of one channel
+typedef struct {
+    const fire_smoke_config_t *config;
+    int32_t sum;                                       // Sum of the average window
+    int16_t window[1 << FIRE_SMOKE_AVERAGE_MAX_SHIFT]; // Last raw samples
+    int32_t filtered;                                  // IIR output, Q4
+    int32_t baseline;                                  // Clean-air baseline, Q12
+    int32_t history[FIRE_SMOKE_RISE_MAX];              // Filtered values for the rise, Q4
+    int32_t rise;                                      // Last rise over rise_samples, Q4
+    uint8_t window_pos;
+    uint8_t history_pos;
+    bool primed;                                       // Window and history hold real samples
+    bool level_active;
+    bool rise_active;
+} fire_smoke_channel_t;
+
+/**
+ * @brief Resets the ring to the empty state
+ */
+static inline void fire_smoke_ring_init(fire_smoke_ring_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflows = 0;
+}
+
+/**
+ * @brief Publishes one acquisition from the producer side
+ *
+ * @return ISR_RING_WAKE if the consumer may be waiting and needs a
+ *         notification, ISR_RING_QUEUED or ISR_RING_DROPPED otherwise
+ */
+static inline isr_ring_result_t fire_smoke_ring_push(fire_smoke_ring_t *ring, const fire_smoke_sample_t *sample)
+{
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= FIRE_SMOKE_RING_SIZE) {
+        ring->overflows++;
+        return ISR_RING_DROPPED;
+    }
+    ring->slots[head & (FIRE_SMOKE_RING_SIZE - 1)] = *sample;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) == head) {
+        return ISR_RING_WAKE;
+    }
+    return ISR_RING_QUEUED;
+}
+
+/**
+ * @brief Takes the oldest acquisition from the consumer side
+ *
+ * @return 1 if a sample was returned, 0 if the ring is empty
+ */
+static inline int fire_smoke_ring_pop(fire_smoke_ring_t *ring, fire_smoke_sample_t *sample)
+{
+    uint32_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == tail) {
+        return 0;
+    }
+    *sample = ring->slots[tail & (FIRE_SMOKE_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_SEQ_CST);
+    return 1;
+}
+
+/**
+ * @brief Returns the cumulative number of dropped acquisitions
+ */
+static inline uint32_t fire_smoke_ring_overflows(const fire_smoke_ring_t *ring)
+{
+    return __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Initializes a channel; the first sample fills the filter
+ *
+ * @param ch Channel state
+ * @param config Settings, kept by reference
+ * @return false if the settings are out of range
+ */
+bool fire_smoke_init(fire_smoke_channel_t *ch, const fire_smoke_config_t *config);
+
+/**
+ * @brief Filters one raw sample and updates both detectors
+ *
+ * The baseline only follows the signal while it stays under half of
+ * level_off, so slow smouldering smoke is not absorbed as drift.
+ *
+ * @return true while the level or the rate-of-rise detector is active
+ */
+bool fire_smoke_update(fire_smoke_channel_t *ch, int16_t sample);
+
+/**
+ * @brief Filtered level above the baseline, Q4 counts
+ */
+static inline int32_t fire_smoke_level(const fire_smoke_channel_t *ch)
+{
+    return ch->filtered - (ch->baseline >> (FIRE_SMOKE_BASELINE_FRAC_BITS - FIRE_SMOKE_FRAC_BITS));
+}
+
+/**
+ * @brief True while the channel signals smoke
+ */
+static inline bool fire_smoke_active(const fire_smoke_channel_t *ch)
+{
+    return ch->level_active || ch->rise_active;
+}
+
+#endif
@@ -0,0 +1,243 @@
+#include <stddef.h>
+#include <string.h>
+#include "fire_spill.h"
+
+// Bố cục một bản ghi 32 byte trên flash
+// On-flash record layout
+typedef struct {
+    uint32_t state;     // FIRE_SPILL_VALID / FIRE_SPILL_CONSUMED, written last
+    uint32_t seq;
+    uint32_t stamp_ms;
+    uint32_t zones_lo;
+    uint32_t zones_hi;
+    uint32_t type;
+    uint32_t check;     // Checksum of seq..type
+    uint32_t order;     // Append counter (ring position), FIRE_SPILL_ERASED on old records
+} spill_record_t;
+
+_Static_assert(sizeof(spill_record_t) == FIRE_SPILL_RECORD_SIZE, "spill record size");
+
+static uint32_t record_check(const spill_record_t *rec)
+{
+    // FNV-1a trên phần dữ liệu của bản ghi
+    const uint8_t *p = (const uint8_t *)&rec->seq;
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < offsetof(spill_record_t, check) - offsetof(spill_record_t, seq); i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline uint32_t slot_addr(const fire_spill_t *spill, uint32_t slot)
+{
+    return spill->base + slot * FIRE_SPILL_RECORD_SIZE;
+}
+
+static inline uint32_t next_slot(const fire_spill_t *spill, uint32_t slot)
+{
+    return slot + 1 == spill->slots ? 0 : slot + 1;
+}
+
+static inline uint32_t used_slots(const fire_spill_t *spill)
+{
+    return spill->tail >= spill->head ? spill->tail - spill->head
+                                      : spill->slots - spill->head + spill->tail;
+}
+
+static bool read_record(const fire_spill_t *spill, uint32_t slot, spill_record_t *rec)
+{
+    return spill->flash->read(slot_addr(spill, slot), rec, sizeof(*rec));
+}
+
+// Bản ghi hợp lệ (đang chờ hoặc đã gửi) với checksum đúng
+static bool record_intact(const spill_record_t *rec)
+{
+    return (rec->state == FIRE_SPILL_VALID || rec->state == FIRE_SPILL_CONSUMED) &&
+           rec->check == record_check(rec);
+}
+
+// Thứ tự ghi vào vòng; bản ghi cũ không có bộ đếm thì seq chính là thứ tự ghi
+static inline uint32_t record_order(const spill_record_t *rec)
+{
+    return rec->order != FIRE_SPILL_ERASED ? rec->order : rec->seq;
+}
+
+static bool record_erased(const spill_record_t *rec)
+{
+    const uint32_t *words = (const uint32_t *)rec;
+    for (uint32_t i = 0; i < sizeof(*rec) / 4; i++) {
+        if (words[i] != FIRE_SPILL_ERASED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bỏ qua các slot không còn bản ghi đang chờ ở đầu hàng đợi
+static void skip_to_pending(fire_spill_t *spill)
+{
+    spill_record_t rec;
+    while (spill->head != spill->tail) {
+        if (read_record(spill, spill->head, &rec) && rec.state == FIRE_SPILL_VALID && record_intact(&rec)) {
+            return;
+        }
+        spill->head = next_slot(spill, spill->head);
+    }
+}
+
+bool fire_spill_mount(fire_spill_t *spill, const fire_flash_ops_t *flash, uint32_t base, uint16_t sectors)
+{
+    spill_record_t rec;
+    bool have_newest = false, have_oldest = false;
+    uint32_t newest_order = 0, newest_slot = 0, newest_seq = 0;
+    uint32_t oldest_order = 0, oldest_slot = 0;
+
+    if (sectors < 2 || base % FIRE_SPILL_SECTOR_SIZE != 0) {
+        return false;
+    }
+    memset(spill, 0, sizeof(*spill));
+    spill->flash = flash;
+    spill->base = base;
+    spill->sectors = sectors;
+    spill->slots = (uint32_t)sectors * FIRE_SPILL_RECORDS_PER_SECTOR;
+
+    for (uint32_t slot = 0; slot < spill->slots; slot++) {
+        if (!read_record(spill, slot, &rec)) {
+            return false;
+        }
+        if (!record_intact(&rec)) {
+            continue;
+        }
+        // Đầu và đuôi vòng theo thứ tự ghi: bản ghi chép từ RAM trước khi khởi
+        // động lại có seq nhỏ hơn các bản ghi đứng trước nó
+        uint32_t order = record_order(&rec);
+        if (!have_newest || (int32_t)(order - newest_order) > 0) {
+            newest_order = order;
+            newest_slot = slot;
+        }
+        if (!have_newest || (int32_t)(rec.seq - newest_seq) > 0) {
+            newest_seq = rec.seq;
+        }
+        have_newest = true;
+        if (rec.state == FIRE_SPILL_VALID) {
+            spill->count++;
+            if (!have_oldest || (int32_t)(order - oldest_order) < 0) {
+                oldest_order = order;
+                oldest_slot = slot;
+                have_oldest = true;
+            }
+        }
+    }
+
+    if (have_newest) {
+        spill->tail = next_slot(spill, newest_slot);
+        spill->next_seq = newest_seq + 1;
+        spill->next_order = newest_order + 1;
+    }
+    // Ghi dở khi mất điện: bỏ qua các slot bẩn còn lại trong sector
+    while (spill->tail % FIRE_SPILL_RECORDS_PER_SECTOR != 0) {
+        if (!read_record(spill, spill->tail, &rec)) {
+            return false;
+        }
+        if (record_erased(&rec)) {
+            break;
+        }
+        spill->tail = next_slot(spill, spill->tail);
+    }
+    spill->head = have_oldest ? oldest_slot : spill->tail;
+    return true;
+}
+
+bool fire_spill_append(fire_spill_t *spill, const fire_event_t *event)
+{
+    spill_record_t rec;
+
+    if (used_slots(spill) >= fire_spill_capacity(spill)) {
+        return false;
+    }
+    // Vào sector mới: xóa trước khi ghi (sector này không chứa bản ghi đang chờ)
+    if (spill->tail % FIRE_SPILL_RECORDS_PER_SECTOR == 0 &&
+        !spill->flash->erase_sector(slot_addr(spill, spill->tail))) {
+        spill->write_errors++;
+        return false;
+    }
+
+    memset(&rec, 0xff, sizeof(rec));
+    rec.seq = event->seq;
+    rec.stamp_ms = event->stamp_ms;
+    rec.zones_lo = (uint32_t)event->zones;
+    rec.zones_hi = (uint32_t)(event->zones >> 32);
+    rec.type = event->type;
+    rec.check = record_check(&rec);
+    rec.order = spill->next_order;
+
+    // Ghi dữ liệu trước, trạng thái sau cùng để bản ghi dở dang không bao giờ hợp lệ
+    uint32_t addr = slot_addr(spill, spill->tail);
+    bool ok = spill->flash->write(addr + 4, &rec.seq, sizeof(rec) - 4);
+    rec.state = FIRE_SPILL_VALID;
+    ok = ok && spill->flash->write(addr, &rec.state, 4);
+
+    bool was_empty = spill->count == 0;
+    spill->tail = next_slot(spill, spill->tail);
+    // Giá trị FIRE_SPILL_ERASED dành cho bản ghi không có bộ đếm
+    spill->next_order = spill->next_order + 1 == FIRE_SPILL_ERASED ? 0 : spill->next_order + 1;
+    if (!ok) {
+        spill->write_errors++;
+        return false;
+    }
+    if (was_empty) {
+        spill->head = (spill->tail + spill->slots - 1) % spill->slots;
+    }
+    spill->count++;
+    if ((int32_t)(event->seq + 1 - spill->next_seq) > 0) {
+        spill->next_seq = event->seq + 1;
+    }
+    return true;
+}
+
+bool fire_spill_peek(const fire_spill_t *spill, uint32_t index, fire_event_t *event)
+{
+    spill_record_t rec;
+    uint32_t slot = spill->head;
+
+    if (index >= spill->count) {
+        return false;
+    }
+    while (slot != spill->tail) {
+        if (!read_record(spill, slot, &rec)) {
+            return false;
+        }
+        if (rec.state == FIRE_SPILL_VALID && record_intact(&rec)) {
+            if (index == 0) {
+                event->seq = rec.seq;
+                event->stamp_ms = rec.stamp_ms;
+                event->zones = ((uint64_t)rec.zones_hi << 32) | rec.zones_lo;
+                event->type = rec.type;
+                return true;
+            }
+            index--;
+        }
+        slot = next_slot(spill, slot);
+    }
+    return false;
+}
+
+void fire_spill_consume(fire_spill_t *spill, uint32_t n)
+{
+    const uint32_t consumed = FIRE_SPILL_CONSUMED;
+
+    while (n > 0 && spill->count > 0) {
+        skip_to_pending(spill);
+        if (spill->head == spill->tail) {
+            spill->count = 0;
+            break;
+        }
+        if (!spill->flash->write(slot_addr(spill, spill->head), &consumed, 4)) {
+            spill->write_errors++;
+        }
+        spill->head = next_slot(spill, spill->head);
+        spill->count--;
+        n--;
+    }
+    skip_to_pending(spill);
+}
@@ -0,0 +1,78 @@
+#ifndef FIRE_SPILL_H
+#define FIRE_SPILL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fire_event.h"
+#include "fire_flash.h"
+
+// Kích thước sector flash (đơn vị xóa)
+#define FIRE_SPILL_SECTOR_SIZE FIRE_FLASH_SECTOR_SIZE
+// Kích thước một bản ghi trên flash
+#define FIRE_SPILL_RECORD_SIZE 32
+#define FIRE_SPILL_RECORDS_PER_SECTOR (FIRE_SPILL_SECTOR_SIZE / FIRE_SPILL_RECORD_SIZE)
+
+// Trạng thái bản ghi: chỉ chuyển bit 1 -> 0 nên ghi đè được mà không cần xóa
+#define FIRE_SPILL_ERASED   0xffffffff
+#define FIRE_SPILL_VALID    0x5a5affff
+#define FIRE_SPILL_CONSUMED 0x5a5a0000
+
+// Hàng đợi FIFO các sự kiện trên một vùng flash gồm nhiều sector (ghi vòng)
+// Persistent FIFO of events in a ring of flash sectors
+typedef struct {
+    const fire_flash_ops_t *flash;
+    uint32_t base;      // Flash address of the first sector
+    uint16_t sectors;   // Number of sectors (at least 2)
+    uint32_t slots;     // Total record slots
+    uint32_t head;      // Slot of the oldest pending record
+    uint32_t tail;      // Slot the next record is written to
+    uint32_t count;     // Pending (not yet consumed) records
+    uint32_t next_seq;  // Sequence number following the newest record ever written
+    uint32_t next_order; // Append counter of the next record (ring order, seq may go back)
+    uint32_t write_errors;
+} fire_spill_t;
+
+/**
+ * @brief Mounts the spill queue, recovering pending records from flash
+ *
+ * @param spill Queue
+ * @param flash Flash primitives
+ * @param base Flash address of the region, sector aligned
+ * @param sectors Number of sectors in the region (at least 2)
+ * @return false if the parameters are invalid or flash cannot be read
+ */
+bool fire_spill_mount(fire_spill_t *spill, const fire_flash_ops_t *flash, uint32_t base, uint16_t sectors);
+
+/**
+ * @brief Returns how many records fit before the queue is full
+ *
+ * One sector is always kept free so the next one can be erased.
+ */
+static inline uint32_t fire_spill_capacity(const fire_spill_t *spill)
+{
+    return spill->slots - FIRE_SPILL_RECORDS_PER_SECTOR;
+}
+
+/**
+ * @brief Appends an event at the tail of the queue
+ *
+ * Records are delivered in append order; @p event->seq may be lower than
+ * that of earlier records (RAM events saved before a restart).
+ *
+ * @return false if the queue is full or the flash write failed
+ */
+bool fire_spill_append(fire_spill_t *spill, const fire_event_t *event);
+
+/**
+ * @brief Reads the pending event at position @p index from the head
+ *
+ * @return false if there is no such event or it is corrupted
+ */
+bool fire_spill_peek(const fire_spill_t *spill, uint32_t index, fire_event_t *event);
+
+/**
+ * @brief Marks the @p n oldest pending events as consumed
+ */
+void fire_spill_consume(fire_spill_t *spill, uint32_t n);
+
+#endif
@@ -0,0 +1,252 @@
+#include <string.h>
+#include "fire_trace.h"
+#include "fire_clock.h"
+
+// log2(FIRE_TRACE_SUB_BUCKETS)
+#define SUB_BITS 2
+
+#if (1 << SUB_BITS) != FIRE_TRACE_SUB_BUCKETS
+#error "FIRE_TRACE_SUB_BUCKETS must be 1 << SUB_BITS"
+#endif
+
+static fire_trace_hist_t trace_stages[FIRE_TRACE_STAGES];
+
+// Báo động đang được theo dõi: timestamp và bit các điểm đã ghi
+static fire_trace_span_t trace_open;
+static uint8_t trace_open_mask;
+
+// Vòng các báo động gần nhất
+static fire_trace_span_t trace_spans[FIRE_TRACE_SPANS];
+static uint32_t trace_span_total;
+
+static uint16_t crc16(const uint8_t *p, size_t len)
+{
+    uint16_t crc = 0xffff;
+    while (len--) {
+        crc ^= (uint16_t)*p++ << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    return p + 4;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+void fire_trace_init(void)
+{
+    memset(trace_stages, 0, sizeof(trace_stages));
+    memset(trace_spans, 0, sizeof(trace_spans));
+    trace_open_mask = 0;
+    trace_span_total = 0;
+}
+
+uint8_t fire_trace_bucket(uint32_t us)
+{
+    if (us < FIRE_TRACE_SUB_BUCKETS) {
+        return us;
+    }
+    // Bit cao nhất chọn lũy thừa của 2, SUB_BITS bit tiếp theo chọn bucket con
+    uint32_t octave = 31 - __builtin_clz(us);
+    uint32_t bucket = (octave - SUB_BITS + 1) * FIRE_TRACE_SUB_BUCKETS +
+                      ((us >> (octave - SUB_BITS)) & (FIRE_TRACE_SUB_BUCKETS - 1));
+    return bucket < FIRE_TRACE_BUCKETS ? bucket : FIRE_TRACE_BUCKETS - 1;
+}
+
+uint32_t fire_trace_bucket_floor(uint8_t bucket)
+{
+    if (bucket < FIRE_TRACE_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t octave = bucket / FIRE_TRACE_SUB_BUCKETS + SUB_BITS - 1;
+    uint32_t sub = bucket % FIRE_TRACE_SUB_BUCKETS;
+    return (FIRE_TRACE_SUB_BUCKETS + sub) << (octave - SUB_BITS);
+}
+
+static void hist_add(fire_trace_hist_t *hist, uint32_t us)
+{
+    uint16_t *bucket = &hist->buckets[fire_trace_bucket(us)];
+    if (*bucket != UINT16_MAX) {
+        (*bucket)++;
+    }
+    hist->count++;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+}
+
+void fire_trace_record(fire_trace_stage_t stage, uint32_t cycles)
+{
+    hist_add(&trace_stages[stage], fire_clock_cycles_to_us(cycles));
+}
+
+void fire_trace_point(fire_trace_point_t point, uint32_t ccount)
+{
+    if (point == FIRE_TRACE_EDGE) {
+        trace_open_mask = 0;
+    } else if (!(trace_open_mask & (1 << FIRE_TRACE_EDGE))) {
+        return;
+    }
+    trace_open.ccount[point] = ccount;
+    trace_open_mask |= 1 << point;
+    if (point != FIRE_TRACE_OUTPUT) {
+        return;
+    }
+
+    // Báo động hoàn chỉnh: cộng từng đoạn vào histogram
+    trace_open_mask = 0;
+    const uint32_t *t = trace_open.ccount;
+    fire_trace_record(FIRE_TRACE_STAGE_DEBOUNCE, t[FIRE_TRACE_ALARM] - t[FIRE_TRACE_EDGE]);
+    fire_trace_record(FIRE_TRACE_STAGE_COMMAND, t[FIRE_TRACE_COMMAND] - t[FIRE_TRACE_ALARM]);
+    fire_trace_record(FIRE_TRACE_STAGE_OUTPUT, t[FIRE_TRACE_OUTPUT] - t[FIRE_TRACE_COMMAND]);
+    fire_trace_record(FIRE_TRACE_STAGE_TOTAL, t[FIRE_TRACE_OUTPUT] - t[FIRE_TRACE_EDGE]);
+    trace_spans[trace_span_total++ % FIRE_TRACE_SPANS] = trace_open;
+}
+
+const fire_trace_hist_t *fire_trace_stage(fire_trace_stage_t stage)
+{
+    return &trace_stages[stage];
+}
+
+uint32_t fire_trace_percentile(const fire_trace_hist_t *hist, uint16_t permille)
+{
+    // Bucket có thể đã bão hòa, nên xếp hạng theo tổng các bucket
+    uint32_t total = 0;
+    for (int i = 0; i < FIRE_TRACE_BUCKETS; i++) {
+        total += hist->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t rank = ((uint64_t)total * permille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    for (int i = 0; i < FIRE_TRACE_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = fire_trace_bucket_floor(i + 1) - 1;
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+size_t fire_trace_encode(uint8_t *buf, size_t size, uint8_t cpu_mhz)
+{
+    uint8_t *p = buf;
+    uint8_t *end = buf + size;
+
+    if (size < 8) {
+        return 0;
+    }
+    p = put_u32(p, FIRE_TRACE_MAGIC);
+    *p++ = FIRE_TRACE_VERSION;
+    *p++ = FIRE_TRACE_STAGES;
+    *p++ = FIRE_TRACE_BUCKETS;
+    *p++ = cpu_mhz;
+
+    for (int s = 0; s < FIRE_TRACE_STAGES; s++) {
+        const fire_trace_hist_t *hist = &trace_stages[s];
+        int first = 0, last = -1;
+        for (int i = 0; i < FIRE_TRACE_BUCKETS; i++) {
+            if (hist->buckets[i] != 0) {
+                if (last < 0) {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+        int run = last - first + 1;
+        if (end - p < 10 + 2 * run) {
+            return 0;
+        }
+        p = put_u32(p, hist->count);
+        p = put_u32(p, hist->max_us);
+        *p++ = first;
+        *p++ = run;
+        for (int i = first; i <= last; i++) {
+            *p++ = hist->buckets[i];
+            *p++ = hist->buckets[i] >> 8;
+        }
+    }
+
+    uint32_t spans = trace_span_total < FIRE_TRACE_SPANS ? trace_span_total : FIRE_TRACE_SPANS;
+    if ((size_t)(end - p) < 1 + spans * 4 * FIRE_TRACE_POINTS + 2) {
+        return 0;
+    }
+    *p++ = spans;
+    for (uint32_t i = trace_span_total - spans; i != trace_span_total; i++) {
+        for (int point = 0; point < FIRE_TRACE_POINTS; point++) {
+            p = put_u32(p, trace_spans[i % FIRE_TRACE_SPANS].ccount[point]);
+        }
+    }
+
+    uint16_t crc = crc16(buf, p - buf);
+    *p++ = crc;
+    *p++ = crc >> 8;
+    return p - buf;
+}
+
+size_t fire_trace_decode(const uint8_t *buf, size_t len, fire_trace_dump_t *dump)
+{
+    const uint8_t *p = buf;
+    const uint8_t *end = buf + len;
+
+    if (len < 8 || get_u32(p) != FIRE_TRACE_MAGIC || p[4] != FIRE_TRACE_VERSION ||
+        p[5] != FIRE_TRACE_STAGES || p[6] != FIRE_TRACE_BUCKETS) {
+        return 0;
+    }
+    memset(dump, 0, sizeof(*dump));
+    dump->cpu_mhz = p[7];
+    p += 8;
+
+    for (int s = 0; s < FIRE_TRACE_STAGES; s++) {
+        fire_trace_hist_t *hist = &dump->stages[s];
+        if (end - p < 10) {
+            return 0;
+        }
+        hist->count = get_u32(p);
+        hist->max_us = get_u32(p + 4);
+        uint8_t first = p[8], run = p[9];
+        p += 10;
+        if (first + run > FIRE_TRACE_BUCKETS || end - p < 2 * run) {
+            return 0;
+        }
+        for (int i = 0; i < run; i++, p += 2) {
+            hist->buckets[first + i] = p[0] | p[1] << 8;
+        }
+    }
+
+    if (end - p < 1 || p[0] > FIRE_TRACE_SPANS) {
+        return 0;
+    }
+    dump->span_count = *p++;
+    if ((size_t)(end - p) < dump->span_count * 4 * FIRE_TRACE_POINTS + 2) {
+        return 0;
+    }
+    for (int i = 0; i < dump->span_count; i++) {
+        for (int point = 0; point < FIRE_TRACE_POINTS; point++, p += 4) {
+            dump->spans[i].ccount[point] = get_u32(p);
+        }
+    }
+
+    if ((p[0] | p[1] << 8) != crc16(buf, p - buf)) {
+        return 0;
+    }
+    return p + 2 - buf;
+}
@@ -0,0 +1,145 @@
+#ifndef FIRE_TRACE_H
+#define FIRE_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Histogram log-tuyến tính theo micro giây: 0-3 us chính xác, sau đó mỗi lũy
+// thừa của 2 chia 4 bucket (sai số dưới 25%); bucket cuối từ 1.8 s trở lên
+#define FIRE_TRACE_SUB_BUCKETS 4
+#define FIRE_TRACE_BUCKETS     80
+
+// Số lần báo động gần nhất giữ nguyên timestamp CCOUNT
+#define FIRE_TRACE_SPANS 4
+
+#define FIRE_TRACE_MAGIC   0x43525446 // "FTRC"
+#define FIRE_TRACE_VERSION 1
+
+// Các điểm đo trên đường đi của một báo động, theo thứ tự
+// Trace points on the path of one alarm, in order
+typedef enum {
+    FIRE_TRACE_EDGE,     // gpio_interrupt_handler timestamped the edge that started the debounce
+    FIRE_TRACE_ALARM,    // fire_monitor_task decided to raise the alarm
+    FIRE_TRACE_COMMAND,  // set_led_state queued the FIRE LED command
+    FIRE_TRACE_OUTPUT,   // led_manager_task drove the FIRE LED pin
+    FIRE_TRACE_POINTS
+} fire_trace_point_t;
+
+// Các đoạn được đo thành histogram
+// Measured stages, one histogram each
+typedef enum {
+    FIRE_TRACE_STAGE_WAKE,     // Every edge: ISR timestamp -> fire_monitor_task pops it
+    FIRE_TRACE_STAGE_DEBOUNCE, // EDGE -> ALARM
+    FIRE_TRACE_STAGE_COMMAND,  // ALARM -> COMMAND
+    FIRE_TRACE_STAGE_OUTPUT,   // COMMAND -> OUTPUT
+    FIRE_TRACE_STAGE_TOTAL,    // EDGE -> OUTPUT
+    FIRE_TRACE_STAGES
+} fire_trace_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint16_t buckets[FIRE_TRACE_BUCKETS]; // Saturating counts
+} fire_trace_hist_t;
+
+// Timestamp CCOUNT của một báo động hoàn chỉnh
+// CCOUNT stamps of one completed alarm
+typedef struct {
+    uint32_t ccount[FIRE_TRACE_POINTS];
+} fire_trace_span_t;
+
+// Nội dung một bản dump, dùng cho công cụ giải mã trên host
+// Decoded dump contents
+typedef struct {
+    uint8_t cpu_mhz;
+    fire_trace_hist_t stages[FIRE_TRACE_STAGES];
+    uint8_t span_count;
+    fire_trace_span_t spans[FIRE_TRACE_SPANS]; // Oldest first
+} fire_trace_dump_t;
+
+// Kích thước lớn nhất của một bản dump: header, mỗi đoạn count, max và dải
+// bucket khác 0, các span, CRC
+#define FIRE_TRACE_FRAME_MAX \
+    (8 + FIRE_TRACE_STAGES * (8 + 2 + 2 * FIRE_TRACE_BUCKETS) + \
+     1 + FIRE_TRACE_SPANS * 4 * FIRE_TRACE_POINTS + 2)
+
+/**
+ * @brief Clears every histogram and span
+ */
+void fire_trace_init(void);
+
+/**
+ * @brief Records one trace point of the alarm in progress
+ *
+ * FIRE_TRACE_EDGE opens a new span. When FIRE_TRACE_OUTPUT arrives and every
+ * earlier point was recorded, the stage latencies are added to the
+ * histograms and the span is kept in the recent span buffer. Points outside
+ * an open span (a LED command that is not an alarm) are ignored.
+ *
+ * @param point Trace point
+ * @param ccount Cycle counter value at that point
+ * @note Called from tasks only; the scheduler is cooperative so no lock is taken.
+ */
+void fire_trace_point(fire_trace_point_t point, uint32_t ccount);
+
+/**
+ * @brief Adds one latency sample to a stage histogram
+ *
+ * @param stage Stage
+ * @param cycles Elapsed cycle counter ticks
+ */
+void fire_trace_record(fire_trace_stage_t stage, uint32_t cycles);
+
+/**
+ * @brief Returns the histogram of a stage
+ */
+const fire_trace_hist_t *fire_trace_stage(fire_trace_stage_t stage);
+
+/**
+ * @brief Bucket index of a latency in microseconds
+ */
+uint8_t fire_trace_bucket(uint32_t us);
+
+/**
+ * @brief Smallest latency that falls into a bucket
+ */
+uint32_t fire_trace_bucket_floor(uint8_t bucket);
+
+/**
+ * @brief Estimates a percentile from a histogram
+ *
+ * @param hist Histogram
+ * @param permille Percentile in tenths of a percent (500 = p50, 990 = p99)
+ * @return Upper bound of the bucket holding that rank, capped at max_us;
+ *         0 for an empty histogram
+ */
+uint32_t fire_trace_percentile(const fire_trace_hist_t *hist, uint16_t permille);
+
+/**
+ * @brief Encodes histograms and recent spans into a binary frame
+ *
+ * Frame (little-endian): magic "FTRC", version, stage count, bucket count,
+ * CPU MHz; per stage count (u32), max_us (u32), first non-zero bucket (u8),
+ * bucket run length (u8) and that many u16 counts; span count (u8) and the
+ * spans, oldest first, as FIRE_TRACE_POINTS u32 CCOUNT stamps each; CRC-16/CCITT
+ * of everything before it.
+ *
+ * @param buf Output buffer, FIRE_TRACE_FRAME_MAX bytes always suffice
+ * @param size Size of buf
+ * @param cpu_mhz Cycle counter ticks per microsecond
+ * @return Frame length, 0 if buf is too small
+ */
+size_t fire_trace_encode(uint8_t *buf, size_t size, uint8_t cpu_mhz);
+
+/**
+ * @brief Decodes a frame produced by fire_trace_encode
+ *
+ * @param buf Bytes starting at the magic
+ * @param len Bytes available
+ * @param dump Decoded contents
+ * @return Frame length, 0 if the bytes are not a complete valid frame
+ */
+size_t fire_trace_decode(const uint8_t *buf, size_t len, fire_trace_dump_t *dump);
+
+#endif
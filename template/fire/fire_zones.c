@@ -0,0 +1,132 @@
+#include <string.h>
+#include "fire_zones.h"
+#include "fire_clock.h"
+
+#define ZONE_BIT(z) ((fire_zone_mask_t)1 << (z))
+
+// Cập nhật mask timer/báo động của một vùng sau khi máy trạng thái chạy
+static void zone_apply(fire_zones_t *zones, uint8_t zone, const fire_fsm_action_t *action,
+                       uint32_t ccount, fire_zones_batch_t *batch)
+{
+    const fire_fsm_t *fsm = &zones->fsm[zone];
+
+    if (fsm->timer_running) {
+        zones->timers |= ZONE_BIT(zone);
+    } else {
+        zones->timers &= ~ZONE_BIT(zone);
+    }
+    if (action->alarm_on) {
+        zones->alarms |= ZONE_BIT(zone);
+        batch->raised |= ZONE_BIT(zone);
+        batch->cleared &= ~ZONE_BIT(zone);
+        // Giữ cạnh cũ nhất để đo độ trễ xấu nhất của batch
+        if (batch->oldest_zone == FIRE_ZONES_NONE ||
+            ccount - fsm->edge_ccount > ccount - batch->oldest_edge) {
+            batch->oldest_zone = zone;
+            batch->oldest_edge = fsm->edge_ccount;
+        }
+    }
+    if (action->alarm_off) {
+        zones->alarms &= ~ZONE_BIT(zone);
+        batch->cleared |= ZONE_BIT(zone);
+        batch->raised &= ~ZONE_BIT(zone);
+    }
+}
+
+static inline bool input_active(const fire_zones_t *zones, uint8_t bit)
+{
+    bool level = (zones->last_input >> bit) & 1;
+    return level == ((zones->active_high_inputs >> bit) & 1);
+}
+
+bool fire_zones_init(fire_zones_t *zones, const fire_zone_config_t *config, uint8_t count)
+{
+    if (count > FIRE_ZONES_MAX) {
+        return false;
+    }
+
+    memset(zones, 0, sizeof(*zones));
+    memset(zones->zone_of_input, FIRE_ZONES_NONE, sizeof(zones->zone_of_input));
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t bit = config[i].input;
+        if (bit >= FIRE_ZONES_INPUT_BITS || zones->zone_of_input[bit] != FIRE_ZONES_NONE) {
+            return false;
+        }
+        zones->zone_of_input[bit] = i;
+        zones->input_of_zone[i] = bit;
+        zones->used_inputs |= (uint64_t)1 << bit;
+        if (config[i].active_high) {
+            zones->active_high_inputs |= (uint64_t)1 << bit;
+        }
+        fire_fsm_init(&zones->fsm[i], config[i].debounce_us, config[i].recovery_us);
+    }
+    zones->count = count;
+    // Mức nghỉ: active-low ở mức cao, active-high ở mức thấp
+    zones->last_input = zones->used_inputs & ~zones->active_high_inputs;
+    return true;
+}
+
+void fire_zones_batch_clear(fire_zones_batch_t *batch)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->oldest_zone = FIRE_ZONES_NONE;
+}
+
+void fire_zones_input(fire_zones_t *zones, uint64_t input, uint32_t ccount, fire_zones_batch_t *batch)
+{
+    uint64_t changed = (input ^ zones->last_input) & zones->used_inputs;
+    fire_fsm_action_t action;
+
+    zones->last_input = (zones->last_input & ~zones->used_inputs) | (input & zones->used_inputs);
+    while (changed) {
+        uint8_t bit = __builtin_ctzll(changed);
+        changed &= changed - 1;
+
+        uint8_t zone = zones->zone_of_input[bit];
+        fire_fsm_edge(&zones->fsm[zone], input_active(zones, bit), ccount, &action);
+        zone_apply(zones, zone, &action, ccount, batch);
+        batch->edges++;
+    }
+}
+
+void fire_zones_expire(fire_zones_t *zones, uint32_t ccount, fire_zones_batch_t *batch)
+{
+    fire_zone_mask_t pending = zones->timers;
+    fire_fsm_action_t action;
+
+    while (pending) {
+        uint8_t zone = __builtin_ctzll(pending);
+        pending &= pending - 1;
+
+        fire_fsm_t *fsm = &zones->fsm[zone];
+        // Máy trạng thái tự bỏ qua timer chưa hết hạn
+        fire_fsm_timeout(fsm, input_active(zones, zones->input_of_zone[zone]), ccount, &action);
+        zone_apply(zones, zone, &action, ccount, batch);
+    }
+}
+
+bool fire_zones_next_timeout(const fire_zones_t *zones, uint32_t ccount, uint32_t *timeout_us)
+{
+    fire_zone_mask_t pending = zones->timers;
+    bool found = false;
+    uint32_t best = 0;
+
+    while (pending) {
+        uint8_t zone = __builtin_ctzll(pending);
+        pending &= pending - 1;
+
+        const fire_fsm_t *fsm = &zones->fsm[zone];
+        uint32_t elapsed = fire_clock_cycles_to_us(ccount - fsm->timer_ccount);
+        uint32_t remaining = elapsed < fsm->timer_us ? fsm->timer_us - elapsed : 0;
+        // Thời gian dài chạy từng chặng để khoảng cách CCOUNT không quay vòng
+        if (remaining > FIRE_FSM_TIMER_STEP_US) {
+            remaining = FIRE_FSM_TIMER_STEP_US;
+        }
+        if (!found || remaining < best) {
+            best = remaining;
+            found = true;
+        }
+    }
+    *timeout_us = best;
+    return found;
+}
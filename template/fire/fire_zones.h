@@ -0,0 +1,120 @@
+#ifndef FIRE_ZONES_H
+#define FIRE_ZONES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fire_fsm.h"
+
+// Số vùng báo cháy tối đa (một bit cho mỗi vùng trong mask 64 bit)
+#define FIRE_ZONES_MAX 64
+
+// Số bit của từ đầu vào: GPIO 0-15 ở bit 0-15, PCF8574 thứ n ở bit 16+8n..23+8n,
+// kênh analog từ bit 63 trở xuống
+#define FIRE_ZONES_INPUT_BITS 64
+#define FIRE_ZONES_GPIO_BITS 16
+
+// Vị trí bit đầu vào của chân pin trên PCF8574 thứ n
+#define FIRE_ZONES_EXPANDER_INPUT(n, pin) (FIRE_ZONES_GPIO_BITS + 8 * (n) + (pin))
+// Kênh analog thứ n (fire_smoke.h) dùng các bit cao nhất, đếm xuống; bit được
+// đặt khi kênh báo khói
+#define FIRE_ZONES_ANALOG_INPUT(n) (FIRE_ZONES_INPUT_BITS - 1 - (n))
+
+#define FIRE_ZONES_NONE 0xff
+
+typedef uint64_t fire_zone_mask_t;
+
+// Cấu hình của một vùng
+// Static description of one zone
+typedef struct {
+    uint8_t input;        // Bit in the input word (GPIO number, FIRE_ZONES_EXPANDER_INPUT or FIRE_ZONES_ANALOG_INPUT)
+    bool active_high;     // true if the detector pulls the input high on alarm
+    uint32_t debounce_us; // Time the input must stay active before alarming
+    uint32_t recovery_us; // Time the input must stay inactive before clearing
+} fire_zone_config_t;
+
+// Kết quả gộp của một lần xử lý (nhiều cạnh cùng lúc -> một batch)
+// Zone changes coalesced over one processing pass
+typedef struct {
+    fire_zone_mask_t raised;  // Zones that entered the alarm state
+    fire_zone_mask_t cleared; // Zones whose alarm cleared
+    uint8_t oldest_zone;      // Raised zone with the oldest triggering edge
+    uint32_t oldest_edge;     // Cycle count of that edge (for latency)
+    uint32_t edges;           // Number of zone edges fed into the engine
+} fire_zones_batch_t;
+
+// Bộ xử lý tất cả các vùng; chỉ duyệt các bit thay đổi hoặc có timer đang chạy
+// Zone engine: per-zone state machines driven by input-word snapshots
+typedef struct {
+    uint8_t count;                             // Number of configured zones
+    uint8_t zone_of_input[FIRE_ZONES_INPUT_BITS]; // Zone index per input bit, or FIRE_ZONES_NONE
+    uint8_t input_of_zone[FIRE_ZONES_MAX];     // Input bit of each zone
+    uint64_t used_inputs;                      // Input bits that belong to a zone
+    uint64_t active_high_inputs;               // Input bits of active-high zones
+    uint64_t last_input;                       // Last input word seen
+    fire_zone_mask_t timers;                   // Zones with a running debounce/recovery timer
+    fire_zone_mask_t alarms;                   // Zones currently in alarm (incl. recovery)
+    fire_fsm_t fsm[FIRE_ZONES_MAX];
+} fire_zones_t;
+
+/**
+ * @brief Initializes the engine from a zone table
+ *
+ * Every zone starts inactive; feed the current input word with
+ * fire_zones_input() afterwards to pick up detectors that are already active.
+ *
+ * @param zones Engine
+ * @param config Zone table, each zone must use a distinct input bit
+ * @param count Number of zones (at most FIRE_ZONES_MAX)
+ * @return false if the table is invalid
+ */
+bool fire_zones_init(fire_zones_t *zones, const fire_zone_config_t *config, uint8_t count);
+
+/**
+ * @brief Clears a batch before a processing pass
+ */
+void fire_zones_batch_clear(fire_zones_batch_t *batch);
+
+/**
+ * @brief Feeds one input word snapshot into the engine
+ *
+ * Only input bits that differ from the previous snapshot are visited, so
+ * simultaneous edges on many zones cost one call.
+ *
+ * @param zones Engine
+ * @param input Input word (GPIO.IN in bits 0-15, expander ports above)
+ * @param ccount Cycle count timestamp of the snapshot
+ * @param batch Accumulates the resulting changes
+ */
+void fire_zones_input(fire_zones_t *zones, uint64_t input, uint32_t ccount, fire_zones_batch_t *batch);
+
+/**
+ * @brief Runs the expired debounce/recovery timers
+ *
+ * @param zones Engine
+ * @param ccount Current cycle count
+ * @param batch Accumulates the resulting changes
+ */
+void fire_zones_expire(fire_zones_t *zones, uint32_t ccount, fire_zones_batch_t *batch);
+
+/**
+ * @brief Returns the time until the earliest running zone timer expires
+ *
+ * @param zones Engine
+ * @param ccount Current cycle count
+ * Capped at FIRE_FSM_TIMER_STEP_US: a longer timeout runs in steps, call
+ * fire_zones_expire() at the end of each one.
+ *
+ * @param timeout_us Output: remaining time in microseconds (0 if overdue)
+ * @return false if no zone timer is running
+ */
+bool fire_zones_next_timeout(const fire_zones_t *zones, uint32_t ccount, uint32_t *timeout_us);
+
+/**
+ * @brief Returns the mask of zones currently in alarm
+ */
+static inline fire_zone_mask_t fire_zones_alarms(const fire_zones_t *zones)
+{
+    return zones->alarms;
+}
+
+#endif
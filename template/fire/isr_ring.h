@@ -0,0 +1,115 @@
+#ifndef ISR_RING_H
+#define ISR_RING_H
+
+#include <stdint.h>
+
+// Số slot của ring (phải là lũy thừa của 2)
+#define ISR_RING_SIZE 32
+
+#if (ISR_RING_SIZE & (ISR_RING_SIZE - 1)) != 0
+#error "ISR_RING_SIZE must be a power of two"
+#endif
+
+// Một sự kiện GPIO được ghi lại trong ISR
+// One GPIO event captured in interrupt context
+typedef struct {
+    uint32_t ccount;  // Cycle counter value when the interrupt was serviced
+    uint16_t pins;    // Bitmask of GPIOs that raised the interrupt
+    uint16_t levels;  // Snapshot of GPIO input levels (GPIO 0-15) at that time
+} isr_event_t;
+
+// Single-producer (ISR) / single-consumer (task) lock-free ring.
+// head is only written by the producer, tail only by the consumer. Both are
+// free-running counters; the slot index is taken modulo ISR_RING_SIZE.
+typedef struct {
+    uint32_t head;       // Total number of events published by the producer
+    uint32_t tail;       // Total number of events consumed by the consumer
+    uint32_t overflows;  // Events dropped because the ring was full
+    isr_event_t slots[ISR_RING_SIZE];
+} isr_ring_t;
+
+// Kết quả của isr_ring_push
+typedef enum {
+    ISR_RING_DROPPED = -1, // Ring was full, event dropped and counted
+    ISR_RING_QUEUED = 0,   // Event queued, consumer is already pending
+    ISR_RING_WAKE = 1      // Event queued, consumer may be blocked: notify it
+} isr_ring_result_t;
+
+/**
+ * @brief Resets the ring to the empty state
+ *
+ * @param ring Ring to initialize
+ * @note Must not be called while the producer can run.
+ */
+static inline void isr_ring_init(isr_ring_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflows = 0;
+}
+
+/**
+ * @brief Publishes one event from the producer side (ISR)
+ *
+ * The return value tells the producer whether the consumer has drained every
+ * earlier event and may therefore be blocked waiting; only then does it need
+ * a task notification. Spurious wakeups are possible, lost wakeups are not.
+ *
+ * @param ring Ring to write to
+ * @param ccount Cycle counter timestamp of the event
+ * @param pins Bitmask of GPIOs that raised the interrupt
+ * @param levels Snapshot of GPIO input levels
+ * @return ISR_RING_WAKE, ISR_RING_QUEUED or ISR_RING_DROPPED
+ */
+static inline isr_ring_result_t isr_ring_push(isr_ring_t *ring, uint32_t ccount,
+                                              uint16_t pins, uint16_t levels)
+{
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ISR_RING_SIZE) {
+        ring->overflows++;
+        return ISR_RING_DROPPED;
+    }
+
+    isr_event_t *slot = &ring->slots[head & (ISR_RING_SIZE - 1)];
+    slot->ccount = ccount;
+    slot->pins = pins;
+    slot->levels = levels;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+
+    // Consumer đã đọc hết các sự kiện trước đó -> có thể đang chờ
+    if (__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) == head) {
+        return ISR_RING_WAKE;
+    }
+    return ISR_RING_QUEUED;
+}
+
+/**
+ * @brief Takes the oldest event from the consumer side (task)
+ *
+ * @param ring Ring to read from
+ * @param event Output for the event
+ * @return 1 if an event was returned, 0 if the ring is empty
+ */
+static inline int isr_ring_pop(isr_ring_t *ring, isr_event_t *event)
+{
+    uint32_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == tail) {
+        return 0;
+    }
+    *event = ring->slots[tail & (ISR_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_SEQ_CST);
+    return 1;
+}
+
+/**
+ * @brief Returns the cumulative number of dropped events
+ *
+ * The counter only grows; callers report the difference to the last value
+ * they have seen.
+ */
+static inline uint32_t isr_ring_overflows(const isr_ring_t *ring)
+{
+    return __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED);
+}
+
+#endif
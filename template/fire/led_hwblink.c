@@ -0,0 +1,311 @@
+#include <string.h>
+#include "led_hwblink.h"
+
+#ifdef FIRE_HOST_BUILD
+#define IRAM
+
+hwblink_mock_regs_t hwblink_mock_regs;
+
+#define HW_OUT_SET(mask)    (hwblink_mock_regs.out |= (mask))
+#define HW_OUT_CLEAR(mask)  (hwblink_mock_regs.out &= ~(mask))
+#define HW_TIMER_COUNT()    (hwblink_mock_regs.count)
+#define HW_TIMER_RUNNING()  (hwblink_mock_regs.running)
+#define HW_INT_MASK()
+#define HW_INT_UNMASK()
+
+static inline void HW_TIMER_LOAD(uint32_t load)
+{
+    hwblink_mock_regs.load = load;
+    hwblink_mock_regs.count = load;
+    hwblink_mock_regs.load_writes++;
+}
+
+static inline void HW_TIMER_ENABLE(bool enable)
+{
+    hwblink_mock_regs.running = enable;
+    hwblink_mock_regs.int_enabled = enable;
+}
+#else
+#include "esp/gpio.h"
+#include "esp/timer.h"
+#include "esp/interrupts.h"
+
+#define HW_OUT_SET(mask)    (GPIO.OUT_SET = (mask))
+#define HW_OUT_CLEAR(mask)  (GPIO.OUT_CLEAR = (mask))
+#define HW_TIMER_COUNT()    timer_get_count(FRC1)
+#define HW_TIMER_RUNNING()  timer_get_run(FRC1)
+#define HW_TIMER_LOAD(load) timer_set_load(FRC1, load)
+// Chỉ chặn ngắt FRC1 khi cập nhật lịch, các ngắt khác vẫn hoạt động
+#define HW_INT_MASK()       _xt_isr_mask(BIT(INUM_TIMER_FRC1))
+#define HW_INT_UNMASK()     _xt_isr_unmask(BIT(INUM_TIMER_FRC1))
+
+static inline void HW_TIMER_ENABLE(bool enable)
+{
+    timer_set_interrupts(FRC1, enable);
+    timer_set_run(FRC1, enable);
+}
+#endif
+
+static hwblink_sched_t hwblink;
+static hwblink_stats_t hwblink_stats;
+static uint32_t hwblink_loaded; // Ticks loaded into FRC1 for the current interval
+
+uint32_t hwblink_ms_to_ticks(uint32_t interval_ms)
+{
+    uint64_t ticks = (uint64_t)interval_ms * HWBLINK_TICKS_PER_SEC / 1000;
+    if (ticks == 0) {
+        return 1;
+    }
+    return ticks > HWBLINK_MAX_LOAD ? HWBLINK_MAX_LOAD : (uint32_t)ticks;
+}
+
+// Thời gian một bước của mẫu sang tick FRC1; dùng trong ISR nên không chia 64 bit.
+// Bước đã được kiểm tra không vượt LED_PATTERN_STEP_MAX_MS nên không tràn.
+static inline uint32_t hwblink_step_ticks(uint32_t step)
+{
+    uint32_t ticks = (led_pattern_step_ms(step) * (HWBLINK_TICKS_PER_SEC / 500)) >> 1;
+    return ticks ? ticks : 1;
+}
+
+void hwblink_sched_init(hwblink_sched_t *sched)
+{
+    memset(sched, 0, sizeof(*sched));
+}
+
+// Kênh đang điều khiển pin, hoặc một kênh mới; NULL nếu đã hết kênh
+static hwblink_channel_t *hwblink_sched_channel(hwblink_sched_t *sched, uint8_t pin)
+{
+    for (int i = 0; i < sched->count; i++) {
+        if (sched->channels[i].pin == pin) {
+            return &sched->channels[i];
+        }
+    }
+    if (sched->count >= HWBLINK_MAX_CHANNELS) {
+        return NULL;
+    }
+    hwblink_channel_t *ch = &sched->channels[sched->count++];
+    ch->pin = pin;
+    return ch;
+}
+
+bool hwblink_sched_start(hwblink_sched_t *sched, uint8_t pin, uint32_t period, uint32_t *set)
+{
+    if (pin >= 16) {
+        return false;
+    }
+    if (period == 0) {
+        period = 1;
+    }
+    hwblink_channel_t *ch = hwblink_sched_channel(sched, pin);
+    if (ch == NULL) {
+        return false;
+    }
+    ch->period = period;
+    ch->remaining = period;
+    ch->cursor.pattern = NULL;
+    // Bật LED ngay khi bắt đầu nhấp nháy
+    sched->levels |= 1u << pin;
+    *set = 1u << pin;
+    return true;
+}
+
+bool hwblink_sched_start_pattern(hwblink_sched_t *sched, uint8_t pin, const led_pattern_t *pattern,
+                                 uint32_t *set, uint32_t *clear)
+{
+    if (pin >= 16 || pattern->count == 0) {
+        return false;
+    }
+    hwblink_channel_t *ch = hwblink_sched_channel(sched, pin);
+    if (ch == NULL) {
+        return false;
+    }
+    uint32_t step = led_pattern_cursor_start(&ch->cursor, pattern);
+    ch->period = 0;
+    ch->remaining = hwblink_step_ticks(step);
+    *set = *clear = 0;
+    if (led_pattern_step_level(step)) {
+        sched->levels |= 1u << pin;
+        *set = 1u << pin;
+    } else {
+        sched->levels &= ~(1u << pin);
+        *clear = 1u << pin;
+    }
+    return true;
+}
+
+bool hwblink_sched_stop(hwblink_sched_t *sched, uint8_t pin)
+{
+    for (int i = 0; i < sched->count; i++) {
+        if (sched->channels[i].pin == pin) {
+            sched->channels[i] = sched->channels[--sched->count];
+            sched->levels &= ~(1u << pin);
+            return true;
+        }
+    }
+    return false;
+}
+
+int IRAM hwblink_sched_advance(hwblink_sched_t *sched, uint32_t elapsed, uint32_t *set, uint32_t *clear)
+{
+    uint32_t toggle = 0;
+    int toggled = 0;
+    for (int i = 0; i < sched->count; i++) {
+        hwblink_channel_t *ch = &sched->channels[i];
+        if (elapsed < ch->remaining) {
+            ch->remaining -= elapsed;
+            continue;
+        }
+        uint32_t bit = 1u << ch->pin;
+        if (ch->cursor.pattern == NULL) {
+            toggle |= bit;
+            ch->remaining = ch->period;
+            toggled++;
+            continue;
+        }
+        // Bước tiếp theo của mẫu, đọc thẳng từ bảng trong flash
+        uint32_t step;
+        bool on = false;
+        if (led_pattern_cursor_next(&ch->cursor, &step)) {
+            on = led_pattern_step_level(step);
+            ch->remaining = hwblink_step_ticks(step);
+        } else {
+            // Mẫu hữu hạn đã hết: tắt LED, kênh cuối chuyển vào chỗ trống và
+            // được xét ở lượt tiếp theo
+            sched->channels[i--] = sched->channels[--sched->count];
+        }
+        if (on != ((sched->levels & bit) != 0)) {
+            toggle |= bit;
+            toggled++;
+        }
+    }
+    sched->levels ^= toggle;
+    *set = toggle & sched->levels;
+    *clear = toggle & ~sched->levels;
+    return toggled;
+}
+
+uint32_t IRAM hwblink_sched_next_load(const hwblink_sched_t *sched)
+{
+    uint32_t next = 0;
+    for (int i = 0; i < sched->count; i++) {
+        if (next == 0 || sched->channels[i].remaining < next) {
+            next = sched->channels[i].remaining;
+        }
+    }
+    return next > HWBLINK_MAX_LOAD ? HWBLINK_MAX_LOAD : next;
+}
+
+// Nạp lại FRC1 theo deadline sớm nhất, hoặc dừng timer khi không còn kênh nào
+static void IRAM hwblink_rearm(void)
+{
+    hwblink_loaded = hwblink_sched_next_load(&hwblink);
+    if (hwblink_loaded == 0) {
+        HW_TIMER_ENABLE(false);
+        return;
+    }
+    HW_TIMER_LOAD(hwblink_loaded);
+}
+
+void IRAM led_hwblink_interrupt_handler(void *arg)
+{
+    uint32_t set, clear;
+    int toggled = hwblink_sched_advance(&hwblink, hwblink_loaded, &set, &clear);
+    HW_OUT_SET(set);
+    HW_OUT_CLEAR(clear);
+    hwblink_stats.interrupts++;
+    hwblink_stats.toggles += toggled;
+    hwblink_rearm();
+}
+
+// Cập nhật lịch theo thời gian đã trôi qua trong chu kỳ timer hiện tại
+static void hwblink_catch_up(void)
+{
+    if (!HW_TIMER_RUNNING() || hwblink_loaded == 0) {
+        return;
+    }
+    uint32_t count = HW_TIMER_COUNT();
+    uint32_t elapsed = count < hwblink_loaded ? hwblink_loaded - count : 0;
+    uint32_t set, clear;
+    hwblink_stats.toggles += hwblink_sched_advance(&hwblink, elapsed, &set, &clear);
+    HW_OUT_SET(set);
+    HW_OUT_CLEAR(clear);
+}
+
+void led_hwblink_init(void)
+{
+    hwblink_sched_init(&hwblink);
+    memset(&hwblink_stats, 0, sizeof(hwblink_stats));
+    hwblink_loaded = 0;
+#ifndef FIRE_HOST_BUILD
+    HW_TIMER_ENABLE(false);
+    timer_set_divider(FRC1, TIMER_CLKDIV_256);
+    timer_set_reload(FRC1, false);
+    _xt_isr_attach(INUM_TIMER_FRC1, led_hwblink_interrupt_handler, NULL);
+#else
+    memset(&hwblink_mock_regs, 0, sizeof(hwblink_mock_regs));
+#endif
+}
+
+// Nạp lại FRC1 sau khi thêm kênh, chạy timer nếu nó đang dừng (ngắt FRC1 đang bị chặn)
+static void hwblink_started(bool was_running)
+{
+    hwblink_rearm();
+    if (!was_running && hwblink_loaded != 0) {
+        HW_TIMER_ENABLE(true);
+    }
+}
+
+bool led_hwblink_start(uint8_t pin, uint32_t interval_ms)
+{
+    uint32_t set = 0;
+    bool was_running;
+
+    HW_INT_MASK();
+    was_running = HW_TIMER_RUNNING();
+    hwblink_catch_up();
+    bool ok = hwblink_sched_start(&hwblink, pin, hwblink_ms_to_ticks(interval_ms), &set);
+    HW_OUT_SET(set);
+    hwblink_started(was_running);
+    HW_INT_UNMASK();
+    return ok;
+}
+
+bool led_hwblink_start_pattern(uint8_t pin, const led_pattern_t *pattern)
+{
+    uint32_t set = 0, clear = 0;
+    bool was_running;
+
+    HW_INT_MASK();
+    was_running = HW_TIMER_RUNNING();
+    hwblink_catch_up();
+    bool ok = hwblink_sched_start_pattern(&hwblink, pin, pattern, &set, &clear);
+    HW_OUT_SET(set);
+    HW_OUT_CLEAR(clear);
+    hwblink_started(was_running);
+    HW_INT_UNMASK();
+    return ok;
+}
+
+void led_hwblink_stop(uint8_t pin, bool level)
+{
+    HW_INT_MASK();
+    hwblink_catch_up();
+    if (hwblink_sched_stop(&hwblink, pin)) {
+        hwblink_rearm();
+    }
+    if (pin < 16) {
+        if (level) {
+            HW_OUT_SET(1u << pin);
+        } else {
+            HW_OUT_CLEAR(1u << pin);
+        }
+    }
+    HW_INT_UNMASK();
+}
+
+void led_hwblink_get_stats(hwblink_stats_t *stats)
+{
+    HW_INT_MASK();
+    *stats = hwblink_stats;
+    HW_INT_UNMASK();
+}
@@ -0,0 +1,177 @@
+#ifndef LED_HWBLINK_H
+#define LED_HWBLINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "led_pattern.h"
+
+// Số kênh nhấp nháy phần cứng tối đa
+#define HWBLINK_MAX_CHANNELS 8
+
+// FRC1 chạy từ clock APB 80 MHz chia 256 -> 312500 tick/s (3.2 us/tick)
+#define HWBLINK_TICKS_PER_SEC 312500
+
+// Giá trị load lớn nhất của FRC1 (23 bit, ~26.8 s)
+#define HWBLINK_MAX_LOAD 0x7fffff
+
+// Một kênh nhấp nháy: đảo trạng thái pin sau mỗi period tick, hoặc chạy một mẫu
+// One blink channel: the pin toggles every period ticks, or plays a pattern
+typedef struct {
+    uint32_t period;             // Toggle period in FRC1 ticks
+    uint32_t remaining;          // Ticks left until the next toggle or pattern step
+    led_pattern_cursor_t cursor; // Pattern playback, cursor.pattern is NULL for a plain blink
+    uint8_t pin;                 // GPIO number (0-15)
+} hwblink_channel_t;
+
+// Lịch nhấp nháy, được tính trong ISR của FRC1
+// Blink schedule, advanced from the FRC1 interrupt
+typedef struct {
+    hwblink_channel_t channels[HWBLINK_MAX_CHANNELS];
+    uint8_t count;   // Number of active channels
+    uint32_t levels; // Current output level of every blinking pin (bitmask)
+} hwblink_sched_t;
+
+// Thống kê của bộ nhấp nháy phần cứng
+typedef struct {
+    uint32_t interrupts; // FRC1 interrupts serviced
+    uint32_t toggles;    // Individual pin toggles performed by the ISR
+} hwblink_stats_t;
+
+/**
+ * @brief Converts a blink interval in milliseconds to FRC1 ticks
+ *
+ * @return Tick count, clamped to [1, HWBLINK_MAX_LOAD]
+ */
+uint32_t hwblink_ms_to_ticks(uint32_t interval_ms);
+
+/**
+ * @brief Initializes an empty schedule
+ */
+void hwblink_sched_init(hwblink_sched_t *sched);
+
+/**
+ * @brief Adds a channel or changes the period of an existing one
+ *
+ * The pin is switched on immediately (reported through @p set) and toggles
+ * every @p period ticks from now.
+ *
+ * @param sched Schedule
+ * @param pin GPIO number (0-15)
+ * @param period Toggle period in FRC1 ticks
+ * @param set Output: pins that must be driven high
+ * @return false if no channel is free or the pin is invalid
+ */
+bool hwblink_sched_start(hwblink_sched_t *sched, uint8_t pin, uint32_t period, uint32_t *set);
+
+/**
+ * @brief Adds a channel playing @p pattern, or switches an existing one to it
+ *
+ * The pin takes the level of the first step immediately. When a finite
+ * pattern ends the pin is switched off and the channel is freed.
+ *
+ * @param sched Schedule
+ * @param pin GPIO number (0-15)
+ * @param pattern Pattern that passes led_pattern_validate()
+ * @param set Output: pins that must be driven high
+ * @param clear Output: pins that must be driven low
+ * @return false if no channel is free or the pin is invalid
+ */
+bool hwblink_sched_start_pattern(hwblink_sched_t *sched, uint8_t pin, const led_pattern_t *pattern,
+                                 uint32_t *set, uint32_t *clear);
+
+/**
+ * @brief Removes the channel driving @p pin, if any
+ *
+ * @return true if a channel was removed
+ */
+bool hwblink_sched_stop(hwblink_sched_t *sched, uint8_t pin);
+
+/**
+ * @brief Advances the schedule by @p elapsed ticks
+ *
+ * Channels whose deadline has been reached toggle or move to their next
+ * pattern step; pins whose level changes are reported through @p set and
+ * @p clear as GPIO OUT_SET / OUT_CLEAR masks.
+ *
+ * @param sched Schedule
+ * @param elapsed Ticks since the previous call
+ * @param set Output: pins to drive high
+ * @param clear Output: pins to drive low
+ * @return Number of pins whose level changed
+ */
+int hwblink_sched_advance(hwblink_sched_t *sched, uint32_t elapsed, uint32_t *set, uint32_t *clear);
+
+/**
+ * @brief Returns the timer load for the next interrupt
+ *
+ * @return Ticks until the earliest channel deadline (capped at
+ *         HWBLINK_MAX_LOAD), or 0 when no channel is active
+ */
+uint32_t hwblink_sched_next_load(const hwblink_sched_t *sched);
+
+/**
+ * @brief Initializes the hardware blink engine and attaches the FRC1 interrupt
+ *
+ * @note FRC1 is used exclusively by this engine; do not combine with
+ *       extras/pwm or extras/multipwm.
+ */
+void led_hwblink_init(void);
+
+/**
+ * @brief Starts blinking a pin in hardware
+ *
+ * Once armed, the pin is toggled from the FRC1 interrupt without any task
+ * wakeups until led_hwblink_stop() is called.
+ *
+ * @param pin GPIO number (0-15), must be configured as output
+ * @param interval_ms Toggle interval in milliseconds
+ * @return false if no channel is free
+ */
+bool led_hwblink_start(uint8_t pin, uint32_t interval_ms);
+
+/**
+ * @brief Starts playing a pattern on a pin in hardware
+ *
+ * Every step is timed by the FRC1 interrupt straight from the pattern table,
+ * without task wakeups. A finite pattern leaves the pin off when it ends.
+ *
+ * @param pin GPIO number (0-15), must be configured as output
+ * @param pattern Pattern, may be shared with other pins
+ * @return false if no channel is free
+ */
+bool led_hwblink_start_pattern(uint8_t pin, const led_pattern_t *pattern);
+
+/**
+ * @brief Stops blinking a pin and drives it to a fixed level
+ *
+ * @param pin GPIO number (0-15)
+ * @param level Level to leave the pin at
+ */
+void led_hwblink_stop(uint8_t pin, bool level);
+
+/**
+ * @brief Reads the interrupt and toggle counters
+ */
+void led_hwblink_get_stats(hwblink_stats_t *stats);
+
+/**
+ * @brief FRC1 interrupt handler (exposed for the host register mock)
+ */
+void led_hwblink_interrupt_handler(void *arg);
+
+#ifdef FIRE_HOST_BUILD
+// Mô phỏng các thanh ghi GPIO/FRC1 để kiểm thử trên host
+// Register-level mock of GPIO OUT and FRC1 used by host tests
+typedef struct {
+    uint32_t out;          // GPIO output register
+    uint32_t load;         // Last value written to FRC1 LOAD
+    uint32_t count;        // FRC1 COUNT, counts down to 0
+    bool running;          // FRC1 run bit
+    bool int_enabled;      // FRC1 interrupt enabled
+    uint32_t load_writes;  // Number of LOAD writes
+} hwblink_mock_regs_t;
+
+extern hwblink_mock_regs_t hwblink_mock_regs;
+#endif
+
+#endif
@@ -3,13 +3,25 @@
 #include "esp/uart.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
 #include "esp8266.h"
 #include "led_manager.h"
+#include "led_sched.h"
+#include "led_hwblink.h"
+#include "fire_clock.h"
+#include "fire_trace.h"
+#include "fire_rtos.h"
+#include "fire_power.h"
+#include "fire_health.h"
 
 // Định nghĩa macro DEBUG (1 = bật debug, 0 = tắt debug)
 #define DEBUG 1
 
+// Nhấp nháy bằng timer phần cứng FRC1 (1) hoặc bằng task (0)
+#define LED_HW_BLINK 1
+// Task thức dậy ít nhất mỗi LED_HEALTH_BEAT_MS để báo còn sống (fire_health.h)
+#define LED_HEALTH_BEAT_MS  1000
+#define LED_HEALTH_LIMIT_MS 3000
+
 static led_info_t leds[] = {
     {LED_BLUE,  LED_OFF, 500, 0, BLUE},
     {LED_SIM,   LED_OFF, 500, 0, SIM},
@@ -18,76 +30,256 @@ static led_info_t leds[] = {
 };
 #define NUM_LEDS (sizeof(leds) / sizeof(leds[0]))
 
-static QueueHandle_t led_command_queue;
+// Ô thư "mới nhất thắng" của mỗi LED (chỉ số là led_name_t): trạng thái ở 2 bit
+// thấp, chu kỳ nhấp nháy (ms) ở các bit còn lại. Lệnh mới ghi đè lệnh chưa xử
+// lý, rồi bật bit thông báo BIT(led_name) của led_manager_task.
+#define LED_MAILBOX_STATE_MASK     0x3
+#define LED_MAILBOX_INTERVAL_SHIFT 2
+#define LED_MAILBOX_INTERVAL_MAX   (UINT32_MAX >> LED_MAILBOX_INTERVAL_SHIFT)
+
+static volatile uint32_t led_mailbox[NUM_LEDS];
+static TaskHandle_t led_task_handle;
+FIRE_TASK_STORAGE(led_manager_task, 768);
+
+// Min-heap các deadline nhấp nháy và histogram độ trễ đảo trạng thái
+static led_sched_t led_sched;
+static led_sched_hist_t led_timing;
+
+// Chuyển chu kỳ nhấp nháy (ms) sang tick, tối thiểu 1 tick
+static TickType_t blink_period_ticks(uint32_t interval_ms)
+{
+    TickType_t ticks = interval_ms / portTICK_PERIOD_MS;
+    return ticks ? ticks : 1;
+}
+
+// Xuất mức của bước hiện tại và hẹn bước tiếp theo (mẫu do task tự định thời)
+static void pattern_step(led_info_t *led, uint8_t id, uint32_t step, TickType_t deadline)
+{
+    gpio_write(led->pin, led_pattern_step_level(step));
+    led->next_toggle = deadline + blink_period_ticks(led_pattern_step_ms(step));
+    led_sched_set(&led_sched, id, led->next_toggle);
+}
+
+// Điểm đo OUTPUT: LED báo cháy vừa được bật
+static void trace_output(const led_info_t *led)
+{
+    if (led->name == FIRE) {
+        fire_trace_point(FIRE_TRACE_OUTPUT, fire_clock_cycles());
+    }
+}
+
+static void apply_command(const led_command_t *cmd)
+{
+    for (int i = 0; i < NUM_LEDS; i++) {
+        if (leds[i].name == cmd->led_name) {
+            leds[i].state = cmd->state;
+            leds[i].interval_ms = cmd->interval_ms;
+            led_sched_remove(&led_sched, i);
+            if (cmd->state == LED_BLINK) {
+#if LED_HW_BLINK
+                // Timer phần cứng đảo LED, task không cần thức dậy
+                if (led_hwblink_start(leds[i].pin, cmd->interval_ms)) {
+                    trace_output(&leds[i]);
+                    break;
+                }
+#endif
+                leds[i].next_toggle = xTaskGetTickCount() + blink_period_ticks(cmd->interval_ms);
+                led_sched_set(&led_sched, i, leds[i].next_toggle);
+            } else if (cmd->state == LED_PATTERN) {
+                const led_pattern_t *pattern = led_pattern_get(cmd->interval_ms);
+                bool started = false;
+#if LED_HW_BLINK
+                // Các bước do ISR của FRC1 chạy, đọc thẳng từ bảng trong flash
+                started = led_hwblink_start_pattern(leds[i].pin, pattern);
+#endif
+                uint32_t step = led_pattern_cursor_start(&leds[i].pattern, pattern);
+                if (!started) {
+                    pattern_step(&leds[i], i, step, xTaskGetTickCount());
+                }
+                if (led_pattern_step_level(step)) {
+                    trace_output(&leds[i]);
+                }
+            } else {
+#if LED_HW_BLINK
+                led_hwblink_stop(leds[i].pin, cmd->state == LED_ON);
+#endif
+                gpio_write(leds[i].pin, cmd->state == LED_ON);
+                if (cmd->state == LED_ON) {
+                    trace_output(&leds[i]);
+                }
+            }
+            break;
+        }
+    }
+}
+
+// Đọc các ô thư có bit trong pending thành một batch nhất quán rồi áp dụng
+static void apply_mailbox(uint32_t pending)
+{
+    led_command_t cmds[NUM_LEDS];
+    int count = 0;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < NUM_LEDS; i++) {
+        if (pending & BIT(i)) {
+            uint32_t word = led_mailbox[i];
+            cmds[count].led_name = i;
+            cmds[count].state = word & LED_MAILBOX_STATE_MASK;
+            cmds[count].interval_ms = word >> LED_MAILBOX_INTERVAL_SHIFT;
+            count++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (int i = 0; i < count; i++) {
+        apply_command(&cmds[i]);
+    }
+    // FRC1 dừng trong light sleep: giữ chip ở modem sleep khi có LED nhấp nháy
+    bool blinking = false;
+    for (int i = 0; i < NUM_LEDS; i++) {
+        blinking |= leds[i].state == LED_BLINK || leds[i].state == LED_PATTERN;
+    }
+    fire_power_hold(FIRE_POWER_HOLD_LED, blinking);
+}
 
 static void led_manager_task(void *pvParameters)
 {
-    led_command_t cmd;
+    int health = fire_health_register_task("led_manager", LED_HEALTH_LIMIT_MS);
 
     for (int i = 0; i < NUM_LEDS; i++) {
         gpio_enable(leds[i].pin, GPIO_OUTPUT);
         gpio_write(leds[i].pin, 0);
     }
+    // Lệnh được ghi trước khi task chạy (chưa có ai để thông báo)
+    apply_mailbox(BIT(NUM_LEDS) - 1);
 
     while (1) {
-        if (xQueueReceive(led_command_queue, &cmd, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-            for (int i = 0; i < NUM_LEDS; i++) {
-                if (leds[i].name == cmd.led_name) {
-                    leds[i].state = cmd.state;
-                    leds[i].interval_ms = cmd.interval_ms;
-                    leds[i].last_toggle = xTaskGetTickCount();
-                    if (cmd.state == LED_ON) {
-                        gpio_write(leds[i].pin, 1);
-                    } else if (cmd.state == LED_OFF) {
-                        gpio_write(leds[i].pin, 0);
-                    }
-                    break;
-                }
-            }
+        fire_health_beat(health);
+        // Chỉ thức dậy đúng deadline sớm nhất, khi có lệnh mới, hoặc cho heartbeat
+        uint32_t wait;
+        if (!led_sched_wait_ticks(&led_sched, xTaskGetTickCount(), &wait) ||
+            wait > pdMS_TO_TICKS(LED_HEALTH_BEAT_MS)) {
+            wait = pdMS_TO_TICKS(LED_HEALTH_BEAT_MS);
+        }
+        // Bit được xóa khi nhận; lệnh ghi sau đó bật lại bit cho lần sau
+        uint32_t pending;
+        if (xTaskNotifyWait(0, UINT32_MAX, &pending, wait) == pdTRUE) {
+            apply_mailbox(pending);
         }
 
         TickType_t current_ticks = xTaskGetTickCount();
-        for (int i = 0; i < NUM_LEDS; i++) {
-            if (leds[i].state == LED_BLINK) {
-                if ((current_ticks - leds[i].last_toggle) * portTICK_PERIOD_MS >= leds[i].interval_ms) {
-                    gpio_write(leds[i].pin, !gpio_read(leds[i].pin));
-                    leds[i].last_toggle = current_ticks;
+        uint8_t i;
+        uint32_t deadline;
+        while (led_sched_pop_due(&led_sched, current_ticks, &i, &deadline)) {
+            led_sched_hist_record(&led_timing, current_ticks - deadline);
+            if (leds[i].state == LED_PATTERN) {
+                uint32_t step;
+                if (led_pattern_cursor_next(&leds[i].pattern, &step)) {
+                    pattern_step(&leds[i], i, step, deadline);
+                } else {
+                    gpio_write(leds[i].pin, 0);
                 }
+                continue;
+            }
+            bool on = !gpio_read(leds[i].pin);
+            gpio_write(leds[i].pin, on);
+            if (on) {
+                trace_output(&leds[i]);
             }
+            leds[i].next_toggle = led_sched_next_deadline(deadline, blink_period_ticks(leds[i].interval_ms), current_ticks);
+            led_sched_set(&led_sched, i, leds[i].next_toggle);
         }
+    }
+}
 
-#ifdef DEBUG
-        UBaseType_t stack_high_water_mark = uxTaskGetStackHighWaterMark(NULL);
-        if (stack_high_water_mark < 50) {
-            printf("Warning: LED task stack low: %lu words\n", stack_high_water_mark);
+// Ghi các lệnh vào ô thư; trả về các bit thông báo cần bật (0 nếu không có lệnh hợp lệ)
+static uint32_t post_commands(const led_command_t *cmds, size_t count)
+{
+    uint32_t bits = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const led_command_t *cmd = &cmds[i];
+        if (cmd->led_name < BLUE || cmd->led_name > FIRE || cmd->state > LED_PATTERN) {
+            continue;
         }
-#endif
+        if (cmd->state == LED_PATTERN && led_pattern_get(cmd->interval_ms) == NULL) {
+            continue;
+        }
+        uint32_t interval_ms = cmd->interval_ms;
+        if (cmd->state == LED_BLINK && interval_ms == 0) {
+            interval_ms = 500;
+        }
+        if (interval_ms > LED_MAILBOX_INTERVAL_MAX) {
+            interval_ms = LED_MAILBOX_INTERVAL_MAX;
+        }
+        led_mailbox[cmd->led_name] = cmd->state | interval_ms << LED_MAILBOX_INTERVAL_SHIFT;
+        bits |= BIT(cmd->led_name);
     }
+    return bits;
 }
 
-void set_led_state(led_name_t led_name, led_state_t state, uint32_t interval_ms)
+void set_led_states(const led_command_t *cmds, size_t count)
 {
-    if (led_command_queue == NULL || led_name < BLUE || led_name > FIRE) {
+    taskENTER_CRITICAL();
+    uint32_t bits = post_commands(cmds, count);
+    taskEXIT_CRITICAL();
+
+    if (bits == 0) {
 #ifdef DEBUG
-        printf("Invalid LED command: queue=%p, led_name=%d\n", led_command_queue, led_name);
+        printf("Invalid LED command: %u commands, none valid\n", (unsigned)count);
 #endif
         return;
     }
-    if (state == LED_BLINK && interval_ms == 0) {
-        interval_ms = 500;
+    for (size_t i = 0; i < count; i++) {
+        if (cmds[i].led_name == FIRE && cmds[i].state != LED_OFF) {
+            fire_trace_point(FIRE_TRACE_COMMAND, fire_clock_cycles());
+        }
     }
+    if (led_task_handle != NULL) {
+        xTaskNotify(led_task_handle, bits, eSetBits);
+    }
+}
+
+void set_led_state(led_name_t led_name, led_state_t state, uint32_t interval_ms)
+{
     led_command_t cmd = {
         .led_name = led_name,
         .state = state,
         .interval_ms = interval_ms
     };
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    BaseType_t result = xQueueSendFromISR(led_command_queue, &cmd, &xHigherPriorityTaskWoken);
-#ifdef DEBUG
-    if (result != pdTRUE) {
-        printf("Failed to send LED command to queue\n");
+    set_led_states(&cmd, 1);
+}
+
+void set_led_pattern(led_name_t led_name, led_pattern_id_t pattern)
+{
+    set_led_state(led_name, LED_PATTERN, pattern);
+}
+
+void set_led_states_from_isr(const led_command_t *cmds, size_t count, BaseType_t *xHigherPriorityTaskWoken)
+{
+    // Task không thể chen vào giữa ISR nên không cần vùng găng
+    uint32_t bits = post_commands(cmds, count);
+    if (bits != 0 && led_task_handle != NULL) {
+        xTaskNotifyFromISR(led_task_handle, bits, eSetBits, xHigherPriorityTaskWoken);
     }
-#endif
+}
+
+void set_led_state_from_isr(led_name_t led_name, led_state_t state, uint32_t interval_ms,
+                            BaseType_t *xHigherPriorityTaskWoken)
+{
+    led_command_t cmd = {
+        .led_name = led_name,
+        .state = state,
+        .interval_ms = interval_ms
+    };
+    set_led_states_from_isr(&cmd, 1, xHigherPriorityTaskWoken);
+}
+
+void led_manager_get_timing_stats(led_sched_hist_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = led_timing;
+    taskEXIT_CRITICAL();
 }
 
 void led_manager_init(void)
@@ -96,13 +288,14 @@ void led_manager_init(void)
     printf("Initializing LED Manager, free heap: %u bytes\n", xPortGetFreeHeapSize());
 #endif
 
-    led_command_queue = xQueueCreate(3, sizeof(led_command_t));
-    if (led_command_queue == NULL) {
+    led_sched_init(&led_sched);
+#if LED_HW_BLINK
+    led_hwblink_init();
+#endif
+
+    if (FIRE_TASK_CREATE(led_manager_task, led_manager_task, NULL, 2, &led_task_handle) != pdPASS) {
 #ifdef DEBUG
-        printf("Failed to create LED command queue\n");
+        printf("Failed to create LED manager task\n");
 #endif
-        return;
     }
-
-    xTaskCreate(led_manager_task, "led_manager_task", 768, NULL, 2, NULL);
 }
\ No newline at end of file
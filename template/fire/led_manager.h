@@ -1,8 +1,11 @@
 #ifndef LED_MANAGER_H
 #define LED_MANAGER_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include "FreeRTOS.h" // Required for TickType_t
+#include "led_sched.h"
+#include "led_pattern.h"
 
 // Định nghĩa GPIO cho LED
 #define LED_BLUE  2   // GPIO pin for blue LED
@@ -14,7 +17,8 @@
 typedef enum {
     LED_OFF,   // LED is turned off
     LED_BLINK,  // LED is in blinking mode with configurable interval
-    LED_ON    // LED is turned on
+    LED_ON,    // LED is turned on
+    LED_PATTERN // LED plays a built-in pattern (led_pattern_id_t)
 } led_state_t;
 
 // Enum tên LED
@@ -32,25 +36,26 @@ typedef struct {
     uint8_t pin;          // GPIO pin number assigned to the LED
     led_state_t state;    // Current state of the LED (OFF, ON, or BLINK)
     uint32_t interval_ms; // Blinking interval in milliseconds (used when state is LED_BLINK)
-    TickType_t last_toggle; // Last tick count when the LED was toggled (for blinking timing)
+    TickType_t next_toggle; // Tick count of the next scheduled toggle (for blinking timing)
     led_name_t name;      // Name of the LED for identification
+    led_pattern_cursor_t pattern; // Pattern playback when the task times the steps itself
 } led_info_t;
 
-// Cấu trúc lệnh gửi qua queue
-// Represents a command to change the state of an LED, sent via FreeRTOS queue
+// Cấu trúc lệnh LED, dùng cho set_led_states()
+// Represents a command to change the state of an LED
 typedef struct {
     led_name_t led_name;  // Name of the LED (BLUE, SIM, FAULT, FIRE)
     led_state_t state;    // Desired state for the LED (OFF, ON, or BLINK)
-    uint32_t interval_ms; // Blinking interval in milliseconds (used when state is LED_BLINK)
+    uint32_t interval_ms; // Blinking interval in milliseconds (LED_BLINK), or led_pattern_id_t (LED_PATTERN)
 } led_command_t;
 
 /**
  * @brief Initializes the LED manager
  * 
- * This function sets up the LED management system by creating a FreeRTOS queue
- * for LED commands and starting a task to handle LED state updates. It must be
- * called before using any other LED manager functions. The function configures
- * the GPIO pins for all LEDs and starts the LED manager task with a priority of 2.
+ * This function sets up the LED management system and starts a task to handle
+ * LED state updates. Commands written before it runs are kept in the mailbox
+ * and applied when the task starts. The task configures the GPIO pins for all
+ * LEDs and runs with a priority of 2.
  * 
  * @note This function should be called once during system initialization.
  */
@@ -59,18 +64,73 @@ void led_manager_init(void);
 /**
  * @brief Sets the state of a specific LED
  * 
- * This function sends a command to the LED manager task via a FreeRTOS queue to
- * change the state of a specified LED. The command includes the LED name, desired
- * state, and blinking interval (if applicable).
+ * This function writes the command into the LED's mailbox slot and sets the
+ * LED's notification bit of the LED manager task. Each LED keeps only its
+ * latest command: a command that has not been applied yet is replaced, so the
+ * call never blocks or fails and a burst always ends in the last state.
  * 
  * @param led_name The name of the LED to control (BLUE, SIM, FAULT, FIRE)
  * @param state The desired state for the LED (LED_OFF, LED_ON, or LED_BLINK)
  * @param interval_ms The blinking interval in milliseconds (used only when state is LED_BLINK)
  * 
- * @note The function is thread-safe and can be called from any task. The command
- *       is queued and processed asynchronously by the LED manager task.
+ * @note Call from task context only; interrupt handlers use set_led_state_from_isr().
  * @note If led_name is invalid, the command is ignored.
  */
 void set_led_state(led_name_t led_name, led_state_t state, uint32_t interval_ms);
 
+/**
+ * @brief Plays a built-in signalling pattern on an LED
+ * 
+ * The pattern table stays in flash and is shared by every LED playing it.
+ * With hardware blinking the steps are timed by the FRC1 interrupt, so a
+ * running pattern causes no task wakeups. A finite pattern leaves the LED
+ * off when it ends. Any later command for the LED replaces the pattern.
+ * 
+ * @param led_name The name of the LED to control (BLUE, SIM, FAULT, FIRE)
+ * @param pattern Pattern to play
+ * 
+ * @note Call from task context only. Same as set_led_state(led_name, LED_PATTERN, pattern).
+ * @note If led_name or pattern is invalid, the command is ignored.
+ */
+void set_led_pattern(led_name_t led_name, led_pattern_id_t pattern);
+
+/**
+ * @brief Sets the state of several LEDs at once
+ * 
+ * All commands are written inside one critical section and signalled with a
+ * single notification, so the LED manager task applies them together in one
+ * wakeup and never shows a mix of old and new states.
+ * 
+ * @param cmds Commands; a later command for the same LED wins
+ * @param count Number of commands
+ * 
+ * @note Call from task context only.
+ */
+void set_led_states(const led_command_t *cmds, size_t count);
+
+/**
+ * @brief Interrupt-safe variant of set_led_state()
+ * 
+ * @param xHigherPriorityTaskWoken Set to pdTRUE if the LED manager task should
+ *        run before the interrupted task; pass it to portEND_SWITCHING_ISR()
+ */
+void set_led_state_from_isr(led_name_t led_name, led_state_t state, uint32_t interval_ms,
+                            BaseType_t *xHigherPriorityTaskWoken);
+
+/**
+ * @brief Interrupt-safe variant of set_led_states()
+ */
+void set_led_states_from_isr(const led_command_t *cmds, size_t count, BaseType_t *xHigherPriorityTaskWoken);
+
+/**
+ * @brief Reads the blink timing histogram of the LED manager
+ * 
+ * Every blink toggle records how many ticks it happened after its scheduled
+ * deadline. The histogram shows the jitter introduced by task scheduling and
+ * command processing.
+ * 
+ * @param stats Output: copy of the current histogram
+ */
+void led_manager_get_timing_stats(led_sched_hist_t *stats);
+
 #endif
\ No newline at end of file
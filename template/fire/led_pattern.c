@@ -0,0 +1,95 @@
+#include <stddef.h>
+#include "led_pattern.h"
+
+#ifdef FIRE_HOST_BUILD
+#define IRAM
+#define IROM const
+#else
+#include "common_macros.h"
+#endif
+
+// Temporal-3 (ISO 8201): 3 lần sáng 0.5 s cách 0.5 s, nghỉ 1.5 s
+static IROM uint32_t temporal3_steps[] = {
+    LED_STEP(1, 500), LED_STEP(0, 500),
+    LED_STEP(1, 500), LED_STEP(0, 500),
+    LED_STEP(1, 500), LED_STEP(0, 1500),
+};
+
+// SOS: chấm 200 ms, gạch 600 ms, cách giữa các chữ 600 ms, nghỉ cuối 1.4 s
+static IROM uint32_t sos_steps[] = {
+    LED_STEP(1, 200), LED_STEP(0, 200), LED_STEP(1, 200), LED_STEP(0, 200),
+    LED_STEP(1, 200), LED_STEP(0, 600),
+    LED_STEP(1, 600), LED_STEP(0, 200), LED_STEP(1, 600), LED_STEP(0, 200),
+    LED_STEP(1, 600), LED_STEP(0, 600),
+    LED_STEP(1, 200), LED_STEP(0, 200), LED_STEP(1, 200), LED_STEP(0, 200),
+    LED_STEP(1, 200), LED_STEP(0, 1400),
+};
+
+// Báo lỗi: chớp ngắn mỗi 10 s
+static IROM uint32_t fault_chirp_steps[] = {
+    LED_STEP(1, 100), LED_STEP(0, 9900),
+};
+
+#define PATTERN(steps, repeat) { steps, sizeof(steps) / sizeof(steps[0]), repeat }
+
+static IROM led_pattern_t led_patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_TEMPORAL3] = PATTERN(temporal3_steps, 0),
+    [LED_PATTERN_SOS] = PATTERN(sos_steps, 0),
+    [LED_PATTERN_FAULT_CHIRP] = PATTERN(fault_chirp_steps, 0),
+};
+
+const led_pattern_t *led_pattern_get(uint32_t id)
+{
+    return id < LED_PATTERN_COUNT ? &led_patterns[id] : NULL;
+}
+
+led_pattern_error_t led_pattern_validate(const led_pattern_t *pattern)
+{
+    if (pattern->steps == NULL || pattern->count == 0) {
+        return LED_PATTERN_ERR_EMPTY;
+    }
+    if (pattern->count > LED_PATTERN_MAX_STEPS) {
+        return LED_PATTERN_ERR_TOO_MANY;
+    }
+    for (uint32_t i = 0; i < pattern->count; i++) {
+        uint32_t ms = led_pattern_step_ms(pattern->steps[i]);
+        if (ms == 0) {
+            return LED_PATTERN_ERR_ZERO_STEP;
+        }
+        if (ms > LED_PATTERN_STEP_MAX_MS) {
+            return LED_PATTERN_ERR_STEP_TOO_LONG;
+        }
+    }
+    return LED_PATTERN_OK;
+}
+
+uint32_t led_pattern_cycle_ms(const led_pattern_t *pattern)
+{
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < pattern->count; i++) {
+        total += led_pattern_step_ms(pattern->steps[i]);
+    }
+    return total;
+}
+
+uint32_t led_pattern_cursor_start(led_pattern_cursor_t *cursor, const led_pattern_t *pattern)
+{
+    cursor->pattern = pattern;
+    cursor->step = 0;
+    cursor->cycles = pattern->repeat;
+    return pattern->steps[0];
+}
+
+bool IRAM led_pattern_cursor_next(led_pattern_cursor_t *cursor, uint32_t *step)
+{
+    const led_pattern_t *pattern = cursor->pattern;
+    if (++cursor->step >= pattern->count) {
+        cursor->step = 0;
+        if (cursor->cycles != 0 && --cursor->cycles == 0) {
+            cursor->pattern = NULL;
+            return false;
+        }
+    }
+    *step = pattern->steps[cursor->step];
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Một bước của mẫu là một word 32 bit: mức LED ở bit 31, thời gian (ms) ở các
+// bit thấp. Bảng nằm trong flash (IROM), chỉ đọc được theo word 32 bit.
+#define LED_PATTERN_LEVEL 0x80000000u
+#define LED_STEP(level, ms) ((level) ? LED_PATTERN_LEVEL | (uint32_t)(ms) : (uint32_t)(ms))
+
+// Giới hạn kiểm tra bởi led_pattern_validate(): một bước phải vừa một lần nạp
+// FRC1 (~26.8 s)
+#define LED_PATTERN_MAX_STEPS   64
+#define LED_PATTERN_STEP_MAX_MS 26000
+
+// Một mẫu tín hiệu: bảng bước dùng chung cho mọi LED chạy mẫu này
+// A signalling pattern; the step table is shared by every LED running it
+typedef struct {
+    const uint32_t *steps; // LED_STEP() entries, in flash
+    uint32_t count;        // Number of steps
+    uint32_t repeat;       // Cycles to play before the LED stays off, 0 = forever
+} led_pattern_t;
+
+// Các mẫu có sẵn, chọn bằng set_led_pattern()
+// Built-in patterns
+typedef enum {
+    LED_PATTERN_TEMPORAL3,   // Evacuation code: three 0.5 s flashes, 1.5 s pause
+    LED_PATTERN_SOS,         // ... --- ... with 200 ms dots
+    LED_PATTERN_FAULT_CHIRP, // 100 ms flash every 10 s
+    LED_PATTERN_COUNT
+} led_pattern_id_t;
+
+typedef enum {
+    LED_PATTERN_OK,
+    LED_PATTERN_ERR_EMPTY,         // No steps
+    LED_PATTERN_ERR_TOO_MANY,      // More than LED_PATTERN_MAX_STEPS steps
+    LED_PATTERN_ERR_ZERO_STEP,     // A step lasts 0 ms
+    LED_PATTERN_ERR_STEP_TOO_LONG, // A step lasts more than LED_PATTERN_STEP_MAX_MS
+} led_pattern_error_t;
+
+// Vị trí đang chạy trong một mẫu
+// Playback position in a pattern
+typedef struct {
+    const led_pattern_t *pattern; // NULL once a finite pattern has finished
+    uint32_t step;                // Index of the current step
+    uint32_t cycles;              // Cycles left including the current one, 0 = forever
+} led_pattern_cursor_t;
+
+static inline bool led_pattern_step_level(uint32_t step)
+{
+    return (step & LED_PATTERN_LEVEL) != 0;
+}
+
+static inline uint32_t led_pattern_step_ms(uint32_t step)
+{
+    return step & ~LED_PATTERN_LEVEL;
+}
+
+/**
+ * @brief Returns a built-in pattern
+ *
+ * @return Pattern, NULL if @p id is not a led_pattern_id_t
+ */
+const led_pattern_t *led_pattern_get(uint32_t id);
+
+/**
+ * @brief Checks that a pattern can be played by the LED engines
+ *
+ * Host tests run it over every built-in pattern, so the firmware only checks
+ * the pattern id at runtime.
+ */
+led_pattern_error_t led_pattern_validate(const led_pattern_t *pattern);
+
+/**
+ * @brief Duration of one cycle of a pattern in milliseconds
+ */
+uint32_t led_pattern_cycle_ms(const led_pattern_t *pattern);
+
+/**
+ * @brief Starts playing a pattern from its first step
+ *
+ * @return The first step
+ */
+uint32_t led_pattern_cursor_start(led_pattern_cursor_t *cursor, const led_pattern_t *pattern);
+
+/**
+ * @brief Moves to the next step, wrapping around at the end of a cycle
+ *
+ * @param cursor Cursor of a running pattern
+ * @param step Output: the new current step
+ * @return false when the last cycle of a finite pattern has ended
+ * @note Lives in IRAM, the FRC1 interrupt calls it.
+ */
+bool led_pattern_cursor_next(led_pattern_cursor_t *cursor, uint32_t *step);
+
+#endif
@@ -0,0 +1,163 @@
+#include <string.h>
+#include "led_sched.h"
+
+// So sánh tick an toàn khi bộ đếm tràn
+static inline bool tick_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static void heap_swap(led_sched_t *sched, uint8_t i, uint8_t j)
+{
+    led_sched_entry_t tmp = sched->heap[i];
+    sched->heap[i] = sched->heap[j];
+    sched->heap[j] = tmp;
+    sched->pos[sched->heap[i].id] = i;
+    sched->pos[sched->heap[j].id] = j;
+}
+
+static void sift_up(led_sched_t *sched, uint8_t i)
+{
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!tick_before(sched->heap[i].deadline, sched->heap[parent].deadline)) {
+            break;
+        }
+        heap_swap(sched, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(led_sched_t *sched, uint8_t i)
+{
+    while (1) {
+        uint8_t smallest = i;
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        if (left < sched->count &&
+            tick_before(sched->heap[left].deadline, sched->heap[smallest].deadline)) {
+            smallest = left;
+        }
+        if (right < sched->count &&
+            tick_before(sched->heap[right].deadline, sched->heap[smallest].deadline)) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        heap_swap(sched, i, smallest);
+        i = smallest;
+    }
+}
+
+void led_sched_init(led_sched_t *sched)
+{
+    sched->count = 0;
+    memset(sched->pos, LED_SCHED_NONE, sizeof(sched->pos));
+}
+
+void led_sched_set(led_sched_t *sched, uint8_t id, uint32_t deadline)
+{
+    if (id >= LED_SCHED_MAX_ENTRIES) {
+        return;
+    }
+    uint8_t i = sched->pos[id];
+    if (i == LED_SCHED_NONE) {
+        i = sched->count++;
+        sched->heap[i].id = id;
+        sched->heap[i].deadline = deadline;
+        sched->pos[id] = i;
+        sift_up(sched, i);
+        return;
+    }
+    uint32_t old = sched->heap[i].deadline;
+    sched->heap[i].deadline = deadline;
+    if (tick_before(deadline, old)) {
+        sift_up(sched, i);
+    } else {
+        sift_down(sched, i);
+    }
+}
+
+void led_sched_remove(led_sched_t *sched, uint8_t id)
+{
+    if (id >= LED_SCHED_MAX_ENTRIES || sched->pos[id] == LED_SCHED_NONE) {
+        return;
+    }
+    uint8_t i = sched->pos[id];
+    uint8_t last = --sched->count;
+    sched->pos[id] = LED_SCHED_NONE;
+    if (i == last) {
+        return;
+    }
+    uint8_t moved = sched->heap[last].id;
+    sched->heap[i] = sched->heap[last];
+    sched->pos[moved] = i;
+    // Phần tử thay thế có thể cần đi lên hoặc đi xuống
+    sift_up(sched, i);
+    sift_down(sched, sched->pos[moved]);
+}
+
+bool led_sched_peek(const led_sched_t *sched, uint8_t *id, uint32_t *deadline)
+{
+    if (sched->count == 0) {
+        return false;
+    }
+    if (id) {
+        *id = sched->heap[0].id;
+    }
+    if (deadline) {
+        *deadline = sched->heap[0].deadline;
+    }
+    return true;
+}
+
+bool led_sched_wait_ticks(const led_sched_t *sched, uint32_t now, uint32_t *wait)
+{
+    uint32_t deadline;
+    if (!led_sched_peek(sched, NULL, &deadline)) {
+        return false;
+    }
+    *wait = tick_before(now, deadline) ? deadline - now : 0;
+    return true;
+}
+
+bool led_sched_pop_due(led_sched_t *sched, uint32_t now, uint8_t *id, uint32_t *deadline)
+{
+    uint8_t first_id;
+    uint32_t first_deadline;
+    if (!led_sched_peek(sched, &first_id, &first_deadline) || tick_before(now, first_deadline)) {
+        return false;
+    }
+    led_sched_remove(sched, first_id);
+    *id = first_id;
+    *deadline = first_deadline;
+    return true;
+}
+
+uint32_t led_sched_next_deadline(uint32_t deadline, uint32_t period, uint32_t now)
+{
+    if (period == 0) {
+        period = 1;
+    }
+    uint32_t next = deadline + period;
+    if (!tick_before(now, next)) {
+        next = now + period;
+    }
+    return next;
+}
+
+void led_sched_hist_record(led_sched_hist_t *hist, uint32_t late_ticks)
+{
+    uint8_t bucket = 0;
+    uint32_t v = late_ticks;
+    while (v && bucket < LED_SCHED_HIST_BUCKETS - 1) {
+        v >>= 1;
+        bucket++;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    if (late_ticks > hist->max) {
+        hist->max = late_ticks;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef LED_SCHED_H
+#define LED_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Số LED tối đa mà scheduler quản lý
+#define LED_SCHED_MAX_ENTRIES 8
+
+// Số bucket của histogram độ trễ (bucket i chứa độ trễ trong [2^(i-1), 2^i) tick)
+#define LED_SCHED_HIST_BUCKETS 8
+
+// Một mốc thời gian đảo trạng thái LED trong min-heap
+// One pending toggle deadline in the min-heap
+typedef struct {
+    uint32_t deadline; // Tick count at which the LED must toggle
+    uint8_t id;        // Index of the LED in the LED manager table
+} led_sched_entry_t;
+
+// Min-heap các deadline, sắp theo thời gian (so sánh an toàn khi tick tràn)
+// Min-heap of toggle deadlines, ordered with wrap-safe tick comparison
+typedef struct {
+    led_sched_entry_t heap[LED_SCHED_MAX_ENTRIES];
+    uint8_t pos[LED_SCHED_MAX_ENTRIES]; // Heap index of each id, or LED_SCHED_NONE
+    uint8_t count;                      // Number of entries in the heap
+} led_sched_t;
+
+#define LED_SCHED_NONE 0xff
+
+// Histogram độ trễ giữa deadline và thời điểm LED thực sự đảo trạng thái
+// Histogram of toggle lateness (actual tick - deadline tick)
+typedef struct {
+    uint32_t buckets[LED_SCHED_HIST_BUCKETS]; // 0, 1, 2-3, 4-7, ... ticks late
+    uint32_t count;                           // Number of recorded toggles
+    uint32_t max;                             // Worst lateness seen, in ticks
+} led_sched_hist_t;
+
+/**
+ * @brief Initializes an empty scheduler
+ */
+void led_sched_init(led_sched_t *sched);
+
+/**
+ * @brief Inserts a deadline for an LED, or moves its existing deadline
+ *
+ * @param sched Scheduler
+ * @param id LED index, must be below LED_SCHED_MAX_ENTRIES
+ * @param deadline Tick count at which the LED must toggle
+ */
+void led_sched_set(led_sched_t *sched, uint8_t id, uint32_t deadline);
+
+/**
+ * @brief Removes the pending deadline of an LED, if any
+ */
+void led_sched_remove(led_sched_t *sched, uint8_t id);
+
+/**
+ * @brief Returns the earliest deadline without removing it
+ *
+ * @return false if no deadline is scheduled
+ */
+bool led_sched_peek(const led_sched_t *sched, uint8_t *id, uint32_t *deadline);
+
+/**
+ * @brief Returns the number of ticks to block until the earliest deadline
+ *
+ * @param sched Scheduler
+ * @param now Current tick count
+ * @param wait Output: 0 if a deadline is already due, otherwise ticks to wait
+ * @return false if no deadline is scheduled (block indefinitely)
+ */
+bool led_sched_wait_ticks(const led_sched_t *sched, uint32_t now, uint32_t *wait);
+
+/**
+ * @brief Removes and returns the earliest deadline if it is due at @p now
+ *
+ * @return true if an entry was due and has been removed from the heap
+ */
+bool led_sched_pop_due(led_sched_t *sched, uint32_t now, uint8_t *id, uint32_t *deadline);
+
+/**
+ * @brief Computes the next periodic deadline without accumulating drift
+ *
+ * The next toggle is scheduled relative to the previous deadline, not to the
+ * time the toggle was serviced. If the caller fell a whole period behind the
+ * schedule restarts from @p now instead of toggling in a burst.
+ *
+ * @param deadline Deadline that has just been serviced
+ * @param period Toggle period in ticks (at least 1)
+ * @param now Current tick count
+ * @return Next deadline
+ */
+uint32_t led_sched_next_deadline(uint32_t deadline, uint32_t period, uint32_t now);
+
+/**
+ * @brief Records the lateness of one toggle into a histogram
+ *
+ * @param hist Histogram
+ * @param late_ticks Ticks between the deadline and the actual toggle
+ */
+void led_sched_hist_record(led_sched_hist_t *hist, uint32_t late_ticks);
+
+#endif
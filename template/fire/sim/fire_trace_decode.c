@@ -0,0 +1,114 @@
+// Giải mã bản dump độ trễ (fire_trace) trong log UART của thiết bị hoặc console
+// của bộ mô phỏng. Các dòng văn bản xung quanh được bỏ qua.
+//
+//   fire_trace_decode [-a] console.log
+//
+// Mặc định in bản dump hợp lệ cuối cùng; -a in mọi bản dump.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fire_trace.h"
+
+static const char *const stage_names[FIRE_TRACE_STAGES] = {
+    [FIRE_TRACE_STAGE_WAKE] = "isr_to_task",
+    [FIRE_TRACE_STAGE_DEBOUNCE] = "edge_to_alarm",
+    [FIRE_TRACE_STAGE_COMMAND] = "alarm_to_command",
+    [FIRE_TRACE_STAGE_OUTPUT] = "command_to_led",
+    [FIRE_TRACE_STAGE_TOTAL] = "edge_to_led",
+};
+
+static void print_dump(const fire_trace_dump_t *dump, size_t offset)
+{
+    printf("dump at byte %zu, cpu %u MHz\n", offset, dump->cpu_mhz);
+    printf("%-18s %8s %10s %10s %10s\n", "stage", "count", "p50_us", "p99_us", "max_us");
+    for (int s = 0; s < FIRE_TRACE_STAGES; s++) {
+        const fire_trace_hist_t *hist = &dump->stages[s];
+        printf("%-18s %8u %10u %10u %10u\n", stage_names[s], hist->count,
+               fire_trace_percentile(hist, 500), fire_trace_percentile(hist, 990), hist->max_us);
+    }
+    for (int i = 0; i < dump->span_count; i++) {
+        const uint32_t *t = dump->spans[i].ccount;
+        uint32_t mhz = dump->cpu_mhz ? dump->cpu_mhz : 80;
+        printf("alarm %d: edge ccount %u, +%u us alarm, +%u us command, +%u us led, total %u us\n", i,
+               t[FIRE_TRACE_EDGE], (t[FIRE_TRACE_ALARM] - t[FIRE_TRACE_EDGE]) / mhz,
+               (t[FIRE_TRACE_COMMAND] - t[FIRE_TRACE_ALARM]) / mhz,
+               (t[FIRE_TRACE_OUTPUT] - t[FIRE_TRACE_COMMAND]) / mhz,
+               (t[FIRE_TRACE_OUTPUT] - t[FIRE_TRACE_EDGE]) / mhz);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool all = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a")) != -1) {
+        if (opt != 'a') {
+            fprintf(stderr, "usage: %s [-a] console.log\n", argv[0]);
+            return 2;
+        }
+        all = true;
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-a] console.log\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = fopen(argv[optind], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return 2;
+    }
+    size_t size = 0, capacity = 4096;
+    uint8_t *data = malloc(capacity);
+    size_t n;
+    while (data != NULL && (n = fread(data + size, 1, capacity - size, file)) > 0) {
+        size += n;
+        if (size == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    fclose(file);
+    if (data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    // Tìm magic ở mọi vị trí; bản dump hỏng (CRC sai) bị bỏ qua
+    static fire_trace_dump_t dump, last;
+    size_t last_offset = 0;
+    int found = 0, corrupt = 0;
+    for (size_t i = 0; i + 4 <= size; i++) {
+        if (data[i] != (FIRE_TRACE_MAGIC & 0xff) || memcmp(data + i, "FTRC", 4) != 0) {
+            continue;
+        }
+        size_t len = fire_trace_decode(data + i, size - i, &dump);
+        if (len == 0) {
+            corrupt++;
+            continue;
+        }
+        found++;
+        if (all) {
+            print_dump(&dump, i);
+        }
+        last = dump;
+        last_offset = i;
+        i += len - 1;
+    }
+    free(data);
+
+    if (found == 0) {
+        fprintf(stderr, "no valid trace dump found (%d corrupt)\n", corrupt);
+        return 1;
+    }
+    if (!all) {
+        print_dump(&last, last_offset);
+    }
+    if (corrupt) {
+        printf("%d corrupt dumps skipped\n", corrupt);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// Bản thay thế FreeRTOS cho bộ mô phỏng: cùng API với esp-open-rtos, mỗi task
+// là một thread nhưng chỉ một task chạy tại một thời điểm (xem sim_rtos.c)
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOSConfig.h"
+#include "portmacro.h"
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL  ((BaseType_t)0)
+
+// Bộ nhớ cho các hàm xxxCreateStatic. Bộ mô phỏng giữ trạng thái trong bảng
+// riêng nên chỉ cần địa chỉ; kích thước không giống target
+typedef struct { void *unused; } StaticTask_t;
+typedef struct { void *unused; } StaticTimer_t;
+typedef struct { void *unused; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+/**
+ * @brief Returns the heap left after the simulated task stacks and queues
+ *
+ * 32-bit like on the target, so the application's format strings still match.
+ */
+uint32_t xPortGetFreeHeapSize(void);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SIM_ADS111X_H
+#define SIM_ADS111X_H
+
+#include <stdint.h>
+#include "i2c/i2c.h"
+
+#define ADS111X_ADDR_GND 0x48
+#define ADS111X_ADDR_VCC 0x49
+#define ADS111X_ADDR_SDA 0x4a
+#define ADS111X_ADDR_SCL 0x4b
+
+#define ADS111X_MAX_VALUE 0x7fff
+
+typedef enum {
+    ADS111X_GAIN_6V144 = 0,
+    ADS111X_GAIN_4V096,
+    ADS111X_GAIN_2V048,
+    ADS111X_GAIN_1V024,
+    ADS111X_GAIN_0V512,
+    ADS111X_GAIN_0V256,
+} ads111x_gain_t;
+
+typedef enum {
+    ADS111X_MUX_0_1 = 0,
+    ADS111X_MUX_0_3,
+    ADS111X_MUX_1_3,
+    ADS111X_MUX_2_3,
+    ADS111X_MUX_0_GND,
+    ADS111X_MUX_1_GND,
+    ADS111X_MUX_2_GND,
+    ADS111X_MUX_3_GND,
+} ads111x_mux_t;
+
+typedef enum {
+    ADS111X_DATA_RATE_8 = 0,
+    ADS111X_DATA_RATE_16,
+    ADS111X_DATA_RATE_32,
+    ADS111X_DATA_RATE_64,
+    ADS111X_DATA_RATE_128,
+    ADS111X_DATA_RATE_250,
+    ADS111X_DATA_RATE_475,
+    ADS111X_DATA_RATE_860
+} ads111x_data_rate_t;
+
+typedef enum {
+    ADS111X_MODE_CONTUNOUS = 0,
+    ADS111X_MODE_SINGLE_SHOT
+} ads111x_mode_t;
+
+// Chip ở ADS111X_ADDR_GND luôn có mặt, AIN0 do kịch bản đặt; một lần chuyển
+// đổi chốt giá trị tại lúc bắt đầu và xong ngay
+void ads111x_start_conversion(i2c_dev_t *dev);
+int16_t ads111x_get_value(i2c_dev_t *dev);
+void ads111x_set_gain(i2c_dev_t *dev, ads111x_gain_t gain);
+void ads111x_set_input_mux(i2c_dev_t *dev, ads111x_mux_t mux);
+void ads111x_set_mode(i2c_dev_t *dev, ads111x_mode_t mode);
+void ads111x_set_data_rate(i2c_dev_t *dev, ads111x_data_rate_t rate);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SIM_BME680_H
+#define SIM_BME680_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BME680_I2C_ADDRESS_1 0x76
+#define BME680_I2C_ADDRESS_2 0x77
+
+typedef enum {
+    osr_none = 0,
+    osr_1x,
+    osr_2x,
+    osr_4x,
+    osr_8x,
+    osr_16x
+} bme680_oversampling_rate_t;
+
+typedef struct {
+    int16_t temperature;     // degree C * 100
+    uint32_t pressure;       // Pa
+    uint32_t humidity;       // % * 1000
+    uint32_t gas_resistance; // ohm
+} bme680_values_fixed_t;
+
+typedef struct {
+    uint8_t bus;
+    uint8_t addr;
+} bme680_sensor_t;
+
+// Chip ở BME680_I2C_ADDRESS_2 luôn có mặt; một lần đo chốt các giá trị do kịch
+// bản đặt tại lúc bắt đầu, kết quả đọc được sau 200 ms (bộ sấy 150 ms)
+bme680_sensor_t *bme680_init_sensor(uint8_t bus, uint8_t addr, uint8_t cs);
+bool bme680_force_measurement(bme680_sensor_t *dev);
+uint32_t bme680_get_measurement_duration(const bme680_sensor_t *dev);
+bool bme680_get_results_fixed(bme680_sensor_t *dev, bme680_values_fixed_t *results);
+bool bme680_set_oversampling_rates(bme680_sensor_t *dev, bme680_oversampling_rate_t osr_t,
+                                   bme680_oversampling_rate_t osr_p, bme680_oversampling_rate_t osr_h);
+bool bme680_set_heater_profile(bme680_sensor_t *dev, uint8_t profile, uint16_t temperature, uint16_t duration);
+bool bme680_use_heater_profile(bme680_sensor_t *dev, int8_t profile);
+
+#endif
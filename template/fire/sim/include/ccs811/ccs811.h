@@ -0,0 +1,31 @@
+#ifndef SIM_CCS811_H
+#define SIM_CCS811_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CCS811_I2C_ADDRESS_1 0x5a
+#define CCS811_I2C_ADDRESS_2 0x5b
+
+typedef enum {
+    ccs811_mode_idle = 0,
+    ccs811_mode_1s,
+    ccs811_mode_10s,
+    ccs811_mode_60s,
+    ccs811_mode_250ms
+} ccs811_mode_t;
+
+typedef struct {
+    uint8_t bus;
+    uint8_t addr;
+    ccs811_mode_t mode;
+} ccs811_sensor_t;
+
+// Chip ở CCS811_I2C_ADDRESS_1 luôn có mặt và trả các giá trị do kịch bản đặt
+ccs811_sensor_t *ccs811_init_sensor(uint8_t bus, uint8_t addr);
+bool ccs811_set_mode(ccs811_sensor_t *sensor, ccs811_mode_t mode);
+bool ccs811_get_results(ccs811_sensor_t *sensor, uint16_t *iaq_tvoc, uint16_t *iaq_eco2, uint8_t *raw_i,
+                        uint16_t *raw_v);
+bool ccs811_set_environmental_data(ccs811_sensor_t *sensor, float temperature, float humidity);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef SIM_COMMON_MACROS_H
+#define SIM_COMMON_MACROS_H
+
+#define BIT(X) (1 << (X))
+
+// Trên host không có IRAM/IROM riêng; IROM vẫn là const như trên thiết bị
+#define IRAM
+#define IROM const
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef SIM_ESP_GPIO_H
+#define SIM_ESP_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "common_macros.h"
+
+typedef enum {
+    GPIO_INPUT,
+    GPIO_OUTPUT,
+    GPIO_OUT_OPEN_DRAIN,
+} gpio_direction_t;
+
+typedef enum {
+    GPIO_INTTYPE_NONE = 0,
+    GPIO_INTTYPE_EDGE_POS = 1,
+    GPIO_INTTYPE_EDGE_NEG = 2,
+    GPIO_INTTYPE_EDGE_ANY = 3,
+    GPIO_INTTYPE_LEVEL_LOW = 4,
+    GPIO_INTTYPE_LEVEL_HIGH = 5,
+} gpio_inttype_t;
+
+typedef void (*gpio_interrupt_handler_t)(uint8_t gpio_num);
+
+// Thanh ghi GPIO. OUT/IN/STATUS là bộ nhớ thường do bộ mô phỏng cập nhật; các
+// thanh ghi chỉ ghi (OUT_SET, OUT_CLEAR, STATUS_CLEAR) được ánh xạ qua macro
+// vào một ô ghi, và lần ghi được áp dụng ở lần truy cập thanh ghi tiếp theo,
+// nên chuỗi ghi liên tiếp giữ đúng thứ tự như trên phần cứng
+// GPIO registers with write-only registers routed through sim_gpio_write_reg()
+typedef struct {
+    uint32_t OUT;
+    uint32_t ENABLE_OUT;
+    uint32_t IN;
+    uint32_t STATUS;
+    uint32_t CONF[16];
+    uint32_t write_only[1];
+} sim_gpio_regs_t;
+
+#define GPIO_CONF_WAKEUP_ENABLE BIT(10)
+
+enum {
+    SIM_GPIO_OUT_SET,
+    SIM_GPIO_OUT_CLEAR,
+    SIM_GPIO_STATUS_CLEAR,
+};
+
+extern sim_gpio_regs_t sim_gpio_regs;
+int sim_gpio_write_reg(int reg);
+
+#define GPIO         sim_gpio_regs
+#define OUT_SET      write_only[sim_gpio_write_reg(SIM_GPIO_OUT_SET)]
+#define OUT_CLEAR    write_only[sim_gpio_write_reg(SIM_GPIO_OUT_CLEAR)]
+#define STATUS_CLEAR write_only[sim_gpio_write_reg(SIM_GPIO_STATUS_CLEAR)]
+
+void gpio_enable(const uint8_t gpio_num, const gpio_direction_t direction);
+void gpio_disable(const uint8_t gpio_num);
+void gpio_set_pullup(uint8_t gpio_num, bool enabled, bool enabled_during_sleep);
+void gpio_write(const uint8_t gpio_num, const bool set);
+bool gpio_read(const uint8_t gpio_num);
+void gpio_toggle(const uint8_t gpio_num);
+void gpio_set_interrupt(const uint8_t gpio_num, const gpio_inttype_t int_type, gpio_interrupt_handler_t handler);
+
+// Handler dùng chung cho mọi chân (ứng dụng có thể định nghĩa lại)
+void gpio_interrupt_handler(void *arg);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SIM_ESP_INTERRUPTS_H
+#define SIM_ESP_INTERRUPTS_H
+
+#include <stdint.h>
+
+typedef enum {
+    INUM_WDEV_FIQ = 0,
+    INUM_SLC = 1,
+    INUM_SPI = 2,
+    INUM_RTC = 3,
+    INUM_GPIO = 4,
+    INUM_UART = 5,
+    INUM_TICK = 6,
+    INUM_SOFT = 7,
+    INUM_WDT = 8,
+    INUM_TIMER_FRC1 = 9,
+    INUM_TIMER_FRC2 = 10,
+} xt_isr_num_t;
+
+typedef void (*_xt_isr)(void *arg);
+
+void _xt_isr_attach(uint8_t i, _xt_isr func, void *arg);
+// Ngắt đang chờ chạy ngay khi được bỏ che, như trên phần cứng
+uint32_t _xt_isr_unmask(uint32_t unmask);
+uint32_t _xt_isr_mask(uint32_t mask);
+
+// ISR chỉ chạy khi mọi task đang chờ hoặc trong WAITI, nên không cần chặn ngắt
+static inline uint32_t _xt_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void _xt_restore_interrupts(uint32_t new_ps)
+{
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Chỉ FRC1 được mô phỏng: đếm lùi từ LOAD theo clock APB 80 MHz / bộ chia
+typedef enum {
+    FRC1 = 0,
+    FRC2 = 1,
+} timer_frc_t;
+
+typedef enum {
+    TIMER_CLKDIV_1 = 0,
+    TIMER_CLKDIV_16 = 4,
+    TIMER_CLKDIV_256 = 8,
+} timer_clkdiv_t;
+
+#define TIMER_FRC1_MAX_LOAD 0x7fffff
+
+uint32_t timer_get_count(const timer_frc_t frc);
+uint32_t timer_get_load(const timer_frc_t frc);
+void timer_set_load(const timer_frc_t frc, const uint32_t load);
+void timer_set_divider(const timer_frc_t frc, const timer_clkdiv_t div);
+void timer_set_reload(const timer_frc_t frc, const bool reload);
+void timer_set_interrupts(const timer_frc_t frc, bool enable);
+void timer_set_run(const timer_frc_t frc, const bool run);
+bool timer_get_run(const timer_frc_t frc);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef SIM_ESP_UART_H
+#define SIM_ESP_UART_H
+
+#include <stdio.h>
+
+// Console của ứng dụng là stdout của bộ mô phỏng
+static inline void uart_set_baud(int uart_num, int bps)
+{
+}
+
+// FIFO TX không bao giờ đầy
+static inline void uart_putc(int uart_num, char c)
+{
+    putchar(c);
+}
+
+static inline int uart_putc_nowait(int uart_num, char c)
+{
+    putchar(c);
+    return 0;
+}
+
+#endif
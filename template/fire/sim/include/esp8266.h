@@ -0,0 +1,9 @@
+#ifndef SIM_ESP8266_H
+#define SIM_ESP8266_H
+
+#include "common_macros.h"
+#include "esp/gpio.h"
+#include "esp/interrupts.h"
+#include "esp/timer.h"
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SIM_ESP_COMMON_H
+#define SIM_ESP_COMMON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "espressif/esp_system.h"
+
+// Wi-Fi: cấu hình được ghi nhận, trạng thái kết nối do kịch bản điều khiển
+enum {
+    NULL_MODE = 0,
+    STATION_MODE,
+    SOFTAP_MODE,
+    STATIONAP_MODE,
+};
+
+struct sdk_station_config {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint8_t bssid_set;
+    uint8_t bssid[6];
+};
+
+bool sdk_wifi_set_opmode(uint8_t opmode);
+bool sdk_wifi_station_set_config(struct sdk_station_config *config);
+bool sdk_wifi_station_connect(void);
+bool sdk_wifi_station_disconnect(void);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SIM_ESP_SYSTEM_H
+#define SIM_ESP_SYSTEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+uint8_t sdk_system_get_cpu_freq(void);
+uint32_t sdk_system_get_time(void);
+void sdk_system_restart(void);
+uint16_t sdk_system_adc_read(void);
+
+enum sdk_sleep_type {
+    WIFI_SLEEP_NONE = 0,
+    WIFI_SLEEP_LIGHT = 1,
+    WIFI_SLEEP_MODEM = 2,
+};
+
+bool sdk_wifi_set_sleep_type(enum sdk_sleep_type);
+enum sdk_sleep_type sdk_wifi_get_sleep_type(void);
+
+#endif
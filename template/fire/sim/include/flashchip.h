@@ -0,0 +1,18 @@
+#ifndef SIM_FLASHCHIP_H
+#define SIM_FLASHCHIP_H
+
+#include <stdint.h>
+
+// Như core/include/flashchip.h; spiflash_host.c mô tả ảnh flash đang mở
+typedef struct {
+    uint32_t device_id;
+    uint32_t chip_size;   /* in bytes */
+    uint32_t block_size;  /* in bytes */
+    uint32_t sector_size; /* in bytes */
+    uint32_t page_size;   /* in bytes */
+    uint32_t status_mask;
+} sdk_flashchip_t;
+
+extern sdk_flashchip_t sdk_flashchip;
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#include <stdint.h>
+
+typedef enum {
+    I2C_FREQ_80K = 0,
+    I2C_FREQ_100K,
+    I2C_FREQ_400K,
+    I2C_FREQ_500K,
+    I2C_FREQ_600K,
+    I2C_FREQ_800K,
+    I2C_FREQ_1000K,
+    I2C_FREQ_1300K
+} i2c_freq_t;
+
+typedef struct i2c_dev {
+    uint8_t bus;
+    uint8_t addr;
+} i2c_dev_t;
+
+int i2c_init(uint8_t bus, uint8_t scl_pin, uint8_t sda_pin, i2c_freq_t freq);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SIM_LWIP_ARCH_H
+#define SIM_LWIP_ARCH_H
+
+#include <stdint.h>
+
+#endif
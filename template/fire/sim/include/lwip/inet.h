@@ -0,0 +1,6 @@
+#ifndef SIM_LWIP_INET_H
+#define SIM_LWIP_INET_H
+
+#include <arpa/inet.h>
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SIM_LWIP_SOCKETS_H
+#define SIM_LWIP_SOCKETS_H
+
+// Kiểu dữ liệu lấy từ host; các lời gọi mở kết nối đi qua mạng giả lập, vốn
+// không có socket nên sim_monitor_task (SIM_MONITOR_RAW=0) luôn thấy mạng lỗi
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+int lwip_socket(int domain, int type, int protocol);
+
+#define socket(domain, type, protocol) lwip_socket(domain, type, protocol)
+#define ioctlsocket ioctl
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef SIM_LWIP_SYS_H
+#define SIM_LWIP_SYS_H
+
+// Như arch/sys_arch.h của esp-open-rtos
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#endif
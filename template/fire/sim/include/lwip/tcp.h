@@ -0,0 +1,7 @@
+#ifndef SIM_LWIP_TCP_H
+#define SIM_LWIP_TCP_H
+
+// Dùng chung khai báo raw API với test của sim_rawprobe
+#include "lwip_mock.h"
+
+#endif
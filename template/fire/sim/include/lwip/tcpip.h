@@ -0,0 +1,12 @@
+#ifndef SIM_LWIP_TCPIP_H
+#define SIM_LWIP_TCPIP_H
+
+#include "lwip/err.h"
+
+typedef void (*tcpip_callback_fn)(void *ctx);
+
+// Chạy function trong thread tcpip (task ưu tiên TCPIP_THREAD_PRIO của bộ mô phỏng)
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx);
+err_t tcpip_try_callback(tcpip_callback_fn function, void *ctx);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_LWIP_TIMEOUTS_H
+#define SIM_LWIP_TIMEOUTS_H
+
+// Dùng chung khai báo raw API với test của sim_rawprobe; timer chạy trong sim_net.c
+#include "lwip_mock.h"
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_PCF8574_H
+#define SIM_PCF8574_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "i2c/i2c.h"
+
+// Các chip 0x20-0x27 luôn có mặt; đọc cổng xóa tín hiệu INT như chip thật
+size_t pcf8574_port_read_buf(i2c_dev_t *dev, void *buf, size_t len);
+size_t pcf8574_port_write_buf(const i2c_dev_t *dev, void *buf, size_t len);
+
+#endif
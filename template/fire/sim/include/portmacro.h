@@ -0,0 +1,23 @@
+#ifndef SIM_PORTMACRO_H
+#define SIM_PORTMACRO_H
+
+#include <stdint.h>
+
+// Kiểu dữ liệu của port ESP8266 (Xtensa 32 bit)
+// Port types of the ESP8266 (32-bit Xtensa) port
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define portBASE_TYPE      long
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+
+// ISR chỉ chạy khi mọi task đang chờ, nên không cần chuyển ngữ cảnh ngay
+void sim_port_yield_from_isr(BaseType_t switch_required);
+
+#define portEND_SWITCHING_ISR(xSwitchRequired) sim_port_yield_from_isr(xSwitchRequired)
+#define portYIELD_FROM_ISR(xSwitchRequired)    sim_port_yield_from_isr(xSwitchRequired)
+
+#endif
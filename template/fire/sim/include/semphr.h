@@ -0,0 +1,18 @@
+#ifndef SIM_SEMPHR_H
+#define SIM_SEMPHR_H
+
+#include "queue.h"
+
+// Như FreeRTOS: semaphore là hàng đợi có phần tử kích thước 0
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer);
+
+#define xSemaphoreTake(sem, ticks)            xQueueReceive((sem), NULL, (ticks))
+#define xSemaphoreGive(sem)                   xQueueSend((sem), NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken)     xQueueSendFromISR((sem), NULL, (woken))
+#define vSemaphoreDelete(sem)                 vQueueDelete(sem)
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SIM_SHT3X_H
+#define SIM_SHT3X_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SHT3x_ADDR_1 0x44
+#define SHT3x_ADDR_2 0x45
+
+typedef enum {
+    sht3x_single_shot = 0,
+    sht3x_periodic_05mps,
+    sht3x_periodic_1mps,
+    sht3x_periodic_2mps,
+    sht3x_periodic_4mps,
+    sht3x_periodic_10mps
+} sht3x_mode_t;
+
+typedef enum {
+    sht3x_high = 0,
+    sht3x_medium,
+    sht3x_low
+} sht3x_repeat_t;
+
+typedef struct {
+    uint8_t bus;
+    uint8_t addr;
+    sht3x_mode_t mode;
+} sht3x_sensor_t;
+
+// Chip ở SHT3x_ADDR_1 luôn có mặt và trả các giá trị do kịch bản đặt
+sht3x_sensor_t *sht3x_init_sensor(uint8_t bus, uint8_t addr);
+bool sht3x_start_measurement(sht3x_sensor_t *dev, sht3x_mode_t mode, sht3x_repeat_t repeat);
+bool sht3x_get_results(sht3x_sensor_t *dev, float *temperature, float *humidity);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SIM_SPIFLASH_H
+#define SIM_SPIFLASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SPI_FLASH_SECTOR_SIZE 4096
+
+// Flash NOR của ../test/host/spiflash_host.c: ghi chỉ xóa bit, xóa theo sector;
+// với sim -f nội dung nằm trong file ảnh và còn lại sau khi thoát
+bool spiflash_read(uint32_t addr, uint8_t *buf, uint32_t size);
+bool spiflash_write(uint32_t addr, uint8_t *buf, uint32_t size);
+bool spiflash_erase_sector(uint32_t addr);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct sim_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+typedef enum {
+    eAbortSleep = 0,
+    eStandardSleep,
+    eNoTasksWaitingTimeout
+} eSleepModeStatus;
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+// Chỉ một task chạy tại một thời điểm và ISR không chen ngang task,
+// nên vùng găng không cần khóa
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskYIELD() sim_task_yield()
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint16_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t code, const char *name, uint32_t stack_depth, void *param,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void sim_task_yield(void);
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+/**
+ * @brief Returns the stack depth the task was created with
+ *
+ * Host stacks say nothing about Xtensa stack usage, so the simulator does not
+ * measure it.
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *higher_priority_woken);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value,
+                           TickType_t ticks);
+eSleepModeStatus eTaskConfirmSleepModeStatus(void);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#define xTaskNotifyGive(task) xTaskNotify((task), 0, eIncrement)
+
+#endif
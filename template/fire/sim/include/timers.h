@@ -0,0 +1,23 @@
+#ifndef SIM_TIMERS_H
+#define SIM_TIMERS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct sim_timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+// Lệnh được áp dụng ngay thay vì qua hàng đợi của timer task; callback vẫn
+// chạy trong timer task với ưu tiên configTIMER_TASK_PRIORITY
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback);
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks);
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+void *pvTimerGetTimerID(TimerHandle_t timer);
+
+#endif
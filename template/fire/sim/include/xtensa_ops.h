@@ -0,0 +1,16 @@
+#ifndef SIM_XTENSA_OPS_H
+#define SIM_XTENSA_OPS_H
+
+#include <stdint.h>
+
+// CCOUNT được suy ra từ thời gian ảo của bộ mô phỏng
+uint32_t sim_rsr_ccount(void);
+
+#define RSR(var, reg) ((var) = sim_rsr_##reg())
+
+// WAITI: thời gian ảo nhảy tới sự kiện kế tiếp, các ngắt đến hạn chạy trước khi trả về
+void sim_waiti(void);
+
+#define WAITI(level) sim_waiti()
+
+#endif
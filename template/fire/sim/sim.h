@@ -0,0 +1,170 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Thời gian ảo của bộ mô phỏng (ns từ lúc khởi động). Code của ứng dụng chạy
+// trong thời gian 0; thời gian chỉ tăng khi mọi task đang chờ, nên kết quả
+// không phụ thuộc máy chạy
+extern uint64_t sim_now_ns;
+
+#define SIM_NEVER   UINT64_MAX
+#define SIM_US      1000ull
+#define SIM_MS      1000000ull
+#define SIM_CPU_MHZ 80
+
+// ---- RTOS (sim_rtos.c) ----
+
+/**
+ * @brief Creates the timer service task; call before user_init()
+ */
+void sim_rtos_init(void);
+
+/**
+ * @brief Runs ready tasks, highest priority first, until every task blocks
+ */
+void sim_rtos_run(void);
+
+/**
+ * @brief Returns the earliest virtual time a blocked task times out
+ */
+uint64_t sim_rtos_next_wake(void);
+
+/**
+ * @brief Readies tasks whose timeout has passed at sim_now_ns
+ */
+void sim_rtos_wake_due(void);
+
+/**
+ * @brief Runs the idle task's sleep hook once every task is blocked
+ *
+ * Like FreeRTOS with configUSE_TICKLESS_IDLE, the hook gets the ticks until
+ * the next task timeout when that is at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP.
+ *
+ * @return true if the hook ran (virtual time may have moved)
+ */
+bool sim_rtos_idle(void);
+
+/**
+ * @brief Prints per-task activations and host CPU time
+ */
+void sim_rtos_report(FILE *out);
+
+/**
+ * @brief Host CPU time (ns) and activations of the named task
+ *
+ * @return false if no task has this name
+ */
+bool sim_rtos_task_stats(const char *name, uint64_t *cpu_ns, uint32_t *activations);
+
+/**
+ * @brief True once virtual time has reached the end of the run
+ */
+bool sim_finished(void);
+
+// ---- Phần cứng (sim_hw.c) ----
+
+/**
+ * @brief Maps the flash and sets the GPIO inputs to their idle level
+ *
+ * @param flash_image File kept between runs (created erased, 4 MB, if
+ *                    missing), or NULL for an erased flash that is dropped
+ * @return false if the image cannot be opened
+ */
+bool sim_hw_init(const char *flash_image);
+
+/**
+ * @brief Writes the flash image back to its file
+ */
+void sim_hw_shutdown(void);
+
+/**
+ * @brief Mounts or creates the sysparam area as the SDK startup does
+ *
+ * Call after sim_rtos_init(), before user_init().
+ */
+bool sim_hw_sysparam_init(void);
+
+/**
+ * @brief Drives a GPIO input from the stimulus and raises its edge interrupt
+ */
+void sim_gpio_set_input(uint8_t pin, bool level);
+
+/**
+ * @brief Drives one PCF8574 input; the chip pulls FIRE_EXPANDER_INT low
+ */
+void sim_expander_set_input(uint8_t chip, uint8_t pin, bool level);
+
+/**
+ * @brief Makes the next @p reads PCF8574 reads fail, as if the bus were busy
+ */
+void sim_expander_fail(uint32_t reads);
+
+/**
+ * @brief Drives an analog input: 0 is TOUT (10 bit), 1 is AIN0 of the ADS111x
+ *
+ * @return Previous value of the input
+ */
+int16_t sim_analog_set_input(uint8_t channel, int16_t value);
+
+/**
+ * @brief Drives a gas sensor reading (fire_fusion_feature_t, fire_fusion.h units)
+ *
+ * @return Previous value of the reading
+ */
+int32_t sim_gas_set_input(uint8_t feature, int32_t value);
+
+/**
+ * @brief Applies pending writes to write-only GPIO registers
+ */
+void sim_gpio_sync(void);
+
+/**
+ * @brief Returns the virtual time of the next FRC1 interrupt
+ */
+uint64_t sim_hw_next_event(void);
+
+/**
+ * @brief Services the FRC1 interrupt if it is due at sim_now_ns
+ */
+void sim_hw_run_due(void);
+
+/**
+ * @brief Interrupt service counts and host CPU time spent in ISRs
+ */
+void sim_hw_report(FILE *out);
+
+/**
+ * @brief Called for every change of a pin configured as output
+ */
+void sim_trace_output(uint8_t pin, bool level);
+
+// ---- Mạng (sim_net.c) ----
+
+/**
+ * @brief Creates the tcpip thread; call before user_init()
+ */
+void sim_net_init(void);
+
+/**
+ * @brief Associates or drops the station
+ *
+ * While up, DNS answers and TCP handshakes take one round trip and every HTTP
+ * request gets a bodyless response with the given status. While down, DNS
+ * fails at once and TCP segments are lost. MQTT never reaches a broker.
+ */
+void sim_wifi_set(bool up, uint32_t rtt_ms, uint16_t http_status);
+
+/**
+ * @brief Returns the virtual time of the next simulated packet arrival
+ */
+uint64_t sim_net_next_event(void);
+
+/**
+ * @brief Hands packets due at sim_now_ns to the tcpip thread
+ */
+void sim_net_run_due(void);
+
+#endif
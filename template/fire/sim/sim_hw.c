@@ -0,0 +1,655 @@
+// Phần cứng ESP8266 của bộ mô phỏng: GPIO, ngắt, FRC1, PCF8574, ADC, flash SPI và sysparam.
+// ISR chạy trên thread đang giữ CPU (bộ lập lịch, hoặc task vừa bỏ che ngắt).
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "espressif/esp_common.h"
+#include "esp/gpio.h"
+#include "esp/interrupts.h"
+#include "esp/timer.h"
+#include "i2c/i2c.h"
+#include "pcf8574/pcf8574.h"
+#include "ads111x/ads111x.h"
+#include "bme680/bme680.h"
+#include "ccs811/ccs811.h"
+#include "sht3x/sht3x.h"
+#include "host/spiflash_host.h"
+#include "sysparam.h"
+#include "xtensa_ops.h"
+#include "fire_fusion.h"
+#include "sim.h"
+
+#define SIM_GPIO_PINS 16
+
+// Chân INT chung của các PCF8574, nối như FIRE_EXPANDER_INT_PIN trong fire.c
+#define SIM_EXPANDER_INT_PIN 3
+#define SIM_EXPANDER_ADDR    0x20
+#define SIM_EXPANDER_COUNT   8
+
+// Flash 4 MB như ESP-12; ảnh có sẵn (-f) giữ kích thước của nó
+#define SIM_FLASH_SIZE (4 * 1024 * 1024)
+
+uint64_t sim_now_ns;
+
+sim_gpio_regs_t sim_gpio_regs;
+static int gpio_pending_reg = -1;   // Write-only register written last, not yet applied
+static uint32_t gpio_inputs = 0xffff; // Levels driven from outside (idle high, pulled up)
+static uint32_t gpio_traced;          // Output levels last reported to the trace
+static uint8_t gpio_inttype[SIM_GPIO_PINS];
+static gpio_interrupt_handler_t gpio_handlers[SIM_GPIO_PINS];
+
+// Bảng ngắt Xtensa: handler, bit được bỏ che và bit đang chờ
+static struct {
+    _xt_isr func;
+    void *arg;
+    uint32_t count;
+    uint64_t cpu_ns;
+} isr_table[16];
+static uint32_t isr_unmasked;
+static uint32_t isr_pending;
+static bool isr_active;
+
+// FRC1: đếm lùi từ remaining tick tính từ since, ngắt khi về 0
+static struct {
+    uint32_t load;
+    uint32_t remaining;
+    uint64_t since;
+    uint32_t prescale;
+    bool run;
+    bool interrupts;
+    bool reload;
+    bool expired;
+} frc1 = { .prescale = 1 };
+
+// Cổng vào của PCF8574 và giá trị đọc lần trước (INT tích cực khi khác nhau)
+static uint8_t expander_inputs[SIM_EXPANDER_COUNT] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+static uint8_t expander_read[SIM_EXPANDER_COUNT] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+static uint32_t expander_reads;
+static uint32_t expander_failures;
+
+// Đầu vào analog: TOUT và AIN0 của ADS111x, mặc định ở mức không khí sạch
+// của FIRE_SMOKE_TOUT_DEFAULTS / FIRE_SMOKE_ADS111X_DEFAULTS
+#define SIM_ANALOG_CHANNELS 2
+static int16_t analog_inputs[SIM_ANALOG_CHANNELS] = { 120, 3200 };
+static int16_t ads_conversion;
+static uint32_t adc_reads, ads_conversions;
+
+// Cảm biến khí (đơn vị của fire_fusion.h), mặc định ở mức không khí sạch
+static int32_t gas_inputs[FIRE_FUSION_FEATURES] = {
+    [FIRE_FUSION_GAS] = 120000, [FIRE_FUSION_TVOC] = 20, [FIRE_FUSION_ECO2] = 420,
+    [FIRE_FUSION_TEMP] = 2150, [FIRE_FUSION_HUMIDITY] = 4500,
+};
+static bme680_sensor_t bme680 = { .addr = BME680_I2C_ADDRESS_2 };
+static ccs811_sensor_t ccs811 = { .addr = CCS811_I2C_ADDRESS_1 };
+static sht3x_sensor_t sht3x = { .addr = SHT3x_ADDR_1 };
+static bme680_values_fixed_t bme680_latched;
+static uint32_t bme680_measurements, ccs811_reads, sht3x_reads;
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint32_t sim_rsr_ccount(void)
+{
+    return (uint32_t)(sim_now_ns * SIM_CPU_MHZ / 1000);
+}
+
+uint8_t sdk_system_get_cpu_freq(void)
+{
+    return SIM_CPU_MHZ;
+}
+
+uint32_t sdk_system_get_time(void)
+{
+    return (uint32_t)(sim_now_ns / SIM_US);
+}
+
+// ---- Ngắt ----
+
+// Chạy mọi ngắt đang chờ và được bỏ che; ngắt không lồng nhau
+static void isr_dispatch(void)
+{
+    if (isr_active) {
+        return;
+    }
+    isr_active = true;
+    uint32_t due;
+    while ((due = isr_pending & isr_unmasked) != 0) {
+        int inum = __builtin_ctz(due);
+        isr_pending &= ~BIT(inum);
+        if (isr_table[inum].func != NULL) {
+            uint64_t start = thread_cpu_ns();
+            isr_table[inum].func(isr_table[inum].arg);
+            isr_table[inum].cpu_ns += thread_cpu_ns() - start;
+            isr_table[inum].count++;
+        }
+        sim_gpio_sync();
+    }
+    isr_active = false;
+}
+
+static void isr_raise(int inum)
+{
+    isr_pending |= BIT(inum);
+    isr_dispatch();
+}
+
+void _xt_isr_attach(uint8_t i, _xt_isr func, void *arg)
+{
+    isr_table[i].func = func;
+    isr_table[i].arg = arg;
+}
+
+uint32_t _xt_isr_unmask(uint32_t unmask)
+{
+    uint32_t old = isr_unmasked;
+    isr_unmasked |= unmask;
+    isr_dispatch();
+    return old;
+}
+
+uint32_t _xt_isr_mask(uint32_t mask)
+{
+    uint32_t old = isr_unmasked;
+    isr_unmasked &= ~mask;
+    return old;
+}
+
+// ---- GPIO ----
+
+static void gpio_update(void)
+{
+    uint32_t outputs = sim_gpio_regs.ENABLE_OUT;
+    sim_gpio_regs.IN = (gpio_inputs & ~outputs) | (sim_gpio_regs.OUT & outputs);
+
+    uint32_t changed = (sim_gpio_regs.OUT ^ gpio_traced) & outputs;
+    for (uint8_t pin = 0; changed != 0; pin++, changed >>= 1) {
+        if (changed & 1) {
+            sim_trace_output(pin, (sim_gpio_regs.OUT >> pin) & 1);
+        }
+    }
+    gpio_traced = (gpio_traced & ~outputs) | (sim_gpio_regs.OUT & outputs);
+}
+
+void sim_gpio_sync(void)
+{
+    int reg = gpio_pending_reg;
+    uint32_t value = sim_gpio_regs.write_only[0];
+
+    if (reg < 0) {
+        return;
+    }
+    gpio_pending_reg = -1;
+    switch (reg) {
+    case SIM_GPIO_OUT_SET:
+        sim_gpio_regs.OUT |= value & 0xffff;
+        break;
+    case SIM_GPIO_OUT_CLEAR:
+        sim_gpio_regs.OUT &= ~value;
+        break;
+    case SIM_GPIO_STATUS_CLEAR:
+        sim_gpio_regs.STATUS &= ~value;
+        break;
+    }
+    gpio_update();
+}
+
+int sim_gpio_write_reg(int reg)
+{
+    sim_gpio_sync();
+    gpio_pending_reg = reg;
+    return 0;
+}
+
+void gpio_enable(const uint8_t gpio_num, const gpio_direction_t direction)
+{
+    sim_gpio_sync();
+    if (direction == GPIO_INPUT) {
+        sim_gpio_regs.ENABLE_OUT &= ~BIT(gpio_num);
+    } else {
+        sim_gpio_regs.ENABLE_OUT |= BIT(gpio_num);
+    }
+    gpio_update();
+}
+
+void gpio_disable(const uint8_t gpio_num)
+{
+    gpio_enable(gpio_num, GPIO_INPUT);
+}
+
+void gpio_set_pullup(uint8_t gpio_num, bool enabled, bool enabled_during_sleep)
+{
+}
+
+void gpio_write(const uint8_t gpio_num, const bool set)
+{
+    sim_gpio_sync();
+    if (set) {
+        sim_gpio_regs.OUT |= BIT(gpio_num);
+    } else {
+        sim_gpio_regs.OUT &= ~BIT(gpio_num);
+    }
+    gpio_update();
+}
+
+bool gpio_read(const uint8_t gpio_num)
+{
+    sim_gpio_sync();
+    return (sim_gpio_regs.IN >> gpio_num) & 1;
+}
+
+void gpio_toggle(const uint8_t gpio_num)
+{
+    gpio_write(gpio_num, !((sim_gpio_regs.OUT >> gpio_num) & 1));
+}
+
+// Handler mặc định của esp_gpio, dùng khi ứng dụng không định nghĩa lại
+void __attribute__((weak)) gpio_interrupt_handler(void *arg)
+{
+    uint32_t status = GPIO.STATUS;
+    GPIO.STATUS_CLEAR = status;
+
+    for (uint8_t pin = 0; pin < SIM_GPIO_PINS; pin++) {
+        if ((status & BIT(pin)) && gpio_handlers[pin] != NULL) {
+            gpio_handlers[pin](pin);
+        }
+    }
+}
+
+void gpio_set_interrupt(const uint8_t gpio_num, const gpio_inttype_t int_type, gpio_interrupt_handler_t handler)
+{
+    gpio_inttype[gpio_num] = int_type;
+    gpio_handlers[gpio_num] = handler;
+    if (int_type != GPIO_INTTYPE_NONE) {
+        _xt_isr_attach(INUM_GPIO, gpio_interrupt_handler, NULL);
+        _xt_isr_unmask(BIT(INUM_GPIO));
+    }
+}
+
+static bool gpio_edge_matches(gpio_inttype_t type, bool level)
+{
+    switch (type) {
+    case GPIO_INTTYPE_EDGE_POS:
+    case GPIO_INTTYPE_LEVEL_HIGH:
+        return level;
+    case GPIO_INTTYPE_EDGE_NEG:
+    case GPIO_INTTYPE_LEVEL_LOW:
+        return !level;
+    case GPIO_INTTYPE_EDGE_ANY:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void sim_gpio_set_input(uint8_t pin, bool level)
+{
+    if (((gpio_inputs >> pin) & 1) == level) {
+        return;
+    }
+    gpio_inputs ^= BIT(pin);
+    gpio_update();
+    if (!(sim_gpio_regs.ENABLE_OUT & BIT(pin)) && gpio_edge_matches(gpio_inttype[pin], level)) {
+        sim_gpio_regs.STATUS |= BIT(pin);
+        isr_raise(INUM_GPIO);
+    }
+}
+
+// ---- FRC1 ----
+
+static uint64_t frc1_ticks_to_ns(uint64_t ticks)
+{
+    return (ticks * frc1.prescale * 1000 + SIM_CPU_MHZ - 1) / SIM_CPU_MHZ;
+}
+
+static uint32_t frc1_count(void)
+{
+    if (!frc1.run) {
+        return frc1.remaining;
+    }
+    uint64_t elapsed = (sim_now_ns - frc1.since) * SIM_CPU_MHZ / (1000ull * frc1.prescale);
+    return elapsed >= frc1.remaining ? 0 : frc1.remaining - (uint32_t)elapsed;
+}
+
+uint32_t timer_get_count(const timer_frc_t frc)
+{
+    return frc == FRC1 ? frc1_count() : 0;
+}
+
+uint32_t timer_get_load(const timer_frc_t frc)
+{
+    return frc == FRC1 ? frc1.load : 0;
+}
+
+void timer_set_load(const timer_frc_t frc, const uint32_t load)
+{
+    if (frc != FRC1) {
+        return;
+    }
+    frc1.load = load & TIMER_FRC1_MAX_LOAD;
+    frc1.remaining = frc1.load;
+    frc1.since = sim_now_ns;
+    frc1.expired = false;
+}
+
+void timer_set_divider(const timer_frc_t frc, const timer_clkdiv_t div)
+{
+    if (frc == FRC1) {
+        frc1.remaining = frc1_count();
+        frc1.since = sim_now_ns;
+        frc1.prescale = 1u << div;
+    }
+}
+
+void timer_set_reload(const timer_frc_t frc, const bool reload)
+{
+    if (frc == FRC1) {
+        frc1.reload = reload;
+    }
+}
+
+void timer_set_interrupts(const timer_frc_t frc, bool enable)
+{
+    if (frc != FRC1) {
+        return;
+    }
+    frc1.interrupts = enable;
+    if (enable) {
+        _xt_isr_unmask(BIT(INUM_TIMER_FRC1));
+    } else {
+        _xt_isr_mask(BIT(INUM_TIMER_FRC1));
+        isr_pending &= ~BIT(INUM_TIMER_FRC1);
+    }
+}
+
+void timer_set_run(const timer_frc_t frc, const bool run)
+{
+    if (frc != FRC1 || frc1.run == run) {
+        return;
+    }
+    frc1.remaining = frc1_count();
+    frc1.since = sim_now_ns;
+    frc1.run = run;
+}
+
+bool timer_get_run(const timer_frc_t frc)
+{
+    return frc == FRC1 && frc1.run;
+}
+
+uint64_t sim_hw_next_event(void)
+{
+    if (!frc1.run || !frc1.interrupts || frc1.expired) {
+        return SIM_NEVER;
+    }
+    return frc1.since + frc1_ticks_to_ns(frc1.remaining);
+}
+
+void sim_hw_run_due(void)
+{
+    uint64_t due = sim_hw_next_event();
+
+    if (due > sim_now_ns) {
+        return;
+    }
+    if (frc1.reload) {
+        frc1.remaining = frc1.load;
+        frc1.since = due;
+    } else {
+        frc1.remaining = 0;
+        frc1.since = due;
+        frc1.expired = true;
+    }
+    isr_raise(INUM_TIMER_FRC1);
+}
+
+// ---- I2C / PCF8574 ----
+
+static void expander_update_int(void)
+{
+    bool asserted = false;
+    for (int chip = 0; chip < SIM_EXPANDER_COUNT; chip++) {
+        asserted |= expander_inputs[chip] != expander_read[chip];
+    }
+    // INT là open-drain, tích cực mức thấp
+    sim_gpio_set_input(SIM_EXPANDER_INT_PIN, !asserted);
+}
+
+void sim_expander_set_input(uint8_t chip, uint8_t pin, bool level)
+{
+    if (level) {
+        expander_inputs[chip] |= BIT(pin);
+    } else {
+        expander_inputs[chip] &= ~BIT(pin);
+    }
+    expander_update_int();
+}
+
+void sim_expander_fail(uint32_t reads)
+{
+    expander_failures = reads;
+}
+
+int i2c_init(uint8_t bus, uint8_t scl_pin, uint8_t sda_pin, i2c_freq_t freq)
+{
+    return 0;
+}
+
+size_t pcf8574_port_read_buf(i2c_dev_t *dev, void *buf, size_t len)
+{
+    int chip = dev->addr - SIM_EXPANDER_ADDR;
+
+    if (chip < 0 || chip >= SIM_EXPANDER_COUNT || len == 0) {
+        return 0;
+    }
+    // Lỗi không xóa INT, như i2c_slave_read() trả về -EBUSY
+    if (expander_failures > 0) {
+        expander_failures--;
+        return 0;
+    }
+    memset(buf, expander_inputs[chip], len);
+    expander_read[chip] = expander_inputs[chip];
+    expander_reads++;
+    expander_update_int();
+    return len;
+}
+
+size_t pcf8574_port_write_buf(const i2c_dev_t *dev, void *buf, size_t len)
+{
+    int chip = dev->addr - SIM_EXPANDER_ADDR;
+    return chip >= 0 && chip < SIM_EXPANDER_COUNT ? len : 0;
+}
+
+// ---- ADC ----
+
+int16_t sim_analog_set_input(uint8_t channel, int16_t value)
+{
+    int16_t previous = analog_inputs[channel];
+    analog_inputs[channel] = value;
+    return previous;
+}
+
+uint16_t sdk_system_adc_read(void)
+{
+    adc_reads++;
+    return analog_inputs[0];
+}
+
+void ads111x_start_conversion(i2c_dev_t *dev)
+{
+    if (dev->addr == ADS111X_ADDR_GND) {
+        ads_conversion = analog_inputs[1];
+        ads_conversions++;
+    }
+}
+
+int16_t ads111x_get_value(i2c_dev_t *dev)
+{
+    return dev->addr == ADS111X_ADDR_GND ? ads_conversion : 0;
+}
+
+void ads111x_set_gain(i2c_dev_t *dev, ads111x_gain_t gain)
+{
+}
+
+void ads111x_set_input_mux(i2c_dev_t *dev, ads111x_mux_t mux)
+{
+}
+
+void ads111x_set_mode(i2c_dev_t *dev, ads111x_mode_t mode)
+{
+}
+
+void ads111x_set_data_rate(i2c_dev_t *dev, ads111x_data_rate_t rate)
+{
+}
+
+// ---- Cảm biến khí ----
+
+int32_t sim_gas_set_input(uint8_t feature, int32_t value)
+{
+    int32_t previous = gas_inputs[feature];
+    gas_inputs[feature] = value;
+    return previous;
+}
+
+bme680_sensor_t *bme680_init_sensor(uint8_t bus, uint8_t addr, uint8_t cs)
+{
+    return addr == bme680.addr ? &bme680 : NULL;
+}
+
+bool bme680_force_measurement(bme680_sensor_t *dev)
+{
+    bme680_latched.temperature = gas_inputs[FIRE_FUSION_TEMP];
+    bme680_latched.humidity = gas_inputs[FIRE_FUSION_HUMIDITY] * 10;
+    bme680_latched.gas_resistance = gas_inputs[FIRE_FUSION_GAS];
+    bme680_measurements++;
+    return true;
+}
+
+uint32_t bme680_get_measurement_duration(const bme680_sensor_t *dev)
+{
+    return 20; // 200 ms ở tick 10 ms
+}
+
+bool bme680_get_results_fixed(bme680_sensor_t *dev, bme680_values_fixed_t *results)
+{
+    *results = bme680_latched;
+    return true;
+}
+
+bool bme680_set_oversampling_rates(bme680_sensor_t *dev, bme680_oversampling_rate_t osr_t,
+                                   bme680_oversampling_rate_t osr_p, bme680_oversampling_rate_t osr_h)
+{
+    return true;
+}
+
+bool bme680_set_heater_profile(bme680_sensor_t *dev, uint8_t profile, uint16_t temperature, uint16_t duration)
+{
+    return true;
+}
+
+bool bme680_use_heater_profile(bme680_sensor_t *dev, int8_t profile)
+{
+    return true;
+}
+
+ccs811_sensor_t *ccs811_init_sensor(uint8_t bus, uint8_t addr)
+{
+    return addr == ccs811.addr ? &ccs811 : NULL;
+}
+
+bool ccs811_set_mode(ccs811_sensor_t *sensor, ccs811_mode_t mode)
+{
+    sensor->mode = mode;
+    return true;
+}
+
+bool ccs811_get_results(ccs811_sensor_t *sensor, uint16_t *iaq_tvoc, uint16_t *iaq_eco2, uint8_t *raw_i,
+                        uint16_t *raw_v)
+{
+    if (sensor->mode == ccs811_mode_idle) {
+        return false;
+    }
+    *iaq_tvoc = gas_inputs[FIRE_FUSION_TVOC];
+    *iaq_eco2 = gas_inputs[FIRE_FUSION_ECO2];
+    ccs811_reads++;
+    return true;
+}
+
+bool ccs811_set_environmental_data(ccs811_sensor_t *sensor, float temperature, float humidity)
+{
+    return true;
+}
+
+sht3x_sensor_t *sht3x_init_sensor(uint8_t bus, uint8_t addr)
+{
+    return addr == sht3x.addr ? &sht3x : NULL;
+}
+
+bool sht3x_start_measurement(sht3x_sensor_t *dev, sht3x_mode_t mode, sht3x_repeat_t repeat)
+{
+    dev->mode = mode;
+    return true;
+}
+
+bool sht3x_get_results(sht3x_sensor_t *dev, float *temperature, float *humidity)
+{
+    *temperature = gas_inputs[FIRE_FUSION_TEMP] / 100.0f;
+    *humidity = gas_inputs[FIRE_FUSION_HUMIDITY] / 100.0f;
+    sht3x_reads++;
+    return true;
+}
+
+// ---- Flash SPI (../test/host/spiflash_host.c) ----
+
+// Như app_main: vùng sysparam ngay dưới 5 sector cấu hình của SDK ở cuối flash
+bool sim_hw_sysparam_init(void)
+{
+    uint32_t size = sdk_flashchip.chip_size;
+    uint32_t addr = size - (5 + DEFAULT_SYSPARAM_SECTORS) * SPI_FLASH_SECTOR_SIZE;
+
+    if (sysparam_init(addr, size) == SYSPARAM_OK) {
+        return true;
+    }
+    return sysparam_create_area(addr, DEFAULT_SYSPARAM_SECTORS, false) == SYSPARAM_OK &&
+           sysparam_init(addr, 0) == SYSPARAM_OK;
+}
+
+bool sim_hw_init(const char *flash_image)
+{
+    uint32_t size = SIM_FLASH_SIZE;
+    struct stat st;
+
+    // Ảnh đã có giữ nguyên kích thước; ảnh mới là flash 4 MB đã xóa
+    if (flash_image != NULL && stat(flash_image, &st) == 0 && st.st_size > 0) {
+        size = 0;
+    }
+    if (!spiflash_host_open(flash_image, size)) {
+        return false;
+    }
+    gpio_update();
+    return true;
+}
+
+void sim_hw_shutdown(void)
+{
+    spiflash_host_close();
+}
+
+void sim_hw_report(FILE *out)
+{
+    fprintf(out, "# isr gpio %u (%.1f us cpu), frc1 %u (%.1f us cpu)\n",
+            isr_table[INUM_GPIO].count, isr_table[INUM_GPIO].cpu_ns / 1e3,
+            isr_table[INUM_TIMER_FRC1].count, isr_table[INUM_TIMER_FRC1].cpu_ns / 1e3);
+    fprintf(out, "# pcf8574 reads %u, flash writes %u (%llu bytes), erases %u, busy %.1f ms\n",
+            expander_reads, spiflash_host_stats.writes, (unsigned long long)spiflash_host_stats.write_bytes,
+            spiflash_host_stats.erases, spiflash_host_stats.busy_ns / 1e6);
+    fprintf(out, "# adc reads %u, ads111x conversions %u\n", adc_reads, ads_conversions);
+    fprintf(out, "# bme680 measurements %u, ccs811 reads %u, sht3x reads %u\n",
+            bme680_measurements, ccs811_reads, sht3x_reads);
+}
@@ -0,0 +1,704 @@
+// Chương trình chính của bộ mô phỏng: đọc kịch bản kích thích, chạy user_init()
+// của ứng dụng trong thời gian ảo và ghi vết mọi thay đổi LED.
+//
+// Kịch bản, mỗi dòng một lệnh (# là chú thích):
+//   <t> gpio <pin> <0|1>              đặt mức một chân GPIO
+//   <t> pcf <chip> <pin> <0|1>        đặt mức một chân PCF8574
+//   <t> i2c fail <n>                  n lần đọc PCF8574 tiếp theo lỗi như bus bận
+//   <t> pulse <pin> <0|1> <độ rộng>   xung trên chân GPIO rồi trở về mức cũ
+//   <t> adc <kênh> <giá trị>          đặt đầu vào analog (0 = TOUT, 1 = ADS111x AIN0)
+//   <t> gas <đặc trưng> <giá trị>     đặt kết quả cảm biến khí (gas, tvoc, eco2, temp, rh)
+//   <t> wifi up <rtt> [mã HTTP]       kết nối Wi-Fi (server trả mã HTTP, mặc định 200)
+//   <t> wifi down                     mất Wi-Fi
+//   <t> expect <LED> <0|1|blink>      kiểm tra LED tại thời điểm t
+//   <t> end                           kết thúc mô phỏng
+//   expect alarms <n>                 số lần báo động khi kết thúc
+//   expect latency <thời gian>        độ trễ báo động lớn nhất
+//   expect cpu <task> <us>            CPU host trung bình mỗi lần chạy của task
+//   param <khóa> <giá trị>            giá trị sysparam (chuỗi) có sẵn trước user_init()
+// Thời gian có đơn vị us, ms (mặc định) hoặc s; "+t" tính từ dòng trước.
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "espressif/esp_system.h"
+#include "fire_health.h"
+#include "fire_power.h"
+#include "fire_fusion.h"
+#include "led_manager.h"
+#include "sim.h"
+#include "sysparam.h"
+
+#define SIM_MAX_STEPS   1024
+#define SIM_MAX_CHECKS  32
+#define SIM_MAX_ALARMS  256
+#define SIM_MAX_PARAMS  16
+#define SIM_GPIO_PINS   16
+// LED báo cháy tắt lâu hơn khoảng này thì lần bật sau là một lần báo động mới
+// (lớn hơn chu kỳ nhấp nháy khi báo động)
+#define SIM_ALARM_GAP_NS (1000 * SIM_MS)
+// Cửa sổ để coi một LED là đang nhấp nháy: ít nhất hai lần đổi mức
+#define SIM_BLINK_WINDOW_NS (1000 * SIM_MS)
+#define SIM_DEFAULT_END_NS  (10000 * SIM_MS)
+
+typedef enum {
+    STEP_GPIO,
+    STEP_PCF,
+    STEP_I2C_FAIL,
+    STEP_ADC,
+    STEP_GAS,
+    STEP_WIFI_UP,
+    STEP_WIFI_DOWN,
+    STEP_EXPECT_LED,
+    STEP_END,
+} step_type_t;
+
+// Một lệnh có thời điểm của kịch bản
+// One timed stimulus line (a pulse becomes two steps)
+typedef struct {
+    uint64_t at;
+    uint32_t order;          // Line order, keeps equal times stable after sorting
+    step_type_t type;
+    uint8_t pin;
+    uint8_t chip;
+    int level;               // 0, 1, or 2 for "blink" in expectations; ADC counts for adc, reading for gas
+    uint32_t rtt_ms;
+    uint16_t http_status;
+    int line;
+} sim_step_t;
+
+typedef enum {
+    CHECK_ALARMS,
+    CHECK_LATENCY,
+    CHECK_CPU,
+} check_type_t;
+
+typedef struct {
+    check_type_t type;
+    char task[24];
+    uint64_t limit;          // Count, latency in ns, or CPU in ns per activation
+    int line;
+} sim_check_t;
+
+// Giá trị sysparam của kịch bản, ghi trước khi ứng dụng khởi động
+// Sysparam value of the stimulus, written before the application starts
+typedef struct {
+    char key[32];
+    char value[64];
+    int line;
+} sim_param_t;
+
+extern void user_init(void);
+
+static const struct {
+    const char *name;
+    uint8_t pin;
+} led_pins[] = {
+    { "BLUE", LED_BLUE },
+    { "SIM", LED_SIM },
+    { "FAULT", LED_FAULT },
+    { "FIRE", LED_FIRE },
+};
+
+static sim_step_t steps[SIM_MAX_STEPS];
+static int step_count;
+static sim_check_t checks[SIM_MAX_CHECKS];
+static int check_count;
+static sim_param_t params[SIM_MAX_PARAMS];
+static int param_count;
+static uint64_t end_ns = SIM_NEVER;
+
+static FILE *trace_out;
+static int failures;
+
+// Lịch sử đầu ra để kiểm tra nhấp nháy
+static uint64_t output_changes[SIM_GPIO_PINS][2]; // Two most recent change times
+static bool output_level[SIM_GPIO_PINS];
+
+// Độ trễ báo động: từ cạnh đầu vào tích cực cuối cùng tới lúc LED báo cháy bật
+static uint64_t last_active_edge = SIM_NEVER;
+static uint64_t fire_off_since;
+static bool fire_seen;
+static uint64_t alarm_latency[SIM_MAX_ALARMS];
+static int alarm_count;
+
+static const char *pin_name(uint8_t pin, char *buf, size_t size)
+{
+    for (size_t i = 0; i < sizeof(led_pins) / sizeof(led_pins[0]); i++) {
+        if (led_pins[i].pin == pin) {
+            return led_pins[i].name;
+        }
+    }
+    snprintf(buf, size, "gpio%u", pin);
+    return buf;
+}
+
+static bool led_pin(const char *name, uint8_t *pin)
+{
+    for (size_t i = 0; i < sizeof(led_pins) / sizeof(led_pins[0]); i++) {
+        if (strcmp(led_pins[i].name, name) == 0) {
+            *pin = led_pins[i].pin;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sim_trace_output(uint8_t pin, bool level)
+{
+    char buf[8];
+
+    fprintf(trace_out, "%llu led %s %d\n", (unsigned long long)(sim_now_ns / SIM_US),
+            pin_name(pin, buf, sizeof(buf)), level);
+    if (pin < SIM_GPIO_PINS) {
+        output_changes[pin][1] = output_changes[pin][0];
+        output_changes[pin][0] = sim_now_ns;
+        output_level[pin] = level;
+    }
+
+    if (pin != LED_FIRE) {
+        return;
+    }
+    if (level) {
+        bool new_alarm = !fire_seen || sim_now_ns - fire_off_since >= SIM_ALARM_GAP_NS;
+        fire_seen = true;
+        if (new_alarm && last_active_edge != SIM_NEVER && alarm_count < SIM_MAX_ALARMS) {
+            alarm_latency[alarm_count++] = sim_now_ns - last_active_edge;
+        }
+    } else {
+        fire_off_since = sim_now_ns;
+    }
+}
+
+// ---- Kịch bản ----
+
+static bool parse_time(const char *text, uint64_t *ns)
+{
+    char *end;
+    double value = strtod(text, &end);
+
+    if (end == text || value < 0) {
+        return false;
+    }
+    if (*end == '\0' || strcmp(end, "ms") == 0) {
+        *ns = (uint64_t)(value * SIM_MS);
+    } else if (strcmp(end, "us") == 0) {
+        *ns = (uint64_t)(value * SIM_US);
+    } else if (strcmp(end, "s") == 0) {
+        *ns = (uint64_t)(value * 1000 * SIM_MS);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_level(const char *text, int *level, bool allow_blink)
+{
+    if (strcmp(text, "0") == 0 || strcmp(text, "1") == 0) {
+        *level = text[0] - '0';
+        return true;
+    }
+    if (allow_blink && strcmp(text, "blink") == 0) {
+        *level = 2;
+        return true;
+    }
+    return false;
+}
+
+static sim_step_t *add_step(uint64_t at, step_type_t type, int line)
+{
+    if (step_count == SIM_MAX_STEPS) {
+        return NULL;
+    }
+    sim_step_t *step = &steps[step_count];
+    memset(step, 0, sizeof(*step));
+    step->at = at;
+    step->order = step_count++;
+    step->type = type;
+    step->line = line;
+    return step;
+}
+
+static bool parse_check(char **argv, int argc, int line)
+{
+    if (check_count == SIM_MAX_CHECKS) {
+        return false;
+    }
+    sim_check_t *check = &checks[check_count];
+    check->line = line;
+    if (argc == 2 && strcmp(argv[0], "alarms") == 0) {
+        check->type = CHECK_ALARMS;
+        check->limit = strtoull(argv[1], NULL, 10);
+    } else if (argc == 2 && strcmp(argv[0], "latency") == 0) {
+        check->type = CHECK_LATENCY;
+        if (!parse_time(argv[1], &check->limit)) {
+            return false;
+        }
+    } else if (argc == 3 && strcmp(argv[0], "cpu") == 0) {
+        check->type = CHECK_CPU;
+        snprintf(check->task, sizeof(check->task), "%s", argv[1]);
+        check->limit = (uint64_t)(strtod(argv[2], NULL) * SIM_US);
+    } else {
+        return false;
+    }
+    check_count++;
+    return true;
+}
+
+// Một dòng có thời điểm; argv[0] là lệnh
+static bool parse_step(uint64_t at, char **argv, int argc, int line)
+{
+    sim_step_t *step;
+    int level;
+
+    if (argc == 3 && strcmp(argv[0], "gpio") == 0 && parse_level(argv[2], &level, false)) {
+        if ((step = add_step(at, STEP_GPIO, line)) == NULL) {
+            return false;
+        }
+        step->pin = atoi(argv[1]);
+        step->level = level;
+        return step->pin < SIM_GPIO_PINS;
+    }
+    if (argc == 4 && strcmp(argv[0], "pcf") == 0 && parse_level(argv[3], &level, false)) {
+        if ((step = add_step(at, STEP_PCF, line)) == NULL) {
+            return false;
+        }
+        step->chip = atoi(argv[1]);
+        step->pin = atoi(argv[2]);
+        step->level = level;
+        return step->chip < 8 && step->pin < 8;
+    }
+    if (argc == 3 && strcmp(argv[0], "i2c") == 0 && strcmp(argv[1], "fail") == 0) {
+        if ((step = add_step(at, STEP_I2C_FAIL, line)) == NULL) {
+            return false;
+        }
+        step->level = atoi(argv[2]);
+        return step->level > 0;
+    }
+    if (argc == 4 && strcmp(argv[0], "pulse") == 0 && parse_level(argv[2], &level, false)) {
+        uint64_t width;
+        uint8_t pin = atoi(argv[1]);
+        if (pin >= SIM_GPIO_PINS || !parse_time(argv[3], &width)) {
+            return false;
+        }
+        for (int i = 0; i < 2; i++) {
+            if ((step = add_step(at + i * width, STEP_GPIO, line)) == NULL) {
+                return false;
+            }
+            step->pin = pin;
+            step->level = i == 0 ? level : !level;
+        }
+        return true;
+    }
+    if (argc == 3 && strcmp(argv[0], "adc") == 0) {
+        if ((step = add_step(at, STEP_ADC, line)) == NULL) {
+            return false;
+        }
+        step->chip = atoi(argv[1]);
+        step->level = atoi(argv[2]);
+        return step->chip < 2 && step->level >= INT16_MIN && step->level <= INT16_MAX;
+    }
+    if (argc == 3 && strcmp(argv[0], "gas") == 0) {
+        static const char *const features[FIRE_FUSION_FEATURES] = {
+            [FIRE_FUSION_GAS] = "gas", [FIRE_FUSION_TVOC] = "tvoc", [FIRE_FUSION_ECO2] = "eco2",
+            [FIRE_FUSION_TEMP] = "temp", [FIRE_FUSION_HUMIDITY] = "rh",
+        };
+        for (uint8_t i = 0; i < FIRE_FUSION_FEATURES; i++) {
+            if (strcmp(argv[1], features[i]) == 0) {
+                if ((step = add_step(at, STEP_GAS, line)) == NULL) {
+                    return false;
+                }
+                step->chip = i;
+                step->level = atoi(argv[2]);
+                return true;
+            }
+        }
+        return false;
+    }
+    if ((argc == 3 || argc == 4) && strcmp(argv[0], "wifi") == 0 && strcmp(argv[1], "up") == 0) {
+        uint64_t rtt;
+        if (!parse_time(argv[2], &rtt) || (step = add_step(at, STEP_WIFI_UP, line)) == NULL) {
+            return false;
+        }
+        step->rtt_ms = rtt / SIM_MS;
+        step->http_status = argc == 4 ? atoi(argv[3]) : 200;
+        return true;
+    }
+    if (argc == 2 && strcmp(argv[0], "wifi") == 0 && strcmp(argv[1], "down") == 0) {
+        return add_step(at, STEP_WIFI_DOWN, line) != NULL;
+    }
+    if (argc == 3 && strcmp(argv[0], "expect") == 0 && parse_level(argv[2], &level, true)) {
+        uint8_t pin;
+        if (!led_pin(argv[1], &pin) || (step = add_step(at, STEP_EXPECT_LED, line)) == NULL) {
+            return false;
+        }
+        step->pin = pin;
+        step->level = level;
+        return true;
+    }
+    if (argc == 1 && strcmp(argv[0], "end") == 0) {
+        if (at < end_ns) {
+            end_ns = at;
+        }
+        return true;
+    }
+    return false;
+}
+
+static int compare_steps(const void *a, const void *b)
+{
+    const sim_step_t *x = a, *y = b;
+
+    if (x->at != y->at) {
+        return x->at < y->at ? -1 : 1;
+    }
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+static bool load_stimulus(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char text[256];
+    uint64_t previous = 0;
+    int line = 0;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    while (fgets(text, sizeof(text), file) != NULL) {
+        char *argv[8];
+        int argc = 0;
+
+        line++;
+        char *comment = strchr(text, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        for (char *token = strtok(text, " \t\r\n"); token != NULL && argc < 8; token = strtok(NULL, " \t\r\n")) {
+            argv[argc++] = token;
+        }
+        if (argc == 0) {
+            continue;
+        }
+
+        bool ok;
+        if (strcmp(argv[0], "expect") == 0) {
+            ok = parse_check(argv + 1, argc - 1, line);
+        } else if (strcmp(argv[0], "param") == 0) {
+            ok = argc == 3 && param_count < SIM_MAX_PARAMS;
+            if (ok) {
+                snprintf(params[param_count].key, sizeof(params[0].key), "%s", argv[1]);
+                snprintf(params[param_count].value, sizeof(params[0].value), "%s", argv[2]);
+                params[param_count++].line = line;
+            }
+        } else {
+            uint64_t at;
+            bool relative = argv[0][0] == '+';
+            ok = parse_time(argv[0] + relative, &at);
+            if (ok) {
+                at += relative ? previous : 0;
+                previous = at;
+                ok = parse_step(at, argv + 1, argc - 1, line);
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%d: invalid line\n", path, line);
+            fclose(file);
+            return false;
+        }
+    }
+    fclose(file);
+    qsort(steps, step_count, sizeof(steps[0]), compare_steps);
+    return true;
+}
+
+// ---- Chạy ----
+
+static void fail(int line, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void fail(int line, const char *fmt, ...)
+{
+    va_list args;
+
+    fprintf(trace_out, "# FAIL line %d: ", line);
+    va_start(args, fmt);
+    vfprintf(trace_out, fmt, args);
+    va_end(args);
+    fputc('\n', trace_out);
+    failures++;
+}
+
+// Bộ giám sát task khởi động lại chip: lần chạy dừng ở đây và bị tính là lỗi
+void sdk_system_restart(void)
+{
+    fail(0, "restart requested at %.3f s", sim_now_ns / 1e9);
+    end_ns = sim_now_ns;
+}
+
+static void run_step(const sim_step_t *step)
+{
+    uint64_t now_us = sim_now_ns / SIM_US;
+
+    switch (step->type) {
+    case STEP_GPIO:
+        fprintf(trace_out, "%llu in gpio %u %d\n", (unsigned long long)now_us, step->pin, step->level);
+        // Mọi đầu vào của ứng dụng đều tích cực mức thấp
+        if (!step->level) {
+            last_active_edge = sim_now_ns;
+        }
+        sim_gpio_set_input(step->pin, step->level);
+        break;
+    case STEP_PCF:
+        fprintf(trace_out, "%llu in pcf %u %u %d\n", (unsigned long long)now_us, step->chip, step->pin, step->level);
+        if (!step->level) {
+            last_active_edge = sim_now_ns;
+        }
+        sim_expander_set_input(step->chip, step->pin, step->level);
+        break;
+    case STEP_I2C_FAIL:
+        fprintf(trace_out, "%llu in i2c fail %d\n", (unsigned long long)now_us, step->level);
+        sim_expander_fail(step->level);
+        break;
+    case STEP_ADC:
+        fprintf(trace_out, "%llu in adc %u %d\n", (unsigned long long)now_us, step->chip, step->level);
+        // Cảm biến khói cho giá trị lớn hơn khi có khói
+        if (sim_analog_set_input(step->chip, step->level) < step->level) {
+            last_active_edge = sim_now_ns;
+        }
+        break;
+    case STEP_GAS:
+        fprintf(trace_out, "%llu in gas %u %d\n", (unsigned long long)now_us, step->chip, step->level);
+        // Bộ kết hợp không có một hướng tích cực chung: mọi thay đổi đều tính
+        if (sim_gas_set_input(step->chip, step->level) != step->level) {
+            last_active_edge = sim_now_ns;
+        }
+        break;
+    case STEP_WIFI_UP:
+        fprintf(trace_out, "%llu in wifi up %u %u\n", (unsigned long long)now_us, step->rtt_ms, step->http_status);
+        sim_wifi_set(true, step->rtt_ms, step->http_status);
+        break;
+    case STEP_WIFI_DOWN:
+        fprintf(trace_out, "%llu in wifi down\n", (unsigned long long)now_us);
+        sim_wifi_set(false, 0, 0);
+        break;
+    case STEP_EXPECT_LED: {
+        const uint64_t *changes = output_changes[step->pin];
+        bool blinking = changes[1] != 0 && sim_now_ns - changes[1] <= SIM_BLINK_WINDOW_NS;
+        char buf[8];
+        if (step->level == 2 ? !blinking : output_level[step->pin] != step->level) {
+            fail(step->line, "LED %s expected %s, is %d%s", pin_name(step->pin, buf, sizeof(buf)),
+                 step->level == 2 ? "blink" : step->level ? "1" : "0",
+                 output_level[step->pin], blinking ? " (blinking)" : "");
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static uint64_t min_u64(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
+
+static int next_step;
+
+// Nhảy tới sự kiện kế tiếp và chạy ngắt, kích thích và gói tin đến hạn;
+// trả về false khi hết thời gian mô phỏng
+static bool advance(void)
+{
+    uint64_t next = end_ns;
+    if (next_step < step_count) {
+        next = min_u64(next, steps[next_step].at);
+    }
+    next = min_u64(next, sim_rtos_next_wake());
+    next = min_u64(next, sim_hw_next_event());
+    next = min_u64(next, sim_net_next_event());
+    if (next >= end_ns) {
+        sim_now_ns = end_ns;
+        return false;
+    }
+    if (next > sim_now_ns) {
+        sim_now_ns = next;
+    }
+
+    // Cùng một thời điểm: ngắt phần cứng, kích thích, rồi gói tin
+    sim_hw_run_due();
+    while (next_step < step_count && steps[next_step].at <= sim_now_ns) {
+        run_step(&steps[next_step++]);
+    }
+    sim_net_run_due();
+    return true;
+}
+
+bool sim_finished(void)
+{
+    return sim_now_ns >= end_ns;
+}
+
+void sim_waiti(void)
+{
+    advance();
+}
+
+static void simulate(void)
+{
+    while (1) {
+        sim_rtos_run();
+        // Task idle có thể tự chờ ngắt (WAITI), khi đó thời gian đã trôi
+        if (sim_rtos_idle()) {
+            if (sim_finished()) {
+                break;
+            }
+        } else if (!advance()) {
+            break;
+        }
+        sim_rtos_wake_due();
+    }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : (x > y);
+}
+
+static void report(void)
+{
+    uint64_t sorted[SIM_MAX_ALARMS];
+    uint64_t max_ns = 0;
+
+    memcpy(sorted, alarm_latency, alarm_count * sizeof(sorted[0]));
+    qsort(sorted, alarm_count, sizeof(sorted[0]), compare_u64);
+    if (alarm_count > 0) {
+        max_ns = sorted[alarm_count - 1];
+        fprintf(trace_out, "# alarms %d latency p50 %.1f us max %.1f us\n", alarm_count,
+                sorted[(alarm_count - 1) / 2] / 1e3, max_ns / 1e3);
+    } else {
+        fprintf(trace_out, "# alarms 0\n");
+    }
+    sim_rtos_report(trace_out);
+    sim_hw_report(trace_out);
+    fire_power_stats_t power;
+    fire_power_get_stats(&power);
+    fprintf(trace_out, "# power active %.1f ms idle %.1f ms modem sleep %.1f ms auto light %.1f ms, "
+            "wakes gpio %u timer %u, charge %u uAh\n",
+            power.time_us[FIRE_POWER_ACTIVE] / 1e3, power.time_us[FIRE_POWER_IDLE] / 1e3,
+            power.time_us[FIRE_POWER_MODEM_SLEEP] / 1e3, power.time_us[FIRE_POWER_AUTO_LIGHT] / 1e3,
+            power.wakes[FIRE_POWER_WAKE_GPIO], power.wakes[FIRE_POWER_WAKE_TIMER], fire_power_charge_uah(&power));
+    fire_health_slot_t slots[FIRE_HEALTH_SLOTS];
+    uint32_t slot_count = fire_health_get_stats(slots, FIRE_HEALTH_SLOTS);
+    for (uint32_t i = 0; i < slot_count; i++) {
+        fprintf(trace_out, "# health %-12s beats %6u period %5u ms max %5u ms, silence max %5u ms, stage %d\n",
+                slots[i].name, slots[i].seen_beats, slots[i].period_ms, slots[i].period_max_ms,
+                slots[i].silence_max_ms, slots[i].stage);
+    }
+
+    for (int i = 0; i < check_count; i++) {
+        const sim_check_t *check = &checks[i];
+        uint64_t cpu_ns;
+        uint32_t activations;
+
+        switch (check->type) {
+        case CHECK_ALARMS:
+            if ((uint64_t)alarm_count != check->limit) {
+                fail(check->line, "%d alarms, expected %llu", alarm_count, (unsigned long long)check->limit);
+            }
+            break;
+        case CHECK_LATENCY:
+            if (max_ns > check->limit) {
+                fail(check->line, "alarm latency %.1f us over %.1f us", max_ns / 1e3, check->limit / 1e3);
+            }
+            break;
+        case CHECK_CPU:
+            if (!sim_rtos_task_stats(check->task, &cpu_ns, &activations)) {
+                fail(check->line, "no task %s", check->task);
+            } else if (activations > 0 && cpu_ns / activations > check->limit) {
+                fail(check->line, "task %s uses %.1f us per activation, budget %.1f us", check->task,
+                     (double)cpu_ns / activations / 1e3, check->limit / 1e3);
+            }
+            break;
+        }
+    }
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-q] [-c console.log] [-d duration] [-f flash.img] stimulus\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *console = NULL;
+    const char *flash_image = NULL;
+    bool quiet = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qc:d:f:")) != -1) {
+        switch (opt) {
+        case 'q':
+            quiet = true;
+            break;
+        case 'c':
+            console = optarg;
+            break;
+        case 'd':
+            if (!parse_time(optarg, &end_ns)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'f':
+            flash_image = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+    }
+    if (!load_stimulus(argv[optind])) {
+        return 2;
+    }
+    if (end_ns == SIM_NEVER) {
+        end_ns = SIM_DEFAULT_END_NS;
+    }
+
+    // Vết ra stdout; printf của ứng dụng (UART) ra stderr, file hoặc bị bỏ
+    trace_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (trace_out == NULL || freopen(console != NULL ? console : quiet ? "/dev/null" : "/dev/stderr",
+                                     "w", stdout) == NULL) {
+        perror("console");
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (!sim_hw_init(flash_image)) {
+        fprintf(stderr, "%s: cannot map the flash image\n", flash_image);
+        return 2;
+    }
+    sim_rtos_init();
+    sim_net_init();
+    if (!sim_hw_sysparam_init()) {
+        fail(0, "sysparam area could not be created");
+    }
+    for (int i = 0; i < param_count; i++) {
+        if (sysparam_set_string(params[i].key, params[i].value) != SYSPARAM_OK) {
+            fail(params[i].line, "could not store param %s", params[i].key);
+        }
+    }
+    user_init();
+    simulate();
+    report();
+
+    fflush(stdout);
+    fflush(trace_out);
+    sim_hw_shutdown();
+    // Các thread của task vẫn đang chờ: kết thúc mà không hủy chúng
+    _exit(failures ? 1 : 0);
+}
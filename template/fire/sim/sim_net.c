@@ -0,0 +1,429 @@
+// Mạng của bộ mô phỏng: thread tcpip, raw API TCP/DNS với một server HTTP giả
+// lập, Wi-Fi do kịch bản bật/tắt. Gói tin tới được đưa vào mailbox của thread
+// tcpip đúng thời điểm ảo của nó, như driver Wi-Fi trên thiết bị.
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "espressif/esp_common.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "lwip/tcpip.h"
+#include "lwip/tcp.h"
+#include "lwip/dns.h"
+#include "lwip/timeouts.h"
+#include "lwip/netdb.h"
+#include "sim.h"
+
+// Như lwipopts.h của esp-open-rtos
+#define SIM_TCPIP_THREAD_PRIO      (configMAX_PRIORITIES - 5)
+#define SIM_TCPIP_THREAD_STACKSIZE 480
+#define SIM_TCPIP_MBOX_SIZE        16
+// Chu kỳ timer chậm của TCP (đơn vị của tcp_poll)
+#define SIM_TCP_SLOW_INTERVAL_MS   500
+
+#define SIM_TCP_PCBS   4
+#define SIM_NET_EVENTS 16
+
+// Địa chỉ mọi tên miền được phân giải tới
+#define SIM_SERVER_ADDR 0x0100000a // 10.0.0.1
+
+struct tcp_pcb {
+    bool used;
+    uint32_t gen;            // Bumped on every allocation, stale events are dropped
+    void *arg;
+    tcp_recv_fn recv;
+    tcp_err_fn err;
+    tcp_poll_fn poll;
+    u8_t poll_interval;
+    bool poll_scheduled;
+    tcp_connected_fn connected;
+};
+
+typedef enum {
+    NET_DNS,       // DNS answer arrives
+    NET_CONNECTED, // SYN-ACK arrives
+    NET_RESPONSE,  // HTTP response arrives
+    NET_POLL,      // TCP slow timer polls the connection
+    NET_TIMEOUT,   // sys_timeout() expires
+} net_event_type_t;
+
+// Gói tin hoặc timer của lwIP chờ tới thời điểm của nó
+// A packet or lwIP timer waiting for its virtual time
+typedef struct {
+    bool used;
+    bool posted;             // Handed to the tcpip thread, not yet delivered
+    uint64_t at;
+    net_event_type_t type;
+    struct tcp_pcb *pcb;
+    uint32_t gen;
+    dns_found_callback dns_found;
+    const char *name;
+    void *dns_arg;
+    sys_timeout_handler timeout;  // NULL once cancelled by sys_untimeout
+    void *timeout_arg;
+} net_event_t;
+
+typedef struct {
+    tcpip_callback_fn function;
+    void *ctx;
+} tcpip_msg_t;
+
+static QueueHandle_t tcpip_mbox;
+static struct tcp_pcb pcbs[SIM_TCP_PCBS];
+static net_event_t events[SIM_NET_EVENTS];
+
+static bool wifi_up;
+static uint64_t wifi_rtt_ns;
+static uint16_t http_status = 200;
+static char http_response[64];
+static uint8_t wifi_opmode;
+static enum sdk_sleep_type wifi_sleep_type = WIFI_SLEEP_MODEM; // Mặc định của SDK
+static char wifi_ssid[33];
+
+static void tcpip_thread(void *arg)
+{
+    tcpip_msg_t msg;
+
+    while (1) {
+        if (xQueueReceive(tcpip_mbox, &msg, portMAX_DELAY) == pdTRUE) {
+            msg.function(msg.ctx);
+        }
+    }
+}
+
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx)
+{
+    tcpip_msg_t msg = { function, ctx };
+    return xQueueSend(tcpip_mbox, &msg, portMAX_DELAY) == pdPASS ? ERR_OK : ERR_MEM;
+}
+
+err_t tcpip_try_callback(tcpip_callback_fn function, void *ctx)
+{
+    tcpip_msg_t msg = { function, ctx };
+    return xQueueSend(tcpip_mbox, &msg, 0) == pdPASS ? ERR_OK : ERR_MEM;
+}
+
+// ---- Sự kiện mạng ----
+
+static net_event_t *schedule(net_event_type_t type, struct tcp_pcb *pcb, uint64_t delay_ns)
+{
+    for (int i = 0; i < SIM_NET_EVENTS; i++) {
+        if (!events[i].used) {
+            memset(&events[i], 0, sizeof(events[i]));
+            events[i].used = true;
+            events[i].at = sim_now_ns + delay_ns;
+            events[i].type = type;
+            events[i].pcb = pcb;
+            events[i].gen = pcb != NULL ? pcb->gen : 0;
+            return &events[i];
+        }
+    }
+    fprintf(stderr, "sim: network event table full\n");
+    return NULL;
+}
+
+static void schedule_poll(struct tcp_pcb *pcb)
+{
+    if (pcb->poll != NULL && !pcb->poll_scheduled &&
+        schedule(NET_POLL, pcb, (uint64_t)pcb->poll_interval * SIM_TCP_SLOW_INTERVAL_MS * SIM_MS) != NULL) {
+        pcb->poll_scheduled = true;
+    }
+}
+
+static bool pcb_alive(const net_event_t *event)
+{
+    return event->pcb->used && event->pcb->gen == event->gen;
+}
+
+// Chạy trong thread tcpip
+static void deliver(void *ctx)
+{
+    net_event_t event = *(net_event_t *)ctx;
+    ((net_event_t *)ctx)->used = false;
+
+    if (event.type == NET_DNS) {
+        ip_addr_t addr = { SIM_SERVER_ADDR };
+        event.dns_found(event.name, &addr, event.dns_arg);
+        return;
+    }
+    if (event.type == NET_TIMEOUT) {
+        if (event.timeout != NULL) {
+            event.timeout(event.timeout_arg);
+        }
+        return;
+    }
+    if (!pcb_alive(&event)) {
+        return;
+    }
+    struct tcp_pcb *pcb = event.pcb;
+    switch (event.type) {
+    case NET_CONNECTED:
+        if (pcb->connected != NULL) {
+            pcb->connected(pcb->arg, pcb, ERR_OK);
+        }
+        break;
+    case NET_RESPONSE:
+        if (pcb->recv != NULL) {
+            struct pbuf p = {
+                .next = NULL,
+                .payload = http_response,
+                .tot_len = strlen(http_response),
+                .len = strlen(http_response),
+            };
+            pcb->recv(pcb->arg, pcb, &p, ERR_OK);
+        }
+        break;
+    case NET_POLL:
+        pcb->poll_scheduled = false;
+        if (pcb->poll != NULL && pcb->poll(pcb->arg, pcb) != ERR_ABRT && pcb_alive(&event)) {
+            schedule_poll(pcb);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+uint64_t sim_net_next_event(void)
+{
+    uint64_t next = SIM_NEVER;
+
+    for (int i = 0; i < SIM_NET_EVENTS; i++) {
+        if (events[i].used && !events[i].posted && events[i].at < next) {
+            next = events[i].at;
+        }
+    }
+    return next;
+}
+
+void sim_net_run_due(void)
+{
+    // Theo thứ tự thời gian, như gói tin tới trên đường truyền
+    uint64_t next;
+    while ((next = sim_net_next_event()) <= sim_now_ns) {
+        for (int i = 0; i < SIM_NET_EVENTS; i++) {
+            if (events[i].used && !events[i].posted && events[i].at == next) {
+                tcpip_msg_t msg = { deliver, &events[i] };
+                events[i].posted = true;
+                if (xQueueSendFromISR(tcpip_mbox, &msg, NULL) != pdPASS) {
+                    events[i].used = false;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void sim_wifi_set(bool up, uint32_t rtt_ms, uint16_t status)
+{
+    wifi_up = up;
+    if (up) {
+        wifi_rtt_ns = (uint64_t)rtt_ms * SIM_MS;
+        http_status = status;
+        snprintf(http_response, sizeof(http_response),
+                 "HTTP/1.1 %u Sim\r\nContent-Length: 0\r\n\r\n", http_status);
+        return;
+    }
+    // Gói tin đang trên đường truyền bị mất; timer của lwIP vẫn chạy
+    for (int i = 0; i < SIM_NET_EVENTS; i++) {
+        if (events[i].used && !events[i].posted && events[i].type != NET_POLL && events[i].type != NET_TIMEOUT) {
+            events[i].used = false;
+        }
+    }
+}
+
+void sim_net_init(void)
+{
+    tcpip_mbox = xQueueCreate(SIM_TCPIP_MBOX_SIZE, sizeof(tcpip_msg_t));
+    xTaskCreate(tcpip_thread, "tcpip_thread", SIM_TCPIP_THREAD_STACKSIZE, NULL, SIM_TCPIP_THREAD_PRIO, NULL);
+}
+
+// ---- Wi-Fi ----
+
+bool sdk_wifi_set_opmode(uint8_t opmode)
+{
+    wifi_opmode = opmode;
+    return true;
+}
+
+bool sdk_wifi_station_set_config(struct sdk_station_config *config)
+{
+    if (wifi_opmode != STATION_MODE && wifi_opmode != STATIONAP_MODE) {
+        return false;
+    }
+    memcpy(wifi_ssid, config->ssid, sizeof(config->ssid));
+    wifi_ssid[sizeof(config->ssid)] = '\0';
+    return true;
+}
+
+bool sdk_wifi_station_connect(void)
+{
+    return true;
+}
+
+bool sdk_wifi_station_disconnect(void)
+{
+    return true;
+}
+
+// Chế độ ngủ của radio chỉ được ghi nhận: kịch bản không mô phỏng độ trễ DTIM
+bool sdk_wifi_set_sleep_type(enum sdk_sleep_type type)
+{
+    wifi_sleep_type = type;
+    return true;
+}
+
+enum sdk_sleep_type sdk_wifi_get_sleep_type(void)
+{
+    return wifi_sleep_type;
+}
+
+// ---- Raw API ----
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg)
+{
+    // Chưa kết nối Wi-Fi thì chưa có DNS server
+    if (!wifi_up) {
+        return ERR_ARG;
+    }
+    net_event_t *event = schedule(NET_DNS, NULL, wifi_rtt_ns);
+    if (event == NULL) {
+        return ERR_MEM;
+    }
+    event->dns_found = found;
+    event->name = hostname;
+    event->dns_arg = callback_arg;
+    return ERR_INPROGRESS;
+}
+
+// Timer một lần của lwIP, chạy trong thread tcpip như sys_timeouts_mbox_fetch
+void sys_timeout(uint32_t msecs, sys_timeout_handler handler, void *arg)
+{
+    net_event_t *event = schedule(NET_TIMEOUT, NULL, (uint64_t)msecs * SIM_MS);
+    if (event != NULL) {
+        event->timeout = handler;
+        event->timeout_arg = arg;
+    }
+}
+
+// Hủy mọi timer còn chờ của handler/arg, kể cả timer đã vào mailbox
+void sys_untimeout(sys_timeout_handler handler, void *arg)
+{
+    for (int i = 0; i < SIM_NET_EVENTS; i++) {
+        if (events[i].used && events[i].type == NET_TIMEOUT && events[i].timeout == handler &&
+            events[i].timeout_arg == arg) {
+            events[i].timeout = NULL;
+            if (!events[i].posted) {
+                events[i].used = false;
+            }
+        }
+    }
+}
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type)
+{
+    for (int i = 0; i < SIM_TCP_PCBS; i++) {
+        if (!pcbs[i].used) {
+            uint32_t gen = pcbs[i].gen + 1;
+            memset(&pcbs[i], 0, sizeof(pcbs[i]));
+            pcbs[i].used = true;
+            pcbs[i].gen = gen;
+            return &pcbs[i];
+        }
+    }
+    return NULL;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg)
+{
+    pcb->arg = arg;
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv)
+{
+    pcb->recv = recv;
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err)
+{
+    pcb->err = err;
+}
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval)
+{
+    pcb->poll = poll;
+    pcb->poll_interval = interval ? interval : 1;
+    schedule_poll(pcb);
+}
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, tcp_connected_fn connected)
+{
+    pcb->connected = connected;
+    // Khi mất Wi-Fi, SYN bị mất và chỉ timer poll của ứng dụng kết thúc được kết nối
+    if (wifi_up) {
+        schedule(NET_CONNECTED, pcb, wifi_rtt_ns);
+    }
+    return ERR_OK;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags)
+{
+    return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb)
+{
+    // Server giả lập trả lời mọi request bằng một phản hồi không có body
+    if (wifi_up) {
+        schedule(NET_RESPONSE, pcb, wifi_rtt_ns);
+    }
+    return ERR_OK;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len)
+{
+}
+
+err_t tcp_close(struct tcp_pcb *pcb)
+{
+    pcb->used = false;
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb)
+{
+    tcp_err_fn err = pcb->err;
+    void *arg = pcb->arg;
+
+    pcb->used = false;
+    if (err != NULL) {
+        err(arg, ERR_ABRT);
+    }
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+    return 1;
+}
+
+// ---- Socket ----
+
+// Mạng giả lập chỉ phục vụ raw API; client dùng socket (MQTT, sim_monitor_task)
+// luôn thấy phân giải tên thất bại
+int lwip_getaddrinfo(const char *nodename, const char *servname, const struct addrinfo *hints,
+                     struct addrinfo **res)
+{
+    *res = NULL;
+    return EAI_FAIL;
+}
+
+void lwip_freeaddrinfo(struct addrinfo *ai)
+{
+}
+
+int lwip_socket(int domain, int type, int protocol)
+{
+    errno = ENETUNREACH;
+    return -1;
+}
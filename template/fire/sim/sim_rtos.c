@@ -0,0 +1,743 @@
+// Bản thay thế FreeRTOS cho bộ mô phỏng.
+// Mỗi task là một pthread nhưng chỉ task được bộ lập lịch trao CPU mới chạy,
+// như lập lịch hợp tác của ứng dụng (configUSE_PREEMPTION 0): task chạy tới
+// khi tự chờ, rồi task sẵn sàng có ưu tiên cao nhất (cùng ưu tiên thì theo
+// thứ tự sẵn sàng) được chạy tiếp. Tick là ranh giới 10 ms của thời gian ảo.
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "sim.h"
+
+#define SIM_MAX_TASKS  16
+#define SIM_MAX_TIMERS 16
+#define SIM_TICK_NS    ((uint64_t)portTICK_PERIOD_MS * SIM_MS)
+
+// Heap còn trống điển hình của esp-open-rtos khi vào user_init
+#define SIM_HEAP_BYTES (48 * 1024)
+// Kích thước TCB ước lượng, cộng vào mỗi task khi tính heap
+#define SIM_TCB_BYTES  96
+
+typedef enum {
+    TASK_READY,
+    TASK_BLOCKED,
+    TASK_DELETED,
+} task_state_t;
+
+enum {
+    NOTIFY_NONE,
+    NOTIFY_WAITING,
+    NOTIFY_RECEIVED,
+};
+
+// Một task và thống kê thời gian CPU của nó trên host
+// One task and its host CPU accounting
+struct sim_task {
+    char name[24];           // Full name (FreeRTOS would truncate to configMAX_TASK_NAME_LEN)
+    TaskFunction_t code;
+    void *param;
+    UBaseType_t priority;
+    uint16_t stack_depth;
+    bool static_memory;      // Created with xTaskCreateStatic, not counted in the heap
+    task_state_t state;
+    uint64_t ready_seq;      // Order in which equal-priority tasks became ready
+    uint64_t wake_at;        // Timeout in virtual time (SIM_NEVER = none)
+    bool timed_out;
+    const void *waiting_on;  // Queue or timer list the task is blocked on
+    uint32_t notify_value;
+    uint8_t notify_state;
+    pthread_t thread;
+    pthread_cond_t cond;
+    uint64_t slice_start;    // Thread CPU clock when the task got the CPU
+    uint64_t cpu_ns;         // Host CPU time used by all activations
+    uint64_t cpu_max_ns;     // Longest single activation
+    uint32_t activations;    // Times the scheduler gave it the CPU
+};
+
+struct sim_queue {
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    bool static_memory;
+};
+
+struct sim_timer {
+    const char *name;
+    TickType_t period;
+    bool auto_reload;
+    void *id;
+    TimerCallbackFunction_t callback;
+    bool active;
+    uint64_t expiry_tick;
+};
+
+static struct sim_task tasks[SIM_MAX_TASKS];
+static int task_count;
+static struct sim_timer timers[SIM_MAX_TIMERS];
+static int timer_count;
+
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_cond = PTHREAD_COND_INITIALIZER;
+// Task đang giữ CPU; NULL khi bộ lập lịch (và ISR) đang chạy
+static struct sim_task *running;
+static uint64_t ready_counter;
+static uint32_t heap_used;
+// TCB, stack và buffer do ứng dụng cấp tĩnh (configSUPPORT_STATIC_ALLOCATION)
+static uint32_t static_used;
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint64_t current_tick(void)
+{
+    return sim_now_ns / SIM_TICK_NS;
+}
+
+// Thời điểm hết hạn của một lần chờ ticks tick, tính từ tick hiện tại
+static uint64_t tick_deadline(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return SIM_NEVER;
+    }
+    return (current_tick() + ticks) * SIM_TICK_NS;
+}
+
+static void make_ready(struct sim_task *task)
+{
+    if (task->state == TASK_BLOCKED) {
+        task->state = TASK_READY;
+        task->ready_seq = ++ready_counter;
+        task->wake_at = SIM_NEVER;
+    }
+}
+
+static void wake_waiters(const void *object)
+{
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].state == TASK_BLOCKED && tasks[i].waiting_on == object) {
+            make_ready(&tasks[i]);
+        }
+    }
+}
+
+// Trả CPU cho bộ lập lịch và chờ tới lượt chạy tiếp theo
+static void switch_out(struct sim_task *task)
+{
+    uint64_t used = thread_cpu_ns() - task->slice_start;
+    task->cpu_ns += used;
+    if (used > task->cpu_max_ns) {
+        task->cpu_max_ns = used;
+    }
+
+    pthread_mutex_lock(&sched_mutex);
+    running = NULL;
+    pthread_cond_signal(&sched_cond);
+    if (task->state == TASK_DELETED) {
+        pthread_mutex_unlock(&sched_mutex);
+        pthread_exit(NULL);
+    }
+    while (running != task) {
+        pthread_cond_wait(&task->cond, &sched_mutex);
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    task->slice_start = thread_cpu_ns();
+}
+
+// Chờ object thay đổi hoặc tới wake_at; false nếu hết thời gian
+static bool block_until(const void *object, uint64_t wake_at)
+{
+    struct sim_task *task = running;
+
+    if (task == NULL) {
+        fprintf(stderr, "sim: blocking call outside a task\n");
+        abort();
+    }
+    task->state = TASK_BLOCKED;
+    task->waiting_on = object;
+    task->wake_at = wake_at;
+    task->timed_out = false;
+    switch_out(task);
+    task->waiting_on = NULL;
+    return !task->timed_out;
+}
+
+// ISR đánh thức task: cần chuyển ngữ cảnh nếu task đó ưu tiên hơn task bị ngắt
+static void set_woken(const struct sim_task *task, BaseType_t *higher_priority_woken)
+{
+    if (higher_priority_woken != NULL && (running == NULL || task->priority > running->priority)) {
+        *higher_priority_woken = pdTRUE;
+    }
+}
+
+static void *task_thread(void *arg)
+{
+    struct sim_task *task = arg;
+
+    pthread_mutex_lock(&sched_mutex);
+    while (running != task) {
+        pthread_cond_wait(&task->cond, &sched_mutex);
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    task->slice_start = thread_cpu_ns();
+    task->code(task->param);
+    // Task không được phép trả về; coi như tự xóa
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+static struct sim_task *highest_ready(void)
+{
+    struct sim_task *best = NULL;
+
+    for (int i = 0; i < task_count; i++) {
+        struct sim_task *task = &tasks[i];
+        if (task->state == TASK_READY &&
+            (best == NULL || task->priority > best->priority ||
+             (task->priority == best->priority && task->ready_seq < best->ready_seq))) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+void sim_rtos_run(void)
+{
+    struct sim_task *task;
+
+    while ((task = highest_ready()) != NULL) {
+        task->activations++;
+        pthread_mutex_lock(&sched_mutex);
+        running = task;
+        pthread_cond_signal(&task->cond);
+        while (running != NULL) {
+            pthread_cond_wait(&sched_cond, &sched_mutex);
+        }
+        pthread_mutex_unlock(&sched_mutex);
+        sim_gpio_sync();
+    }
+}
+
+uint64_t sim_rtos_next_wake(void)
+{
+    uint64_t next = SIM_NEVER;
+
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].state == TASK_BLOCKED && tasks[i].wake_at < next) {
+            next = tasks[i].wake_at;
+        }
+    }
+    return next;
+}
+
+void sim_rtos_wake_due(void)
+{
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].state == TASK_BLOCKED && tasks[i].wake_at <= sim_now_ns) {
+            tasks[i].timed_out = true;
+            make_ready(&tasks[i]);
+        }
+    }
+}
+
+bool sim_rtos_idle(void)
+{
+#if configUSE_TICKLESS_IDLE
+    // Như prvGetExpectedIdleTime(): số tick tới lần hết hạn chờ sớm nhất
+    uint64_t wake = sim_rtos_next_wake();
+    TickType_t expected = wake == SIM_NEVER ? portMAX_DELAY : (TickType_t)(wake / SIM_TICK_NS - current_tick());
+    if (expected >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP) {
+        portSUPPRESS_TICKS_AND_SLEEP(expected);
+        return true;
+    }
+#endif
+    return false;
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void)
+{
+    // Hết thời gian mô phỏng: WAITI không còn sự kiện nào để chờ
+    return highest_ready() != NULL || sim_finished() ? eAbortSleep : eStandardSleep;
+}
+
+void sim_port_yield_from_isr(BaseType_t switch_required)
+{
+    // Lập lịch hợp tác: task được đánh thức chạy khi task hiện tại tự chờ
+}
+
+uint32_t xPortGetFreeHeapSize(void)
+{
+    return SIM_HEAP_BYTES - heap_used;
+}
+
+// ---- Task ----
+
+static struct sim_task *task_create(TaskFunction_t code, const char *name, uint16_t stack_depth, void *param,
+                                    UBaseType_t priority, bool static_memory)
+{
+    uint32_t bytes = stack_depth * sizeof(StackType_t) + SIM_TCB_BYTES;
+
+    if (task_count == SIM_MAX_TASKS || (!static_memory && heap_used + bytes > SIM_HEAP_BYTES)) {
+        return NULL;
+    }
+    struct sim_task *task = &tasks[task_count];
+    memset(task, 0, sizeof(*task));
+    strncpy(task->name, name, sizeof(task->name) - 1);
+    task->code = code;
+    task->param = param;
+    task->priority = priority < configMAX_PRIORITIES ? priority : configMAX_PRIORITIES - 1;
+    task->stack_depth = stack_depth;
+    task->static_memory = static_memory;
+    task->state = TASK_READY;
+    task->ready_seq = ++ready_counter;
+    task->wake_at = SIM_NEVER;
+    pthread_cond_init(&task->cond, NULL);
+    if (pthread_create(&task->thread, NULL, task_thread, task) != 0) {
+        return NULL;
+    }
+    task_count++;
+    if (static_memory) {
+        static_used += bytes;
+    } else {
+        heap_used += bytes;
+    }
+    return task;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint16_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    struct sim_task *task = task_create(code, name, stack_depth, param, priority, false);
+
+    if (created != NULL && task != NULL) {
+        *created = task;
+    }
+    return task != NULL ? pdPASS : pdFAIL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t code, const char *name, uint32_t stack_depth, void *param,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb)
+{
+    if (stack == NULL || tcb == NULL) {
+        return NULL;
+    }
+    return task_create(code, name, stack_depth, param, priority, true);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL) {
+        task = running;
+    }
+    task->state = TASK_DELETED;
+    // Bộ nhớ tĩnh vẫn thuộc về ứng dụng sau khi task bị xóa
+    if (!task->static_memory) {
+        heap_used -= task->stack_depth * sizeof(StackType_t) + SIM_TCB_BYTES;
+    }
+    if (task == running) {
+        switch_out(task);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0) {
+        sim_task_yield();
+        return;
+    }
+    block_until(NULL, tick_deadline(ticks));
+}
+
+void sim_task_yield(void)
+{
+    struct sim_task *task = running;
+
+    task->ready_seq = ++ready_counter;
+    switch_out(task);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)current_tick();
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return (TickType_t)current_tick();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return running;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return (task != NULL ? task : running)->stack_depth;
+}
+
+// ---- Thông báo task ----
+
+static bool notify(struct sim_task *task, uint32_t value, eNotifyAction action)
+{
+    uint8_t previous = task->notify_state;
+
+    switch (action) {
+    case eSetBits:
+        task->notify_value |= value;
+        break;
+    case eIncrement:
+        task->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify_value = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (previous == NOTIFY_RECEIVED) {
+            return false;
+        }
+        task->notify_value = value;
+        break;
+    case eNoAction:
+        break;
+    }
+    task->notify_state = NOTIFY_RECEIVED;
+    if (previous == NOTIFY_WAITING) {
+        make_ready(task);
+    }
+    return true;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    return notify(task, value, action) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *higher_priority_woken)
+{
+    bool waiting = task->notify_state == NOTIFY_WAITING;
+    bool ok = notify(task, value, action);
+    if (waiting) {
+        set_woken(task, higher_priority_woken);
+    }
+    return ok ? pdPASS : pdFAIL;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_woken)
+{
+    xTaskNotifyFromISR(task, 0, eIncrement, higher_priority_woken);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value,
+                           TickType_t ticks)
+{
+    struct sim_task *task = running;
+    BaseType_t result;
+
+    if (task->notify_state != NOTIFY_RECEIVED) {
+        task->notify_value &= ~clear_on_entry;
+        task->notify_state = NOTIFY_WAITING;
+        if (ticks > 0) {
+            block_until(&task->notify_state, tick_deadline(ticks));
+        }
+    }
+    if (value != NULL) {
+        *value = task->notify_value;
+    }
+    if (task->notify_state == NOTIFY_RECEIVED) {
+        task->notify_value &= ~clear_on_exit;
+        result = pdTRUE;
+    } else {
+        result = pdFALSE;
+    }
+    task->notify_state = NOTIFY_NONE;
+    return result;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct sim_task *task = running;
+
+    if (task->notify_value == 0) {
+        task->notify_state = NOTIFY_WAITING;
+        if (ticks > 0) {
+            block_until(&task->notify_state, tick_deadline(ticks));
+        }
+    }
+    uint32_t value = task->notify_value;
+    if (value != 0) {
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    task->notify_state = NOTIFY_NONE;
+    return value;
+}
+
+// ---- Hàng đợi và semaphore ----
+
+static bool queue_put(struct sim_queue *queue, const void *item)
+{
+    if (queue->count == queue->length) {
+        return false;
+    }
+    if (queue->item_size != 0) {
+        UBaseType_t slot = (queue->head + queue->count) % queue->length;
+        memcpy(queue->storage + slot * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    wake_waiters(queue);
+    return true;
+}
+
+static bool queue_get(struct sim_queue *queue, void *buffer)
+{
+    if (queue->count == 0) {
+        return false;
+    }
+    if (queue->item_size != 0) {
+        memcpy(buffer, queue->storage + queue->head * queue->item_size, queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    wake_waiters(queue);
+    return true;
+}
+
+static QueueHandle_t queue_create(UBaseType_t length, UBaseType_t item_size, bool static_memory)
+{
+    uint32_t bytes = length * item_size + sizeof(struct sim_queue);
+
+    if (length == 0 || (!static_memory && heap_used + bytes > SIM_HEAP_BYTES)) {
+        return NULL;
+    }
+    struct sim_queue *queue = calloc(1, sizeof(*queue));
+    queue->storage = calloc(length, item_size ? item_size : 1);
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->static_memory = static_memory;
+    if (static_memory) {
+        static_used += bytes;
+    } else {
+        heap_used += bytes;
+    }
+    return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    return queue_create(length, item_size, false);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (!queue->static_memory) {
+        heap_used -= queue->length * queue->item_size + sizeof(struct sim_queue);
+    }
+    free(queue->storage);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    uint64_t deadline = tick_deadline(ticks);
+
+    while (!queue_put(queue, item)) {
+        if (ticks == 0 || !block_until(queue, deadline)) {
+            return errQUEUE_FULL;
+        }
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_priority_woken)
+{
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].state == TASK_BLOCKED && tasks[i].waiting_on == queue) {
+            set_woken(&tasks[i], higher_priority_woken);
+        }
+    }
+    return queue_put(queue, item) ? pdPASS : errQUEUE_FULL;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks)
+{
+    uint64_t deadline = tick_deadline(ticks);
+
+    while (!queue_get(queue, buffer)) {
+        if (ticks == 0 || !block_until(queue, deadline)) {
+            return errQUEUE_EMPTY;
+        }
+    }
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t sem = xQueueCreate(1, 0);
+    if (sem != NULL) {
+        sem->count = 1;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer)
+{
+    SemaphoreHandle_t sem = buffer != NULL ? queue_create(1, 0, true) : NULL;
+    if (sem != NULL) {
+        sem->count = 1;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xQueueCreate(1, 0);
+}
+
+// ---- Timer phần mềm ----
+
+static struct sim_timer *next_timer(void)
+{
+    struct sim_timer *next = NULL;
+
+    for (int i = 0; i < timer_count; i++) {
+        if (timers[i].active && (next == NULL || timers[i].expiry_tick < next->expiry_tick)) {
+            next = &timers[i];
+        }
+    }
+    return next;
+}
+
+// Timer task: chạy callback của các timer đã hết hạn theo thứ tự hết hạn
+static void timer_task(void *arg)
+{
+    while (1) {
+        struct sim_timer *timer = next_timer();
+        if (timer == NULL || timer->expiry_tick > current_tick()) {
+            // Thức dậy khi timer sớm nhất hết hạn hoặc khi có lệnh mới
+            block_until(timers, timer != NULL ? timer->expiry_tick * SIM_TICK_NS : SIM_NEVER);
+            continue;
+        }
+        if (timer->auto_reload) {
+            timer->expiry_tick += timer->period;
+        } else {
+            timer->active = false;
+        }
+        timer->callback(timer);
+    }
+}
+
+static BaseType_t timer_arm(TimerHandle_t timer)
+{
+    timer->active = true;
+    timer->expiry_tick = current_tick() + timer->period;
+    wake_waiters(timers);
+    return pdPASS;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback)
+{
+    if (timer_count == SIM_MAX_TIMERS || period == 0) {
+        return NULL;
+    }
+    struct sim_timer *timer = &timers[timer_count++];
+    timer->name = name;
+    timer->period = period;
+    timer->auto_reload = auto_reload;
+    timer->id = id;
+    timer->callback = callback;
+    timer->active = false;
+    return timer;
+}
+
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer)
+{
+    return buffer != NULL ? xTimerCreate(name, period, auto_reload, id, callback) : NULL;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks)
+{
+    return timer_arm(timer);
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks)
+{
+    return timer_arm(timer);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks)
+{
+    timer->active = false;
+    wake_waiters(timers);
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks)
+{
+    if (period == 0) {
+        return pdFAIL;
+    }
+    timer->period = period;
+    return timer_arm(timer);
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+    return timer->active ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+    return timer->id;
+}
+
+// ---- Khởi tạo và báo cáo ----
+
+void sim_rtos_init(void)
+{
+    // Như port.c: với cấp phát tĩnh, stack của timer task không lấy từ heap
+    task_create(timer_task, "Tmr Svc", configTIMER_TASK_STACK_DEPTH, NULL, configTIMER_TASK_PRIORITY,
+                configSUPPORT_STATIC_ALLOCATION);
+}
+
+void sim_rtos_report(FILE *out)
+{
+    fprintf(out, "# %-18s %4s %12s %12s %10s %10s\n",
+            "task", "prio", "activations", "cpu_us", "mean_us", "max_us");
+    for (int i = 0; i < task_count; i++) {
+        const struct sim_task *task = &tasks[i];
+        fprintf(out, "# %-18s %4lu %12u %12.1f %10.2f %10.1f\n",
+                task->name, task->priority, task->activations, task->cpu_ns / 1e3,
+                task->activations ? task->cpu_ns / 1e3 / task->activations : 0.0, task->cpu_max_ns / 1e3);
+    }
+    fprintf(out, "# free heap %u bytes, static rtos memory %u bytes\n", xPortGetFreeHeapSize(), static_used);
+}
+
+bool sim_rtos_task_stats(const char *name, uint64_t *cpu_ns, uint32_t *activations)
+{
+    for (int i = 0; i < task_count; i++) {
+        if (strcmp(tasks[i].name, name) == 0) {
+            *cpu_ns = tasks[i].cpu_ns;
+            *activations = tasks[i].activations;
+            return true;
+        }
+    }
+    return false;
+}
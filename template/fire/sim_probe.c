@@ -0,0 +1,305 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "sim_probe.h"
+#include "fire_clock.h"
+
+#ifdef FIRE_HOST_BUILD
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ioctlsocket ioctl
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+#else
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/netdb.h"
+
+static uint32_t now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+#endif
+
+// Phản hồi của HEAD không có body dù có Content-Length: trả 1 để http-parser
+// kết thúc message ngay sau header
+static int on_headers_complete(http_parser *http)
+{
+    return 1;
+}
+
+// Dừng parser sau message đầu tiên: byte tiếp theo (nếu có) là body thừa
+static int on_message_complete(http_parser *http)
+{
+    sim_probe_parser_t *parser = http->data;
+    parser->status = http->status_code;
+    parser->keep_alive = http_should_keep_alive(http);
+    parser->done = true;
+    http_parser_pause(http, 1);
+    return 0;
+}
+
+static const http_parser_settings parser_settings = {
+    .on_headers_complete = on_headers_complete,
+    .on_message_complete = on_message_complete,
+};
+
+void sim_probe_parser_init(sim_probe_parser_t *parser)
+{
+    http_parser_init(&parser->http, HTTP_RESPONSE);
+    parser->http.data = parser;
+    parser->received = 0;
+    parser->status = 0;
+    parser->keep_alive = false;
+    parser->done = false;
+    parser->error = SIM_PROBE_OK;
+}
+
+int sim_probe_parser_feed(sim_probe_parser_t *parser, const char *data, int len)
+{
+    if (parser->done) {
+        if (len == 0) {
+            return 1;
+        }
+        parser->error = SIM_PROBE_ERR_OVERSIZE;
+        return -1;
+    }
+
+    // Không đưa quá SIM_PROBE_HEADER_MAX byte vào parser
+    size_t room = SIM_PROBE_HEADER_MAX - parser->received;
+    size_t n = (size_t)len < room ? (size_t)len : room;
+    size_t parsed = http_parser_execute(&parser->http, &parser_settings, data, n);
+    parser->received += parsed;
+
+    if (parser->done) {
+        if (parsed < (size_t)len) {
+            // Body sau phản hồi HEAD: kết nối không còn đồng bộ
+            parser->error = SIM_PROBE_ERR_OVERSIZE;
+            return -1;
+        }
+        return 1;
+    }
+    if (HTTP_PARSER_ERRNO(&parser->http) != HPE_OK) {
+        parser->error = SIM_PROBE_ERR_STATUS;
+        return -1;
+    }
+    if (parser->received == SIM_PROBE_HEADER_MAX) {
+        parser->error = SIM_PROBE_ERR_OVERSIZE;
+        return -1;
+    }
+    return 0;
+}
+
+int sim_probe_format_request(char *buf, size_t size, const char *host, const char *path)
+{
+    int len = snprintf(buf, size,
+                       "HEAD %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "Connection: keep-alive\r\n"
+                       "\r\n", path, host);
+    if (len < 0 || len >= (int)size) {
+        return -1;
+    }
+    return len;
+}
+
+bool sim_probe_init(sim_probe_t *probe, const char *host, const char *port, const char *path)
+{
+    memset(probe, 0, sizeof(*probe));
+    probe->host = host;
+    probe->port = port;
+    probe->sock = -1;
+
+    int len = sim_probe_format_request(probe->request, sizeof(probe->request), host, path);
+    if (len < 0) {
+        return false;
+    }
+    probe->request_len = len;
+    return true;
+}
+
+void sim_probe_close(sim_probe_t *probe)
+{
+    if (probe->sock >= 0) {
+        close(probe->sock);
+        probe->sock = -1;
+    }
+}
+
+void sim_probe_flush_dns(sim_probe_t *probe)
+{
+    probe->addr_valid = false;
+}
+
+// Phân giải tên miền khi địa chỉ trong cache đã hết hạn
+static bool resolve(sim_probe_t *probe)
+{
+    uint32_t now = now_ms();
+    if (probe->addr_valid && (int32_t)(probe->addr_expiry_ms - now) > 0) {
+        return true;
+    }
+
+    const struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+
+    probe->dns_lookups++;
+    int err = getaddrinfo(probe->host, probe->port, &hints, &res);
+    if (err != 0 || res == NULL || res->ai_addrlen > sizeof(probe->addr)) {
+        if (res) {
+            freeaddrinfo(res);
+        }
+        probe->addr_valid = false;
+        return false;
+    }
+    memcpy(&probe->addr, res->ai_addr, res->ai_addrlen);
+    probe->addr_len = res->ai_addrlen;
+    probe->addr_valid = true;
+    probe->addr_expiry_ms = now + SIM_PROBE_DNS_TTL_MS;
+    freeaddrinfo(res);
+    return true;
+}
+
+// Mở kết nối mới với timeout (connect không chặn + select)
+static sim_probe_result_t open_connection(sim_probe_t *probe)
+{
+    int s = socket(probe->addr.ss_family, SOCK_STREAM, 0);
+    if (s < 0) {
+        return SIM_PROBE_ERR_SOCKET;
+    }
+
+    int nonblocking = 1;
+    ioctlsocket(s, FIONBIO, &nonblocking);
+    int r = connect(s, (struct sockaddr *)&probe->addr, probe->addr_len);
+    if (r != 0 && errno == EINPROGRESS) {
+        fd_set wfds;
+        struct timeval tv = { .tv_sec = SIM_PROBE_TIMEOUT_MS / 1000,
+                              .tv_usec = (SIM_PROBE_TIMEOUT_MS % 1000) * 1000 };
+        FD_ZERO(&wfds);
+        FD_SET(s, &wfds);
+        if (select(s + 1, NULL, &wfds, NULL, &tv) == 1) {
+            int so_error = 0;
+            socklen_t optlen = sizeof(so_error);
+            getsockopt(s, SOL_SOCKET, SO_ERROR, &so_error, &optlen);
+            r = so_error == 0 ? 0 : -1;
+        }
+    }
+    if (r != 0) {
+        close(s);
+        // Địa chỉ có thể đã đổi: phân giải lại ở lần sau
+        probe->addr_valid = false;
+        return SIM_PROBE_ERR_CONNECT;
+    }
+    nonblocking = 0;
+    ioctlsocket(s, FIONBIO, &nonblocking);
+
+    struct timeval tv = { .tv_sec = SIM_PROBE_TIMEOUT_MS / 1000,
+                          .tv_usec = (SIM_PROBE_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+
+    probe->sock = s;
+    probe->connects++;
+    return SIM_PROBE_OK;
+}
+
+// Gửi request và đọc tới hết header trên kết nối đang mở
+static sim_probe_result_t exchange(sim_probe_t *probe)
+{
+    sim_probe_parser_t parser;
+    char buf[64];
+
+    uint32_t start = fire_clock_cycles();
+    if (write(probe->sock, probe->request, probe->request_len) != probe->request_len) {
+        return SIM_PROBE_ERR_SEND;
+    }
+
+    sim_probe_parser_init(&parser);
+    while (1) {
+        int r = read(probe->sock, buf, sizeof(buf));
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // SO_RCVTIMEO hết hạn
+            return SIM_PROBE_ERR_TIMEOUT;
+        }
+        if (r <= 0) {
+            return SIM_PROBE_ERR_RECV;
+        }
+        int done = sim_probe_parser_feed(&parser, buf, r);
+        if (done < 0) {
+            return parser.error;
+        }
+        if (done > 0) {
+            break;
+        }
+    }
+
+    uint32_t rtt_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    probe->last_status = parser.status;
+    probe->last_rtt_us = rtt_us;
+    if (probe->probes == probe->failures + 1 || rtt_us < probe->min_rtt_us) {
+        probe->min_rtt_us = rtt_us;
+    }
+    if (rtt_us > probe->max_rtt_us) {
+        probe->max_rtt_us = rtt_us;
+    }
+    // Server báo sẽ đóng kết nối (Connection: close, HTTP/1.0): không giữ lại
+    if (!parser.keep_alive) {
+        sim_probe_close(probe);
+    }
+    return parser.status >= SIM_PROBE_HTTP_ERROR_MIN ? SIM_PROBE_ERR_HTTP : SIM_PROBE_OK;
+}
+
+sim_probe_result_t sim_probe_run(sim_probe_t *probe)
+{
+    sim_probe_result_t result;
+
+    probe->probes++;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = probe->sock >= 0;
+        if (!reused) {
+            if (!resolve(probe)) {
+                result = SIM_PROBE_ERR_DNS;
+                break;
+            }
+            result = open_connection(probe);
+            if (result != SIM_PROBE_OK) {
+                break;
+            }
+        }
+
+        result = exchange(probe);
+        if (result == SIM_PROBE_OK) {
+            return SIM_PROBE_OK;
+        }
+        if (result == SIM_PROBE_ERR_HTTP) {
+            // Phản hồi đầy đủ: kết nối vẫn dùng được
+            break;
+        }
+        sim_probe_close(probe);
+        // Chỉ thử lại khi kết nối cũ đã bị server đóng trong lúc nghỉ
+        if (!reused || !sim_probe_stale_error(result)) {
+            break;
+        }
+    }
+
+    probe->failures++;
+    probe->errors[result]++;
+    return result;
+}
@@ -0,0 +1,145 @@
+#ifndef SIM_PROBE_H
+#define SIM_PROBE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "http-parser/http_parser.h"
+
+#ifdef FIRE_HOST_BUILD
+#include <sys/socket.h>
+#else
+#include "lwip/sockets.h"
+#endif
+
+// Thời gian giữ địa chỉ đã phân giải (getaddrinfo không trả về TTL của DNS)
+#define SIM_PROBE_DNS_TTL_MS 300000
+// Timeout cho connect/send/recv của một lần probe
+#define SIM_PROBE_TIMEOUT_MS 5000
+// Kích thước tối đa của request HEAD đã dựng sẵn
+#define SIM_PROBE_REQUEST_MAX 160
+// Giới hạn status line cộng header của phản hồi; phản hồi dài hơn bị hủy
+#define SIM_PROBE_HEADER_MAX 1024
+// Mã HTTP từ mức này là lỗi phía server: probe thất bại
+#define SIM_PROBE_HTTP_ERROR_MIN 500
+
+// Kết quả của một lần probe
+typedef enum {
+    SIM_PROBE_OK = 0,       // Headers received with a status under SIM_PROBE_HTTP_ERROR_MIN (see last_status)
+    SIM_PROBE_ERR_DNS,      // Name resolution failed
+    SIM_PROBE_ERR_SOCKET,   // Socket could not be allocated
+    SIM_PROBE_ERR_CONNECT,  // TCP connect failed or timed out
+    SIM_PROBE_ERR_SEND,     // Request could not be sent
+    SIM_PROBE_ERR_RECV,     // Connection closed or reset before the end of the headers
+    SIM_PROBE_ERR_STATUS,   // Response is not valid HTTP
+    SIM_PROBE_ERR_TIMEOUT,  // Headers not complete within SIM_PROBE_TIMEOUT_MS
+    SIM_PROBE_ERR_OVERSIZE, // Headers over SIM_PROBE_HEADER_MAX, or a body after the HEAD response
+    SIM_PROBE_ERR_HTTP,     // Server error status (see last_status), the connection stays usable
+    SIM_PROBE_RESULTS
+} sim_probe_result_t;
+
+// Bộ phân tích phản hồi HEAD trên http-parser: dừng ngay khi status line và
+// header hợp lệ đã đủ, không đọc body
+// Incremental HEAD response parser built on http-parser
+typedef struct {
+    http_parser http;
+    uint16_t received;        // Bytes consumed, bounded by SIM_PROBE_HEADER_MAX
+    uint16_t status;          // Status code, valid once the headers are complete
+    bool keep_alive;          // Server keeps the connection open after this response
+    bool done;
+    sim_probe_result_t error; // Why sim_probe_parser_feed() returned -1
+} sim_probe_parser_t;
+
+// Lỗi trên kết nối keep-alive cũ có thể chỉ do server đã đóng nó lúc nghỉ
+static inline bool sim_probe_stale_error(sim_probe_result_t result)
+{
+    return result == SIM_PROBE_ERR_SEND || result == SIM_PROBE_ERR_RECV;
+}
+
+// Probe kết nối HTTP dùng lại một kết nối keep-alive
+// Keep-alive HTTP HEAD connectivity probe with cached DNS
+typedef struct {
+    const char *host;
+    const char *port;
+    char request[SIM_PROBE_REQUEST_MAX];
+    uint16_t request_len;
+
+    int sock;                      // Open keep-alive connection, or -1
+    struct sockaddr_storage addr;  // Cached resolved address
+    socklen_t addr_len;
+    bool addr_valid;
+    uint32_t addr_expiry_ms;       // Time at which the cached address expires
+
+    // Thống kê
+    uint32_t dns_lookups;  // getaddrinfo calls
+    uint32_t connects;     // TCP connections opened
+    uint32_t probes;       // Probes attempted
+    uint32_t failures;     // Probes that did not end in SIM_PROBE_OK
+    uint32_t errors[SIM_PROBE_RESULTS]; // Failures by result
+    uint16_t last_status;  // HTTP status of the last complete response
+    uint32_t last_rtt_us;  // Request-to-status-line time of the last probe
+    uint32_t min_rtt_us;
+    uint32_t max_rtt_us;
+} sim_probe_t;
+
+/**
+ * @brief Initializes a probe; no network activity happens here
+ *
+ * @param probe Probe
+ * @param host Host name, also sent in the Host header
+ * @param port TCP port as a string
+ * @param path Request path
+ * @return false if the request does not fit SIM_PROBE_REQUEST_MAX
+ */
+bool sim_probe_init(sim_probe_t *probe, const char *host, const char *port, const char *path);
+
+/**
+ * @brief Runs one probe
+ *
+ * Resolves the host only when the cached address has expired, reuses the
+ * open connection when there is one, and retries once on a fresh connection
+ * if the server closed the old one. Reading stops at the end of the headers.
+ *
+ * @param probe Probe
+ * @return SIM_PROBE_OK when valid headers with a non-error status were received
+ */
+sim_probe_result_t sim_probe_run(sim_probe_t *probe);
+
+/**
+ * @brief Closes the keep-alive connection, if any
+ */
+void sim_probe_close(sim_probe_t *probe);
+
+/**
+ * @brief Drops the cached address so the next probe resolves again
+ */
+void sim_probe_flush_dns(sim_probe_t *probe);
+
+/**
+ * @brief Builds the keep-alive HEAD request sent by the probes
+ *
+ * @param buf Output buffer
+ * @param size Size of @p buf
+ * @param host Value of the Host header
+ * @param path Request path
+ * @return Request length, or -1 if it does not fit
+ */
+int sim_probe_format_request(char *buf, size_t size, const char *host, const char *path);
+
+/**
+ * @brief Resets a response parser
+ */
+void sim_probe_parser_init(sim_probe_parser_t *parser);
+
+/**
+ * @brief Feeds received bytes into the parser
+ *
+ * @param parser Parser
+ * @param data Received bytes
+ * @param len Number of bytes
+ * @return 1 when the end of the headers was reached, 0 if more data is
+ *         needed, -1 on a malformed or oversize response (see error)
+ */
+int sim_probe_parser_feed(sim_probe_parser_t *parser, const char *data, int len);
+
+#endif
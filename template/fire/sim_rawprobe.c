@@ -0,0 +1,264 @@
+#include <string.h>
+#include "sim_rawprobe.h"
+#include "fire_clock.h"
+
+static void start_connect(sim_rawprobe_t *probe);
+
+static inline uint32_t elapsed_us(uint32_t since)
+{
+    return fire_clock_cycles_to_us(fire_clock_cycles() - since);
+}
+
+// Gỡ callback và đóng kết nối (tcp_abort nếu tcp_close không cấp được bộ nhớ)
+static void drop_pcb(sim_rawprobe_t *probe, bool abort)
+{
+    struct tcp_pcb *pcb = probe->pcb;
+    if (pcb == NULL) {
+        return;
+    }
+    probe->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    if (abort || tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+    }
+}
+
+static void finish(sim_rawprobe_t *probe, sim_probe_result_t result)
+{
+    probe->report.result = result;
+    probe->report.total_us = elapsed_us(probe->start_ccount);
+    probe->state = probe->pcb != NULL ? SIM_RAWPROBE_READY : SIM_RAWPROBE_IDLE;
+    if (probe->done) {
+        probe->done(&probe->report, probe->done_arg);
+    }
+}
+
+// Lỗi trên kết nối keep-alive cũ: thử lại một lần trên kết nối mới
+static void fail(sim_rawprobe_t *probe, sim_probe_result_t result, bool abort)
+{
+    drop_pcb(probe, abort);
+    if (probe->report.reused && !probe->retried && sim_probe_stale_error(result)) {
+        probe->retried = true;
+        probe->report.reused = false;
+        start_connect(probe);
+        return;
+    }
+    finish(probe, result);
+}
+
+static void send_request(sim_rawprobe_t *probe)
+{
+    probe->state = SIM_RAWPROBE_REQUEST;
+    probe->stage_ccount = fire_clock_cycles();
+    probe->report.first_byte_us = 0;
+    sim_probe_parser_init(&probe->parser);
+
+    // Request nằm trong struct probe nên không cần copy
+    if (tcp_write(probe->pcb, probe->request, probe->request_len, 0) != ERR_OK ||
+        tcp_output(probe->pcb) != ERR_OK) {
+        fail(probe, SIM_PROBE_ERR_SEND, true);
+    }
+}
+
+static err_t on_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    sim_rawprobe_t *probe = arg;
+
+    if (p == NULL) {
+        // Server đóng kết nối
+        if (probe->state == SIM_RAWPROBE_REQUEST) {
+            fail(probe, SIM_PROBE_ERR_RECV, false);
+        } else {
+            drop_pcb(probe, false);
+            probe->state = SIM_RAWPROBE_IDLE;
+        }
+        return ERR_OK;
+    }
+
+    if (probe->state != SIM_RAWPROBE_REQUEST) {
+        // Dữ liệu ngoài lúc chờ phản hồi: kết nối không còn dùng lại được
+        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
+        drop_pcb(probe, true);
+        probe->state = SIM_RAWPROBE_IDLE;
+        return ERR_ABRT;
+    }
+
+    if (probe->report.first_byte_us == 0) {
+        probe->report.first_byte_us = elapsed_us(probe->stage_ccount);
+    }
+
+    int done = 0;
+    for (struct pbuf *q = p; q != NULL && done == 0; q = q->next) {
+        done = sim_probe_parser_feed(&probe->parser, q->payload, q->len);
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    if (done < 0) {
+        fail(probe, probe->parser.error, true);
+        return ERR_ABRT;
+    }
+    if (done > 0) {
+        probe->report.status = probe->parser.status;
+        // Server báo sẽ đóng kết nối: đóng trước, lần sau connect lại
+        if (!probe->parser.keep_alive) {
+            drop_pcb(probe, false);
+        }
+        finish(probe, probe->parser.status >= SIM_PROBE_HTTP_ERROR_MIN ? SIM_PROBE_ERR_HTTP : SIM_PROBE_OK);
+    }
+    return ERR_OK;
+}
+
+static void on_err(void *arg, err_t err)
+{
+    sim_rawprobe_t *probe = arg;
+
+    // lwIP đã giải phóng pcb
+    probe->pcb = NULL;
+    switch (probe->state) {
+    case SIM_RAWPROBE_CONNECTING:
+        fail(probe, SIM_PROBE_ERR_CONNECT, false);
+        break;
+    case SIM_RAWPROBE_REQUEST:
+        fail(probe, SIM_PROBE_ERR_RECV, false);
+        break;
+    default:
+        probe->state = SIM_RAWPROBE_IDLE;
+        break;
+    }
+}
+
+static err_t on_poll(void *arg, struct tcp_pcb *pcb)
+{
+    sim_rawprobe_t *probe = arg;
+
+    if (elapsed_us(probe->stage_ccount) < probe->timeout_us) {
+        return ERR_OK;
+    }
+    if (probe->state == SIM_RAWPROBE_CONNECTING) {
+        fail(probe, SIM_PROBE_ERR_CONNECT, true);
+        return ERR_ABRT;
+    }
+    if (probe->state == SIM_RAWPROBE_REQUEST) {
+        fail(probe, SIM_PROBE_ERR_TIMEOUT, true);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+static err_t on_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    sim_rawprobe_t *probe = arg;
+
+    probe->report.connect_us = elapsed_us(probe->stage_ccount);
+    if (err != ERR_OK) {
+        fail(probe, SIM_PROBE_ERR_CONNECT, true);
+        return ERR_ABRT;
+    }
+    send_request(probe);
+    return probe->pcb != NULL ? ERR_OK : ERR_ABRT;
+}
+
+static void start_connect(sim_rawprobe_t *probe)
+{
+    probe->state = SIM_RAWPROBE_CONNECTING;
+    probe->stage_ccount = fire_clock_cycles();
+
+    probe->pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (probe->pcb == NULL) {
+        finish(probe, SIM_PROBE_ERR_SOCKET);
+        return;
+    }
+    tcp_arg(probe->pcb, probe);
+    tcp_recv(probe->pcb, on_recv);
+    tcp_err(probe->pcb, on_err);
+    tcp_poll(probe->pcb, on_poll, SIM_RAWPROBE_POLL_INTERVAL);
+
+    if (tcp_connect(probe->pcb, &probe->addr, probe->port, on_connected) != ERR_OK) {
+        drop_pcb(probe, true);
+        finish(probe, SIM_PROBE_ERR_CONNECT);
+    }
+}
+
+// Giai đoạn DNS chưa có pcb nên không có tcp_poll: hạn chờ là một timer của
+// lwIP, không phụ thuộc số lần gửi lại của DNS. Câu trả lời tới muộn bị bỏ
+static void on_dns_timeout(void *arg)
+{
+    sim_rawprobe_t *probe = arg;
+
+    if (probe->state != SIM_RAWPROBE_DNS) {
+        return;
+    }
+    probe->report.dns_us = elapsed_us(probe->stage_ccount);
+    finish(probe, SIM_PROBE_ERR_DNS);
+}
+
+static void on_dns(const char *name, const ip_addr_t *ipaddr, void *arg)
+{
+    sim_rawprobe_t *probe = arg;
+
+    if (probe->state != SIM_RAWPROBE_DNS) {
+        return;
+    }
+    sys_untimeout(on_dns_timeout, probe);
+    probe->report.dns_us = elapsed_us(probe->stage_ccount);
+    if (ipaddr == NULL) {
+        finish(probe, SIM_PROBE_ERR_DNS);
+        return;
+    }
+    probe->addr = *ipaddr;
+    start_connect(probe);
+}
+
+bool sim_rawprobe_init(sim_rawprobe_t *probe, const char *host, uint16_t port, const char *path,
+                       uint32_t timeout_ms, sim_rawprobe_done_fn done, void *arg)
+{
+    memset(probe, 0, sizeof(*probe));
+    probe->host = host;
+    probe->port = port;
+    probe->timeout_us = timeout_ms * 1000;
+    probe->done = done;
+    probe->done_arg = arg;
+    probe->state = SIM_RAWPROBE_IDLE;
+
+    int len = sim_probe_format_request(probe->request, sizeof(probe->request), host, path);
+    if (len < 0) {
+        return false;
+    }
+    probe->request_len = len;
+    return true;
+}
+
+bool sim_rawprobe_start(sim_rawprobe_t *probe)
+{
+    if (probe->state != SIM_RAWPROBE_IDLE && probe->state != SIM_RAWPROBE_READY) {
+        return false;
+    }
+
+    memset(&probe->report, 0, sizeof(probe->report));
+    probe->retried = false;
+    probe->start_ccount = fire_clock_cycles();
+
+    if (probe->state == SIM_RAWPROBE_READY) {
+        probe->report.reused = true;
+        send_request(probe);
+        return true;
+    }
+
+    // lwIP trả lời ngay từ bảng DNS của nó khi bản ghi chưa hết TTL
+    probe->state = SIM_RAWPROBE_DNS;
+    probe->stage_ccount = probe->start_ccount;
+    err_t err = dns_gethostbyname(probe->host, &probe->addr, on_dns, probe);
+    if (err == ERR_OK) {
+        start_connect(probe);
+    } else if (err == ERR_INPROGRESS) {
+        sys_timeout(probe->timeout_us / 1000, on_dns_timeout, probe);
+    } else {
+        finish(probe, SIM_PROBE_ERR_DNS);
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef SIM_RAWPROBE_H
+#define SIM_RAWPROBE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim_probe.h"
+
+#ifdef FIRE_HOST_BUILD
+#include "lwip_mock.h"
+#else
+#include "lwip/tcp.h"
+#include "lwip/dns.h"
+#include "lwip/timeouts.h"
+#endif
+
+// Chu kỳ gọi tcp_poll (đơn vị 500 ms của timer TCP chậm)
+#define SIM_RAWPROBE_POLL_INTERVAL 1
+
+// Trạng thái của probe chạy trong thread tcpip
+typedef enum {
+    SIM_RAWPROBE_IDLE,        // No connection
+    SIM_RAWPROBE_DNS,         // Waiting for dns_gethostbyname
+    SIM_RAWPROBE_CONNECTING,  // SYN sent
+    SIM_RAWPROBE_REQUEST,     // Request sent, waiting for the response headers
+    SIM_RAWPROBE_READY        // Keep-alive connection open and idle
+} sim_rawprobe_state_t;
+
+// Kết quả và thời gian từng giai đoạn của một lần probe
+// Outcome of one probe with per-stage timings in microseconds
+typedef struct {
+    sim_probe_result_t result;
+    uint16_t status;         // HTTP status when result is SIM_PROBE_OK or SIM_PROBE_ERR_HTTP
+    bool reused;             // Sent on an existing keep-alive connection
+    uint32_t dns_us;         // Name resolution (0 when answered from lwIP's cache)
+    uint32_t connect_us;     // TCP handshake (0 when the connection was reused)
+    uint32_t first_byte_us;  // Request sent -> first response byte
+    uint32_t total_us;       // Probe start -> end of response headers or failure
+} sim_rawprobe_report_t;
+
+typedef void (*sim_rawprobe_done_fn)(const sim_rawprobe_report_t *report, void *arg);
+
+// Probe HTTP HEAD dùng raw API của lwIP, không cần task riêng
+// Connectivity probe driven entirely by lwIP raw API callbacks
+typedef struct {
+    const char *host;
+    uint16_t port;
+    char request[SIM_PROBE_REQUEST_MAX];
+    uint16_t request_len;
+    uint32_t timeout_us;          // Limit for the DNS, connect and response stages
+
+    sim_rawprobe_done_fn done;
+    void *done_arg;
+
+    sim_rawprobe_state_t state;
+    struct tcp_pcb *pcb;
+    ip_addr_t addr;
+    sim_probe_parser_t parser;
+    bool retried;                 // Already reconnected once in this probe
+    uint32_t start_ccount;        // Probe start
+    uint32_t stage_ccount;        // Start of the current stage
+    sim_rawprobe_report_t report; // Report being filled in
+} sim_rawprobe_t;
+
+/**
+ * @brief Initializes a probe; no network activity happens here
+ *
+ * @param probe Probe
+ * @param host Host name, also sent in the Host header
+ * @param port TCP port
+ * @param path Request path
+ * @param timeout_ms Limit for each of the DNS, connect and response stages
+ * @param done Called in the tcpip thread when a probe finishes
+ * @param arg Passed to @p done
+ * @return false if the request does not fit SIM_PROBE_REQUEST_MAX
+ */
+bool sim_rawprobe_init(sim_rawprobe_t *probe, const char *host, uint16_t port, const char *path,
+                       uint32_t timeout_ms, sim_rawprobe_done_fn done, void *arg);
+
+/**
+ * @brief Starts one probe
+ *
+ * Must run in the tcpip thread, e.g. through tcpip_callback(). The result
+ * is delivered to the done callback; nothing blocks in between.
+ *
+ * @param probe Probe
+ * @return false if a probe is already in progress
+ */
+bool sim_rawprobe_start(sim_rawprobe_t *probe);
+
+#endif
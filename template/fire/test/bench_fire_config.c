@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fire_clock.h"
+#include "fire_config.h"
+#include "sysparam_emu.h"
+
+// Đọc cấu hình lúc khởi động: một lượt sysparam_iter_next so với tra từng khóa
+// bằng sysparam_get_data_static. Không có chỉ mục RAM của sysparam, mỗi lần tra
+// quét lại vùng từ đầu; có chỉ mục (SYSPARAM_INDEX_SIZE như firmware) thì mỗi
+// khóa tốn hai lần đọc. Vùng chứa các khóa fire.* cùng khóa của thành phần
+// khác, như trên thiết bị.
+#define BENCH_ROUNDS      200
+#define BENCH_OTHER_KEYS  24
+
+static const char *const keys[] = {
+    "fire.wifi.ssid", "fire.wifi.pass", "fire.mqtt.host", "fire.mqtt.port", "fire.mqtt.topic",
+    "fire.mqtt.client_id", "fire.mqtt.keepalive", "fire.probe.host", "fire.probe.port", "fire.probe.path",
+    "fire.sensor.pin", "fire.zone.debounce_us", "fire.zone.recovery_us",
+};
+#define KEY_COUNT (sizeof(keys) / sizeof(keys[0]))
+
+static bool populate(void)
+{
+    char key[24];
+    fire_config_t config = { .mqtt_port = 1883, .mqtt_keepalive_s = 30, .probe_port = 80, .sensor_pin = 12 };
+    fire_config_t update = {
+        .wifi_ssid = "office", .wifi_pass = "secret", .mqtt_host = "broker.example", .mqtt_port = 8883,
+        .mqtt_topic = "site/a/fire", .mqtt_client_id = "fire-a1", .mqtt_keepalive_s = 60,
+        .probe_host = "probe.example", .probe_port = 8080, .probe_path = "/health", .sensor_pin = 15,
+        .debounce_us = 50000, .recovery_us = 500000,
+    };
+
+    if (!sysparam_emu_format()) {
+        return false;
+    }
+    for (int i = 0; i < BENCH_OTHER_KEYS; i++) {
+        snprintf(key, sizeof(key), "app.setting%02d", i);
+        if (sysparam_set_int32(key, i) != SYSPARAM_OK) {
+            return false;
+        }
+    }
+    return fire_config_save(&config, &update, NULL) == SYSPARAM_OK && sysparam_emu_reboot();
+}
+
+int main(void)
+{
+    fire_config_t config;
+    fire_config_stats_t stats;
+    uint8_t value[80];
+    size_t len;
+    bool binary;
+
+    if (!populate()) {
+        printf("FAIL: could not populate the sysparam area\n");
+        return 1;
+    }
+
+    uint32_t reads = spiflash_host_stats.reads;
+    uint32_t start = fire_clock_cycles();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        memset(&config, 0, sizeof(config));
+        if (fire_config_load(&config, &stats) != SYSPARAM_OK || stats.applied != KEY_COUNT) {
+            printf("FAIL: load applied %u of %u keys\n", stats.applied, (unsigned)KEY_COUNT);
+            return 1;
+        }
+    }
+    uint32_t iter_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    uint32_t iter_reads = (spiflash_host_stats.reads - reads) / BENCH_ROUNDS;
+
+    reads = spiflash_host_stats.reads;
+    start = fire_clock_cycles();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t i = 0; i < KEY_COUNT; i++) {
+            if (sysparam_get_data_static(keys[i], value, sizeof(value), &len, &binary) != SYSPARAM_OK) {
+                printf("FAIL: %s not found\n", keys[i]);
+                return 1;
+            }
+        }
+    }
+    uint32_t lookup_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    uint32_t lookup_reads = (spiflash_host_stats.reads - reads) / BENCH_ROUNDS;
+
+    printf("fire_config load (%u fire keys among %u entries)\n", (unsigned)KEY_COUNT, stats.entries);
+    printf("  iterator pass   %6u flash reads %8.2f us\n", iter_reads, (double)iter_us / BENCH_ROUNDS);
+    printf("  per-key lookup  %6u flash reads %8.2f us\n", lookup_reads, (double)lookup_us / BENCH_ROUNDS);
+    if (SYSPARAM_INDEX_SIZE == 0 && iter_reads >= lookup_reads) {
+        printf("FAIL: the iterator pass does not read less flash than per-key lookups\n");
+        return 1;
+    }
+    if (SYSPARAM_INDEX_SIZE > 0 && lookup_reads > 3 * KEY_COUNT) {
+        printf("FAIL: indexed lookups take %u flash reads\n", lookup_reads);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "fire_fusion.h"
+#include "fusion_trace.h"
+
+// Quét ngưỡng bật trên các bản ghi fusion_*: mỗi ngưỡng phát lại mọi bản ghi,
+// in số đám cháy phát hiện, số báo động giả và độ trễ phát hiện trung bình
+#define SWEEP_ON_MIN  200
+#define SWEEP_ON_MAX  800
+#define SWEEP_ON_STEP 50
+// Các đám cháy trong bản ghi bắt đầu ở 300 s
+#define TRACE_FIRE_START_MS 300000
+
+static const char *const trace_names[] = { "fusion_flaming", "fusion_smoulder", "fusion_shower", "fusion_cooking" };
+#define TRACE_COUNT (sizeof(trace_names) / sizeof(trace_names[0]))
+
+static fusion_trace_t traces[TRACE_COUNT];
+
+typedef struct {
+    uint32_t detected;
+    uint32_t false_alarms;
+    uint32_t latency_ms; // Sum over detected fires
+} sweep_point_t;
+
+static void sweep_run(const fire_fusion_config_t *config, sweep_point_t *point, uint64_t *samples)
+{
+    fusion_replay_t result;
+    *point = (sweep_point_t){ 0 };
+    for (uint32_t t = 0; t < TRACE_COUNT; t++) {
+        fusion_trace_replay(&traces[t], config, &result);
+        *samples += traces[t].count;
+        if (result.alarm_epochs == 0) {
+            continue;
+        }
+        if (traces[t].expect_alarm) {
+            point->detected++;
+            point->latency_ms += result.first_alarm_ms - TRACE_FIRE_START_MS;
+        } else {
+            point->false_alarms++;
+        }
+    }
+}
+
+/**
+ * @return true if the variant has a threshold that detects every fire
+ *         without a false alarm
+ */
+static bool bench_sweep(const char *label, fire_fusion_config_t config, uint32_t fires)
+{
+    uint64_t samples = 0;
+    uint32_t runs = 0;
+    bool separates = false;
+
+    printf("fire_fusion %s\n", label);
+    printf("  score_on  detected  false  mean latency\n");
+    uint32_t start = fire_clock_cycles();
+    for (uint32_t on = SWEEP_ON_MIN; on <= SWEEP_ON_MAX; on += SWEEP_ON_STEP) {
+        sweep_point_t point;
+        config.score_on = on;
+        config.score_off = on * 5 / 9;
+        sweep_run(&config, &point, &samples);
+        runs += TRACE_COUNT;
+        if (point.detected == fires && point.false_alarms == 0) {
+            separates = true;
+        }
+        if (point.detected > 0) {
+            printf("  %8u  %4u/%-3u  %5u  %9.1f s\n", on, point.detected, fires, point.false_alarms,
+                   point.latency_ms / 1000.0 / point.detected);
+        } else {
+            printf("  %8u  %4u/%-3u  %5u  %11s\n", on, point.detected, fires, point.false_alarms, "-");
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    printf("  %u replays in %.1f ms: %.2f Msamples/s, %.1f us/replay\n", runs, elapsed_us / 1000.0,
+           (double)samples / elapsed_us, (double)elapsed_us / runs);
+    return separates;
+}
+
+int main(void)
+{
+    uint32_t fires = 0;
+
+    for (uint32_t t = 0; t < TRACE_COUNT; t++) {
+        if (!fusion_trace_load(&traces[t], trace_names[t])) {
+            return 1;
+        }
+        fires += traces[t].expect_alarm;
+    }
+
+    static const fire_fusion_config_t defaults = FIRE_FUSION_DEFAULTS;
+    fire_fusion_config_t no_inhibit = defaults;
+    no_inhibit.features[FIRE_FUSION_HUMIDITY].weight = 0;
+    fire_fusion_config_t any_agree = defaults;
+    any_agree.min_agree = 1;
+
+    bool separates = bench_sweep("defaults", defaults, fires);
+    bench_sweep("without humidity inhibit", no_inhibit, fires);
+    bench_sweep("single sensor may raise", any_agree, fires);
+    if (!separates) {
+        printf("FAIL: no score_on separates fires from nuisances with the defaults\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "fire_event.h"
+#include "fire_journal.h"
+#include "flash_emu.h"
+
+// Số bản ghi trong mỗi phép đo (nhiều lần ghi vòng qua vùng flash)
+#define BENCH_RECORDS 200000u
+#define BENCH_SECTORS 8
+
+// Thời gian điển hình của flash SPI dòng 25Q (datasheet): ghi một trang và xóa một sector
+#define FLASH_PAGE_PROGRAM_US 700
+#define FLASH_SECTOR_ERASE_US 45000
+
+static fire_journal_t journal;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Appends BENCH_RECORDS records, forcing a flush every flush_every records
+ * (1 = write-through, 0 = only the journal's own page-sized batches).
+ * Write amplification is flash bytes programmed per byte of record payload,
+ * counting each erased sector as a full sector rewrite.
+ */
+static int bench_run(const char *name, uint32_t flush_every)
+{
+    flash_emu_reset();
+    if (!fire_journal_mount(&journal, &flash_emu_ops, 0, BENCH_SECTORS)) {
+        return 1;
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        fire_journal_append(&journal, FIRE_EVENT_ALARM, i, i);
+        if (flush_every && (i + 1) % flush_every == 0) {
+            fire_journal_flush(&journal);
+        }
+    }
+    fire_journal_flush(&journal);
+    uint64_t elapsed = now_ns() - start;
+
+    uint64_t payload = (uint64_t)BENCH_RECORDS * FIRE_JOURNAL_RECORD_SIZE;
+    uint64_t device_us = (uint64_t)flash_emu_pages * FLASH_PAGE_PROGRAM_US +
+                         (uint64_t)flash_emu_erases * FLASH_SECTOR_ERASE_US;
+    double amplification = ((double)flash_emu_bytes + (double)flash_emu_erases * FIRE_FLASH_SECTOR_SIZE) / payload;
+
+    printf("%-16s host %8.0f rec/s, %6u page programs (%.3f/rec), %4u erases, "
+           "WA %.2f, ESP8266 est. %6.0f rec/s\n",
+           name, BENCH_RECORDS * 1e9 / elapsed, flash_emu_pages, (double)flash_emu_pages / BENCH_RECORDS,
+           flash_emu_erases, amplification, BENCH_RECORDS * 1e6 / device_us);
+    return journal.write_errors == 0 ? 0 : 1;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    failed |= bench_run("write-through", 1);
+    failed |= bench_run("flush every 4", 4);
+    failed |= bench_run("page batches", 0);
+    return failed;
+}
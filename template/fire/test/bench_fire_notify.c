@@ -0,0 +1,100 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fire_notify.h"
+#include "flash_emu.h"
+#include "mqtt_broker.h"
+
+// Số sự kiện gửi trong mỗi phép đo
+#define BENCH_EVENTS 1500u
+
+static mqtt_broker_t broker;
+static fire_notify_config_t config = {
+    .host = "127.0.0.1",
+    .topic = "fire/events",
+    .client_id = "fire-bench",
+    .keepalive_s = 10,
+    .command_timeout_ms = 100,
+};
+
+static void *notify_thread(void *arg)
+{
+    fire_notify_run();
+    return NULL;
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Posts BENCH_EVENTS events (all at once, like a burst of zone changes) while
+ * the broker drops the connection every drop_every PUBLISH packets, or is
+ * offline for outage_ms first so everything is drained after a reconnect.
+ */
+static int bench_run(const char *name, uint32_t drop_every, uint32_t outage_ms)
+{
+    fire_notify_stats_t stats;
+    pthread_t thread;
+
+    flash_emu_reset();
+    broker.drop_every = drop_every;
+    broker.offline = outage_ms > 0;
+    broker.log_count = 0;
+    broker.publishes = 0;
+    if (!fire_notify_init(&config, &flash_emu_ops, 0, FLASH_EMU_SIZE / FIRE_SPILL_SECTOR_SIZE)) {
+        return 1;
+    }
+    pthread_create(&thread, NULL, notify_thread, NULL);
+
+    uint64_t start = now_us();
+    for (uint32_t i = 0; i < BENCH_EVENTS; i++) {
+        fire_notify_post(FIRE_EVENT_ALARM, 1, fire_notify_now_ms());
+    }
+    if (outage_ms) {
+        usleep(outage_ms * 1000);
+        broker.offline = false;
+    }
+    do {
+        usleep(1000);
+        fire_notify_get_stats(&stats);
+    } while (stats.pending > 0 && now_us() - start < 60000000);
+    uint64_t elapsed = now_us() - start;
+
+    fire_notify_stop();
+    pthread_join(thread, NULL);
+
+    printf("%-18s %6u events in %5llu ms (%6.0f ev/s), sessions %4u, dup %4u, spilled %4u, dropped %u, "
+           "latency avg %4u ms max %5u ms\n",
+           name, stats.published, (unsigned long long)(elapsed / 1000),
+           stats.published * 1e6 / elapsed, stats.sessions, broker.publishes - stats.published,
+           stats.spilled, stats.dropped,
+           stats.latency_count ? (uint32_t)(stats.latency_sum_ms / stats.latency_count) : 0,
+           stats.latency_max_ms);
+    return stats.pending == 0 && stats.dropped == 0 ? 0 : 1;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    if (!mqtt_broker_start(&broker)) {
+        printf("cannot start broker\n");
+        return 1;
+    }
+    config.port = broker.port;
+
+    failed |= bench_run("stable", 0, 0);
+    failed |= bench_run("drop every 100", 100, 0);
+    failed |= bench_run("drop every 25", 25, 0);
+    failed |= bench_run("outage 500 ms", 0, 500);
+
+    mqtt_broker_stop(&broker);
+    return failed;
+}
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "fire_smoke.h"
+#include "smoke_trace.h"
+
+// Số lần chạy lại mỗi bản ghi trong một phép đo
+#define BENCH_REPEAT 200
+
+static const char *const trace_names[] = { "smoulder", "flaming", "nuisance", "drift" };
+#define TRACE_COUNT (sizeof(trace_names) / sizeof(trace_names[0]))
+
+static smoke_trace_t traces[TRACE_COUNT];
+static fire_smoke_ring_t ring;
+
+/**
+ * Timer-to-task pipeline on synthetic traces: every acquisition goes through
+ * the ring (as the sampling timer would push it), then each channel is
+ * filtered. Both channels replay the same trace.
+ */
+static int bench_filter(const char *label, const fire_smoke_config_t *config)
+{
+    fire_smoke_channel_t ch[FIRE_SMOKE_CHANNELS];
+    fire_smoke_sample_t sample, out;
+    uint64_t samples = 0, active = 0;
+    uint32_t ccount = 0;
+
+    fire_smoke_ring_init(&ring);
+    uint32_t start = fire_clock_cycles();
+    for (uint32_t r = 0; r < BENCH_REPEAT; r++) {
+        for (uint32_t t = 0; t < TRACE_COUNT; t++) {
+            for (int c = 0; c < FIRE_SMOKE_CHANNELS; c++) {
+                fire_smoke_init(&ch[c], config);
+            }
+            for (uint32_t i = 0; i < traces[t].count; i++) {
+                sample.ccount = ccount += 100000 * FIRE_CLOCK_HOST_MHZ;
+                for (int c = 0; c < FIRE_SMOKE_CHANNELS; c++) {
+                    sample.value[c] = traces[t].adc[i];
+                }
+                fire_smoke_ring_push(&ring, &sample);
+                while (fire_smoke_ring_pop(&ring, &out)) {
+                    for (int c = 0; c < FIRE_SMOKE_CHANNELS; c++) {
+                        active += fire_smoke_update(&ch[c], out.value[c]);
+                    }
+                    samples += FIRE_SMOKE_CHANNELS;
+                }
+            }
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    printf("fire_smoke %-22s: %.2f Msamples/s, %.1f ns/sample, %.2f%% active\n",
+           label, (double)samples / elapsed_us, elapsed_us * 1000.0 / samples, 100.0 * active / samples);
+    if (samples == 0 || fire_smoke_ring_overflows(&ring) != 0) {
+        printf("FAIL: %llu samples, %u overflows\n", (unsigned long long)samples, fire_smoke_ring_overflows(&ring));
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    for (uint32_t t = 0; t < TRACE_COUNT; t++) {
+        if (!smoke_trace_load(&traces[t], trace_names[t])) {
+            return 1;
+        }
+    }
+
+    static const fire_smoke_config_t average = { .average_shift = 3, .clean_air = 120, .level_on = 150, .level_off = 100 };
+    static const fire_smoke_config_t average_iir = {
+        .average_shift = 3, .iir_shift = 2, .clean_air = 120, .level_on = 150, .level_off = 100
+    };
+    static const fire_smoke_config_t defaults = FIRE_SMOKE_TOUT_DEFAULTS;
+    result |= bench_filter("average", &average);
+    result |= bench_filter("average+iir", &average_iir);
+    result |= bench_filter("average+iir+rise+base", &defaults);
+    return result;
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "fire_zones.h"
+#include "isr_ring.h"
+
+// Số snapshot GPIO đi qua pipeline trong mỗi phép đo
+#define BENCH_EVENTS 2000000u
+// Khoảng cách (mô phỏng) giữa hai ngắt liên tiếp
+#define BENCH_EVENT_SPACING_US 2000
+
+static isr_ring_t ring;
+static fire_zones_t zones;
+static fire_zone_config_t table[FIRE_ZONES_MAX];
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/**
+ * Full task-side pipeline: ring push (as the ISR would), drain, zone engine
+ * update, and timer expiry whenever the earliest zone timer is due.
+ * Each snapshot flips edges_per_event random zone inputs.
+ */
+static int bench_pipeline(uint8_t zone_count, uint32_t edges_per_event)
+{
+    fire_zones_batch_t batch;
+    isr_event_t ev;
+    uint64_t input = UINT64_MAX;
+    uint64_t used = zone_count == 64 ? UINT64_MAX : ((uint64_t)1 << zone_count) - 1;
+    uint32_t ccount = 0;
+    uint64_t zone_edges = 0, raised = 0, cleared = 0, batches = 0;
+
+    for (uint8_t i = 0; i < zone_count; i++) {
+        table[i].input = i;
+        table[i].active_high = false;
+        table[i].debounce_us = 20000;
+        table[i].recovery_us = 200000;
+    }
+    if (!fire_zones_init(&zones, table, zone_count)) {
+        printf("FAIL: init\n");
+        return 1;
+    }
+    isr_ring_init(&ring);
+
+    uint32_t start = fire_clock_cycles();
+    for (uint32_t i = 0; i < BENCH_EVENTS; i++) {
+        uint64_t flip = 0;
+        for (uint32_t e = 0; e < edges_per_event; e++) {
+            flip |= (uint64_t)1 << (rng_next() % zone_count);
+        }
+        input ^= flip & used;
+        ccount += BENCH_EVENT_SPACING_US * FIRE_CLOCK_HOST_MHZ;
+
+        // Từ đầu vào 64 bit được chia thành nhiều slot giống GPIO.IN 16 bit;
+        // ở đây mỗi sự kiện mang phần thấp, phần cao được giữ như cổng PCF8574
+        isr_ring_push(&ring, ccount, 0xffff, (uint16_t)input);
+
+        fire_zones_batch_clear(&batch);
+        while (isr_ring_pop(&ring, &ev)) {
+            fire_zones_input(&zones, (input & ~(uint64_t)0xffff) | ev.levels, ev.ccount, &batch);
+        }
+        uint32_t timeout_us;
+        if (fire_zones_next_timeout(&zones, ccount, &timeout_us) && timeout_us == 0) {
+            fire_zones_expire(&zones, ccount, &batch);
+        }
+        zone_edges += batch.edges;
+        raised += __builtin_popcountll(batch.raised);
+        cleared += __builtin_popcountll(batch.cleared);
+        batches += (batch.raised | batch.cleared) != 0;
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    printf("fire_zones zones=%-2u edges/event=%-2u: %.2f Mevents/s, %.2f Mzone-edges/s, "
+           "%llu raised, %llu cleared in %llu batches\n",
+           zone_count, edges_per_event,
+           (double)BENCH_EVENTS / elapsed_us, (double)zone_edges / elapsed_us,
+           (unsigned long long)raised, (unsigned long long)cleared,
+           (unsigned long long)batches);
+
+    if (zone_edges == 0) {
+        printf("FAIL: no zone edges\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    result |= bench_pipeline(1, 1);
+    result |= bench_pipeline(8, 1);
+    result |= bench_pipeline(8, 4);
+    result |= bench_pipeline(64, 1);
+    result |= bench_pipeline(64, 8);
+    result |= bench_pipeline(64, 32);
+    return result;
+}
@@ -0,0 +1,157 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "isr_ring.h"
+
+// Số sự kiện cho phép đo push/pop đơn luồng
+#define BENCH_EVENTS 20000000u
+// Số burst cho phép đo producer/consumer hai luồng
+#define BENCH_BURSTS 20000u
+
+static isr_ring_t ring;
+
+// Mô phỏng task notification (counting semaphore) và tín hiệu "đã xử lý xong burst"
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static uint32_t notify_count;
+static uint32_t bursts_done;
+static int producer_done;
+
+static uint32_t burst_size;
+static uint32_t notifications;
+
+/**
+ * Raw cost of publishing and consuming one event, no contention.
+ */
+static void bench_single_thread(void)
+{
+    isr_event_t ev;
+    uint32_t sum = 0;
+
+    isr_ring_init(&ring);
+    uint32_t start = fire_clock_cycles();
+    for (uint32_t i = 0; i < BENCH_EVENTS; i++) {
+        isr_ring_push(&ring, i, 1 << 12, 0);
+        if (isr_ring_pop(&ring, &ev)) {
+            sum += ev.ccount;
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    printf("isr_ring push+pop: %u events in %u us (%.1f Mevents/s, %.1f ns/event) [%u]\n",
+           BENCH_EVENTS, elapsed_us, (double)BENCH_EVENTS / elapsed_us,
+           elapsed_us * 1000.0 / BENCH_EVENTS, sum & 1);
+}
+
+static void *producer(void *arg)
+{
+    for (uint32_t b = 0; b < BENCH_BURSTS; b++) {
+        // Một burst cạnh GPIO liên tiếp, giống như ISR bị gọi dồn dập
+        for (uint32_t i = 0; i < burst_size; i++) {
+            if (isr_ring_push(&ring, b * burst_size + i, 1 << 12, 0) == ISR_RING_WAKE) {
+                notifications++;
+                pthread_mutex_lock(&lock);
+                notify_count++;
+                pthread_cond_signal(&cond);
+                pthread_mutex_unlock(&lock);
+            }
+        }
+        // Chờ consumer xử lý xong trước burst tiếp theo
+        pthread_mutex_lock(&lock);
+        while (bursts_done <= b) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    pthread_mutex_lock(&lock);
+    producer_done = 1;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+/**
+ * Bursts of back-to-back events from a producer thread, drained by a consumer
+ * that sleeps on a notification between bursts.
+ */
+static int bench_bursts(uint32_t size)
+{
+    pthread_t thread;
+    isr_event_t ev;
+    uint32_t received = 0, out_of_order = 0, last = 0;
+
+    isr_ring_init(&ring);
+    burst_size = size;
+    notifications = 0;
+    notify_count = 0;
+    bursts_done = 0;
+    producer_done = 0;
+
+    uint32_t start = fire_clock_cycles();
+    pthread_create(&thread, NULL, producer, NULL);
+    while (1) {
+        pthread_mutex_lock(&lock);
+        while (notify_count == 0 && !producer_done) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        notify_count = 0;
+        int done = producer_done;
+        pthread_mutex_unlock(&lock);
+        if (done) {
+            break;
+        }
+
+        while (isr_ring_pop(&ring, &ev)) {
+            if (received && ev.ccount <= last) {
+                out_of_order++;
+            }
+            last = ev.ccount;
+            received++;
+        }
+
+        // Producer đã đẩy xong burst hiện tại khi đã phát hết burst_size sự kiện
+        pthread_mutex_lock(&lock);
+        uint32_t produced = __atomic_load_n(&ring.head, __ATOMIC_SEQ_CST) + isr_ring_overflows(&ring);
+        if (produced >= (bursts_done + 1) * burst_size && ring.head == ring.tail) {
+            bursts_done++;
+            pthread_cond_broadcast(&cond);
+        } else {
+            // Burst chưa xong: tự đánh thức lại để tiếp tục xử lý
+            notify_count++;
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    pthread_join(thread, NULL);
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    uint32_t dropped = isr_ring_overflows(&ring);
+    printf("isr_ring burst=%-3u: %u bursts in %u us, received=%u dropped=%u "
+           "notifications/burst=%.2f\n",
+           size, BENCH_BURSTS, elapsed_us, received, dropped,
+           (double)notifications / BENCH_BURSTS);
+
+    if (received + dropped != BENCH_BURSTS * size || out_of_order != 0) {
+        printf("FAIL\n");
+        return 1;
+    }
+    // Burst không vượt quá kích thước ring thì không được mất sự kiện
+    if (size <= ISR_RING_SIZE && dropped != 0) {
+        printf("FAIL: events dropped with burst <= ring size\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    bench_single_thread();
+    result |= bench_bursts(1);
+    result |= bench_bursts(8);
+    result |= bench_bursts(ISR_RING_SIZE);
+    result |= bench_bursts(4 * ISR_RING_SIZE);
+    return result;
+}
@@ -0,0 +1,96 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "sim_probe.h"
+
+// Số lần phân tích lại mỗi phản hồi trong một phép đo
+#define BENCH_REPEAT 20000
+
+// Phản hồi HEAD mẫu trong traces/ (viết tay theo dạng phản hồi của các máy chủ
+// đó, không phải bản bắt gói; CRLF) và kết quả đúng
+typedef struct {
+    const char *name;
+    uint16_t status;
+    bool keep_alive;
+    char data[SIM_PROBE_HEADER_MAX];
+    int len;
+} response_t;
+
+static response_t responses[] = {
+    { "http_gstatic_204", 204, true },
+    { "http_nginx_200", 200, true },
+    { "http_apache_301_close", 301, false },
+    { "http_portal_302", 302, false },
+    { "http_cloudflare_503", 503, true },
+};
+#define RESPONSE_COUNT (sizeof(responses) / sizeof(responses[0]))
+
+static bool response_load(response_t *resp)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "traces/%s.http", resp->name);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("%s: cannot open\n", path);
+        return false;
+    }
+    resp->len = fread(resp->data, 1, sizeof(resp->data), f);
+    fclose(f);
+    return resp->len > 0;
+}
+
+/**
+ * Every sample response fed in @p chunk byte pieces, as the probe gets
+ * them from recv() or from a pbuf chain (536 is one TCP segment at the
+ * ESP8266 default MSS); 0 feeds the whole response at once.
+ */
+static int bench_parse(int chunk)
+{
+    sim_probe_parser_t parser;
+    uint64_t bytes = 0;
+
+    uint32_t start = fire_clock_cycles();
+    for (uint32_t r = 0; r < BENCH_REPEAT; r++) {
+        for (uint32_t i = 0; i < RESPONSE_COUNT; i++) {
+            const response_t *resp = &responses[i];
+            int step = chunk > 0 ? chunk : resp->len;
+            int done = 0;
+
+            sim_probe_parser_init(&parser);
+            for (int pos = 0; pos < resp->len && done == 0; pos += step) {
+                int n = resp->len - pos < step ? resp->len - pos : step;
+                done = sim_probe_parser_feed(&parser, resp->data + pos, n);
+            }
+            if (done != 1 || parser.status != resp->status || parser.keep_alive != resp->keep_alive ||
+                parser.received != resp->len) {
+                printf("FAIL: %s chunk %d: result %d, status %u, keep-alive %d, %u of %d bytes\n", resp->name,
+                       chunk, done, parser.status, parser.keep_alive, parser.received, resp->len);
+                return 1;
+            }
+            bytes += resp->len;
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    printf("sim_probe parse, chunk %4d: %.1f MB/s, %.0f ns/response\n", chunk, (double)bytes / elapsed_us,
+           elapsed_us * 1000.0 / ((uint64_t)BENCH_REPEAT * RESPONSE_COUNT));
+    return 0;
+}
+
+int main(void)
+{
+    static const int chunks[] = { 1, 16, 64, 536, 0 };
+    int result = 0;
+
+    for (uint32_t i = 0; i < RESPONSE_COUNT; i++) {
+        if (!response_load(&responses[i])) {
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        result |= bench_parse(chunks[i]);
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spiflash_host.h"
+
+// Ba đường đọc của spiflash_read trên flash 4 MB theo mô hình thời gian của
+// spiflash_host.h: cả lần đọc trong một đoạn găng (trước đây), đọc thô chia
+// đoạn SPIFLASH_READ_CHUNK byte, và đọc qua cửa sổ cache ánh xạ MB đầu. Thông
+// lượng tính theo thời gian flash; độ trễ ngắt là đoạn găng dài nhất, thời gian
+// một ISR phải chờ thêm khi ngắt đến lúc đang đọc
+#define BENCH_FLASH_SIZE (4 * 1024 * 1024)
+#define BENCH_READ_BYTES (1024 * 1024)
+
+typedef struct {
+    const char *name;
+    uint32_t chunk;
+    uint32_t mmap_size;
+    uint32_t addr;       // Đầu vùng đọc
+} read_path_t;
+
+static const read_path_t paths[] = {
+    { "single", 0, 0, 0x300000 },
+    { "chunked", SPIFLASH_HOST_READ_CHUNK, SPIFLASH_HOST_MMAP_SIZE, 0x300000 },
+    { "mmap", SPIFLASH_HOST_READ_CHUNK, SPIFLASH_HOST_MMAP_SIZE, 0x10000 },
+};
+
+static const uint32_t read_sizes[] = { 16, 60, 256, 4096, 65536 };
+
+static int bench_read(const read_path_t *path, uint32_t size, uint8_t *buf)
+{
+    spiflash_host_read_chunk = path->chunk;
+    spiflash_host_mmap_size = path->mmap_size;
+    spiflash_host_reset_stats();
+    for (uint32_t done = 0; done < BENCH_READ_BYTES; done += size) {
+        // Đọc lệch 4 byte mỗi lần như các bản ghi nối tiếp nhau
+        if (!spiflash_read(path->addr + done % 0x80000 + (done / size) % 4, buf, size)) {
+            printf("FAIL: %s read of %u bytes\n", path->name, size);
+            return 1;
+        }
+    }
+
+    double mb_s = (double)BENCH_READ_BYTES / spiflash_host_stats.busy_ns * 1e3;
+    printf("spiflash read %-7s %5u bytes: %5.2f MB/s, %4u sections, interrupts off max %6.1f us\n",
+           path->name, size, mb_s, spiflash_host_stats.read_sections / (BENCH_READ_BYTES / size),
+           spiflash_host_stats.read_irq_off_max_ns / 1000.0);
+
+    uint32_t limit = path->chunk > 0 ? (path->chunk + SPIFLASH_HOST_READ_BLOCK - 1) / SPIFLASH_HOST_READ_BLOCK *
+                                       SPIFLASH_HOST_READ_BLOCK_NS : UINT32_MAX;
+    if (spiflash_host_stats.read_irq_off_max_ns > limit) {
+        printf("FAIL: %s read held interrupts for %u ns\n", path->name, spiflash_host_stats.read_irq_off_max_ns);
+        return 1;
+    }
+    if (path->addr < path->mmap_size && spiflash_host_stats.read_sections != 0) {
+        printf("FAIL: %s read left the cache window\n", path->name);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int result = 0;
+    uint8_t *buf = malloc(read_sizes[sizeof(read_sizes) / sizeof(read_sizes[0]) - 1] + 4);
+
+    if (buf == NULL || !spiflash_host_open(NULL, BENCH_FLASH_SIZE)) {
+        printf("FAIL: cannot open flash\n");
+        return 1;
+    }
+    for (uint32_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++) {
+        for (uint32_t s = 0; s < sizeof(read_sizes) / sizeof(read_sizes[0]); s++) {
+            result |= bench_read(&paths[p], read_sizes[s], buf);
+        }
+    }
+    spiflash_host_close();
+    free(buf);
+    return result;
+}
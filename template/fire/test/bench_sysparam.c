@@ -0,0 +1,197 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fire_clock.h"
+#include "sysparam_emu.h"
+
+// Tra khóa sysparam với 10, 100 và 500 khóa trên flash giả lập. Cùng file được
+// biên dịch hai lần: bench_sysparam với chỉ mục RAM (SYSPARAM_INDEX_SIZE=512)
+// và bench_sysparam_scan không có chỉ mục, mỗi lần tra quét vùng từ đầu.
+#define BENCH_LOOKUPS 20000
+// 500 khóa "bench.key.NNN" với giá trị int32 cần 12,5 KB mỗi region
+#define BENCH_SECTORS 8
+
+static const int key_counts[] = { 10, 100, 500 };
+
+static int bench_keys(int count)
+{
+    char key[24];
+    int32_t value;
+
+    if (!sysparam_emu_format_sectors(BENCH_SECTORS)) {
+        printf("FAIL: cannot format\n");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "bench.key.%03d", i);
+        if (sysparam_set_int32(key, i) != SYSPARAM_OK) {
+            printf("FAIL: set %s\n", key);
+            return 1;
+        }
+    }
+
+    uint32_t reads = spiflash_host_stats.reads;
+    uint32_t start = fire_clock_cycles();
+    if (!sysparam_emu_reboot()) {
+        printf("FAIL: init\n");
+        return 1;
+    }
+    uint32_t init_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    uint32_t init_reads = spiflash_host_stats.reads - reads;
+
+    // Khóa rải đều trong vùng; khóa ở cuối vùng là trường hợp xấu nhất khi quét
+    reads = spiflash_host_stats.reads;
+    uint64_t busy_ns = spiflash_host_stats.busy_ns;
+    start = fire_clock_cycles();
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        int k = (i * 7919) % count;
+        snprintf(key, sizeof(key), "bench.key.%03d", k);
+        if (sysparam_get_int32(key, &value) != SYSPARAM_OK || value != k) {
+            printf("FAIL: get %s\n", key);
+            return 1;
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+    reads = spiflash_host_stats.reads - reads;
+    busy_ns = spiflash_host_stats.busy_ns - busy_ns;
+
+    // Thời gian đọc flash của chip thật theo mô hình của spiflash_host.h
+    printf("sysparam %-5s %3d keys: init %5u reads %6u us, get %6.1f reads %7.0f ns (flash %6.1f us)\n",
+           SYSPARAM_INDEX_SIZE > 0 ? "index" : "scan", count, init_reads, init_us,
+           (double)reads / BENCH_LOOKUPS, elapsed_us * 1000.0 / BENCH_LOOKUPS,
+           (double)busy_ns / 1000 / BENCH_LOOKUPS);
+    // Có chỉ mục: một lần đọc kiểm tra khóa và một lần đọc giá trị, thêm một
+    // lần cho mỗi khóa khác trùng hash 16 bit (hiếm)
+    if (SYSPARAM_INDEX_SIZE > 0 && reads > 2 * BENCH_LOOKUPS + BENCH_LOOKUPS / 10) {
+        printf("FAIL: %u reads for %d lookups\n", reads, BENCH_LOOKUPS);
+        return 1;
+    }
+    return 0;
+}
+
+// Đổi 8 khóa (như một bộ cấu hình Wi-Fi/MQTT) từng khóa một và trong một giao
+// dịch; cả hai lặp tới sau vài lần nén để tính cả chi phí nén vào mỗi lần lưu
+#define BENCH_TXN_KEYS   8
+#define BENCH_TXN_ROUNDS 1000
+
+static uint32_t single_writes;
+
+static int bench_update(bool txn)
+{
+    char key[24];
+
+    if (!sysparam_emu_format_sectors(BENCH_SECTORS)) {
+        printf("FAIL: cannot format\n");
+        return 1;
+    }
+    spiflash_host_reset_stats();
+    uint32_t start = fire_clock_cycles();
+    for (int round = 0; round < BENCH_TXN_ROUNDS; round++) {
+        sysparam_txn_t t;
+        sysparam_status_t status = SYSPARAM_OK;
+        sysparam_txn_begin(&t);
+        for (int i = 0; i < BENCH_TXN_KEYS && status == SYSPARAM_OK; i++) {
+            snprintf(key, sizeof(key), "net.setting.%d", i);
+            status = txn ? sysparam_txn_set_int32(&t, key, round * 100 + i) : sysparam_set_int32(key, round * 100 + i);
+        }
+        if (txn) {
+            status = sysparam_txn_commit(&t);
+        } else {
+            sysparam_txn_abort(&t);
+        }
+        if (status != SYSPARAM_OK) {
+            printf("FAIL: round %d (%d)\n", round, status);
+            return 1;
+        }
+    }
+    uint32_t elapsed_us = fire_clock_cycles_to_us(fire_clock_cycles() - start);
+
+    printf("sysparam %-5s update %d keys %-6s: %5.1f writes %4.1f pages %5.2f erases, flash %7.1f us, host %5.1f us\n",
+           SYSPARAM_INDEX_SIZE > 0 ? "index" : "scan", BENCH_TXN_KEYS, txn ? "txn" : "single",
+           (double)spiflash_host_stats.writes / BENCH_TXN_ROUNDS, (double)spiflash_host_stats.pages / BENCH_TXN_ROUNDS,
+           (double)spiflash_host_stats.erases / BENCH_TXN_ROUNDS,
+           (double)spiflash_host_stats.busy_ns / 1000 / BENCH_TXN_ROUNDS, (double)elapsed_us / BENCH_TXN_ROUNDS);
+    if (!txn) {
+        single_writes = spiflash_host_stats.writes;
+    } else if (spiflash_host_stats.writes >= single_writes) {
+        printf("FAIL: a transaction takes %u flash writes, single sets %u\n", spiflash_host_stats.writes, single_writes);
+        return 1;
+    }
+    return 0;
+}
+
+// Ghi liên tục 4 bộ đếm trên 24 khóa cấu hình: nén trong lần ghi hết chỗ, hoặc
+// một lát sysparam_compact_step (như task ưu tiên thấp) sau mỗi lần ghi. Độ
+// trễ tính theo đồng hồ của spiflash_host.c, tức thời gian flash của chip thật
+#define BENCH_BG_UPDATES  20000
+#define BENCH_BG_SLICE_US 5000
+
+static uint32_t foreground_set_max_us;
+
+static int bench_background(bool background)
+{
+    char key[24];
+    sysparam_stats_t stats;
+    size_t threshold = BENCH_SECTORS / 2 * SPI_FLASH_SEC_SIZE / 4;
+
+    if (!sysparam_emu_format_sectors(BENCH_SECTORS)) {
+        printf("FAIL: cannot format\n");
+        return 1;
+    }
+    for (int i = 0; i < 24; i++) {
+        snprintf(key, sizeof(key), "net.setting.%d", i);
+        if (sysparam_set_int32(key, i) != SYSPARAM_OK) {
+            printf("FAIL: set %s\n", key);
+            return 1;
+        }
+    }
+    // Thống kê tính từ sysparam_init()
+    if (!sysparam_emu_reboot()) {
+        printf("FAIL: init\n");
+        return 1;
+    }
+    spiflash_host_reset_stats();
+    for (int i = 0; i < BENCH_BG_UPDATES; i++) {
+        snprintf(key, sizeof(key), "app.counter.%d", i % 4);
+        if (sysparam_set_int32(key, i) != SYSPARAM_OK) {
+            printf("FAIL: update %d\n", i);
+            return 1;
+        }
+        if (background && sysparam_compact_step(threshold, BENCH_BG_SLICE_US) < 0) {
+            printf("FAIL: compact step %d\n", i);
+            return 1;
+        }
+    }
+    if (sysparam_get_stats(&stats) != SYSPARAM_OK) {
+        printf("FAIL: stats\n");
+        return 1;
+    }
+
+    printf("sysparam %-5s compaction %-10s: worst set %6u us, step %5u us, %2u+%2u compactions, "
+           "%3u sector erases, flash %5.2f ms/set\n",
+           SYSPARAM_INDEX_SIZE > 0 ? "index" : "scan", background ? "background" : "in write",
+           stats.set_max_us, stats.step_max_us, stats.compactions, stats.background_compactions,
+           stats.sector_erases, (double)spiflash_host_stats.busy_ns / 1e6 / BENCH_BG_UPDATES);
+    if (!background) {
+        foreground_set_max_us = stats.set_max_us;
+    } else if (stats.compactions > 0 || stats.set_max_us * 4 > foreground_set_max_us) {
+        printf("FAIL: background compaction left %u compactions in writes, worst set %u us\n",
+               stats.compactions, stats.set_max_us);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    for (uint32_t i = 0; i < sizeof(key_counts) / sizeof(key_counts[0]); i++) {
+        result |= bench_keys(key_counts[i]);
+    }
+    result |= bench_update(false);
+    result |= bench_update(true);
+    result |= bench_background(false);
+    result |= bench_background(true);
+    return result;
+}
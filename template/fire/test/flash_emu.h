@@ -0,0 +1,84 @@
+#ifndef FLASH_EMU_H
+#define FLASH_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fire_flash.h"
+
+// Flash NOR giả lập trong RAM cho các test chạy trên host:
+// ghi chỉ xóa bit (1 -> 0), xóa đặt cả sector về 0xff.
+#define FLASH_EMU_SIZE (16 * FIRE_FLASH_SECTOR_SIZE)
+
+static uint8_t flash_emu[FLASH_EMU_SIZE];
+static uint32_t flash_emu_reads;
+static uint32_t flash_emu_writes;
+static uint32_t flash_emu_erases;
+static uint32_t flash_emu_bytes;   // Bytes programmed
+static uint32_t flash_emu_pages;   // Page program operations (a write spanning two pages costs two)
+// Số byte còn ghi được trước khi "mất điện" (UINT32_MAX = không giới hạn)
+static uint32_t flash_emu_budget = UINT32_MAX;
+
+static void flash_emu_reset(void)
+{
+    memset(flash_emu, 0xff, sizeof(flash_emu));
+    flash_emu_reads = 0;
+    flash_emu_writes = 0;
+    flash_emu_erases = 0;
+    flash_emu_bytes = 0;
+    flash_emu_pages = 0;
+    flash_emu_budget = UINT32_MAX;
+}
+
+static bool flash_emu_read(uint32_t addr, void *buf, uint32_t len)
+{
+    if (addr + len > FLASH_EMU_SIZE) {
+        return false;
+    }
+    memcpy(buf, flash_emu + addr, len);
+    flash_emu_reads++;
+    return true;
+}
+
+static bool flash_emu_write(uint32_t addr, const void *buf, uint32_t len)
+{
+    const uint8_t *src = buf;
+
+    if (addr + len > FLASH_EMU_SIZE) {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (flash_emu_budget == 0) {
+            return false;
+        }
+        if (flash_emu_budget != UINT32_MAX) {
+            flash_emu_budget--;
+        }
+        flash_emu[addr + i] &= src[i];
+    }
+    flash_emu_writes++;
+    flash_emu_bytes += len;
+    if (len > 0) {
+        flash_emu_pages += (addr + len - 1) / FIRE_FLASH_PAGE_SIZE - addr / FIRE_FLASH_PAGE_SIZE + 1;
+    }
+    return true;
+}
+
+static bool flash_emu_erase(uint32_t addr)
+{
+    if (addr % FIRE_FLASH_SECTOR_SIZE != 0 || addr >= FLASH_EMU_SIZE || flash_emu_budget == 0) {
+        return false;
+    }
+    memset(flash_emu + addr, 0xff, FIRE_FLASH_SECTOR_SIZE);
+    flash_emu_erases++;
+    return true;
+}
+
+static const fire_flash_ops_t flash_emu_ops = {
+    .read = flash_emu_read,
+    .write = flash_emu_write,
+    .erase_sector = flash_emu_erase,
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef FUSION_TRACE_H
+#define FUSION_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fire_fusion.h"
+
+// Bản ghi cảm biến khí tổng hợp trong traces/ (sinh bởi trace_gen.c, không
+// phải dữ liệu đo): dòng "ms,sensor,value" theo thời gian đo
+// (sensor là gas, tvoc, eco2, temp hoặc rh, cùng đơn vị với fire_fusion.h),
+// dòng "# expect alarm" hoặc "# expect quiet" cho kết quả mong đợi
+#define FUSION_TRACE_MAX 8000
+
+typedef struct {
+    uint32_t count;
+    bool expect_alarm;
+    uint32_t ms[FUSION_TRACE_MAX];
+    uint8_t feature[FUSION_TRACE_MAX];
+    int32_t value[FUSION_TRACE_MAX];
+} fusion_trace_t;
+
+// Kết quả phát lại một bản ghi
+typedef struct {
+    uint32_t first_alarm_ms; // First epoch with the alarm raised, UINT32_MAX if none
+    uint32_t alarm_epochs;   // Epochs with the alarm raised
+    uint16_t peak_score;
+} fusion_replay_t;
+
+static const char *const fusion_trace_sensors[FIRE_FUSION_FEATURES] = {
+    [FIRE_FUSION_GAS] = "gas", [FIRE_FUSION_TVOC] = "tvoc", [FIRE_FUSION_ECO2] = "eco2",
+    [FIRE_FUSION_TEMP] = "temp", [FIRE_FUSION_HUMIDITY] = "rh",
+};
+
+/**
+ * @brief Loads traces/<name>.csv; @return false if it cannot be read
+ */
+static bool fusion_trace_load(fusion_trace_t *trace, const char *name)
+{
+    char path[64], line[80];
+    snprintf(path, sizeof(path), "traces/%s.csv", name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("%s: cannot open\n", path);
+        return false;
+    }
+    trace->count = 0;
+    trace->expect_alarm = false;
+    while (fgets(line, sizeof(line), f) != NULL && trace->count < FUSION_TRACE_MAX) {
+        if (strncmp(line, "# expect alarm", 14) == 0) {
+            trace->expect_alarm = true;
+        }
+        char *end;
+        unsigned long ms = strtoul(line, &end, 10);
+        if (end == line || *end != ',') {
+            continue;
+        }
+        char *sensor = end + 1;
+        char *comma = strchr(sensor, ',');
+        if (comma == NULL) {
+            continue;
+        }
+        *comma = '\0';
+        for (int i = 0; i < FIRE_FUSION_FEATURES; i++) {
+            if (strcmp(sensor, fusion_trace_sensors[i]) == 0) {
+                trace->ms[trace->count] = ms;
+                trace->feature[trace->count] = i;
+                trace->value[trace->count] = strtol(comma + 1, NULL, 10);
+                trace->count++;
+                break;
+            }
+        }
+    }
+    fclose(f);
+    return trace->count > 0;
+}
+
+/**
+ * @brief Replays a trace: the engine is stepped to each sample's time before
+ *        the sample is added, as the polling task does
+ */
+static void fusion_trace_replay(const fusion_trace_t *trace, const fire_fusion_config_t *config,
+                                fusion_replay_t *result)
+{
+    fire_fusion_t fusion;
+    uint32_t epochs = 0;
+
+    memset(result, 0, sizeof(*result));
+    result->first_alarm_ms = UINT32_MAX;
+    fire_fusion_init(&fusion, config, 0);
+    for (uint32_t i = 0; i <= trace->count; i++) {
+        uint32_t now = i < trace->count ? trace->ms[i] : trace->ms[trace->count - 1] + config->align_ms;
+        bool alarm = fire_fusion_step(&fusion, now);
+        if (fusion.epochs != epochs) {
+            // Các mốc giữa hai mẫu có cùng điểm và trạng thái với mốc cuối
+            uint32_t scored_ms = fusion.next_epoch_ms - config->epoch_ms;
+            if (fusion.score > result->peak_score) {
+                result->peak_score = fusion.score;
+            }
+            if (alarm) {
+                result->alarm_epochs += fusion.epochs - epochs;
+                if (result->first_alarm_ms == UINT32_MAX) {
+                    result->first_alarm_ms = scored_ms;
+                }
+            }
+            epochs = fusion.epochs;
+        }
+        if (i < trace->count) {
+            fire_fusion_sample(&fusion, trace->feature[i], trace->value[i], trace->ms[i]);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Bản thay thế tối thiểu để biên dịch paho_mqtt_c và sysparam trên host
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY      0xffffffff
+
+#endif
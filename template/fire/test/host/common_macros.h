@@ -0,0 +1,6 @@
+#ifndef HOST_COMMON_MACROS_H
+#define HOST_COMMON_MACROS_H
+
+#define BIT(X) (1 << (X))
+
+#endif
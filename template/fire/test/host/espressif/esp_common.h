@@ -0,0 +1,7 @@
+#ifndef HOST_ESP_COMMON_H
+#define HOST_ESP_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#endif
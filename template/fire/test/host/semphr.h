@@ -0,0 +1,24 @@
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+// Test trên host chạy một luồng: mutex của sysparam không cần khóa thật
+typedef void *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)1;
+}
+
+static inline int xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    return 1;
+}
+
+static inline int xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return 1;
+}
+
+#endif
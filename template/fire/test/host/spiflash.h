@@ -0,0 +1,14 @@
+#ifndef HOST_SPIFLASH_H
+#define HOST_SPIFLASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bản thay thế để biên dịch core/sysparam.c trên host; các hàm nằm trong spiflash_host.c
+#define SPI_FLASH_SECTOR_SIZE 4096
+
+bool spiflash_read(uint32_t addr, uint8_t *buf, uint32_t size);
+bool spiflash_write(uint32_t addr, uint8_t *buf, uint32_t size);
+bool spiflash_erase_sector(uint32_t addr);
+
+#endif
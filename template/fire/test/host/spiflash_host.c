@@ -0,0 +1,266 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "spiflash_host.h"
+
+spiflash_host_stats_t spiflash_host_stats;
+uint32_t spiflash_host_budget = UINT32_MAX;
+bool spiflash_host_strict;
+uint32_t spiflash_host_mmap_size;
+uint8_t spiflash_host_mmap_megabyte;
+uint32_t spiflash_host_read_chunk = SPIFLASH_HOST_READ_CHUNK;
+
+// Mô tả flash như SDK đọc từ header của ảnh; chip_size theo ảnh đang mở
+sdk_flashchip_t sdk_flashchip = {
+    .device_id = 0x1640ef, // W25Q32
+    .chip_size = 0,
+    .block_size = 65536,
+    .sector_size = SPI_FLASH_SECTOR_SIZE,
+    .page_size = SPIFLASH_HOST_PAGE_SIZE,
+    .status_mask = 0x1ffff,
+};
+
+static uint8_t *image;
+static uint32_t image_size;
+static int image_fd = -1;
+static uint32_t status_reg;
+
+static bool in_range(uint32_t addr, uint32_t size)
+{
+    return image != NULL && addr <= image_size && size <= image_size - addr;
+}
+
+static bool reject(void)
+{
+    spiflash_host_stats.errors++;
+    return false;
+}
+
+bool spiflash_host_open(const char *path, uint32_t size)
+{
+    struct stat st;
+    uint32_t old_size = 0;
+
+    spiflash_host_close();
+    if (path != NULL) {
+        image_fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (image_fd < 0 || fstat(image_fd, &st) != 0) {
+            perror(path);
+            spiflash_host_close();
+            return false;
+        }
+        old_size = st.st_size;
+        if (size == 0) {
+            size = old_size;
+        }
+    }
+    if (size == 0 || size % SPI_FLASH_SECTOR_SIZE != 0) {
+        spiflash_host_close();
+        return false;
+    }
+
+    if (image_fd >= 0) {
+        if (old_size < size && ftruncate(image_fd, size) != 0) {
+            perror(path);
+            spiflash_host_close();
+            return false;
+        }
+        image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, image_fd, 0);
+    } else {
+        image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (image == MAP_FAILED) {
+        image = NULL;
+        spiflash_host_close();
+        return false;
+    }
+    // Phần mới của ảnh là flash đã xóa
+    if (old_size < size) {
+        memset(image + old_size, 0xff, size - old_size);
+    }
+    image_size = size;
+    sdk_flashchip.chip_size = size;
+    spiflash_host_reset_stats();
+    spiflash_host_budget = UINT32_MAX;
+    return true;
+}
+
+void spiflash_host_close(void)
+{
+    if (image != NULL) {
+        if (image_fd >= 0) {
+            msync(image, image_size, MS_SYNC);
+        }
+        munmap(image, image_size);
+        image = NULL;
+    }
+    if (image_fd >= 0) {
+        close(image_fd);
+        image_fd = -1;
+    }
+    image_size = 0;
+    sdk_flashchip.chip_size = 0;
+}
+
+uint8_t *spiflash_host_data(void)
+{
+    return image;
+}
+
+void spiflash_host_reset_stats(void)
+{
+    memset(&spiflash_host_stats, 0, sizeof(spiflash_host_stats));
+}
+
+bool spiflash_read(uint32_t addr, uint8_t *buf, uint32_t size)
+{
+    if (!in_range(addr, size)) {
+        return reject();
+    }
+    memcpy(buf, image + addr, size);
+    spiflash_host_stats.reads++;
+    spiflash_host_stats.read_bytes += size;
+
+    uint32_t mmap_start = (uint32_t)spiflash_host_mmap_megabyte << 20;
+    if (addr >= mmap_start && addr - mmap_start < spiflash_host_mmap_size &&
+        size <= spiflash_host_mmap_size - (addr - mmap_start)) {
+        uint32_t offset = addr - mmap_start;
+        uint32_t lines = size > 0 ? (offset + size - 1) / SPIFLASH_HOST_CACHE_LINE - offset / SPIFLASH_HOST_CACHE_LINE + 1 : 0;
+        spiflash_host_stats.mmap_reads++;
+        spiflash_host_stats.busy_ns += (uint64_t)lines * SPIFLASH_HOST_CACHE_LINE_NS;
+        return true;
+    }
+    // Mỗi đoạn tắt ngắt trong thời gian đọc các khối của nó
+    uint32_t chunk = spiflash_host_read_chunk > 0 ? spiflash_host_read_chunk : size;
+    do {
+        uint32_t len = size < chunk ? size : chunk;
+        uint32_t blocks = (len + SPIFLASH_HOST_READ_BLOCK - 1) / SPIFLASH_HOST_READ_BLOCK;
+        uint32_t ns = (blocks > 0 ? blocks : 1) * SPIFLASH_HOST_READ_BLOCK_NS;
+        spiflash_host_stats.busy_ns += ns;
+        spiflash_host_stats.read_sections++;
+        if (ns > spiflash_host_stats.read_irq_off_max_ns) {
+            spiflash_host_stats.read_irq_off_max_ns = ns;
+        }
+        size -= len;
+    } while (size > 0);
+    return true;
+}
+
+bool spiflash_write(uint32_t addr, uint8_t *buf, uint32_t size)
+{
+    if (!in_range(addr, size) || spiflash_host_budget == 0) {
+        return reject();
+    }
+    if (spiflash_host_strict) {
+        for (uint32_t i = 0; i < size; i++) {
+            if (buf[i] & ~image[addr + i]) {
+                return reject();
+            }
+        }
+    }
+
+    // Mỗi trang chạm tới là một lần program
+    if (size > 0) {
+        uint32_t pages = (addr + size - 1) / SPIFLASH_HOST_PAGE_SIZE - addr / SPIFLASH_HOST_PAGE_SIZE + 1;
+        spiflash_host_stats.pages += pages;
+        spiflash_host_stats.busy_ns += (uint64_t)pages * SPIFLASH_HOST_PAGE_PROGRAM_US * 1000;
+    }
+    spiflash_host_stats.writes++;
+    for (uint32_t i = 0; i < size; i++) {
+        if (spiflash_host_budget == 0) {
+            // Mất điện giữa lần ghi: phần đã ghi vẫn nằm trong flash
+            return reject();
+        }
+        if (spiflash_host_budget != UINT32_MAX) {
+            spiflash_host_budget--;
+        }
+        spiflash_host_stats.stuck_bits += __builtin_popcount(buf[i] & ~image[addr + i] & 0xff);
+        image[addr + i] &= buf[i];
+        spiflash_host_stats.write_bytes++;
+    }
+    return true;
+}
+
+bool spiflash_erase_sector(uint32_t addr)
+{
+    if (addr % SPI_FLASH_SECTOR_SIZE != 0 || !in_range(addr, SPI_FLASH_SECTOR_SIZE) || spiflash_host_budget == 0) {
+        return reject();
+    }
+    spiflash_host_stats.erases++;
+    spiflash_host_stats.busy_ns += (uint64_t)SPIFLASH_HOST_SECTOR_ERASE_US * 1000;
+    for (uint32_t block = addr; block < addr + SPI_FLASH_SECTOR_SIZE; block += SPIFLASH_HOST_ERASE_BLOCK) {
+        if (spiflash_host_budget == 0) {
+            // Mất điện giữa lần xóa: khối đang xóa chỉ lên 1 một phần số bit
+            // (giả ngẫu nhiên nhưng lặp lại được), các khối sau giữ nguyên
+            uint32_t noise = block * 2654435761u;
+            for (uint32_t i = 0; i < SPIFLASH_HOST_ERASE_BLOCK; i++) {
+                noise = noise * 1103515245u + 12345u;
+                image[block + i] |= noise >> 24;
+            }
+            return reject();
+        }
+        if (spiflash_host_budget != UINT32_MAX) {
+            spiflash_host_budget--;
+        }
+        memset(image + block, 0xff, SPIFLASH_HOST_ERASE_BLOCK);
+    }
+    return true;
+}
+
+// ---- API của SDK: địa chỉ, bộ đệm và độ dài phải căn 4 byte ----
+
+static bool aligned(uint32_t addr, const void *buf, uint32_t size)
+{
+    return addr % 4 == 0 && (uintptr_t)buf % 4 == 0 && size % 4 == 0;
+}
+
+uint32_t sdk_spi_flash_get_id(void)
+{
+    return sdk_flashchip.device_id;
+}
+
+sdk_SpiFlashOpResult sdk_spi_flash_read_status(uint32_t *status)
+{
+    *status = status_reg;
+    return SPI_FLASH_RESULT_OK;
+}
+
+sdk_SpiFlashOpResult sdk_spi_flash_write_status(uint32_t status_value)
+{
+    status_reg = status_value & sdk_flashchip.status_mask;
+    return SPI_FLASH_RESULT_OK;
+}
+
+sdk_SpiFlashOpResult sdk_spi_flash_erase_sector(uint16_t sec)
+{
+    return spiflash_erase_sector((uint32_t)sec * SPI_FLASH_SEC_SIZE) ? SPI_FLASH_RESULT_OK : SPI_FLASH_RESULT_ERR;
+}
+
+sdk_SpiFlashOpResult sdk_spi_flash_write(uint32_t des_addr, uint32_t *src, uint32_t size)
+{
+    if (!aligned(des_addr, src, size)) {
+        reject();
+        return SPI_FLASH_RESULT_ERR;
+    }
+    return spiflash_write(des_addr, (uint8_t *)src, size) ? SPI_FLASH_RESULT_OK : SPI_FLASH_RESULT_ERR;
+}
+
+sdk_SpiFlashOpResult sdk_spi_flash_read(uint32_t src_addr, uint32_t *des, uint32_t size)
+{
+    if (!aligned(src_addr, des, size)) {
+        reject();
+        return SPI_FLASH_RESULT_ERR;
+    }
+    return spiflash_read(src_addr, (uint8_t *)des, size) ? SPI_FLASH_RESULT_OK : SPI_FLASH_RESULT_ERR;
+}
+
+// Đồng hồ µs của SDK khi không có bộ mô phỏng (sim_hw.c định nghĩa bản của
+// nó): chỉ chạy theo thời gian bận của flash, nên đo được độ trễ do flash
+uint32_t __attribute__((weak)) sdk_system_get_time(void)
+{
+    return (uint32_t)(spiflash_host_stats.busy_ns / 1000);
+}
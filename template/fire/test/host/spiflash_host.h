@@ -0,0 +1,110 @@
+#ifndef SPIFLASH_HOST_H
+#define SPIFLASH_HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// <> : spiflash.h và flashchip.h thay thế của bản build đang dùng (test/host hoặc sim/include)
+#include <spiflash.h>
+#include <flashchip.h>
+#include "espressif/spi_flash.h"
+
+// spiflash_read/write/erase_sector của core/spiflash.c và sdk_spi_flash_* của
+// SDK trên host, trên một ảnh flash mmap từ file (hoặc bộ nhớ ẩn danh). Giữ
+// ngữ nghĩa NOR: ghi chỉ xóa bit (1 -> 0), xóa theo sector về 0xff. Mỗi thao
+// tác được đếm và cộng thời gian của chip thật theo mô hình dưới đây, để
+// sysparam, spiffs, rboot-api... đo và fuzz được trên Linux.
+
+// Mô hình thời gian: flash NOR 4 MB kiểu W25Q32 (giá trị điển hình của
+// datasheet), đọc qua cửa sổ 64 byte SPI(0).W của ESP8266 ở 40 MHz
+#define SPIFLASH_HOST_READ_BLOCK      64
+#define SPIFLASH_HOST_READ_BLOCK_NS   2000  // Command, address and 64 data bytes
+#define SPIFLASH_HOST_PAGE_SIZE       256
+#define SPIFLASH_HOST_PAGE_PROGRAM_US 700
+#define SPIFLASH_HOST_SECTOR_ERASE_US 45000
+// Một lần xóa tiêu tốn spiflash_host_budget theo từng khối này (16 đơn vị mỗi sector)
+#define SPIFLASH_HOST_ERASE_BLOCK     256
+// Đọc qua cửa sổ flash ánh xạ bộ nhớ: cache nạp từng dòng 32 byte, mọi dòng
+// tính là trượt cache, cùng băng thông với đọc qua SPI(0).W
+#define SPIFLASH_HOST_CACHE_LINE      32
+#define SPIFLASH_HOST_CACHE_LINE_NS   1000
+// SPIFLASH_READ_CHUNK và SPIFLASH_MMAP_SIZE của core/include/spiflash.h
+#define SPIFLASH_HOST_READ_CHUNK      256
+#define SPIFLASH_HOST_MMAP_SIZE       0x100000
+
+// Thống kê từ lần mở ảnh (hoặc spiflash_host_reset_stats)
+// Statistics since the image was opened
+typedef struct {
+    uint32_t reads;        // Read calls
+    uint32_t writes;       // Write calls
+    uint32_t erases;       // Sector erases
+    uint32_t pages;        // Page program operations (a write spanning two pages costs two)
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint32_t stuck_bits;   // Bits written as 1 over a programmed 0, which NOR cannot do
+    uint32_t errors;       // Calls rejected (out of range, misaligned, power lost)
+    uint64_t busy_ns;      // Modelled device time of all operations
+    uint32_t mmap_reads;   // Reads served from the memory-mapped window
+    uint32_t read_sections;       // Critical sections of raw reads
+    uint32_t read_irq_off_max_ns; // Longest of them, interrupts and cache disabled
+} spiflash_host_stats_t;
+
+extern spiflash_host_stats_t spiflash_host_stats;
+
+// Số byte còn ghi được (mỗi khối SPIFLASH_HOST_ERASE_BLOCK byte được xóa tính
+// một đơn vị) trước khi "mất điện": ghi hoặc xóa dừng giữa chừng và mọi thao
+// tác ghi/xóa sau đó thất bại (UINT32_MAX = không giới hạn). Sector đang xóa
+// dở giữ các khối đã xóa, khối đang xóa có bit ngẫu nhiên, phần còn lại như cũ
+extern uint32_t spiflash_host_budget;
+
+// Từ chối (trả false) lần ghi cố đặt bit 0 thành 1 thay vì chỉ đếm stuck_bits
+extern bool spiflash_host_strict;
+
+// Đường đọc như core/spiflash.c: spiflash_host_mmap_size byte đầu của MB
+// spiflash_host_mmap_megabyte (rboot_megabyte trên chip, MB của ROM đang chạy)
+// đọc qua cache, không tắt ngắt; phần còn lại qua SPI(0).W, mỗi đoạn
+// spiflash_host_read_chunk byte trong một đoạn găng (0 = cả lần đọc một đoạn,
+// như trước khi chia). Cửa sổ mặc định là 0 vì ảnh của các test nằm trọn trong
+// MB đầu: chúng giữ mô hình đọc thô; bench đặt SPIFLASH_HOST_MMAP_SIZE để so sánh
+extern uint32_t spiflash_host_mmap_size;
+extern uint8_t spiflash_host_mmap_megabyte;
+extern uint32_t spiflash_host_read_chunk;
+
+/**
+ * @brief Maps a flash image and makes it the current flash
+ *
+ * A missing file is created erased. An existing file keeps its content; it
+ * is grown to @p size with erased bytes if shorter. The previous image, if
+ * any, is closed first. Statistics and the write budget are reset.
+ *
+ * @param path Image file, or NULL for an erased image that is not kept
+ * @param size Flash size in bytes, a multiple of the sector size; 0 takes
+ *             the size of the existing file
+ * @return false if the file cannot be opened or mapped
+ */
+bool spiflash_host_open(const char *path, uint32_t size);
+
+/**
+ * @brief Writes the image back to its file and unmaps it
+ */
+void spiflash_host_close(void);
+
+/**
+ * @brief Content of the current image, sdk_flashchip.chip_size bytes
+ */
+uint8_t *spiflash_host_data(void);
+
+/**
+ * @brief Clears spiflash_host_stats
+ */
+void spiflash_host_reset_stats(void);
+
+/**
+ * @brief The SDK microsecond clock, unless the program defines its own
+ *
+ * Advances only with the modelled flash time (busy_ns), so the latency a
+ * caller measures with it is the flash time of what it did.
+ */
+uint32_t sdk_system_get_time(void);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef LWIP_MOCK_H
+#define LWIP_MOCK_H
+
+#include <stdint.h>
+
+// Các kiểu và hàm raw API của lwIP mà sim_rawprobe dùng, được test giả lập
+// Minimal stand-ins for the lwIP raw TCP, DNS and timer API used by sim_rawprobe
+
+typedef int8_t err_t;
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+
+#define ERR_OK          0
+#define ERR_MEM        -1
+#define ERR_TIMEOUT    -3
+#define ERR_INPROGRESS -5
+#define ERR_ABRT      -13
+#define ERR_RST       -14
+#define ERR_CLSD      -15
+#define ERR_ARG       -16
+
+#define IPADDR_TYPE_ANY 46
+
+typedef struct {
+    uint32_t addr;
+} ip_addr_t;
+
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    u16_t tot_len;
+    u16_t len;
+};
+
+struct tcp_pcb;
+
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+typedef err_t (*tcp_poll_fn)(void *arg, struct tcp_pcb *tpcb);
+typedef void (*tcp_err_fn)(void *arg, err_t err);
+typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *callback_arg);
+typedef void (*sys_timeout_handler)(void *arg);
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type);
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval);
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, tcp_connected_fn connected);
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags);
+err_t tcp_output(struct tcp_pcb *pcb);
+void tcp_recved(struct tcp_pcb *pcb, u16_t len);
+err_t tcp_close(struct tcp_pcb *pcb);
+void tcp_abort(struct tcp_pcb *pcb);
+u8_t pbuf_free(struct pbuf *p);
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg);
+void sys_timeout(uint32_t msecs, sys_timeout_handler handler, void *arg);
+void sys_untimeout(sys_timeout_handler handler, void *arg);
+
+#endif
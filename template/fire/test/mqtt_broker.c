@@ -0,0 +1,179 @@
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "mqtt_broker.h"
+
+static pthread_t broker_thread;
+static int broker_fd = -1;
+static volatile bool broker_stopping;
+static volatile bool broker_kick;
+
+// Đọc đúng len byte; false khi client đóng hoặc broker dừng
+static bool read_exact(int fd, uint8_t *buf, uint32_t len)
+{
+    while (len > 0) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (broker_stopping || broker_kick) {
+            return false;
+        }
+        if (poll(&pfd, 1, 20) <= 0) {
+            continue;
+        }
+        int r = read(fd, buf, len);
+        if (r <= 0) {
+            return false;
+        }
+        buf += r;
+        len -= r;
+    }
+    return true;
+}
+
+static bool send_all(int fd, const uint8_t *buf, uint32_t len)
+{
+    return send(fd, buf, len, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+// Lấy giá trị số của trường "name" trong payload JSON
+static uint32_t json_field(const char *payload, const char *name)
+{
+    char key[16];
+    snprintf(key, sizeof(key), "\"%s\":", name);
+    const char *p = strstr(payload, key);
+    if (p == NULL || strncmp(p + strlen(key), "null", 4) == 0) {
+        return UINT32_MAX;
+    }
+    return strtoul(p + strlen(key), NULL, 10);
+}
+
+// Xử lý một gói; false để đóng kết nối
+static bool handle_packet(mqtt_broker_t *broker, int fd, uint8_t header, uint8_t *body, uint32_t len)
+{
+    switch (header >> 4) {
+    case 1: { // CONNECT: 6 byte tên giao thức, 1 byte phiên bản, 1 byte cờ
+        static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+        broker->last_clean_session = len > 7 ? (body[7] >> 1) & 1 : 1;
+        broker->connects++;
+        return send_all(fd, connack, sizeof(connack));
+    }
+    case 3: { // PUBLISH
+        uint8_t qos = (header >> 1) & 3;
+        uint32_t topic_len = len >= 2 ? (body[0] << 8) | body[1] : 0;
+        uint32_t pos = 2 + topic_len;
+        uint8_t puback[] = { 0x40, 0x02, 0, 0 };
+        if (pos + (qos ? 2 : 0) > len) {
+            return false;
+        }
+        snprintf(broker->last_topic, sizeof(broker->last_topic), "%.*s", (int)topic_len, body + 2);
+        if (qos) {
+            puback[2] = body[pos];
+            puback[3] = body[pos + 1];
+            pos += 2;
+        }
+        snprintf(broker->last_payload, sizeof(broker->last_payload), "%.*s", (int)(len - pos), body + pos);
+        broker->last_qos = qos;
+        broker->publishes++;
+        if (broker->log_count < MQTT_BROKER_LOG_MAX) {
+            broker->seq_log[broker->log_count] = json_field(broker->last_payload, "seq");
+            broker->latency_log[broker->log_count] = json_field(broker->last_payload, "age");
+            broker->log_count++;
+        }
+        // Giả lập mất PUBACK: đã nhận nhưng đóng kết nối trước khi xác nhận
+        if (broker->drop_every && broker->publishes % broker->drop_every == 0) {
+            return false;
+        }
+        return qos == 0 || send_all(fd, puback, sizeof(puback));
+    }
+    case 12: { // PINGREQ
+        static const uint8_t pingresp[] = { 0xd0, 0x00 };
+        broker->pings++;
+        return send_all(fd, pingresp, sizeof(pingresp));
+    }
+    default: // DISCONNECT và các gói không hỗ trợ
+        return false;
+    }
+}
+
+static void serve_client(mqtt_broker_t *broker, int fd)
+{
+    uint8_t body[512];
+
+    while (!broker_stopping && !broker_kick) {
+        uint8_t header, byte;
+        uint32_t len = 0, shift = 0;
+
+        if (!read_exact(fd, &header, 1)) {
+            return;
+        }
+        do {
+            if (!read_exact(fd, &byte, 1) || shift > 21) {
+                return;
+            }
+            len |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (len > sizeof(body) || !read_exact(fd, body, len)) {
+            return;
+        }
+        if (!handle_packet(broker, fd, header, body, len)) {
+            return;
+        }
+    }
+}
+
+static void *broker_main(void *arg)
+{
+    mqtt_broker_t *broker = arg;
+
+    while (!broker_stopping) {
+        struct pollfd pfd = { .fd = broker_fd, .events = POLLIN };
+        if (poll(&pfd, 1, 20) <= 0) {
+            continue;
+        }
+        int fd = accept(broker_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        if (!broker->offline) {
+            broker_kick = false;
+            serve_client(broker, fd);
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+bool mqtt_broker_start(mqtt_broker_t *broker)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(addr);
+
+    memset(broker, 0, sizeof(*broker));
+    broker_stopping = false;
+    broker_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (broker_fd < 0 || bind(broker_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(broker_fd, 8) < 0 || getsockname(broker_fd, (struct sockaddr *)&addr, &len) < 0) {
+        return false;
+    }
+    broker->port = ntohs(addr.sin_port);
+    return pthread_create(&broker_thread, NULL, broker_main, broker) == 0;
+}
+
+void mqtt_broker_stop(mqtt_broker_t *broker)
+{
+    broker_stopping = true;
+    pthread_join(broker_thread, NULL);
+    close(broker_fd);
+    broker_fd = -1;
+}
+
+void mqtt_broker_kick(mqtt_broker_t *broker)
+{
+    broker_kick = true;
+}
@@ -0,0 +1,43 @@
+#ifndef MQTT_BROKER_H
+#define MQTT_BROKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Số PUBLISH tối đa được ghi lại
+#define MQTT_BROKER_LOG_MAX 65536
+
+// Broker MQTT giả lập cho test trên host: một client mỗi lúc,
+// trả lời CONNECT / PUBLISH QoS 1 / PINGREQ và có thể cắt kết nối theo ý muốn.
+typedef struct {
+    uint16_t port;
+    volatile bool offline;       // Close every new connection right away
+    volatile uint32_t drop_every; // Drop the connection instead of acking every N-th PUBLISH (0 = never)
+    volatile uint32_t connects;
+    volatile uint32_t publishes; // PUBLISH packets received, duplicates included
+    volatile uint32_t pings;
+    uint32_t log_count;
+    uint32_t seq_log[MQTT_BROKER_LOG_MAX];     // "seq" of each PUBLISH received
+    uint32_t latency_log[MQTT_BROKER_LOG_MAX]; // "age" field (ms), or UINT32_MAX if null
+    char last_payload[128];
+    char last_topic[64];
+    uint8_t last_qos;
+    uint8_t last_clean_session;
+} mqtt_broker_t;
+
+/**
+ * @brief Starts the broker on an ephemeral loopback port
+ */
+bool mqtt_broker_start(mqtt_broker_t *broker);
+
+/**
+ * @brief Stops the broker thread and closes its sockets
+ */
+void mqtt_broker_stop(mqtt_broker_t *broker);
+
+/**
+ * @brief Closes the current client connection, if any
+ */
+void mqtt_broker_kick(mqtt_broker_t *broker);
+
+#endif
@@ -0,0 +1,118 @@
+// Lớp mạng và timer của paho_mqtt_c trên host (thay cho MQTTESP8266.c)
+#include <netdb.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "paho_mqtt_c/MQTTESP8266.h"
+
+static TickType_t host_ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+char mqtt_timer_expired(mqtt_timer_t *timer)
+{
+    return (int32_t)(timer->end_time - host_ticks()) <= 0;
+}
+
+void mqtt_timer_countdown_ms(mqtt_timer_t *timer, unsigned int timeout)
+{
+    timer->end_time = host_ticks() + timeout / portTICK_PERIOD_MS;
+}
+
+void mqtt_timer_countdown(mqtt_timer_t *timer, unsigned int timeout)
+{
+    mqtt_timer_countdown_ms(timer, timeout * 1000);
+}
+
+int mqtt_timer_left_ms(mqtt_timer_t *timer)
+{
+    int32_t left = timer->end_time - host_ticks();
+    return left < 0 ? 0 : left * portTICK_PERIOD_MS;
+}
+
+void mqtt_timer_init(mqtt_timer_t *timer)
+{
+    timer->end_time = 0;
+}
+
+static int wait_socket(int fd, int timeout_ms, int for_write)
+{
+    struct timeval tv = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+    fd_set fdset;
+
+    FD_ZERO(&fdset);
+    FD_SET(fd, &fdset);
+    return select(fd + 1, for_write ? NULL : &fdset, for_write ? &fdset : NULL, NULL, &tv);
+}
+
+int mqtt_esp_read(mqtt_network_t *n, unsigned char *buffer, int len, int timeout_ms)
+{
+    int rcvd = 0;
+
+    // Đọc đủ len byte như lwIP trả về cả gói trên ESP8266
+    while (rcvd < len) {
+        if (wait_socket(n->my_socket, timeout_ms, 0) <= 0) {
+            return rcvd ? rcvd : -1;
+        }
+        int r = recv(n->my_socket, buffer + rcvd, len - rcvd, 0);
+        if (r <= 0) {
+            return rcvd ? rcvd : -1;
+        }
+        rcvd += r;
+    }
+    return rcvd;
+}
+
+int mqtt_esp_write(mqtt_network_t *n, unsigned char *buffer, int len, int timeout_ms)
+{
+    if (wait_socket(n->my_socket, timeout_ms, 1) <= 0) {
+        return -1;
+    }
+    return send(n->my_socket, buffer, len, MSG_NOSIGNAL);
+}
+
+void mqtt_network_new(mqtt_network_t *n)
+{
+    n->my_socket = -1;
+    n->mqttread = mqtt_esp_read;
+    n->mqttwrite = mqtt_esp_write;
+}
+
+int mqtt_network_connect(mqtt_network_t *n, const char *host, int port)
+{
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res;
+    struct sockaddr_in addr;
+
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) {
+        return -1;
+    }
+    memcpy(&addr, res->ai_addr, sizeof(addr));
+    freeaddrinfo(res);
+    addr.sin_port = htons(port);
+
+    n->my_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (n->my_socket < 0) {
+        return -1;
+    }
+    if (connect(n->my_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(n->my_socket);
+        n->my_socket = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int mqtt_network_disconnect(mqtt_network_t *n)
+{
+    close(n->my_socket);
+    n->my_socket = -1;
+    return 0;
+}
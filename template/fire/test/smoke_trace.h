@@ -0,0 +1,48 @@
+#ifndef SMOKE_TRACE_H
+#define SMOKE_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Bản ghi cảm biến khói tổng hợp trong traces/ (sinh bởi trace_gen.c, không
+// phải dữ liệu đo): dòng "ms,adc" lấy mẫu 10 Hz, dòng bắt đầu bằng # là chú
+// thích, dòng tiêu đề bị bỏ qua
+#define SMOKE_TRACE_MAX 20000
+#define SMOKE_TRACE_PERIOD_MS 100
+
+typedef struct {
+    uint32_t count;
+    uint32_t ms[SMOKE_TRACE_MAX];
+    int16_t adc[SMOKE_TRACE_MAX];
+} smoke_trace_t;
+
+/**
+ * @brief Loads traces/<name>.csv; @return false if it cannot be read
+ */
+static bool smoke_trace_load(smoke_trace_t *trace, const char *name)
+{
+    char path[64], line[80];
+    snprintf(path, sizeof(path), "traces/%s.csv", name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("%s: cannot open\n", path);
+        return false;
+    }
+    trace->count = 0;
+    while (fgets(line, sizeof(line), f) != NULL && trace->count < SMOKE_TRACE_MAX) {
+        char *end;
+        unsigned long ms = strtoul(line, &end, 10);
+        if (end == line || *end != ',') {
+            continue;
+        }
+        trace->ms[trace->count] = ms;
+        trace->adc[trace->count] = strtol(end + 1, NULL, 10);
+        trace->count++;
+    }
+    fclose(f);
+    return trace->count > 0;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SYSPARAM_EMU_H
+#define SYSPARAM_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "spiflash_host.h"
+#include "sysparam.h"
+
+// core/sysparam.c chạy trên flash giả lập của spiflash_host.c (ảnh ẩn danh
+// SYSPARAM_EMU_FLASH_SIZE byte): vùng sysparam (hai region) chiếm
+// SYSPARAM_EMU_SECTORS sector từ SYSPARAM_EMU_ADDR
+#define SYSPARAM_EMU_FLASH_SIZE (16 * SPI_FLASH_SEC_SIZE)
+#define SYSPARAM_EMU_ADDR       0x8000
+#define SYSPARAM_EMU_SECTORS    4
+
+// Xóa flash rồi tạo vùng sysparam mới @p sectors sector (chẵn, tới hết flash giả lập)
+static inline bool sysparam_emu_format_sectors(uint16_t sectors)
+{
+    return spiflash_host_open(NULL, SYSPARAM_EMU_FLASH_SIZE) &&
+           sysparam_create_area(SYSPARAM_EMU_ADDR, sectors, true) == SYSPARAM_OK &&
+           sysparam_init(SYSPARAM_EMU_ADDR, 0) == SYSPARAM_OK;
+}
+
+// Xóa flash rồi tạo vùng sysparam mới, như app_main khi chưa có vùng
+static inline bool sysparam_emu_format(void)
+{
+    return sysparam_emu_format_sectors(SYSPARAM_EMU_SECTORS);
+}
+
+// "Khởi động lại": sysparam đọc lại vùng từ flash
+static inline bool sysparam_emu_reboot(void)
+{
+    return sysparam_init(SYSPARAM_EMU_ADDR, SYSPARAM_EMU_FLASH_SIZE) == SYSPARAM_OK;
+}
+
+#endif
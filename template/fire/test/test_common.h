@@ -0,0 +1,33 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+
+// Bộ macro kiểm thử tối giản cho các test chạy trên host
+static int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) do { \
+        long long _a = (long long)(a), _b = (long long)(b); \
+        if (_a != _b) { \
+            printf("%s:%d: CHECK_EQ failed: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) do { \
+        int _before = test_failures; \
+        fn(); \
+        printf("%s: %s\n", #fn, test_failures == _before ? "PASS" : "FAIL"); \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif
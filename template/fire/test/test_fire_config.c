@@ -0,0 +1,162 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "fire_config.h"
+#include "sysparam_emu.h"
+#include "test_common.h"
+
+static const fire_config_t defaults = {
+    .wifi_ssid = "home",
+    .wifi_pass = "secret",
+    .mqtt_host = "broker.local",
+    .mqtt_port = 1883,
+    .mqtt_topic = "fire/events",
+    .mqtt_client_id = "fire-esp8266",
+    .mqtt_keepalive_s = 30,
+    .probe_host = "httpbin.org",
+    .probe_port = 80,
+    .probe_path = "/get",
+    .sensor_pin = 12,
+    .debounce_us = 20000,
+    .recovery_us = 200000,
+};
+
+static fire_config_result_t apply_text(fire_config_t *config, const char *key, const char *value)
+{
+    return fire_config_apply(config, key, (const uint8_t *)value, strlen(value), false);
+}
+
+static void test_apply(void)
+{
+    fire_config_t config = defaults;
+    uint8_t binary[4] = { 0x5b, 0x22, 0, 0 }; // 8795
+
+    CHECK_EQ(apply_text(&config, "fire.wifi.ssid", "office"), FIRE_CONFIG_APPLIED);
+    CHECK(strcmp(config.wifi_ssid, "office") == 0);
+    CHECK_EQ(apply_text(&config, "fire.mqtt.port", "8883"), FIRE_CONFIG_APPLIED);
+    CHECK_EQ(config.mqtt_port, 8883);
+    CHECK_EQ(fire_config_apply(&config, "fire.probe.port", binary, 4, true), FIRE_CONFIG_APPLIED);
+    CHECK_EQ(config.probe_port, 8795);
+    CHECK_EQ(fire_config_apply(&config, "fire.sensor.pin", (const uint8_t *)"\x04", 1, true), FIRE_CONFIG_APPLIED);
+    CHECK_EQ(config.sensor_pin, 4);
+
+    // Khóa của ứng dụng khác hoặc của phiên bản sau
+    CHECK_EQ(apply_text(&config, "wifi.ssid", "other"), FIRE_CONFIG_IGNORED);
+    CHECK_EQ(apply_text(&config, "fire.zone.count", "3"), FIRE_CONFIG_IGNORED);
+
+    // Giá trị sai giữ nguyên giá trị trước đó
+    CHECK_EQ(apply_text(&config, "fire.mqtt.port", "0"), FIRE_CONFIG_INVALID);
+    CHECK_EQ(apply_text(&config, "fire.mqtt.port", "70000"), FIRE_CONFIG_INVALID);
+    CHECK_EQ(apply_text(&config, "fire.mqtt.port", "80x"), FIRE_CONFIG_INVALID);
+    CHECK_EQ(apply_text(&config, "fire.sensor.pin", "-1"), FIRE_CONFIG_INVALID);
+    CHECK_EQ(fire_config_apply(&config, "fire.mqtt.port", binary, 3, true), FIRE_CONFIG_INVALID);
+    CHECK_EQ(config.mqtt_port, 8883);
+    CHECK_EQ(apply_text(&config, "fire.mqtt.client_id", "a-client-id-longer-than-23"), FIRE_CONFIG_INVALID);
+    CHECK_EQ(fire_config_apply(&config, "fire.mqtt.topic", (const uint8_t *)"a\0b", 3, false), FIRE_CONFIG_INVALID);
+    CHECK(strcmp(config.mqtt_client_id, "fire-esp8266") == 0);
+
+    // Chuỗi rỗng được lưu là một byte NUL
+    CHECK_EQ(fire_config_apply(&config, "fire.wifi.pass", (const uint8_t *)"", 1, false), FIRE_CONFIG_APPLIED);
+    CHECK_EQ(config.wifi_pass[0], '\0');
+}
+
+static void test_diff(void)
+{
+    fire_config_t config = defaults;
+
+    CHECK_EQ(fire_config_diff(&defaults, &config), 0);
+    strcpy(config.mqtt_host, "broker.example");
+    config.recovery_us = 500000;
+    CHECK_EQ(fire_config_diff(&defaults, &config), (1u << FIRE_CONFIG_MQTT_HOST) | (1u << FIRE_CONFIG_RECOVERY_US));
+}
+
+// Một lượt duyệt lấy mọi khóa fire.*, bỏ qua khóa khác và giá trị sai
+static void test_load(void)
+{
+    fire_config_t config = defaults;
+    fire_config_stats_t stats;
+
+    CHECK(sysparam_emu_format());
+    CHECK_EQ(sysparam_set_string("fire.mqtt.host", "broker.example"), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_int32("fire.sensor.pin", 5), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_string("fire.zone.debounce_us", "50000"), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_int32("fire.mqtt.keepalive", 1), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_string("other.key", "x"), SYSPARAM_OK);
+    CHECK(sysparam_emu_reboot());
+
+    CHECK_EQ(fire_config_load(&config, &stats), SYSPARAM_OK);
+    CHECK_EQ(stats.entries, 5);
+    CHECK_EQ(stats.applied, 3);
+    CHECK_EQ(stats.invalid, 1);
+    CHECK(strcmp(config.mqtt_host, "broker.example") == 0);
+    CHECK_EQ(config.sensor_pin, 5);
+    CHECK_EQ(config.debounce_us, 50000);
+    CHECK_EQ(config.mqtt_keepalive_s, 30);
+    CHECK_EQ(fire_config_diff(&defaults, &config),
+             (1u << FIRE_CONFIG_MQTT_HOST) | (1u << FIRE_CONFIG_SENSOR_PIN) | (1u << FIRE_CONFIG_DEBOUNCE_US));
+}
+
+// Chỉ các trường thay đổi được ghi; lần lưu lặp lại không chạm vào flash
+static void test_save_batch(void)
+{
+    fire_config_t stored = defaults, update;
+    fire_config_stats_t stats;
+    uint32_t written;
+
+    CHECK(sysparam_emu_format());
+    update = stored;
+    strcpy(update.wifi_ssid, "office");
+    update.wifi_pass[0] = '\0';
+    update.probe_port = 8080;
+    spiflash_host_reset_stats();
+    CHECK_EQ(fire_config_save(&stored, &update, &written), SYSPARAM_OK);
+    CHECK_EQ(written, 3);
+    CHECK_EQ(fire_config_diff(&stored, &update), 0);
+    // Một khối giao dịch, header xác nhận và xóa cờ chờ (chưa có giá trị cũ)
+    CHECK_EQ(spiflash_host_stats.writes, 3);
+
+    uint32_t writes = spiflash_host_stats.writes;
+    CHECK_EQ(fire_config_save(&stored, &update, &written), SYSPARAM_OK);
+    CHECK_EQ(written, 0);
+    CHECK_EQ(spiflash_host_stats.writes, writes);
+
+    fire_config_t loaded = defaults;
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(fire_config_load(&loaded, &stats), SYSPARAM_OK);
+    CHECK_EQ(stats.applied, 3);
+    CHECK_EQ(fire_config_diff(&loaded, &update), 0);
+}
+
+// Mất điện giữa lô: không trường nào được lưu, bản đã lưu giữ nguyên, lần gọi sau ghi cả lô
+static void test_save_partial(void)
+{
+    fire_config_t stored = defaults, update = defaults, loaded = defaults;
+    fire_config_stats_t stats;
+    uint32_t written;
+
+    CHECK(sysparam_emu_format());
+    strcpy(update.mqtt_topic, "site/a/fire");
+    update.recovery_us = 1000000;
+    spiflash_host_budget = 20;
+    CHECK_EQ(fire_config_save(&stored, &update, &written), SYSPARAM_ERR_IO);
+    CHECK_EQ(written, 0);
+    CHECK_EQ(fire_config_diff(&stored, &update), (1u << FIRE_CONFIG_MQTT_TOPIC) | (1u << FIRE_CONFIG_RECOVERY_US));
+
+    spiflash_host_budget = UINT32_MAX;
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(fire_config_load(&loaded, &stats), SYSPARAM_OK);
+    CHECK_EQ(stats.applied, 0);
+    CHECK_EQ(fire_config_save(&stored, &update, &written), SYSPARAM_OK);
+    CHECK_EQ(written, 2);
+    CHECK_EQ(fire_config_diff(&stored, &update), 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_apply);
+    RUN_TEST(test_diff);
+    RUN_TEST(test_load);
+    RUN_TEST(test_save_batch);
+    RUN_TEST(test_save_partial);
+    return TEST_RESULT();
+}
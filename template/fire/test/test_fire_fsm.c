@@ -0,0 +1,154 @@
+#include <stdint.h>
+
+#include "fire_fsm.h"
+#include "fire_clock.h"
+#include "test_common.h"
+
+#define DEBOUNCE_US 20000
+#define RECOVERY_US 200000
+
+// Chuyển micro giây sang số chu kỳ CCOUNT trên host
+#define US(x) ((uint32_t)(x) * FIRE_CLOCK_HOST_MHZ)
+
+static fire_fsm_t fsm;
+static fire_fsm_action_t action;
+
+static void test_clean_alarm_and_recovery(void)
+{
+    fire_fsm_init(&fsm, DEBOUNCE_US, RECOVERY_US);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+
+    fire_fsm_edge(&fsm, true, US(1000), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_DEBOUNCE);
+    CHECK(action.timer_start);
+    CHECK_EQ(action.timer_us, DEBOUNCE_US);
+    CHECK(!action.alarm_on);
+
+    fire_fsm_timeout(&fsm, true, US(1000 + DEBOUNCE_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_ALARM);
+    CHECK(action.alarm_on);
+    CHECK_EQ(fsm.edge_ccount, US(1000));
+
+    fire_fsm_edge(&fsm, false, US(50000), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_RECOVERY);
+    CHECK(action.timer_start);
+    CHECK_EQ(action.timer_us, RECOVERY_US);
+    CHECK(!action.alarm_off);
+
+    fire_fsm_timeout(&fsm, false, US(50000 + RECOVERY_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+    CHECK(action.alarm_off);
+}
+
+static void test_glitch_is_rejected(void)
+{
+    fire_fsm_init(&fsm, DEBOUNCE_US, RECOVERY_US);
+    fire_fsm_edge(&fsm, true, US(0), &action);
+    fire_fsm_edge(&fsm, false, US(500), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+    CHECK(action.timer_stop);
+    CHECK(!action.alarm_on);
+
+    // Timer đã bị hủy nhưng thông báo hết hạn vẫn tới muộn
+    fire_fsm_timeout(&fsm, false, US(DEBOUNCE_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+    CHECK(!action.alarm_on);
+    CHECK(!action.alarm_off);
+}
+
+static void test_bounce_restarts_debounce(void)
+{
+    fire_fsm_init(&fsm, DEBOUNCE_US, RECOVERY_US);
+    fire_fsm_edge(&fsm, true, US(0), &action);
+    fire_fsm_edge(&fsm, true, US(15000), &action);
+    CHECK(action.timer_start);
+
+    // Hết hạn của timer cũ: chưa đủ thời gian kể từ cạnh mới nhất
+    fire_fsm_timeout(&fsm, true, US(DEBOUNCE_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_DEBOUNCE);
+    CHECK(!action.alarm_on);
+
+    fire_fsm_timeout(&fsm, true, US(15000 + DEBOUNCE_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_ALARM);
+    CHECK(action.alarm_on);
+    // Độ trễ được tính từ cạnh đầu tiên
+    CHECK_EQ(fsm.edge_ccount, US(0));
+}
+
+static void test_recovery_interrupted(void)
+{
+    fire_fsm_init(&fsm, DEBOUNCE_US, RECOVERY_US);
+    fire_fsm_edge(&fsm, true, US(0), &action);
+    fire_fsm_timeout(&fsm, true, US(DEBOUNCE_US), &action);
+    fire_fsm_edge(&fsm, false, US(30000), &action);
+    fire_fsm_edge(&fsm, true, US(40000), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_ALARM);
+    CHECK(action.timer_stop);
+    CHECK(!action.alarm_on);
+    CHECK(!action.alarm_off);
+
+    fire_fsm_timeout(&fsm, true, US(30000 + RECOVERY_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_ALARM);
+    CHECK(!action.alarm_off);
+}
+
+static void test_timeout_rechecks_level(void)
+{
+    // Cạnh cuối bị mất: timer hết hạn nhưng mức hiện tại đã khác
+    fire_fsm_init(&fsm, DEBOUNCE_US, RECOVERY_US);
+    fire_fsm_edge(&fsm, true, US(0), &action);
+    fire_fsm_timeout(&fsm, false, US(DEBOUNCE_US), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+    CHECK(!action.alarm_on);
+}
+
+// Recovery 60 s dài hơn một vòng CCOUNT (53,7 s ở 80 MHz): timer chạy từng
+// chặng FIRE_FSM_TIMER_STEP_US, báo động tắt đúng sau 60 s dù CCOUNT quay vòng
+static void test_recovery_longer_than_wrap(void)
+{
+    uint32_t release = US(30000000);
+    uint32_t step_us = 0;
+
+    fire_fsm_init(&fsm, DEBOUNCE_US, 60000000);
+    fire_fsm_edge(&fsm, true, US(0), &action);
+    fire_fsm_timeout(&fsm, true, US(DEBOUNCE_US), &action);
+    fire_fsm_edge(&fsm, false, release, &action);
+    CHECK(action.timer_start);
+    CHECK_EQ(action.timer_us, FIRE_FSM_TIMER_STEP_US);
+
+    for (uint32_t t = FIRE_FSM_TIMER_STEP_US; t < 60000000; t += step_us) {
+        fire_fsm_timeout(&fsm, false, release + US(t), &action);
+        CHECK_EQ(fsm.state, FIRE_FSM_RECOVERY);
+        CHECK(action.timer_start);
+        CHECK(!action.alarm_off);
+        step_us = action.timer_us;
+    }
+    fire_fsm_timeout(&fsm, false, release + US(60000000), &action);
+    CHECK_EQ(fsm.state, FIRE_FSM_IDLE);
+    CHECK(action.alarm_off);
+}
+
+static void test_latency_stats(void)
+{
+    fire_fsm_latency_t stats = {0};
+    fire_fsm_latency_record(&stats, 300);
+    fire_fsm_latency_record(&stats, 100);
+    fire_fsm_latency_record(&stats, 200);
+    CHECK_EQ(stats.count, 3);
+    CHECK_EQ(stats.min_us, 100);
+    CHECK_EQ(stats.max_us, 300);
+    CHECK_EQ(stats.last_us, 200);
+    CHECK_EQ(stats.total_us, 600);
+}
+
+int main(void)
+{
+    RUN_TEST(test_clean_alarm_and_recovery);
+    RUN_TEST(test_glitch_is_rejected);
+    RUN_TEST(test_bounce_restarts_debounce);
+    RUN_TEST(test_recovery_interrupted);
+    RUN_TEST(test_timeout_rechecks_level);
+    RUN_TEST(test_recovery_longer_than_wrap);
+    RUN_TEST(test_latency_stats);
+    return TEST_RESULT();
+}
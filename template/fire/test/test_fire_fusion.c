@@ -0,0 +1,309 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "fire_fusion.h"
+#include "fusion_trace.h"
+#include "test_common.h"
+
+static fusion_trace_t trace;
+
+// Hai đặc trưng mức với nền cố định (giá trị đầu tiên), bằng chứng đầy đủ ở
+// độ lệch 100; lưới 1 s, báo động ngay khi điểm đạt ngưỡng
+static fire_fusion_config_t level_config(void)
+{
+    fire_fusion_config_t config = {
+        .epoch_ms = 1000, .align_ms = 500, .score_on = 500, .score_off = 300, .min_agree = 1,
+    };
+    for (int i = FIRE_FUSION_GAS; i <= FIRE_FUSION_TVOC; i++) {
+        config.features[i] = (fire_fusion_feature_config_t){
+            .mode = FIRE_FUSION_LEVEL, .direction = 1, .weight = 50, .dev_lo = 0, .dev_hi = 100, .max_age_ms = 2500,
+        };
+    }
+    return config;
+}
+
+// Giá trị không được gửi trong run()
+#define NONE INT32_MIN
+
+// Mỗi mốc từ @p from tới @p to (ms): gửi mẫu khí và TVOC rồi tính mốc đó, như
+// task thăm dò; @return trạng thái báo động ở mốc cuối
+static bool run(fire_fusion_t *fusion, int32_t gas, int32_t tvoc, uint32_t from, uint32_t to)
+{
+    for (uint32_t ms = from; ms <= to; ms += 1000) {
+        if (gas != NONE) {
+            fire_fusion_sample(fusion, FIRE_FUSION_GAS, gas, ms);
+        }
+        if (tvoc != NONE) {
+            fire_fusion_sample(fusion, FIRE_FUSION_TVOC, tvoc, ms);
+        }
+        fire_fusion_step(fusion, ms + fusion->config->align_ms);
+    }
+    return fusion->alarm;
+}
+
+static void test_config_validation(void)
+{
+    static const fire_fusion_config_t defaults = FIRE_FUSION_DEFAULTS;
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &defaults, 0));
+
+    fire_fusion_config_t config = defaults;
+    config.score_off = config.score_on + 1;
+    CHECK(!fire_fusion_init(&fusion, &config, 0));
+    config = defaults;
+    config.features[FIRE_FUSION_TEMP].rise_epochs = FIRE_FUSION_RISE_MAX + 1;
+    CHECK(!fire_fusion_init(&fusion, &config, 0));
+    config = defaults;
+    config.features[FIRE_FUSION_GAS].dev_hi = config.features[FIRE_FUSION_GAS].dev_lo;
+    CHECK(!fire_fusion_init(&fusion, &config, 0));
+    // Đặc trưng trọng số 0 bị bỏ qua hoàn toàn
+    config.features[FIRE_FUSION_GAS].weight = 0;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+    config.epoch_ms = 0;
+    CHECK(!fire_fusion_init(&fusion, &config, 0));
+}
+
+// Mốc t dùng mẫu gần nhất đo không muộn hơn t, kể cả mẫu đến muộn tới align_ms;
+// mẫu đến sau khi mốc đã tính chỉ có tác dụng từ mốc sau
+static void test_time_alignment(void)
+{
+    fire_fusion_config_t config = level_config();
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 1000));
+    fire_fusion_channel_t *ch = &fusion.ch[FIRE_FUSION_GAS];
+
+    // Đến không theo thứ tự; mốc 1000 chưa được tính trước 1500
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 20, 1200);
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 10, 900);
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 30, 1400);
+    CHECK_EQ(ch->pending_count, 3);
+    CHECK_EQ(ch->pending[0].ms, 900);
+    CHECK_EQ(ch->pending[2].ms, 1400);
+    fire_fusion_step(&fusion, 1499);
+    CHECK_EQ(fusion.epochs, 0);
+    fire_fusion_step(&fusion, 1500);
+    CHECK_EQ(fusion.epochs, 1);
+    CHECK_EQ(ch->held.value, 10);
+    CHECK_EQ(ch->pending_count, 2);
+
+    // 950 đến sau khi mốc 1000 đã tính: mẫu giữ đổi, mốc không tính lại
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 15, 950);
+    CHECK_EQ(fusion.late, 1);
+    CHECK_EQ(ch->held.value, 15);
+    fire_fusion_step(&fusion, 2500);
+    CHECK_EQ(fusion.epochs, 2);
+    CHECK_EQ(ch->held.value, 30);
+    CHECK_EQ(ch->pending_count, 0);
+    // Nền là giá trị đầu tiên được tính (10)
+    CHECK_EQ(ch->deviation, 20);
+
+    // Hàng đợi đầy: mẫu cũ nhất bị bỏ, mẫu giữ không đổi
+    for (uint32_t i = 0; i <= FIRE_FUSION_PENDING; i++) {
+        fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 40 + i, 2100 + 100 * i);
+    }
+    CHECK_EQ(fusion.dropped, 1);
+    CHECK_EQ(ch->pending[0].ms, 2200);
+    CHECK_EQ(ch->held.value, 30);
+    CHECK_EQ(ch->pending_count, FIRE_FUSION_PENDING);
+}
+
+// Điểm là trung bình bằng chứng theo trọng số dương; trọng số âm trừ bớt
+static void test_weighted_score(void)
+{
+    fire_fusion_config_t config = level_config();
+    config.features[FIRE_FUSION_GAS].weight = 60;
+    config.features[FIRE_FUSION_TVOC].weight = 40;
+    config.features[FIRE_FUSION_HUMIDITY] = (fire_fusion_feature_config_t){
+        .mode = FIRE_FUSION_LEVEL, .direction = 1, .weight = -50, .dev_lo = 0, .dev_hi = 100, .max_age_ms = 2500,
+    };
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+
+    // Mốc 0 lấy nền, sau đó khí lệch đầy đủ và TVOC một nửa
+    fire_fusion_sample(&fusion, FIRE_FUSION_HUMIDITY, 0, 0);
+    run(&fusion, 0, 0, 0, 0);
+    fire_fusion_sample(&fusion, FIRE_FUSION_HUMIDITY, 0, 1000);
+    run(&fusion, 100, 50, 1000, 1000);
+    CHECK_EQ(fusion.ch[FIRE_FUSION_TVOC].evidence, 500);
+    CHECK_EQ(fusion.score, (60 * 1000 + 40 * 500) / 100);
+    CHECK_EQ(fusion.agree, 2);
+
+    // Độ ẩm tăng đầy đủ: (60000 + 20000 - 50000) / 100
+    fire_fusion_sample(&fusion, FIRE_FUSION_HUMIDITY, 100, 2000);
+    run(&fusion, 100, 50, 2000, 2000);
+    CHECK_EQ(fusion.score, 300);
+
+    // Độ ẩm lớn hơn tổng bằng chứng dương: điểm không âm
+    config.features[FIRE_FUSION_HUMIDITY].weight = -200;
+    fire_fusion_sample(&fusion, FIRE_FUSION_HUMIDITY, 100, 3000);
+    run(&fusion, 100, 50, 3000, 3000);
+    CHECK_EQ(fusion.score, 0);
+}
+
+// Cảm biến im lặng quá max_age bị loại khỏi điểm, các cảm biến còn lại được
+// chuẩn hóa lại
+static void test_stale_sensor(void)
+{
+    fire_fusion_config_t config = level_config();
+    config.score_on = 600;
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+
+    run(&fusion, 0, 0, 0, 0);
+    CHECK(!run(&fusion, 100, NONE, 1000, 2000));
+    CHECK_EQ(fire_fusion_fresh_mask(&fusion), (1u << FIRE_FUSION_GAS) | (1u << FIRE_FUSION_TVOC));
+    CHECK_EQ(fusion.score, 500);
+    // TVOC đo lần cuối ở 0 ms: còn dùng ở mốc 2000, bị loại từ mốc 3000
+    CHECK(run(&fusion, 100, NONE, 3000, 9000));
+    CHECK_EQ(fire_fusion_fresh_mask(&fusion), 1u << FIRE_FUSION_GAS);
+    CHECK_EQ(fusion.score, 1000);
+
+    // Không còn đặc trưng trọng số dương nào: điểm 0
+    fire_fusion_step(&fusion, 12500);
+    CHECK_EQ(fire_fusion_fresh_mask(&fusion), 0);
+    CHECK_EQ(fusion.score, 0);
+    CHECK(!fusion.alarm);
+}
+
+// Báo động cần confirm_epochs mốc liên tiếp đạt score_on với đủ đặc trưng
+// đồng ý, và chỉ xóa khi điểm xuống dưới score_off
+static void test_confirm_and_hysteresis(void)
+{
+    fire_fusion_config_t config = level_config();
+    config.confirm_epochs = 3;
+    config.min_agree = 2;
+    config.score_on = 450;
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+
+    run(&fusion, 0, 0, 0, 0);
+    // Chỉ khí: điểm 500 nhưng một đặc trưng đồng ý
+    CHECK(!run(&fusion, 100, 0, 1000, 5000));
+    CHECK_EQ(fusion.score, 500);
+    CHECK_EQ(fusion.agree, 1);
+
+    // Hai mốc đạt ngưỡng rồi tụt: đếm lại từ đầu
+    CHECK(!run(&fusion, 100, 60, 6000, 7000));
+    CHECK_EQ(fusion.over_epochs, 2);
+    CHECK(!run(&fusion, 100, 0, 8000, 8000));
+    CHECK_EQ(fusion.over_epochs, 0);
+    CHECK(!run(&fusion, 100, 60, 9000, 10000));
+    CHECK(run(&fusion, 100, 60, 11000, 11000));
+
+    // 350 giữa score_off và score_on: vẫn báo động; 250 thì xóa
+    CHECK(run(&fusion, 40, 30, 12000, 12000));
+    CHECK_EQ(fusion.score, 350);
+    CHECK(!run(&fusion, 40, 10, 13000, 13000));
+    CHECK_EQ(fusion.score, 250);
+}
+
+// Tốc độ tăng so với mốc rise_epochs trước; trước khi đủ cửa sổ thì so với mốc đầu
+static void test_rise_mode(void)
+{
+    fire_fusion_config_t config = level_config();
+    config.features[FIRE_FUSION_TVOC].weight = 0;
+    config.features[FIRE_FUSION_GAS] = (fire_fusion_feature_config_t){
+        .mode = FIRE_FUSION_RISE, .direction = 1, .rise_epochs = 10, .weight = 10,
+        .dev_lo = 50, .dev_hi = 150, .max_age_ms = 2500,
+    };
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+    fire_fusion_channel_t *ch = &fusion.ch[FIRE_FUSION_GAS];
+
+    for (uint32_t i = 0; i < 30; i++) {
+        fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 2000 + 10 * i, 1000 * i);
+        fire_fusion_step(&fusion, 1000 * i + 500);
+        CHECK_EQ(ch->deviation, i < 10 ? 10 * i : 100);
+    }
+    CHECK_EQ(ch->evidence, 500);
+    // Giảm không phải bằng chứng
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 1000, 30000);
+    fire_fusion_step(&fusion, 30500);
+    CHECK(ch->deviation < 0);
+    CHECK_EQ(ch->evidence, 0);
+}
+
+// Tỉ lệ so với nền theo phần nghìn; nền theo độ trôi nhỏ nhưng đứng yên khi
+// độ lệch vượt nửa dev_lo
+static void test_ratio_baseline(void)
+{
+    fire_fusion_config_t config = level_config();
+    config.features[FIRE_FUSION_TVOC].weight = 0;
+    config.features[FIRE_FUSION_GAS] = (fire_fusion_feature_config_t){
+        .mode = FIRE_FUSION_RATIO, .direction = -1, .baseline_shift = 2, .weight = 10,
+        .dev_lo = 100, .dev_hi = 500, .max_age_ms = 2500,
+    };
+    fire_fusion_t fusion;
+    CHECK(fire_fusion_init(&fusion, &config, 0));
+    fire_fusion_channel_t *ch = &fusion.ch[FIRE_FUSION_GAS];
+
+    fire_fusion_sample(&fusion, FIRE_FUSION_GAS, 100000, 0);
+    fire_fusion_step(&fusion, 500);
+    CHECK_EQ(ch->deviation, 0);
+
+    // Trôi 4 % (dưới 5 %): nền theo kịp
+    run(&fusion, 96000, NONE, 1000, 30000);
+    CHECK_EQ(ch->baseline / (1 << FIRE_FUSION_BASELINE_FRAC_BITS), 96000);
+    CHECK_EQ(ch->deviation, 0);
+
+    // Giảm 30 %: nền đứng yên, bằng chứng (300 - 100) / 400
+    run(&fusion, 67200, NONE, 31000, 60000);
+    CHECK_EQ(ch->baseline / (1 << FIRE_FUSION_BASELINE_FRAC_BITS), 96000);
+    CHECK_EQ(ch->deviation, 300);
+    CHECK_EQ(ch->evidence, 500);
+}
+
+static void replay(const char *name, const fire_fusion_config_t *config, fusion_replay_t *result)
+{
+    CHECK(fusion_trace_load(&trace, name));
+    fusion_trace_replay(&trace, config, result);
+}
+
+// Cài đặt mặc định: cả hai đám cháy báo động trong vài phút từ lúc bắt đầu
+// (300 s), tắm và nấu ăn không báo
+static void test_traces_defaults(void)
+{
+    static const fire_fusion_config_t defaults = FIRE_FUSION_DEFAULTS;
+    fusion_replay_t result;
+
+    replay("fusion_flaming", &defaults, &result);
+    CHECK(trace.expect_alarm);
+    CHECK(result.first_alarm_ms > 300000 && result.first_alarm_ms < 420000);
+    replay("fusion_smoulder", &defaults, &result);
+    CHECK(trace.expect_alarm);
+    CHECK(result.first_alarm_ms > 300000 && result.first_alarm_ms < 900000);
+    replay("fusion_shower", &defaults, &result);
+    CHECK(!trace.expect_alarm);
+    CHECK_EQ(result.alarm_epochs, 0);
+    replay("fusion_cooking", &defaults, &result);
+    CHECK(!trace.expect_alarm);
+    CHECK_EQ(result.alarm_epochs, 0);
+}
+
+// Hơi nước làm giảm điện trở khí và tăng TVOC như khói: chỉ trọng số âm của
+// độ ẩm giữ bản ghi tắm dưới ngưỡng
+static void test_humidity_inhibits_shower(void)
+{
+    fire_fusion_config_t config = FIRE_FUSION_DEFAULTS;
+    fusion_replay_t result;
+
+    config.features[FIRE_FUSION_HUMIDITY].weight = 0;
+    replay("fusion_shower", &config, &result);
+    CHECK(result.alarm_epochs > 0);
+    replay("fusion_flaming", &config, &result);
+    CHECK(result.alarm_epochs > 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_config_validation);
+    RUN_TEST(test_time_alignment);
+    RUN_TEST(test_weighted_score);
+    RUN_TEST(test_stale_sensor);
+    RUN_TEST(test_confirm_and_hysteresis);
+    RUN_TEST(test_rise_mode);
+    RUN_TEST(test_ratio_baseline);
+    RUN_TEST(test_traces_defaults);
+    RUN_TEST(test_humidity_inhibits_shower);
+    return TEST_RESULT();
+}
@@ -0,0 +1,117 @@
+#include <stdint.h>
+
+#include "fire_health.h"
+#include "test_common.h"
+
+static void test_stage_thresholds(void)
+{
+    CHECK_EQ(fire_health_stage_for(0, 1000), FIRE_HEALTH_OK);
+    CHECK_EQ(fire_health_stage_for(1000, 1000), FIRE_HEALTH_OK);
+    CHECK_EQ(fire_health_stage_for(1001, 1000), FIRE_HEALTH_LATE);
+    CHECK_EQ(fire_health_stage_for(2001, 1000), FIRE_HEALTH_STALLED);
+    CHECK_EQ(fire_health_stage_for(3000, 1000), FIRE_HEALTH_STALLED);
+    CHECK_EQ(fire_health_stage_for(3001, 1000), FIRE_HEALTH_RESTART);
+}
+
+static void test_register_full(void)
+{
+    fire_health_t health;
+    fire_health_init(&health);
+    for (int i = 0; i < FIRE_HEALTH_SLOTS; i++) {
+        CHECK_EQ(fire_health_register(&health, "task", NULL, 1000, 0), i);
+    }
+    CHECK_EQ(fire_health_register(&health, "extra", NULL, 1000, 0), -1);
+    CHECK_EQ(health.count, FIRE_HEALTH_SLOTS);
+}
+
+// Một task đều đặn và một task bị treo: chỉ task treo leo thang, mỗi mức
+// được báo đúng một lần, và trở về OK ngay khi task chạy lại
+static void test_escalation_and_recovery(void)
+{
+    fire_health_t health;
+    fire_health_init(&health);
+    int steady = fire_health_register(&health, "steady", NULL, 3000, 0);
+    int stuck = fire_health_register(&health, "stuck", NULL, 3000, 0);
+    uint32_t raised_at[FIRE_HEALTH_RESTART + 1] = { 0 };
+    uint32_t raised_count = 0;
+
+    for (uint32_t now = 1000; now <= 20000; now += 1000) {
+        // steady chạy mỗi 100 ms, stuck chỉ chạy trước 2 s
+        for (int i = 0; i < 10; i++) {
+            fire_health_beat_slot(&health, steady);
+        }
+        if (now <= 2000) {
+            fire_health_beat_slot(&health, stuck);
+        }
+        uint32_t raised = fire_health_check(&health, now);
+        CHECK_EQ(raised & (1u << steady), 0);
+        if (raised & (1u << stuck)) {
+            raised_at[health.slots[stuck].stage] = now;
+            raised_count++;
+        }
+    }
+    // Nhịp cuối ở 2 s: quá 3 s là LATE, quá 6 s STALLED, quá 9 s RESTART
+    CHECK_EQ(raised_count, 3);
+    CHECK_EQ(raised_at[FIRE_HEALTH_LATE], 6000);
+    CHECK_EQ(raised_at[FIRE_HEALTH_STALLED], 9000);
+    CHECK_EQ(raised_at[FIRE_HEALTH_RESTART], 12000);
+    CHECK_EQ(fire_health_worst(&health), FIRE_HEALTH_RESTART);
+    CHECK_EQ(health.slots[stuck].silence_max_ms, 18000);
+
+    CHECK_EQ(health.slots[steady].period_ms, 100);
+    CHECK_EQ(health.slots[steady].period_max_ms, 100);
+    CHECK_EQ(health.slots[steady].stage, FIRE_HEALTH_OK);
+
+    fire_health_beat_slot(&health, stuck);
+    CHECK_EQ(fire_health_check(&health, 21000), 0);
+    CHECK_EQ(health.slots[stuck].stage, FIRE_HEALTH_OK);
+    CHECK_EQ(health.slots[stuck].period_ms, 19000);
+    CHECK_EQ(health.slots[stuck].period_max_ms, 19000);
+    CHECK_EQ(fire_health_worst(&health), FIRE_HEALTH_OK);
+}
+
+// Bộ đếm 32 bit quay vòng và đồng hồ ms quay vòng không gây báo động giả
+static void test_counter_wrap(void)
+{
+    fire_health_t health;
+    fire_health_init(&health);
+    int slot = fire_health_register(&health, "wrap", NULL, 1500, UINT32_MAX - 500);
+    health.slots[slot].beats = UINT32_MAX - 1;
+    health.slots[slot].seen_beats = UINT32_MAX - 1;
+
+    fire_health_beat_slot(&health, slot);
+    fire_health_beat_slot(&health, slot);
+    fire_health_beat_slot(&health, slot);
+    CHECK_EQ(fire_health_check(&health, 499), 0);
+    CHECK_EQ(health.slots[slot].beats, 1);
+    CHECK_EQ(health.slots[slot].period_ms, 1000 / 3);
+    CHECK_EQ(fire_health_check(&health, 1999), 0);
+    CHECK_EQ(fire_health_check(&health, 2000), 1u << slot);
+}
+
+static void test_stack_samples(void)
+{
+    fire_health_t health;
+    fire_health_init(&health);
+    int slot = fire_health_register(&health, "stack", NULL, 1000, 0);
+
+    CHECK_EQ(health.slots[slot].stack_min_words, UINT32_MAX);
+    CHECK(!fire_health_stack_sample(&health, slot, 200));
+    CHECK(!fire_health_stack_sample(&health, slot, 300));
+    CHECK_EQ(health.slots[slot].stack_min_words, 200);
+    // Chỉ cảnh báo khi có mức thấp mới dưới ngưỡng
+    CHECK(fire_health_stack_sample(&health, slot, FIRE_HEALTH_STACK_LOW_WORDS - 1));
+    CHECK(!fire_health_stack_sample(&health, slot, FIRE_HEALTH_STACK_LOW_WORDS - 1));
+    CHECK(fire_health_stack_sample(&health, slot, 10));
+    CHECK_EQ(health.slots[slot].stack_min_words, 10);
+}
+
+int main(void)
+{
+    RUN_TEST(test_stage_thresholds);
+    RUN_TEST(test_register_full);
+    RUN_TEST(test_escalation_and_recovery);
+    RUN_TEST(test_counter_wrap);
+    RUN_TEST(test_stack_samples);
+    return TEST_RESULT();
+}
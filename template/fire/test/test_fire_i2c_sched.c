@@ -0,0 +1,97 @@
+#include <stdint.h>
+
+#include "fire_i2c_sched.h"
+#include "test_common.h"
+
+static void test_add_full(void)
+{
+    fire_i2c_sched_t sched;
+    fire_i2c_sched_init(&sched);
+    uint32_t wait_ms;
+    CHECK_EQ(fire_i2c_sched_next(&sched, 0, &wait_ms), -1);
+    CHECK_EQ(wait_ms, UINT32_MAX);
+    CHECK_EQ(fire_i2c_sched_add(&sched, "zero", 0, 0, 0), -1);
+    for (int i = 0; i < FIRE_I2C_SCHED_JOBS; i++) {
+        CHECK_EQ(fire_i2c_sched_add(&sched, "job", 1000, 0, 0), i);
+    }
+    CHECK_EQ(fire_i2c_sched_add(&sched, "extra", 1000, 0, 0), -1);
+}
+
+// Cảm biến đo cưỡng bức: START, chờ convert_ms, FETCH, rồi chu kỳ sau theo nhịp gốc
+static void test_start_fetch_cycle(void)
+{
+    fire_i2c_sched_t sched;
+    fire_i2c_sched_init(&sched);
+    int job = fire_i2c_sched_add(&sched, "bme680", 3000, 200, 100);
+    uint32_t wait_ms;
+
+    CHECK_EQ(fire_i2c_sched_next(&sched, 0, &wait_ms), -1);
+    CHECK_EQ(wait_ms, 100);
+    CHECK_EQ(fire_i2c_sched_next(&sched, 100, &wait_ms), job);
+    CHECK_EQ(fire_i2c_sched_step(&sched, job), FIRE_I2C_START);
+    fire_i2c_sched_done(&sched, job, 110, true);
+
+    CHECK_EQ(fire_i2c_sched_next(&sched, 200, &wait_ms), -1);
+    CHECK_EQ(wait_ms, 110);
+    CHECK_EQ(fire_i2c_sched_next(&sched, 310, &wait_ms), job);
+    CHECK_EQ(fire_i2c_sched_step(&sched, job), FIRE_I2C_FETCH);
+    fire_i2c_sched_done(&sched, job, 330, true);
+    CHECK_EQ(sched.jobs[job].fetches, 1);
+    CHECK_EQ(sched.jobs[job].late_max_ms, 20);
+    CHECK_EQ(sched.jobs[job].due_ms, 3100);
+    CHECK_EQ(fire_i2c_sched_step(&sched, job), FIRE_I2C_START);
+
+    // START lỗi: không chờ chuyển đổi, thử lại ở chu kỳ sau
+    fire_i2c_sched_done(&sched, job, 3100, false);
+    CHECK_EQ(sched.jobs[job].errors, 1);
+    CHECK_EQ(sched.jobs[job].due_ms, 6100);
+    CHECK(!sched.jobs[job].converting);
+}
+
+// Job quá hạn lâu nhất chạy trước; các chu kỳ đã lỡ bị bỏ qua
+static void test_overdue_order_and_skip(void)
+{
+    fire_i2c_sched_t sched;
+    fire_i2c_sched_init(&sched);
+    int ccs = fire_i2c_sched_add(&sched, "ccs811", 1000, 0, 1000);
+    int sht = fire_i2c_sched_add(&sched, "sht3x", 1000, 0, 900);
+    uint32_t wait_ms;
+
+    CHECK_EQ(fire_i2c_sched_next(&sched, 1000, &wait_ms), sht);
+    fire_i2c_sched_done(&sched, sht, 1000, true);
+    CHECK_EQ(fire_i2c_sched_next(&sched, 1000, &wait_ms), ccs);
+
+    // Bus bị giữ 3,5 s: chạy một lần rồi về nhịp 1000 + n * 1000
+    fire_i2c_sched_done(&sched, ccs, 4500, true);
+    CHECK_EQ(sched.jobs[ccs].due_ms, 5000);
+    CHECK_EQ(sched.jobs[ccs].late_max_ms, 3500);
+    CHECK_EQ(fire_i2c_sched_next(&sched, 4500, &wait_ms), sht);
+    fire_i2c_sched_done(&sched, sht, 4500, false);
+    CHECK_EQ(sched.jobs[sht].due_ms, 4900);
+}
+
+// Đồng hồ ms quay vòng giữa hai bước
+static void test_clock_wrap(void)
+{
+    fire_i2c_sched_t sched;
+    fire_i2c_sched_init(&sched);
+    int job = fire_i2c_sched_add(&sched, "wrap", 1000, 300, UINT32_MAX - 100);
+    uint32_t wait_ms;
+
+    CHECK_EQ(fire_i2c_sched_next(&sched, UINT32_MAX - 100, &wait_ms), job);
+    fire_i2c_sched_done(&sched, job, UINT32_MAX - 100, true);
+    CHECK_EQ(fire_i2c_sched_next(&sched, UINT32_MAX, &wait_ms), -1);
+    CHECK_EQ(wait_ms, 200);
+    CHECK_EQ(fire_i2c_sched_next(&sched, 199, &wait_ms), job);
+    fire_i2c_sched_done(&sched, job, 199, true);
+    CHECK_EQ(sched.jobs[job].due_ms, 899);
+}
+
+int main(void)
+{
+    RUN_TEST(test_add_full);
+    RUN_TEST(test_start_fetch_cycle);
+    RUN_TEST(test_overdue_order_and_skip);
+    RUN_TEST(test_clock_wrap);
+    return TEST_RESULT();
+}
@@ -0,0 +1,190 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fire_event.h"
+#include "fire_journal.h"
+#include "flash_emu.h"
+#include "test_common.h"
+
+#define JOURNAL_BASE    FIRE_FLASH_SECTOR_SIZE
+#define JOURNAL_SECTORS 3
+#define RPS             FIRE_JOURNAL_RECORDS_PER_SECTOR
+
+static fire_journal_t journal;
+
+static void append_range(uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < first + count; i++) {
+        CHECK(fire_journal_append(&journal, i & 1 ? FIRE_EVENT_RECOVERY : FIRE_EVENT_ALARM,
+                                  (uint64_t)i << 32 | i, i * 3));
+    }
+}
+
+// Đọc lùi toàn bộ nhật ký: phải ra đúng last, last-1, ..., first
+static void check_history(uint32_t first, uint32_t last)
+{
+    fire_journal_iter_t iter;
+    fire_journal_record_t record;
+    uint32_t expected = last;
+    uint32_t count = 0;
+
+    fire_journal_iter_init(&journal, &iter);
+    while (fire_journal_prev(&journal, &iter, &record)) {
+        CHECK_EQ(record.index, expected);
+        CHECK_EQ(record.stamp_ms, expected * 3);
+        CHECK(record.zones == ((uint64_t)expected << 32 | expected));
+        CHECK_EQ(record.type, expected & 1 ? FIRE_EVENT_RECOVERY : FIRE_EVENT_ALARM);
+        if (record.index != expected) {
+            return;
+        }
+        expected--;
+        count++;
+    }
+    CHECK_EQ(count, last - first + 1);
+}
+
+static void test_empty(void)
+{
+    fire_journal_iter_t iter;
+    fire_journal_record_t record;
+
+    flash_emu_reset();
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    fire_journal_iter_init(&journal, &iter);
+    CHECK(!fire_journal_prev(&journal, &iter, &record));
+    CHECK(fire_journal_flush(&journal));
+    CHECK_EQ(flash_emu_writes, 0);
+
+    CHECK(!fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE + 16, JOURNAL_SECTORS));
+    CHECK(!fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, 1));
+}
+
+static void test_batches_one_page_per_write(void)
+{
+    flash_emu_reset();
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+
+    // Trang đầu của sector chứa header nên chỉ còn chỗ cho 15 bản ghi
+    append_range(0, FIRE_JOURNAL_BUFFER_RECORDS - 2);
+    CHECK_EQ(journal.flushes, 0);
+    CHECK(fire_journal_pending(&journal));
+    check_history(0, FIRE_JOURNAL_BUFFER_RECORDS - 3);
+    append_range(FIRE_JOURNAL_BUFFER_RECORDS - 2, 1);
+    CHECK_EQ(journal.flushes, 1);
+    CHECK(!fire_journal_pending(&journal));
+
+    // Sau đó mỗi trang nhận đúng 16 bản ghi trong một lần ghi
+    append_range(FIRE_JOURNAL_BUFFER_RECORDS - 1, 3 * FIRE_JOURNAL_BUFFER_RECORDS);
+    CHECK_EQ(journal.flushes, 4);
+    // header + 4 trang bản ghi, mỗi lần ghi không vượt quá một trang
+    CHECK_EQ(flash_emu_writes, 5);
+    CHECK_EQ(flash_emu_pages, 5);
+    CHECK_EQ(journal.erases, 1);
+    check_history(0, 4 * FIRE_JOURNAL_BUFFER_RECORDS - 2);
+}
+
+static void test_partial_flush_and_remount(void)
+{
+    flash_emu_reset();
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    append_range(0, 20);
+    CHECK(fire_journal_flush(&journal));
+    // Ghi tiếp phần còn lại của trang đang dở
+    append_range(20, 5);
+    CHECK(fire_journal_flush(&journal));
+    append_range(25, 3);
+
+    // Khởi động lại: bản ghi chưa flush bị mất, vị trí ghi được tìm lại
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    CHECK_EQ(journal.slot, 25);
+    CHECK_EQ(journal.sector_seq, 1);
+    check_history(0, 24);
+    append_range(25, RPS);
+    check_history(0, 24 + RPS);
+    CHECK_EQ(journal.sector_seq, 2);
+}
+
+static void test_wrap_drops_oldest_sector(void)
+{
+    flash_emu_reset();
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    uint32_t total = 5 * RPS + 17;
+    append_range(0, total);
+    CHECK(fire_journal_flush(&journal));
+    CHECK_EQ(journal.sector_seq, 6);
+    CHECK_EQ(journal.erases, 6);
+    // Chỉ còn 2 sector đầy và sector đang ghi
+    check_history(3 * RPS, total - 1);
+
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    CHECK_EQ(journal.sector_seq, 6);
+    CHECK_EQ(journal.slot, 17);
+    check_history(3 * RPS, total - 1);
+
+    // Sector vừa đầy đúng biên: lần ghi sau mới mở sector mới
+    append_range(total, RPS - 17);
+    CHECK_EQ(journal.slot, RPS);
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    CHECK_EQ(journal.slot, RPS);
+    append_range(6 * RPS, 1);
+    CHECK(fire_journal_flush(&journal));
+    CHECK_EQ(journal.sector_seq, 7);
+    check_history(4 * RPS, 6 * RPS);
+    // Vùng flash bên ngoài không bị chạm tới
+    CHECK_EQ(flash_emu[JOURNAL_BASE - 1], 0xff);
+    CHECK_EQ(flash_emu[JOURNAL_BASE + JOURNAL_SECTORS * FIRE_FLASH_SECTOR_SIZE], 0xff);
+}
+
+static void test_torn_writes(void)
+{
+    fire_journal_iter_t iter;
+    fire_journal_record_t record;
+
+    flash_emu_reset();
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    append_range(0, 40);
+    CHECK(fire_journal_flush(&journal));
+
+    // Mất điện giữa bản ghi thứ 2 của lần flush
+    append_range(40, 4);
+    flash_emu_budget = FIRE_JOURNAL_RECORD_SIZE + 6;
+    CHECK(!fire_journal_flush(&journal));
+    CHECK_EQ(journal.write_errors, 1);
+    flash_emu_budget = UINT32_MAX;
+
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    // Bản ghi 40 còn nguyên, bản ghi 41 hỏng bị bỏ qua, ghi tiếp sau nó
+    CHECK_EQ(journal.slot, 42);
+    fire_journal_iter_init(&journal, &iter);
+    CHECK(fire_journal_prev(&journal, &iter, &record));
+    CHECK_EQ(record.index, 40);
+    CHECK_EQ(record.stamp_ms, 120);
+
+    // Mất điện khi vừa xóa sector mới, lúc đang ghi header
+    append_range(42, RPS - 42);
+    flash_emu_budget = 4;
+    CHECK(!fire_journal_append(&journal, FIRE_EVENT_ALARM, 1, 1));
+    flash_emu_budget = UINT32_MAX;
+    CHECK(fire_journal_mount(&journal, &flash_emu_ops, JOURNAL_BASE, JOURNAL_SECTORS));
+    CHECK_EQ(journal.sector_seq, 1);
+    CHECK_EQ(journal.slot, RPS);
+    append_range(RPS, 1);
+    CHECK(fire_journal_flush(&journal));
+    CHECK_EQ(journal.sector_seq, 2);
+    fire_journal_iter_init(&journal, &iter);
+    CHECK(fire_journal_prev(&journal, &iter, &record));
+    CHECK_EQ(record.index, RPS);
+    CHECK(fire_journal_prev(&journal, &iter, &record));
+    CHECK_EQ(record.index, RPS - 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_empty);
+    RUN_TEST(test_batches_one_page_per_write);
+    RUN_TEST(test_partial_flush_and_remount);
+    RUN_TEST(test_wrap_drops_oldest_sector);
+    RUN_TEST(test_torn_writes);
+    return TEST_RESULT();
+}
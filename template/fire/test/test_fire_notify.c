@@ -0,0 +1,312 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fire_notify.h"
+#include "flash_emu.h"
+#include "mqtt_broker.h"
+#include "test_common.h"
+
+#define SPILL_BASE    0
+#define SPILL_SECTORS 4
+
+static mqtt_broker_t broker;
+static fire_notify_config_t config = {
+    .host = "127.0.0.1",
+    .topic = "fire/events",
+    .client_id = "fire-test",
+    .keepalive_s = 1,
+    .command_timeout_ms = 100,
+};
+
+static void *notify_thread(void *arg)
+{
+    fire_notify_run();
+    return NULL;
+}
+
+static pthread_t start_notify(void)
+{
+    pthread_t thread;
+    pthread_create(&thread, NULL, notify_thread, NULL);
+    return thread;
+}
+
+static void stop_notify(pthread_t thread)
+{
+    fire_notify_stop();
+    pthread_join(thread, NULL);
+}
+
+// Chờ tới khi hàng đợi rỗng; false nếu quá thời gian
+static bool wait_delivered(uint32_t published, uint32_t timeout_ms)
+{
+    fire_notify_stats_t stats;
+    for (uint32_t waited = 0; waited < timeout_ms; waited += 10) {
+        fire_notify_get_stats(&stats);
+        if (stats.pending == 0 && stats.published >= published) {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+// Sau khi bỏ các bản gửi lại (trùng seq liên tiếp) phải còn đúng first..last theo thứ tự
+static void check_broker_sequence(uint32_t from_log, uint32_t first, uint32_t last)
+{
+    uint32_t expected = first;
+    uint32_t duplicates = 0;
+
+    for (uint32_t i = from_log; i < broker.log_count; i++) {
+        if (i > from_log && broker.seq_log[i] == broker.seq_log[i - 1]) {
+            duplicates++;
+            continue;
+        }
+        CHECK_EQ(broker.seq_log[i], expected);
+        if (broker.seq_log[i] != expected) {
+            return;
+        }
+        expected++;
+    }
+    CHECK_EQ(expected, last + 1);
+    printf("  %u events delivered, %u duplicates\n", last + 1 - first, duplicates);
+}
+
+static void test_format(void)
+{
+    fire_event_t event = { .seq = 42, .stamp_ms = 1234, .zones = 0x100000003ull, .type = FIRE_EVENT_ALARM };
+    char buf[FIRE_NOTIFY_PAYLOAD_MAX];
+
+    int len = fire_notify_format(&event, 17, buf, sizeof(buf));
+    CHECK_EQ(len, (int)strlen(buf));
+    CHECK(strcmp(buf, "{\"seq\":42,\"type\":\"fire\",\"zones\":\"0000000100000003\",\"stamp\":1234,\"age\":17}") == 0);
+
+    event.type = FIRE_EVENT_RECOVERY;
+    fire_notify_format(&event, -1, buf, sizeof(buf));
+    CHECK(strstr(buf, "\"type\":\"recovery\"") != NULL);
+    CHECK(strstr(buf, "\"age\":null") != NULL);
+
+    // Payload dài nhất vẫn vừa bộ đệm
+    fire_event_t worst = { .seq = UINT32_MAX, .stamp_ms = UINT32_MAX, .zones = UINT64_MAX, .type = FIRE_EVENT_RECOVERY };
+    CHECK(fire_notify_format(&worst, INT32_MAX, buf, sizeof(buf)) > 0);
+    CHECK_EQ(fire_notify_format(&event, 17, buf, 10), -1);
+}
+
+static void test_delivers_in_order_across_drops(void)
+{
+    fire_notify_stats_t stats;
+    const uint32_t events = 300;
+
+    flash_emu_reset();
+    broker.drop_every = 20;
+    broker.log_count = 0;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    pthread_t thread = start_notify();
+
+    for (uint32_t i = 0; i < events; i++) {
+        CHECK(fire_notify_post(i & 1 ? FIRE_EVENT_RECOVERY : FIRE_EVENT_ALARM, (uint64_t)1 << (i % 64),
+                               fire_notify_now_ms()));
+    }
+    CHECK(wait_delivered(events, 20000));
+    stop_notify(thread);
+
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.posted, events);
+    CHECK_EQ(stats.published, events);
+    CHECK_EQ(stats.dropped, 0);
+    CHECK(stats.sessions > 1);
+    CHECK_EQ(stats.latency_count, events);
+    check_broker_sequence(0, 0, events - 1);
+    // Phiên bền vững, QoS 1
+    CHECK_EQ(broker.last_clean_session, 0);
+    CHECK_EQ(broker.last_qos, 1);
+    CHECK(strcmp(broker.last_topic, "fire/events") == 0);
+    printf("  sessions %u, spilled %u, latency avg %u ms max %u ms\n", stats.sessions, stats.spilled,
+           (uint32_t)(stats.latency_sum_ms / stats.latency_count), stats.latency_max_ms);
+    broker.drop_every = 0;
+}
+
+static void test_outage_spills_and_survives_reboot(void)
+{
+    fire_notify_stats_t stats;
+    const uint32_t events = 100;
+
+    flash_emu_reset();
+    broker.offline = true;
+    broker.log_count = 0;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    pthread_t thread = start_notify();
+
+    for (uint32_t i = 0; i < events; i++) {
+        CHECK(fire_notify_post(FIRE_EVENT_ALARM, 1, fire_notify_now_ms()));
+    }
+    // Đủ lâu cho vài lần kết nối thất bại
+    usleep(500000);
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.published, 0);
+    CHECK_EQ(stats.pending, events);
+    CHECK_EQ(stats.spilled, events - FIRE_OUTBOX_RAM_SLOTS);
+    CHECK(stats.failures > 0);
+    stop_notify(thread);
+
+    // Khởi động lại: sự kiện trong RAM mất, sự kiện trên flash được gửi tiếp
+    broker.offline = false;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.pending, events - FIRE_OUTBOX_RAM_SLOTS);
+    thread = start_notify();
+    CHECK(fire_notify_post(FIRE_EVENT_RECOVERY, 1, fire_notify_now_ms()));
+    CHECK(wait_delivered(events - FIRE_OUTBOX_RAM_SLOTS + 1, 5000));
+    stop_notify(thread);
+
+    check_broker_sequence(0, FIRE_OUTBOX_RAM_SLOTS, events);
+    // Sự kiện của lần khởi động trước không có độ trễ, sự kiện mới thì có
+    CHECK_EQ(broker.latency_log[0], UINT32_MAX);
+    CHECK(broker.latency_log[broker.log_count - 1] != UINT32_MAX);
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.latency_count, 1);
+}
+
+// Task bị treo, bộ giám sát khởi động lại khi hàng đợi RAM còn sự kiện (một
+// phần đã tràn sang flash): sau khởi động lại không mất sự kiện nào
+static void test_restart_keeps_ram_events(void)
+{
+    fire_notify_stats_t stats;
+    const uint32_t events = FIRE_OUTBOX_RAM_SLOTS + 4;
+    bool seen[FIRE_OUTBOX_RAM_SLOTS + 4] = { false };
+
+    flash_emu_reset();
+    broker.offline = true;
+    broker.log_count = 0;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    pthread_t thread = start_notify();
+    for (uint32_t i = 0; i < events; i++) {
+        CHECK(fire_notify_post(FIRE_EVENT_ALARM, 1, fire_notify_now_ms()));
+    }
+    usleep(200000);
+    CHECK(fire_notify_persist());
+    stop_notify(thread);
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.published, 0);
+    CHECK_EQ(stats.spilled, events);
+
+    // Khởi động lại: mọi sự kiện đều nằm trong vùng flash chờ gửi
+    broker.offline = false;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    fire_notify_get_stats(&stats);
+    CHECK_EQ(stats.pending, events);
+    thread = start_notify();
+    CHECK(wait_delivered(events, 5000));
+    stop_notify(thread);
+
+    // Phần từ RAM nằm sau phần đã tràn nên có thể lệch thứ tự; seq vẫn đủ
+    CHECK_EQ(broker.log_count, events);
+    for (uint32_t i = 0; i < broker.log_count; i++) {
+        CHECK(broker.seq_log[i] < events);
+        if (broker.seq_log[i] < events) {
+            CHECK(!seen[broker.seq_log[i]]);
+            seen[broker.seq_log[i]] = true;
+        }
+    }
+}
+
+// Mốc seq lưu bền giả lập (sysparam trên thiết bị)
+static uint32_t stored_mark;
+static bool mark_valid;
+static uint32_t mark_writes;
+
+static bool seq_load(uint32_t *mark)
+{
+    *mark = stored_mark;
+    return mark_valid;
+}
+
+static bool seq_store(uint32_t mark)
+{
+    stored_mark = mark;
+    mark_valid = true;
+    mark_writes++;
+    return true;
+}
+
+// Sự kiện đã gửi từ RAM, rồi khởi động lại với vùng flash trống: seq mới
+// không trùng seq cũ, nên subscriber lọc trùng theo seq không bỏ sự kiện thật
+static void test_seq_unique_across_reboots(void)
+{
+    const uint32_t events = FIRE_NOTIFY_SEQ_LEASE / 2 + 10;
+
+    flash_emu_reset();
+    broker.log_count = 0;
+    mark_valid = false;
+    mark_writes = 0;
+    config.seq_load = seq_load;
+    config.seq_store = seq_store;
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(stored_mark, FIRE_NOTIFY_SEQ_LEASE);
+    pthread_t thread = start_notify();
+    for (uint32_t i = 0; i < events; i++) {
+        CHECK(fire_notify_post(FIRE_EVENT_ALARM, 1, fire_notify_now_ms()));
+        // Gửi hết từ RAM, không dùng vùng flash chờ gửi
+        if ((i + 1) % FIRE_OUTBOX_RAM_SLOTS == 0) {
+            CHECK(wait_delivered(i + 1, 5000));
+        }
+    }
+    CHECK(wait_delivered(events, 5000));
+    stop_notify(thread);
+    check_broker_sequence(0, 0, events - 1);
+    // Đã qua nửa dải: mốc được dời một lần trong task MQTT
+    CHECK_EQ(mark_writes, 2);
+    CHECK(stored_mark >= events + FIRE_NOTIFY_SEQ_LEASE / 2);
+
+    // Khởi động lại, vùng flash chờ gửi trống
+    uint32_t mark = stored_mark;
+    uint32_t from_log = broker.log_count;
+    flash_emu_reset();
+    CHECK(fire_notify_init(&config, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    thread = start_notify();
+    CHECK(fire_notify_post(FIRE_EVENT_ALARM, 1, fire_notify_now_ms()));
+    CHECK(wait_delivered(1, 5000));
+    stop_notify(thread);
+    check_broker_sequence(from_log, mark, mark);
+    CHECK_EQ(stored_mark, mark + FIRE_NOTIFY_SEQ_LEASE);
+
+    config.seq_load = NULL;
+    config.seq_store = NULL;
+}
+
+static void test_keepalive_while_idle(void)
+{
+    flash_emu_reset();
+    broker.pings = 0;
+    CHECK(fire_notify_init(&config, NULL, 0, 0));
+    pthread_t thread = start_notify();
+
+    // keep-alive 1 s: phải có PINGREQ khi không có sự kiện
+    usleep(2600000);
+    CHECK(broker.pings >= 1);
+    CHECK(fire_notify_post(FIRE_EVENT_ALARM, 2, fire_notify_now_ms()));
+    CHECK(wait_delivered(1, 2000));
+    stop_notify(thread);
+}
+
+int main(void)
+{
+    if (!mqtt_broker_start(&broker)) {
+        printf("cannot start broker\n");
+        return 1;
+    }
+    config.port = broker.port;
+
+    RUN_TEST(test_format);
+    RUN_TEST(test_delivers_in_order_across_drops);
+    RUN_TEST(test_outage_spills_and_survives_reboot);
+    RUN_TEST(test_restart_keeps_ram_events);
+    RUN_TEST(test_seq_unique_across_reboots);
+    RUN_TEST(test_keepalive_while_idle);
+
+    mqtt_broker_stop(&broker);
+    return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+#include <stdint.h>
+
+#include "fire_power.h"
+#include "test_common.h"
+
+#define TICK_US 10000
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(uint32_t n)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (rng_state >> 8) % n;
+}
+
+static void test_select_policy(void)
+{
+    fire_power_t pm;
+    fire_power_init(&pm, 0);
+
+    CHECK_EQ(fire_power_select(&pm, UINT32_MAX), FIRE_POWER_AUTO_LIGHT);
+    CHECK_EQ(fire_power_select(&pm, FIRE_POWER_AUTO_LIGHT_MIN_US), FIRE_POWER_AUTO_LIGHT);
+    CHECK_EQ(fire_power_select(&pm, FIRE_POWER_AUTO_LIGHT_MIN_US - 1), FIRE_POWER_MODEM_SLEEP);
+    CHECK_EQ(fire_power_select(&pm, FIRE_POWER_MODEM_MIN_US - 1), FIRE_POWER_IDLE);
+
+    // LED nhấp nháy bằng FRC1: SDK không bao giờ được tự vào light sleep
+    pm.holds = FIRE_POWER_HOLD_LED;
+    CHECK_EQ(fire_power_select(&pm, UINT32_MAX), FIRE_POWER_MODEM_SLEEP);
+    CHECK_EQ(fire_power_select(&pm, FIRE_POWER_MODEM_MIN_US - 1), FIRE_POWER_IDLE);
+    CHECK_EQ(fire_power_deepest(pm.holds), FIRE_POWER_MODEM_SLEEP);
+
+    // Đang báo động: radio luôn bật, đánh thức tức thì
+    pm.holds = FIRE_POWER_HOLD_ALARM | FIRE_POWER_HOLD_LED;
+    CHECK_EQ(fire_power_select(&pm, UINT32_MAX), FIRE_POWER_IDLE);
+    CHECK_EQ(fire_power_exit_us(fire_power_select(&pm, UINT32_MAX)), 0);
+    CHECK_EQ(fire_power_exit_us(FIRE_POWER_AUTO_LIGHT), FIRE_POWER_AUTO_LIGHT_EXIT_US);
+}
+
+static void test_accounting(void)
+{
+    fire_power_t pm;
+    fire_power_stats_t stats;
+
+    fire_power_init(&pm, 1000);
+    fire_power_enter(&pm, FIRE_POWER_AUTO_LIGHT, 1500);
+    fire_power_wake(&pm, FIRE_POWER_WAKE_TIMER, 3601500);
+    fire_power_enter(&pm, FIRE_POWER_MODEM_SLEEP, 3602000);
+    fire_power_wake(&pm, FIRE_POWER_WAKE_GPIO, 3612000);
+    fire_power_snapshot(&pm, 3613000, &stats);
+
+    CHECK_EQ(stats.time_us[FIRE_POWER_ACTIVE], 500 + 500 + 1000);
+    CHECK_EQ(stats.time_us[FIRE_POWER_AUTO_LIGHT], 3600000);
+    CHECK_EQ(stats.time_us[FIRE_POWER_MODEM_SLEEP], 10000);
+    CHECK_EQ(stats.entries[FIRE_POWER_AUTO_LIGHT], 1);
+    CHECK_EQ(stats.entries[FIRE_POWER_ACTIVE], 2);
+    CHECK_EQ(stats.wakes[FIRE_POWER_WAKE_GPIO], 1);
+    CHECK_EQ(stats.wakes[FIRE_POWER_WAKE_TIMER], 1);
+    // Bản chụp không làm thay đổi khoảng đang mở
+    CHECK_EQ(pm.stats.time_us[FIRE_POWER_ACTIVE], 1000);
+
+    // 1 giờ auto light tính như modem sleep = 15000 µAh
+    fire_power_stats_t hour = { .time_us = { [FIRE_POWER_AUTO_LIGHT] = 3600000000ull } };
+    CHECK_EQ(fire_power_charge_uah(&hour), FIRE_POWER_AUTO_LIGHT_UA);
+    hour.time_us[FIRE_POWER_ACTIVE] = 36000000; // + 1% thời gian ở ACTIVE
+    CHECK_EQ(fire_power_charge_uah(&hour), FIRE_POWER_AUTO_LIGHT_UA + FIRE_POWER_ACTIVE_UA / 100);
+
+    // sdk_system_get_time() quay vòng sau 71 phút
+    fire_power_init(&pm, UINT32_MAX - 99);
+    fire_power_enter(&pm, FIRE_POWER_IDLE, 100);
+    CHECK_EQ(pm.stats.time_us[FIRE_POWER_ACTIVE], 200);
+}
+
+// Bộ lập lịch giả lập: các deadline của task theo tick (LED nhấp nháy bằng
+// task, probe mạng, debounce) và cạnh GPIO ngẫu nhiên. Mỗi lần mọi task đang
+// chờ, chip ngủ theo fire_power_select() tới deadline hoặc cạnh kế tiếp, rồi
+// cần thêm fire_power_exit_us() để chạy lại.
+typedef struct {
+    uint64_t now;
+    uint64_t probe_at;     // Probe mạng mỗi 5 s
+    uint64_t led_at;       // Bước LED do task định thời (UINT64_MAX khi tắt)
+    uint64_t debounce_at;  // Hết debounce/recovery (UINT64_MAX khi không chờ)
+    uint64_t edge_at;      // Cạnh GPIO kế tiếp
+    bool input;            // Mức đầu vào báo cháy
+    bool alarm;
+    uint32_t max_gpio_latency_us;
+    uint32_t max_timer_late_us;
+    uint32_t auto_light_with_led;
+    uint32_t slow_alarm_wakes;
+} sched_model_t;
+
+static uint64_t min_u64(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
+
+// Deadline tính theo tick, như timer FreeRTOS
+static uint64_t tick_ceil(uint64_t us)
+{
+    return (us + TICK_US - 1) / TICK_US * TICK_US;
+}
+
+static void model_run_due(sched_model_t *m, fire_power_t *pm)
+{
+    if (m->now >= m->probe_at) {
+        m->probe_at += 5000000;
+    }
+    if (m->now >= m->led_at) {
+        m->led_at += 200000;
+    }
+    if (m->now >= m->debounce_at) {
+        m->debounce_at = UINT64_MAX;
+        if (m->input != m->alarm) {
+            m->alarm = m->input;
+            // Như fire_apply_batch() và led_manager: báo động giữ radio, LED nhấp nháy bằng FRC1
+            if (m->alarm) {
+                pm->holds |= FIRE_POWER_HOLD_ALARM | FIRE_POWER_HOLD_LED;
+            } else {
+                pm->holds &= ~(FIRE_POWER_HOLD_ALARM | FIRE_POWER_HOLD_LED);
+            }
+        }
+    }
+}
+
+static void test_scheduler_wake_bounds(void)
+{
+    fire_power_t pm;
+    fire_power_stats_t stats;
+    sched_model_t m = {
+        .probe_at = 5000000,
+        .led_at = UINT64_MAX,
+        .debounce_at = UINT64_MAX,
+        .edge_at = 1000000,
+    };
+    uint64_t end = 3600ull * 1000000; // 1 giờ
+
+    fire_power_init(&pm, 0);
+    while (m.now < end) {
+        // Task chạy một lúc sau mỗi lần thức dậy
+        m.now += 50 + rng(1000);
+        model_run_due(&m, &pm);
+
+        uint64_t deadline = min_u64(min_u64(m.probe_at, m.led_at), m.debounce_at);
+        uint64_t idle_us = deadline > m.now ? deadline - m.now : 0;
+        fire_power_state_t state = fire_power_select(&pm, idle_us > UINT32_MAX ? UINT32_MAX : idle_us);
+        uint32_t exit_us = fire_power_exit_us(state);
+
+        if (state == FIRE_POWER_AUTO_LIGHT && (pm.holds & FIRE_POWER_HOLD_LED)) {
+            m.auto_light_with_led++;
+        }
+        fire_power_enter(&pm, state, m.now);
+        if (m.edge_at < deadline) {
+            // Cạnh GPIO: ISR chạy sau thời gian thoát khỏi mức ngủ (cạnh đến khi
+            // task còn chạy thì ISR chạy ngay, chip vừa vào đã thức)
+            uint64_t edge = m.edge_at > m.now ? m.edge_at : m.now;
+            m.now = edge + exit_us;
+            fire_power_wake(&pm, FIRE_POWER_WAKE_GPIO, m.now);
+            if (m.now - edge > m.max_gpio_latency_us) {
+                m.max_gpio_latency_us = m.now - edge;
+            }
+            if ((pm.holds & FIRE_POWER_HOLD_ALARM) && m.now != edge) {
+                m.slow_alarm_wakes++;
+            }
+            m.input = !m.input;
+            m.debounce_at = tick_ceil(m.now + (m.input ? 20000 : 200000)) + TICK_US;
+            // Phần lớn là nhiễu ngắn hơn debounce, đôi khi là báo cháy kéo dài vài giây;
+            // đầu vào yên lặng tới vài phút giữa hai lần
+            if (m.input) {
+                m.edge_at = edge + (rng(8) != 0 ? 1000 + rng(15000) : 1000000 + rng(30000000));
+            } else {
+                m.edge_at = edge + 1000000 + rng(120000000);
+            }
+        } else {
+            m.now = (deadline > m.now ? deadline : m.now) + exit_us;
+            fire_power_wake(&pm, FIRE_POWER_WAKE_TIMER, m.now);
+            if (m.now - deadline > m.max_timer_late_us) {
+                m.max_timer_late_us = m.now - deadline;
+            }
+        }
+        // LED do task định thời chỉ chạy khi không có báo động
+        if (!m.alarm && m.led_at == UINT64_MAX && rng(50) == 0) {
+            m.led_at = tick_ceil(m.now) + 200000;
+        } else if (m.alarm) {
+            m.led_at = UINT64_MAX;
+        }
+    }
+
+    CHECK_EQ(m.auto_light_with_led, 0);
+    CHECK_EQ(m.slow_alarm_wakes, 0);
+    // Cạnh báo cháy được xử lý trong thời gian SDK thoát light sleep; deadline của
+    // task trễ ít hơn một tick nên LED và debounce giữ đúng độ phân giải tick
+    CHECK(m.max_gpio_latency_us <= FIRE_POWER_AUTO_LIGHT_EXIT_US);
+    CHECK(m.max_timer_late_us <= FIRE_POWER_AUTO_LIGHT_EXIT_US);
+    CHECK(FIRE_POWER_AUTO_LIGHT_EXIT_US < TICK_US);
+
+    // Mọi micro giây được tính vào đúng một trạng thái
+    fire_power_snapshot(&pm, m.now, &stats);
+    uint64_t total = 0;
+    for (int i = 0; i < FIRE_POWER_STATES; i++) {
+        total += stats.time_us[i];
+    }
+    CHECK_EQ(total, m.now);
+    CHECK_EQ(stats.entries[FIRE_POWER_ACTIVE], stats.wakes[FIRE_POWER_WAKE_GPIO] + stats.wakes[FIRE_POWER_WAKE_TIMER]);
+    CHECK(stats.wakes[FIRE_POWER_WAKE_GPIO] > 100);
+    CHECK(stats.entries[FIRE_POWER_AUTO_LIGHT] > 0);
+    // Phần lớn thời gian chờ ở auto light: kể cả khi chỉ tính dòng modem sleep
+    // vẫn tốn chưa tới một nửa so với chỉ WAITI
+    CHECK(stats.time_us[FIRE_POWER_AUTO_LIGHT] > m.now / 2);
+    CHECK(fire_power_charge_uah(&stats) < FIRE_POWER_IDLE_UA / 2);
+}
+
+int main(void)
+{
+    RUN_TEST(test_select_policy);
+    RUN_TEST(test_accounting);
+    RUN_TEST(test_scheduler_wake_bounds);
+    return TEST_RESULT();
+}
@@ -0,0 +1,289 @@
+#include <stdint.h>
+
+#include "fire_smoke.h"
+#include "fire_zones.h"
+#include "fire_clock.h"
+#include "smoke_trace.h"
+#include "test_common.h"
+
+// Như bảng vùng trong fire.c: kênh analog phải báo khói liên tục 1 s
+#define SMOKE_DEBOUNCE_US 1000000
+#define SMOKE_RECOVERY_US 5000000
+
+#define Q4(x) ((x) * (1 << FIRE_SMOKE_FRAC_BITS))
+
+static smoke_trace_t trace;
+
+// Kết quả chạy một bản ghi qua bộ lọc và bộ xử lý vùng
+typedef struct {
+    uint32_t level_on_ms;   // First time the level detector activated, UINT32_MAX if never
+    uint32_t rise_on_ms;    // First time the rise detector activated
+    uint32_t alarm_ms;      // First time the zone raised its alarm
+    uint32_t alarms;
+    bool alarm_at_end;
+} smoke_run_t;
+
+static void run_trace(const char *name, const fire_smoke_config_t *config, smoke_run_t *run)
+{
+    static const fire_zone_config_t zone = {
+        FIRE_ZONES_ANALOG_INPUT(0), true, SMOKE_DEBOUNCE_US, SMOKE_RECOVERY_US
+    };
+    fire_smoke_channel_t ch;
+    fire_zones_t zones;
+    fire_zones_batch_t batch;
+
+    *run = (smoke_run_t){ .level_on_ms = UINT32_MAX, .rise_on_ms = UINT32_MAX, .alarm_ms = UINT32_MAX };
+    CHECK(smoke_trace_load(&trace, name));
+    CHECK(fire_smoke_init(&ch, config));
+    CHECK(fire_zones_init(&zones, &zone, 1));
+
+    for (uint32_t i = 0; i < trace.count; i++) {
+        uint32_t ccount = trace.ms[i] * 1000 * FIRE_CLOCK_HOST_MHZ;
+        bool active = fire_smoke_update(&ch, trace.adc[i]);
+
+        if (ch.level_active && run->level_on_ms == UINT32_MAX) {
+            run->level_on_ms = trace.ms[i];
+        }
+        if (ch.rise_active && run->rise_on_ms == UINT32_MAX) {
+            run->rise_on_ms = trace.ms[i];
+        }
+        // Timer debounce/recovery có độ phân giải bằng chu kỳ lấy mẫu
+        fire_zones_batch_clear(&batch);
+        uint32_t timeout_us;
+        if (fire_zones_next_timeout(&zones, ccount, &timeout_us) && timeout_us == 0) {
+            fire_zones_expire(&zones, ccount, &batch);
+        }
+        fire_zones_input(&zones, active ? (uint64_t)1 << FIRE_ZONES_ANALOG_INPUT(0) : 0, ccount, &batch);
+        if (batch.raised) {
+            run->alarms++;
+            if (run->alarm_ms == UINT32_MAX) {
+                run->alarm_ms = trace.ms[i];
+            }
+        }
+    }
+    run->alarm_at_end = fire_zones_alarms(&zones) != 0;
+}
+
+// Bước 0 -> 100 qua trung bình 4 mẫu: tăng đều 25 mỗi mẫu, không sai số làm tròn
+static void test_moving_average(void)
+{
+    static const fire_smoke_config_t config = { .average_shift = 2, .level_on = 1000, .level_off = 1000 };
+    fire_smoke_channel_t ch;
+    CHECK(fire_smoke_init(&ch, &config));
+
+    fire_smoke_update(&ch, 0);
+    CHECK_EQ(ch.filtered, 0);
+    for (int i = 1; i <= 4; i++) {
+        fire_smoke_update(&ch, 100);
+        CHECK_EQ(ch.filtered, Q4(25 * i));
+    }
+    fire_smoke_update(&ch, 100);
+    CHECK_EQ(ch.filtered, Q4(100));
+    // Số âm (ADS111x dưới GND một chút) được chia đúng
+    for (int i = 0; i < 4; i++) {
+        fire_smoke_update(&ch, -3);
+    }
+    CHECK_EQ(ch.filtered, Q4(-3));
+}
+
+// IIR 1/4 hội tụ về đầu vào trong phạm vi nửa bước của phần phân số Q4
+// (dưới 1/8 đơn vị ADC), không kẹt cách cả một đơn vị như khi tính số nguyên
+static void test_iir_converges(void)
+{
+    static const fire_smoke_config_t config = { .iir_shift = 2, .level_on = 1000, .level_off = 1000 };
+    fire_smoke_channel_t ch;
+    CHECK(fire_smoke_init(&ch, &config));
+
+    fire_smoke_update(&ch, 0);
+    fire_smoke_update(&ch, 100);
+    CHECK_EQ(ch.filtered, Q4(25));
+    fire_smoke_update(&ch, 100);
+    CHECK_EQ(ch.filtered, Q4(25) + Q4(75) / 4);
+    for (int i = 0; i < 100; i++) {
+        fire_smoke_update(&ch, 100);
+    }
+    CHECK(ch.filtered >= Q4(100) - 1 && ch.filtered <= Q4(100) + 2);
+    for (int i = 0; i < 100; i++) {
+        fire_smoke_update(&ch, 7);
+    }
+    CHECK(ch.filtered >= Q4(7) - 1 && ch.filtered <= Q4(7) + 2);
+}
+
+// Ngưỡng có trễ: bật ở level_on, giữ tới khi xuống dưới level_off
+static void test_level_hysteresis(void)
+{
+    static const fire_smoke_config_t config = { .clean_air = 100, .level_on = 50, .level_off = 30 };
+    fire_smoke_channel_t ch;
+    CHECK(fire_smoke_init(&ch, &config));
+
+    CHECK(!fire_smoke_update(&ch, 149));
+    CHECK_EQ(fire_smoke_level(&ch), Q4(49));
+    CHECK(fire_smoke_update(&ch, 150));
+    CHECK(fire_smoke_update(&ch, 131));
+    CHECK(fire_smoke_update(&ch, 130));
+    CHECK(!fire_smoke_update(&ch, 129));
+    CHECK(!fire_smoke_update(&ch, 140));
+    CHECK(ch.level_active == false && ch.rise_active == false);
+}
+
+// Tốc độ tăng đo trên rise_samples mẫu, độc lập với mức tuyệt đối
+static void test_rate_of_rise(void)
+{
+    static const fire_smoke_config_t config = {
+        .rise_samples = 10, .level_on = 30000, .level_off = 30000, .rise_on = 20, .rise_off = 5
+    };
+    fire_smoke_channel_t ch;
+    CHECK(fire_smoke_init(&ch, &config));
+
+    // Dốc 1/mẫu: 10 trên cửa sổ, chưa đủ
+    for (int i = 0; i < 30; i++) {
+        CHECK(!fire_smoke_update(&ch, 500 + i));
+    }
+    CHECK_EQ(ch.rise, Q4(10));
+    // Dốc 3/mẫu: bật khi chênh lệch trên cửa sổ đạt 20
+    int16_t v = 530;
+    int n = 0;
+    while (!fire_smoke_update(&ch, v += 3) && n < 20) {
+        n++;
+    }
+    CHECK(ch.rise_active);
+    CHECK(!ch.level_active);
+    CHECK_EQ(ch.rise, Q4(20) + Q4(1));
+    // Đứng yên: tắt khi chênh lệch xuống dưới 5
+    n = 0;
+    while (fire_smoke_update(&ch, v) && n < 20) {
+        n++;
+    }
+    CHECK(!ch.rise_active);
+    CHECK(ch.rise < Q4(5));
+    CHECK(ch.rise >= Q4(3));
+}
+
+static void test_invalid_config(void)
+{
+    fire_smoke_channel_t ch;
+    fire_smoke_config_t config = FIRE_SMOKE_TOUT_DEFAULTS;
+    CHECK(fire_smoke_init(&ch, &config));
+    config.average_shift = FIRE_SMOKE_AVERAGE_MAX_SHIFT + 1;
+    CHECK(!fire_smoke_init(&ch, &config));
+    config = (fire_smoke_config_t)FIRE_SMOKE_TOUT_DEFAULTS;
+    config.rise_samples = FIRE_SMOKE_RISE_MAX + 1;
+    CHECK(!fire_smoke_init(&ch, &config));
+    config = (fire_smoke_config_t)FIRE_SMOKE_TOUT_DEFAULTS;
+    config.level_off = config.level_on + 1;
+    CHECK(!fire_smoke_init(&ch, &config));
+    config = (fire_smoke_config_t)FIRE_SMOKE_ADS111X_DEFAULTS;
+    CHECK(fire_smoke_init(&ch, &config));
+}
+
+// Ring giữa timer lấy mẫu và task: chỉ đánh thức khi ring rỗng, đầy thì bỏ mẫu mới
+static void test_ring(void)
+{
+    fire_smoke_ring_t ring;
+    fire_smoke_sample_t sample = { 0 }, out;
+    fire_smoke_ring_init(&ring);
+
+    sample.ccount = 1;
+    CHECK_EQ(fire_smoke_ring_push(&ring, &sample), ISR_RING_WAKE);
+    sample.ccount = 2;
+    CHECK_EQ(fire_smoke_ring_push(&ring, &sample), ISR_RING_QUEUED);
+    CHECK(fire_smoke_ring_pop(&ring, &out));
+    CHECK_EQ(out.ccount, 1);
+    CHECK(fire_smoke_ring_pop(&ring, &out));
+    CHECK_EQ(out.ccount, 2);
+    CHECK(!fire_smoke_ring_pop(&ring, &out));
+
+    for (uint32_t i = 0; i < FIRE_SMOKE_RING_SIZE + 3; i++) {
+        sample.ccount = 100 + i;
+        sample.value[0] = i;
+        fire_smoke_ring_push(&ring, &sample);
+    }
+    CHECK_EQ(fire_smoke_ring_overflows(&ring), 3);
+    CHECK(fire_smoke_ring_pop(&ring, &out));
+    CHECK_EQ(out.ccount, 100);
+    CHECK_EQ(out.value[0], 0);
+}
+
+// Cháy âm ỉ: khói tăng ~0,4/s từ 120 s, vượt 150 trên nền sau khoảng 375 s.
+// Chỉ ngưỡng mức phát hiện; nền ngừng theo khi tín hiệu rời không khí sạch
+static void test_trace_smoulder(void)
+{
+    static const fire_smoke_config_t config = FIRE_SMOKE_TOUT_DEFAULTS;
+    smoke_run_t run;
+    run_trace("smoulder", &config, &run);
+
+    CHECK_EQ(run.rise_on_ms, UINT32_MAX);
+    CHECK(run.level_on_ms > 480000);
+    CHECK(run.level_on_ms < 600000);
+    CHECK(run.alarm_ms >= run.level_on_ms + SMOKE_DEBOUNCE_US / 1000);
+    CHECK(run.alarm_ms <= run.level_on_ms + SMOKE_DEBOUNCE_US / 1000 + SMOKE_TRACE_PERIOD_MS);
+    CHECK_EQ(run.alarms, 1);
+    CHECK(run.alarm_at_end);
+}
+
+// Cháy bùng: tốc độ tăng báo trước ngưỡng mức, trong vòng 6 s từ lúc khói
+// xuất hiện (60 s); phòng được thông gió thì báo động tự xóa
+static void test_trace_flaming(void)
+{
+    static const fire_smoke_config_t config = FIRE_SMOKE_TOUT_DEFAULTS;
+    smoke_run_t run;
+    run_trace("flaming", &config, &run);
+
+    CHECK(run.rise_on_ms < run.level_on_ms);
+    CHECK(run.rise_on_ms > 60000);
+    CHECK(run.alarm_ms <= 66000);
+    CHECK_EQ(run.alarms, 1);
+    CHECK(!run.alarm_at_end);
+}
+
+// Bụi và hơi nước (một hai mẫu) và một lần tăng nhẹ 3 s: không bộ dò nào bật
+static void test_trace_nuisance(void)
+{
+    static const fire_smoke_config_t config = FIRE_SMOKE_TOUT_DEFAULTS;
+    smoke_run_t run;
+    run_trace("nuisance", &config, &run);
+
+    CHECK_EQ(run.level_on_ms, UINT32_MAX);
+    CHECK_EQ(run.rise_on_ms, UINT32_MAX);
+    CHECK_EQ(run.alarms, 0);
+
+    // Không có trung bình trượt, các xung đơn lẻ đủ làm bộ dò tốc độ tăng bật
+    fire_smoke_config_t unfiltered = FIRE_SMOKE_TOUT_DEFAULTS;
+    unfiltered.average_shift = 0;
+    unfiltered.iir_shift = 0;
+    run_trace("nuisance", &unfiltered, &run);
+    CHECK(run.rise_on_ms != UINT32_MAX);
+}
+
+// Độ trôi +150 trong 20 phút: nền theo kịp nên không báo động; với nền cố
+// định, cùng bản ghi vượt ngưỡng mức
+static void test_trace_drift(void)
+{
+    static const fire_smoke_config_t config = FIRE_SMOKE_TOUT_DEFAULTS;
+    smoke_run_t run;
+    run_trace("drift", &config, &run);
+
+    CHECK_EQ(run.level_on_ms, UINT32_MAX);
+    CHECK_EQ(run.rise_on_ms, UINT32_MAX);
+    CHECK_EQ(run.alarms, 0);
+
+    fire_smoke_config_t fixed = FIRE_SMOKE_TOUT_DEFAULTS;
+    fixed.baseline_shift = 0;
+    run_trace("drift", &fixed, &run);
+    CHECK(run.level_on_ms != UINT32_MAX);
+}
+
+int main(void)
+{
+    RUN_TEST(test_moving_average);
+    RUN_TEST(test_iir_converges);
+    RUN_TEST(test_level_hysteresis);
+    RUN_TEST(test_rate_of_rise);
+    RUN_TEST(test_invalid_config);
+    RUN_TEST(test_ring);
+    RUN_TEST(test_trace_smoulder);
+    RUN_TEST(test_trace_flaming);
+    RUN_TEST(test_trace_nuisance);
+    RUN_TEST(test_trace_drift);
+    return TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fire_outbox.h"
+#include "fire_spill.h"
+#include "flash_emu.h"
+#include "test_common.h"
+
+#define SPILL_BASE    (2 * FIRE_SPILL_SECTOR_SIZE)
+#define SPILL_SECTORS 3
+
+static fire_event_t make_event(uint32_t seq)
+{
+    fire_event_t event = {
+        .seq = seq,
+        .stamp_ms = seq * 10,
+        .zones = (uint64_t)1 << (seq % 64),
+        .type = seq & 1 ? FIRE_EVENT_RECOVERY : FIRE_EVENT_ALARM,
+    };
+    return event;
+}
+
+static void check_event(const fire_event_t *event, uint32_t seq)
+{
+    fire_event_t expected = make_event(seq);
+    CHECK_EQ(event->seq, expected.seq);
+    CHECK_EQ(event->stamp_ms, expected.stamp_ms);
+    CHECK(event->zones == expected.zones);
+    CHECK_EQ(event->type, expected.type);
+}
+
+static void test_append_peek_consume(void)
+{
+    fire_spill_t spill;
+    fire_event_t event;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, 0);
+    CHECK_EQ(spill.next_seq, 0);
+    CHECK(!fire_spill_peek(&spill, 0, &event));
+
+    for (uint32_t seq = 0; seq < 5; seq++) {
+        fire_event_t e = make_event(seq);
+        CHECK(fire_spill_append(&spill, &e));
+    }
+    CHECK_EQ(spill.count, 5);
+    CHECK_EQ(spill.next_seq, 5);
+    for (uint32_t i = 0; i < 5; i++) {
+        CHECK(fire_spill_peek(&spill, i, &event));
+        check_event(&event, i);
+    }
+
+    fire_spill_consume(&spill, 2);
+    CHECK_EQ(spill.count, 3);
+    CHECK(fire_spill_peek(&spill, 0, &event));
+    check_event(&event, 2);
+
+    // Vùng flash nằm ngoài khoảng cho phép / quá ít sector
+    CHECK(!fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE + 32, SPILL_SECTORS));
+    CHECK(!fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, 1));
+}
+
+static void test_remount_recovers_pending(void)
+{
+    fire_spill_t spill;
+    fire_event_t event;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    for (uint32_t seq = 100; seq < 110; seq++) {
+        fire_event_t e = make_event(seq);
+        CHECK(fire_spill_append(&spill, &e));
+    }
+    fire_spill_consume(&spill, 4);
+
+    // Khởi động lại: chỉ còn các bản ghi chưa gửi, seq tiếp tục tăng
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, 6);
+    CHECK_EQ(spill.next_seq, 110);
+    for (uint32_t i = 0; i < 6; i++) {
+        CHECK(fire_spill_peek(&spill, i, &event));
+        check_event(&event, 104 + i);
+    }
+
+    // Đã gửi hết: seq vẫn được giữ qua lần khởi động sau
+    fire_spill_consume(&spill, 6);
+    CHECK_EQ(spill.count, 0);
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, 0);
+    CHECK_EQ(spill.next_seq, 110);
+    fire_event_t e = make_event(110);
+    CHECK(fire_spill_append(&spill, &e));
+    CHECK(fire_spill_peek(&spill, 0, &event));
+    check_event(&event, 110);
+}
+
+static void test_torn_write_is_ignored(void)
+{
+    fire_spill_t spill;
+    fire_event_t event;
+    fire_event_t e;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    for (uint32_t seq = 0; seq < 3; seq++) {
+        e = make_event(seq);
+        CHECK(fire_spill_append(&spill, &e));
+    }
+
+    // Mất điện sau khi ghi một phần dữ liệu, trước khi ghi trạng thái
+    flash_emu_budget = 10;
+    e = make_event(3);
+    CHECK(!fire_spill_append(&spill, &e));
+    CHECK_EQ(spill.write_errors, 1);
+
+    flash_emu_budget = UINT32_MAX;
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, 3);
+    // Slot bẩn bị bỏ qua, bản ghi mới được ghi vào slot sau
+    CHECK_EQ(spill.tail, 4);
+    e = make_event(3);
+    CHECK(fire_spill_append(&spill, &e));
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(fire_spill_peek(&spill, i, &event));
+        check_event(&event, i);
+    }
+}
+
+static void test_full_and_wrap(void)
+{
+    fire_spill_t spill;
+    fire_event_t event;
+    fire_event_t e;
+    uint32_t seq = 0, consumed = 0;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    uint32_t capacity = fire_spill_capacity(&spill);
+    CHECK_EQ(capacity, (SPILL_SECTORS - 1) * FIRE_SPILL_RECORDS_PER_SECTOR);
+
+    for (; seq < capacity; seq++) {
+        e = make_event(seq);
+        CHECK(fire_spill_append(&spill, &e));
+    }
+    e = make_event(seq);
+    CHECK(!fire_spill_append(&spill, &e));
+    CHECK_EQ(spill.count, capacity);
+
+    // Ghi vòng nhiều lần quanh vùng flash
+    for (int round = 0; round < 10; round++) {
+        fire_spill_consume(&spill, FIRE_SPILL_RECORDS_PER_SECTOR);
+        consumed += FIRE_SPILL_RECORDS_PER_SECTOR;
+        for (uint32_t i = 0; i < FIRE_SPILL_RECORDS_PER_SECTOR; i++, seq++) {
+            e = make_event(seq);
+            CHECK(fire_spill_append(&spill, &e));
+        }
+        CHECK_EQ(spill.count, capacity);
+    }
+
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, capacity);
+    CHECK_EQ(spill.next_seq, seq);
+    CHECK(fire_spill_peek(&spill, 0, &event));
+    check_event(&event, consumed);
+    CHECK(fire_spill_peek(&spill, capacity - 1, &event));
+    check_event(&event, seq - 1);
+    // Vùng flash trước và sau không bị chạm tới
+    CHECK_EQ(flash_emu[SPILL_BASE - 1], 0xff);
+    CHECK_EQ(flash_emu[SPILL_BASE + SPILL_SECTORS * FIRE_SPILL_SECTOR_SIZE], 0xff);
+}
+
+static void test_outbox_overflows_to_flash_in_order(void)
+{
+    fire_spill_t spill;
+    fire_outbox_t outbox;
+    fire_event_t events[64];
+    uint32_t seq = 0, next = 0;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    fire_outbox_init(&outbox, &spill);
+
+    for (; seq < FIRE_OUTBOX_RAM_SLOTS + 10; seq++) {
+        fire_event_t e = make_event(seq);
+        CHECK(fire_outbox_push(&outbox, &e));
+    }
+    CHECK_EQ(outbox.ram_count, FIRE_OUTBOX_RAM_SLOTS);
+    CHECK_EQ(outbox.spilled, 10);
+    CHECK_EQ(fire_outbox_count(&outbox), FIRE_OUTBOX_RAM_SLOTS + 10);
+
+    // Đọc qua ranh giới RAM / flash
+    uint32_t n = fire_outbox_peek(&outbox, events, 64);
+    CHECK_EQ(n, FIRE_OUTBOX_RAM_SLOTS + 10);
+    for (uint32_t i = 0; i < n; i++) {
+        CHECK_EQ(events[i].seq, i);
+    }
+
+    // RAM còn chỗ nhưng flash còn sự kiện cũ hơn: sự kiện mới vẫn vào flash
+    fire_outbox_commit(&outbox, 4);
+    next = 4;
+    fire_event_t e = make_event(seq++);
+    CHECK(fire_outbox_push(&outbox, &e));
+    CHECK_EQ(outbox.spilled, 11);
+
+    while (fire_outbox_count(&outbox) > 0) {
+        n = fire_outbox_peek(&outbox, events, 3);
+        for (uint32_t i = 0; i < n; i++) {
+            CHECK_EQ(events[i].seq, next + i);
+        }
+        fire_outbox_commit(&outbox, n);
+        next += n;
+    }
+    CHECK_EQ(next, seq);
+
+    // Hết sự kiện trên flash: lại dùng RAM
+    e = make_event(seq++);
+    CHECK(fire_outbox_push(&outbox, &e));
+    CHECK_EQ(outbox.ram_count, 1);
+    CHECK_EQ(outbox.spilled, 11);
+}
+
+// Chép RAM xuống flash trước khi khởi động lại: seq nhỏ hơn các bản ghi đã
+// tràn nhưng sau khi mount lại vẫn đủ, theo thứ tự ghi
+static void test_outbox_persist_survives_remount(void)
+{
+    fire_spill_t spill;
+    fire_outbox_t outbox;
+    fire_event_t event;
+    const uint32_t spilled = 5;
+
+    flash_emu_reset();
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    fire_outbox_init(&outbox, &spill);
+    for (uint32_t seq = 0; seq < FIRE_OUTBOX_RAM_SLOTS + spilled; seq++) {
+        fire_event_t e = make_event(seq);
+        CHECK(fire_outbox_push(&outbox, &e));
+    }
+    CHECK_EQ(fire_outbox_persist(&outbox), FIRE_OUTBOX_RAM_SLOTS);
+    CHECK_EQ(outbox.ram_count, FIRE_OUTBOX_RAM_SLOTS);
+
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, FIRE_OUTBOX_RAM_SLOTS + spilled);
+    CHECK_EQ(spill.next_seq, FIRE_OUTBOX_RAM_SLOTS + spilled);
+    for (uint32_t i = 0; i < spill.count; i++) {
+        CHECK(fire_spill_peek(&spill, i, &event));
+        check_event(&event, i < spilled ? FIRE_OUTBOX_RAM_SLOTS + i : i - spilled);
+    }
+
+    // Bản ghi tiếp theo nằm sau các bản chép, không ghi đè chúng
+    fire_event_t e = make_event(spill.next_seq);
+    CHECK(fire_spill_append(&spill, &e));
+    CHECK(fire_spill_mount(&spill, &flash_emu_ops, SPILL_BASE, SPILL_SECTORS));
+    CHECK_EQ(spill.count, FIRE_OUTBOX_RAM_SLOTS + spilled + 1);
+    CHECK(fire_spill_peek(&spill, spill.count - 1, &event));
+    check_event(&event, FIRE_OUTBOX_RAM_SLOTS + spilled);
+
+    // Không có flash: không chép được gì
+    fire_outbox_init(&outbox, NULL);
+    CHECK(fire_outbox_push(&outbox, &e));
+    CHECK_EQ(fire_outbox_persist(&outbox), 0);
+}
+
+static void test_outbox_without_spill_drops(void)
+{
+    fire_outbox_t outbox;
+    fire_event_t events[FIRE_OUTBOX_RAM_SLOTS];
+
+    fire_outbox_init(&outbox, NULL);
+    for (uint32_t seq = 0; seq < FIRE_OUTBOX_RAM_SLOTS + 3; seq++) {
+        fire_event_t e = make_event(seq);
+        CHECK_EQ(fire_outbox_push(&outbox, &e), seq < FIRE_OUTBOX_RAM_SLOTS);
+    }
+    CHECK_EQ(outbox.dropped, 3);
+    CHECK_EQ(fire_outbox_peek(&outbox, events, FIRE_OUTBOX_RAM_SLOTS), FIRE_OUTBOX_RAM_SLOTS);
+    CHECK_EQ(events[FIRE_OUTBOX_RAM_SLOTS - 1].seq, FIRE_OUTBOX_RAM_SLOTS - 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_append_peek_consume);
+    RUN_TEST(test_remount_recovers_pending);
+    RUN_TEST(test_torn_write_is_ignored);
+    RUN_TEST(test_full_and_wrap);
+    RUN_TEST(test_outbox_overflows_to_flash_in_order);
+    RUN_TEST(test_outbox_persist_survives_remount);
+    RUN_TEST(test_outbox_without_spill_drops);
+    return TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fire_trace.h"
+#include "fire_clock.h"
+#include "test_common.h"
+
+#define US(x) ((uint32_t)(x) * FIRE_CLOCK_HOST_MHZ)
+
+// Mỗi giá trị rơi vào bucket có floor <= giá trị < floor của bucket sau
+static void test_buckets(void)
+{
+    CHECK_EQ(fire_trace_bucket(0), 0);
+    CHECK_EQ(fire_trace_bucket(3), 3);
+    CHECK_EQ(fire_trace_bucket(4), 4);
+    CHECK_EQ(fire_trace_bucket(8), 8);
+    CHECK_EQ(fire_trace_bucket(UINT32_MAX), FIRE_TRACE_BUCKETS - 1);
+
+    for (uint32_t us = 0; us < 4000000; us += us < 5000 ? 1 : 97) {
+        uint8_t bucket = fire_trace_bucket(us);
+        CHECK(fire_trace_bucket_floor(bucket) <= us);
+        CHECK(bucket == FIRE_TRACE_BUCKETS - 1 || us < fire_trace_bucket_floor(bucket + 1));
+    }
+    for (int bucket = 0; bucket < FIRE_TRACE_BUCKETS; bucket++) {
+        CHECK_EQ(fire_trace_bucket(fire_trace_bucket_floor(bucket)), bucket);
+    }
+}
+
+static void test_percentiles(void)
+{
+    fire_trace_init();
+    const fire_trace_hist_t *hist = fire_trace_stage(FIRE_TRACE_STAGE_WAKE);
+    CHECK_EQ(fire_trace_percentile(hist, 500), 0);
+
+    // 98 mẫu 10 us, 2 mẫu 5000 us
+    for (int i = 0; i < 98; i++) {
+        fire_trace_record(FIRE_TRACE_STAGE_WAKE, US(10));
+    }
+    fire_trace_record(FIRE_TRACE_STAGE_WAKE, US(5000));
+    fire_trace_record(FIRE_TRACE_STAGE_WAKE, US(5000));
+    CHECK_EQ(hist->count, 100);
+    CHECK_EQ(hist->max_us, 5000);
+    CHECK_EQ(fire_trace_percentile(hist, 500), 11); // Bucket [10, 12)
+    CHECK_EQ(fire_trace_percentile(hist, 980), 11);
+    CHECK_EQ(fire_trace_percentile(hist, 990), 5000); // Capped at the maximum
+    CHECK_EQ(fire_trace_percentile(hist, 1000), 5000);
+}
+
+static void alarm(uint32_t edge_us, uint32_t debounce_us, uint32_t command_us, uint32_t output_us)
+{
+    uint32_t t = US(edge_us);
+    fire_trace_point(FIRE_TRACE_EDGE, t);
+    fire_trace_point(FIRE_TRACE_ALARM, t += US(debounce_us));
+    fire_trace_point(FIRE_TRACE_COMMAND, t += US(command_us));
+    fire_trace_point(FIRE_TRACE_OUTPUT, t += US(output_us));
+}
+
+static void test_spans(void)
+{
+    fire_trace_init();
+
+    // Lệnh LED không thuộc báo động nào bị bỏ qua
+    fire_trace_point(FIRE_TRACE_COMMAND, 1);
+    fire_trace_point(FIRE_TRACE_OUTPUT, 2);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_TOTAL)->count, 0);
+
+    // CCOUNT tràn giữa chừng vẫn cho độ trễ đúng
+    alarm(UINT32_MAX / FIRE_CLOCK_HOST_MHZ - 10000, 20000, 5, 300);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_DEBOUNCE)->max_us, 20000);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_COMMAND)->max_us, 5);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_OUTPUT)->max_us, 300);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_TOTAL)->max_us, 20305);
+
+    // Span đã đóng: OUTPUT tiếp theo (LED nhấp nháy) không được tính lại
+    fire_trace_point(FIRE_TRACE_OUTPUT, 12345);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_TOTAL)->count, 1);
+
+    // EDGE mới (debounce bắt đầu lại) mở lại span từ đầu
+    fire_trace_point(FIRE_TRACE_EDGE, US(100));
+    fire_trace_point(FIRE_TRACE_EDGE, US(200));
+    fire_trace_point(FIRE_TRACE_ALARM, US(20200));
+    fire_trace_point(FIRE_TRACE_COMMAND, US(20210));
+    fire_trace_point(FIRE_TRACE_OUTPUT, US(20300));
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_TOTAL)->count, 2);
+    CHECK_EQ(fire_trace_stage(FIRE_TRACE_STAGE_DEBOUNCE)->max_us, 20000);
+}
+
+static void test_encode_decode(void)
+{
+    static uint8_t frame[FIRE_TRACE_FRAME_MAX];
+    static fire_trace_dump_t dump;
+
+    fire_trace_init();
+    for (int i = 0; i < 6; i++) {
+        alarm(i * 1000000, 20000 + i, 3, 100 * i);
+        fire_trace_record(FIRE_TRACE_STAGE_WAKE, US(i * 7));
+    }
+    size_t len = fire_trace_encode(frame, sizeof(frame), 80);
+    CHECK(len > 0 && len < 300); // Only the non-zero bucket range is sent
+    CHECK_EQ(fire_trace_decode(frame, len, &dump), len);
+    CHECK_EQ(dump.cpu_mhz, 80);
+    for (int s = 0; s < FIRE_TRACE_STAGES; s++) {
+        CHECK(memcmp(&dump.stages[s], fire_trace_stage(s), sizeof(fire_trace_hist_t)) == 0);
+    }
+    // Chỉ giữ FIRE_TRACE_SPANS báo động gần nhất, cũ nhất trước
+    CHECK_EQ(dump.span_count, FIRE_TRACE_SPANS);
+    CHECK_EQ(dump.spans[0].ccount[FIRE_TRACE_EDGE], US((6 - FIRE_TRACE_SPANS) * 1000000));
+    CHECK_EQ(dump.spans[FIRE_TRACE_SPANS - 1].ccount[FIRE_TRACE_EDGE], US(5000000));
+
+    // Thiếu byte, sai một bit hoặc bộ đệm nhỏ đều bị từ chối
+    CHECK_EQ(fire_trace_decode(frame, len - 1, &dump), 0);
+    frame[len / 2] ^= 0x10;
+    CHECK_EQ(fire_trace_decode(frame, len, &dump), 0);
+    CHECK_EQ(fire_trace_encode(frame, len - 1, 80), 0);
+}
+
+// Histogram đầy nhất vẫn vừa FIRE_TRACE_FRAME_MAX
+static void test_frame_max(void)
+{
+    static uint8_t frame[FIRE_TRACE_FRAME_MAX];
+    static fire_trace_dump_t dump;
+
+    fire_trace_init();
+    for (int s = 0; s < FIRE_TRACE_STAGES; s++) {
+        for (int bucket = 0; bucket < FIRE_TRACE_BUCKETS; bucket++) {
+            fire_trace_record(s, US(fire_trace_bucket_floor(bucket)));
+        }
+    }
+    for (int i = 0; i < FIRE_TRACE_SPANS; i++) {
+        alarm(i, 1, 1, 1);
+    }
+    size_t len = fire_trace_encode(frame, sizeof(frame), 80);
+    CHECK_EQ(len, FIRE_TRACE_FRAME_MAX);
+    CHECK_EQ(fire_trace_decode(frame, len, &dump), len);
+    CHECK_EQ(dump.stages[FIRE_TRACE_STAGE_WAKE].buckets[FIRE_TRACE_BUCKETS - 1], 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_buckets);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_spans);
+    RUN_TEST(test_encode_decode);
+    RUN_TEST(test_frame_max);
+    return TEST_RESULT();
+}
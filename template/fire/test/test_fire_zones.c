@@ -0,0 +1,172 @@
+#include <stdint.h>
+
+#include "fire_zones.h"
+#include "fire_clock.h"
+#include "test_common.h"
+
+#define DEBOUNCE_US 20000
+#define RECOVERY_US 200000
+
+// Chuyển micro giây sang số chu kỳ CCOUNT trên host
+#define US(x) ((uint32_t)(x) * FIRE_CLOCK_HOST_MHZ)
+
+static fire_zones_t zones;
+static fire_zones_batch_t batch;
+static fire_zone_config_t table[FIRE_ZONES_MAX];
+
+// Mức nghỉ của toàn bộ từ đầu vào (tất cả vùng tích cực mức thấp)
+#define IDLE UINT64_MAX
+
+static void make_table(uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        table[i].input = i;
+        table[i].active_high = false;
+        table[i].debounce_us = DEBOUNCE_US;
+        table[i].recovery_us = RECOVERY_US;
+    }
+}
+
+static void test_rejects_invalid_tables(void)
+{
+    make_table(2);
+    table[1].input = 0;
+    CHECK(!fire_zones_init(&zones, table, 2));
+    table[1].input = FIRE_ZONES_INPUT_BITS;
+    CHECK(!fire_zones_init(&zones, table, 2));
+    make_table(FIRE_ZONES_MAX);
+    CHECK(fire_zones_init(&zones, table, FIRE_ZONES_MAX));
+}
+
+static void test_simultaneous_edges_coalesce(void)
+{
+    uint32_t timeout_us;
+    make_table(FIRE_ZONES_MAX);
+    CHECK(fire_zones_init(&zones, table, FIRE_ZONES_MAX));
+
+    // Ba vùng (0, 17, 63) cùng xuống mức thấp trong một snapshot
+    uint64_t mask = ((uint64_t)1 << 0) | ((uint64_t)1 << 17) | ((uint64_t)1 << 63);
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, IDLE & ~mask, US(1000), &batch);
+    CHECK_EQ(batch.edges, 3);
+    CHECK(batch.raised == 0);
+    CHECK(zones.timers == mask);
+    CHECK(fire_zones_next_timeout(&zones, US(1000), &timeout_us));
+    CHECK_EQ(timeout_us, DEBOUNCE_US);
+
+    fire_zones_batch_clear(&batch);
+    fire_zones_expire(&zones, US(1000 + DEBOUNCE_US), &batch);
+    CHECK(batch.raised == mask);
+    CHECK(fire_zones_alarms(&zones) == mask);
+    CHECK_EQ(batch.oldest_edge, US(1000));
+    CHECK(!fire_zones_next_timeout(&zones, US(1000 + DEBOUNCE_US), &timeout_us));
+}
+
+static void test_active_high_and_expander_inputs(void)
+{
+    fire_zone_config_t cfg[] = {
+        { 12, false, DEBOUNCE_US, RECOVERY_US },
+        { FIRE_ZONES_EXPANDER_INPUT(0, 3), false, DEBOUNCE_US, RECOVERY_US },
+        { FIRE_ZONES_EXPANDER_INPUT(5, 7), true, 1000, RECOVERY_US },
+    };
+    CHECK(fire_zones_init(&zones, cfg, 3));
+
+    // Vùng active-high ở mức thấp là bình thường: không có cạnh nào
+    uint64_t word = IDLE & ~((uint64_t)1 << FIRE_ZONES_EXPANDER_INPUT(5, 7));
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, word, US(0), &batch);
+    CHECK_EQ(batch.edges, 0);
+
+    word &= ~((uint64_t)1 << FIRE_ZONES_EXPANDER_INPUT(0, 3));
+    fire_zones_input(&zones, word, US(0), &batch);
+    fire_zones_expire(&zones, US(DEBOUNCE_US), &batch);
+    CHECK(batch.raised == 2);
+
+    // Cổng GPIO khác (không thuộc vùng nào) thay đổi: bị bỏ qua
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, word & ~(uint64_t)0x0f, US(DEBOUNCE_US), &batch);
+    CHECK_EQ(batch.edges, 0);
+
+    fire_zones_input(&zones, IDLE & ~((uint64_t)1 << FIRE_ZONES_EXPANDER_INPUT(5, 7)), US(50000), &batch);
+    fire_zones_expire(&zones, US(50000 + RECOVERY_US), &batch);
+    CHECK(batch.cleared == 2);
+    CHECK(fire_zones_alarms(&zones) == 0);
+}
+
+static void test_per_zone_timers(void)
+{
+    uint32_t timeout_us;
+    make_table(2);
+    table[1].debounce_us = 5000;
+    CHECK(fire_zones_init(&zones, table, 2));
+
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, IDLE & ~(uint64_t)1, US(0), &batch);
+    fire_zones_input(&zones, IDLE & ~(uint64_t)3, US(1000), &batch);
+    CHECK(fire_zones_next_timeout(&zones, US(2000), &timeout_us));
+    CHECK_EQ(timeout_us, 4000);
+
+    // Chỉ vùng 1 hết hạn debounce
+    fire_zones_expire(&zones, US(6000), &batch);
+    CHECK(batch.raised == 2);
+    CHECK(fire_zones_next_timeout(&zones, US(6000), &timeout_us));
+    CHECK_EQ(timeout_us, DEBOUNCE_US - 6000);
+
+    fire_zones_expire(&zones, US(DEBOUNCE_US), &batch);
+    CHECK(batch.raised == 3);
+    // Vùng 0 kích hoạt trước nên là cạnh cũ nhất
+    CHECK_EQ(batch.oldest_zone, 0);
+}
+
+// Recovery 60 s qua một lần CCOUNT quay vòng: hạn chờ không quá một chặng,
+// vùng thoát báo động đúng sau 60 s
+static void test_recovery_longer_than_wrap(void)
+{
+    uint32_t timeout_us;
+    uint32_t now = US(DEBOUNCE_US);
+    uint32_t waited_us = 0;
+
+    make_table(1);
+    table[0].recovery_us = 60000000;
+    CHECK(fire_zones_init(&zones, table, 1));
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, IDLE & ~(uint64_t)1, US(0), &batch);
+    fire_zones_expire(&zones, now, &batch);
+    CHECK(batch.raised == 1);
+    fire_zones_input(&zones, IDLE, now, &batch);
+
+    fire_zones_batch_clear(&batch);
+    while (fire_zones_next_timeout(&zones, now, &timeout_us)) {
+        CHECK(timeout_us <= FIRE_FSM_TIMER_STEP_US);
+        now += US(timeout_us);
+        waited_us += timeout_us;
+        fire_zones_expire(&zones, now, &batch);
+    }
+    CHECK_EQ(waited_us, 60000000);
+    CHECK(batch.cleared == 1);
+    CHECK(fire_zones_alarms(&zones) == 0);
+}
+
+static void test_glitch_on_one_zone_keeps_others(void)
+{
+    make_table(8);
+    CHECK(fire_zones_init(&zones, table, 8));
+
+    fire_zones_batch_clear(&batch);
+    fire_zones_input(&zones, IDLE & ~(uint64_t)0x81, US(0), &batch);
+    fire_zones_input(&zones, IDLE & ~(uint64_t)0x80, US(100), &batch);
+    CHECK(zones.timers == 0x80);
+    fire_zones_expire(&zones, US(DEBOUNCE_US), &batch);
+    CHECK(batch.raised == 0x80);
+}
+
+int main(void)
+{
+    RUN_TEST(test_rejects_invalid_tables);
+    RUN_TEST(test_simultaneous_edges_coalesce);
+    RUN_TEST(test_active_high_and_expander_inputs);
+    RUN_TEST(test_per_zone_timers);
+    RUN_TEST(test_glitch_on_one_zone_keeps_others);
+    RUN_TEST(test_recovery_longer_than_wrap);
+    return TEST_RESULT();
+}
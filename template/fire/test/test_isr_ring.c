@@ -0,0 +1,90 @@
+#include <stdint.h>
+
+#include "isr_ring.h"
+#include "test_common.h"
+
+static isr_ring_t ring;
+
+static void test_empty_ring(void)
+{
+    isr_event_t ev;
+    isr_ring_init(&ring);
+    CHECK_EQ(isr_ring_pop(&ring, &ev), 0);
+    CHECK_EQ(isr_ring_overflows(&ring), 0);
+}
+
+static void test_fifo_order_and_payload(void)
+{
+    isr_event_t ev;
+    isr_ring_init(&ring);
+    for (uint32_t i = 0; i < 10; i++) {
+        isr_ring_push(&ring, 1000 + i, 1 << (i % 16), (uint16_t)(0xa500 + i));
+    }
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK_EQ(isr_ring_pop(&ring, &ev), 1);
+        CHECK_EQ(ev.ccount, 1000 + i);
+        CHECK_EQ(ev.pins, 1 << (i % 16));
+        CHECK_EQ(ev.levels, 0xa500 + i);
+    }
+    CHECK_EQ(isr_ring_pop(&ring, &ev), 0);
+}
+
+static void test_wake_only_when_consumer_drained(void)
+{
+    isr_event_t ev;
+    isr_ring_init(&ring);
+    CHECK_EQ(isr_ring_push(&ring, 1, 1, 0), ISR_RING_WAKE);
+    CHECK_EQ(isr_ring_push(&ring, 2, 1, 0), ISR_RING_QUEUED);
+    CHECK_EQ(isr_ring_push(&ring, 3, 1, 0), ISR_RING_QUEUED);
+    while (isr_ring_pop(&ring, &ev)) {
+    }
+    CHECK_EQ(isr_ring_push(&ring, 4, 1, 0), ISR_RING_WAKE);
+    // Consumer đọc một phần: vẫn còn sự kiện chưa xử lý nên không cần đánh thức
+    CHECK_EQ(isr_ring_push(&ring, 5, 1, 0), ISR_RING_QUEUED);
+    CHECK_EQ(isr_ring_pop(&ring, &ev), 1);
+    CHECK_EQ(isr_ring_push(&ring, 6, 1, 0), ISR_RING_QUEUED);
+}
+
+static void test_overflow_counts_and_keeps_oldest(void)
+{
+    isr_event_t ev;
+    isr_ring_init(&ring);
+    for (uint32_t i = 0; i < ISR_RING_SIZE; i++) {
+        CHECK(isr_ring_push(&ring, i, 1, 0) != ISR_RING_DROPPED);
+    }
+    CHECK_EQ(isr_ring_push(&ring, 999, 1, 0), ISR_RING_DROPPED);
+    CHECK_EQ(isr_ring_push(&ring, 998, 1, 0), ISR_RING_DROPPED);
+    CHECK_EQ(isr_ring_overflows(&ring), 2);
+    for (uint32_t i = 0; i < ISR_RING_SIZE; i++) {
+        CHECK_EQ(isr_ring_pop(&ring, &ev), 1);
+        CHECK_EQ(ev.ccount, i);
+    }
+    CHECK_EQ(isr_ring_pop(&ring, &ev), 0);
+    CHECK_EQ(isr_ring_overflows(&ring), 2);
+}
+
+static void test_index_wraparound(void)
+{
+    isr_event_t ev;
+    isr_ring_init(&ring);
+    ring.head = ring.tail = UINT32_MAX - 3;
+    for (uint32_t i = 0; i < ISR_RING_SIZE; i++) {
+        CHECK(isr_ring_push(&ring, i, 1, 0) != ISR_RING_DROPPED);
+    }
+    CHECK_EQ(isr_ring_push(&ring, 0, 1, 0), ISR_RING_DROPPED);
+    for (uint32_t i = 0; i < ISR_RING_SIZE; i++) {
+        CHECK_EQ(isr_ring_pop(&ring, &ev), 1);
+        CHECK_EQ(ev.ccount, i);
+    }
+    CHECK_EQ(isr_ring_pop(&ring, &ev), 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_empty_ring);
+    RUN_TEST(test_fifo_order_and_payload);
+    RUN_TEST(test_wake_only_when_consumer_drained);
+    RUN_TEST(test_overflow_counts_and_keeps_oldest);
+    RUN_TEST(test_index_wraparound);
+    return TEST_RESULT();
+}
@@ -0,0 +1,335 @@
+#include <stdint.h>
+
+#include "led_hwblink.h"
+#include "test_common.h"
+
+// Thời gian mô phỏng (tick FRC1) và lịch sử cạnh của từng pin
+static uint64_t now_ticks;
+static uint64_t last_edge[16];
+static uint32_t edges[16];
+static uint32_t period_errors;
+static uint32_t expected_period[16];
+
+// Mẫu lặp mãi đang chạy trên pin: bước hiện tại và thời điểm cạnh tiếp theo
+static const led_pattern_t *expected_pattern[16];
+static uint32_t expected_step[16];
+static uint64_t expected_edge[16];
+
+// Tiến tới bước kế tiếp có mức khác mức hiện tại
+static void expect_next_edge(int pin)
+{
+    const led_pattern_t *pattern = expected_pattern[pin];
+    bool level = led_pattern_step_level(pattern->steps[expected_step[pin]]);
+    do {
+        uint32_t ms = led_pattern_step_ms(pattern->steps[expected_step[pin]]);
+        expected_edge[pin] += (uint64_t)ms * HWBLINK_TICKS_PER_SEC / 1000;
+        expected_step[pin] = (expected_step[pin] + 1) % pattern->count;
+    } while (led_pattern_step_level(pattern->steps[expected_step[pin]]) == level);
+}
+
+static void record_edges(uint32_t before)
+{
+    uint32_t changed = before ^ hwblink_mock_regs.out;
+    for (int pin = 0; pin < 16; pin++) {
+        if (changed & (1u << pin)) {
+            if (edges[pin] > 0 && expected_period[pin] &&
+                now_ticks - last_edge[pin] != expected_period[pin]) {
+                period_errors++;
+            }
+            if (edges[pin] > 0 && expected_pattern[pin] != NULL) {
+                if (now_ticks != expected_edge[pin]) {
+                    period_errors++;
+                }
+                expect_next_edge(pin);
+            }
+            last_edge[pin] = now_ticks;
+            edges[pin]++;
+        }
+    }
+}
+
+// Cho FRC1 đếm xuống trong @ticks tick, gọi ISR mỗi khi về 0
+static void mock_run(uint64_t ticks)
+{
+    while (ticks > 0) {
+        if (!hwblink_mock_regs.running || !hwblink_mock_regs.int_enabled) {
+            now_ticks += ticks;
+            return;
+        }
+        if (ticks < hwblink_mock_regs.count) {
+            hwblink_mock_regs.count -= ticks;
+            now_ticks += ticks;
+            return;
+        }
+        ticks -= hwblink_mock_regs.count;
+        now_ticks += hwblink_mock_regs.count;
+        hwblink_mock_regs.count = 0;
+        uint32_t before = hwblink_mock_regs.out;
+        led_hwblink_interrupt_handler(NULL);
+        record_edges(before);
+    }
+}
+
+static void reset(void)
+{
+    led_hwblink_init();
+    now_ticks = 0;
+    period_errors = 0;
+    for (int i = 0; i < 16; i++) {
+        last_edge[i] = 0;
+        edges[i] = 0;
+        expected_period[i] = 0;
+        expected_pattern[i] = NULL;
+    }
+}
+
+static void start(uint8_t pin, uint32_t interval_ms)
+{
+    uint32_t before = hwblink_mock_regs.out;
+    CHECK(led_hwblink_start(pin, interval_ms));
+    expected_period[pin] = hwblink_ms_to_ticks(interval_ms);
+    record_edges(before);
+}
+
+static void start_pattern(uint8_t pin, const led_pattern_t *pattern)
+{
+    uint32_t before = hwblink_mock_regs.out;
+    CHECK(led_hwblink_start_pattern(pin, pattern));
+    expected_period[pin] = 0;
+    expected_pattern[pin] = NULL;
+    record_edges(before);
+    if (pattern->repeat == 0) {
+        expected_pattern[pin] = pattern;
+        expected_step[pin] = 0;
+        expected_edge[pin] = now_ticks;
+        expect_next_edge(pin);
+    }
+}
+
+static void test_ms_to_ticks(void)
+{
+    CHECK_EQ(hwblink_ms_to_ticks(0), 1);
+    CHECK_EQ(hwblink_ms_to_ticks(1), 312);
+    CHECK_EQ(hwblink_ms_to_ticks(200), 62500);
+    CHECK_EQ(hwblink_ms_to_ticks(500), 156250);
+    CHECK_EQ(hwblink_ms_to_ticks(60000), HWBLINK_MAX_LOAD);
+}
+
+static void test_single_channel_schedule(void)
+{
+    reset();
+    CHECK(!hwblink_mock_regs.running);
+    start(4, 200);
+    // LED bật ngay, timer được nạp đúng nửa chu kỳ nhấp nháy
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+    CHECK(hwblink_mock_regs.running);
+    CHECK_EQ(hwblink_mock_regs.load, 62500);
+
+    mock_run(62499);
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+    mock_run(1);
+    CHECK(!(hwblink_mock_regs.out & (1 << 4)));
+    mock_run(62500);
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+
+    hwblink_stats_t stats;
+    led_hwblink_get_stats(&stats);
+    CHECK_EQ(stats.interrupts, 2);
+    CHECK_EQ(stats.toggles, 2);
+}
+
+static void test_multiple_channels_exact_periods(void)
+{
+    reset();
+    start(2, 500);   // LED_BLUE
+    start(4, 200);   // LED_FIRE
+    start(5, 250);   // LED_SIM
+    start(14, 1000); // LED_FAULT
+
+    // Mô phỏng 1 giờ
+    mock_run(3600ull * HWBLINK_TICKS_PER_SEC);
+    CHECK_EQ(period_errors, 0);
+    // Mỗi pin: 1 cạnh khi bắt đầu + 3600 s / interval
+    CHECK_EQ(edges[2], 1 + 3600 * 1000 / 500);
+    CHECK_EQ(edges[4], 1 + 3600 * 1000 / 200);
+    CHECK_EQ(edges[5], 1 + 3600 * 1000 / 250);
+    CHECK_EQ(edges[14], 1 + 3600 * 1000 / 1000);
+
+    // Mỗi ngắt phải đảo ít nhất một LED: không có ngắt thừa
+    hwblink_stats_t stats;
+    led_hwblink_get_stats(&stats);
+    CHECK(stats.interrupts <= stats.toggles);
+    CHECK_EQ(stats.toggles, edges[2] + edges[4] + edges[5] + edges[14] - 4);
+}
+
+static void test_start_mid_interval_keeps_other_phase(void)
+{
+    reset();
+    start(4, 200);
+    mock_run(20000);
+    // Thêm kênh giữa chu kỳ: kênh cũ vẫn đảo đúng thời điểm
+    start(5, 100);
+    CHECK_EQ(hwblink_mock_regs.load, 31250);
+    mock_run(31250);
+    CHECK_EQ(edges[5], 2);
+    mock_run(62500 - 20000 - 31250);
+    CHECK_EQ(edges[4], 2);
+    CHECK_EQ(last_edge[4], 62500);
+    CHECK_EQ(period_errors, 0);
+}
+
+static void test_stop_leaves_level_and_stops_timer(void)
+{
+    reset();
+    start(4, 200);
+    start(5, 300);
+    mock_run(70000);
+    led_hwblink_stop(4, true);
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+    CHECK(hwblink_mock_regs.running);
+    led_hwblink_stop(5, false);
+    CHECK(!(hwblink_mock_regs.out & (1 << 5)));
+    CHECK(!hwblink_mock_regs.running);
+
+    // Không còn kênh nào: không có ngắt
+    hwblink_stats_t before, after;
+    led_hwblink_get_stats(&before);
+    mock_run(10ull * HWBLINK_TICKS_PER_SEC);
+    led_hwblink_get_stats(&after);
+    CHECK_EQ(after.interrupts, before.interrupts);
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+}
+
+static void test_long_interval_uses_capped_loads(void)
+{
+    hwblink_sched_t sched;
+    uint32_t set, clear;
+    hwblink_sched_init(&sched);
+    CHECK(hwblink_sched_start(&sched, 2, HWBLINK_MAX_LOAD, &set));
+    CHECK_EQ(set, 1 << 2);
+    CHECK_EQ(hwblink_sched_next_load(&sched), HWBLINK_MAX_LOAD);
+    CHECK_EQ(hwblink_sched_advance(&sched, HWBLINK_MAX_LOAD - 1, &set, &clear), 0);
+    CHECK_EQ(hwblink_sched_next_load(&sched), 1);
+    CHECK_EQ(hwblink_sched_advance(&sched, 1, &set, &clear), 1);
+    CHECK_EQ(clear, 1 << 2);
+    CHECK(!hwblink_sched_start(&sched, 16, 10, &set));
+}
+
+static void test_channel_limit(void)
+{
+    hwblink_sched_t sched;
+    uint32_t set;
+    hwblink_sched_init(&sched);
+    for (int pin = 0; pin < HWBLINK_MAX_CHANNELS; pin++) {
+        CHECK(hwblink_sched_start(&sched, pin, 100, &set));
+    }
+    CHECK(!hwblink_sched_start(&sched, HWBLINK_MAX_CHANNELS, 100, &set));
+    // Đổi chu kỳ của kênh đã có vẫn được phép
+    CHECK(hwblink_sched_start(&sched, 0, 50, &set));
+    CHECK(hwblink_sched_stop(&sched, 3));
+    CHECK(!hwblink_sched_stop(&sched, 3));
+    CHECK(hwblink_sched_start(&sched, HWBLINK_MAX_CHANNELS, 100, &set));
+}
+
+static void test_patterns_exact_timing(void)
+{
+    const led_pattern_t *temporal3 = led_pattern_get(LED_PATTERN_TEMPORAL3);
+    reset();
+    start(2, 500);
+    start_pattern(4, temporal3);
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+    start_pattern(5, led_pattern_get(LED_PATTERN_SOS));
+    // Nạp theo deadline sớm nhất: chấm 200 ms đầu tiên của SOS
+    CHECK_EQ(hwblink_mock_regs.load, 62500);
+    mock_run(HWBLINK_TICKS_PER_SEC + 12345);
+    // Cùng một bảng, lệch pha với pin 4
+    start_pattern(14, temporal3);
+    start_pattern(12, led_pattern_get(LED_PATTERN_FAULT_CHIRP));
+
+    // Mô phỏng 1 giờ: mọi cạnh đúng tới từng tick FRC1
+    mock_run(3599ull * HWBLINK_TICKS_PER_SEC - 12345);
+    CHECK_EQ(period_errors, 0);
+    // Temporal-3: 6 cạnh mỗi chu kỳ 4 s, cạnh đầu của chu kỳ 901 rơi đúng lúc 1 giờ
+    CHECK_EQ(edges[4], 1 + 3600 / 4 * 6);
+    CHECK_EQ(edges[2], 1 + 3600 * 1000 / 500);
+    CHECK(edges[5] >= 3600 * 1000 / 6800 * 18);
+    CHECK(edges[14] >= 899 * 6);
+    // Chớp lỗi: 2 cạnh mỗi 10 s
+    CHECK(edges[12] >= 359 * 2);
+
+    // Mỗi ngắt đổi mức ít nhất một pin: các bước không tạo ngắt thừa
+    hwblink_stats_t stats;
+    led_hwblink_get_stats(&stats);
+    CHECK(stats.interrupts <= stats.toggles);
+}
+
+static void test_finite_pattern_frees_channel(void)
+{
+    static const uint32_t off_on_steps[] = { LED_STEP(0, 50), LED_STEP(1, 50) };
+    led_pattern_t twice = { off_on_steps, 2, 2 };
+
+    reset();
+    // Kênh mẫu đứng trước kênh nhấp nháy: khi được giải phóng, kênh nhấp
+    // nháy chuyển vào chỗ của nó mà không lệch pha
+    start_pattern(4, &twice);
+    start(2, 30);
+    CHECK(!(hwblink_mock_regs.out & (1 << 4)));
+    // Bước đầu tắt: không có cạnh khi bắt đầu
+    CHECK_EQ(edges[4], 0);
+    mock_run(hwblink_ms_to_ticks(50));
+    CHECK(hwblink_mock_regs.out & (1 << 4));
+    mock_run(hwblink_ms_to_ticks(50));
+    CHECK(!(hwblink_mock_regs.out & (1 << 4)));
+    mock_run(hwblink_ms_to_ticks(100));
+    CHECK(!(hwblink_mock_regs.out & (1 << 4)));
+    CHECK_EQ(edges[4], 4);
+    mock_run(10ull * HWBLINK_TICKS_PER_SEC);
+    CHECK_EQ(edges[4], 4);
+    CHECK_EQ(period_errors, 0);
+    CHECK_EQ(edges[2], 1 + 10200 / 30);
+
+    // Không còn kênh nào: timer dừng
+    led_hwblink_stop(2, false);
+    CHECK(!hwblink_mock_regs.running);
+    start_pattern(4, &twice);
+    CHECK(hwblink_mock_regs.running);
+    mock_run(hwblink_ms_to_ticks(200));
+    CHECK(!hwblink_mock_regs.running);
+    CHECK_EQ(hwblink_mock_regs.out, 0);
+}
+
+static void test_pattern_replaced_by_blink(void)
+{
+    hwblink_sched_t sched;
+    uint32_t set, clear;
+    hwblink_sched_init(&sched);
+
+    CHECK(!hwblink_sched_start_pattern(&sched, 16, led_pattern_get(LED_PATTERN_SOS), &set, &clear));
+    CHECK(hwblink_sched_start_pattern(&sched, 4, led_pattern_get(LED_PATTERN_SOS), &set, &clear));
+    CHECK_EQ(set, 1 << 4);
+    CHECK_EQ(clear, 0);
+    CHECK_EQ(hwblink_sched_next_load(&sched), hwblink_ms_to_ticks(200));
+    // Cùng pin, cùng kênh: chuyển sang nhấp nháy thường
+    CHECK(hwblink_sched_start(&sched, 4, 1000, &set));
+    CHECK_EQ(sched.count, 1);
+    CHECK(sched.channels[0].cursor.pattern == NULL);
+    for (int i = 0; i < 10; i++) {
+        CHECK_EQ(hwblink_sched_advance(&sched, 1000, &set, &clear), 1);
+    }
+    CHECK_EQ(sched.count, 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_ms_to_ticks);
+    RUN_TEST(test_single_channel_schedule);
+    RUN_TEST(test_multiple_channels_exact_periods);
+    RUN_TEST(test_start_mid_interval_keeps_other_phase);
+    RUN_TEST(test_stop_leaves_level_and_stops_timer);
+    RUN_TEST(test_long_interval_uses_capped_loads);
+    RUN_TEST(test_channel_limit);
+    RUN_TEST(test_patterns_exact_timing);
+    RUN_TEST(test_finite_pattern_frees_channel);
+    RUN_TEST(test_pattern_replaced_by_blink);
+    return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_pattern.h"
+#include "test_common.h"
+
+static const uint32_t blink_steps[] = { LED_STEP(1, 50), LED_STEP(0, 50) };
+
+// Mọi mẫu có sẵn phải chạy được trên cả ISR FRC1 lẫn task LED
+static void test_builtin_patterns_valid(void)
+{
+    for (uint32_t id = 0; id < LED_PATTERN_COUNT; id++) {
+        const led_pattern_t *pattern = led_pattern_get(id);
+        CHECK(pattern != NULL);
+        CHECK_EQ(led_pattern_validate(pattern), LED_PATTERN_OK);
+        // Bắt đầu bằng một lần sáng và luân phiên mức: mỗi bước là một cạnh
+        for (uint32_t i = 0; i < pattern->count; i++) {
+            CHECK_EQ(led_pattern_step_level(pattern->steps[i]), i % 2 == 0);
+        }
+        CHECK_EQ(pattern->count % 2, 0);
+    }
+    CHECK(led_pattern_get(LED_PATTERN_COUNT) == NULL);
+    CHECK(led_pattern_get(UINT32_MAX) == NULL);
+
+    CHECK_EQ(led_pattern_cycle_ms(led_pattern_get(LED_PATTERN_TEMPORAL3)), 4000);
+    CHECK_EQ(led_pattern_cycle_ms(led_pattern_get(LED_PATTERN_SOS)), 6800);
+    CHECK_EQ(led_pattern_cycle_ms(led_pattern_get(LED_PATTERN_FAULT_CHIRP)), 10000);
+}
+
+static void test_validator_rejects(void)
+{
+    static const uint32_t zero_step[] = { LED_STEP(1, 100), LED_STEP(0, 0) };
+    static const uint32_t long_step[] = { LED_STEP(1, LED_PATTERN_STEP_MAX_MS + 1) };
+    static const uint32_t max_step[] = { LED_STEP(1, LED_PATTERN_STEP_MAX_MS) };
+    static uint32_t many_steps[LED_PATTERN_MAX_STEPS + 1];
+
+    for (int i = 0; i <= LED_PATTERN_MAX_STEPS; i++) {
+        many_steps[i] = LED_STEP(i % 2 == 0, 10);
+    }
+    led_pattern_t pattern = { NULL, 2, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_ERR_EMPTY);
+    pattern = (led_pattern_t){ blink_steps, 0, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_ERR_EMPTY);
+    pattern = (led_pattern_t){ zero_step, 2, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_ERR_ZERO_STEP);
+    pattern = (led_pattern_t){ long_step, 1, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_ERR_STEP_TOO_LONG);
+    pattern = (led_pattern_t){ max_step, 1, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_OK);
+    pattern = (led_pattern_t){ many_steps, LED_PATTERN_MAX_STEPS + 1, 0 };
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_ERR_TOO_MANY);
+    pattern.count = LED_PATTERN_MAX_STEPS;
+    CHECK_EQ(led_pattern_validate(&pattern), LED_PATTERN_OK);
+}
+
+static void test_step_encoding(void)
+{
+    CHECK_EQ(LED_STEP(1, 500), LED_PATTERN_LEVEL | 500);
+    CHECK_EQ(LED_STEP(0, 500), 500);
+    CHECK(led_pattern_step_level(LED_STEP(1, 1)));
+    CHECK(!led_pattern_step_level(LED_STEP(0, 1)));
+    CHECK_EQ(led_pattern_step_ms(LED_STEP(1, LED_PATTERN_STEP_MAX_MS)), LED_PATTERN_STEP_MAX_MS);
+}
+
+static void test_cursor_repeat(void)
+{
+    led_pattern_t finite = { blink_steps, 2, 3 };
+    led_pattern_cursor_t cursor;
+    uint32_t step;
+
+    CHECK_EQ(led_pattern_cursor_start(&cursor, &finite), LED_STEP(1, 50));
+    // 3 chu kỳ, mỗi chu kỳ 2 bước: còn 5 bước sau bước đầu
+    for (int i = 1; i < 6; i++) {
+        CHECK(led_pattern_cursor_next(&cursor, &step));
+        CHECK_EQ(step, blink_steps[i % 2]);
+    }
+    CHECK(!led_pattern_cursor_next(&cursor, &step));
+    CHECK(cursor.pattern == NULL);
+
+    // Mẫu lặp mãi không bao giờ kết thúc
+    led_pattern_t forever = { blink_steps, 2, 0 };
+    led_pattern_cursor_start(&cursor, &forever);
+    for (int i = 0; i < 100000; i++) {
+        CHECK(led_pattern_cursor_next(&cursor, &step));
+    }
+    CHECK(cursor.pattern == &forever);
+}
+
+// Hai LED dùng chung một bảng nhưng có vị trí riêng
+static void test_shared_table_independent_cursors(void)
+{
+    const led_pattern_t *sos = led_pattern_get(LED_PATTERN_SOS);
+    led_pattern_cursor_t a, b;
+    uint32_t step_a, step_b;
+
+    led_pattern_cursor_start(&a, sos);
+    for (int i = 0; i < 7; i++) {
+        led_pattern_cursor_next(&a, &step_a);
+    }
+    led_pattern_cursor_start(&b, sos);
+    CHECK_EQ(a.step, 7);
+    CHECK_EQ(b.step, 0);
+    for (uint32_t i = 1; i < sos->count * 2; i++) {
+        CHECK(led_pattern_cursor_next(&a, &step_a));
+        CHECK(led_pattern_cursor_next(&b, &step_b));
+        CHECK_EQ(step_a, sos->steps[(i + 7) % sos->count]);
+        CHECK_EQ(step_b, sos->steps[i % sos->count]);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_builtin_patterns_valid);
+    RUN_TEST(test_validator_rejects);
+    RUN_TEST(test_step_encoding);
+    RUN_TEST(test_cursor_repeat);
+    RUN_TEST(test_shared_table_independent_cursors);
+    return TEST_RESULT();
+}
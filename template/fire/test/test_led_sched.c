@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "led_sched.h"
+#include "test_common.h"
+
+static led_sched_t sched;
+
+// Tham chiếu brute-force: deadline của từng id, hoặc -1 nếu không có
+static int64_t reference[LED_SCHED_MAX_ENTRIES];
+
+static void check_against_reference(uint32_t base)
+{
+    int64_t best = -1;
+    int count = 0;
+    for (int i = 0; i < LED_SCHED_MAX_ENTRIES; i++) {
+        if (reference[i] >= 0) {
+            count++;
+            if (best < 0 || (int32_t)((uint32_t)reference[i] - (uint32_t)best) < 0) {
+                best = reference[i];
+            }
+        }
+    }
+    uint8_t id;
+    uint32_t deadline;
+    CHECK_EQ(sched.count, count);
+    if (count == 0) {
+        CHECK(!led_sched_peek(&sched, &id, &deadline));
+    } else {
+        CHECK(led_sched_peek(&sched, &id, &deadline));
+        CHECK_EQ(deadline, (uint32_t)best);
+    }
+}
+
+static void test_random_operations_match_reference(void)
+{
+    srand(1234);
+    led_sched_init(&sched);
+    for (int i = 0; i < LED_SCHED_MAX_ENTRIES; i++) {
+        reference[i] = -1;
+    }
+    // Gần mốc tràn để kiểm tra so sánh tick an toàn
+    uint32_t base = UINT32_MAX - 5000;
+    for (int step = 0; step < 100000; step++) {
+        uint8_t id = rand() % LED_SCHED_MAX_ENTRIES;
+        if (rand() % 3 == 0) {
+            led_sched_remove(&sched, id);
+            reference[id] = -1;
+        } else {
+            uint32_t deadline = base + rand() % 10000;
+            led_sched_set(&sched, id, deadline);
+            reference[id] = deadline;
+        }
+        check_against_reference(base);
+    }
+}
+
+static void test_wait_ticks(void)
+{
+    uint32_t wait;
+    led_sched_init(&sched);
+    CHECK(!led_sched_wait_ticks(&sched, 100, &wait));
+    led_sched_set(&sched, 2, 150);
+    led_sched_set(&sched, 1, 120);
+    CHECK(led_sched_wait_ticks(&sched, 100, &wait));
+    CHECK_EQ(wait, 20);
+    CHECK(led_sched_wait_ticks(&sched, 130, &wait));
+    CHECK_EQ(wait, 0);
+
+    uint8_t id;
+    uint32_t deadline;
+    CHECK(!led_sched_pop_due(&sched, 119, &id, &deadline));
+    CHECK(led_sched_pop_due(&sched, 130, &id, &deadline));
+    CHECK_EQ(id, 1);
+    CHECK_EQ(deadline, 120);
+    CHECK(!led_sched_pop_due(&sched, 130, &id, &deadline));
+    CHECK(led_sched_pop_due(&sched, 150, &id, &deadline));
+    CHECK_EQ(id, 2);
+}
+
+static void test_next_deadline_no_drift(void)
+{
+    // Trễ một chút: vẫn bám theo lịch gốc
+    CHECK_EQ(led_sched_next_deadline(100, 20, 103), 120);
+    // Trễ hơn một chu kỳ: lịch bắt đầu lại từ thời điểm hiện tại
+    CHECK_EQ(led_sched_next_deadline(100, 20, 125), 145);
+    CHECK_EQ(led_sched_next_deadline(100, 0, 100), 101);
+    CHECK_EQ(led_sched_next_deadline(UINT32_MAX - 5, 10, UINT32_MAX - 4), 4);
+}
+
+// Mô phỏng nhiều giờ nhấp nháy: task chỉ thức dậy theo deadline sớm nhất,
+// với độ trễ lập lịch ngẫu nhiên, và kiểm tra không có trôi thời gian
+static void test_simulated_hours_of_toggles(void)
+{
+    const uint32_t ticks_per_hour = 3600 * 100; // 10 ms tick
+    const uint32_t hours = 6;
+    const uint32_t periods[4] = {20, 25, 50, 100}; // 200/250/500/1000 ms
+    uint32_t toggles[4] = {0};
+    uint32_t wakeups = 0;
+    led_sched_hist_t hist = {0};
+
+    srand(42);
+    led_sched_init(&sched);
+    uint32_t now = UINT32_MAX - 1000; // tick tràn trong lúc mô phỏng
+    uint32_t start = now;
+    for (int i = 0; i < 4; i++) {
+        led_sched_set(&sched, i, now + periods[i]);
+    }
+
+    while (now - start < hours * ticks_per_hour) {
+        uint32_t wait;
+        CHECK(led_sched_wait_ticks(&sched, now, &wait));
+        // Task thức dậy đúng deadline, đôi khi trễ 1-2 tick vì task khác
+        now += wait + ((rand() % 16) == 0 ? 1 + rand() % 2 : 0);
+        wakeups++;
+
+        uint8_t id;
+        uint32_t deadline;
+        while (led_sched_pop_due(&sched, now, &id, &deadline)) {
+            toggles[id]++;
+            led_sched_hist_record(&hist, now - deadline);
+            led_sched_set(&sched, id, led_sched_next_deadline(deadline, periods[id], now));
+        }
+    }
+
+    uint32_t total = 0;
+    for (int i = 0; i < 4; i++) {
+        uint32_t expected = hours * ticks_per_hour / periods[i];
+        // Không trôi: số lần đảo khớp lịch lý tưởng (sai số 1 chu kỳ)
+        CHECK(toggles[i] + 1 >= expected && toggles[i] <= expected + 1);
+        total += toggles[i];
+    }
+    // Không có polling: số lần thức dậy không vượt quá số lần đảo trạng thái
+    CHECK(wakeups <= total);
+    CHECK_EQ(hist.count, total);
+    CHECK(hist.max <= 2);
+    printf("  %u h simulated: %u toggles, %u wakeups (100 ms polling: %u), max late %u ticks\n",
+           hours, total, wakeups, hours * ticks_per_hour / 10, hist.max);
+}
+
+static void test_histogram_buckets(void)
+{
+    led_sched_hist_t hist = {0};
+    led_sched_hist_record(&hist, 0);
+    led_sched_hist_record(&hist, 1);
+    led_sched_hist_record(&hist, 2);
+    led_sched_hist_record(&hist, 3);
+    led_sched_hist_record(&hist, 4);
+    led_sched_hist_record(&hist, 100000);
+    CHECK_EQ(hist.buckets[0], 1);
+    CHECK_EQ(hist.buckets[1], 1);
+    CHECK_EQ(hist.buckets[2], 2);
+    CHECK_EQ(hist.buckets[3], 1);
+    CHECK_EQ(hist.buckets[LED_SCHED_HIST_BUCKETS - 1], 1);
+    CHECK_EQ(hist.count, 6);
+    CHECK_EQ(hist.max, 100000);
+}
+
+int main(void)
+{
+    RUN_TEST(test_random_operations_match_reference);
+    RUN_TEST(test_wait_ticks);
+    RUN_TEST(test_next_deadline_no_drift);
+    RUN_TEST(test_simulated_hours_of_toggles);
+    RUN_TEST(test_histogram_buckets);
+    return TEST_RESULT();
+}
@@ -0,0 +1,282 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "sim_probe.h"
+#include "test_common.h"
+
+// Chế độ của HTTP server giả lập
+enum {
+    SERVER_KEEPALIVE,  // Answers every request on the same connection
+    SERVER_CLOSE,      // Closes the connection after each response
+    SERVER_GARBAGE,    // Answers with something that is not HTTP
+    SERVER_BUSY        // Answers 503 and keeps the connection
+};
+
+static int server_fd;
+static char server_port[8];
+static volatile int server_mode;
+static volatile int server_stop;
+static volatile uint32_t server_accepts;
+static volatile uint32_t server_requests;
+static char last_request[256];
+
+// Đọc một request (tới dòng trống) từ client; trả về false khi client đóng
+static int read_request(int c)
+{
+    int len = 0;
+    while (len < (int)sizeof(last_request) - 1) {
+        int r = read(c, last_request + len, 1);
+        if (r <= 0) {
+            return 0;
+        }
+        len++;
+        last_request[len] = 0;
+        if (len >= 4 && memcmp(last_request + len - 4, "\r\n\r\n", 4) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *server_thread(void *arg)
+{
+    const char *ok = "HTTP/1.1 200 OK\r\nContent-Length: 321\r\nConnection: keep-alive\r\n\r\n";
+    const char *garbage = "SSH-2.0-OpenSSH\r\n\r\n";
+    const char *busy = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 5\r\n\r\n";
+
+    while (!server_stop) {
+        struct pollfd pfd = { .fd = server_fd, .events = POLLIN };
+        if (poll(&pfd, 1, 20) <= 0) {
+            continue;
+        }
+        int c = accept(server_fd, NULL, NULL);
+        if (c < 0) {
+            continue;
+        }
+        server_accepts++;
+        while (!server_stop) {
+            pfd.fd = c;
+            if (poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            if (!read_request(c)) {
+                break;
+            }
+            server_requests++;
+            const char *resp = server_mode == SERVER_GARBAGE ? garbage : server_mode == SERVER_BUSY ? busy : ok;
+            if (write(c, resp, strlen(resp)) < 0 || server_mode == SERVER_CLOSE || server_mode == SERVER_GARBAGE) {
+                break;
+            }
+        }
+        close(c);
+    }
+    return NULL;
+}
+
+static pthread_t start_server(void)
+{
+    pthread_t thread;
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(addr);
+
+    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    bind(server_fd, (struct sockaddr *)&addr, sizeof(addr));
+    listen(server_fd, 4);
+    getsockname(server_fd, (struct sockaddr *)&addr, &len);
+    snprintf(server_port, sizeof(server_port), "%u", ntohs(addr.sin_port));
+    pthread_create(&thread, NULL, server_thread, NULL);
+    return thread;
+}
+
+static void test_parser_split_input(void)
+{
+    const char *resp = "HTTP/1.1 204 No Content\r\nServer: x\r\n\r\n";
+    sim_probe_parser_t parser;
+    int len = strlen(resp);
+
+    // Dữ liệu tới từng byte một
+    sim_probe_parser_init(&parser);
+    for (int i = 0; i < len - 1; i++) {
+        CHECK_EQ(sim_probe_parser_feed(&parser, resp + i, 1), 0);
+    }
+    CHECK_EQ(sim_probe_parser_feed(&parser, resp + len - 1, 1), 1);
+    CHECK_EQ(parser.status, 204);
+
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, resp, len), 1);
+    CHECK_EQ(parser.status, 204);
+}
+
+static void test_parser_rejects_bad_input(void)
+{
+    sim_probe_parser_t parser;
+
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTX/1.1 200 OK\r\n\r\n", 19), -1);
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 2x0 OK\r\n\r\n", 19), -1);
+    CHECK_EQ(parser.error, SIM_PROBE_ERR_STATUS);
+    // "\r\n\r" rồi ký tự khác là header sai cú pháp
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.0 200 OK\r\nA: b\r\n\rx\r\n\r\n", 29), -1);
+    CHECK_EQ(parser.error, SIM_PROBE_ERR_STATUS);
+}
+
+static void test_parser_limits(void)
+{
+    sim_probe_parser_t parser;
+
+    // Body sau header của phản hồi HEAD, cùng lần đọc hoặc lần sau
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 200 OK\r\n\r\nbody", 23), -1);
+    CHECK_EQ(parser.error, SIM_PROBE_ERR_OVERSIZE);
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n", 38), 1);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "hello", 5), -1);
+    CHECK_EQ(parser.error, SIM_PROBE_ERR_OVERSIZE);
+
+    // Header vượt SIM_PROBE_HEADER_MAX dù chưa sai cú pháp
+    char line[64];
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 200 OK\r\n", 17), 0);
+    int result = 0;
+    for (int i = 0; i < SIM_PROBE_HEADER_MAX / 8 && result == 0; i++) {
+        int len = snprintf(line, sizeof(line), "X-%04d: 123\r\n", i);
+        result = sim_probe_parser_feed(&parser, line, len);
+    }
+    CHECK_EQ(result, -1);
+    CHECK_EQ(parser.error, SIM_PROBE_ERR_OVERSIZE);
+    CHECK_EQ(parser.received, SIM_PROBE_HEADER_MAX);
+}
+
+static void test_parser_keep_alive(void)
+{
+    sim_probe_parser_t parser;
+
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 200 OK\r\n\r\n", 19), 1);
+    CHECK(parser.keep_alive);
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n", 38), 1);
+    CHECK(!parser.keep_alive);
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.0 200 OK\r\n\r\n", 19), 1);
+    CHECK(!parser.keep_alive);
+    sim_probe_parser_init(&parser);
+    CHECK_EQ(sim_probe_parser_feed(&parser, "HTTP/1.0 503 Busy\r\nConnection: keep-alive\r\n\r\n", 45), 1);
+    CHECK(parser.keep_alive);
+    CHECK_EQ(parser.status, 503);
+}
+
+static void test_keepalive_reuses_connection_and_dns(void)
+{
+    sim_probe_t probe;
+    server_mode = SERVER_KEEPALIVE;
+    server_accepts = 0;
+    server_requests = 0;
+
+    CHECK(sim_probe_init(&probe, "127.0.0.1", server_port, "/get"));
+    for (int i = 0; i < 10; i++) {
+        CHECK_EQ(sim_probe_run(&probe), SIM_PROBE_OK);
+        CHECK_EQ(probe.last_status, 200);
+    }
+    CHECK_EQ(server_requests, 10);
+    CHECK_EQ(server_accepts, 1);
+    CHECK_EQ(probe.connects, 1);
+    CHECK_EQ(probe.dns_lookups, 1);
+    CHECK_EQ(probe.failures, 0);
+    CHECK(probe.min_rtt_us <= probe.max_rtt_us);
+    CHECK(strncmp(last_request, "HEAD /get HTTP/1.1\r\n", 20) == 0);
+    printf("  10 probes: rtt min %u us, max %u us\n", probe.min_rtt_us, probe.max_rtt_us);
+    sim_probe_close(&probe);
+}
+
+static void test_reconnects_when_server_closes(void)
+{
+    sim_probe_t probe;
+    server_mode = SERVER_CLOSE;
+    server_accepts = 0;
+    server_requests = 0;
+
+    CHECK(sim_probe_init(&probe, "127.0.0.1", server_port, "/get"));
+    for (int i = 0; i < 3; i++) {
+        // Đợi server đóng kết nối cũ
+        usleep(50000);
+        CHECK_EQ(sim_probe_run(&probe), SIM_PROBE_OK);
+    }
+    CHECK_EQ(server_requests, 3);
+    CHECK_EQ(probe.failures, 0);
+    // Địa chỉ vẫn lấy từ cache khi mở lại kết nối
+    CHECK_EQ(probe.dns_lookups, 1);
+    CHECK(probe.connects >= 3);
+    sim_probe_close(&probe);
+}
+
+static void test_garbage_and_refused(void)
+{
+    sim_probe_t probe;
+    server_mode = SERVER_GARBAGE;
+
+    CHECK(sim_probe_init(&probe, "127.0.0.1", server_port, "/get"));
+    CHECK_EQ(sim_probe_run(&probe), SIM_PROBE_ERR_STATUS);
+    CHECK_EQ(probe.failures, 1);
+    CHECK_EQ(probe.sock, -1);
+
+    // Cổng không có server: connect thất bại và cache DNS bị xóa
+    CHECK(sim_probe_init(&probe, "127.0.0.1", "1", "/get"));
+    CHECK_EQ(sim_probe_run(&probe), SIM_PROBE_ERR_CONNECT);
+    CHECK(!probe.addr_valid);
+}
+
+static void test_server_error_keeps_connection(void)
+{
+    sim_probe_t probe;
+    server_mode = SERVER_BUSY;
+    server_accepts = 0;
+
+    CHECK(sim_probe_init(&probe, "127.0.0.1", server_port, "/get"));
+    for (int i = 0; i < 2; i++) {
+        CHECK_EQ(sim_probe_run(&probe), SIM_PROBE_ERR_HTTP);
+        CHECK_EQ(probe.last_status, 503);
+    }
+    CHECK_EQ(server_accepts, 1);
+    CHECK(probe.sock >= 0);
+    CHECK_EQ(probe.failures, 2);
+    CHECK_EQ(probe.errors[SIM_PROBE_ERR_HTTP], 2);
+    sim_probe_close(&probe);
+}
+
+static void test_request_too_long(void)
+{
+    sim_probe_t probe;
+    char path[SIM_PROBE_REQUEST_MAX];
+    memset(path, 'a', sizeof(path) - 1);
+    path[sizeof(path) - 1] = 0;
+    CHECK(!sim_probe_init(&probe, "127.0.0.1", "80", path));
+}
+
+int main(void)
+{
+    pthread_t thread = start_server();
+
+    RUN_TEST(test_parser_split_input);
+    RUN_TEST(test_parser_rejects_bad_input);
+    RUN_TEST(test_parser_limits);
+    RUN_TEST(test_parser_keep_alive);
+    RUN_TEST(test_keepalive_reuses_connection_and_dns);
+    RUN_TEST(test_reconnects_when_server_closes);
+    RUN_TEST(test_garbage_and_refused);
+    RUN_TEST(test_server_error_keeps_connection);
+    RUN_TEST(test_request_too_long);
+
+    server_stop = 1;
+    pthread_join(thread, NULL);
+    close(server_fd);
+    return TEST_RESULT();
+}
@@ -0,0 +1,306 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim_rawprobe.h"
+#include "test_common.h"
+
+// Giả lập pcb của lwIP: lưu callback để test tự kích hoạt sự kiện
+struct tcp_pcb {
+    void *arg;
+    tcp_recv_fn recv;
+    tcp_err_fn err;
+    tcp_poll_fn poll;
+    tcp_connected_fn connected;
+    int closed;
+    int aborted;
+    char sent[256];
+    int sent_len;
+};
+
+static struct tcp_pcb pcbs[8];
+static int pcb_count;
+static int recved_bytes;
+
+// Giả lập DNS
+static err_t dns_result;
+static dns_found_callback dns_cb;
+static void *dns_arg;
+static int dns_calls;
+
+// Giả lập timer của lwIP: một timer chờ
+static sys_timeout_handler timeout_handler;
+static void *timeout_arg;
+static uint32_t timeout_ms;
+
+static sim_rawprobe_report_t last_report;
+static int reports;
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type)
+{
+    struct tcp_pcb *pcb = &pcbs[pcb_count++];
+    memset(pcb, 0, sizeof(*pcb));
+    return pcb;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg) { pcb->arg = arg; }
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv) { pcb->recv = recv; }
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err) { pcb->err = err; }
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) { pcb->poll = poll; }
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, tcp_connected_fn connected)
+{
+    pcb->connected = connected;
+    return ERR_OK;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags)
+{
+    memcpy(pcb->sent + pcb->sent_len, dataptr, len);
+    pcb->sent_len += len;
+    return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb) { return ERR_OK; }
+void tcp_recved(struct tcp_pcb *pcb, u16_t len) { recved_bytes += len; }
+err_t tcp_close(struct tcp_pcb *pcb) { pcb->closed = 1; return ERR_OK; }
+void tcp_abort(struct tcp_pcb *pcb) { pcb->aborted = 1; }
+u8_t pbuf_free(struct pbuf *p) { return 1; }
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg)
+{
+    dns_calls++;
+    if (dns_result == ERR_OK) {
+        addr->addr = 0x0100007f;
+    }
+    dns_cb = found;
+    dns_arg = callback_arg;
+    return dns_result;
+}
+
+void sys_timeout(uint32_t msecs, sys_timeout_handler handler, void *arg)
+{
+    timeout_handler = handler;
+    timeout_arg = arg;
+    timeout_ms = msecs;
+}
+
+void sys_untimeout(sys_timeout_handler handler, void *arg)
+{
+    if (timeout_handler == handler && timeout_arg == arg) {
+        timeout_handler = NULL;
+    }
+}
+
+static void on_done(const sim_rawprobe_report_t *report, void *arg)
+{
+    last_report = *report;
+    reports++;
+}
+
+static sim_rawprobe_t probe;
+
+static void reset(err_t dns)
+{
+    pcb_count = 0;
+    reports = 0;
+    recved_bytes = 0;
+    dns_calls = 0;
+    dns_result = dns;
+    timeout_handler = NULL;
+    CHECK(sim_rawprobe_init(&probe, "example.com", 80, "/get", 100, on_done, NULL));
+}
+
+// Gửi dữ liệu tới probe dưới dạng chuỗi pbuf hai phần
+static err_t deliver(struct tcp_pcb *pcb, const char *data)
+{
+    int len = strlen(data);
+    int half = len / 2;
+    struct pbuf second = { NULL, (void *)(data + half), len - half, len - half };
+    struct pbuf first = { &second, (void *)data, len, half };
+    return pcb->recv(pcb->arg, pcb, &first, ERR_OK);
+}
+
+static void test_cached_dns_and_keepalive(void)
+{
+    reset(ERR_OK);
+    CHECK(sim_rawprobe_start(&probe));
+    CHECK_EQ(pcb_count, 1);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_CONNECTING);
+    // Không thể bắt đầu probe thứ hai khi đang chạy
+    CHECK(!sim_rawprobe_start(&probe));
+
+    struct tcp_pcb *pcb = &pcbs[0];
+    CHECK_EQ(pcb->connected(pcb->arg, pcb, ERR_OK), ERR_OK);
+    CHECK(strncmp(pcb->sent, "HEAD /get HTTP/1.1\r\nHost: example.com\r\n", 39) == 0);
+    usleep(1000);
+    CHECK_EQ(deliver(pcb, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n"), ERR_OK);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(last_report.result, SIM_PROBE_OK);
+    CHECK_EQ(last_report.status, 200);
+    CHECK(!last_report.reused);
+    CHECK_EQ(last_report.dns_us, 0);
+    CHECK(last_report.first_byte_us >= 1000);
+    CHECK(last_report.total_us >= last_report.first_byte_us);
+    CHECK_EQ(recved_bytes, 38);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_READY);
+
+    // Probe tiếp theo dùng lại kết nối, không DNS, không connect
+    pcb->sent_len = 0;
+    CHECK(sim_rawprobe_start(&probe));
+    CHECK_EQ(dns_calls, 1);
+    CHECK_EQ(pcb_count, 1);
+    CHECK_EQ(pcb->sent_len, probe.request_len);
+    deliver(pcb, "HTTP/1.1 503 Busy\r\n\r\n");
+    CHECK_EQ(reports, 2);
+    CHECK(last_report.reused);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_HTTP);
+    CHECK_EQ(last_report.status, 503);
+    CHECK_EQ(last_report.connect_us, 0);
+    // Lỗi phía server nhưng phản hồi đầy đủ: kết nối vẫn giữ
+    CHECK(!pcb->closed && !pcb->aborted);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_READY);
+}
+
+static void test_async_dns_and_failure(void)
+{
+    reset(ERR_INPROGRESS);
+    CHECK(sim_rawprobe_start(&probe));
+    CHECK_EQ(probe.state, SIM_RAWPROBE_DNS);
+    CHECK_EQ(pcb_count, 0);
+    usleep(500);
+    dns_cb("example.com", NULL, dns_arg);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_DNS);
+    CHECK(last_report.dns_us >= 500);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_IDLE);
+
+    ip_addr_t addr = { 0x0200000a };
+    CHECK(sim_rawprobe_start(&probe));
+    dns_cb("example.com", &addr, dns_arg);
+    CHECK_EQ(pcb_count, 1);
+    CHECK_EQ(probe.addr.addr, 0x0200000a);
+}
+
+// DNS không trả lời: hạn chờ riêng kết thúc probe, câu trả lời muộn bị bỏ
+static void test_dns_timeout(void)
+{
+    reset(ERR_INPROGRESS);
+    CHECK(sim_rawprobe_start(&probe));
+    CHECK(timeout_handler != NULL);
+    CHECK_EQ(timeout_ms, 100);
+    timeout_handler(timeout_arg);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_DNS);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_IDLE);
+
+    ip_addr_t addr = { 0x0200000a };
+    dns_cb("example.com", &addr, dns_arg);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(pcb_count, 0);
+
+    // Trả lời kịp thì timer bị hủy
+    CHECK(sim_rawprobe_start(&probe));
+    dns_cb("example.com", &addr, dns_arg);
+    CHECK(timeout_handler == NULL);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_CONNECTING);
+}
+
+static void test_connect_timeout(void)
+{
+    reset(ERR_OK);
+    CHECK(sim_rawprobe_start(&probe));
+    struct tcp_pcb *pcb = &pcbs[0];
+    CHECK_EQ(pcb->poll(pcb->arg, pcb), ERR_OK);
+    CHECK_EQ(reports, 0);
+    usleep(120000);
+    CHECK_EQ(pcb->poll(pcb->arg, pcb), ERR_ABRT);
+    CHECK(pcb->aborted);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_CONNECT);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_IDLE);
+}
+
+static void test_stale_keepalive_retries_once(void)
+{
+    reset(ERR_OK);
+    sim_rawprobe_start(&probe);
+    pcbs[0].connected(pcbs[0].arg, &pcbs[0], ERR_OK);
+    deliver(&pcbs[0], "HTTP/1.1 200 OK\r\n\r\n");
+    CHECK_EQ(reports, 1);
+
+    // Server đã reset kết nối cũ: probe mở kết nối mới và gửi lại
+    sim_rawprobe_start(&probe);
+    pcbs[0].err(pcbs[0].arg, ERR_RST);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(pcb_count, 2);
+    pcbs[1].connected(pcbs[1].arg, &pcbs[1], ERR_OK);
+    deliver(&pcbs[1], "HTTP/1.1 200 OK\r\n\r\n");
+    CHECK_EQ(reports, 2);
+    CHECK_EQ(last_report.result, SIM_PROBE_OK);
+    CHECK(!last_report.reused);
+}
+
+static void test_response_timeout_and_connection_close(void)
+{
+    reset(ERR_OK);
+    sim_rawprobe_start(&probe);
+    pcbs[0].connected(pcbs[0].arg, &pcbs[0], ERR_OK);
+    deliver(&pcbs[0], "HTTP/1.1 200 OK\r\nServer: x\r\n");
+    usleep(120000);
+    CHECK_EQ(pcbs[0].poll(pcbs[0].arg, &pcbs[0]), ERR_ABRT);
+    CHECK(pcbs[0].aborted);
+    CHECK_EQ(reports, 1);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_TIMEOUT);
+
+    // Server báo Connection: close: probe thành công nhưng không giữ kết nối
+    sim_rawprobe_start(&probe);
+    pcbs[1].connected(pcbs[1].arg, &pcbs[1], ERR_OK);
+    deliver(&pcbs[1], "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n");
+    CHECK_EQ(reports, 2);
+    CHECK_EQ(last_report.result, SIM_PROBE_OK);
+    CHECK(pcbs[1].closed);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_IDLE);
+
+    // Header dài quá SIM_PROBE_HEADER_MAX
+    char big[SIM_PROBE_HEADER_MAX + 64];
+    strcpy(big, "HTTP/1.1 200 OK\r\nX: ");
+    memset(big + strlen(big), 'a', sizeof(big) - strlen(big) - 1);
+    big[sizeof(big) - 1] = 0;
+    sim_rawprobe_start(&probe);
+    pcbs[2].connected(pcbs[2].arg, &pcbs[2], ERR_OK);
+    CHECK_EQ(deliver(&pcbs[2], big), ERR_ABRT);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_OVERSIZE);
+}
+
+static void test_bad_response_and_remote_close(void)
+{
+    reset(ERR_OK);
+    sim_rawprobe_start(&probe);
+    pcbs[0].connected(pcbs[0].arg, &pcbs[0], ERR_OK);
+    CHECK_EQ(deliver(&pcbs[0], "SSH-2.0\r\n\r\n"), ERR_ABRT);
+    CHECK(pcbs[0].aborted);
+    CHECK_EQ(last_report.result, SIM_PROBE_ERR_STATUS);
+
+    // Server đóng kết nối khi đang nghỉ: không báo lỗi, lần sau connect lại
+    sim_rawprobe_start(&probe);
+    pcbs[1].connected(pcbs[1].arg, &pcbs[1], ERR_OK);
+    deliver(&pcbs[1], "HTTP/1.1 200 OK\r\n\r\n");
+    CHECK_EQ(reports, 2);
+    CHECK_EQ(pcbs[1].recv(pcbs[1].arg, &pcbs[1], NULL, ERR_OK), ERR_OK);
+    CHECK(pcbs[1].closed);
+    CHECK_EQ(reports, 2);
+    CHECK_EQ(probe.state, SIM_RAWPROBE_IDLE);
+}
+
+int main(void)
+{
+    RUN_TEST(test_cached_dns_and_keepalive);
+    RUN_TEST(test_async_dns_and_failure);
+    RUN_TEST(test_dns_timeout);
+    RUN_TEST(test_connect_timeout);
+    RUN_TEST(test_stale_keepalive_retries_once);
+    RUN_TEST(test_response_timeout_and_connection_close);
+    RUN_TEST(test_bad_response_and_remote_close);
+    return TEST_RESULT();
+}
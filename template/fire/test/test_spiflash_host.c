@@ -0,0 +1,242 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "spiflash_host.h"
+#include "test_common.h"
+
+#define TEST_SIZE (4 * SPI_FLASH_SEC_SIZE)
+
+// Ghi chỉ xóa bit; muốn đặt lại 1 phải xóa cả sector
+static void test_nor_semantics(void)
+{
+    uint8_t buf[4];
+
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    CHECK_EQ(sdk_flashchip.chip_size, TEST_SIZE);
+    CHECK(spiflash_read(TEST_SIZE - 4, buf, 4));
+    CHECK_EQ(buf[3], 0xff);
+
+    CHECK(spiflash_write(0x1000, (uint8_t *)"\xf0\x0f", 2));
+    CHECK(spiflash_write(0x1000, (uint8_t *)"\x3c\xff", 2));
+    CHECK(spiflash_read(0x1000, buf, 2));
+    CHECK_EQ(buf[0], 0x30);
+    CHECK_EQ(buf[1], 0x0f);
+    // 0x3c trên 0xf0 cố đặt bit 2 và 3, 0xff trên 0x0f cố đặt 4 bit cao
+    CHECK_EQ(spiflash_host_stats.stuck_bits, 6);
+
+    spiflash_host_strict = true;
+    CHECK(!spiflash_write(0x1000, (uint8_t *)"\xff", 1));
+    CHECK(spiflash_write(0x1000, (uint8_t *)"\x10", 1));
+    spiflash_host_strict = false;
+
+    CHECK(spiflash_erase_sector(0x1000));
+    CHECK(spiflash_read(0x1000, buf, 2));
+    CHECK_EQ(buf[0], 0xff);
+    CHECK_EQ(buf[1], 0xff);
+}
+
+// Ngoài ảnh, sector lệch và API SDK không căn 4 byte đều bị từ chối
+static void test_bounds_alignment(void)
+{
+    uint32_t words[2] = { 0x12345678, 0 };
+    uint8_t buf[8];
+
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    CHECK(!spiflash_read(TEST_SIZE - 2, buf, 4));
+    CHECK(!spiflash_write(TEST_SIZE, buf, 1));
+    CHECK(!spiflash_erase_sector(0x800));
+    CHECK(!spiflash_erase_sector(TEST_SIZE));
+    CHECK_EQ(sdk_spi_flash_erase_sector(TEST_SIZE / SPI_FLASH_SEC_SIZE), SPI_FLASH_RESULT_ERR);
+    CHECK_EQ(sdk_spi_flash_write(0x102, words, 4), SPI_FLASH_RESULT_ERR);
+    CHECK_EQ(sdk_spi_flash_write(0x100, words, 3), SPI_FLASH_RESULT_ERR);
+    CHECK_EQ(sdk_spi_flash_read(0x100, (uint32_t *)(buf + 1), 4), SPI_FLASH_RESULT_ERR);
+    CHECK_EQ(spiflash_host_stats.errors, 8);
+
+    CHECK_EQ(sdk_spi_flash_write(0x100, words, 4), SPI_FLASH_RESULT_OK);
+    CHECK_EQ(sdk_spi_flash_read(0x100, &words[1], 4), SPI_FLASH_RESULT_OK);
+    CHECK_EQ(words[1], 0x12345678);
+    CHECK_EQ(sdk_spi_flash_erase_sector(0), SPI_FLASH_RESULT_OK);
+    CHECK_EQ(spiflash_host_data()[0x100], 0xff);
+    CHECK_EQ(sdk_spi_flash_get_id(), sdk_flashchip.device_id);
+}
+
+// Đếm thao tác và thời gian của chip theo mô hình
+static void test_stats_latency(void)
+{
+    uint8_t buf[300];
+
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    memset(buf, 0, sizeof(buf));
+    // 300 byte từ 0xf0 chạm ba trang
+    CHECK(spiflash_write(0xf0, buf, sizeof(buf)));
+    CHECK(spiflash_read(0, buf, 65));
+    CHECK(spiflash_erase_sector(0));
+    CHECK_EQ(spiflash_host_stats.writes, 1);
+    CHECK_EQ(spiflash_host_stats.pages, 3);
+    CHECK_EQ(spiflash_host_stats.write_bytes, 300);
+    CHECK_EQ(spiflash_host_stats.reads, 1);
+    CHECK_EQ(spiflash_host_stats.read_bytes, 65);
+    CHECK_EQ(spiflash_host_stats.erases, 1);
+    CHECK_EQ(spiflash_host_stats.busy_ns, 3ull * SPIFLASH_HOST_PAGE_PROGRAM_US * 1000 +
+             2ull * SPIFLASH_HOST_READ_BLOCK_NS + SPIFLASH_HOST_SECTOR_ERASE_US * 1000ull);
+
+    spiflash_host_reset_stats();
+    CHECK_EQ(spiflash_host_stats.busy_ns, 0);
+}
+
+// Đọc trong cửa sổ cache không tắt ngắt; đọc thô chia đoạn SPIFLASH_READ_CHUNK
+static void test_read_paths(void)
+{
+    uint8_t buf[1000];
+
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    spiflash_host_mmap_size = 2 * SPI_FLASH_SEC_SIZE;
+    // Byte 30..69 nằm trên ba dòng cache
+    CHECK(spiflash_read(30, buf, 40));
+    CHECK_EQ(spiflash_host_stats.mmap_reads, 1);
+    CHECK_EQ(spiflash_host_stats.read_sections, 0);
+    CHECK_EQ(spiflash_host_stats.busy_ns, 3ull * SPIFLASH_HOST_CACHE_LINE_NS);
+
+    // Vượt qua cuối cửa sổ thì đọc thô; 1000 byte là 256 + 256 + 256 + 232
+    spiflash_host_reset_stats();
+    CHECK(spiflash_read(2 * SPI_FLASH_SEC_SIZE - 8, buf, sizeof(buf)));
+    CHECK_EQ(spiflash_host_stats.mmap_reads, 0);
+    CHECK_EQ(spiflash_host_stats.read_sections, 4);
+    CHECK_EQ(spiflash_host_stats.read_irq_off_max_ns, 4 * SPIFLASH_HOST_READ_BLOCK_NS);
+    CHECK_EQ(spiflash_host_stats.busy_ns, 16ull * SPIFLASH_HOST_READ_BLOCK_NS);
+
+    // Không chia đoạn: ngắt tắt suốt lần đọc
+    spiflash_host_reset_stats();
+    spiflash_host_read_chunk = 0;
+    CHECK(spiflash_read(3 * SPI_FLASH_SEC_SIZE, buf, sizeof(buf)));
+    CHECK_EQ(spiflash_host_stats.read_sections, 1);
+    CHECK_EQ(spiflash_host_stats.read_irq_off_max_ns, 16 * SPIFLASH_HOST_READ_BLOCK_NS);
+
+    spiflash_host_mmap_size = 0;
+    spiflash_host_read_chunk = SPIFLASH_HOST_READ_CHUNK;
+}
+
+// ROM chạy từ MB 1 (rboot): cửa sổ cache là MB đó, MB 0 phải đọc thô
+static void test_read_mapped_megabyte(void)
+{
+    uint8_t data[4] = { 0x12, 0x34, 0x56, 0x78 };
+    uint8_t buf[40];
+
+    CHECK(spiflash_host_open(NULL, 3 * SPIFLASH_HOST_MMAP_SIZE));
+    spiflash_host_mmap_size = SPIFLASH_HOST_MMAP_SIZE;
+    spiflash_host_mmap_megabyte = 1;
+    CHECK(spiflash_write(SPIFLASH_HOST_MMAP_SIZE + 32, data, sizeof(data)));
+
+    spiflash_host_reset_stats();
+    CHECK(spiflash_read(30, buf, sizeof(buf)));
+    CHECK_EQ(spiflash_host_stats.mmap_reads, 0);
+    CHECK_EQ(spiflash_host_stats.read_sections, 1);
+
+    // Cùng độ lệch trong MB 1: ba dòng cache, đúng dữ liệu của MB 1
+    spiflash_host_reset_stats();
+    CHECK(spiflash_read(SPIFLASH_HOST_MMAP_SIZE + 30, buf, sizeof(buf)));
+    CHECK_EQ(spiflash_host_stats.mmap_reads, 1);
+    CHECK_EQ(spiflash_host_stats.read_sections, 0);
+    CHECK_EQ(spiflash_host_stats.busy_ns, 3ull * SPIFLASH_HOST_CACHE_LINE_NS);
+    CHECK(memcmp(buf + 2, data, sizeof(data)) == 0);
+
+    // Vượt sang MB 2 hoặc nằm hẳn trong MB 2 thì đọc thô
+    spiflash_host_reset_stats();
+    CHECK(spiflash_read(2 * SPIFLASH_HOST_MMAP_SIZE - 8, buf, 16));
+    CHECK(spiflash_read(2 * SPIFLASH_HOST_MMAP_SIZE, buf, 16));
+    CHECK_EQ(spiflash_host_stats.mmap_reads, 0);
+    CHECK_EQ(spiflash_host_stats.read_sections, 2);
+
+    spiflash_host_mmap_size = 0;
+    spiflash_host_mmap_megabyte = 0;
+}
+
+// Mất điện giữa lần ghi: phần đầu đã xuống flash, sau đó mọi ghi/xóa thất bại
+static void test_power_loss(void)
+{
+    uint8_t buf[8] = { 0 };
+
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    spiflash_host_budget = 5;
+    CHECK(!spiflash_write(0, buf, sizeof(buf)));
+    CHECK_EQ(spiflash_host_data()[4], 0x00);
+    CHECK_EQ(spiflash_host_data()[5], 0xff);
+    CHECK(!spiflash_erase_sector(0));
+    CHECK(spiflash_read(0, buf, 1));
+    // Mở lại ảnh là bật nguồn lại
+    CHECK(spiflash_host_open(NULL, TEST_SIZE));
+    CHECK_EQ(spiflash_host_budget, UINT32_MAX);
+
+    // Mất điện giữa lần xóa: hai khối đầu đã xóa, khối thứ ba dở dang, phần
+    // còn lại của sector chưa bị xóa
+    const uint8_t *data = spiflash_host_data();
+    uint8_t zeros[SPI_FLASH_SECTOR_SIZE] = { 0 };
+    CHECK(spiflash_write(0, zeros, sizeof(zeros)));
+    spiflash_host_budget = 2;
+    CHECK(!spiflash_erase_sector(0));
+    CHECK_EQ(spiflash_host_budget, 0);
+    CHECK_EQ(spiflash_host_stats.erases, 1);
+    uint32_t erased = 0, partial = 0;
+    for (uint32_t i = 0; i < SPI_FLASH_SECTOR_SIZE; i++) {
+        if (i < 2 * SPIFLASH_HOST_ERASE_BLOCK) {
+            erased += data[i] == 0xff;
+        } else if (i < 3 * SPIFLASH_HOST_ERASE_BLOCK) {
+            partial += data[i] != 0x00 && data[i] != 0xff;
+        } else {
+            CHECK_EQ(data[i], 0x00);
+        }
+    }
+    CHECK_EQ(erased, 2 * SPIFLASH_HOST_ERASE_BLOCK);
+    CHECK(partial > SPIFLASH_HOST_ERASE_BLOCK / 2);
+    CHECK(!spiflash_erase_sector(0));
+}
+
+// Ảnh file giữ nội dung giữa hai lần mở; kích thước 0 lấy theo file
+static void test_file_image(void)
+{
+    char path[] = "/tmp/spiflash_hostXXXXXX";
+    int fd = mkstemp(path);
+    uint8_t buf[4];
+
+    CHECK(fd >= 0);
+    close(fd);
+    CHECK(spiflash_host_open(path, TEST_SIZE));
+    CHECK(spiflash_read(TEST_SIZE - 4, buf, 4));
+    CHECK_EQ(buf[0], 0xff);
+    CHECK(spiflash_write(0x2000, (uint8_t *)"fire", 4));
+    spiflash_host_close();
+    CHECK(!spiflash_read(0, buf, 1));
+
+    CHECK(spiflash_host_open(path, 0));
+    CHECK_EQ(sdk_flashchip.chip_size, TEST_SIZE);
+    CHECK(spiflash_read(0x2000, buf, 4));
+    CHECK(memcmp(buf, "fire", 4) == 0);
+    spiflash_host_close();
+
+    // Ảnh nhỏ hơn được nới ra bằng byte đã xóa
+    CHECK(spiflash_host_open(path, 2 * TEST_SIZE));
+    CHECK(spiflash_read(0x2000, buf, 4));
+    CHECK(memcmp(buf, "fire", 4) == 0);
+    CHECK(spiflash_read(TEST_SIZE, buf, 4));
+    CHECK_EQ(buf[0], 0xff);
+    spiflash_host_close();
+
+    CHECK(!spiflash_host_open(path, 1000));
+    unlink(path);
+}
+
+int main(void)
+{
+    RUN_TEST(test_nor_semantics);
+    RUN_TEST(test_bounds_alignment);
+    RUN_TEST(test_stats_latency);
+    RUN_TEST(test_read_paths);
+    RUN_TEST(test_read_mapped_megabyte);
+    RUN_TEST(test_power_loss);
+    RUN_TEST(test_file_image);
+    spiflash_host_close();
+    return TEST_RESULT();
+}
@@ -0,0 +1,596 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sysparam_emu.h"
+#include "test_common.h"
+
+// Chỉ mục khóa của core/sysparam.c, cùng kích thước với firmware
+// (SYSPARAM_INDEX_SIZE truyền từ Makefile): tra một khóa có trong chỉ mục tốn
+// một lần đọc để kiểm tra khóa và một lần đọc giá trị, dù vùng có bao nhiêu mục
+
+static void key_name(char *key, size_t size, int i)
+{
+    snprintf(key, size, "app.key%02d", i);
+}
+
+static bool set_keys(int count, int32_t base)
+{
+    char key[16];
+    for (int i = 0; i < count; i++) {
+        key_name(key, sizeof(key), i);
+        if (sysparam_set_int32(key, base + i) != SYSPARAM_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Số lần đọc flash của một lần tra, -1 nếu giá trị sai
+static int get_reads(const char *key, int32_t expected)
+{
+    int32_t value = 0;
+    uint32_t reads = spiflash_host_stats.reads;
+    if (sysparam_get_int32(key, &value) != SYSPARAM_OK || value != expected) {
+        return -1;
+    }
+    return spiflash_host_stats.reads - reads;
+}
+
+static void test_lookup_reads(void)
+{
+    char key[16];
+    int32_t value;
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_keys(20, 100));
+    for (int i = 0; i < 20; i++) {
+        key_name(key, sizeof(key), i);
+        CHECK_EQ(get_reads(key, 100 + i), 2);
+    }
+    // Khóa không có: không đọc flash
+    uint32_t reads = spiflash_host_stats.reads;
+    CHECK_EQ(sysparam_get_int32("app.missing", &value), SYSPARAM_NOTFOUND);
+    CHECK_EQ(spiflash_host_stats.reads, reads);
+
+    // Chỉ mục được dựng lại khi khởi động
+    CHECK(sysparam_emu_reboot());
+    for (int i = 0; i < 20; i++) {
+        key_name(key, sizeof(key), i);
+        CHECK_EQ(get_reads(key, 100 + i), 2);
+    }
+}
+
+static void test_update_and_delete(void)
+{
+    char *text;
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_keys(8, 0));
+    CHECK_EQ(sysparam_set_string("app.name", "first"), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_string("app.name", "a longer second value"), SYSPARAM_OK);
+    CHECK_EQ(sysparam_get_string("app.name", &text), SYSPARAM_OK);
+    CHECK(strcmp(text, "a longer second value") == 0);
+    free(text);
+    CHECK_EQ(sysparam_set_int32("app.key03", -7), SYSPARAM_OK);
+    CHECK_EQ(get_reads("app.key03", -7), 2);
+
+    // Xóa: khóa vẫn còn trong vùng nhưng không có giá trị
+    CHECK_EQ(sysparam_set_data("app.key05", NULL, 0, false), SYSPARAM_OK);
+    CHECK_EQ(sysparam_get_string("app.key05", &text), SYSPARAM_NOTFOUND);
+    CHECK_EQ(sysparam_set_int32("app.key05", 55), SYSPARAM_OK);
+    CHECK_EQ(get_reads("app.key05", 55), 2);
+
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(get_reads("app.key03", -7), 2);
+    CHECK_EQ(get_reads("app.key05", 55), 2);
+    CHECK_EQ(get_reads("app.key07", 7), 2);
+}
+
+// Ghi đè tới khi vùng đầy và được nén: chỉ mục trỏ sang vùng mới
+static void test_compaction(void)
+{
+    char key[16];
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_keys(10, 0));
+    uint32_t erases = spiflash_host_stats.erases;
+    int32_t i;
+    for (i = 0; i < 2000 && spiflash_host_stats.erases == erases; i++) {
+        CHECK_EQ(sysparam_set_int32("app.counter", i), SYSPARAM_OK);
+    }
+    CHECK(spiflash_host_stats.erases > erases);
+    CHECK_EQ(sysparam_set_int32("app.counter", 5000), SYSPARAM_OK);
+    CHECK_EQ(get_reads("app.counter", 5000), 2);
+    for (int k = 0; k < 10; k++) {
+        key_name(key, sizeof(key), k);
+        CHECK_EQ(get_reads(key, k), 2);
+    }
+
+    CHECK_EQ(sysparam_compact(), SYSPARAM_OK);
+    CHECK_EQ(get_reads("app.counter", 5000), 2);
+    CHECK_EQ(sysparam_set_string("app.after", "x"), SYSPARAM_OK);
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(get_reads("app.counter", 5000), 2);
+    CHECK_EQ(get_reads("app.key09", 9), 2);
+}
+
+// Hai khóa cùng độ dài có cùng hash 16 bit: khóa trong flash quyết định
+static void test_hash_collision(void)
+{
+    CHECK(sysparam_emu_format());
+    CHECK_EQ(sysparam_set_int32("wifi.key147", 147), SYSPARAM_OK);
+    CHECK_EQ(sysparam_set_int32("wifi.key355", 355), SYSPARAM_OK);
+    CHECK_EQ(get_reads("wifi.key147", 147), 2);
+    CHECK_EQ(get_reads("wifi.key355", 355), 3);
+    CHECK_EQ(sysparam_set_int32("wifi.key355", 356), SYSPARAM_OK);
+    CHECK_EQ(get_reads("wifi.key147", 147), 2);
+    CHECK_EQ(get_reads("wifi.key355", 356), 3);
+}
+
+// Nhiều khóa hơn chỉ mục: tra bằng cách quét flash như trước
+static void test_index_overflow(void)
+{
+    char key[16];
+    int count = SYSPARAM_INDEX_SIZE + 8;
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_keys(count, 1000));
+    key_name(key, sizeof(key), count - 1);
+    CHECK(get_reads(key, 1000 + count - 1) > 2);
+    CHECK(sysparam_emu_reboot());
+    for (int i = 0; i < count; i++) {
+        key_name(key, sizeof(key), i);
+        CHECK(get_reads(key, 1000 + i) > 0);
+    }
+}
+
+// ---- Giao dịch nhiều khóa ----
+
+static const uint8_t bssid[6] = { 0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03 };
+
+static bool has_string(const char *key, const char *expected)
+{
+    char *text;
+    if (sysparam_get_string(key, &text) != SYSPARAM_OK) {
+        return false;
+    }
+    bool same = strcmp(text, expected) == 0;
+    free(text);
+    return same;
+}
+
+static bool set_wifi_old(void)
+{
+    return sysparam_set_string("wifi.ssid", "old-ssid") == SYSPARAM_OK &&
+           sysparam_set_string("wifi.pass", "old-pass") == SYSPARAM_OK &&
+           sysparam_set_int32("wifi.channel", 1) == SYSPARAM_OK &&
+           sysparam_set_int32("app.keep", 9) == SYSPARAM_OK;
+}
+
+// Đổi SSID, mật khẩu, kênh, thêm BSSID (khóa mới) và xóa app.keep cùng lúc
+static sysparam_status_t commit_wifi_new(void)
+{
+    sysparam_txn_t txn;
+    sysparam_txn_begin(&txn);
+    sysparam_txn_set_string(&txn, "wifi.ssid", "new-ssid");
+    sysparam_txn_set_string(&txn, "wifi.pass", "draft");
+    sysparam_txn_set_int32(&txn, "wifi.channel", 6);
+    sysparam_txn_set_data(&txn, "wifi.bssid", bssid, sizeof(bssid), true);
+    sysparam_txn_set_data(&txn, "app.keep", NULL, 0, false);
+    sysparam_txn_set_string(&txn, "wifi.pass", "new-password");
+    return sysparam_txn_commit(&txn);
+}
+
+// 1 = toàn bộ giá trị cũ, 2 = toàn bộ giá trị mới, 0 = lẫn lộn
+static int wifi_state(void)
+{
+    int32_t channel = 0, keep = 0;
+    uint8_t mac[8];
+    size_t len = 0;
+    bool binary;
+    bool old_state = has_string("wifi.ssid", "old-ssid") && has_string("wifi.pass", "old-pass") &&
+                     sysparam_get_int32("wifi.channel", &channel) == SYSPARAM_OK && channel == 1 &&
+                     sysparam_get_data_static("wifi.bssid", mac, sizeof(mac), &len, &binary) == SYSPARAM_NOTFOUND &&
+                     sysparam_get_int32("app.keep", &keep) == SYSPARAM_OK && keep == 9;
+    bool new_state = has_string("wifi.ssid", "new-ssid") && has_string("wifi.pass", "new-password") &&
+                     sysparam_get_int32("wifi.channel", &channel) == SYSPARAM_OK && channel == 6 &&
+                     sysparam_get_data_static("wifi.bssid", mac, sizeof(mac), &len, &binary) == SYSPARAM_OK &&
+                     len == sizeof(bssid) && binary && memcmp(mac, bssid, sizeof(bssid)) == 0 &&
+                     sysparam_get_int32("app.keep", &keep) == SYSPARAM_NOTFOUND;
+    return old_state ? 1 : new_state ? 2 : 0;
+}
+
+// Một khối ghi liền, một lần ghi header để xác nhận, rồi xóa các giá trị cũ
+static void test_txn_commit(void)
+{
+    CHECK(sysparam_emu_format());
+    CHECK(set_wifi_old());
+    CHECK_EQ(wifi_state(), 1);
+
+    spiflash_host_reset_stats();
+    CHECK_EQ(commit_wifi_new(), SYSPARAM_OK);
+    CHECK_EQ(wifi_state(), 2);
+    // Khối, header xác nhận, 4 lần xóa giá trị cũ, xóa cờ chờ
+    CHECK_EQ(spiflash_host_stats.writes, 7);
+    CHECK_EQ(spiflash_host_stats.erases, 0);
+    CHECK_EQ(get_reads("wifi.channel", 6), 2);
+
+    // Không gì thay đổi: không ghi
+    uint32_t writes = spiflash_host_stats.writes;
+    CHECK_EQ(commit_wifi_new(), SYSPARAM_OK);
+    CHECK_EQ(spiflash_host_stats.writes, writes);
+
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(wifi_state(), 2);
+    CHECK_EQ(get_reads("wifi.channel", 6), 2);
+    CHECK_EQ(sysparam_set_int32("wifi.channel", 11), SYSPARAM_OK);
+    CHECK_EQ(get_reads("wifi.channel", 11), 2);
+
+    // Duyệt thấy mỗi khóa một lần, kể cả khóa nằm trong khối giao dịch
+    sysparam_iter_t iter;
+    int entries = 0;
+    CHECK_EQ(sysparam_iter_start(&iter), SYSPARAM_OK);
+    while (sysparam_iter_next(&iter) == SYSPARAM_OK) {
+        entries++;
+    }
+    sysparam_iter_end(&iter);
+    CHECK_EQ(entries, 4);
+}
+
+// Mất điện sau từng byte của lần commit: sau khi khởi động lại luôn thấy đủ
+// giá trị cũ hoặc đủ giá trị mới, và vùng vẫn ghi tiếp được
+static void test_txn_power_loss(void)
+{
+    uint32_t budget;
+    sysparam_status_t status = SYSPARAM_ERR_IO;
+    int old_states = 0;
+
+    for (budget = 0; status != SYSPARAM_OK && budget < 1000; budget++) {
+        CHECK(sysparam_emu_format());
+        CHECK(set_wifi_old());
+        spiflash_host_budget = budget;
+        status = commit_wifi_new();
+        spiflash_host_budget = UINT32_MAX;
+        CHECK(sysparam_emu_reboot());
+        int state = wifi_state();
+        if (state == 0) {
+            printf("budget %u: mixed state\n", budget);
+        }
+        CHECK(state != 0);
+        old_states += state == 1;
+        CHECK_EQ(sysparam_set_string("app.after", "x"), SYSPARAM_OK);
+        CHECK(sysparam_emu_reboot());
+        CHECK_EQ(wifi_state(), state);
+        CHECK(has_string("app.after", "x"));
+    }
+    CHECK_EQ(status, SYSPARAM_OK);
+    // Trước header xác nhận là trạng thái cũ, sau đó là trạng thái mới
+    CHECK(old_states > 0 && old_states < (int)budget);
+}
+
+// Mất điện lần nữa khi khởi động đang hoàn tất giao dịch dở: sysparam_init()
+// báo lỗi và vùng chưa dùng được (không đọc trạng thái lẫn lộn); lần khởi
+// động sau hoàn tất giao dịch
+static void test_txn_recovery_fails(void)
+{
+    uint32_t budget;
+    sysparam_status_t status = SYSPARAM_ERR_IO;
+    int32_t channel;
+    int failed = 0;
+
+    for (budget = 0; status != SYSPARAM_OK && budget < 1000; budget++) {
+        CHECK(sysparam_emu_format());
+        CHECK(set_wifi_old());
+        spiflash_host_budget = budget;
+        status = commit_wifi_new();
+        spiflash_host_budget = 0;
+        sysparam_status_t init = sysparam_init(SYSPARAM_EMU_ADDR, SYSPARAM_EMU_FLASH_SIZE);
+        spiflash_host_budget = UINT32_MAX;
+        if (init != SYSPARAM_OK) {
+            CHECK_EQ(init, SYSPARAM_ERR_IO);
+            CHECK_EQ(sysparam_get_int32("wifi.channel", &channel), SYSPARAM_ERR_NOINIT);
+            failed++;
+        }
+        CHECK(sysparam_emu_reboot());
+        CHECK(wifi_state() != 0);
+    }
+    CHECK_EQ(status, SYSPARAM_OK);
+    CHECK(failed > 0);
+}
+
+// Ghi app.counter tới khi vùng được nén, trả về số lần ghi
+static int32_t set_until_compaction(void)
+{
+    uint32_t erases = spiflash_host_stats.erases;
+    int32_t i;
+    for (i = 1; i < 5000; i++) {
+        if (sysparam_set_int32("app.counter", i) != SYSPARAM_OK || spiflash_host_stats.erases != erases) {
+            break;
+        }
+    }
+    return i;
+}
+
+// Vùng gần đầy: nén đúng một lần rồi ghi cả khối; khối không thể vừa thì không ghi giá trị nào
+static void test_txn_compaction(void)
+{
+    CHECK(sysparam_emu_format());
+    CHECK(set_wifi_old());
+    // Sau mỗi lần nén vùng giống hệt nhau: dừng 5 giá trị (40 byte) trước lần nén
+    // kế tiếp, khi khối giao dịch (76 byte) không còn vừa
+    set_until_compaction();
+    int32_t cycle = set_until_compaction();
+    CHECK(cycle > 100);
+    for (int32_t i = 0; i < cycle - 5; i++) {
+        CHECK_EQ(sysparam_set_int32("app.counter", i), SYSPARAM_OK);
+    }
+
+    uint32_t erases = spiflash_host_stats.erases;
+    CHECK_EQ(commit_wifi_new(), SYSPARAM_OK);
+    CHECK_EQ(spiflash_host_stats.erases - erases, SYSPARAM_EMU_SECTORS / 2);
+    CHECK_EQ(wifi_state(), 2);
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(wifi_state(), 2);
+
+    // Lớn hơn cả region: ERR_FULL sau nhiều nhất một lần nén (khóa app.keep
+    // không còn giá trị nên có thể thu hồi), không giá trị nào được ghi
+    static uint8_t big[60000];
+    sysparam_txn_t txn;
+    sysparam_txn_begin(&txn);
+    sysparam_txn_set_string(&txn, "wifi.ssid", "lost");
+    CHECK_EQ(sysparam_txn_set_data(&txn, "app.blob", big, sizeof(big), true), SYSPARAM_OK);
+    erases = spiflash_host_stats.erases;
+    CHECK_EQ(sysparam_txn_commit(&txn), SYSPARAM_ERR_FULL);
+    CHECK(spiflash_host_stats.erases - erases <= SYSPARAM_EMU_SECTORS / 2);
+    CHECK_EQ(wifi_state(), 2);
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(wifi_state(), 2);
+}
+
+// Lỗi khi chuẩn bị được giữ lại và commit không ghi gì
+static void test_txn_staging_errors(void)
+{
+    static uint8_t big[40000];
+    sysparam_txn_t txn;
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_wifi_old());
+    sysparam_txn_begin(&txn);
+    CHECK_EQ(sysparam_txn_set_string(&txn, "wifi.ssid", "new-ssid"), SYSPARAM_OK);
+    CHECK_EQ(sysparam_txn_set_string(&txn, "", "x"), SYSPARAM_ERR_BADVALUE);
+    CHECK_EQ(sysparam_txn_set_int32(&txn, "wifi.channel", 6), SYSPARAM_ERR_BADVALUE);
+    CHECK_EQ(sysparam_txn_commit(&txn), SYSPARAM_ERR_BADVALUE);
+    CHECK_EQ(wifi_state(), 1);
+
+    // Mọi mục phải nằm trong một entry 64 KB
+    sysparam_txn_begin(&txn);
+    CHECK_EQ(sysparam_txn_set_data(&txn, "a", big, sizeof(big), true), SYSPARAM_OK);
+    CHECK_EQ(sysparam_txn_set_data(&txn, "b", big, sizeof(big), true), SYSPARAM_ERR_BADVALUE);
+    sysparam_txn_abort(&txn);
+    CHECK_EQ(sysparam_txn_commit(&txn), SYSPARAM_OK);
+    CHECK_EQ(wifi_state(), 1);
+}
+
+// Không có chỉ mục (nhiều khóa hơn SYSPARAM_INDEX_SIZE): khóa tìm bằng quét flash
+static void test_txn_without_index(void)
+{
+    char key[16];
+    int count = SYSPARAM_INDEX_SIZE + 8;
+
+    CHECK(sysparam_emu_format());
+    CHECK(set_keys(count, 0));
+    CHECK(set_wifi_old());
+    key_name(key, sizeof(key), count - 1);
+    CHECK(get_reads(key, count - 1) > 2);
+    CHECK_EQ(commit_wifi_new(), SYSPARAM_OK);
+    CHECK_EQ(wifi_state(), 2);
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(wifi_state(), 2);
+    CHECK_EQ(get_reads(key, count - 1) > 0, true);
+}
+
+// ---- Nén nền (sysparam_compact_step) ----
+
+static bool keys_hold(int count, int32_t base)
+{
+    char key[16];
+    int32_t value;
+    for (int i = 0; i < count; i++) {
+        key_name(key, sizeof(key), i);
+        if (sysparam_get_int32(key, &value) != SYSPARAM_OK || value != base + i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 10 khóa và 100 lần ghi app.counter (99 giá trị đã xóa, 792 byte nén được)
+static bool fill_counter(void)
+{
+    if (!sysparam_emu_format() || !set_keys(10, 0)) {
+        return false;
+    }
+    for (int32_t i = 0; i < 100; i++) {
+        if (sysparam_set_int32("app.counter", i) != SYSPARAM_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool counter_is(int32_t expected)
+{
+    int32_t value;
+    return sysparam_get_int32("app.counter", &value) == SYSPARAM_OK && value == expected;
+}
+
+// Gọi sysparam_compact_step tới khi hết việc: số lần gọi, -1 nếu lỗi.
+// @p max_ns nhận thời gian flash của lần gọi lâu nhất
+static int compact_steps(size_t threshold, uint32_t slice_us, uint64_t *max_ns)
+{
+    for (int calls = 1; calls < 10000; calls++) {
+        uint64_t busy_ns = spiflash_host_stats.busy_ns;
+        sysparam_status_t status = sysparam_compact_step(threshold, slice_us);
+        if (max_ns != NULL && spiflash_host_stats.busy_ns - busy_ns > *max_ns) {
+            *max_ns = spiflash_host_stats.busy_ns - busy_ns;
+        }
+        if (status == SYSPARAM_NOTFOUND) {
+            return calls;
+        }
+        if (status != SYSPARAM_OK) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+static void test_background_compaction(void)
+{
+    sysparam_stats_t stats;
+    uint64_t max_ns = 0;
+
+    CHECK(fill_counter());
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.compactable, 99 * 8);
+    // Dưới ngưỡng: chỉ kiểm tra region cũ (đã trống), không ghi gì
+    uint32_t writes = spiflash_host_stats.writes;
+    uint32_t erases = spiflash_host_stats.erases;
+    CHECK_EQ(compact_steps(1024, 10000, NULL), 1);
+    CHECK_EQ(spiflash_host_stats.writes, writes);
+    CHECK_EQ(spiflash_host_stats.erases, erases);
+
+    // Mỗi lần gọi dừng sau lát 10 ms; một lần xóa sector (45 ms) không chia được
+    int calls = compact_steps(512, 10000, &max_ns);
+    CHECK(calls > 1);
+    CHECK(max_ns <= (10000 + SPIFLASH_HOST_SECTOR_ERASE_US + 2000) * 1000ull);
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.background_compactions, 1);
+    CHECK_EQ(stats.compactions, 0);
+    CHECK_EQ(stats.restarts, 0);
+    CHECK_EQ(stats.compactable, 0);
+    // Chỉ sector đầu chứa header cần xóa; phần còn lại của hai region chưa từng được ghi
+    CHECK_EQ(stats.sector_erases, 1);
+    CHECK_EQ(stats.region_cycles[0] + stats.region_cycles[1], 1);
+    CHECK(stats.step_max_us <= max_ns / 1000);
+    CHECK(keys_hold(10, 0));
+    CHECK(counter_is(99));
+    CHECK_EQ(get_reads("app.counter", 99), 2);
+
+    // Số lần nén của mỗi region nằm trong header
+    CHECK(sysparam_emu_reboot());
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.background_compactions, 0);
+    CHECK_EQ(stats.region_cycles[0] + stats.region_cycles[1], 1);
+    CHECK(keys_hold(10, 0));
+    CHECK_EQ(sysparam_compact(), SYSPARAM_OK);
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.region_cycles[0], 1);
+    CHECK_EQ(stats.region_cycles[1], 1);
+    CHECK_EQ(stats.compactions, 1);
+    CHECK(counter_is(99));
+}
+
+// Khóa đã chép bị ghi lại: bản chép bị bỏ và làm lại; khóa chưa chép thì không
+static void test_background_restart(void)
+{
+    sysparam_stats_t stats;
+
+    CHECK(fill_counter());
+    // Lát 1 µs: mỗi lần gọi làm đúng một bước (xóa sector 1, bắt đầu chép, chép một khóa)
+    for (int i = 0; i < 5; i++) {
+        CHECK_EQ(sysparam_compact_step(0, 1), SYSPARAM_OK);
+    }
+    CHECK_EQ(sysparam_set_int32("app.key08", 108), SYSPARAM_OK);
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.restarts, 0);
+    CHECK_EQ(sysparam_set_int32("app.key01", 101), SYSPARAM_OK);
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.restarts, 1);
+
+    CHECK(compact_steps(0, 1, NULL) > 0);
+    CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    CHECK_EQ(stats.background_compactions, 1);
+    CHECK_EQ(stats.restarts, 1);
+    CHECK(sysparam_emu_reboot());
+    int32_t value = 0;
+    CHECK_EQ(sysparam_get_int32("app.key01", &value), SYSPARAM_OK);
+    CHECK_EQ(value, 101);
+    CHECK_EQ(sysparam_get_int32("app.key08", &value), SYSPARAM_OK);
+    CHECK_EQ(value, 108);
+    CHECK(counter_is(99));
+}
+
+// Lần ghi cần nén khi bản chép nền đang dở: chép tiếp thay vì xóa lại region
+static void test_background_finished_by_write(void)
+{
+    sysparam_stats_t stats;
+
+    CHECK(fill_counter());
+    for (int i = 0; i < 6; i++) {
+        CHECK_EQ(sysparam_compact_step(0, 1), SYSPARAM_OK);
+    }
+    uint32_t erases = spiflash_host_stats.erases;
+    int32_t i = 100;
+    do {
+        CHECK_EQ(sysparam_set_int32("app.counter", i), SYSPARAM_OK);
+        CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+    } while (stats.compactions == 0 && ++i < 2000);
+    CHECK_EQ(stats.compactions, 1);
+    CHECK_EQ(stats.background_compactions, 0);
+    CHECK_EQ(stats.restarts, 0);
+    CHECK_EQ(spiflash_host_stats.erases, erases);
+    CHECK(counter_is(i));
+    CHECK(keys_hold(10, 0));
+    CHECK(sysparam_emu_reboot());
+    CHECK(counter_is(i));
+    CHECK(keys_hold(10, 0));
+}
+
+// Mất điện sau từng byte của một lượt nén nền: vùng cũ vẫn nguyên vẹn
+static void test_background_power_loss(void)
+{
+    sysparam_stats_t stats = { 0 };
+    uint32_t budget;
+
+    for (budget = 0; stats.background_compactions == 0 && budget < 1000; budget++) {
+        CHECK(fill_counter());
+        spiflash_host_budget = budget;
+        compact_steps(0, 100000, NULL);
+        spiflash_host_budget = UINT32_MAX;
+        CHECK_EQ(sysparam_get_stats(&stats), SYSPARAM_OK);
+        CHECK(sysparam_emu_reboot());
+        if (!keys_hold(10, 0) || !counter_is(99)) {
+            printf("budget %u: values lost\n", budget);
+            CHECK(false);
+        }
+        CHECK_EQ(sysparam_set_string("app.after", "x"), SYSPARAM_OK);
+        CHECK(compact_steps(0, 100000, NULL) > 0);
+        CHECK(sysparam_emu_reboot());
+        CHECK(keys_hold(10, 0));
+        CHECK(has_string("app.after", "x"));
+    }
+    CHECK_EQ(stats.background_compactions, 1);
+    CHECK(budget > 200);
+}
+
+int main(void)
+{
+    RUN_TEST(test_lookup_reads);
+    RUN_TEST(test_update_and_delete);
+    RUN_TEST(test_compaction);
+    RUN_TEST(test_hash_collision);
+    RUN_TEST(test_index_overflow);
+    RUN_TEST(test_txn_commit);
+    RUN_TEST(test_txn_power_loss);
+    RUN_TEST(test_txn_recovery_fails);
+    RUN_TEST(test_txn_compaction);
+    RUN_TEST(test_txn_staging_errors);
+    RUN_TEST(test_txn_without_index);
+    RUN_TEST(test_background_compaction);
+    RUN_TEST(test_background_restart);
+    RUN_TEST(test_background_finished_by_write);
+    RUN_TEST(test_background_power_loss);
+    return TEST_RESULT();
+}
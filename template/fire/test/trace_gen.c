@@ -0,0 +1,270 @@
+// Sinh các bản ghi cảm biến tổng hợp trong traces/ cho test và bench (không
+// phải dữ liệu đo thật): mỗi bản ghi là một mô hình tín hiệu cộng nhiễu giả
+// ngẫu nhiên với hạt giống cố định, nên cùng một tệp được tạo lại y hệt.
+//
+//   trace_gen traces/smoulder.csv ...
+//
+// Tên tệp (bỏ thư mục và .csv) chọn mô hình trong bảng traces[].
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SYNTHETIC_NOTE "Synthetic trace generated by test/trace_gen.c, not a recording"
+
+// ADC trên TOUT, 10 Hz; số đếm khi không khí sạch
+#define SMOKE_PERIOD_MS 100
+#define SMOKE_CLEAN 120
+// Bản ghi khí: 20 phút, sự kiện bắt đầu từ 300 s
+#define FUSION_DURATION_S 1200
+
+static uint64_t rng_state;
+
+static void rng_seed(uint64_t seed)
+{
+    rng_state = seed * 0x9e3779b97f4a7c15ull + 1;
+}
+
+// Số ngẫu nhiên đều trong [0, 1) (xorshift64*)
+static double uniform(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return ((rng_state * 0x2545f4914f6cdd1dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double uniform_range(double lo, double hi)
+{
+    return lo + (hi - lo) * uniform();
+}
+
+// Phân phối chuẩn (Box-Muller)
+static double gauss(double mean, double sd)
+{
+    double u = 1.0 - uniform();
+    return mean + sd * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniform());
+}
+
+static double clamp(double v, double lo, double hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Tăng tuyến tính từ 0 lên 1 trong @dur giây kể từ @t0
+static double ramp(double t, double t0, double dur)
+{
+    return clamp((t - t0) / dur, 0, 1);
+}
+
+// Giữ 1 tới @t1 rồi giảm theo hàm mũ hằng số thời gian @tau
+static double decay(double t, double t1, double tau)
+{
+    return t < t1 ? 1 : exp(-(t - t1) / tau);
+}
+
+// Nhiễu ADC: Gauss 3 số đếm, 1 % mẫu bị gai 15-25 số đếm khi Wi-Fi phát
+static double adc_noise(void)
+{
+    double v = gauss(0, 3);
+    if (uniform() < 0.01) {
+        v += (uniform() < 0.5 ? -1 : 1) * uniform_range(15, 25);
+    }
+    return v;
+}
+
+static double smoulder(double t)
+{
+    return SMOKE_CLEAN + (t < 120 ? 0 : 0.4 * (t - 120));
+}
+
+static double flaming(double t)
+{
+    if (t < 60) {
+        return SMOKE_CLEAN;
+    }
+    if (t < 75) {
+        return SMOKE_CLEAN + 30 * (t - 60);
+    }
+    if (t < 120) {
+        return SMOKE_CLEAN + 450;
+    }
+    return SMOKE_CLEAN + 450 * exp(-(t - 120) / 10);
+}
+
+static double drift(double t)
+{
+    return SMOKE_CLEAN + 150 * t / 1200;
+}
+
+// Gai bụi/hơi nước một hoặc hai mẫu cách nhau 10-30 s, tạo trước khi sinh nhiễu
+#define NUISANCE_SAMPLES 6000
+static double nuisance_spikes[NUISANCE_SAMPLES];
+
+static void nuisance_prepare(void)
+{
+    memset(nuisance_spikes, 0, sizeof(nuisance_spikes));
+    for (double t = 5.0; t < 590; t += uniform_range(10, 30)) {
+        int start = (int)(t * 10);
+        int count = uniform() < 0.5 ? 1 : 2;
+        for (int k = 0; k < count; k++) {
+            nuisance_spikes[start + k] = uniform_range(100, 300);
+        }
+    }
+}
+
+static double nuisance(double t)
+{
+    int i = (int)lround(t * 10);
+    double v = SMOKE_CLEAN + (i < NUISANCE_SAMPLES ? nuisance_spikes[i] : 0);
+    if (t >= 300 && t < 303) {
+        v += 60;
+    }
+    return v;
+}
+
+// Độ lệch so với không khí sạch của từng đại lượng khí
+typedef struct {
+    double gas;  // Fractional drop of the BME680 gas resistance
+    double tvoc; // ppb
+    double eco2; // ppm
+    double temp; // 0.01 C
+    double rh;   // 0.01 %
+} fusion_effect_t;
+
+static fusion_effect_t fusion_flaming(double t)
+{
+    double s = ramp(t, 300, 120) * decay(t, 900, 120);
+    return (fusion_effect_t){ 0.65 * s, 3000 * s, 1800 * s, 1200 * ramp(t, 310, 150) * decay(t, 900, 300), -1500 * s };
+}
+
+static fusion_effect_t fusion_smoulder(double t)
+{
+    double s = ramp(t, 300, 600) * decay(t, 1000, 200);
+    return (fusion_effect_t){ 0.75 * s, 4000 * s, 2500 * s, 150 * s, 200 * s };
+}
+
+static fusion_effect_t fusion_shower(double t)
+{
+    double s = ramp(t, 300, 90) * decay(t, 900, 180);
+    return (fusion_effect_t){ 0.55 * s, 900 * s, 800 * s, 300 * ramp(t, 300, 180) * decay(t, 900, 300), 4700 * s };
+}
+
+static fusion_effect_t fusion_cooking(double t)
+{
+    double s = ramp(t, 300, 60) * decay(t, 700, 200);
+    return (fusion_effect_t){ 0.35 * s, 700 * s, 600 * s, 200 * ramp(t, 300, 300) * decay(t, 700, 300), 600 * s };
+}
+
+typedef struct {
+    const char *name;
+    const char *description;
+    uint32_t seed;
+    uint32_t duration_s;               // Smoke traces only
+    double (*smoke)(double t);         // ADC counts at time t (s), or NULL
+    fusion_effect_t (*fusion)(double t);
+    const char *expect;                // Fusion traces only: "alarm" or "quiet"
+} trace_model_t;
+
+#define FUSION_SENSORS "BME680 gas every 3 s, CCS811 TVOC/eCO2 and SHT3x temperature/humidity every 1 s"
+
+static const trace_model_t traces[] = {
+    { "smoulder", "Smouldering fire: clean air, then smoke rising about 0.4 counts/s from 120 s",
+      1, 900, smoulder },
+    { "flaming", "Flaming fire: smoke rising about 30 counts/s from 60 s, room vented from 120 s",
+      2, 240, flaming },
+    { "nuisance", "Nuisance: dust and steam spikes of one or two samples, a 3 s +60 bump at 300 s",
+      3, 600, nuisance },
+    { "drift", "Sensor drift: clean air reading creeping from 120 to 270 over 20 min",
+      4, 1200, drift },
+    { "fusion_flaming", "Flaming fire from 300 s: gas -65 %, TVOC and eCO2 up, +12 C in 150 s, humidity -15 %",
+      11, 0, NULL, fusion_flaming, "alarm" },
+    { "fusion_smoulder", "Smouldering fire from 300 s: slow 10 min build-up, gas -75 %, TVOC saturated, "
+      "eCO2 +2500 ppm, little heat", 12, 0, NULL, fusion_smoulder, "alarm" },
+    { "fusion_shower", "Shower steam from 300 s: humidity +47 %, gas -55 % and TVOC +900 ppb by "
+      "cross-sensitivity, +3 C", 13, 0, NULL, fusion_shower, "quiet" },
+    { "fusion_cooking", "Frying from 300 s: gas -35 %, TVOC +700 ppb, eCO2 +600 ppm, +2 C, humidity +6 %",
+      14, 0, NULL, fusion_cooking, "quiet" },
+};
+
+static void write_smoke(FILE *out, const trace_model_t *model)
+{
+    fprintf(out, "# %s\n# %s\n# ADC on TOUT, 10 Hz\nms,adc\n", SYNTHETIC_NOTE, model->description);
+    if (model->smoke == nuisance) {
+        nuisance_prepare();
+    }
+    for (uint32_t i = 0; i < model->duration_s * 1000 / SMOKE_PERIOD_MS; i++) {
+        double t = i * SMOKE_PERIOD_MS / 1000.0;
+        long v = lround(model->smoke(t) + adc_noise());
+        fprintf(out, "%u,%ld\n", i * SMOKE_PERIOD_MS, (long)clamp(v, 0, 1023));
+    }
+}
+
+// Mỗi giây: khí BME680 (mỗi 3 s) lúc +250 ms, CCS811 lúc +400 ms, SHT3x lúc
+// +700 ms, lệch ±20 ms; các dòng tự theo thứ tự thời gian
+static void write_fusion(FILE *out, const trace_model_t *model)
+{
+    fprintf(out, "# %s\n# %s\n# %s\n# expect %s\nms,sensor,value\n",
+            SYNTHETIC_NOTE, model->description, FUSION_SENSORS, model->expect);
+    for (uint32_t ms = 0; ms < FUSION_DURATION_S * 1000; ms += 1000) {
+        uint32_t t;
+        fusion_effect_t e;
+        if (ms % 3000 == 0) {
+            t = ms + 250 + (int)uniform_range(-20, 21);
+            e = model->fusion(t / 1000.0);
+            fprintf(out, "%u,gas,%d\n", t, (int)(120000 * (1 + 0.01 * gauss(0, 1)) * (1 - e.gas)));
+        }
+        t = ms + 400 + (int)uniform_range(-20, 21);
+        e = model->fusion(t / 1000.0);
+        fprintf(out, "%u,tvoc,%d\n", t, (int)clamp(20 + e.tvoc + gauss(0, 6), 0, 1187));
+        fprintf(out, "%u,eco2,%d\n", t, (int)clamp(420 + e.eco2 + gauss(0, 10), 400, 8192));
+        t = ms + 700 + (int)uniform_range(-20, 21);
+        e = model->fusion(t / 1000.0);
+        fprintf(out, "%u,temp,%d\n", t, (int)(2150 + e.temp + gauss(0, 4)));
+        fprintf(out, "%u,rh,%d\n", t, (int)clamp(4500 + e.rh + gauss(0, 25), 0, 10000));
+    }
+}
+
+static const trace_model_t *find_model(const char *path)
+{
+    const char *base = strrchr(path, '/');
+    base = base != NULL ? base + 1 : path;
+    size_t len = strcspn(base, ".");
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        if (strlen(traces[i].name) == len && strncmp(base, traces[i].name, len) == 0) {
+            return &traces[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s traces/<name>.csv...\n", argv[0]);
+        return 2;
+    }
+    for (int i = 1; i < argc; i++) {
+        const trace_model_t *model = find_model(argv[i]);
+        if (model == NULL) {
+            fprintf(stderr, "%s: no trace model\n", argv[i]);
+            return 1;
+        }
+        FILE *out = fopen(argv[i], "w");
+        if (out == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        rng_seed(model->seed);
+        if (model->smoke != NULL) {
+            write_smoke(out, model);
+        } else {
+            write_fusion(out, model);
+        }
+        if (fclose(out) != 0) {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+    return 0;
+}